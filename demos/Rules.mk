@@ -20,6 +20,9 @@ include $(dir)/Rules.mk
 dir := $(d)/examples
 include $(dir)/Rules.mk
 
+dir := $(d)/tests
+include $(dir)/Rules.mk
+
 # Begin standard footer
 d		:= $(dirstack_$(sp))
 sp		:= $(basename $(sp))
@@ -94,6 +94,9 @@ public:
   command_line_argument_value<uint32_t> m_thinnen_key;
   command_line_argument_value<float> m_thicken_thinnen_rate;
 
+  //simulation rate options
+  command_line_argument_value<int> m_simulation_rate_divider;
+  command_line_argument_value<int> m_max_extrapolation_time;
 
   //what to display
   command_line_argument_value<int> m_cell_count_x;
@@ -217,6 +220,15 @@ public:
     m_thicken_key(DefaultThickenKey, "thicken_keycode", "Key to press to thicken lines", *this),
     m_thinnen_key(DefaultThinnenKey, "thinnen_keycode", "Key to press to thinnen lines", *this),
     m_thicken_thinnen_rate(10.0f, "ticken_rate", "Thicken/Thinnen rate in pixels/sec", *this),
+
+    //simulation rate options
+    m_simulation_rate_divider(1, "sim_rate_div",
+                              "Run the simulation (animation of cells) only once every "
+                              "sim_rate_div frames, useful for benchmarking extrapolation "
+                              "of node values in the rendering thread", *this),
+    m_max_extrapolation_time(0, "max_extrapolate_ms",
+                             "Maximum time in ms by which node values are extrapolated "
+                             "in the rendering thread, 0 means no extrapolation", *this),
     
 
     //what to display
@@ -321,6 +333,9 @@ private:
   bool m_thicken_down, m_thinnen_down;
   WRATHTime m_paint_time, m_total_time;
   int m_number_frames;
+  int m_simulation_rate_divider;
+  int m_frames_since_simulation, m_number_simulation_frames;
+  float m_simulation_ticks;
 
   bool m_touch_emulate;
   int32_t m_double_click_time;
@@ -368,6 +383,10 @@ TableView(cmd_line_type &cmd_line):
   m_thicken_down(false),
   m_thinnen_down(false),
   m_number_frames(0),
+  m_simulation_rate_divider(std::max(1, cmd_line.m_simulation_rate_divider.m_value)),
+  m_frames_since_simulation(0),
+  m_number_simulation_frames(0),
+  m_simulation_ticks(0.0f),
   m_touch_emulate(cmd_line.m_touch_emulate.m_value),
   m_double_click_time(cmd_line.m_double_click_time.m_value),
   m_zoom_gesture_begin_time(cmd_line.m_zoom_gesture_begin_time.m_value),
@@ -395,6 +414,7 @@ TableView(cmd_line_type &cmd_line):
     command to specify maximum number of nodes per draw call...
    */
   NodePacker::max_node_count()=cmd_line.m_max_transformations.m_value;
+  WRATHLayerNodeValuePackerBase::max_extrapolation_time(cmd_line.m_max_extrapolation_time.m_value);
 
   generate_font(cmd_line);
   generate_table(cmd_line);
@@ -419,7 +439,9 @@ clean_up(void)
             << t << " ms, fps="
             << static_cast<float>(1000*m_number_frames)/t
             << ", [" << t/static_cast<float>(nn)
-            << " ms/frame ]\nStats:"
+            << " ms/frame ]\n"
+            << m_number_simulation_frames << " simulation frames (sim_rate_div="
+            << m_simulation_rate_divider << ")\nStats:"
             << "\n\tDraw calls/frame=" << m_stats.m_draw_count/nn
             << "\n\tGLSL program changes=" << m_stats.m_program_count/nn
             << "\n\tTexture changes=" << m_stats.m_texture_choice_count/nn
@@ -444,7 +466,7 @@ paint(void)
 
       if(m_resized)
         {
-          glViewport(0.0f, 0.0f, width(), height());
+          WRATHGLStateShadow::viewport(vecN<GLint, 4>(0, 0, width(), height()));
           float_orthogonal_projection_params proj_params(0, width(),
                                                          height(), 0);
           m_table->layer().simulation_matrix(WRATHLayer::projection_matrix,
@@ -458,44 +480,57 @@ paint(void)
         }
 
       
-      ticks=m_paint_time.restart();
-      animate_cells(ticks);
-      if(m_thicken_down)
-        {
-          m_table->stroke_width_internal_lines()+=ticks*m_thicken_thinnen_rate;
-          m_table->stroke_width_external_lines()+=ticks*m_thicken_thinnen_rate;
-        }
-      else if(m_thinnen_down)
+      /*
+        the simulation (animation of cells) only runs
+        once every m_simulation_rate_divider frames,
+        if max_extrapolate_ms is non-zero, the rendering
+        thread extrapolates the node values for the frames
+        in between.
+       */
+      m_simulation_ticks+=m_paint_time.restart();
+      ++m_frames_since_simulation;
+      
+      if(m_frames_since_simulation>=m_simulation_rate_divider)
         {
-          float v, d;
+          ticks=m_simulation_ticks;
+          m_simulation_ticks=0.0f;
+          m_frames_since_simulation=0;
+          ++m_number_simulation_frames;
 
-          d=ticks*m_thicken_thinnen_rate;
-          v=std::max(m_table->stroke_width_internal_lines(),
-                     m_table->stroke_width_external_lines());
-          
-          if(v>d)
+          animate_cells(ticks);
+          if(m_thicken_down)
             {
-              m_table->stroke_width_internal_lines()-=d;
-              m_table->stroke_width_external_lines()-=d;
+              m_table->stroke_width_internal_lines()+=ticks*m_thicken_thinnen_rate;
+              m_table->stroke_width_external_lines()+=ticks*m_thicken_thinnen_rate;
             }
-          else
+          else if(m_thinnen_down)
             {
-              m_table->stroke_width_internal_lines()-=v;
-              m_table->stroke_width_external_lines()-=v;
+              float v, d;
+              
+              d=ticks*m_thicken_thinnen_rate;
+              v=std::max(m_table->stroke_width_internal_lines(),
+                         m_table->stroke_width_external_lines());
+              
+              if(v>d)
+                {
+                  m_table->stroke_width_internal_lines()-=d;
+                  m_table->stroke_width_external_lines()-=d;
+                }
+              else
+                {
+                  m_table->stroke_width_internal_lines()-=v;
+                  m_table->stroke_width_external_lines()-=v;
+                }
             }
-          
+          m_tr->signal_complete_simulation_frame();
         }
 
-
-      glClearColor(1.0f, 0.0f, 1.0f, 1.0f);
-
-      m_tr->signal_complete_simulation_frame();
+      WRATHGLStateShadow::clear_color(vec4(1.0f, 0.0f, 1.0f, 1.0f));
       m_tr->signal_begin_presentation_frame();
 
-
       
 
-      glBindFramebuffer(GL_FRAMEBUFFER, 0);
+      WRATHGLStateShadow::bind_framebuffer(0);
       m_table->layer().clear_and_draw(&m_stats);
 
       update_widget();
@@ -163,6 +163,7 @@ DemoWidget(DemoKernelMaker *pp):
   m_ep=WRATHNew FURYQT::EventProducer(this);
   m_connect=m_ep->connect( boost::bind(&DemoWidget::pre_handle_event,
                                        this, _1));
+  m_ep->enable_coalescing(m_maker->m_coalesce_events.m_value);
 
   if(m_maker->m_hide_cursor.m_value)
     {
@@ -246,6 +247,15 @@ event(QEvent *ev)
   else if(m_ep!=NULL)
     {
       m_ep->feed_event(ev);
+      if(m_maker->m_coalesce_events.m_value)
+        {
+          /*
+            queued events are dispatched by paintGL(),
+            Qt merges the update requests of the events
+            of a frame into one paint.
+           */
+          update();
+        }
     }
 
   return QGLWidget::event(ev);
@@ -373,6 +383,11 @@ void
 DemoWidget::
 paintGL(void)
 {
+  if(m_d!=NULL and !m_end_demo_flag)
+    {
+      m_ep->dispatch_events();
+    }
+
   if(m_d!=NULL and !m_end_demo_flag)
     {
       m_d->paint();
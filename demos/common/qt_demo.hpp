@@ -150,6 +150,7 @@ public:
   command_line_argument_value<int> m_stencil_bits;
   command_line_argument_value<bool> m_fullscreen;
   command_line_argument_value<bool> m_hide_cursor;
+  command_line_argument_value<bool> m_coalesce_events;
   command_line_argument_value<bool> m_use_msaa;
   command_line_argument_value<int> m_msaa;
 
@@ -183,6 +184,9 @@ public:
                  *this),
     m_fullscreen(false, "fullscreen", "fullscreen mode", *this),
     m_hide_cursor(false, "hide_cursor", "If true, hide the mouse cursor with a Qt call", *this),
+    m_coalesce_events(true, "coalesce_events", 
+                      "If true, events are queued and dispatched once per frame "
+                      "with consecutive mouse and touch motion events merged", *this),
     m_use_msaa(false, "enable_msaa", "If true enables MSAA", *this),
     m_msaa(4, "msaa_samples", 
            "If greater than 0, specifies the number of samples "
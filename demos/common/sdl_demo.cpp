@@ -52,6 +52,9 @@ DemoKernelMaker(void):
                  *this),
   m_fullscreen(false, "fullscreen", "fullscreen mode", *this),
   m_hide_cursor(false, "hide_cursor", "If true, hide the mouse cursor with a SDL call", *this),
+  m_coalesce_events(true, "coalesce_events", 
+                    "If true, events are queued and dispatched once per frame "
+                    "with consecutive mouse motion events merged", *this),
   m_use_msaa(false, "enable_msaa", "If true enables MSAA", *this),
   m_msaa(4, "msaa_samples", 
          "If greater than 0, specifies the number of samples "
@@ -227,6 +230,7 @@ init_sdl(void)
   m_ep=WRATHNew FURYSDL::EventProducer(w, h);
   m_connect=m_ep->connect( boost::bind(&DemoKernelMaker::pre_handle_event,
                                        this, _1));
+  m_ep->enable_coalescing(m_coalesce_events.m_value);
   if(m_hide_cursor.m_value)
     {
       SDL_ShowCursor(SDL_DISABLE);
@@ -439,6 +443,7 @@ main(int argc, char **argv)
             }
           m_ep->feed_event(&ev);
         }
+      m_ep->dispatch_events();
 
       if(m_call_update and !m_end_demo_flag)
         {
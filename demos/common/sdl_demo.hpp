@@ -155,6 +155,7 @@ public:
   command_line_argument_value<int> m_stencil_bits;
   command_line_argument_value<bool> m_fullscreen;
   command_line_argument_value<bool> m_hide_cursor;
+  command_line_argument_value<bool> m_coalesce_events;
   command_line_argument_value<bool> m_use_msaa;
   command_line_argument_value<int> m_msaa;
   command_line_argument_value<int> m_width;
@@ -58,6 +58,9 @@ include $(dir)/Rules.mk
 dir := $(d)/counter
 include $(dir)/Rules.mk
 
+dir := $(d)/text_document
+include $(dir)/Rules.mk
+
 
 
 # Begin standard footer
@@ -249,7 +249,7 @@ CustomNodeExample(cmd_line_type *cmd_line):
   m_widget->m_outer_radius=300.0f;
   m_widget->m_outer_radius_speed=165.0f;
   
-  glClearColor(1.0, 1.0, 1.0, 1.0);
+  WRATHGLStateShadow::clear_color(vec4(1.0, 1.0, 1.0, 1.0));
 }
 
 CustomNodeExample::
@@ -280,7 +280,7 @@ resize(int width, int height)
 {
   float_orthogonal_projection_params proj_params(0, width, height, 0);
   m_layer->simulation_matrix(WRATHLayer::projection_matrix, float4x4(proj_params));
-  glViewport(0, 0, width, height);
+  WRATHGLStateShadow::viewport(vecN<GLint, 4>(0, 0, width, height));
 }
 
 void 
@@ -265,7 +265,7 @@ CustomNodeExample(cmd_line_type *cmd_line):
       m_widgets.push_back(c);
     }
   
-  glClearColor(0.0, 0.0, 0.0, 1.0);
+  WRATHGLStateShadow::clear_color(vec4(0.0, 0.0, 0.0, 1.0));
 }
 
 CustomNodeExample::
@@ -329,7 +329,7 @@ resize(int width, int height)
 {
   float_orthogonal_projection_params proj_params(0, width, height, 0);
   m_layer->simulation_matrix(WRATHLayer::projection_matrix, float4x4(proj_params));
-  glViewport(0, 0, width, height);
+  WRATHGLStateShadow::viewport(vecN<GLint, 4>(0, 0, width, height));
 }
 
 
@@ -190,7 +190,7 @@ BrushExample(cmd_line_type *cmd_line):
   m_widget->set_gradient(vec2(400.0f, 300.0f), vec2(0.0f, 0.0f));
   m_widget->color(vec4(1.0f, 1.0f, 1.0f, 1.0f));
 
-  glClearColor(1.0, 1.0, 1.0, 1.0);
+  WRATHGLStateShadow::clear_color(vec4(1.0, 1.0, 1.0, 1.0));
 }
 
 BrushExample::
@@ -221,7 +221,7 @@ resize(int width, int height)
 {
   float_orthogonal_projection_params proj_params(0, width, height, 0);
   m_layer->simulation_matrix(WRATHLayer::projection_matrix, float4x4(proj_params));
-  glViewport(0, 0, width, height);
+  WRATHGLStateShadow::viewport(vecN<GLint, 4>(0, 0, width, height));
 }
 
 void 
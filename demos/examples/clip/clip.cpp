@@ -274,7 +274,7 @@ ClipExample(cmd_line_type *cmd_line):
                                                      
   
                   
-  glClearColor(1.0, 1.0, 1.0, 1.0);
+  WRATHGLStateShadow::clear_color(vec4(1.0, 1.0, 1.0, 1.0));
 }
 
 ClipExample::
@@ -344,7 +344,7 @@ resize(ivec2 new_size, ivec2 old_size)
 {
   float_orthogonal_projection_params proj_params(0, new_size.x(), new_size.y(), 0);
   m_layer->simulation_matrix(WRATHLayer::projection_matrix, float4x4(proj_params));
-  glViewport(0, 0, new_size.x(), new_size.y());
+  WRATHGLStateShadow::viewport(vecN<GLint, 4>(0, 0, new_size.x(), new_size.y()));
 
   set_border_and_clip(new_size.x()/4.0, 50.0f, vec2(new_size.x()/2, new_size.y()/2));
   for(unsigned int i=0, endi=m_widgets.size(); i<endi; ++i)
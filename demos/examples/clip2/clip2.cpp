@@ -403,7 +403,7 @@ ClipExample(cmd_line_type *cmd_line):
                                                      
   
                   
-  glClearColor(1.0, 1.0, 1.0, 1.0);
+  WRATHGLStateShadow::clear_color(vec4(1.0, 1.0, 1.0, 1.0));
 }
 
 ClipExample::
@@ -491,7 +491,7 @@ resize(ivec2 new_size, ivec2 old_size)
 {
   float_orthogonal_projection_params proj_params(0, new_size.x(), new_size.y(), 0);
   m_layer->simulation_matrix(WRATHLayer::projection_matrix, float4x4(proj_params));
-  glViewport(0, 0, new_size.x(), new_size.y());
+  WRATHGLStateShadow::viewport(vecN<GLint, 4>(0, 0, new_size.x(), new_size.y()));
 
   WRATHDefaultRectAttributePacker::Rect::handle rect;  
   
@@ -202,6 +202,7 @@ public:
   command_line_argument_value<unsigned int> m_num_frames;
   command_line_argument_value<std::string> m_record_frame;
   command_line_argument_value<bool> m_save_png, m_animate_gradient;
+  command_line_argument_value<int> m_stream_text;
 
   cmd_line_type(void):
     m_virtual_height(128, "virtual_height", 
@@ -217,7 +218,10 @@ public:
     m_num_frames(0, "num_frames", "if non-zero exit, after given number of frames", *this),
     m_record_frame("", "record_frame", "if non-empty record frames to files prefixed with value", *this),
     m_save_png(true, "save_png", "if true save frames as png, if false save as bmp", *this),
-    m_animate_gradient(true, "animate_gradient", "if true animates the radial gradient pattern", *this)
+    m_animate_gradient(true, "animate_gradient", "if true animates the radial gradient pattern", *this),
+    m_stream_text(0, "stream_text", 
+                  "streaming mode of the attribute buffer of the counter text, which changes every frame, "
+                  "0: no streaming, 1: orphan on upload, N>1: ring of N buffers", *this)
   {}
 
   virtual
@@ -366,7 +370,10 @@ CounterExample(cmd_line_type *cmd_line):
   /*
     create the text widget
    */
-  m_text_widget=WRATHNew TextWidget(m_layer, WRATHTextItemTypes::text_transparent);
+  m_text_widget=WRATHNew TextWidget(m_layer, WRATHTextItemTypes::text_transparent,
+                                    WRATHTextItem::Drawer(), WRATHTextItem::draw_order(),
+                                    WRATHTextItem::ExtraDrawState()
+                                    .stream_buffer_count(cmd_line->m_stream_text.m_value));
   m_text_widget->z_order(-1);
 
   /*
@@ -462,7 +469,7 @@ CounterExample::~CounterExample()
 
 void CounterExample::resize(int width, int height)
 {
-  glViewport(0, 0, width, height);
+  WRATHGLStateShadow::viewport(vecN<GLint, 4>(0, 0, width, height));
 }
 
 void CounterExample::paint(void)
@@ -774,7 +774,7 @@ paint(void)
    */
   if(m_resized)
     {
-      glViewport(0, 0, width(), height());
+      WRATHGLStateShadow::viewport(vecN<GLint, 4>(0, 0, width(), height()));
       float_orthogonal_projection_params proj_params(0, width(),
                                                      height(), 0);
       m_contents->simulation_matrix(WRATHLayer::projection_matrix,
@@ -815,7 +815,7 @@ paint(void)
      as well since WRATH does not make any guarantees
      on what the GL state is after drawing. 
    */
-   glBindFramebuffer(GL_FRAMEBUFFER, 0);
+   WRATHGLStateShadow::bind_framebuffer(0);
 
    WRATHLayer::draw_information draw_counts;
 
@@ -548,7 +548,7 @@ void
 wrathlayer_example::
 paint(void)
 {
-  glClearColor(1.0f, 0.0f, 0.0f, 1.0f);
+  WRATHGLStateShadow::clear_color(vec4(1.0f, 0.0f, 0.0f, 1.0f));
 
    /*
     resize happend, a resize of the window triggers that we need
@@ -558,7 +558,7 @@ paint(void)
    */
   if(m_resized)
     {
-      glViewport(0, 0, width(), height());
+      WRATHGLStateShadow::viewport(vecN<GLint, 4>(0, 0, width(), height()));
       float_orthogonal_projection_params proj_params(0, width(),
                                                      height(), 0);
       m_contents->simulation_matrix(WRATHLayer::projection_matrix,
@@ -595,7 +595,7 @@ paint(void)
      as well since WRATH does not make any guarantees
      on what the GL state is after drawing. 
    */
-   glBindFramebuffer(GL_FRAMEBUFFER, 0);
+   WRATHGLStateShadow::bind_framebuffer(0);
 
    /*
      try out that pre-matrix stuff:
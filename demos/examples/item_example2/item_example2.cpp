@@ -154,7 +154,7 @@ ItemExample(cmd_line_type *cmd_line):
 
   //make our widget
   m_widget=WRATHNew Widget(m_layer, params);
-  glClearColor(1.0, 1.0, 1.0, 1.0);
+  WRATHGLStateShadow::clear_color(vec4(1.0, 1.0, 1.0, 1.0));
 }
 
 ItemExample::
@@ -184,7 +184,7 @@ resize(int width, int height)
 {
   float_orthogonal_projection_params proj_params(0, width, height, 0);
   m_layer->simulation_matrix(WRATHLayer::projection_matrix, float4x4(proj_params));
-  glViewport(0, 0, width, height);
+  WRATHGLStateShadow::viewport(vecN<GLint, 4>(0, 0, width, height));
 }
 
 void 
@@ -185,7 +185,7 @@ ShapeExample(cmd_line_type *cmd_line):
                                         WRATHShapeItemTypes::shape_valueT<float>(shape),
                                         drawer);
   m_shape_widget->color(vec4(0.0f, 0.0f, 0.0f, 0.0f));
-  glClearColor(1.0, 1.0, 1.0, 1.0);
+  WRATHGLStateShadow::clear_color(vec4(1.0, 1.0, 1.0, 1.0));
 }
 
 ShapeExample::
@@ -207,7 +207,7 @@ resize(int width, int height)
     float_orthogonal_projection_params proj_params(0, width, height, 0);
 
     m_layer->simulation_matrix(WRATHLayer::projection_matrix, float4x4(proj_params));
-    glViewport(0, 0, width, height);
+    WRATHGLStateShadow::viewport(vecN<GLint, 4>(0, 0, width, height));
 }
 
 void 
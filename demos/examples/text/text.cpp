@@ -196,7 +196,7 @@ TextExample(cmd_line_type *cmd_line):
    */
   m_text_widget->add_text(stream);
   m_text_widget->position(vec2(0.0f, 0.0f));
-  glClearColor(1.0, 1.0, 1.0, 1.0);
+  WRATHGLStateShadow::clear_color(vec4(1.0, 1.0, 1.0, 1.0));
 }
 
 TextExample::~TextExample()
@@ -223,7 +223,7 @@ void TextExample::resize(int width, int height)
 {
   float_orthogonal_projection_params proj_params(0, width, height, 0);
   m_layer->simulation_matrix(WRATHLayer::projection_matrix, float4x4(proj_params));
-  glViewport(0, 0, width, height);
+  WRATHGLStateShadow::viewport(vecN<GLint, 4>(0, 0, width, height));
 }
 
 void TextExample::paint(void)
@@ -0,0 +1,14 @@
+# Begin standard header
+sp 		:= $(sp).x
+dirstack_$(sp)	:= $(d)
+d		:= $(dir)
+# End standard header
+
+DEMOS += text_document
+
+text_document_SOURCES := $(call filelist, text_document.cpp) $(COMMON_DEMO_SOURCES)
+
+# Begin standard footer
+d		:= $(dirstack_$(sp))
+sp		:= $(basename $(sp))
+# End standard footer
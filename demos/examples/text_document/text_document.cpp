@@ -0,0 +1,314 @@
+/*!
+ * \file text_document.cpp
+ * \brief file text_document.cpp
+ *
+ * Copyright 2013 by Nomovok Ltd.
+ *
+ * Contact: info@nomovok.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ *
+ */
+
+
+#include "WRATHConfig.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <boost/bind.hpp>
+
+#include "vecN.hpp"
+#include "WRATHNew.hpp"
+#include "WRATHTime.hpp"
+#include "WRATHLayer.hpp"
+#include "WRATHLayerItemNodeTranslate.hpp"
+#include "WRATHLayerItemDrawerFactory.hpp"
+#include "WRATHLayerNodeValuePackerUniformArrays.hpp"
+#include "WRATHLayerTextDocument.hpp"
+
+#include "ngl_backend.hpp"
+#include "wrath_demo.hpp"
+
+/*!
+\details
+This example opens a (possibly very large) text file
+with a \ref WRATHLayerTextDocument: opening only splits
+the text into chunks, and each frame only the chunks
+near the window are formatted. The time to open the
+document and to format the first frame are printed.
+Scroll with the mouse wheel or the up and down keys,
+or pass auto_scroll to scroll through the document.
+ */
+
+class cmd_line_type:public DemoKernelMaker
+{
+public:
+  command_line_argument_value<std::string> m_file;
+  command_line_argument_value<int> m_generate_lines;
+  command_line_argument_value<int> m_chunk_size;
+  command_line_argument_value<int> m_pixel_size;
+  command_line_argument_value<float> m_auto_scroll;
+
+  cmd_line_type(void):
+    m_file("", "file", "Text file to open, if empty a document is generated", *this),
+    m_generate_lines(100000, "generate_lines",
+                     "Number of lines of the generated document", *this),
+    m_chunk_size(4096, "chunk_size",
+                 "Number of bytes of text after which a chunk is split at the next line break", *this),
+    m_pixel_size(20, "pixel_size", "Pixel size of the text", *this),
+    m_auto_scroll(0.0f, "auto_scroll",
+                  "If positive, scroll through the document at this many pixels per ms", *this)
+  {}
+
+  virtual
+  DemoKernel*
+  make_demo(void);
+
+  virtual
+  void
+  delete_demo(DemoKernel *k)
+  {
+    if(k!=NULL)
+      {
+        WRATHDelete(k);
+      }
+  }
+};
+
+class TextDocumentExample:public DemoKernel
+{
+public:
+  TextDocumentExample(cmd_line_type *cmd_line);
+  ~TextDocumentExample();
+
+  void resize(int width, int height);
+  virtual void handle_event(FURYEvent::handle ev);
+  virtual void paint(void);
+
+private:
+  typedef WRATHLayerItemDrawerFactory<WRATHLayerItemNodeTranslate,
+                                      WRATHLayerNodeValuePackerUniformArrays> Factory;
+  typedef WRATHLayerTextDocument<WRATHLayerItemNodeTranslate> Document;
+
+  static
+  void
+  setup_stream(int pixel_size, WRATHTextDataStream &stream);
+
+  void
+  scroll(float delta);
+
+  cmd_line_type *m_cmd_line;
+  WRATHTripleBufferEnabler::handle m_tr;
+  WRATHLayer *m_layer;
+  WRATHLayerItemNodeTranslate *m_root, *m_document_node;
+  Document *m_document;
+
+  float m_scroll;
+  bool m_first_frame;
+  WRATHTime m_time;
+};
+
+DemoKernel*
+cmd_line_type::
+make_demo(void)
+{
+  return WRATHNew TextDocumentExample(this);
+}
+
+TextDocumentExample::
+TextDocumentExample(cmd_line_type *cmd_line):
+  DemoKernel(cmd_line),
+  m_cmd_line(cmd_line),
+  m_scroll(0.0f),
+  m_first_frame(true)
+{
+  Document::parameters params;
+  std::string text;
+  WRATHTime timer;
+  int32_t read_ms, open_ms;
+
+  m_tr=WRATHNew WRATHTripleBufferEnabler();
+  m_layer=WRATHNew WRATHLayer(m_tr);
+
+  float_orthogonal_projection_params proj_params(0, width(), height(), 0);
+  m_layer->simulation_matrix(WRATHLayer::projection_matrix, float4x4(proj_params));
+
+  m_root=WRATHNew WRATHLayerItemNodeTranslate(m_tr);
+  m_document_node=WRATHNew WRATHLayerItemNodeTranslate(m_root);
+
+  params.m_chunk_size=m_cmd_line->m_chunk_size.m_value;
+  params.m_estimated_line_height=static_cast<float>(m_cmd_line->m_pixel_size.m_value);
+  params.m_estimated_width=static_cast<float>(width());
+  params.m_stream_setup=boost::bind(&TextDocumentExample::setup_stream,
+                                    m_cmd_line->m_pixel_size.m_value, _1);
+  m_document=WRATHNew Document(m_document_node, m_layer, Factory(), 0, params);
+
+  /*
+    read or generate the text
+   */
+  timer.restart();
+  if(!m_cmd_line->m_file.m_value.empty())
+    {
+      std::ifstream file(m_cmd_line->m_file.m_value.c_str(), std::ios::binary);
+      text.assign(std::istreambuf_iterator<char>(file),
+                  std::istreambuf_iterator<char>());
+    }
+  else
+    {
+      std::ostringstream ostr;
+      for(int l=0; l<m_cmd_line->m_generate_lines.m_value; ++l)
+        {
+          ostr << "Line " << l
+               << ": the quick brown fox jumps over the lazy dog\n";
+        }
+      text=ostr.str();
+    }
+  read_ms=timer.elapsed();
+
+  timer.restart();
+  m_document->append_utf8(text);
+  open_ms=timer.elapsed();
+
+  std::cout << "Read " << text.size() << " bytes in " << read_ms << " ms\n"
+            << "Opened document in " << open_ms << " ms: "
+            << m_document->number_chunks() << " chunks\n";
+
+  WRATHGLStateShadow::clear_color(vec4(1.0f, 1.0f, 1.0f, 1.0f));
+}
+
+TextDocumentExample::
+~TextDocumentExample()
+{
+  WRATHDelete(m_document);
+  WRATHPhasedDelete(m_root);
+  WRATHPhasedDelete(m_layer);
+  WRATHResourceManagerBase::clear_all_resource_managers();
+  m_tr->purge_cleanup();
+  m_tr=NULL;
+}
+
+void
+TextDocumentExample::
+setup_stream(int pixel_size, WRATHTextDataStream &stream)
+{
+  stream.stream() << WRATHText::set_pixel_size(pixel_size)
+                  << WRATHText::set_color(0, 0, 0);
+}
+
+void
+TextDocumentExample::
+scroll(float delta)
+{
+  Document::BBox box(m_document->bounding_box());
+  float max_scroll(0.0f);
+
+  if(!box.empty())
+    {
+      max_scroll=std::max(0.0f, box.max_corner().y() - static_cast<float>(height()));
+    }
+  m_scroll=std::min(max_scroll, std::max(0.0f, m_scroll + delta));
+  m_document_node->translation(vec2(0.0f, -m_scroll));
+  update_widget();
+}
+
+void
+TextDocumentExample::
+resize(int width, int height)
+{
+  float_orthogonal_projection_params proj_params(0, width, height, 0);
+  m_layer->simulation_matrix(WRATHLayer::projection_matrix, float4x4(proj_params));
+  WRATHGLStateShadow::viewport(vecN<GLint, 4>(0, 0, width, height));
+}
+
+void
+TextDocumentExample::
+paint(void)
+{
+  WRATHTime timer;
+
+  if(m_cmd_line->m_auto_scroll.m_value>0.0f)
+    {
+      scroll(m_cmd_line->m_auto_scroll.m_value*static_cast<float>(m_time.restart()));
+    }
+
+  /*
+    the view in the coordinates of the root
+    node, i.e. the window
+   */
+  m_document->update(Document::BBox(vec2(0.0f, 0.0f),
+                                    vec2(width(), height())));
+
+  m_tr->signal_complete_simulation_frame();
+  m_tr->signal_begin_presentation_frame();
+  m_layer->clear_and_draw();
+
+  if(m_first_frame)
+    {
+      m_first_frame=false;
+      std::cout << "First frame in " << timer.elapsed() << " ms: "
+                << m_document->number_loaded_chunks() << " chunks formatted\n";
+    }
+
+  if(m_cmd_line->m_auto_scroll.m_value>0.0f)
+    {
+      update_widget();
+    }
+}
+
+void
+TextDocumentExample::
+handle_event(FURYEvent::handle ev)
+{
+  switch(ev->type())
+    {
+    case FURYEvent::Resize:
+      {
+        FURYResizeEvent::handle rev(ev.static_cast_handle<FURYResizeEvent>());
+        resize(rev->new_size().x(), rev->new_size().y());
+      }
+      break;
+
+    case FURYEvent::MouseWheel:
+      {
+        FURYMouseWheelEvent::handle wev(ev.static_cast_handle<FURYMouseWheelEvent>());
+        scroll(-3.0f*m_document->estimated_line_height()*static_cast<float>(wev->scroll().y()));
+        ev->accept();
+      }
+      break;
+
+    case FURYEvent::KeyDown:
+      {
+        FURYKeyEvent::handle qe(ev.static_cast_handle<FURYKeyEvent>());
+        switch(qe->key().m_value)
+          {
+          case FURYKey_Up:
+            scroll(-m_document->estimated_line_height());
+            ev->accept();
+            break;
+
+          case FURYKey_Down:
+            scroll(m_document->estimated_line_height());
+            ev->accept();
+            break;
+          }
+      }
+      break;
+
+    default:
+      break;
+    }
+}
+
+int
+main(int argc, char **argv)
+{
+  cmd_line_type cmd_line;
+  return cmd_line.main(argc, argv);
+}
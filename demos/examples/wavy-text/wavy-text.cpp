@@ -318,7 +318,7 @@ WavyTextExample(cmd_line_type *cmd_line):
   m_text_widget->m_wobble_freq=2.0f;
    
                     
-  glClearColor(0.0, 0.0, 0.0, 0.0);
+  WRATHGLStateShadow::clear_color(vec4(0.0, 0.0, 0.0, 0.0));
 }
 
 WavyTextExample::
@@ -348,7 +348,7 @@ resize(int width, int height)
 {
   float_orthogonal_projection_params proj_params(0, width, height, 0);
   m_layer->simulation_matrix(WRATHLayer::projection_matrix, float4x4(proj_params));
-  glViewport(0, 0, width, height);
+  WRATHGLStateShadow::viewport(vecN<GLint, 4>(0, 0, width, height));
 }
 
 void
@@ -1103,10 +1103,10 @@ DemoImage(cmd_line_type &pcmd_line):
 
       velocities[i]*=mul[i&1];
     }
-  glClearColor( static_cast<float>(cmd_line.m_bg_red.m_value)/255.0f,
-                static_cast<float>(cmd_line.m_bg_green.m_value)/255.0f,
-                static_cast<float>(cmd_line.m_bg_blue.m_value)/255.0f,
-                static_cast<float>(cmd_line.m_bg_alpha.m_value)/255.0f);
+  WRATHGLStateShadow::clear_color(vec4(static_cast<float>(cmd_line.m_bg_red.m_value)/255.0f,
+                                       static_cast<float>(cmd_line.m_bg_green.m_value)/255.0f,
+                                       static_cast<float>(cmd_line.m_bg_blue.m_value)/255.0f,
+                                       static_cast<float>(cmd_line.m_bg_alpha.m_value)/255.0f));
 
  
   update_widget();
@@ -1120,7 +1120,7 @@ paint(void)
      or window_size.y()!=height())
     {
       window_size=ivec2(width(), height());
-      glViewport(0, 0, window_size.x(), window_size.y());
+      WRATHGLStateShadow::viewport(vecN<GLint, 4>(0, 0, window_size.x(), window_size.y()));
       set_perspetive_matrix();      
     }
   
@@ -0,0 +1,51 @@
+# Begin standard header
+sp 		:= $(sp).x
+dirstack_$(sp)	:= $(d)
+d		:= $(dir)
+# End standard header
+
+DEMOS_INCLUDES += -I$(d)
+
+dir := $(d)/text_pack_benchmark
+include $(dir)/Rules.mk
+
+dir := $(d)/gl_state_shadow_test
+include $(dir)/Rules.mk
+
+dir := $(d)/buffer_stream_test
+include $(dir)/Rules.mk
+
+dir := $(d)/event_queue_test
+include $(dir)/Rules.mk
+
+dir := $(d)/coverage_mipmap_test
+include $(dir)/Rules.mk
+
+dir := $(d)/action_queue_benchmark
+include $(dir)/Rules.mk
+
+dir := $(d)/frame_signal_benchmark
+include $(dir)/Rules.mk
+
+dir := $(d)/shape_payload_test
+include $(dir)/Rules.mk
+
+dir := $(d)/text_append_test
+include $(dir)/Rules.mk
+
+dir := $(d)/text_format_benchmark
+include $(dir)/Rules.mk
+
+dir := $(d)/gradient_test
+include $(dir)/Rules.mk
+
+dir := $(d)/shape_tolerance_test
+include $(dir)/Rules.mk
+
+dir := $(d)/compact_text_test
+include $(dir)/Rules.mk
+
+# Begin standard footer
+d		:= $(dirstack_$(sp))
+sp		:= $(basename $(sp))
+# End standard footer
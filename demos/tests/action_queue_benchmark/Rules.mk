@@ -0,0 +1,14 @@
+# Begin standard header
+sp 		:= $(sp).x
+dirstack_$(sp)	:= $(d)
+d		:= $(dir)
+# End standard header
+
+DEMOS += action_queue_benchmark
+
+action_queue_benchmark_SOURCES := $(call filelist, action_queue_benchmark.cpp)
+
+# Begin standard footer
+d		:= $(dirstack_$(sp))
+sp		:= $(basename $(sp))
+# End standard footer
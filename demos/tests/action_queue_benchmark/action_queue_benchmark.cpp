@@ -0,0 +1,406 @@
+/*!
+ * \file action_queue_benchmark.cpp
+ * \brief file action_queue_benchmark.cpp
+ *
+ * Copyright 2013 by Nomovok Ltd.
+ *
+ * Contact: info@nomovok.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ *
+ */
+
+
+#include "WRATHConfig.hpp"
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <list>
+#include <cstdlib>
+#include <algorithm>
+#include <pthread.h>
+
+#include "WRATHNew.hpp"
+#include "WRATHTime.hpp"
+#include "WRATHMutex.hpp"
+#include "WRATHatomic.hpp"
+#include "WRATHActionQueue.hpp"
+
+/*
+  Stress test and benchmark of WRATHActionQueue, the
+  queue behind WRATHTripleBufferEnabler::schedule_rendering_action()
+  and schedule_simulation_action(): several producer
+  threads schedule actions while one consumer thread
+  executes them. It checks that
+  - every action is executed exactly once,
+  - the actions of each producer are executed in
+    the order that producer scheduled them,
+  - actions too large to be stored inline (which
+    go through the heap) are executed too,
+  - an action scheduled by an executing action
+    runs on the next execute_actions().
+  The same load is then run through a queue made of
+  a mutex and a std::list of heap allocated actions,
+  i.e. how the actions were queued before, and the
+  time of both is printed.
+
+  Usage: action_queue_benchmark [threads] [actions_per_thread]
+  The program exits with 0 if all checks pass.
+ */
+
+namespace
+{
+  /*
+    state checked by the consumer, only
+    touched by the consumer thread.
+   */
+  class consumer_state
+  {
+  public:
+    explicit
+    consumer_state(int number_producers):
+      m_next_sequence(number_producers, 0),
+      m_executed(0),
+      m_out_of_order(0)
+    {}
+
+    void
+    record(int producer, int sequence)
+    {
+      if(m_next_sequence[producer]!=sequence)
+        {
+          ++m_out_of_order;
+        }
+      m_next_sequence[producer]=sequence+1;
+      ++m_executed;
+    }
+
+    std::vector<int> m_next_sequence;
+    int m_executed;
+    int m_out_of_order;
+  };
+
+  class small_action
+  {
+  public:
+    small_action(consumer_state *st, int producer, int sequence):
+      m_state(st),
+      m_producer(producer),
+      m_sequence(sequence)
+    {}
+
+    void
+    operator()(void)
+    {
+      m_state->record(m_producer, m_sequence);
+    }
+
+    consumer_state *m_state;
+    int m_producer, m_sequence;
+  };
+
+  /*
+    too large to be stored inline
+    in a WRATHActionQueue chunk.
+   */
+  class large_action:public small_action
+  {
+  public:
+    large_action(consumer_state *st, int producer, int sequence):
+      small_action(st, producer, sequence)
+    {
+      m_payload[0]=static_cast<char>(sequence);
+    }
+
+    void
+    operator()(void)
+    {
+      small_action::operator()();
+    }
+
+    char m_payload[2048];
+  };
+
+  /*
+    the queue as it was before WRATHActionQueue:
+    a heap allocated action per call pushed on
+    a std::list under a mutex.
+   */
+  class locked_list_queue
+  {
+  public:
+    ~locked_list_queue()
+    {
+      for(std::list<base_action*>::iterator iter=m_actions.begin(),
+            end=m_actions.end(); iter!=end; ++iter)
+        {
+          WRATHDelete(*iter);
+        }
+    }
+
+    template<typename T>
+    void
+    schedule(const T &v)
+    {
+      base_action *a;
+
+      a=WRATHNew action<T>(v);
+      WRATHLockMutex(m_mutex);
+      m_actions.push_back(a);
+      WRATHUnlockMutex(m_mutex);
+    }
+
+    int
+    execute_actions(void)
+    {
+      std::list<base_action*> actions;
+      int return_value(0);
+
+      WRATHLockMutex(m_mutex);
+      std::swap(actions, m_actions);
+      WRATHUnlockMutex(m_mutex);
+
+      for(std::list<base_action*>::iterator iter=actions.begin(),
+            end=actions.end(); iter!=end; ++iter, ++return_value)
+        {
+          (*iter)->execute();
+          WRATHDelete(*iter);
+        }
+      return return_value;
+    }
+
+  private:
+    class base_action
+    {
+    public:
+      virtual
+      ~base_action()
+      {}
+
+      virtual
+      void
+      execute(void)=0;
+    };
+
+    template<typename T>
+    class action:public base_action
+    {
+    public:
+      explicit
+      action(const T &v):
+        m_value(v)
+      {}
+
+      virtual
+      void
+      execute(void)
+      {
+        m_value();
+      }
+
+      T m_value;
+    };
+
+    WRATHMutex m_mutex;
+    std::list<base_action*> m_actions;
+  };
+
+  template<typename Q>
+  class producer_data
+  {
+  public:
+    Q *m_queue;
+    consumer_state *m_state;
+    int m_producer;
+    int m_number_actions;
+    int m_large_every;
+    int *m_number_done;
+  };
+
+  template<typename Q>
+  void*
+  producer_main(void *ptr)
+  {
+    producer_data<Q> *d(static_cast<producer_data<Q>*>(ptr));
+
+    for(int i=0; i<d->m_number_actions; ++i)
+      {
+        if(d->m_large_every>0 and (i%d->m_large_every)==0)
+          {
+            d->m_queue->schedule(large_action(d->m_state, d->m_producer, i));
+          }
+        else
+          {
+            d->m_queue->schedule(small_action(d->m_state, d->m_producer, i));
+          }
+      }
+    WRATHAtomicAddAndFetch(d->m_number_done, 1);
+    return NULL;
+  }
+
+  /*
+    runs the producers against a consumer on the
+    calling thread, returns the time in ms.
+   */
+  template<typename Q>
+  int32_t
+  run(Q &queue, consumer_state &st, int number_threads,
+      int actions_per_thread, int large_every)
+  {
+    std::vector<producer_data<Q> > data(number_threads);
+    std::vector<pthread_t> threads(number_threads);
+    int number_done(0);
+    WRATHTime timer;
+
+    timer.restart();
+    for(int t=0; t<number_threads; ++t)
+      {
+        data[t].m_queue=&queue;
+        data[t].m_state=&st;
+        data[t].m_producer=t;
+        data[t].m_number_actions=actions_per_thread;
+        data[t].m_large_every=large_every;
+        data[t].m_number_done=&number_done;
+        pthread_create(&threads[t], NULL, producer_main<Q>, &data[t]);
+      }
+
+    /*
+      execute while the producers are running,
+      then once more for the actions scheduled
+      after the last call.
+     */
+    while(WRATHAtomicLoad(&number_done)<number_threads)
+      {
+        queue.execute_actions();
+      }
+    queue.execute_actions();
+
+    for(int t=0; t<number_threads; ++t)
+      {
+        pthread_join(threads[t], NULL);
+      }
+    return timer.elapsed();
+  }
+
+  class reschedule_action
+  {
+  public:
+    reschedule_action(WRATHActionQueue *q, int *count):
+      m_queue(q),
+      m_count(count)
+    {}
+
+    void
+    operator()(void)
+    {
+      ++*m_count;
+      if(*m_count==1)
+        {
+          m_queue->schedule(*this);
+        }
+    }
+
+    WRATHActionQueue *m_queue;
+    int *m_count;
+  };
+
+  class test_state
+  {
+  public:
+    test_state(void):
+      m_failures(0)
+    {}
+
+    void
+    check(bool v, const std::string &label)
+    {
+      if(!v)
+        {
+          ++m_failures;
+          std::cout << "action_queue_benchmark: check failed: " << label << "\n";
+        }
+    }
+
+    int m_failures;
+  };
+}
+
+int
+main(int argc, char **argv)
+{
+  int number_threads(4), actions_per_thread(100000);
+  test_state st;
+  int32_t queue_ms, list_ms;
+
+  if(argc>1)
+    {
+      number_threads=std::max(1, std::atoi(argv[1]));
+    }
+  if(argc>2)
+    {
+      actions_per_thread=std::max(1, std::atoi(argv[2]));
+    }
+
+  /*
+    checks
+   */
+  {
+    WRATHActionQueue queue;
+    consumer_state cst(number_threads);
+    int count(0);
+
+    run(queue, cst, number_threads, actions_per_thread/10, 97);
+    st.check(cst.m_executed==number_threads*(actions_per_thread/10),
+             "every action is executed exactly once");
+    st.check(cst.m_out_of_order==0, "actions of a producer are executed in order");
+    st.check(queue.empty(), "queue is empty after executing");
+
+    queue.schedule(reschedule_action(&queue, &count));
+    queue.execute_actions();
+    st.check(count==1 and !queue.empty(),
+             "an action scheduled by an action waits for the next execute_actions()");
+    queue.execute_actions();
+    st.check(count==2 and queue.empty(),
+             "an action scheduled by an action runs on the next execute_actions()");
+  }
+
+  /*
+    timing, small actions only
+   */
+  {
+    WRATHActionQueue queue;
+    consumer_state cst(number_threads);
+
+    queue_ms=run(queue, cst, number_threads, actions_per_thread, 0);
+    st.check(cst.m_executed==number_threads*actions_per_thread and cst.m_out_of_order==0,
+             "timed run of WRATHActionQueue");
+  }
+
+  {
+    locked_list_queue queue;
+    consumer_state cst(number_threads);
+
+    list_ms=run(queue, cst, number_threads, actions_per_thread, 0);
+    st.check(cst.m_executed==number_threads*actions_per_thread and cst.m_out_of_order==0,
+             "timed run of mutex and std::list queue");
+  }
+
+  std::cout << number_threads << " producer threads, "
+            << actions_per_thread << " actions each:"
+            << "\n\tWRATHActionQueue: " << queue_ms << " ms"
+            << "\n\tmutex and std::list: " << list_ms << " ms";
+  if(queue_ms>0)
+    {
+      std::cout << " (speedup " << static_cast<float>(list_ms)/static_cast<float>(queue_ms) << ")";
+    }
+  std::cout << "\naction_queue_benchmark: "
+            << ((st.m_failures==0)?"PASSED":"FAILED") << "\n";
+
+  return (st.m_failures==0)?0:-1;
+}
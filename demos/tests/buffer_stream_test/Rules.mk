@@ -0,0 +1,14 @@
+# Begin standard header
+sp 		:= $(sp).x
+dirstack_$(sp)	:= $(d)
+d		:= $(dir)
+# End standard header
+
+DEMOS += buffer_stream_test
+
+buffer_stream_test_SOURCES := $(call filelist, buffer_stream_test.cpp)
+
+# Begin standard footer
+d		:= $(dirstack_$(sp))
+sp		:= $(basename $(sp))
+# End standard footer
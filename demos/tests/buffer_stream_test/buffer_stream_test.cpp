@@ -0,0 +1,382 @@
+/*!
+ * \file buffer_stream_test.cpp
+ * \brief file buffer_stream_test.cpp
+ *
+ * Copyright 2013 by Nomovok Ltd.
+ *
+ * Contact: info@nomovok.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ *
+ */
+
+
+#include "WRATHConfig.hpp"
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <set>
+#include <cstring>
+
+#include "WRATHNew.hpp"
+#include "WRATHgl.hpp"
+#include "WRATHBufferObject.hpp"
+#include "WRATHAttributeStore.hpp"
+#include "WRATHTextItemTypes.hpp"
+
+#include "ngl_backend.hpp"
+
+/*
+  Checks the uploads of WRATHBufferObject in each
+  streaming mode (see WRATHBufferObject::stream_buffer_count(int))
+  without a GL context: the GL buffer functions are remapped
+  with ngl_functionPointer to functions that record the calls
+  and keep a copy of the contents of each buffer object. For
+  each mode it checks that
+  - the GL buffer the WRATHBufferObject names holds its
+    contents after each flush,
+  - a flush without changes issues no GL calls,
+  - mode 0 uploads only the dirty range with glBufferSubData,
+  - mode 1 orphans with glBufferData(NULL) before each upload,
+  - mode N>1 uploads to the N buffers in turn, so that an
+    upload never writes to the buffers of the previous N-1
+    frames, and allocates storage of a buffer only when it
+    grows,
+  - all GL buffers are deleted with the WRATHBufferObject.
+  The program exits with 0 if all checks pass.
+ */
+
+namespace
+{
+  class gl_buffer_recorder
+  {
+  public:
+    gl_buffer_recorder(void):
+      m_next_name(1),
+      m_bound(0)
+    {
+      reset_counts();
+    }
+
+    void
+    reset_counts(void)
+    {
+      m_gen_count=0;
+      m_delete_count=0;
+      m_bind_count=0;
+      m_buffer_data_count=0;
+      m_orphan_count=0;
+      m_buffer_sub_data_count=0;
+      m_sub_data_bytes=0;
+      m_written.clear();
+    }
+
+    std::map<GLuint, std::vector<uint8_t> > m_buffers;
+    GLuint m_next_name, m_bound;
+
+    int m_gen_count, m_delete_count, m_bind_count;
+    int m_buffer_data_count, m_orphan_count;
+    int m_buffer_sub_data_count, m_sub_data_bytes;
+
+    /*
+      buffers written to since the last reset_counts()
+     */
+    std::set<GLuint> m_written;
+  };
+
+  gl_buffer_recorder&
+  recorder(void)
+  {
+    static gl_buffer_recorder R;
+    return R;
+  }
+
+  void
+  record_glGenBuffers(GLsizei n, GLuint *names)
+  {
+    for(GLsizei i=0; i<n; ++i, ++names)
+      {
+        *names=recorder().m_next_name++;
+        recorder().m_buffers[*names]=std::vector<uint8_t>();
+      }
+    ++recorder().m_gen_count;
+  }
+
+  void
+  record_glDeleteBuffers(GLsizei n, const GLuint *names)
+  {
+    for(GLsizei i=0; i<n; ++i, ++names)
+      {
+        recorder().m_buffers.erase(*names);
+      }
+    ++recorder().m_delete_count;
+  }
+
+  void
+  record_glBindBuffer(GLenum target, GLuint name)
+  {
+    WRATHassert(target==GL_ARRAY_BUFFER);
+    WRATHunused(target);
+    recorder().m_bound=name;
+    ++recorder().m_bind_count;
+  }
+
+  void
+  record_glBufferData(GLenum target, GLsizeiptr size, const GLvoid *data, GLenum usage)
+  {
+    std::vector<uint8_t> &buffer(recorder().m_buffers[recorder().m_bound]);
+
+    WRATHunused(target);
+    WRATHunused(usage);
+
+    buffer.resize(size);
+    if(data!=NULL)
+      {
+        std::memcpy(&buffer[0], data, size);
+      }
+    else
+      {
+        std::fill(buffer.begin(), buffer.end(), 0xAA);
+        ++recorder().m_orphan_count;
+      }
+    recorder().m_written.insert(recorder().m_bound);
+    ++recorder().m_buffer_data_count;
+  }
+
+  void
+  record_glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid *data)
+  {
+    std::vector<uint8_t> &buffer(recorder().m_buffers[recorder().m_bound]);
+
+    WRATHunused(target);
+    WRATHassert(offset+size<=static_cast<GLintptr>(buffer.size()));
+    std::memcpy(&buffer[offset], data, size);
+    recorder().m_written.insert(recorder().m_bound);
+    recorder().m_sub_data_bytes+=size;
+    ++recorder().m_buffer_sub_data_count;
+  }
+
+  GLenum
+  record_glGetError(void)
+  {
+    return GL_NO_ERROR;
+  }
+
+  class test_state
+  {
+  public:
+    test_state(void):
+      m_failures(0)
+    {}
+
+    void
+    check(bool v, int mode, const std::string &label)
+    {
+      if(!v)
+        {
+          ++m_failures;
+          std::cout << "buffer_stream_test: stream_buffer_count("
+                    << mode << "): check failed: " << label << "\n";
+        }
+    }
+
+    int m_failures;
+  };
+
+  void
+  write_pattern(WRATHBufferObject *bo, int begin, int end, int frame)
+  {
+    for(int i=begin; i<end; ++i)
+      {
+        *bo->c_ptr(i)=static_cast<uint8_t>(i*7 + frame*13);
+      }
+    bo->mark_bytes_dirty(begin, end);
+  }
+
+  bool
+  gl_buffer_matches(WRATHBufferObject *bo)
+  {
+    std::map<GLuint, std::vector<uint8_t> >::const_iterator iter;
+
+    iter=recorder().m_buffers.find(bo->name());
+    return iter!=recorder().m_buffers.end()
+      and static_cast<int>(iter->second.size())>=bo->size()
+      and std::memcmp(&iter->second[0], bo->c_ptr(0), bo->size())==0;
+  }
+
+  void
+  test_mode(const WRATHTripleBufferEnabler::handle &tr, int mode, test_state &st)
+  {
+    const int initial_size(256), grown_size(1024);
+    const int dirty_begin(16), dirty_end(48);
+    WRATHBufferObject *bo;
+    std::vector<GLuint> frame_names;
+    int number_frames;
+
+    recorder().reset_counts();
+
+    bo=WRATHNew WRATHBufferObject(tr, GL_STREAM_DRAW);
+    bo->stream_buffer_count(mode);
+    bo->resize(initial_size);
+    write_pattern(bo, 0, initial_size, 0);
+
+    /*
+      first upload
+     */
+    bo->flush(GL_ARRAY_BUFFER);
+    st.check(gl_buffer_matches(bo), mode, "contents after first flush");
+    st.check(recorder().m_gen_count==1, mode, "one glGenBuffers call");
+    st.check(static_cast<int>(recorder().m_buffers.size())==std::max(1, mode),
+             mode, "number of GL buffers");
+
+    /*
+      flush without changes
+     */
+    recorder().reset_counts();
+    st.check(!bo->flush(GL_ARRAY_BUFFER), mode, "flush without changes returns false");
+    st.check(recorder().m_bind_count==0 and recorder().m_written.empty(),
+             mode, "flush without changes issues no GL calls");
+
+    /*
+      frames that change part of the buffer
+     */
+    number_frames=2*std::max(1, mode)+1;
+    frame_names.push_back(bo->name());
+    for(int f=1; f<=number_frames; ++f)
+      {
+        GLuint previous_name(bo->name());
+
+        recorder().reset_counts();
+        write_pattern(bo, dirty_begin, dirty_end, f);
+        bo->flush(GL_ARRAY_BUFFER);
+
+        st.check(gl_buffer_matches(bo), mode, "contents after partial change");
+        st.check(recorder().m_written.size()==1
+                 and *recorder().m_written.begin()==bo->name(),
+                 mode, "an upload writes only to the named buffer");
+
+        if(mode==0)
+          {
+            st.check(bo->name()==previous_name, mode, "name does not change");
+            st.check(recorder().m_buffer_data_count==0
+                     and recorder().m_buffer_sub_data_count==1
+                     and recorder().m_sub_data_bytes==dirty_end-dirty_begin,
+                     mode, "only the dirty range is uploaded with glBufferSubData");
+          }
+        else if(mode==1)
+          {
+            st.check(bo->name()==previous_name, mode, "name does not change");
+            st.check(recorder().m_orphan_count==1
+                     and recorder().m_buffer_data_count==1
+                     and recorder().m_sub_data_bytes==initial_size,
+                     mode, "store is orphaned and then uploaded whole");
+          }
+        else
+          {
+            /*
+              the buffers of the previous mode-1 frames
+              may still be read by the GPU.
+             */
+            for(int p=std::max(0, f-mode+1); p<f; ++p)
+              {
+                st.check(bo->name()!=frame_names[p], mode,
+                         "upload does not write a buffer of the previous frames");
+              }
+            st.check(recorder().m_orphan_count==0, mode, "ring buffer is never orphaned");
+            if(f<mode)
+              {
+                st.check(recorder().m_buffer_data_count==1, mode,
+                         "first use of a ring buffer allocates its storage");
+              }
+            else
+              {
+                st.check(recorder().m_buffer_data_count==0
+                         and recorder().m_sub_data_bytes==initial_size,
+                         mode, "later uses of a ring buffer upload with glBufferSubData");
+              }
+          }
+        frame_names.push_back(bo->name());
+      }
+
+    if(mode>1)
+      {
+        st.check(frame_names[0]==frame_names[mode], mode,
+                 "ring buffers are used in turn");
+      }
+
+    /*
+      growing the buffer
+     */
+    recorder().reset_counts();
+    bo->resize(grown_size);
+    write_pattern(bo, 0, grown_size, number_frames+1);
+    bo->flush(GL_ARRAY_BUFFER);
+    st.check(gl_buffer_matches(bo), mode, "contents after growing");
+    st.check(recorder().m_buffer_data_count==1, mode,
+             "growing allocates the storage of the written buffer");
+
+    std::cout << "\nstream_buffer_count(" << mode << "): "
+              << recorder().m_buffers.size() << " GL buffers, "
+              << number_frames << " frames uploaded "
+              << ((mode==0)?dirty_end-dirty_begin:initial_size)
+              << " bytes each";
+
+    /*
+      deletion
+     */
+    recorder().reset_counts();
+    WRATHPhasedDelete(bo);
+    tr->purge_cleanup();
+    st.check(recorder().m_buffers.empty(), mode, "all GL buffers deleted");
+    st.check(recorder().m_delete_count==1, mode, "one glDeleteBuffers call");
+  }
+}
+
+int
+main(int argc, char **argv)
+{
+  WRATHunused(argc);
+  WRATHunused(argv);
+
+  WRATHTripleBufferEnabler::handle tr;
+  test_state st;
+  WRATHAttributeStoreKey plain_key, stream_key;
+  WRATHTextItemTypes::TextExtraDrawState text_state;
+
+  ngl_functionPointer(glGenBuffers)=record_glGenBuffers;
+  ngl_functionPointer(glDeleteBuffers)=record_glDeleteBuffers;
+  ngl_functionPointer(glBindBuffer)=record_glBindBuffer;
+  ngl_functionPointer(glBufferData)=record_glBufferData;
+  ngl_functionPointer(glBufferSubData)=record_glBufferSubData;
+  ngl_functionPointer(glGetError)=record_glGetError;
+
+  tr=WRATHNew WRATHTripleBufferEnabler();
+  test_mode(tr, 0, st);
+  test_mode(tr, 1, st);
+  test_mode(tr, 3, st);
+  tr=NULL;
+
+  /*
+    streaming attribute data must not share
+    an attribute store with static data, and text
+    items default to no streaming.
+   */
+  stream_key.stream_buffer_count(3);
+  st.check(!(plain_key==stream_key) and (plain_key<stream_key or stream_key<plain_key),
+           3, "WRATHAttributeStoreKey distinguishes streaming stores");
+  st.check(text_state.m_stream_buffer_count==0
+           and text_state.stream_buffer_count(2).m_stream_buffer_count==2,
+           2, "TextExtraDrawState streaming opt-in");
+
+  std::cout << "\nbuffer_stream_test: "
+            << ((st.m_failures==0)?"PASSED":"FAILED") << "\n";
+
+  return (st.m_failures==0)?0:-1;
+}
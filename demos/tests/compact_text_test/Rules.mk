@@ -0,0 +1,14 @@
+# Begin standard header
+sp 		:= $(sp).x
+dirstack_$(sp)	:= $(d)
+d		:= $(dir)
+# End standard header
+
+DEMOS += compact_text_test
+
+compact_text_test_SOURCES := $(call filelist, compact_text_test.cpp) $(COMMON_DEMO_SOURCES)
+
+# Begin standard footer
+d		:= $(dirstack_$(sp))
+sp		:= $(basename $(sp))
+# End standard footer
@@ -0,0 +1,449 @@
+/*!
+ * \file compact_text_test.cpp
+ * \brief file compact_text_test.cpp
+ *
+ * Copyright 2013 by Nomovok Ltd.
+ *
+ * Contact: info@nomovok.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ *
+ */
+
+
+#include "WRATHConfig.hpp"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+#include "WRATHNew.hpp"
+#include "WRATHgl.hpp"
+#include "WRATHTextDataStream.hpp"
+#include "WRATHLayerItemWidgetsTranslate.hpp"
+#include "WRATHDefaultTextAttributePacker.hpp"
+#include "WRATHCompactTextAttributePacker.hpp"
+#include "WRATHFontShaderSpecifier.hpp"
+
+#include "ngl_backend.hpp"
+#include "wrath_test.hpp"
+
+/*
+  Measures the bytes sent to GL to draw the same text with
+  the default text packer, the compact packer and the
+  instanced compact packer (one attribute per glyph, no
+  indices, glyph size and texture location in a per-font
+  table), each in full and half precision. Each packer
+  draws the text in its own WRATHLayer once; while the
+  layer draws, glBufferData, glBufferSubData, the upload
+  of the glyph table and the draw calls are recorded by
+  remapping the GL functions with ngl_functionPointer to
+  functions that count and then call GL. The checks are that
+  - each packer draws without a GL error,
+  - the compact packer sends fewer attribute bytes
+    than the default packer,
+  - the instanced packer sends no indices, draws with
+    glDrawArraysInstanced only and sends fewer bytes
+    in total than the compact packer.
+  The instanced packers require GL 3.3 or GLES3.
+ */
+
+namespace
+{
+  class gl_upload_recorder
+  {
+  public:
+    gl_upload_recorder(void)
+    {
+      reset_counts();
+    }
+
+    void
+    reset_counts(void)
+    {
+      m_buffer_bytes=0;
+      m_element_buffer_bytes=0;
+      m_table_bytes=0;
+      m_draw_elements_count=0;
+      m_draw_instanced_count=0;
+    }
+
+    int m_buffer_bytes, m_element_buffer_bytes, m_table_bytes;
+    int m_draw_elements_count, m_draw_instanced_count;
+
+    void (*m_glBufferData)(GLenum, GLsizeiptr, const GLvoid*, GLenum);
+    void (*m_glBufferSubData)(GLenum, GLintptr, GLsizeiptr, const GLvoid*);
+    void (*m_glTexSubImage2D)(GLenum, GLint, GLint, GLint, GLsizei, GLsizei,
+                              GLenum, GLenum, const GLvoid*);
+    void (*m_glDrawElements)(GLenum, GLsizei, GLenum, const GLvoid*);
+
+    #if WRATH_GL_GLES_VERSION>=3
+    void (*m_glDrawArraysInstanced)(GLenum, GLint, GLsizei, GLsizei);
+    #endif
+  };
+
+  gl_upload_recorder&
+  recorder(void)
+  {
+    static gl_upload_recorder R;
+    return R;
+  }
+
+  void
+  add_buffer_bytes(GLenum target, GLsizeiptr size)
+  {
+    if(target==GL_ELEMENT_ARRAY_BUFFER)
+      {
+        recorder().m_element_buffer_bytes+=size;
+      }
+    else
+      {
+        recorder().m_buffer_bytes+=size;
+      }
+  }
+
+  void
+  record_glBufferData(GLenum target, GLsizeiptr size, const GLvoid *data, GLenum usage)
+  {
+    /*
+      glBufferData with NULL only allocates
+      (or orphans) storage, nothing is sent.
+     */
+    if(data!=NULL)
+      {
+        add_buffer_bytes(target, size);
+      }
+    recorder().m_glBufferData(target, size, data, usage);
+  }
+
+  void
+  record_glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid *data)
+  {
+    add_buffer_bytes(target, size);
+    recorder().m_glBufferSubData(target, offset, size, data);
+  }
+
+  void
+  record_glTexSubImage2D(GLenum target, GLint level, GLint x, GLint y,
+                         GLsizei w, GLsizei h, GLenum format, GLenum type,
+                         const GLvoid *pixels)
+  {
+    #if WRATH_GL_GLES_VERSION>=3
+    {
+      /*
+        the glyph table of the instanced packer is
+        the only GL_RGBA_INTEGER texture, glyph
+        textures are not counted.
+       */
+      if(format==GL_RGBA_INTEGER and type==GL_UNSIGNED_SHORT)
+        {
+          recorder().m_table_bytes+=w*h*4*sizeof(GLushort);
+        }
+    }
+    #endif
+    recorder().m_glTexSubImage2D(target, level, x, y, w, h, format, type, pixels);
+  }
+
+  void
+  record_glDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid *indices)
+  {
+    ++recorder().m_draw_elements_count;
+    recorder().m_glDrawElements(mode, count, type, indices);
+  }
+
+  #if WRATH_GL_GLES_VERSION>=3
+  void
+  record_glDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances)
+  {
+    ++recorder().m_draw_instanced_count;
+    recorder().m_glDrawArraysInstanced(mode, first, count, instances);
+  }
+  #endif
+
+  void
+  begin_recording(void)
+  {
+    recorder().reset_counts();
+
+    recorder().m_glBufferData=ngl_functionPointer(glBufferData);
+    recorder().m_glBufferSubData=ngl_functionPointer(glBufferSubData);
+    recorder().m_glTexSubImage2D=ngl_functionPointer(glTexSubImage2D);
+    recorder().m_glDrawElements=ngl_functionPointer(glDrawElements);
+
+    ngl_functionPointer(glBufferData)=record_glBufferData;
+    ngl_functionPointer(glBufferSubData)=record_glBufferSubData;
+    ngl_functionPointer(glTexSubImage2D)=record_glTexSubImage2D;
+    ngl_functionPointer(glDrawElements)=record_glDrawElements;
+
+    #if WRATH_GL_GLES_VERSION>=3
+    {
+      recorder().m_glDrawArraysInstanced=ngl_functionPointer(glDrawArraysInstanced);
+      ngl_functionPointer(glDrawArraysInstanced)=record_glDrawArraysInstanced;
+    }
+    #endif
+  }
+
+  void
+  end_recording(void)
+  {
+    ngl_functionPointer(glBufferData)=recorder().m_glBufferData;
+    ngl_functionPointer(glBufferSubData)=recorder().m_glBufferSubData;
+    ngl_functionPointer(glTexSubImage2D)=recorder().m_glTexSubImage2D;
+    ngl_functionPointer(glDrawElements)=recorder().m_glDrawElements;
+
+    #if WRATH_GL_GLES_VERSION>=3
+    {
+      ngl_functionPointer(glDrawArraysInstanced)=recorder().m_glDrawArraysInstanced;
+    }
+    #endif
+  }
+
+  class result
+  {
+  public:
+    result(void):
+      m_attribute_bytes(0),
+      m_index_bytes(0),
+      m_table_bytes(0),
+      m_draw_elements_count(0),
+      m_draw_instanced_count(0),
+      m_gl_error(GL_NO_ERROR)
+    {}
+
+    int
+    total_bytes(void) const
+    {
+      return m_attribute_bytes + m_index_bytes + m_table_bytes;
+    }
+
+    int m_attribute_bytes, m_index_bytes, m_table_bytes;
+    int m_draw_elements_count, m_draw_instanced_count;
+    GLenum m_gl_error;
+  };
+}
+
+class cmd_line_type:public DemoKernelMaker
+{
+public:
+  command_line_argument_value<int> m_number_lines;
+
+  cmd_line_type(void):
+    m_number_lines(40, "lines", "Number of lines of text", *this)
+  {}
+
+  virtual
+  DemoKernel*
+  make_demo(void);
+
+  virtual
+  void
+  delete_demo(DemoKernel *k)
+  {
+    if(k!=NULL)
+      {
+        WRATHDelete(k);
+      }
+  }
+};
+
+class CompactTextTest:public TestKernel
+{
+public:
+  CompactTextTest(cmd_line_type *cmd_line);
+  ~CompactTextTest();
+
+protected:
+  virtual
+  void
+  run_test(void);
+
+private:
+  typedef WRATHLayerTranslateFamilySet::PlainFamily::TextWidget TextWidget;
+
+  result
+  measure(const WRATHTextItemTypes::TextDrawerPacker &drawer);
+
+  void
+  report(const std::string &label, const result &R, int number_glyphs);
+
+  cmd_line_type *m_cmd_line;
+  WRATHTripleBufferEnabler::handle m_tr;
+  WRATHTextDataStream m_text;
+};
+
+DemoKernel*
+cmd_line_type::
+make_demo(void)
+{
+  return WRATHNew CompactTextTest(this);
+}
+
+CompactTextTest::
+CompactTextTest(cmd_line_type *cmd_line):
+  TestKernel(cmd_line, "compact_text_test"),
+  m_cmd_line(cmd_line)
+{
+  m_tr=WRATHNew WRATHTripleBufferEnabler();
+}
+
+CompactTextTest::
+~CompactTextTest()
+{
+  WRATHResourceManagerBase::clear_all_resource_managers();
+  m_tr->purge_cleanup();
+  m_tr=NULL;
+}
+
+result
+CompactTextTest::
+measure(const WRATHTextItemTypes::TextDrawerPacker &drawer)
+{
+  WRATHLayer *layer;
+  TextWidget *item;
+  result R;
+  float_orthogonal_projection_params proj_params(0, width(), height(), 0);
+
+  layer=WRATHNew WRATHLayer(m_tr);
+  layer->simulation_matrix(WRATHLayer::projection_matrix, float4x4(proj_params));
+
+  item=WRATHNew TextWidget(layer, WRATHTextItemTypes::text_transparent,
+                           drawer, WRATHTextItem::draw_order(),
+                           WRATHTextItem::ExtraDrawState());
+  item->add_text(m_text);
+
+  m_tr->signal_complete_simulation_frame();
+  m_tr->signal_begin_presentation_frame();
+
+  while(glGetError()!=GL_NO_ERROR)
+    {}
+
+  begin_recording();
+  layer->draw();
+  end_recording();
+
+  R.m_gl_error=glGetError();
+  R.m_attribute_bytes=recorder().m_buffer_bytes;
+  R.m_index_bytes=recorder().m_element_buffer_bytes;
+  R.m_table_bytes=recorder().m_table_bytes;
+  R.m_draw_elements_count=recorder().m_draw_elements_count;
+  R.m_draw_instanced_count=recorder().m_draw_instanced_count;
+
+  WRATHDelete(item);
+  WRATHPhasedDelete(layer);
+  return R;
+}
+
+void
+CompactTextTest::
+report(const std::string &label, const result &R, int number_glyphs)
+{
+  std::cout << std::setw(24) << label
+            << std::setw(12) << R.m_attribute_bytes
+            << std::setw(10) << R.m_index_bytes
+            << std::setw(8) << R.m_table_bytes
+            << std::setw(10) << R.total_bytes();
+  if(number_glyphs>0)
+    {
+      std::cout << std::setw(12)
+                << static_cast<float>(R.total_bytes())/static_cast<float>(number_glyphs);
+    }
+  std::cout << "\n";
+
+  check(R.m_gl_error==GL_NO_ERROR, label + ": draws without a GL error");
+}
+
+void
+CompactTextTest::
+run_test(void)
+{
+  int number_glyphs;
+  vecN<result, 2> default_result, compact_result;
+  vecN<enum WRATHAttributePacker::attribute_format_type, 2> fmts;
+  vecN<std::string, 2> fmt_labels;
+
+  fmts[0]=WRATHAttributePacker::full_precision_format;
+  fmts[1]=WRATHAttributePacker::half_precision_format;
+  fmt_labels[0]="";
+  fmt_labels[1]=" half";
+
+  m_text.stream() << WRATHText::set_pixel_size(16)
+                  << WRATHText::set_color(0, 0, 0);
+  for(int l=0; l<m_cmd_line->m_number_lines.m_value; ++l)
+    {
+      m_text.stream() << "Line " << l
+                      << ": the quick brown fox jumps over the lazy dog\n";
+    }
+
+  /*
+    draw once with the default packer so that the
+    glyph textures are uploaded before recording.
+   */
+  measure(WRATHTextItemTypes::TextDrawerPacker());
+
+  number_glyphs=m_text.formatted_text().data_stream().size();
+  std::cout << "\nBytes sent to GL to draw " << number_glyphs << " glyphs:\n"
+            << std::setw(24) << "packer"
+            << std::setw(12) << "attributes"
+            << std::setw(10) << "indices"
+            << std::setw(8) << "table"
+            << std::setw(10) << "total"
+            << std::setw(12) << "per glyph" << "\n";
+
+  for(int f=0; f<2; ++f)
+    {
+      const WRATHTextAttributePacker *default_packer, *compact_packer;
+
+      default_packer=WRATHDefaultTextAttributePacker::fetch(WRATHDefaultTextAttributePacker::SingleQuadPacker,
+                                                            fmts[f]);
+      compact_packer=WRATHCompactTextAttributePacker::fetch(fmts[f]);
+
+      default_result[f]=measure(WRATHTextItemTypes::TextDrawerPacker(&WRATHFontShaderSpecifier::default_aa(),
+                                                                    default_packer));
+      report("default" + fmt_labels[f], default_result[f], number_glyphs);
+
+      compact_result[f]=measure(WRATHTextItemTypes::TextDrawerPacker(&WRATHFontShaderSpecifier::compact_aa(),
+                                                                    compact_packer));
+      report("compact" + fmt_labels[f], compact_result[f], number_glyphs);
+
+      check(compact_result[f].m_attribute_bytes<default_result[f].m_attribute_bytes,
+            "compact" + fmt_labels[f] + ": fewer attribute bytes than default");
+    }
+
+  #if WRATH_GL_GLES_VERSION>=3
+  {
+    for(int f=0; f<2; ++f)
+      {
+        result R;
+
+        R=measure(WRATHTextItemTypes::TextDrawerPacker(&WRATHFontShaderSpecifier::compact_instanced_aa(),
+                                                       WRATHCompactTextAttributePacker::fetch_instanced(fmts[f])));
+        report("compact instanced" + fmt_labels[f], R, number_glyphs);
+
+        check(R.m_index_bytes==0 and R.m_draw_elements_count==0,
+              "compact instanced" + fmt_labels[f] + ": no indices");
+        check(R.m_draw_instanced_count>0,
+              "compact instanced" + fmt_labels[f] + ": draws with glDrawArraysInstanced");
+        check(R.m_table_bytes>0,
+              "compact instanced" + fmt_labels[f] + ": glyph table uploaded");
+        check(R.total_bytes()<compact_result[f].total_bytes(),
+              "compact instanced" + fmt_labels[f] + ": fewer bytes than compact");
+      }
+  }
+  #else
+  {
+    std::cout << "compact instanced: requires GL 3.3 or GLES3, not measured\n";
+  }
+  #endif
+}
+
+int
+main(int argc, char **argv)
+{
+  cmd_line_type cmd_line;
+  return cmd_line.main(argc, argv);
+}
@@ -0,0 +1,14 @@
+# Begin standard header
+sp 		:= $(sp).x
+dirstack_$(sp)	:= $(d)
+d		:= $(dir)
+# End standard header
+
+DEMOS += coverage_mipmap_test
+
+coverage_mipmap_test_SOURCES := $(call filelist, coverage_mipmap_test.cpp) $(COMMON_DEMO_SOURCES)
+
+# Begin standard footer
+d		:= $(dirstack_$(sp))
+sp		:= $(basename $(sp))
+# End standard footer
@@ -0,0 +1,206 @@
+/*!
+ * \file coverage_mipmap_test.cpp
+ * \brief file coverage_mipmap_test.cpp
+ *
+ * Copyright 2013 by Nomovok Ltd.
+ *
+ * Contact: info@nomovok.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ *
+ */
+
+
+#include "WRATHConfig.hpp"
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "WRATHNew.hpp"
+#include "WRATHTime.hpp"
+#include "WRATHFontFetch.hpp"
+#include "WRATHTextureFontFreeType_Coverage.hpp"
+
+#include "ngl_backend.hpp"
+#include "wrath_test.hpp"
+
+/*
+  Checks the mipmap levels of coverage glyphs built with
+  WRATHTextureFontFreeType_Coverage::downsample_mipmap_levels
+  against mipmap levels rendered by FreeType. For each of
+  the pixel sizes given, a font generates the glyphs of
+  a sample text with the downsample mode; the first
+  glyphs of the font are checked against re-rendered
+  levels (see WRATHTextureFontFreeType_Coverage::downsample_tolerance())
+  and the program reports the mean difference and if the
+  font kept the downsample mode. It then checks that a
+  font falls back to rendering each level when the
+  tolerance is 0 and keeps the downsample mode when
+  the tolerance is 255.
+ */
+
+class cmd_line_type:public DemoKernelMaker
+{
+public:
+  command_line_argument_value<std::string> m_family;
+  command_line_argument_value<std::string> m_sizes;
+  command_line_argument_value<int> m_tolerance;
+  command_line_argument_value<int> m_check_glyphs;
+
+  cmd_line_type(void):
+    m_family("Sans", "family", "Font family to test", *this),
+    m_sizes("32 64 128", "sizes",
+            "Pixel sizes to report, separated by spaces", *this),
+    m_tolerance(12, "tolerance",
+                "Tolerance, in units of 1/255 of coverage, for the reported sizes", *this),
+    m_check_glyphs(32, "check_glyphs", "Number of glyphs of each font to check", *this)
+  {}
+
+  virtual
+  DemoKernel*
+  make_demo(void);
+
+  virtual
+  void
+  delete_demo(DemoKernel *k)
+  {
+    if(k!=NULL)
+      {
+        WRATHDelete(k);
+      }
+  }
+};
+
+class CoverageMipmapTest:public TestKernel
+{
+public:
+  CoverageMipmapTest(cmd_line_type *cmd_line);
+  ~CoverageMipmapTest();
+
+protected:
+  virtual
+  void
+  run_test(void);
+
+private:
+  WRATHTextureFontFreeType_Coverage*
+  generate_glyphs(int pixel_size, int tolerance);
+
+  cmd_line_type *m_cmd_line;
+};
+
+DemoKernel*
+cmd_line_type::
+make_demo(void)
+{
+  return WRATHNew CoverageMipmapTest(this);
+}
+
+CoverageMipmapTest::
+CoverageMipmapTest(cmd_line_type *cmd_line):
+  TestKernel(cmd_line, "coverage_mipmap_test"),
+  m_cmd_line(cmd_line)
+{}
+
+CoverageMipmapTest::
+~CoverageMipmapTest()
+{
+  WRATHResourceManagerBase::clear_all_resource_managers();
+}
+
+WRATHTextureFontFreeType_Coverage*
+CoverageMipmapTest::
+generate_glyphs(int pixel_size, int tolerance)
+{
+  const char *sample="The quick brown fox jumps over the lazy dog 0123456789 "
+    "THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG @#$%&?!";
+  WRATHTextureFont *font;
+  WRATHTextureFontFreeType_Coverage *coverage_font;
+
+  WRATHTextureFontFreeType_Coverage::downsample_tolerance(tolerance);
+  font=WRATHFontFetch::fetch_font(pixel_size,
+                                  WRATHFontFetch::FontProperties()
+                                  .family_name(m_cmd_line->m_family.m_value),
+                                  type_tag<WRATHTextureFontFreeType_Coverage>());
+  coverage_font=dynamic_cast<WRATHTextureFontFreeType_Coverage*>(font);
+  if(coverage_font==NULL)
+    {
+      return NULL;
+    }
+
+  for(const char *p=sample; *p!='\0'; ++p)
+    {
+      WRATHTextureFont::glyph_index_type G;
+
+      G=coverage_font->glyph_index(WRATHTextureFont::character_code_type(*p));
+      if(G.valid())
+        {
+          coverage_font->glyph_data(G);
+        }
+    }
+  return coverage_font;
+}
+
+void
+CoverageMipmapTest::
+run_test(void)
+{
+  std::istringstream sizes(m_cmd_line->m_sizes.m_value);
+  WRATHTextureFontFreeType_Coverage *font;
+  int pixel_size;
+
+  WRATHTextureFontFreeType_Coverage::mipmap_generation(WRATHTextureFontFreeType_Coverage::downsample_mipmap_levels);
+  WRATHTextureFontFreeType_Coverage::downsample_check_glyph_count(m_cmd_line->m_check_glyphs.m_value);
+
+  while(sizes >> pixel_size)
+    {
+      font=generate_glyphs(pixel_size, m_cmd_line->m_tolerance.m_value);
+      if(!check(font!=NULL, "fetching a coverage font"))
+        {
+          return;
+        }
+
+      std::cout << "\n" << pixel_size << " px: "
+                << font->number_downsample_checked_glyphs() << " glyphs checked, "
+                << "mean difference " << font->mean_downsample_difference() << "/255, "
+                << ((font->font_mipmap_generation()==WRATHTextureFontFreeType_Coverage::downsample_mipmap_levels)?
+                    "downsampling kept":
+                    "fell back to rendering each level");
+      check(font->number_downsample_checked_glyphs()>0, "glyphs are checked");
+    }
+  std::cout << "\n";
+
+  /*
+    the pixel sizes below are not used above
+    so that new fonts are created.
+   */
+  font=generate_glyphs(47, 0);
+  if(check(font!=NULL, "fetching a coverage font"))
+    {
+      check(font->mean_downsample_difference()<=0.0f
+            or font->font_mipmap_generation()==WRATHTextureFontFreeType_Coverage::render_each_mipmap_level,
+            "fall back to rendering each level above the tolerance");
+    }
+
+  font=generate_glyphs(45, 255);
+  if(check(font!=NULL, "fetching a coverage font"))
+    {
+      check(font->font_mipmap_generation()==WRATHTextureFontFreeType_Coverage::downsample_mipmap_levels,
+            "downsampling kept within the tolerance");
+    }
+
+  WRATHTextureFontFreeType_Coverage::mipmap_generation(WRATHTextureFontFreeType_Coverage::render_each_mipmap_level);
+}
+
+int
+main(int argc, char **argv)
+{
+  cmd_line_type cmd_line;
+  return cmd_line.main(argc, argv);
+}
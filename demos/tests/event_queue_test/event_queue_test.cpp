@@ -0,0 +1,405 @@
+/*!
+ * \file event_queue_test.cpp
+ * \brief file event_queue_test.cpp
+ *
+ * Copyright 2013 by Nomovok Ltd.
+ *
+ * Contact: info@nomovok.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ *
+ */
+
+
+#include "WRATHConfig.hpp"
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <set>
+#include <boost/bind.hpp>
+
+#include "WRATHNew.hpp"
+#include "WRATHTime.hpp"
+#include "FURYEventQueue.hpp"
+#include "FURYKeyEvent.hpp"
+#include "FURYMouseEvent.hpp"
+#include "FURYTouchEvent.hpp"
+
+/*
+  Feeds synthetic event streams to a FURYEventQueue
+  and checks what dispatch() signals:
+  - consecutive motion events of a pointer are merged
+    to the latest position (and pressure) with the
+    deltas summed,
+  - motion events of different mice or touch IDs are
+    not merged with each other,
+  - no motion event is merged across a button, key or
+    touch down/up event, so the order relative to
+    those is kept,
+  - with coalescing disabled every event is signaled,
+  - events queued by slots during dispatch() are held
+    for the next dispatch(),
+  - the motion event objects are reused from frame to
+    frame unless a slot keeps a handle to them.
+  Runs without a window or GL context and exits with
+  0 if all checks pass.
+ */
+
+namespace
+{
+  class record
+  {
+  public:
+    record(FURYEvent::event_type tp, int pointer,
+           const vec2 &position, const vec2 &delta,
+           float pressure=0.0f):
+      m_type(tp),
+      m_pointer(pointer),
+      m_position(position),
+      m_delta(delta),
+      m_pressure(pressure)
+    {}
+
+    bool
+    operator==(const record &rhs) const
+    {
+      return m_type==rhs.m_type
+        and m_pointer==rhs.m_pointer
+        and m_position==rhs.m_position
+        and m_delta==rhs.m_delta
+        and m_pressure==rhs.m_pressure;
+    }
+
+    FURYEvent::event_type m_type;
+    int m_pointer;
+    vec2 m_position, m_delta;
+    float m_pressure;
+  };
+
+  class recorder
+  {
+  public:
+    recorder(FURYEventQueue &q):
+      m_queue(q),
+      m_retain(false),
+      m_push_in_slot(false),
+      m_number_accepted_on_entry(0)
+    {
+      m_connect=q.connect(boost::bind(&recorder::on_event, this, _1));
+    }
+
+    ~recorder()
+    {
+      m_connect.disconnect();
+    }
+
+    void
+    on_event(FURYEvent::handle ev)
+    {
+      FURYMouseMotionEvent::handle m;
+      FURYTouchEvent::handle t;
+
+      if(m_retain)
+        {
+          m_retained.push_back(ev);
+        }
+
+      /*
+        a reused event must come without the
+        accepted flag of its previous use.
+       */
+      if(ev->accepted())
+        {
+          ++m_number_accepted_on_entry;
+        }
+      ev->accept();
+
+      m=ev.dynamic_cast_handle<FURYMouseMotionEvent>();
+      t=ev.dynamic_cast_handle<FURYTouchEvent>();
+      if(m.valid() or t.valid())
+        {
+          m_motion_objects.insert(ev.raw_pointer());
+        }
+
+      if(m.valid())
+        {
+          m_records.push_back(record(ev->type(), m->mouse().m_mouse_index,
+                                     vec2(m->pt().x(), m->pt().y()),
+                                     vec2(m->delta().x(), m->delta().y())));
+        }
+      else if(t.valid())
+        {
+          m_records.push_back(record(ev->type(), t->id().m_value,
+                                     t->position(), t->delta(), t->pressure()));
+        }
+      else
+        {
+          m_records.push_back(record(ev->type(), -1, vec2(0.0f, 0.0f), vec2(0.0f, 0.0f)));
+        }
+
+      if(m_push_in_slot)
+        {
+          m_push_in_slot=false;
+          m_queue.push_mouse_motion(ivec2(1, 1), ivec2(1, 1));
+        }
+    }
+
+    FURYEventQueue &m_queue;
+    FURYEventQueue::connect_t m_connect;
+    std::vector<record> m_records;
+    std::set<FURYEvent*> m_motion_objects;
+    std::vector<FURYEvent::handle> m_retained;
+    bool m_retain, m_push_in_slot;
+    int m_number_accepted_on_entry;
+  };
+
+  class test_state
+  {
+  public:
+    test_state(void):
+      m_failures(0)
+    {}
+
+    void
+    check(bool v, const std::string &label)
+    {
+      if(!v)
+        {
+          ++m_failures;
+          std::cout << "event_queue_test: check failed: " << label << "\n";
+        }
+    }
+
+    int m_failures;
+  };
+
+  FURYEvent::handle
+  button(bool pressed)
+  {
+    return WRATHNew FURYMouseButtonEvent(0, ivec2(0, 0), pressed);
+  }
+
+  FURYEvent::handle
+  key(bool pressed)
+  {
+    return WRATHNew FURYKeyEvent(FURYKey(65), pressed, 0, 0, FURYKeyModifier(0));
+  }
+
+  FURYEvent::handle
+  touch(FURYEvent::event_type tp, int id)
+  {
+    return WRATHNew FURYTouchEvent(tp, FURYTouchID(id),
+                                   vec2(0.0f, 0.0f), vec2(0.0f, 0.0f), 1.0f);
+  }
+
+  void
+  test_merge_and_order(test_state &st)
+  {
+    FURYEventQueue q;
+    recorder r(q);
+    std::vector<record> expected;
+
+    /*
+      motion, button down, 3 motions, key down,
+      motion given as a FURYEvent, button up
+     */
+    q.push_mouse_motion(ivec2(10, 10), ivec2(1, 0));
+    q.push(button(true));
+    q.push_mouse_motion(ivec2(11, 10), ivec2(1, 0));
+    q.push_mouse_motion(ivec2(13, 12), ivec2(2, 2));
+    q.push_mouse_motion(ivec2(16, 12), ivec2(3, 0));
+    q.push(key(true));
+    q.push(WRATHNew FURYMouseMotionEvent(ivec2(20, 20), ivec2(4, 8)));
+    q.push(button(false));
+
+    st.check(q.number_pending()==6, "pending count after coalescing");
+    st.check(q.number_coalesced()==2, "coalesced count");
+    q.dispatch();
+
+    expected.push_back(record(FURYEvent::MouseMotion, 0, vec2(10, 10), vec2(1, 0)));
+    expected.push_back(record(FURYEvent::MouseButtonDown, -1, vec2(0, 0), vec2(0, 0)));
+    expected.push_back(record(FURYEvent::MouseMotion, 0, vec2(16, 12), vec2(6, 2)));
+    expected.push_back(record(FURYEvent::KeyDown, -1, vec2(0, 0), vec2(0, 0)));
+    expected.push_back(record(FURYEvent::MouseMotion, 0, vec2(20, 20), vec2(4, 8)));
+    expected.push_back(record(FURYEvent::MouseButtonUp, -1, vec2(0, 0), vec2(0, 0)));
+    st.check(r.m_records==expected, "merged motions keep their order to buttons and keys");
+    st.check(q.number_pending()==0 and q.number_coalesced()==0, "dispatch empties the queue");
+  }
+
+  void
+  test_per_pointer(test_state &st)
+  {
+    FURYEventQueue q;
+    recorder r(q);
+    std::vector<record> expected;
+
+    /*
+      two mice and two touch IDs interleaved,
+      then a touch up of ID 1 which stops
+      ID 1 from merging with later motions.
+     */
+    q.push_mouse_motion(ivec2(0, 0), ivec2(1, 1), FURYMouse(0));
+    q.push_mouse_motion(ivec2(100, 0), ivec2(2, 2), FURYMouse(1));
+    q.push_touch_motion(FURYTouchID(1), vec2(5, 5), vec2(1, 0), 0.25f);
+    q.push_mouse_motion(ivec2(1, 1), ivec2(1, 1), FURYMouse(0));
+    q.push_touch_motion(FURYTouchID(2), vec2(50, 50), vec2(0, 1), 0.5f);
+    q.push_touch_motion(FURYTouchID(1), vec2(6, 5), vec2(1, 0), 0.75f);
+    q.push_mouse_motion(ivec2(102, 2), ivec2(2, 2), FURYMouse(1));
+    q.push(touch(FURYEvent::TouchUp, 1));
+    q.push_touch_motion(FURYTouchID(1), vec2(7, 5), vec2(1, 0), 1.0f);
+    q.push_touch_motion(FURYTouchID(2), vec2(50, 52), vec2(0, 2), 0.5f);
+    q.dispatch();
+
+    expected.push_back(record(FURYEvent::MouseMotion, 0, vec2(1, 1), vec2(2, 2)));
+    expected.push_back(record(FURYEvent::MouseMotion, 1, vec2(102, 2), vec2(4, 4)));
+    expected.push_back(record(FURYEvent::TouchMotion, 1, vec2(6, 5), vec2(2, 0), 0.75f));
+    expected.push_back(record(FURYEvent::TouchMotion, 2, vec2(50, 50), vec2(0, 1), 0.5f));
+    expected.push_back(record(FURYEvent::TouchUp, 1, vec2(0, 0), vec2(0, 0), 1.0f));
+    expected.push_back(record(FURYEvent::TouchMotion, 1, vec2(7, 5), vec2(1, 0), 1.0f));
+    expected.push_back(record(FURYEvent::TouchMotion, 2, vec2(50, 52), vec2(0, 2), 0.5f));
+    st.check(r.m_records==expected, "motions merge per mouse and per touch ID");
+  }
+
+  void
+  test_no_coalescing(test_state &st)
+  {
+    FURYEventQueue q;
+    recorder r(q);
+
+    q.coalesce(false);
+    for(int i=0; i<10; ++i)
+      {
+        q.push_mouse_motion(ivec2(i, i), ivec2(1, 1));
+        q.push_touch_motion(FURYTouchID(0), vec2(i, i), vec2(1, 1), 1.0f);
+      }
+    q.dispatch();
+    st.check(r.m_records.size()==20, "no events merged with coalescing disabled");
+  }
+
+  void
+  test_push_in_slot(test_state &st)
+  {
+    FURYEventQueue q;
+    recorder r(q);
+
+    r.m_push_in_slot=true;
+    q.push(key(true));
+    q.dispatch();
+    st.check(r.m_records.size()==1 and q.number_pending()==1,
+             "events queued by a slot are held for the next dispatch");
+    q.dispatch();
+    st.check(r.m_records.size()==2 and r.m_records.back().m_type==FURYEvent::MouseMotion,
+             "held events are signaled on the next dispatch");
+  }
+
+  void
+  test_arena(test_state &st)
+  {
+    FURYEventQueue q;
+    recorder r(q);
+    FURYMouseMotionEvent::handle kept;
+    vec2 kept_position;
+
+    /*
+      each frame: two mice moving with a button
+      event between the motions, i.e. three
+      motion events signaled per frame.
+     */
+    for(int f=0; f<20; ++f)
+      {
+        q.push_mouse_motion(ivec2(f, 0), ivec2(1, 0), FURYMouse(0));
+        q.push_mouse_motion(ivec2(f, 1), ivec2(1, 0), FURYMouse(1));
+        q.push(button(true));
+        q.push_mouse_motion(ivec2(f, 2), ivec2(1, 0), FURYMouse(0));
+        q.dispatch();
+      }
+    st.check(r.m_motion_objects.size()==3, "motion events are reused across frames");
+    st.check(r.m_number_accepted_on_entry==0, "reused events are not accepted");
+
+    /*
+      a slot keeping a handle: the kept event
+      must not be reused and so not change.
+     */
+    r.m_retain=true;
+    q.push_mouse_motion(ivec2(77, 77), ivec2(1, 0));
+    q.dispatch();
+    r.m_retain=false;
+    kept=r.m_retained.back().dynamic_cast_handle<FURYMouseMotionEvent>();
+    kept_position=vec2(kept->pt().x(), kept->pt().y());
+
+    for(int f=0; f<5; ++f)
+      {
+        q.push_mouse_motion(ivec2(f, f), ivec2(1, 0));
+        q.dispatch();
+      }
+    st.check(kept.valid() and kept_position==vec2(77, 77)
+             and kept->pt()==ivec2(77, 77),
+             "an event kept by a slot is not reused");
+  }
+
+  void
+  stress(test_state &st, int number_frames, int motions_per_frame)
+  {
+    FURYEventQueue q;
+    recorder r(q);
+    WRATHTime timer;
+    int32_t ms;
+
+    timer.restart();
+    for(int f=0; f<number_frames; ++f)
+      {
+        for(int i=0; i<motions_per_frame; ++i)
+          {
+            q.push_mouse_motion(ivec2(i, f), ivec2(1, 0));
+            q.push_touch_motion(FURYTouchID(i&3), vec2(i, f), vec2(1, 0), 1.0f);
+            if((i&63)==63)
+              {
+                q.push(key((i&64)!=0));
+              }
+          }
+        q.dispatch();
+      }
+    ms=timer.elapsed();
+
+    std::cout << "\n" << number_frames << " frames of "
+              << 2*motions_per_frame << " motion events: "
+              << r.m_records.size() << " events signaled, "
+              << r.m_motion_objects.size() << " motion event objects, "
+              << ms << " ms";
+
+    /*
+      per block of 64 motions: one mouse motion,
+      four touch motions and one key event.
+     */
+    st.check(r.m_records.size()
+             ==static_cast<unsigned int>(number_frames*6*(motions_per_frame/64)),
+             "stress stream merges to one motion per pointer between keys");
+  }
+}
+
+int
+main(int argc, char **argv)
+{
+  WRATHunused(argc);
+  WRATHunused(argv);
+
+  test_state st;
+
+  test_merge_and_order(st);
+  test_per_pointer(st);
+  test_no_coalescing(st);
+  test_push_in_slot(st);
+  test_arena(st);
+  stress(st, 200, 1024);
+
+  std::cout << "\nevent_queue_test: "
+            << ((st.m_failures==0)?"PASSED":"FAILED") << "\n";
+
+  return (st.m_failures==0)?0:-1;
+}
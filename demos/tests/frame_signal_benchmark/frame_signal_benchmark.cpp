@@ -0,0 +1,306 @@
+/*!
+ * \file frame_signal_benchmark.cpp
+ * \brief file frame_signal_benchmark.cpp
+ *
+ * Copyright 2013 by Nomovok Ltd.
+ *
+ * Contact: info@nomovok.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ *
+ */
+
+
+#include "WRATHConfig.hpp"
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <boost/signals2.hpp>
+
+#include "WRATHNew.hpp"
+#include "WRATHTime.hpp"
+#include "WRATHFrameSignal.hpp"
+
+/*
+  Checks and micro-benchmarks WRATHFrameSignal, the signal
+  type of the per-frame signals of WRATHTripleBufferEnabler.
+  The checks are that
+  - slots are called in order of group order and then
+    in the order they were connected,
+  - a disconnected slot is not called,
+  - a slot connected or disconnected by a slot during
+    an emission takes effect at the next emission.
+  The benchmark emits a signal with many slots (as a
+  frame does with the slots of the node value packers,
+  raw draw datas and buffer objects) many times, and
+  connects and disconnects slots, for both WRATHFrameSignal
+  and boost::signals2::signal, and prints the cost per
+  emission and per slot call.
+
+  Usage: frame_signal_benchmark [slots] [emissions]
+  The program exits with 0 if all checks pass.
+ */
+
+namespace
+{
+  class recorder
+  {
+  public:
+    void
+    call(int v)
+    {
+      m_calls.push_back(v);
+    }
+
+    std::vector<int> m_calls;
+  };
+
+  class counter
+  {
+  public:
+    explicit
+    counter(int *p):
+      m_p(p)
+    {}
+
+    void
+    operator()(void)
+    {
+      ++*m_p;
+    }
+
+    int *m_p;
+  };
+
+  class test_state
+  {
+  public:
+    test_state(void):
+      m_failures(0)
+    {}
+
+    void
+    check(bool v, const std::string &label)
+    {
+      if(!v)
+        {
+          ++m_failures;
+          std::cout << "frame_signal_benchmark: check failed: " << label << "\n";
+        }
+    }
+
+    int m_failures;
+  };
+
+  class connect_during_emit
+  {
+  public:
+    connect_during_emit(WRATHFrameSignal *sig, recorder *r):
+      m_sig(sig),
+      m_recorder(r),
+      m_count(0)
+    {}
+
+    void
+    call(void)
+    {
+      ++m_count;
+      if(m_count==1)
+        {
+          m_connection=m_sig->connect(boost::bind(&recorder::call, m_recorder, 99));
+        }
+      else if(m_count==3)
+        {
+          m_connection.disconnect();
+        }
+    }
+
+    WRATHFrameSignal *m_sig;
+    recorder *m_recorder;
+    WRATHFrameSignal::connection m_connection;
+    int m_count;
+  };
+
+  void
+  test_order(test_state &st)
+  {
+    WRATHFrameSignal sig;
+    recorder r;
+    WRATHFrameSignal::connection c;
+    std::vector<int> expected;
+
+    sig.connect(boost::bind(&recorder::call, &r, 3), 1);
+    sig.connect(boost::bind(&recorder::call, &r, 1), 0);
+    c=sig.connect(boost::bind(&recorder::call, &r, 4), 1);
+    sig.connect(boost::bind(&recorder::call, &r, 0), -1);
+    sig.connect(boost::bind(&recorder::call, &r, 2), 0);
+    sig.connect(boost::bind(&recorder::call, &r, 5), 1);
+
+    sig();
+    for(int i=0; i<6; ++i)
+      {
+        expected.push_back(i);
+      }
+    st.check(r.m_calls==expected, "slots called by group order, then connection order");
+
+    c.disconnect();
+    r.m_calls.clear();
+    expected.erase(expected.begin()+4);
+    st.check(!c.connected(), "connection reports disconnected");
+    sig();
+    st.check(r.m_calls==expected, "disconnected slot is not called");
+  }
+
+  void
+  test_connect_during_emit(test_state &st)
+  {
+    WRATHFrameSignal sig;
+    recorder r;
+    connect_during_emit cde(&sig, &r);
+
+    sig.connect(boost::bind(&connect_during_emit::call, &cde));
+
+    sig();
+    st.check(r.m_calls.empty(), "slot connected during emission not called by it");
+
+    sig();
+    st.check(r.m_calls.size()==1, "slot connected during emission called by the next");
+
+    /*
+      the third emission disconnects the slot before
+      it is reached, so it must not be called by it
+      nor by any later emission
+     */
+    r.m_calls.clear();
+    sig();
+    sig();
+    st.check(r.m_calls.empty(), "slot disconnected during emission not called after");
+  }
+
+  template<typename S>
+  int32_t
+  time_emit(S &sig, int number_emissions)
+  {
+    WRATHTime timer;
+
+    timer.restart();
+    for(int i=0; i<number_emissions; ++i)
+      {
+        sig();
+      }
+    return timer.elapsed();
+  }
+
+  template<typename S, typename C>
+  int32_t
+  time_connect(S &sig, int number_slots, int *count)
+  {
+    std::vector<C> connections(number_slots);
+    WRATHTime timer;
+
+    timer.restart();
+    for(int r=0; r<10; ++r)
+      {
+        for(int i=0; i<number_slots; ++i)
+          {
+            connections[i]=sig.connect(counter(count));
+          }
+        /*
+          one emission per round so that
+          WRATHFrameSignal merges and reclaims
+          its pending slots
+         */
+        sig();
+        for(int i=0; i<number_slots; ++i)
+          {
+            connections[i].disconnect();
+          }
+      }
+    return timer.elapsed();
+  }
+
+  void
+  print(const char *label, int32_t ms, int number_emissions, int number_slots)
+  {
+    std::cout << "\n\t" << label << ": " << ms << " ms";
+    if(number_emissions>0 and number_slots>0)
+      {
+        std::cout << " (" << 1000.0f*static_cast<float>(ms)/static_cast<float>(number_emissions)
+                  << " us per emission, "
+                  << 1000000.0f*static_cast<float>(ms)/static_cast<float>(number_emissions*number_slots)
+                  << " ns per slot)";
+      }
+  }
+}
+
+int
+main(int argc, char **argv)
+{
+  int number_slots(500), number_emissions(5000);
+  test_state st;
+
+  if(argc>1)
+    {
+      number_slots=std::max(1, std::atoi(argv[1]));
+    }
+  if(argc>2)
+    {
+      number_emissions=std::max(1, std::atoi(argv[2]));
+    }
+
+  test_order(st);
+  test_connect_during_emit(st);
+
+  {
+    WRATHFrameSignal frame_signal;
+    boost::signals2::signal<void ()> boost_signal;
+    int frame_count(0), boost_count(0);
+    int32_t frame_ms, boost_ms;
+
+    for(int i=0; i<number_slots; ++i)
+      {
+        frame_signal.connect(counter(&frame_count), i%4);
+        boost_signal.connect(i%4, counter(&boost_count));
+      }
+
+    frame_ms=time_emit(frame_signal, number_emissions);
+    boost_ms=time_emit(boost_signal, number_emissions);
+    st.check(frame_count==number_slots*number_emissions
+             and boost_count==number_slots*number_emissions,
+             "every slot called on each emission");
+
+    std::cout << "Emitting " << number_emissions << " times to "
+              << number_slots << " slots:";
+    print("WRATHFrameSignal", frame_ms, number_emissions, number_slots);
+    print("boost::signals2::signal", boost_ms, number_emissions, number_slots);
+  }
+
+  {
+    WRATHFrameSignal frame_signal;
+    boost::signals2::signal<void ()> boost_signal;
+    int frame_count(0), boost_count(0);
+    int32_t frame_ms, boost_ms;
+
+    frame_ms=time_connect<WRATHFrameSignal, WRATHFrameSignal::connection>(frame_signal, number_slots, &frame_count);
+    boost_ms=time_connect<boost::signals2::signal<void ()>, boost::signals2::connection>(boost_signal, number_slots, &boost_count);
+    st.check(frame_count==10*number_slots and boost_count==10*number_slots,
+             "connected slots called once per round");
+
+    std::cout << "\nConnecting and disconnecting " << number_slots << " slots 10 times:";
+    print("WRATHFrameSignal", frame_ms, 0, 0);
+    print("boost::signals2::signal", boost_ms, 0, 0);
+  }
+
+  std::cout << "\nframe_signal_benchmark: "
+            << ((st.m_failures==0)?"PASSED":"FAILED") << "\n";
+
+  return (st.m_failures==0)?0:-1;
+}
@@ -0,0 +1,257 @@
+/*!
+ * \file gl_state_shadow_test.cpp
+ * \brief file gl_state_shadow_test.cpp
+ *
+ * Copyright 2013 by Nomovok Ltd.
+ *
+ * Contact: info@nomovok.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ *
+ */
+
+
+#include "WRATHConfig.hpp"
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "vecN.hpp"
+#include "WRATHNew.hpp"
+#include "WRATHGLStateShadow.hpp"
+#include "WRATHGLStateStack.hpp"
+#include "WRATHTextDataStream.hpp"
+#include "WRATHLayerItemWidgetsTranslate.hpp"
+
+#include "ngl_backend.hpp"
+#include "wrath_test.hpp"
+
+/*
+  Counts the GL calls WRATHGLStateShadow issues, filters and
+  the glGet queries it makes while drawing a layer of text
+  items for several frames. The first frame fills the shadow,
+  after it:
+  - with the default (the shadow is authoritative) no frame
+    may query GL,
+  - with external_gl_state_changes(true) each frame may only
+    query what the one invalidate() of clear_and_draw() re-reads,
+  - pushing and popping a WRATHGLStateStack around a frame
+    may not query GL and may not issue calls for state that
+    did not change.
+ */
+
+class cmd_line_type:public DemoKernelMaker
+{
+public:
+  command_line_argument_value<int> m_number_items;
+  command_line_argument_value<int> m_number_frames;
+
+  cmd_line_type(void):
+    m_number_items(16, "items", "Number of text items drawn", *this),
+    m_number_frames(8, "frames", "Number of frames drawn for each measurement", *this)
+  {}
+
+  virtual
+  DemoKernel*
+  make_demo(void);
+
+  virtual
+  void
+  delete_demo(DemoKernel *k)
+  {
+    if(k!=NULL)
+      {
+        WRATHDelete(k);
+      }
+  }
+};
+
+class GLStateShadowTest:public TestKernel
+{
+public:
+  GLStateShadowTest(cmd_line_type *cmd_line);
+  ~GLStateShadowTest();
+
+protected:
+  virtual
+  void
+  run_test(void);
+
+private:
+  typedef WRATHLayerTranslateFamilySet::PlainFamily::TextWidget TextWidget;
+
+  class counts
+  {
+  public:
+    counts(void):
+      m_issued(WRATHGLStateShadow::issued_call_count()),
+      m_filtered(WRATHGLStateShadow::filtered_call_count()),
+      m_queries(WRATHGLStateShadow::query_count())
+    {}
+
+    unsigned int m_issued, m_filtered, m_queries;
+  };
+
+  void
+  draw_frame(void);
+
+  counts
+  measure(const std::string &label, bool use_state_stack);
+
+  cmd_line_type *m_cmd_line;
+  WRATHTripleBufferEnabler::handle m_tr;
+  WRATHLayer *m_layer;
+  WRATHTextDataStream m_text;
+  std::vector<TextWidget*> m_items;
+};
+
+DemoKernel*
+cmd_line_type::
+make_demo(void)
+{
+  return WRATHNew GLStateShadowTest(this);
+}
+
+GLStateShadowTest::
+GLStateShadowTest(cmd_line_type *cmd_line):
+  TestKernel(cmd_line, "gl_state_shadow_test"),
+  m_cmd_line(cmd_line)
+{
+  float_orthogonal_projection_params proj_params(0, width(), height(), 0);
+
+  m_tr=WRATHNew WRATHTripleBufferEnabler();
+  m_layer=WRATHNew WRATHLayer(m_tr);
+  m_layer->simulation_matrix(WRATHLayer::projection_matrix, float4x4(proj_params));
+}
+
+GLStateShadowTest::
+~GLStateShadowTest()
+{
+  for(std::vector<TextWidget*>::iterator iter=m_items.begin(),
+        end=m_items.end(); iter!=end; ++iter)
+    {
+      WRATHDelete(*iter);
+    }
+  WRATHPhasedDelete(m_layer);
+  WRATHResourceManagerBase::clear_all_resource_managers();
+  m_tr->purge_cleanup();
+  m_tr=NULL;
+}
+
+void
+GLStateShadowTest::
+draw_frame(void)
+{
+  m_tr->signal_complete_simulation_frame();
+  m_tr->signal_begin_presentation_frame();
+  m_layer->clear_and_draw();
+}
+
+GLStateShadowTest::counts
+GLStateShadowTest::
+measure(const std::string &label, bool use_state_stack)
+{
+  counts R;
+
+  WRATHGLStateShadow::reset_counters();
+  for(int f=0; f<m_cmd_line->m_number_frames.m_value; ++f)
+    {
+      if(use_state_stack)
+        {
+          WRATHGLStateStack stack;
+
+          stack.push(WRATHGLStateStack::color_buffer_bit
+                     | WRATHGLStateStack::depth_buffer_bit
+                     | WRATHGLStateStack::stencil_buffer_bit
+                     | WRATHGLStateStack::rendering_target_bit
+                     | WRATHGLStateStack::rendering_action_bit);
+          draw_frame();
+          stack.pop();
+        }
+      else
+        {
+          draw_frame();
+        }
+    }
+  R=counts();
+
+  std::cout << "\n" << label << ", " << m_cmd_line->m_number_frames.m_value
+            << " frames: issued " << R.m_issued
+            << ", filtered " << R.m_filtered
+            << ", queries " << R.m_queries;
+  return R;
+}
+
+void
+GLStateShadowTest::
+run_test(void)
+{
+  bool saved_external(WRATHGLStateShadow::external_gl_state_changes());
+  counts authoritative, with_stack, external, first_frame;
+  int number_frames(m_cmd_line->m_number_frames.m_value);
+
+  m_text.stream() << WRATHText::set_pixel_size(16)
+                  << WRATHText::set_color(0, 0, 0)
+                  << "the quick brown fox jumps over the lazy dog";
+
+  for(int i=0; i<m_cmd_line->m_number_items.m_value; ++i)
+    {
+      m_items.push_back(WRATHNew TextWidget(m_layer, WRATHTextItemTypes::text_transparent));
+      m_items.back()->add_text(m_text);
+      m_items.back()->position(vec2(0.0f, 20.0f*static_cast<float>(i)));
+    }
+
+  /*
+    the first frame creates the GL objects and fills
+    the shadow, the shadow is made to re-read GL once
+    so that the counts of the first frame include the
+    queries an invalidate() costs.
+   */
+  WRATHGLStateShadow::external_gl_state_changes(false);
+  WRATHGLStateShadow::invalidate();
+  WRATHGLStateShadow::reset_counters();
+  draw_frame();
+  first_frame=counts();
+  std::cout << "\nfirst frame: issued " << first_frame.m_issued
+            << ", filtered " << first_frame.m_filtered
+            << ", queries " << first_frame.m_queries;
+
+  authoritative=measure("authoritative shadow", false);
+  check(authoritative.m_queries==0, "no GL queries once the shadow is filled");
+  check(authoritative.m_filtered>0, "redundant GL calls are filtered");
+
+  with_stack=measure("authoritative shadow with WRATHGLStateStack", true);
+  check(with_stack.m_queries==0, "WRATHGLStateStack push/pop does not query GL");
+  check(with_stack.m_issued<=authoritative.m_issued,
+        "WRATHGLStateStack push/pop issues no calls for unchanged state");
+
+  WRATHGLStateShadow::external_gl_state_changes(true);
+  external=measure("external GL state changes", false);
+  WRATHGLStateShadow::external_gl_state_changes(saved_external);
+
+  /*
+    clear_and_draw() invalidates once per frame, so each
+    frame may query at most what one filled shadow needs.
+   */
+  {
+    std::ostringstream str;
+    str << "at most " << first_frame.m_queries
+        << " queries per frame with external GL state changes";
+    check(external.m_queries <= first_frame.m_queries*static_cast<unsigned int>(number_frames),
+          str.str());
+  }
+  std::cout << "\n";
+}
+
+int
+main(int argc, char **argv)
+{
+  cmd_line_type cmd_line;
+  return cmd_line.main(argc, argv);
+}
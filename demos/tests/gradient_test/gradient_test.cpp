@@ -0,0 +1,542 @@
+/*!
+ * \file gradient_test.cpp
+ * \brief file gradient_test.cpp
+ *
+ * Copyright 2013 by Nomovok Ltd.
+ *
+ * Contact: info@nomovok.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ *
+ */
+
+
+#include "WRATHConfig.hpp"
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <set>
+#include <map>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "WRATHNew.hpp"
+#include "WRATHTime.hpp"
+#include "WRATHGradient.hpp"
+
+#include "ngl_backend.hpp"
+#include "wrath_test.hpp"
+
+/*
+  Checks and times the rows of WRATHGradient textures.
+  The checks are that
+  - gradients of every resolution with the same repeat
+    mode share a texture, and gradients of different
+    repeat modes do not,
+  - the row of a gradient, read back from the texture,
+    is what GL gives filtering a texture of the resolution
+    of the gradient with its repeat mode at the texel
+    centers of the row (the row of a gradient of lower
+    resolution is resampled to the width of the texture),
+  - a row freed by a deleted gradient is rewritten for
+    the gradient that takes it.
+  It then changes a color stop of each of many gradients
+  per frame and times interpolating and uploading the
+  dirty rows when binding their textures.
+
+  Reading back the rows needs glGetTexImage, thus the
+  row checks are skipped under GLES.
+ */
+
+class cmd_line_type:public DemoKernelMaker
+{
+public:
+  command_line_argument_value<int> m_number_gradients;
+  command_line_argument_value<int> m_number_frames;
+
+  cmd_line_type(void):
+    m_number_gradients(512, "number_gradients",
+                       "Number of gradients of the timed updates", *this),
+    m_number_frames(200, "number_frames",
+                    "Number of frames of the timed updates", *this)
+  {}
+
+  virtual
+  DemoKernel*
+  make_demo(void);
+
+  virtual
+  void
+  delete_demo(DemoKernel *k)
+  {
+    if(k!=NULL)
+      {
+        WRATHDelete(k);
+      }
+  }
+};
+
+class GradientTest:public TestKernel
+{
+public:
+  GradientTest(cmd_line_type *cmd_line);
+  ~GradientTest();
+
+protected:
+  virtual
+  void
+  run_test(void);
+
+private:
+  class stop
+  {
+  public:
+    stop(float t, const vec4 &c):
+      m_t(t),
+      m_color(c)
+    {}
+
+    float m_t;
+    vec4 m_color;
+  };
+
+  static
+  WRATHGradient*
+  make_gradient(enum WRATHGradient::repeat_type_t mode, int log2_resolution,
+                const std::vector<stop> &stops);
+
+  static
+  void
+  reference_texels(WRATHGradient *gradient, enum WRATHGradient::repeat_type_t mode,
+                   int resolution, const std::vector<stop> &stops, std::vector<vec4> &out);
+
+  static
+  void
+  reference_row(WRATHGradient *gradient, enum WRATHGradient::repeat_type_t mode,
+                int resolution, const std::vector<stop> &stops, int width,
+                std::vector<vec4> &out);
+
+  static
+  int
+  wrap(enum WRATHGradient::repeat_type_t mode, int i, int resolution);
+
+  bool
+  read_row(WRATHGradient *gradient, std::vector<vecN<GLubyte, 4> > &out);
+
+  void
+  check_row(WRATHGradient *gradient, enum WRATHGradient::repeat_type_t mode,
+            int log2_resolution, const std::vector<stop> &stops,
+            const std::string &label);
+
+  void
+  check_sharing(void);
+
+  void
+  check_rows(void);
+
+  void
+  time_updates(void);
+
+  cmd_line_type *m_cmd_line;
+};
+
+DemoKernel*
+cmd_line_type::
+make_demo(void)
+{
+  return WRATHNew GradientTest(this);
+}
+
+GradientTest::
+GradientTest(cmd_line_type *cmd_line):
+  TestKernel(cmd_line, "gradient_test"),
+  m_cmd_line(cmd_line)
+{}
+
+GradientTest::
+~GradientTest()
+{
+  WRATHResourceManagerBase::clear_all_resource_managers();
+}
+
+WRATHGradient*
+GradientTest::
+make_gradient(enum WRATHGradient::repeat_type_t mode, int log2_resolution,
+              const std::vector<stop> &stops)
+{
+  WRATHGradient::parameters params(mode);
+  WRATHGradient *R;
+
+  params.m_log2_resolution=log2_resolution;
+  R=WRATHNew WRATHGradient(params);
+  for(unsigned int i=0, endi=stops.size(); i<endi; ++i)
+    {
+      R->set_color(stops[i].m_t, stops[i].m_color);
+    }
+  return R;
+}
+
+int
+GradientTest::
+wrap(enum WRATHGradient::repeat_type_t mode, int i, int resolution)
+{
+  switch(mode)
+    {
+    case WRATHGradient::Repeat:
+      i=i%resolution;
+      return (i<0)?i+resolution:i;
+
+    case WRATHGradient::MirrorRepeat:
+      i=i%(2*resolution);
+      i=(i<0)?i+2*resolution:i;
+      return (i<resolution)?i:2*resolution-1-i;
+
+    default:
+      return std::max(0, std::min(i, resolution-1));
+    }
+}
+
+void
+GradientTest::
+reference_texels(WRATHGradient *gradient, enum WRATHGradient::repeat_type_t mode,
+                 int resolution, const std::vector<stop> &stops, std::vector<vec4> &out)
+{
+  /*
+    a stop is at the texel WRATHGradient::texel()
+    gives for it, a later stop at the same texel
+    replaces the earlier one. Between stops colors
+    are linearly interpolated by texel, outside of
+    the stops the colors are clamped except for
+    Repeat which interpolates from the last stop to
+    the first stop, taken resolution-1 texels later.
+    Without stops a gradient is white.
+   */
+  std::map<int, vec4> texels;
+
+  for(unsigned int i=0, endi=stops.size(); i<endi; ++i)
+    {
+      texels[gradient->texel(stops[i].m_t)]=stops[i].m_color;
+    }
+
+  out.assign(resolution, vec4(1.0f, 1.0f, 1.0f, 1.0f));
+  if(texels.empty())
+    {
+      return;
+    }
+
+  for(int I=0; I<resolution; ++I)
+    {
+      std::map<int, vec4>::iterator next;
+      int prev_texel, next_texel;
+      vec4 prev_color, next_color;
+
+      next=texels.upper_bound(I);
+      if(next==texels.begin())
+        {
+          next_texel=next->first;
+          next_color=next->second;
+          if(mode==WRATHGradient::Repeat)
+            {
+              prev_texel=texels.rbegin()->first - (resolution-1);
+              prev_color=texels.rbegin()->second;
+            }
+          else
+            {
+              prev_texel=next_texel;
+              prev_color=next_color;
+            }
+        }
+      else if(next==texels.end())
+        {
+          prev_texel=texels.rbegin()->first;
+          prev_color=texels.rbegin()->second;
+          if(mode==WRATHGradient::Repeat)
+            {
+              next_texel=texels.begin()->first + (resolution-1);
+              next_color=texels.begin()->second;
+            }
+          else
+            {
+              next_texel=prev_texel;
+              next_color=prev_color;
+            }
+        }
+      else
+        {
+          next_texel=next->first;
+          next_color=next->second;
+          --next;
+          prev_texel=next->first;
+          prev_color=next->second;
+        }
+
+      float t(0.0f);
+      if(next_texel!=prev_texel)
+        {
+          t=static_cast<float>(I - prev_texel)/static_cast<float>(next_texel - prev_texel);
+        }
+      out[I]=(1.0f-t)*prev_color + t*next_color;
+    }
+}
+
+void
+GradientTest::
+reference_row(WRATHGradient *gradient, enum WRATHGradient::repeat_type_t mode,
+              int resolution, const std::vector<stop> &stops, int width,
+              std::vector<vec4> &out)
+{
+  std::vector<vec4> texels;
+
+  reference_texels(gradient, mode, resolution, stops, texels);
+
+  /*
+    sample the texels with GL_LINEAR at the
+    texel centers of a row of width texels.
+   */
+  out.resize(width);
+  for(int J=0; J<width; ++J)
+    {
+      float s, f;
+      int i0;
+
+      s=(static_cast<float>(J) + 0.5f)*static_cast<float>(resolution)/static_cast<float>(width) - 0.5f;
+      i0=static_cast<int>(std::floor(s));
+      f=s - static_cast<float>(i0);
+      out[J]=(1.0f-f)*texels[wrap(mode, i0, resolution)]
+        + f*texels[wrap(mode, i0+1, resolution)];
+    }
+}
+
+bool
+GradientTest::
+read_row(WRATHGradient *gradient, std::vector<vecN<GLubyte, 4> > &out)
+{
+#if defined(WRATH_GLES_VERSION)
+  WRATHunused(gradient);
+  WRATHunused(out);
+  return false;
+#else
+  GLint width, height;
+  std::vector<vecN<GLubyte, 4> > pixels;
+  int y;
+
+  glActiveTexture(GL_TEXTURE0);
+  gradient->texture_binder()->bind_texture(GL_TEXTURE0);
+  glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+  glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+
+  pixels.resize(width*height);
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels[0].c_ptr());
+
+  y=static_cast<int>(gradient->texture_coordinate_y()*static_cast<float>(height));
+  out.assign(pixels.begin() + y*width, pixels.begin() + (y+1)*width);
+  return true;
+#endif
+}
+
+void
+GradientTest::
+check_row(WRATHGradient *gradient, enum WRATHGradient::repeat_type_t mode,
+          int log2_resolution, const std::vector<stop> &stops,
+          const std::string &label)
+{
+  std::vector<vecN<GLubyte, 4> > row;
+  std::vector<vec4> expected;
+  float max_difference(0.0f);
+
+  if(!read_row(gradient, row))
+    {
+      return;
+    }
+
+  reference_row(gradient, mode, 1<<log2_resolution, stops, row.size(), expected);
+  for(unsigned int J=0, endJ=row.size(); J<endJ; ++J)
+    {
+      for(int c=0; c<4; ++c)
+        {
+          float v;
+
+          v=255.0f*std::max(0.0f, std::min(1.0f, expected[J][c]));
+          max_difference=std::max(max_difference,
+                                  std::fabs(v - static_cast<float>(row[J][c])));
+        }
+    }
+
+  if(max_difference>1.0f)
+    {
+      std::cout << label << ": max difference " << max_difference << "/255\n";
+    }
+  check(max_difference<=1.0f, label);
+}
+
+void
+GradientTest::
+check_sharing(void)
+{
+  std::vector<stop> stops;
+  std::vector<WRATHGradient*> gradients;
+  std::set<float> ys;
+  bool same_texture(true);
+
+  stops.push_back(stop(0.0f, vec4(1.0f, 0.0f, 0.0f, 1.0f)));
+  stops.push_back(stop(1.0f, vec4(0.0f, 0.0f, 1.0f, 1.0f)));
+
+  for(int log2_res=0; log2_res<=8; ++log2_res)
+    {
+      gradients.push_back(make_gradient(WRATHGradient::Clamp, log2_res, stops));
+      same_texture=same_texture
+        and gradients.back()->texture_binder()==gradients.front()->texture_binder();
+      ys.insert(gradients.back()->texture_coordinate_y());
+    }
+  check(same_texture, "gradients of all resolutions share a texture");
+  check(ys.size()==gradients.size(), "gradients sharing a texture take different rows");
+
+  gradients.push_back(make_gradient(WRATHGradient::Repeat, 5, stops));
+  gradients.push_back(make_gradient(WRATHGradient::MirrorRepeat, 5, stops));
+  check(gradients[gradients.size()-2]->texture_binder()!=gradients.front()->texture_binder()
+        and gradients[gradients.size()-1]->texture_binder()!=gradients.front()->texture_binder()
+        and gradients[gradients.size()-1]->texture_binder()!=gradients[gradients.size()-2]->texture_binder(),
+        "gradients of different repeat modes do not share a texture");
+
+  for(unsigned int i=0, endi=gradients.size(); i<endi; ++i)
+    {
+      WRATHDelete(gradients[i]);
+    }
+}
+
+void
+GradientTest::
+check_rows(void)
+{
+  const enum WRATHGradient::repeat_type_t modes[]=
+    {
+      WRATHGradient::Clamp,
+      WRATHGradient::Repeat,
+      WRATHGradient::MirrorRepeat
+    };
+  const char *mode_labels[]=
+    {
+      "Clamp",
+      "Repeat",
+      "MirrorRepeat"
+    };
+  std::vector<stop> stops;
+
+  stops.push_back(stop(0.1f, vec4(1.0f, 0.0f, 0.0f, 1.0f)));
+  stops.push_back(stop(0.35f, vec4(0.0f, 1.0f, 0.0f, 0.5f)));
+  stops.push_back(stop(0.6f, vec4(0.0f, 0.0f, 1.0f, 1.0f)));
+  stops.push_back(stop(0.9f, vec4(1.0f, 1.0f, 0.0f, 0.0f)));
+
+  /*
+    from a resolution of 8 on, the stops at 0.1
+    and 0.9 are at texels within the gradient.
+   */
+  for(int m=0; m<3; ++m)
+    {
+      for(int log2_res=3; log2_res<=8; ++log2_res)
+        {
+          WRATHGradient *gradient;
+          std::ostringstream label;
+
+          label << "row of a " << mode_labels[m] << " gradient of resolution "
+                << (1<<log2_res);
+          gradient=make_gradient(modes[m], log2_res, stops);
+          check_row(gradient, modes[m], log2_res, stops, label.str());
+          WRATHDelete(gradient);
+        }
+    }
+
+  /*
+    the row of a deleted gradient is taken
+    by the next gradient created, it must
+    be rewritten even without any color set.
+   */
+  {
+    std::vector<stop> no_stops;
+    WRATHGradient *gradient;
+
+    gradient=make_gradient(WRATHGradient::Clamp, 4, stops);
+    check_row(gradient, WRATHGradient::Clamp, 4, stops, "row before reuse");
+    WRATHDelete(gradient);
+
+    gradient=make_gradient(WRATHGradient::Clamp, 4, no_stops);
+    check_row(gradient, WRATHGradient::Clamp, 4, no_stops, "reused row without stops is white");
+    WRATHDelete(gradient);
+  }
+}
+
+void
+GradientTest::
+time_updates(void)
+{
+  std::vector<WRATHGradient*> gradients;
+  std::set<WRATHTextureChoice::texture_base*> textures;
+  std::vector<stop> stops;
+  WRATHTime timer;
+  int32_t ms;
+  int number_frames(std::max(1, m_cmd_line->m_number_frames.m_value));
+
+  stops.push_back(stop(0.0f, vec4(1.0f, 0.0f, 0.0f, 1.0f)));
+  stops.push_back(stop(0.5f, vec4(0.0f, 1.0f, 0.0f, 1.0f)));
+  stops.push_back(stop(1.0f, vec4(0.0f, 0.0f, 1.0f, 1.0f)));
+
+  for(int i=0; i<m_cmd_line->m_number_gradients.m_value; ++i)
+    {
+      gradients.push_back(make_gradient(WRATHGradient::Clamp, 3 + i%6, stops));
+      textures.insert(gradients.back()->texture_binder().raw_pointer());
+    }
+
+  glActiveTexture(GL_TEXTURE0);
+  timer.restart();
+  for(int f=0; f<number_frames; ++f)
+    {
+      float v(static_cast<float>(f%64)/63.0f);
+
+      for(unsigned int i=0, endi=gradients.size(); i<endi; ++i)
+        {
+          gradients[i]->set_color(0.5f, WRATHGradient::color(v, 1.0f - v, 0.5f, 1.0f));
+        }
+
+      for(std::set<WRATHTextureChoice::texture_base*>::iterator iter=textures.begin(),
+            end=textures.end(); iter!=end; ++iter)
+        {
+          (*iter)->bind_texture(GL_TEXTURE0);
+        }
+    }
+  glFinish();
+  ms=timer.elapsed();
+
+  std::cout << "\nUpdating " << gradients.size() << " gradients of resolutions 8 to 256 in "
+            << textures.size() << " textures, " << number_frames << " frames: "
+            << ms << " ms (" << static_cast<float>(ms)/static_cast<float>(number_frames)
+            << " ms per frame)\n";
+
+  for(unsigned int i=0, endi=gradients.size(); i<endi; ++i)
+    {
+      WRATHDelete(gradients[i]);
+    }
+}
+
+void
+GradientTest::
+run_test(void)
+{
+  check_sharing();
+  check_rows();
+  time_updates();
+}
+
+int
+main(int argc, char **argv)
+{
+  cmd_line_type cmd_line;
+  return cmd_line.main(argc, argv);
+}
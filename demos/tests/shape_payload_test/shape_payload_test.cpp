@@ -0,0 +1,401 @@
+/*!
+ * \file shape_payload_test.cpp
+ * \brief file shape_payload_test.cpp
+ *
+ * Copyright 2013 by Nomovok Ltd.
+ *
+ * Contact: info@nomovok.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ *
+ */
+
+
+#include "WRATHConfig.hpp"
+#include <iostream>
+#include <cstdlib>
+#include <algorithm>
+#include <pthread.h>
+
+#include "WRATHNew.hpp"
+#include "WRATHTime.hpp"
+#include "WRATHParallelFor.hpp"
+#include "WRATHShape.hpp"
+#include "WRATHShapeSimpleTessellator.hpp"
+#include "WRATHShapePreStroker.hpp"
+
+/*
+  Checks and times the per-outline generation of
+  WRATHShapeSimpleTessellatorPayload and WRATHShapePreStrokerPayload.
+  The checks are that
+  - after editing one outline of a shape, the payloads
+    fetched again reuse the tessellation of the other
+    outlines and only regenerate the edited one,
+  - those incrementally generated payloads are identical
+    to payloads generated from scratch,
+  - payloads generated with several threads are identical
+    to payloads generated with one thread,
+  - the compute() of a GenericInterpolator is only called
+    from the calling thread.
+  It then times, for a shape with many outlines, generating
+  the payloads from scratch with one thread and with
+  WRATHParallelFor::max_number_threads() threads, and
+  regenerating them after editing one outline.
+
+  Usage: shape_payload_test [threads] [outlines]
+  The pre-stroker uses 16-bit indices, so the
+  number of outlines must stay below about 1000
+  for the rounded caps of the shape to be indexable.
+  The program exits with 0 if all checks pass.
+ */
+
+namespace
+{
+  typedef WRATHShapeSimpleTessellatorPayload TessPayload;
+  typedef WRATHShapePreStrokerPayload StrokePayload;
+
+  class test_state
+  {
+  public:
+    test_state(void):
+      m_failures(0)
+    {}
+
+    void
+    check(bool v, const std::string &label)
+    {
+      if(!v)
+        {
+          ++m_failures;
+          std::cout << "shape_payload_test: check failed: " << label << "\n";
+        }
+    }
+
+    int m_failures;
+  };
+
+  /*
+    the point types have padding and members that
+    some of their ctors leave unset, so they are
+    compared through their accessors.
+   */
+  bool
+  same_point(GLushort a, GLushort b)
+  {
+    return a==b;
+  }
+
+  bool
+  same_point(const TessPayload::CurvePoint &a, const TessPayload::CurvePoint &b)
+  {
+    return a.position()==b.position()
+      and a.normal()==b.normal()
+      and a.time()==b.time();
+  }
+
+  template<typename J>
+  bool
+  same_join_point(const J &a, const J &b)
+  {
+    return a.pre_position()==b.pre_position()
+      and a.offset_vector(4.0f)==b.offset_vector(4.0f)
+      and a.outlineID()==b.outlineID()
+      and a.pointID_beforeJoin()==b.pointID_beforeJoin()
+      and a.pointID_afterJoin()==b.pointID_afterJoin();
+  }
+
+  bool
+  same_point(const StrokePayload::JoinPoint &a, const StrokePayload::JoinPoint &b)
+  {
+    return same_join_point(a, b);
+  }
+
+  bool
+  same_point(const StrokePayload::MiterJoinPoint &a, const StrokePayload::MiterJoinPoint &b)
+  {
+    return same_join_point(a, b);
+  }
+
+  bool
+  same_point(const StrokePayload::CapPoint &a, const StrokePayload::CapPoint &b)
+  {
+    return a.pre_position()==b.pre_position()
+      and a.offset_vector()==b.offset_vector()
+      and a.outlineID()==b.outlineID()
+      and a.at_start_of_edge()==b.at_start_of_edge();
+  }
+
+  template<typename T>
+  bool
+  same_array(const_c_array<T> a, const_c_array<T> b)
+  {
+    if(a.size()!=b.size())
+      {
+        return false;
+      }
+
+    for(unsigned int i=0, endi=a.size(); i<endi; ++i)
+      {
+        if(!same_point(a[i], b[i]))
+          {
+            return false;
+          }
+      }
+    return true;
+  }
+
+  bool
+  same_tessellation(const TessPayload::handle &a, const TessPayload::handle &b)
+  {
+    if(a->tessellation().size()!=b->tessellation().size())
+      {
+        return false;
+      }
+
+    for(unsigned int o=0, endo=a->tessellation().size(); o<endo; ++o)
+      {
+        const TessPayload::TessellatedOutline::handle &ao(a->tessellation()[o]);
+        const TessPayload::TessellatedOutline::handle &bo(b->tessellation()[o]);
+
+        if(ao->edges().size()!=bo->edges().size())
+          {
+            return false;
+          }
+
+        for(unsigned int e=0, ende=ao->edges().size(); e<ende; ++e)
+          {
+            const_c_array<TessPayload::CurvePoint> ap(ao->edges()[e]->curve_points());
+            const_c_array<TessPayload::CurvePoint> bp(bo->edges()[e]->curve_points());
+
+            if(!same_array(ap, bp))
+              {
+                return false;
+              }
+          }
+      }
+    return true;
+  }
+
+  bool
+  same_stroking(const StrokePayload::handle &a, const StrokePayload::handle &b)
+  {
+    return a->flags()==b->flags()
+      and same_array(a->square_cap_pts(), b->square_cap_pts())
+      and same_array(a->square_cap_indices(), b->square_cap_indices())
+      and same_array(a->rounded_cap_pts(), b->rounded_cap_pts())
+      and same_array(a->rounded_cap_indices(), b->rounded_cap_indices())
+      and same_array(a->all_miter_join_pts(), b->all_miter_join_pts())
+      and same_array(a->all_miter_join_indices(), b->all_miter_join_indices())
+      and same_array(a->core_miter_join_indices(), b->core_miter_join_indices())
+      and same_array(a->all_bevel_join_pts(), b->all_bevel_join_pts())
+      and same_array(a->all_bevel_join_indices(), b->all_bevel_join_indices())
+      and same_array(a->core_bevel_join_indices(), b->core_bevel_join_indices())
+      and same_array(a->all_rounded_join_pts(), b->all_rounded_join_pts())
+      and same_array(a->all_rounded_join_indices(), b->all_rounded_join_indices())
+      and same_array(a->core_rounded_join_indices(), b->core_rounded_join_indices());
+  }
+
+  /*
+    adds one closed outline made of a line,
+    a quadratic and a cubic at the offset p
+   */
+  void
+  add_outline(WRATHShape<float> &shape, const vec2 &p, float size)
+  {
+    shape.move_to(p)
+      .line_to(p + vec2(size, 0.0f))
+      .quadratic_to(p + vec2(1.5f*size, 0.5f*size), p + vec2(size, size))
+      .cubic_to(p + vec2(0.7f*size, 1.4f*size), p + vec2(0.3f*size, 0.6f*size),
+                p + vec2(0.0f, size));
+  }
+
+  pthread_t calling_thread;
+  int off_thread_computes(0), number_computes(0);
+
+  class line_interpolator:public WRATHOutline<float>::GenericInterpolator
+  {
+  public:
+    line_interpolator(const vec2 &a, const vec2 &b):
+      m_a(a),
+      m_b(b)
+    {}
+
+    virtual
+    void
+    compute(float t, vec2 &p, vec2 &p_t, vec2 &p_tt) const
+    {
+      ++number_computes;
+      if(!pthread_equal(pthread_self(), calling_thread))
+        {
+          ++off_thread_computes;
+        }
+      p=m_a + t*(m_b - m_a);
+      p_t=m_b - m_a;
+      p_tt=vec2(0.0f, 0.0f);
+    }
+
+    vec2 m_a, m_b;
+  };
+
+  void
+  test_incremental(test_state &st, int number_threads)
+  {
+    WRATHShape<float> shape;
+    TessPayload::handle T1, T2, fresh_tess;
+    StrokePayload::handle P1, P2, fresh_stroke;
+
+    WRATHParallelFor::max_number_threads(number_threads);
+
+    add_outline(shape, vec2(0.0f, 0.0f), 10.0f);
+    add_outline(shape, vec2(50.0f, 50.0f), 40.0f);
+    add_outline(shape, vec2(100.0f, 0.0f), 20.0f);
+
+    P1=shape.fetch_payload<StrokePayload>();
+    T1=shape.fetch_payload<TessPayload>();
+
+    /*
+      edit the last outline only
+     */
+    shape.line_to(vec2(130.0f, 30.0f));
+    P2=shape.fetch_payload<StrokePayload>();
+    T2=shape.fetch_payload<TessPayload>();
+
+    st.check(T2->tessellation().size()==3, "edited shape has 3 outlines");
+    st.check(T1->tessellation()[0]==T2->tessellation()[0]
+             and T1->tessellation()[1]==T2->tessellation()[1],
+             "unedited outlines reuse their tessellation");
+    st.check(T1->tessellation()[2]!=T2->tessellation()[2],
+             "edited outline is tessellated again");
+
+    fresh_tess=WRATHNew TessPayload(shape);
+    fresh_stroke=WRATHNew StrokePayload(fresh_tess);
+    st.check(same_tessellation(T2, fresh_tess),
+             "incremental tessellation equals tessellation from scratch");
+    st.check(same_stroking(P2, fresh_stroke),
+             "incremental pre-stroking equals pre-stroking from scratch");
+    st.check(!same_stroking(P1, P2), "pre-stroking changes with the edited outline");
+  }
+
+  void
+  test_threads(test_state &st, int number_threads)
+  {
+    WRATHShape<float> shape;
+    TessPayload::handle serial_tess, parallel_tess;
+    StrokePayload::handle serial_stroke, parallel_stroke;
+
+    for(int i=0; i<32; ++i)
+      {
+        add_outline(shape, vec2(30.0f*static_cast<float>(i%8), 30.0f*static_cast<float>(i/8)),
+                    5.0f + static_cast<float>(i));
+      }
+
+    WRATHParallelFor::max_number_threads(1);
+    serial_tess=WRATHNew TessPayload(shape);
+    serial_stroke=WRATHNew StrokePayload(serial_tess);
+
+    WRATHParallelFor::max_number_threads(number_threads);
+    parallel_tess=WRATHNew TessPayload(shape);
+    parallel_stroke=WRATHNew StrokePayload(parallel_tess);
+
+    st.check(same_tessellation(serial_tess, parallel_tess),
+             "parallel tessellation equals serial tessellation");
+    st.check(same_stroking(serial_stroke, parallel_stroke),
+             "parallel pre-stroking equals serial pre-stroking");
+  }
+
+  void
+  test_generic_interpolator(test_state &st, int number_threads)
+  {
+    WRATHShape<float> shape;
+
+    WRATHParallelFor::max_number_threads(number_threads);
+    calling_thread=pthread_self();
+    off_thread_computes=0;
+    number_computes=0;
+
+    add_outline(shape, vec2(0.0f, 0.0f), 10.0f);
+    add_outline(shape, vec2(50.0f, 50.0f), 40.0f);
+    add_outline(shape, vec2(100.0f, 0.0f), 20.0f);
+    shape.move_to(vec2(200.0f, 0.0f));
+    shape.current_outline().add_point(vec2(205.0f, 0.0f),
+                                      WRATHNew line_interpolator(vec2(205.0f, 0.0f),
+                                                                 vec2(210.0f, 5.0f)));
+    shape.current_outline().add_point(vec2(210.0f, 5.0f), NULL);
+
+    shape.fetch_payload<TessPayload>();
+    shape.fetch_payload<StrokePayload>();
+
+    st.check(number_computes>0, "GenericInterpolator is computed");
+    st.check(off_thread_computes==0, "GenericInterpolator only computed from the calling thread");
+  }
+
+  int32_t
+  time_generate(WRATHShape<float> &shape)
+  {
+    WRATHTime timer;
+
+    timer.restart();
+    shape.fetch_payload<StrokePayload>();
+    return timer.elapsed();
+  }
+}
+
+int
+main(int argc, char **argv)
+{
+  int number_threads(WRATHParallelFor::max_number_threads());
+  int number_outlines(200);
+  int32_t serial_ms, parallel_ms, edit_ms;
+  test_state st;
+
+  if(argc>1)
+    {
+      number_threads=std::max(1, std::atoi(argv[1]));
+    }
+  if(argc>2)
+    {
+      number_outlines=std::max(1, std::atoi(argv[2]));
+    }
+
+  test_incremental(st, 1);
+  test_incremental(st, std::max(2, number_threads));
+  test_threads(st, std::max(2, number_threads));
+  test_generic_interpolator(st, std::max(2, number_threads));
+
+  {
+    WRATHShape<float> serial_shape, parallel_shape;
+
+    for(int i=0; i<number_outlines; ++i)
+      {
+        vec2 p(30.0f*static_cast<float>(i%64), 30.0f*static_cast<float>(i/64));
+        float sz(5.0f + static_cast<float>(i%20));
+
+        add_outline(serial_shape, p, sz);
+        add_outline(parallel_shape, p, sz);
+      }
+
+    WRATHParallelFor::max_number_threads(1);
+    serial_ms=time_generate(serial_shape);
+
+    WRATHParallelFor::max_number_threads(number_threads);
+    parallel_ms=time_generate(parallel_shape);
+
+    parallel_shape.line_to(vec2(-10.0f, -10.0f));
+    edit_ms=time_generate(parallel_shape);
+  }
+
+  std::cout << "Tessellating and pre-stroking " << number_outlines << " outlines:"
+            << "\n\tfrom scratch, 1 thread: " << serial_ms << " ms"
+            << "\n\tfrom scratch, " << number_threads << " threads: " << parallel_ms << " ms"
+            << "\n\tafter editing one outline: " << edit_ms << " ms"
+            << "\nshape_payload_test: "
+            << ((st.m_failures==0)?"PASSED":"FAILED") << "\n";
+
+  return (st.m_failures==0)?0:-1;
+}
@@ -0,0 +1,345 @@
+/*!
+ * \file shape_tolerance_test.cpp
+ * \brief file shape_tolerance_test.cpp
+ *
+ * Copyright 2013 by Nomovok Ltd.
+ *
+ * Contact: info@nomovok.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ *
+ */
+
+
+#include "WRATHConfig.hpp"
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+#include "WRATHNew.hpp"
+#include "WRATHShape.hpp"
+#include "WRATHShapeSimpleTessellator.hpp"
+
+/*
+  Checks and reports the tolerance driven curve flattening
+  of WRATHShapeSimpleTessellatorPayload, i.e. a positive
+  PayloadParams::m_tolerance. For each shape drawn at
+  each of several scales, it measures how far the
+  tessellated edges are from the analytic curves (Bezier
+  curves of degree 2, 3 and 4 and arcs), in pixels, and
+  counts the points of the tessellation, both with the
+  default PayloadParams and with a tolerance of [tolerance]
+  pixels and PayloadParams::m_max_scale set to the scale.
+  The first shape is the curve of the shape example
+  (demos/examples/shape) in its default 800x600 window.
+  The checks are that
+  - with a tolerance, every edge is within the tolerance
+    of its curve at every scale,
+  - with a tolerance, the number of points does not
+    decrease as the scale increases.
+
+  Usage: shape_tolerance_test [tolerance]
+  The program exits with 0 if all checks pass.
+ */
+
+namespace
+{
+  typedef WRATHShapeSimpleTessellatorPayload TessPayload;
+  typedef WRATHOutline<float> Outline;
+
+  class test_state
+  {
+  public:
+    test_state(void):
+      m_failures(0)
+    {}
+
+    void
+    check(bool v, const std::string &label)
+    {
+      if(!v)
+        {
+          ++m_failures;
+          std::cout << "shape_tolerance_test: check failed: " << label << "\n";
+        }
+    }
+
+    int m_failures;
+  };
+
+  class result
+  {
+  public:
+    result(void):
+      m_number_points(0),
+      m_max_deviation(0.0f)
+    {}
+
+    int m_number_points;
+    float m_max_deviation;
+  };
+
+  /*
+    number of samples of each analytic
+    curve when measuring the deviation
+   */
+  const int number_curve_samples=2048;
+
+  vec2
+  bezier(std::vector<vec2> pts, float t)
+  {
+    for(unsigned int n=pts.size(); n>1; --n)
+      {
+        for(unsigned int i=0; i+1<n; ++i)
+          {
+            pts[i]=(1.0f-t)*pts[i] + t*pts[i+1];
+          }
+      }
+    return pts[0];
+  }
+
+  /*
+    center of the arc of the given angle from
+    p0 to p1, for y increasing upwards the
+    center of a counter clockwise arc of less
+    than a half circle is left of p1-p0.
+   */
+  vec2
+  arc_center(const vec2 &p0, const vec2 &p1, float angle, bool ccw)
+  {
+    vec2 d(p1-p0), n(-d.y(), d.x());
+    float h;
+
+    h=0.5f/std::tan(0.5f*angle);
+    return 0.5f*(p0+p1) + ((ccw)?h:-h)*n;
+  }
+
+  float
+  segment_distance(const vec2 &p, const vec2 &a, const vec2 &b)
+  {
+    vec2 ab(b-a);
+    float L, u;
+
+    L=dot(ab, ab);
+    u=(L>0.0f)?
+      std::max(0.0f, std::min(1.0f, dot(p-a, ab)/L)):
+      0.0f;
+    return (a + u*ab - p).magnitude();
+  }
+
+  /*
+    samples the curve from the point I of
+    the outline to the next point.
+   */
+  void
+  sample_curve(const Outline *outline, int I, std::vector<vec2> &out)
+  {
+    const Outline::point &pt(outline->pt(I));
+    const vec2 &p0(pt.position());
+    const vec2 &p1(outline->pt((I+1)%outline->points().size()).position());
+    const Outline::BezierInterpolator *bez;
+    const Outline::ArcInterpolator *arc;
+
+    bez=dynamic_cast<const Outline::BezierInterpolator*>(pt.interpolator());
+    arc=dynamic_cast<const Outline::ArcInterpolator*>(pt.interpolator());
+
+    out.resize(number_curve_samples+1);
+    if(arc!=NULL)
+      {
+        vec2 c(arc_center(p0, p1, arc->m_angle, arc->m_counter_clockwise));
+        vec2 r(p0-c);
+        float a0(std::atan2(r.y(), r.x())), R(r.magnitude());
+        float sweep((arc->m_counter_clockwise)?arc->m_angle:-arc->m_angle);
+
+        for(int k=0; k<=number_curve_samples; ++k)
+          {
+            float a(a0 + sweep*static_cast<float>(k)/static_cast<float>(number_curve_samples));
+            out[k]=c + R*vec2(std::cos(a), std::sin(a));
+          }
+      }
+    else
+      {
+        std::vector<vec2> pts;
+
+        pts.push_back(p0);
+        if(bez!=NULL)
+          {
+            pts.insert(pts.end(), bez->m_control_points.begin(), bez->m_control_points.end());
+          }
+        pts.push_back(p1);
+
+        for(int k=0; k<=number_curve_samples; ++k)
+          {
+            out[k]=bezier(pts, static_cast<float>(k)/static_cast<float>(number_curve_samples));
+          }
+      }
+  }
+
+  /*
+    tessellates the shape with the parameters and
+    returns the number of points and the largest
+    distance, in pixels at the scale, of a point
+    of an analytic curve to its tessellated edge.
+   */
+  result
+  measure(const WRATHShape<float> &shape, const TessPayload::PayloadParams &params,
+          float scale)
+  {
+    TessPayload::handle T;
+    result R;
+    std::vector<vec2> samples;
+
+    T=WRATHNew TessPayload(shape, params);
+    for(unsigned int o=0, endo=T->tessellation().size(); o<endo; ++o)
+      {
+        const TessPayload::TessellatedOutline::handle &tess(T->tessellation()[o]);
+        const Outline *outline(shape.outline(tess->outlineID()));
+
+        for(unsigned int e=0, ende=tess->edges().size(); e<ende; ++e)
+          {
+            const TessPayload::TessellatedEdge::handle &edge(tess->edges()[e]);
+            const std::vector<TessPayload::CurvePoint> &pts(edge->curve_points());
+
+            R.m_number_points+=pts.size();
+            sample_curve(outline, edge->point_id(), samples);
+            for(unsigned int k=0, endk=samples.size(); k<endk; ++k)
+              {
+                float d(segment_distance(samples[k], pts.front().position(), pts.back().position()));
+
+                for(unsigned int i=1, endi=pts.size(); i<endi; ++i)
+                  {
+                    d=std::min(d, segment_distance(samples[k], pts[i-1].position(), pts[i].position()));
+                  }
+                R.m_max_deviation=std::max(R.m_max_deviation, scale*d);
+              }
+          }
+      }
+    return R;
+  }
+
+  void
+  make_shapes(std::vector<WRATHShape<float>*> &shapes,
+              std::vector<std::string> &labels)
+  {
+    WRATHShape<float> *S;
+
+    /*
+      the quadratic curve of demos/examples/shape
+     */
+    S=WRATHNew WRATHShape<float>();
+    S->new_outline();
+    S->current_outline() << Outline::position_type(0.0f, 0.0f)
+                         << Outline::control_point(Outline::position_type(400.0f, 600.0f))
+                         << Outline::position_type(800.0f, 0.0f);
+    shapes.push_back(S);
+    labels.push_back("shape example");
+
+    S=WRATHNew WRATHShape<float>();
+    S->move_to(vec2(0.0f, 0.0f))
+      .cubic_to(vec2(30.0f, 80.0f), vec2(70.0f, -40.0f), vec2(100.0f, 0.0f));
+    shapes.push_back(S);
+    labels.push_back("cubic");
+
+    S=WRATHNew WRATHShape<float>();
+    S->new_outline();
+    S->current_outline() << Outline::position_type(0.0f, 0.0f)
+                         << Outline::control_point(Outline::position_type(20.0f, 60.0f))
+                         << Outline::control_point(Outline::position_type(50.0f, -60.0f))
+                         << Outline::control_point(Outline::position_type(80.0f, 60.0f))
+                         << Outline::position_type(100.0f, 0.0f);
+    shapes.push_back(S);
+    labels.push_back("quartic");
+
+    S=WRATHNew WRATHShape<float>();
+    S->move_to(vec2(-50.0f, 0.0f));
+    S->current_outline().to_arc(M_PI*0.999f, true);
+    S->line_to(vec2(50.0f, 0.0f));
+    S->current_outline().to_arc(M_PI*0.999f, true);
+    shapes.push_back(S);
+    labels.push_back("circle");
+
+    S=WRATHNew WRATHShape<float>();
+    S->move_to(vec2(10.0f, 0.0f)).line_to(vec2(90.0f, 0.0f));
+    S->current_outline().to_arc(M_PI*0.5f, true);
+    S->line_to(vec2(100.0f, 10.0f)).line_to(vec2(100.0f, 50.0f));
+    S->current_outline().to_arc(M_PI*0.5f, true);
+    S->line_to(vec2(90.0f, 60.0f)).line_to(vec2(10.0f, 60.0f));
+    S->current_outline().to_arc(M_PI*0.5f, true);
+    S->line_to(vec2(0.0f, 50.0f)).line_to(vec2(0.0f, 10.0f));
+    S->current_outline().to_arc(M_PI*0.5f, true);
+    shapes.push_back(S);
+    labels.push_back("rounded rect");
+  }
+}
+
+int
+main(int argc, char **argv)
+{
+  const float scales[]=
+    {
+      0.1f, 1.0f, 10.0f, 100.0f
+    };
+  const int number_scales(sizeof(scales)/sizeof(scales[0]));
+  float tolerance(0.25f);
+  std::vector<WRATHShape<float>*> shapes;
+  std::vector<std::string> labels;
+  test_state st;
+
+  if(argc>1)
+    {
+      tolerance=std::max(0.001f, static_cast<float>(std::atof(argv[1])));
+    }
+
+  make_shapes(shapes, labels);
+
+  std::cout << "Points and max deviation (pixels) of the default parameters"
+            << " and of a tolerance of " << tolerance << " pixels:\n"
+            << std::setw(14) << "shape" << std::setw(8) << "scale"
+            << std::setw(10) << "default" << std::setw(12) << "deviation"
+            << std::setw(11) << "tolerance" << std::setw(12) << "deviation" << "\n";
+
+  for(unsigned int s=0, ends=shapes.size(); s<ends; ++s)
+    {
+      int last_number_points(0);
+
+      for(int i=0; i<number_scales; ++i)
+        {
+          result def, tol;
+
+          def=measure(*shapes[s], TessPayload::PayloadParams(), scales[i]);
+          tol=measure(*shapes[s],
+                      TessPayload::PayloadParams().tolerance(tolerance).max_scale(scales[i]),
+                      scales[i]);
+
+          std::cout << std::setw(14) << labels[s] << std::setw(8) << scales[i]
+                    << std::setw(10) << def.m_number_points
+                    << std::setw(12) << def.m_max_deviation
+                    << std::setw(11) << tol.m_number_points
+                    << std::setw(12) << tol.m_max_deviation << "\n";
+
+          /*
+            allow for the curves being sampled
+            and for float rounding at large scales
+           */
+          st.check(tol.m_max_deviation<=1.05f*tolerance + 0.001f*scales[i],
+                   labels[s] + ": deviation within the tolerance");
+          st.check(tol.m_number_points>=last_number_points,
+                   labels[s] + ": points do not decrease with the scale");
+          last_number_points=tol.m_number_points;
+        }
+      WRATHDelete(shapes[s]);
+    }
+
+  std::cout << "shape_tolerance_test: "
+            << ((st.m_failures==0)?"PASSED":"FAILED") << "\n";
+
+  return (st.m_failures==0)?0:-1;
+}
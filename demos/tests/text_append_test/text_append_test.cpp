@@ -0,0 +1,338 @@
+/*!
+ * \file text_append_test.cpp
+ * \brief file text_append_test.cpp
+ *
+ * Copyright 2013 by Nomovok Ltd.
+ *
+ * Contact: info@nomovok.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ *
+ */
+
+
+#include "WRATHConfig.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+#include "WRATHNew.hpp"
+#include "WRATHTime.hpp"
+#include "WRATHUTF8.hpp"
+#include "WRATHTextData.hpp"
+#include "WRATHTextDataStream.hpp"
+
+#include "ngl_backend.hpp"
+#include "wrath_test.hpp"
+
+/*
+  Checks and times WRATHTextDataStream::append_utf8().
+  The checks are that
+  - WRATHTextData::decode_utf8() decodes exactly as
+    WRATHUTF8, both for valid text and for random
+    (mostly invalid) byte sequences,
+  - for each capitalization mode, appending UTF8 with
+    append_utf8() gives the same raw text as streaming
+    the decoded text through wstream().
+  The time of adding a large document (size_mb
+  megabytes of mostly ASCII text) with append_utf8(),
+  with decoding by WRATHUTF8 and streaming through
+  wstream(), and with stream() is then printed.
+  The stream() path converts with the locale of the
+  stream, so it only gives the same text as the
+  others for a locale whose conversion is UTF8.
+
+  The GL context is only needed because a
+  WRATHTextDataStream fetches the default font.
+ */
+
+class cmd_line_type:public DemoKernelMaker
+{
+public:
+  command_line_argument_value<int> m_size_mb;
+  command_line_argument_value<int> m_random_sequences;
+
+  cmd_line_type(void):
+    m_size_mb(8, "size_mb", "Size in megabytes of the timed text", *this),
+    m_random_sequences(200000, "random_sequences",
+                       "Number of random byte sequences to decode", *this)
+  {}
+
+  virtual
+  DemoKernel*
+  make_demo(void);
+
+  virtual
+  void
+  delete_demo(DemoKernel *k)
+  {
+    if(k!=NULL)
+      {
+        WRATHDelete(k);
+      }
+  }
+};
+
+class TextAppendTest:public TestKernel
+{
+public:
+  TextAppendTest(cmd_line_type *cmd_line);
+  ~TextAppendTest();
+
+protected:
+  virtual
+  void
+  run_test(void);
+
+private:
+  static
+  std::string
+  make_text(size_t sz);
+
+  static
+  void
+  decode_reference(const std::string &text, std::vector<uint32_t> &out);
+
+  void
+  check_decoding(const std::string &text);
+
+  void
+  check_random_decoding(void);
+
+  void
+  check_capitalization(const std::string &text);
+
+  void
+  time_append(const std::string &text);
+
+  cmd_line_type *m_cmd_line;
+};
+
+DemoKernel*
+cmd_line_type::
+make_demo(void)
+{
+  return WRATHNew TextAppendTest(this);
+}
+
+TextAppendTest::
+TextAppendTest(cmd_line_type *cmd_line):
+  TestKernel(cmd_line, "text_append_test"),
+  m_cmd_line(cmd_line)
+{}
+
+TextAppendTest::
+~TextAppendTest()
+{
+  WRATHResourceManagerBase::clear_all_resource_managers();
+}
+
+std::string
+TextAppendTest::
+make_text(size_t sz)
+{
+  /*
+    mostly ASCII with mixed case, with
+    some 2, 3 and 4 byte sequences and
+    letters whose case mapping changes
+    their length (the German sharp s).
+   */
+  const char *words[]=
+    {
+      "The", "quick", "BROWN", "fox", "jumps", "oVeR", "the", "lazy", "dog.",
+      "stra\xc3\x9f" "e", "\xc3\x89" "cole", "\xce\x95\xce\xbb\xce\xbb\xce\xac\xce\xb4\xce\xb1",
+      "\xd0\x9c\xd0\xbe\xd1\x81\xd0\xba\xd0\xb2\xd0\xb0", "\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e",
+      "\xf0\x9f\x98\x80", "title case", "12345,", "\n"
+    };
+  const int number_words(sizeof(words)/sizeof(words[0]));
+  std::string R;
+  unsigned int state(12345);
+
+  R.reserve(sz + 32);
+  while(R.size()<sz)
+    {
+      state=state*1103515245u + 12345u;
+      R.append(words[(state>>16)%number_words]);
+      R.push_back(' ');
+    }
+  return R;
+}
+
+void
+TextAppendTest::
+decode_reference(const std::string &text, std::vector<uint32_t> &out)
+{
+  typedef WRATHUTF8<std::string::const_iterator> UTF8;
+  UTF8 C(text.begin(), text.end());
+
+  for(UTF8::iterator iter=C.begin(), end=C.end(); iter!=end; ++iter)
+    {
+      out.push_back(*iter);
+    }
+}
+
+void
+TextAppendTest::
+check_decoding(const std::string &text)
+{
+  std::vector<uint32_t> expected, decoded;
+  const uint8_t *p(reinterpret_cast<const uint8_t*>(text.data()));
+
+  decode_reference(text, expected);
+  WRATHTextData::decode_utf8(p, p + text.size(), decoded);
+  check(decoded==expected, "decoding matches WRATHUTF8");
+}
+
+void
+TextAppendTest::
+check_random_decoding(void)
+{
+  unsigned int state(6789);
+  int mismatches(0);
+
+  for(int s=0; s<m_cmd_line->m_random_sequences.m_value; ++s)
+    {
+      std::string bytes;
+      std::vector<uint32_t> expected, decoded;
+      int length;
+
+      state=state*1103515245u + 12345u;
+      length=1 + (state>>16)%8;
+      for(int i=0; i<length; ++i)
+        {
+          state=state*1103515245u + 12345u;
+          bytes.push_back(static_cast<char>((state>>16)&0xFF));
+        }
+
+      const uint8_t *p(reinterpret_cast<const uint8_t*>(bytes.data()));
+      decode_reference(bytes, expected);
+      WRATHTextData::decode_utf8(p, p + bytes.size(), decoded);
+      if(decoded!=expected)
+        {
+          ++mismatches;
+        }
+    }
+
+  if(mismatches!=0)
+    {
+      std::cout << "\n" << mismatches << " random byte sequences decoded differently";
+    }
+  check(mismatches==0, "decoding of random bytes matches WRATHUTF8");
+}
+
+void
+TextAppendTest::
+check_capitalization(const std::string &text)
+{
+  const enum WRATHText::capitalization_e modes[]=
+    {
+      WRATHText::capitalization_as_in_stream,
+      WRATHText::capitalization_all_lower_case,
+      WRATHText::capitalization_all_upper_case,
+      WRATHText::capitalization_title_case
+    };
+  const char *labels[]=
+    {
+      "as in stream",
+      "all lower case",
+      "all upper case",
+      "title case"
+    };
+  std::vector<uint32_t> codes;
+  std::wstring wide;
+
+  decode_reference(text, codes);
+  wide.assign(codes.begin(), codes.end());
+
+  for(int m=0; m<4; ++m)
+    {
+      WRATHTextDataStream direct, streamed;
+
+      direct.capitalization(modes[m]);
+      direct.append_utf8(text);
+
+      streamed.capitalization(modes[m]);
+      streamed.wstream() << wide;
+
+      check(direct.raw_text().character_data()==streamed.raw_text().character_data(),
+            std::string("append_utf8 matches wstream() with capitalization ") + labels[m]);
+    }
+}
+
+void
+TextAppendTest::
+time_append(const std::string &text)
+{
+  WRATHTime timer;
+  int32_t direct_ms, stream_ms, wstream_ms;
+  size_t direct_size, wstream_size;
+
+  {
+    WRATHTextDataStream stream;
+
+    timer.restart();
+    stream.append_utf8(text);
+    direct_size=stream.raw_text().character_data().size();
+    direct_ms=timer.elapsed();
+  }
+
+  {
+    WRATHTextDataStream stream;
+
+    timer.restart();
+    stream.stream() << text;
+    stream.raw_text();
+    stream_ms=timer.elapsed();
+  }
+
+  {
+    WRATHTextDataStream stream;
+    std::vector<uint32_t> codes;
+    std::wstring wide;
+
+    timer.restart();
+    decode_reference(text, codes);
+    wide.assign(codes.begin(), codes.end());
+    stream.wstream() << wide;
+    wstream_size=stream.raw_text().character_data().size();
+    wstream_ms=timer.elapsed();
+  }
+
+  check(direct_size==wstream_size, "append_utf8 appends every character");
+
+  float mb(static_cast<float>(text.size())/(1024.0f*1024.0f));
+  std::cout << "\nAppending " << mb << " MB (" << direct_size << " characters):"
+            << "\n\tappend_utf8(): " << direct_ms << " ms";
+  if(direct_ms>0)
+    {
+      std::cout << " (" << 1000.0f*mb/static_cast<float>(direct_ms) << " MB/s)";
+    }
+  std::cout << "\n\tWRATHUTF8 then wstream(): " << wstream_ms << " ms"
+            << "\n\tstream() << std::string (decoded by the locale): " << stream_ms << " ms\n";
+}
+
+void
+TextAppendTest::
+run_test(void)
+{
+  std::string sample(make_text(64*1024));
+
+  check_decoding(sample);
+  check_random_decoding();
+  check_capitalization(sample);
+  time_append(make_text(static_cast<size_t>(m_cmd_line->m_size_mb.m_value)*1024*1024));
+}
+
+int
+main(int argc, char **argv)
+{
+  cmd_line_type cmd_line;
+  return cmd_line.main(argc, argv);
+}
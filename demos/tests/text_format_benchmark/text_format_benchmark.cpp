@@ -0,0 +1,307 @@
+/*!
+ * \file text_format_benchmark.cpp
+ * \brief file text_format_benchmark.cpp
+ *
+ * Copyright 2013 by Nomovok Ltd.
+ *
+ * Contact: info@nomovok.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ *
+ */
+
+
+#include "WRATHConfig.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <pthread.h>
+
+#include "WRATHNew.hpp"
+#include "WRATHTime.hpp"
+#include "WRATHFontFetch.hpp"
+#include "WRATHFreeTypeSupport.hpp"
+#include "WRATHTextDataStream.hpp"
+
+#include "ngl_backend.hpp"
+#include "wrath_test.hpp"
+
+/*
+  Times formatting a large document (size_kb kilobytes,
+  1 MB by default) with the kerning of FreeType fonts
+  read from the per-font kerning tables and with it
+  queried from FreeType for each glyph pair, see
+  WRATHFreeTypeSupport::kerning_table_enabled(). The
+  document is formatted once first so that all glyphs
+  are generated; the timed runs then only lay out text,
+  i.e. read advances and kerning. Each mode is timed
+  formatting the whole document from one thread and
+  formatting a part of it from each of several threads,
+  which is where locking the font for each glyph pair
+  serializes layout. The program checks that both modes
+  give the same glyph positions.
+ */
+
+class cmd_line_type:public DemoKernelMaker
+{
+public:
+  command_line_argument_value<std::string> m_family;
+  command_line_argument_value<int> m_pixel_size;
+  command_line_argument_value<int> m_size_kb;
+  command_line_argument_value<int> m_threads;
+  command_line_argument_value<int> m_repeat;
+
+  cmd_line_type(void):
+    m_family("DejaVu Serif", "family", "Font family to use", *this),
+    m_pixel_size(32, "pixel_size", "Pixel size of the font", *this),
+    m_size_kb(1024, "size_kb", "Size of the document in kilobytes", *this),
+    m_threads(4, "threads", "Number of threads of the parallel runs", *this),
+    m_repeat(3, "repeat", "Number of times each run is made, the best time is printed", *this)
+  {}
+
+  virtual
+  DemoKernel*
+  make_demo(void);
+
+  virtual
+  void
+  delete_demo(DemoKernel *k)
+  {
+    if(k!=NULL)
+      {
+        WRATHDelete(k);
+      }
+  }
+};
+
+class TextFormatBenchmark:public TestKernel
+{
+public:
+  TextFormatBenchmark(cmd_line_type *cmd_line);
+  ~TextFormatBenchmark();
+
+protected:
+  virtual
+  void
+  run_test(void);
+
+private:
+  static
+  std::string
+  make_text(size_t sz);
+
+  static
+  void*
+  format_thread(void *ptr);
+
+  void
+  setup_streams(const std::string &text, int number_streams,
+                std::vector<WRATHTextDataStream*> &streams);
+
+  int32_t
+  time_format(const std::string &text, int number_threads,
+              int number_runs, std::vector<vec2> *positions);
+
+  cmd_line_type *m_cmd_line;
+  WRATHTextureFont *m_font;
+};
+
+DemoKernel*
+cmd_line_type::
+make_demo(void)
+{
+  return WRATHNew TextFormatBenchmark(this);
+}
+
+TextFormatBenchmark::
+TextFormatBenchmark(cmd_line_type *cmd_line):
+  TestKernel(cmd_line, "text_format_benchmark"),
+  m_cmd_line(cmd_line),
+  m_font(NULL)
+{}
+
+TextFormatBenchmark::
+~TextFormatBenchmark()
+{
+  WRATHFreeTypeSupport::kerning_table_enabled(true);
+  WRATHResourceManagerBase::clear_all_resource_managers();
+}
+
+std::string
+TextFormatBenchmark::
+make_text(size_t sz)
+{
+  /*
+    words with many kerned pairs
+   */
+  const char *words[]=
+    {
+      "AVAST", "Towards", "WAVY", "Yolk", "LT", "To", "Wa", "Ye", "P.",
+      "av", "yo", "We", "Va", "LY", "Fa", "Te", "quick", "brown", "fox",
+      "jumps", "over", "the", "lazy", "dog", "\n"
+    };
+  const int number_words(sizeof(words)/sizeof(words[0]));
+  std::string R;
+  unsigned int state(4321);
+
+  R.reserve(sz + 32);
+  while(R.size()<sz)
+    {
+      state=state*1103515245u + 12345u;
+      R.append(words[(state>>16)%number_words]);
+      R.push_back(' ');
+    }
+  return R;
+}
+
+void*
+TextFormatBenchmark::
+format_thread(void *ptr)
+{
+  WRATHTextDataStream *stream(static_cast<WRATHTextDataStream*>(ptr));
+
+  stream->formatted_text();
+  return NULL;
+}
+
+void
+TextFormatBenchmark::
+setup_streams(const std::string &text, int number_streams,
+              std::vector<WRATHTextDataStream*> &streams)
+{
+  size_t begin(0);
+
+  streams.resize(number_streams);
+  for(int i=0; i<number_streams; ++i)
+    {
+      size_t end;
+
+      end=(i+1==number_streams)?
+        text.size():
+        text.find('\n', (text.size()*(i+1))/number_streams);
+      end=std::min(end, text.size());
+
+      streams[i]=WRATHNew WRATHTextDataStream();
+      streams[i]->stream() << WRATHText::set_font(m_font)
+                           << WRATHText::set_pixel_size(m_cmd_line->m_pixel_size.m_value);
+      streams[i]->append_utf8(text.data() + begin, text.data() + end);
+      streams[i]->raw_text();
+      begin=end;
+    }
+}
+
+int32_t
+TextFormatBenchmark::
+time_format(const std::string &text, int number_threads,
+            int number_runs, std::vector<vec2> *positions)
+{
+  int32_t best(-1);
+
+  for(int r=0; r<number_runs; ++r)
+    {
+      std::vector<WRATHTextDataStream*> streams;
+      std::vector<pthread_t> threads(number_threads);
+      WRATHTime timer;
+      int32_t ms;
+
+      setup_streams(text, number_threads, streams);
+
+      timer.restart();
+      if(number_threads==1)
+        {
+          streams[0]->formatted_text();
+        }
+      else
+        {
+          for(int t=0; t<number_threads; ++t)
+            {
+              pthread_create(&threads[t], NULL, format_thread, streams[t]);
+            }
+          for(int t=0; t<number_threads; ++t)
+            {
+              pthread_join(threads[t], NULL);
+            }
+        }
+      ms=timer.elapsed();
+      best=(best<0)?ms:std::min(best, ms);
+
+      if(positions!=NULL and r==0)
+        {
+          for(int s=0; s<number_threads; ++s)
+            {
+              const std::vector<WRATHFormattedTextStream::glyph_instance> &glyphs(streams[s]->formatted_text().data_stream());
+
+              for(unsigned int g=0, endg=glyphs.size(); g<endg; ++g)
+                {
+                  positions->push_back(glyphs[g].m_position);
+                }
+            }
+        }
+
+      for(int s=0; s<number_threads; ++s)
+        {
+          WRATHDelete(streams[s]);
+        }
+    }
+  return best;
+}
+
+void
+TextFormatBenchmark::
+run_test(void)
+{
+  std::string text(make_text(static_cast<size_t>(m_cmd_line->m_size_kb.m_value)*1024));
+  int number_threads(std::max(2, m_cmd_line->m_threads.m_value));
+  std::vector<vec2> table_positions, freetype_positions;
+  int number_runs(std::max(1, m_cmd_line->m_repeat.m_value));
+  int32_t warm_ms, table_ms, freetype_ms, table_parallel_ms, freetype_parallel_ms;
+
+  m_font=WRATHFontFetch::fetch_font(m_cmd_line->m_pixel_size.m_value,
+                                    WRATHFontFetch::FontProperties()
+                                    .family_name(m_cmd_line->m_family.m_value));
+  if(!check(m_font!=NULL, "fetching a font"))
+    {
+      return;
+    }
+
+  /*
+    generate the glyphs and the kerning table
+   */
+  WRATHFreeTypeSupport::kerning_table_enabled(true);
+  warm_ms=time_format(text, 1, 1, NULL);
+
+  table_ms=time_format(text, 1, number_runs, &table_positions);
+  table_parallel_ms=time_format(text, number_threads, number_runs, NULL);
+
+  WRATHFreeTypeSupport::kerning_table_enabled(false);
+  freetype_ms=time_format(text, 1, number_runs, &freetype_positions);
+  freetype_parallel_ms=time_format(text, number_threads, number_runs, NULL);
+
+  WRATHFreeTypeSupport::kerning_table_enabled(true);
+
+  check(table_positions==freetype_positions,
+        "kerning tables give the same glyph positions as FreeType");
+
+  std::cout << "\nFormatting " << text.size()/1024 << " KB with "
+            << m_font->simple_name() << " at " << m_cmd_line->m_pixel_size.m_value << " px"
+            << " (first run, generating glyphs: " << warm_ms << " ms):"
+            << "\n\tkerning tables, 1 thread: " << table_ms << " ms"
+            << "\n\tkerning tables, " << number_threads << " threads: " << table_parallel_ms << " ms"
+            << "\n\tFreeType kerning, 1 thread: " << freetype_ms << " ms"
+            << "\n\tFreeType kerning, " << number_threads << " threads: " << freetype_parallel_ms << " ms"
+            << "\n";
+}
+
+int
+main(int argc, char **argv)
+{
+  cmd_line_type cmd_line;
+  return cmd_line.main(argc, argv);
+}
@@ -0,0 +1,240 @@
+/*!
+ * \file text_pack_benchmark.cpp
+ * \brief file text_pack_benchmark.cpp
+ *
+ * Copyright 2013 by Nomovok Ltd.
+ *
+ * Contact: info@nomovok.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ *
+ */
+
+
+#include "WRATHConfig.hpp"
+#include <iostream>
+#include <vector>
+
+#include "vecN.hpp"
+#include "WRATHNew.hpp"
+#include "WRATHTime.hpp"
+#include "WRATHParallelFor.hpp"
+#include "WRATHTextDataStream.hpp"
+#include "WRATHLayerItemWidgetsTranslate.hpp"
+
+#include "ngl_backend.hpp"
+#include "wrath_test.hpp"
+
+/*
+  Measures the throughput of packing the glyph attributes of
+  text items that share their attribute stores, first from
+  one thread and then from several threads with WRATHParallelFor.
+  Each item is cleared and its text added again for each round,
+  so the timing is of allocation and packing, the glyphs are
+  generated before the timing starts. WRATHParallelFor creates
+  its threads for each round, so the staging buffers of the
+  text packer are also created and freed on thread exit for
+  each round.
+ */
+
+class cmd_line_type:public DemoKernelMaker
+{
+public:
+  command_line_argument_value<int> m_number_items;
+  command_line_argument_value<int> m_number_lines;
+  command_line_argument_value<int> m_number_rounds;
+  command_line_argument_value<int> m_number_threads;
+
+  cmd_line_type(void):
+    m_number_items(64, "items", "Number of text items", *this),
+    m_number_lines(40, "lines", "Number of lines of text of each text item", *this),
+    m_number_rounds(20, "rounds", "Number of times each item is packed for each measurement", *this),
+    m_number_threads(0, "threads",
+                     "Number of threads for the parallel measurement, "
+                     "0 means WRATHParallelFor's default", *this)
+  {}
+
+  virtual
+  DemoKernel*
+  make_demo(void);
+
+  virtual
+  void
+  delete_demo(DemoKernel *k)
+  {
+    if(k!=NULL)
+      {
+        WRATHDelete(k);
+      }
+  }
+};
+
+class TextPackBenchmark:public TestKernel
+{
+public:
+  TextPackBenchmark(cmd_line_type *cmd_line);
+  ~TextPackBenchmark();
+
+protected:
+  virtual
+  void
+  run_test(void);
+
+private:
+  typedef WRATHLayerTranslateFamilySet::PlainFamily::TextWidget TextWidget;
+
+  class PackJob:public WRATHParallelFor::Job
+  {
+  public:
+    PackJob(TextPackBenchmark *p):
+      m_p(p)
+    {}
+
+    virtual
+    void
+    execute(int i)
+    {
+      m_p->m_items[i]->clear();
+      m_p->m_items[i]->add_text(m_p->m_text);
+    }
+
+    TextPackBenchmark *m_p;
+  };
+
+  int32_t
+  measure(int number_threads);
+
+  cmd_line_type *m_cmd_line;
+  WRATHTripleBufferEnabler::handle m_tr;
+  WRATHLayer *m_layer;
+  WRATHTextDataStream m_text;
+  std::vector<TextWidget*> m_items;
+};
+
+DemoKernel*
+cmd_line_type::
+make_demo(void)
+{
+  return WRATHNew TextPackBenchmark(this);
+}
+
+TextPackBenchmark::
+TextPackBenchmark(cmd_line_type *cmd_line):
+  TestKernel(cmd_line, "text_pack_benchmark"),
+  m_cmd_line(cmd_line)
+{
+  m_tr=WRATHNew WRATHTripleBufferEnabler();
+  m_layer=WRATHNew WRATHLayer(m_tr);
+}
+
+TextPackBenchmark::
+~TextPackBenchmark()
+{
+  WRATHPhasedDelete(m_layer);
+  WRATHResourceManagerBase::clear_all_resource_managers();
+  m_tr->purge_cleanup();
+  m_tr=NULL;
+}
+
+int32_t
+TextPackBenchmark::
+measure(int number_threads)
+{
+  PackJob job(this);
+  WRATHTime timer;
+  int saved_threads(WRATHParallelFor::max_number_threads());
+
+  WRATHParallelFor::max_number_threads(number_threads);
+  timer.restart();
+  for(int r=0; r<m_cmd_line->m_number_rounds.m_value; ++r)
+    {
+      WRATHParallelFor::run(job, m_items.size());
+    }
+  WRATHParallelFor::max_number_threads(saved_threads);
+
+  return timer.elapsed();
+}
+
+void
+TextPackBenchmark::
+run_test(void)
+{
+  int number_threads, number_glyphs;
+  int32_t single_ms, parallel_ms;
+  vecN<WRATHTextAttributePacker::BBox, 2> boxes;
+
+  m_text.stream() << WRATHText::set_pixel_size(16)
+                  << WRATHText::set_color(0, 0, 0);
+  for(int l=0; l<m_cmd_line->m_number_lines.m_value; ++l)
+    {
+      m_text.stream() << "Line " << l
+                      << ": the quick brown fox jumps over the lazy dog\n";
+    }
+
+  /*
+    create the items and pack them once
+    so that the glyphs are generated before
+    timing.
+   */
+  for(int i=0; i<m_cmd_line->m_number_items.m_value; ++i)
+    {
+      m_items.push_back(WRATHNew TextWidget(m_layer, WRATHTextItemTypes::text_transparent));
+      m_items.back()->add_text(m_text);
+    }
+  boxes[0]=m_items.front()->bounding_box();
+
+  number_threads=(m_cmd_line->m_number_threads.m_value>0)?
+    m_cmd_line->m_number_threads.m_value:
+    WRATHParallelFor::max_number_threads();
+
+  single_ms=measure(1);
+  parallel_ms=measure(number_threads);
+
+  /*
+    packing from several threads must give
+    the same text as packing from one.
+   */
+  boxes[1]=m_items.back()->bounding_box();
+  check(boxes[0].min_corner()==boxes[1].min_corner()
+        and boxes[0].max_corner()==boxes[1].max_corner(),
+        "bounding box of text packed from several threads");
+
+  number_glyphs=m_text.formatted_text().data_stream().size()
+    *m_items.size()*m_cmd_line->m_number_rounds.m_value;
+
+  std::cout << "\nPacked " << number_glyphs << " glyphs in "
+            << m_items.size() << " text items:"
+            << "\n\t1 thread: " << single_ms << " ms";
+  if(single_ms>0)
+    {
+      std::cout << " (" << number_glyphs/single_ms << " glyphs/ms)";
+    }
+  std::cout << "\n\t" << number_threads << " threads: " << parallel_ms << " ms";
+  if(parallel_ms>0)
+    {
+      std::cout << " (" << number_glyphs/parallel_ms << " glyphs/ms, speedup "
+                << static_cast<float>(single_ms)/static_cast<float>(parallel_ms)
+                << ")";
+    }
+  std::cout << "\n";
+
+  for(std::vector<TextWidget*>::iterator iter=m_items.begin(),
+        end=m_items.end(); iter!=end; ++iter)
+    {
+      WRATHDelete(*iter);
+    }
+  m_items.clear();
+}
+
+int
+main(int argc, char **argv)
+{
+  cmd_line_type cmd_line;
+  return cmd_line.main(argc, argv);
+}
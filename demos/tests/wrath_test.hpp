@@ -0,0 +1,102 @@
+/*! 
+ * \file wrath_test.hpp
+ * \brief file wrath_test.hpp
+ * 
+ * Copyright 2013 by Nomovok Ltd.
+ * 
+ * Contact: info@nomovok.com
+ * 
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ * 
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ * 
+ */
+
+
+#ifndef WRATH_DEMO_TEST_HPP_
+#define WRATH_DEMO_TEST_HPP_
+
+#include "WRATHConfig.hpp"
+#include <iostream>
+#include <string>
+#include "wrath_demo.hpp"
+
+/*
+  A TestKernel is the DemoKernel of the programs
+  under demos/tests: run_test() is called on the
+  first paint, i.e. with the GL context current,
+  then the demo ends. Checks are made with check()
+  which prints each failed check; the summary line
+  printed at the end is "PASSED" or "FAILED" so
+  that the output can be grepped by a script.
+ */
+class TestKernel:public DemoKernel
+{
+public:
+  TestKernel(DemoKernelMaker *q, const std::string &name):
+    DemoKernel(q),
+    m_name(name),
+    m_done(false),
+    m_number_failures(0)
+  {}
+
+  virtual
+  void
+  paint(void)
+  {
+    if(!m_done)
+      {
+        m_done=true;
+        run_test();
+        std::cout << m_name << ": " 
+                  << ((m_number_failures==0)? "PASSED": "FAILED")
+                  << "\n";
+        end_demo();
+      }
+  }
+
+  virtual
+  void
+  handle_event(FURYEvent::handle)
+  {}
+
+  int
+  number_failures(void) const
+  {
+    return m_number_failures;
+  }
+
+protected:
+  /*
+    to be implemented by a derived class
+    to run the test.
+   */
+  virtual
+  void
+  run_test(void)=0;
+
+  /*
+    records a failure if v is false.
+   */
+  bool
+  check(bool v, const std::string &label)
+  {
+    if(!v)
+      {
+        ++m_number_failures;
+        std::cout << m_name << ": check failed: " << label << "\n";
+      }
+    return v;
+  }
+
+private:
+  std::string m_name;
+  bool m_done;
+  int m_number_failures;
+};
+
+#endif
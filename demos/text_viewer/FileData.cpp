@@ -210,7 +210,9 @@ FileData(FilePacket *pparent, const std::string &pfilename,
   m_container(NULL),
   m_tr(NULL),
   m_number_chars(0),
-  m_number_streams(0)
+  m_number_streams(0),
+  m_chunk_index(NULL),
+  m_link_index(NULL)
 {
 }
 
@@ -239,6 +241,12 @@ FileData::
     }
 
 
+  if(m_chunk_index!=NULL)
+    {
+      WRATHDelete(m_chunk_index);
+      WRATHDelete(m_link_index);
+    }
+
   if(m_container!=NULL)
     {
       WRATHPhasedDelete(m_container);
@@ -265,6 +273,8 @@ load_file(void)
   m_container->visible(false);
 
   m_tr=WRATHNew WRATHLayerItemNodeRotateTranslate(m_container->root_node<WRATHLayerItemNodeRotateTranslate>());
+  m_chunk_index=WRATHNew ChunkIndex(m_tr);
+  m_link_index=WRATHNew LinkIndex(m_tr);
 
   //NOTE: this operation can be threaded:
   m_parent->load_file(m_filename, this, m_file_type);
@@ -304,8 +314,11 @@ reload_file(void)
     }
 
   m_text_chunks.clear();
+  m_empty_chunks.clear();
   m_images.clear();
   m_links.clear();
+  m_chunk_index->clear();
+  m_link_index->clear();
   m_shapes.clear();
 
   m_number_streams=0;
@@ -337,6 +350,14 @@ add_text(const WRATHFormattedTextStream &ptext,
                            ptext, pstate_stream,
                            m_container, m_parent, m_tr);
       m_text_chunks.push_back(ptr);
+      if(!ptr->bbox().empty())
+        {
+          m_chunk_index->add(ptr, ptr->bbox());
+        }
+      else
+        {
+          m_empty_chunks.push_back(ptr);
+        }
 
       m_bbox.set_or(ptr->bbox());
     }
@@ -348,24 +369,29 @@ void
 FileData::
 update_culling(const ivec2 &window_size, bool disable_culling)
 {
-  WRATH2DRigidTransformation R;
-  WRATHTextAttributePacker::BBox window_box;
-
   load_file();
 
-  R=m_tr->global_values().m_transformation.inverse();
-    
-  window_box.set_or(R.apply_to_point(vec2(0,0)));
-  window_box.set_or(R.apply_to_point(vec2(0, window_size.y())));
-  window_box.set_or(R.apply_to_point(vec2(window_size.x(), 0)));
-  window_box.set_or(R.apply_to_point(vec2(window_size.x(), window_size.y())));
+  /*
+    the index only changes the visibility
+    of those chunks that enter or leave
+    the window.
+   */
+  if(disable_culling)
+    {
+      m_chunk_index->uncull();
+    }
+  else
+    {
+      m_chunk_index->cull(ChunkIndex::BBox(vec2(0.0f, 0.0f),
+                                           vec2(window_size.x(), window_size.y())));
+    }
+
   for(std::vector<TextChunk*>::iterator 
-        iter=m_text_chunks.begin(), 
-        end=m_text_chunks.end();
+        iter=m_empty_chunks.begin(), 
+        end=m_empty_chunks.end();
       iter!=end; ++iter)
     {
-      TextChunk *ptr(*iter);
-      ptr->visible(disable_culling or window_box.intersects(ptr->bbox()));
+      (*iter)->visible(disable_culling);
     }
 }
 
@@ -373,21 +399,7 @@ const FileData::LinkAtResult*
 FileData::
 link_at(int x, int y)
 {
-  vec2 pos(x, y);
-
-  pos=m_tr->global_values().m_transformation.inverse().apply_to_point(pos);
-
-  //TODO: quad tree search of link:  
-  for(std::vector<PerLink>::iterator iter=m_links.begin(),
-        end=m_links.end(); iter!=end; ++iter)
-    {
-      if(iter->m_bbox.intersects(pos))
-        {
-          return &iter->m_file;
-        }
-    }
-
-  return NULL;
+  return m_link_index->first_at(vec2(x, y));
 }
 
 
@@ -422,18 +434,22 @@ add_link(FileData *pfile,
          const WRATHTextAttributePacker::BBox &bbox,
          const std::pair<bool, std::string> &jump_location)
 {
-  //TODO: create quad search tree for fast
-  //intersection test:
   m_links.push_back(PerLink(LinkAtResult(pfile, jump_location), bbox));
+  if(!bbox.empty())
+    {
+      m_link_index->add(&m_links.back().m_file, bbox);
+    }
 }
 
 void
 FileData::
 add_quit_link(const WRATHTextAttributePacker::BBox &bbox)
 {
-  //TODO: create quad search tree for fast
-  //intersection test:
   m_links.push_back(PerLink(LinkAtResult(), bbox));
+  if(!bbox.empty())
+    {
+      m_link_index->add(&m_links.back().m_file, bbox);
+    }
 }
 
 
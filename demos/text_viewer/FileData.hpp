@@ -22,6 +22,7 @@
 
 #include "WRATHConfig.hpp"
 #include <string>
+#include <list>
 #include "WRATHTextDataStream.hpp"
 #include "TextChunk.hpp"
 #include "vectorGL.hpp"
@@ -33,6 +34,7 @@
 #include "WRATHShaderSpecifier.hpp"
 #include "WRATHLayer.hpp"
 #include "WRATHLayerItemNodeRotateTranslate.hpp"
+#include "WRATHLayerItemNodeSpatialIndex.hpp"
 
 class FilePacket;
 class FileData
@@ -230,6 +232,9 @@ private:
     WRATHTextAttributePacker::BBox m_bbox;
   };
 
+  typedef WRATHLayerItemNodeSpatialIndex<WRATHLayerItemNodeRotateTranslate, TextChunk> ChunkIndex;
+  typedef WRATHLayerItemNodeSpatialIndex<WRATHLayerItemNodeRotateTranslate, LinkAtResult> LinkIndex;
+
 
   std::string m_filename;
   file_fetch_type m_file_type;
@@ -239,10 +244,23 @@ private:
   WRATHLayer *m_container;
   WRATHLayerItemNodeRotateTranslate *m_tr;
   std::vector<TextChunk*> m_text_chunks;
+
+  /*
+    chunks with an empty bounding box are not
+    in m_chunk_index, they are culled always
+    unless culling is disabled.
+   */
+  std::vector<TextChunk*> m_empty_chunks;
   WRATHTextAttributePacker::BBox m_bbox;
   int m_number_chars, m_number_streams;
 
-  std::vector<PerLink> m_links;
+  /*
+    std::list so that the LinkAtResult
+    pointers of m_link_index stay valid
+   */
+  std::list<PerLink> m_links;
+  ChunkIndex *m_chunk_index;
+  LinkIndex *m_link_index;
   std::vector<WRATHRectItem*> m_images;
   std::vector<WRATHShapeItem*> m_shapes;
   std::map<std::string, vec2> m_jump_tags;
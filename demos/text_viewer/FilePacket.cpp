@@ -776,11 +776,15 @@ namespace
   public:
     tess_params_argc(WRATHShapeSimpleTessellatorPayload::PayloadParams &pp):
       m_curve_tessellation(pp.m_curve_tessellation, "curve_tess", *this),
-      m_max_recurse(pp.m_max_recurse, "max_recurse", *this)
+      m_max_recurse(pp.m_max_recurse, "max_recurse", *this),
+      m_tolerance(pp.m_tolerance, "tess_tolerance", *this),
+      m_max_scale(pp.m_max_scale, "tess_max_scale", *this)
     {}
     
     command_arg<unsigned int&> m_curve_tessellation;
     command_arg<int&> m_max_recurse;
+    command_arg<float&> m_tolerance;
+    command_arg<float&> m_max_scale;
   };
 
   class stroke_params_args:public command_line_register
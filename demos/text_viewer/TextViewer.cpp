@@ -212,6 +212,7 @@ public:
   command_line_argument_value<int> m_text_renderer_coverage_min_filter;
   command_line_argument_value<int> m_text_renderer_converage_mag_filter;
   command_line_argument_value<int> m_text_renderer_converage_deepness_slack; 
+  command_line_argument_value<bool> m_text_renderer_converage_downsample_mipmaps;
   command_line_argument_value<int> m_text_renderer_analytic_mipmap_level;
   command_line_argument_value<float> m_mix_font_div_ratio;
   command_line_argument_value<float> m_mix_font_minified_inflate_factor;
@@ -238,6 +239,7 @@ public:
   command_line_argument_value<int> m_bg_red, m_bg_blue, m_bg_green, m_bg_alpha;
   
   command_line_argument_value<bool> m_show_perf_stats, m_smart_update;
+  command_line_argument_value<bool> m_kerning_table;
 
   command_line_argument_value<int> m_up_key, m_down_key;
   command_line_argument_value<int> m_left_key, m_right_key;
@@ -350,6 +352,12 @@ public:
                                              "mipmaps, determines the mipmap level used "
                                              "to which to add slack ",
                                              *this),
+    m_text_renderer_converage_downsample_mipmaps(false, "text_coverage_downsample_mips",
+                                                 "When genering coverage fonts, if true "
+                                                 "mipmaps are computed by downsampling "
+                                                 "the base level instead of rendering "
+                                                 "each level with FreeType",
+                                                 *this),
 
     m_text_renderer_analytic_mipmap_level(1, "analytic_mipmap_level",
                                           "Number of mipmap levels for an Analytic font "
@@ -428,6 +436,11 @@ public:
 
     m_show_perf_stats(false, "show_perf", "Show performance/debug stats", *this),
     m_smart_update(true, "smart_update", "Only repaint when necessary", *this),
+    m_kerning_table(true, "kerning_table", 
+                    "If true, kerning is read from per-font kerning tables "
+                    "without locking the font, if false kerning is queried "
+                    "from FreeType for each glyph pair. Use with show_perf "
+                    "to see the time to format the file", *this),
 
     m_up_key(FURYKey_Up,"up_key", "FURY-Key code for scroll up", *this),
     m_down_key(FURYKey_Down,"down_key", "FURY-Key code for scroll down", *this),
@@ -944,6 +957,7 @@ TextViewer(cmd_line_type &cmd_line):
     command to specify maximum number of nodes per draw call...
    */
   NodePacker::max_node_count()=cmd_line.m_max_transformations.m_value;
+  WRATHFreeTypeSupport::kerning_table_enabled(cmd_line.m_kerning_table.m_value);
 
 
   int analytic_mip_value(std::max(1,cmd_line.m_text_renderer_analytic_mipmap_level.m_value));
@@ -1180,6 +1194,9 @@ TextViewer(cmd_line_type &cmd_line):
   WRATHTextureFontFreeType_Coverage::minification_filter(filter_tags[min_filter]);
   WRATHTextureFontFreeType_Coverage::magnification_filter(filter_tags[mag_filter]);
   WRATHTextureFontFreeType_Coverage::mipmap_slacking_threshhold_level(cmd_line.m_text_renderer_converage_deepness_slack.m_value);
+  WRATHTextureFontFreeType_Coverage::mipmap_generation(cmd_line.m_text_renderer_converage_downsample_mipmaps.m_value?
+                                                       WRATHTextureFontFreeType_Coverage::downsample_mipmap_levels:
+                                                       WRATHTextureFontFreeType_Coverage::render_each_mipmap_level);
 
   //////////////////////////////////////
   // load font:
@@ -1441,10 +1458,20 @@ TextViewer(cmd_line_type &cmd_line):
           filename.push_back(DIRECTORY_SLASH);
         }
     }
+  WRATHTime load_time;
   m_current_display_contents=
     m_all_contents->fetch_file(filename, load_type);
   m_current_display_contents->container().visible(true);
 
+  if(m_show_stats)
+    {
+      std::cout << "\nLoaded and formatted " << filename 
+                << " (" << m_current_display_contents->number_chars()
+                << " characters) in " << load_time.elapsed() << " ms, kerning tables "
+                << (WRATHFreeTypeSupport::kerning_table_enabled()? "enabled": "disabled")
+                << "\n";
+    }
+
 
   //only for debug:
   if(m_show_stats or m_load_font_in_thread)
@@ -1489,7 +1516,7 @@ TextViewer(cmd_line_type &cmd_line):
   m_key_commands.push_back(on_key_command(&TextViewer::on_print_font_texture_consumption,
                                           m_print_texture_consumption));
 
-  glClearColor(m_bg_color[0], m_bg_color[1], m_bg_color[2], m_bg_color[3]);
+  WRATHGLStateShadow::clear_color(vec4(m_bg_color[0], m_bg_color[1], m_bg_color[2], m_bg_color[3]));
   update_transformation();
 }
 
@@ -1673,7 +1700,7 @@ paint(void)
 
   if(m_viewport_sz.x()!=width() or m_viewport_sz.y()!=height())
     {
-      glViewport(0, 0, width(), height());
+      WRATHGLStateShadow::viewport(vecN<GLint, 4>(0, 0, width(), height()));
 
       m_viewport_sz.x()=width();
       m_viewport_sz.y()=height();
@@ -1817,9 +1844,9 @@ paint(void)
   m_tr->signal_begin_presentation_frame();
 
 
-  glDepthMask(GL_TRUE);
-  glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-  glClearColor(m_bg_color[0], m_bg_color[1], m_bg_color[2], m_bg_color[3]);
+  WRATHGLStateShadow::depth_mask(GL_TRUE);
+  WRATHGLStateShadow::color_mask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+  WRATHGLStateShadow::clear_color(vec4(m_bg_color[0], m_bg_color[1], m_bg_color[2], m_bg_color[3]));
   glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT|GL_STENCIL_BUFFER_BIT);
   
 
@@ -123,6 +123,29 @@ namespace FURYQT
     void
     enable_text_mode(bool);
 
+    /*!\fn enable_coalescing
+      If true, events are not signaled as 
+      they are fed. Instead they are held in
+      a FURYEventQueue, which merges consecutive 
+      motion events of the same pointer, and 
+      are signaled when dispatch_events() is
+      called, typically once per frame. 
+      Default value is false. Because Qt
+      deletes the QEvent of an UnknownEvent, 
+      the held events are dispatched before 
+      an UnknownEvent is signaled.
+     */
+    void
+    enable_coalescing(bool);
+
+    /*!\fn dispatch_events
+      Signals the events held since the last
+      call to dispatch_events(). Does nothing
+      if coalescing is not enabled.
+     */
+    void
+    dispatch_events(void);
+
     /*
       what to call to feed events
       
@@ -113,6 +113,26 @@ namespace FURYSDL
     void
     enable_text_mode(bool);
 
+    /*!\fn enable_coalescing
+      If true, events are not signaled as 
+      they are fed. Instead they are held in
+      a FURYEventQueue, which merges consecutive 
+      motion events of the same pointer, and 
+      are signaled when dispatch_events() is
+      called, typically once per frame. 
+      Default value is false.
+     */
+    void
+    enable_coalescing(bool);
+
+    /*!\fn dispatch_events
+      Signals the events held since the last
+      call to dispatch_events(). Does nothing
+      if coalescing is not enabled.
+     */
+    void
+    dispatch_events(void);
+
     /*!\fn feed_event
       Feed an SDL Event to the EventProducer
      */
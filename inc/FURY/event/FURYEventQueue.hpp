@@ -0,0 +1,281 @@
+/*! 
+ * \file FURYEventQueue.hpp
+ * \brief file FURYEventQueue.hpp
+ * 
+ * Copyright 2013 by Nomovok Ltd.
+ * 
+ * Contact: info@nomovok.com
+ * 
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ * 
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ * 
+ */
+
+
+#ifndef FURY_EVENT_QUEUE_HPP_
+#define FURY_EVENT_QUEUE_HPP_
+
+#include "WRATHConfig.hpp"
+#include <vector>
+#include <algorithm>
+#include <boost/utility.hpp>
+#include <boost/signals2.hpp>
+#include "FURYEvent.hpp"
+#include "FURYMouseEvent.hpp"
+#include "FURYTouchEvent.hpp"
+
+/*!\class FURYEventQueue
+  A FURYEventQueue holds events until dispatch()
+  is called, typically once per simulation frame.
+  When coalescing is enabled, a mouse motion
+  event (respectively touch motion event) is
+  merged with the last queued motion event of
+  the same mouse (respectively touch ID) provided
+  that no event other than a mouse or touch motion
+  event was queued after it. As such the order of
+  motion events relative to button, key, text and
+  all other events is preserved. A merged motion
+  event has the position (and pressure) of the
+  latest motion event and the sum of the deltas
+  of the merged events.
+
+  Motion events fed with push_mouse_motion() and
+  push_touch_motion() are stored by value. The
+  FURYMouseMotionEvent and FURYTouchEvent objects
+  signaled on dispatch() come from a per-frame
+  arena of the queue: an event object is reused
+  by a later dispatch() once no handle other than
+  the arena's references it, so that in steady
+  state dispatching motion events allocates
+  nothing. Slots may keep the handles they are
+  passed, such events are simply not reused
+  until released. The storage of the queue is
+  also reused from one dispatch to the next.
+ */
+class FURYEventQueue:boost::noncopyable
+{
+public:
+  /*!\typedef signal_t
+    Signal type.
+   */
+  typedef boost::signals2::signal<void (FURYEvent::handle)> signal_t;
+
+  /*!\typedef slot_type
+    Slot type.
+   */
+  typedef signal_t::slot_type slot_type;
+
+  /*!\typedef connect_t
+    Convenience typedef for the connection type.
+   */
+  typedef boost::signals2::connection connect_t;
+
+  /*!\fn FURYEventQueue
+    Ctor. Coalescing is initially enabled.
+   */
+  FURYEventQueue(void);
+
+  /*!\fn connect_t connect(const slot_type&)
+    Connects a subscribing slot to the signal
+    fired for each event on dispatch().
+    \param subscriber Subscriber slot
+   */
+  connect_t
+  connect(const slot_type &subscriber);
+
+  /*!\fn void coalesce(bool)
+    Set if motion events are merged as
+    they are queued. Default value is true.
+    \param v value to use
+   */
+  void
+  coalesce(bool v)
+  {
+    m_coalesce=v;
+  }
+
+  /*!\fn bool coalesce(void) const
+    Returns if motion events are merged as
+    they are queued.
+   */
+  bool
+  coalesce(void) const
+  {
+    return m_coalesce;
+  }
+
+  /*!\fn void push(const FURYEvent::handle&)
+    Queue an event. If the event is a
+    FURYMouseMotionEvent or a FURYTouchEvent
+    of type FURYEvent::TouchMotion, then the
+    event is queued as if by push_mouse_motion()
+    or push_touch_motion().
+    \param ev event to queue, if not valid then
+              nothing is queued
+   */
+  void
+  push(const FURYEvent::handle &ev);
+
+  /*!\fn void push_mouse_motion
+    Queue a mouse motion event without
+    creating a FURYMouseMotionEvent.
+    \param pt position of mouse
+    \param delta change in the position of the mouse
+    \param mouse which mouse
+   */
+  void
+  push_mouse_motion(const ivec2 &pt, const ivec2 &delta,
+                    FURYMouse mouse=FURYMouse(0));
+
+  /*!\fn void push_touch_motion
+    Queue a touch motion event without
+    creating a FURYTouchEvent.
+    \param id touch ID
+    \param position position of the touch
+    \param delta change in the position of the touch
+    \param pressure pressure of the touch
+   */
+  void
+  push_touch_motion(FURYTouchID id,
+                    const vec2 &position, const vec2 &delta,
+                    float pressure);
+
+  /*!\fn unsigned int number_pending
+    Returns the number of events queued,
+    after coalescing, since the last dispatch().
+   */
+  unsigned int
+  number_pending(void) const
+  {
+    return m_pending.size();
+  }
+
+  /*!\fn unsigned int number_coalesced
+    Returns the number of events that were
+    merged into an already queued event since
+    the last dispatch().
+   */
+  unsigned int
+  number_coalesced(void) const
+  {
+    return m_number_coalesced;
+  }
+
+  /*!\fn void dispatch
+    Fires the signal for each queued event,
+    in order, and empties the queue. Events
+    queued by the slots during dispatch() are
+    held for the next call to dispatch().
+    Calling dispatch() from a slot does nothing.
+   */
+  void
+  dispatch(void);
+
+  /*!\fn void clear
+    Drop all queued events without
+    firing the signal.
+   */
+  void
+  clear(void);
+
+private:
+
+  enum entry_type
+    {
+      event_entry,
+      mouse_motion_entry,
+      touch_motion_entry
+    };
+
+  class entry
+  {
+  public:
+    enum entry_type m_type;
+    FURYEvent::handle m_event;
+    int m_pointer;
+    vec2 m_position, m_delta;
+    float m_pressure;
+  };
+
+  /*
+    Arena of event objects of type T, the events
+    handed out since begin_frame() are at
+    [0, m_next), the events at [m_next, m_scan)
+    are still referenced outside of the arena
+    and those at [m_scan, end) are not yet
+    examined this frame.
+   */
+  template<typename T>
+  class event_arena
+  {
+  public:
+    event_arena(void):
+      m_next(0),
+      m_scan(0)
+    {}
+
+    void
+    begin_frame(void)
+    {
+      m_next=0;
+      m_scan=0;
+    }
+
+    /*
+      returns an event of the arena referenced
+      by nothing else, or NULL if there is none.
+     */
+    T*
+    reuse(void)
+    {
+      for(; m_scan<m_events.size(); ++m_scan)
+        {
+          if(m_events[m_scan]->reference_count()==1)
+            {
+              std::swap(m_events[m_next], m_events[m_scan]);
+              ++m_scan;
+              return m_events[m_next++].raw_pointer();
+            }
+        }
+      return NULL;
+    }
+
+    /*
+      adds a newly created event to the
+      arena as handed out this frame.
+     */
+    void
+    add(T *ev)
+    {
+      m_events.push_back(typename T::handle(ev));
+      std::swap(m_events[m_next], m_events.back());
+      ++m_next;
+      m_scan=m_events.size();
+    }
+
+  private:
+    std::vector<typename T::handle> m_events;
+    unsigned int m_next, m_scan;
+  };
+
+  entry*
+  find_motion_entry(enum entry_type tp, int pointer);
+
+  FURYEvent::handle
+  make_event(const entry &e);
+
+  std::vector<entry> m_pending, m_dispatching;
+  event_arena<FURYMouseMotionEvent> m_mouse_motion_arena;
+  event_arena<FURYTouchEvent> m_touch_motion_arena;
+  signal_t m_sig;
+  bool m_coalesce;
+  bool m_in_dispatch;
+  unsigned int m_number_coalesced;
+};
+
+#endif
@@ -77,6 +77,12 @@ public:
   }
 
 private:
+  /*
+    FURYEventQueue reuses motion events
+    from one frame to the next.
+   */
+  friend class FURYEventQueue;
+
   ivec2 m_pt, m_delta;
   FURYMouse m_mouse;
 };
@@ -98,6 +98,12 @@ public:
   }
 
 private:
+  /*
+    FURYEventQueue reuses motion events
+    from one frame to the next.
+   */
+  friend class FURYEventQueue;
+
   vec2 m_position;
   vec2 m_delta;
   float m_pressure;
@@ -73,6 +73,29 @@ public:
     }
   };
 
+  /*!\enum attribute_format_type
+    Enumeration to select the precision with which
+    a WRATHAttributePacker derived object that supports
+    more than one attribute format packs its attributes.
+   */
+  enum attribute_format_type
+    {
+      /*!
+        Floating point attribute values are
+        packed as 32-bit floats.
+       */
+      full_precision_format,
+
+      /*!
+        Floating point attribute values for which
+        the precision suffices are packed as 16-bit
+        floats, roughly halving the bytes per vertex.
+        For GLES2, requires the extension
+        GL_OES_vertex_half_float.
+       */
+      half_precision_format
+    };
+
   /*!\class AttributePackerFactory
     The purpose of a AttributePackerFactory is to help
     automate the case where a WRATHAttributePacker derived
@@ -222,12 +245,39 @@ public:
   static
   T*
   fetch_make(const AttributePackerFactory &factory)
+  {
+    return fetch_make<T>(typeid(T).name(), factory);
+  }
+
+  /*!\fn T* fetch_make(const ResourceKey&, const AttributePackerFactory &)
+    Overload of fetch_make(const AttributePackerFactory &)
+    for WRATHAttributePacker derived classes of which
+    several objects may exist, for example one for
+    each \ref attribute_format_type. Checks if a 
+    WRATHAttributePacker object whose \ref resource_name()
+    is _exactly_ pname exists, and if so returns that
+    object dynamic_cast'ed to type T. If such an object
+    does not exist, it then creates an object with the
+    passed AttributePackerFactory.
+
+    \param pname resource name of the object to fetch, the
+                 object created by factory must have
+                 exactly this resource name
+    \param factory AttributePackerFactory derived object
+                   used to produce the return value if
+                   the object does not yet exist.
+   */
+  template<typename T>
+  static
+  T*
+  fetch_make(const ResourceKey &pname, 
+             const AttributePackerFactory &factory)
   {
     WRATHAutoLockMutex(fetch_make_mutex());
     WRATHAttributePacker *q;
     T *p;
 
-    q=retrieve_resource(typeid(T).name());
+    q=retrieve_resource(pname);
     if(q==NULL)
       {
         q=factory.create();
@@ -235,7 +285,7 @@ public:
 
     p=dynamic_cast<T*>(q);
     WRATHassert(p!=NULL);
-    WRATHassert(p->resource_name()==typeid(T).name());
+    WRATHassert(p->resource_name()==pname);
 
     return p;
   }
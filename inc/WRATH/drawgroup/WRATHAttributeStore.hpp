@@ -88,8 +88,10 @@ public:
    */
   WRATHAttributeStoreKey(void):
     m_buffer_object_hint(GL_STATIC_DRAW),
+    m_stream_buffer_count(0),
     m_index_bit_count(index_16bits),
-    m_type_size(0)
+    m_type_size(0),
+    m_instance_vertex_count(0)
   {}
 
   /*!\fn WRATHAttributeStoreKey(type_tag<T>, GLenum, enum index_bit_count_type)
@@ -110,8 +112,10 @@ public:
                          GLenum pbuffer_object_hint=GL_STATIC_DRAW,
                          enum index_bit_count_type pindex_bit_count=index_16bits):
     m_buffer_object_hint(pbuffer_object_hint),
+    m_stream_buffer_count(0),
     m_index_bit_count(pindex_bit_count),      
-    m_type_size(sizeof(T))
+    m_type_size(sizeof(T)),
+    m_instance_vertex_count(0)
   {
     T::attribute_key(m_attribute_format_location);
   }
@@ -143,8 +147,10 @@ public:
                          GLenum pbuffer_object_hint=GL_STATIC_DRAW,
                          enum index_bit_count_type pindex_bit_count=index_16bits):
     m_buffer_object_hint(pbuffer_object_hint),
+    m_stream_buffer_count(0),
     m_index_bit_count(pindex_bit_count),      
-    m_type_size(sizeof(T))
+    m_type_size(sizeof(T)),
+    m_instance_vertex_count(0)
   {
     T::attribute_key(m_attribute_format_location);
     for(unsigned int i=0, 
@@ -180,6 +186,41 @@ public:
     return *this;
   }
   
+  /*!\fn WRATHAttributeStoreKey& stream_buffer_count
+    Set the streaming mode of the buffer object
+    holding the attribute data, see
+    WRATHBufferObject::stream_buffer_count(int).
+    Intended for attribute data that changes
+    every frame, default value is 0 (no streaming).
+    \param v value to which to set \ref m_stream_buffer_count
+  */
+  WRATHAttributeStoreKey&
+  stream_buffer_count(int v)
+  {
+    m_stream_buffer_count=v;
+    return *this;
+  }
+  
+  /*!\fn WRATHAttributeStoreKey& instance_vertex_count
+    Set the number of vertices drawn per attribute
+    element, default value is 0. A positive value
+    indicates that each attribute element of a
+    WRATHAttributeStore of the key is one instance:
+    all attributes, including the implicit attributes,
+    get an instance divisor of 1 (see opengl_trait_value::m_divisor)
+    and the store is drawn with glDrawArraysInstanced()
+    drawing v vertices per instance, the vertex shader
+    using gl_VertexID to tell the vertices of an instance 
+    apart. Instancing requires GL 3.3 or GLES3.
+    \param v value to which to set \ref m_instance_vertex_count
+  */
+  WRATHAttributeStoreKey&
+  instance_vertex_count(int v)
+  {
+    m_instance_vertex_count=v;
+    return *this;
+  }
+
   /*!\fn WRATHAttributeStoreKey& index_bit_count
     Set the index bit count, default value is
     WRATHAttributeStore::index_16bits.
@@ -249,6 +290,23 @@ public:
     return *this;
   }
 
+  /*!\fn WRATHAttributeStoreKey& half_float_format
+    Set the named attribute to be read by GL as 16-bit
+    floats (see WRATHUtil::convert_to_halfp_from_float()),
+    the attribute type must then be a GLushort or vecN of
+    GLushort. For GLES2, requires the extension
+    GL_OES_vertex_half_float.
+    \param i which index of \ref m_attribute_format_location to set
+  */
+  WRATHAttributeStoreKey&
+  half_float_format(int i)
+  {
+    WRATHassert(m_attribute_format_location[i].m_type==GL_UNSIGNED_SHORT);
+    m_attribute_format_location[i].m_type=WRATH_GL_HALF_FLOAT;
+    m_attribute_format_location[i].m_normalized=GL_FALSE;
+    return *this;
+  }
+
   /*!\fn WRATHAttributeStoreKey& attribute_format(const WRATHDrawCallSpec::attribute_array_params&)
     Set all attribute formats.
     \param v new value for \ref m_attribute_format_location
@@ -265,8 +323,10 @@ public:
     comparison operator for sorting, which sorts 
     in the following order:
      -# \ref m_buffer_object_hint
+     -# \ref m_stream_buffer_count
      -# \ref m_index_bit_count
      -# \ref m_type_size
+     -# \ref m_instance_vertex_count
      -# \ref m_attribute_format_location
      \param rhs object to which to compare
    */
@@ -278,8 +338,10 @@ public:
     true if any only if all of the following
     are equal:
      - \ref m_buffer_object_hint
+     - \ref m_stream_buffer_count
      - \ref m_index_bit_count
      - \ref m_type_size
+     - \ref m_instance_vertex_count
      - \ref m_attribute_format_location
      \param rhs object to which to compare
    */
@@ -313,6 +375,15 @@ public:
     to store the attribute data.
    */
   GLenum m_buffer_object_hint;
+
+  /*!\var m_stream_buffer_count
+    Specifies the streaming mode of the buffer
+    object holding the attribute data, see
+    WRATHBufferObject::stream_buffer_count(int).
+    Has no effect if \ref m_buffer_object_hint
+    is GL_INVALID_VALUE.
+   */
+  int m_stream_buffer_count;
   
   /*!\var m_index_bit_count
     Specifies the number of bits that the index
@@ -328,6 +399,14 @@ public:
    */
   int m_type_size;
 
+  /*!\var m_instance_vertex_count
+    If positive, each attribute element is an instance
+    of m_instance_vertex_count vertices, see 
+    instance_vertex_count(int). A value of 0 indicates
+    that each attribute element is a vertex.
+   */
+  int m_instance_vertex_count;
+
   /*!\fn bool valid
     A WRATHAttributeStoreKey is said to be valid
     if all of the following conditions are true:
@@ -478,6 +557,19 @@ public:
     return m_index_bits;
   }
 
+  /*!\fn int instance_vertex_count
+    Returns the number of vertices drawn per
+    attribute element, see
+    WRATHAttributeStoreKey::instance_vertex_count(int).
+    A return value of 0 indicates that each attribute
+    element is a vertex, drawn via indices.
+   */
+  int
+  instance_vertex_count(void) const
+  {
+    return m_key.m_instance_vertex_count;
+  }
+
   /*!\fn int allocate_attribute_data(int)
     Allocates memory in the attribute buffer
     object. Returns the location as an 
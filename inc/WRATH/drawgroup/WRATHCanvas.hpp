@@ -694,6 +694,24 @@ public:
       return index_store()->allocate_copy_index_group<I>(h);
     }
 
+    /*!\fn WRATHIndexGroupAllocator::instance_group allocate_instance_group
+      Adds a range of attribute elements to be drawn
+      as instances, see
+      WRATHIndexGroupAllocator::allocate_instance_group().
+      Equivalent to
+      \code
+      index_store()->allocate_instance_group(R);
+      \endcode
+      \param R range of attribute elements, one instance
+               per element
+     */
+    WRATHIndexGroupAllocator::instance_group
+    allocate_instance_group(range_type<int> R)
+    {
+      WRATHassert(valid());
+      return index_store()->allocate_instance_group(R);
+    }
+
   private:
     WRATHItemGroup *m_item_group;
     const CustomDataBase *m_custom_data;
@@ -1054,6 +1072,50 @@ public:
                     h);
   }
 
+  /*!\fn enum return_code transfer(DataHandle&, const_c_array< range_type<int> >, 
+                                   std::vector<WRATHIndexGroupAllocator::instance_group>&)
+    Transfers a DataHandle from a given DataHandle
+    which resides on a different WRATHCanvas
+    to this WRATHCanvas. In addition, sets the
+    implicit attribute data of specified
+    blocks of the attribute store of the
+    DataHandle and moves instance groups.
+    \param in_group DataHandle object to change
+    \param allocations array of attribute ranges to 
+                       which to set the implicit attribute
+                       data
+    \param h instance groups, each is re-created (for this
+             WRATHCanvas) with the same attribute range,
+             the old handle is released and replaced by 
+             the new instance group.
+   */
+  enum return_code
+  transfer(DataHandle &in_group,
+           const_c_array< range_type<int> > allocations,
+           std::vector<WRATHIndexGroupAllocator::instance_group> &h)
+  {
+    enum return_code R;
+
+    if(in_group.parent()==this)
+      {
+        return routine_success;
+      }
+    R=transfer(in_group, allocations);
+
+    for(unsigned int i=0, endi=h.size(); R==routine_success and i<endi; ++i)
+      {
+        if(h[i].valid())
+          {
+            WRATHIndexGroupAllocator::instance_group newH;
+
+            newH=in_group.allocate_instance_group(h[i].range());
+            h[i].delete_group();
+            h[i]=newH;
+          }
+      }
+    return R;
+  }
+
   /*!\fn void release_group(DataHandle&)
     To be implemented by a derived class
     to release a DataHandle. The underlying
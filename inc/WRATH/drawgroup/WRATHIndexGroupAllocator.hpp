@@ -367,6 +367,71 @@ public:
   };
 
 
+  /*!\class instance_group
+    An instance_group is a handle to a range
+    of attribute elements drawn as instances,
+    i.e. for a WRATHIndexGroupAllocator whose
+    attribute_store() has a positive 
+    WRATHAttributeStore::instance_vertex_count().
+    Each attribute element of the range is one
+    instance and no index data is used. As with
+    \ref index_group, an instance_group is a
+    handle, if two instance_group values refer
+    to the same range and one of them deletes it,
+    the other will refer to a deleted range.
+   */
+  class instance_group
+  {
+  public:
+    /*!\fn instance_group(void)
+      Default ctor, returns an \ref instance_group
+      that does not refer to a range (yet).
+     */
+    instance_group(void):
+      m_data(NULL)
+    {}
+
+    /*!\fn bool valid
+      Returns true if and only if the
+      instance_group refers to a range
+      of attribute elements, see also
+      index_group::valid().
+     */
+    bool
+    valid(void) const
+    {
+      return m_data!=NULL;
+    }
+
+    /*!\fn range_type<int> range
+      Returns the range of attribute elements,
+      i.e. instances, of the instance_group,
+      will WRATHassert if valid() is false.
+     */
+    range_type<int>
+    range(void) const;
+
+    /*!\fn void delete_group
+      Removes the range that this \ref instance_group
+      refers to from the ranges drawn. The attribute
+      data itself is not deallocated, that is the 
+      responsibility of the caller. Afterwards, this
+      instance_group will not refer to a range.
+     */
+    void
+    delete_group(void);
+
+  private:
+    friend class WRATHIndexGroupAllocator;
+
+    explicit
+    instance_group(index_chunk *v):
+      m_data(v)
+    {}
+
+    index_chunk *m_data;
+  };
+
   /*!\fn WRATHIndexGroupAllocator(GLenum, WRATHBufferAllocator*, 
                                   const WRATHAttributeStore::handle &)
     Ctor. Creates an WRATHIndexGroupAllocator that uses a passed
@@ -416,8 +481,8 @@ public:
 
   /*!\fn bool empty
     Returns true if each created \ref index_group
-    created by this WRATHIndexGroupAllocator has
-    been deleted.
+    and \ref instance_group created by this 
+    WRATHIndexGroupAllocator has been deleted.
    */
   bool
   empty(void) const;
@@ -504,6 +569,23 @@ public:
     return R;
   } 
 
+  /*!\fn instance_group allocate_instance_group
+    Adds a range of attribute elements of attribute_store()
+    to be drawn as instances, one instance per attribute
+    element. No index data is allocated. Method
+    WRATHasserts if attribute_store()->instance_vertex_count()
+    is not positive. Ranges of an instance_group
+    must not overlap. Can be called from threads outside
+    of the GL context from multiple threads 
+    simultaneously because it locks mutex().
+    \param attribute_range range of attribute elements, an
+                           empty range will return an
+                           instance_group whose valid() 
+                           method returns false.
+   */
+  instance_group
+  allocate_instance_group(range_type<int> attribute_range);
+
   /*!\fn const WRATHTripleBufferEnabler::handle& triple_buffer_enabler
     Returns a handle to the WRATHTripleBufferEnabler
     used by the buffers associated to this
@@ -552,6 +634,10 @@ private:
     void
     append_draw_elements(std::vector<index_range> &output);
 
+    virtual
+    int
+    instance_vertex_count(void);
+
   private:
     WRATHIndexGroupAllocator *m_src;
     GLenum m_primitive_type;
@@ -563,6 +649,9 @@ private:
   void
   deallocate_group_implement(index_chunk *p);
 
+  void
+  deallocate_instance_group_implement(index_chunk *p);
+
   void
   update_draw_ranges(void);
 
@@ -576,6 +665,7 @@ private:
   bool m_own_index_buffer;
   WRATHDrawCommand *m_draw_command;
   std::map<int, index_chunk*> m_index_chunks;
+  std::map<int, index_chunk*> m_instance_chunks;
   mutable WRATHMutex m_mutex;
   WRATHAttributeStore::handle m_attribute_store;
 
@@ -30,6 +30,7 @@
 #include "WRATHTripleBufferEnabler.hpp"
 #include "WRATHassert.hpp" 
 #include "WRATHMutex.hpp"
+#include "WRATHStableID.hpp"
 #include "WRATHgl.hpp"
 
 /*! \addtogroup GLUtility
@@ -116,6 +117,47 @@ public:
     return m_usage!=GL_INVALID_ENUM;
   }
 
+  /*!\fn void stream_buffer_count(int)
+    Sets the streaming mode of this WRATHBufferObject,
+    intended for buffers whose contents change every
+    frame. A streaming WRATHBufferObject does not track
+    dirty regions; instead each flush() that has changes
+    to upload re-uploads the entire buffer into GL
+    storage that the GPU is not reading from, so that
+    the upload does not wait on draw calls of previous
+    frames:
+    - 0: no streaming (the default), changes are uploaded
+         with glBufferSubData into the one GL buffer object
+    - 1: the GL buffer object is orphaned with glBufferData
+         with a NULL pointer before the upload
+    - N>1: the WRATHBufferObject is backed by N GL buffer
+           objects used round-robin, thus the value of
+           name() changes with each flush() that uploads.
+
+    May only be called before the first time the
+    WRATHBufferObject is flushed or bound, and has
+    no effect if the WRATHBufferObject is not backed
+    by a GL buffer object.
+    \param N number of backing GL buffer objects to use
+   */
+  void
+  stream_buffer_count(int N)
+  {
+    WRATHassert(m_name==0);
+    WRATHassert(N>=0);
+    m_stream_buffer_count=N;
+  }
+
+  /*!\fn int stream_buffer_count(void) const
+    Returns the streaming mode as set by
+    stream_buffer_count(int).
+   */
+  int
+  stream_buffer_count(void) const
+  {
+    return m_stream_buffer_count;
+  }
+
   /*!\fn int size
     Returns the size of the buffer object,
     the size is guaranteed to be a multiple
@@ -340,6 +382,20 @@ public:
   unsigned int
   total_bytes_uploaded(void);
 
+  /*!\fn int sort_id
+    Returns a small integer ID unique among the
+    alive WRATHBufferObject objects. ID's are assigned
+    in creation order and reused, so unlike pointer
+    values they are small and the same from run to
+    run. Used by \ref WRATHRawDrawData to build
+    the sort keys of draw calls.
+   */
+  int
+  sort_id(void) const
+  {
+    return m_sort_id.value();
+  }
+
 protected:
 
   virtual
@@ -348,6 +404,8 @@ protected:
 
 private:
 
+  WRATHStableID<WRATHBufferObject> m_sort_id;
+
   /*
     tracking of dirty regions is via a list
     of of regions that are dirty. Neighboring
@@ -374,6 +432,21 @@ private:
 
   WRATHMutex *m_mutex;
 
+  /*
+    streaming: when m_stream_buffer_count>1,
+    m_stream_names holds all the GL buffer
+    objects and m_name is m_stream_names[m_stream_index],
+    m_stream_sizes[i] is the size of the store of
+    m_stream_names[i].
+   */
+  int m_stream_buffer_count;
+  int m_stream_index;
+  std::vector<GLuint> m_stream_names;
+  std::vector<int> m_stream_sizes;
+
+  bool
+  flush_streaming_no_lock(GLenum bind_target);
+
   const uint8_t*
   raw_data_pointer(void) const
   {
@@ -72,13 +72,17 @@ public:
     /*!\var m_location
       Starting offset into a WRATHBufferObject
       of the 1st index to send to GL. Value
-      is in _bytes_.
+      is in _bytes_. For an instanced draw
+      command (see WRATHDrawCommand::instance_vertex_count())
+      the value is the first instance instead.
      */
     int m_location;
 
     /*!\var m_count
       Number of indices to send to GL. Value
-      is in number of indices, not bytes.
+      is in number of indices, not bytes. For
+      an instanced draw command the value is
+      the number of instances instead.
      */
     int m_count;
   };
@@ -157,7 +161,29 @@ public:
   {
     return false;
   }
-  
+
+  /*!\fn int instance_vertex_count
+    May be reimplemented by a derived class.
+    If the return value is positive, the draw
+    command draws instances instead of indices:
+    for each index_range appended by
+    append_draw_elements(), index_range::m_location
+    is the first instance, i.e. the first attribute
+    element, index_range::m_count is the number of
+    instances and the instances are drawn with
+    glDrawArraysInstanced() drawing instance_vertex_count()
+    vertices each. In that case buffer_object() and
+    index_type() are not used to draw. Default value
+    is to return 0, i.e. to draw indices. Instancing
+    requires GL 3.3 or GLES3.
+   */
+  virtual
+  int
+  instance_vertex_count(void)
+  {
+    return 0;
+  }
+
 protected:
 
   /*!\var m_buffer_object
@@ -29,6 +29,8 @@
 #include "WRATHgl.hpp"
 #include "vectorGL.hpp"
 #include "WRATHReferenceCountedObject.hpp"
+#include "WRATHStableID.hpp"
+#include "WRATHGLStateShadow.hpp"
 
 /*! \addtogroup GLUtility
  * @{
@@ -81,7 +83,9 @@ public:
     A state_change represents a state
     change of GL to something, i.e.
     calling GL functions that directly
-    affect GL state.
+    affect GL state. State tracked by
+    \ref WRATHGLStateShadow should be
+    changed through WRATHGLStateShadow.
    */
   class state_change:
     public WRATHReferenceCountedObjectT<state_change>
@@ -113,7 +117,8 @@ public:
 
   /*!\class blend_state
     Represents setting the blending function,
-    i.e. calling glBlendFunc.
+    i.e. calling glBlendFunc (through \ref
+    WRATHGLStateShadow).
    */
   class blend_state:public state_change
   {
@@ -136,7 +141,7 @@ public:
     void
     set_state(WRATHGLProgram*)
     {
-      glBlendFunc(m_arg1, m_arg2);
+      WRATHGLStateShadow::blend_func(m_arg1, m_arg2);
     }
 
     virtual
@@ -279,7 +284,22 @@ public:
   compare(const WRATHGLStateChange::const_handle &lhs,
           const WRATHGLStateChange::const_handle &rhs);
 
+  /*!\fn int sort_id
+    Returns a small integer ID unique among the
+    alive WRATHGLStateChange objects. ID's are assigned
+    in creation order and reused, so unlike pointer
+    values they are small and the same from run to
+    run. Used by \ref WRATHRawDrawData to build
+    the sort keys of draw calls.
+   */
+  int
+  sort_id(void) const
+  {
+    return m_sort_id.value();
+  }
+
 private:
+  WRATHStableID<WRATHGLStateChange> m_sort_id;
   std::set<state_change::handle> m_state_changes;
 };
 /*! @} */
@@ -0,0 +1,576 @@
+/*! 
+ * \file WRATHGLStateShadow.hpp
+ * \brief file WRATHGLStateShadow.hpp
+ * 
+ * Copyright 2013 by Nomovok Ltd.
+ * 
+ * Contact: info@nomovok.com
+ * 
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ * 
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ * 
+ */
+
+
+#ifndef WRATH_HEADER_GL_STATE_SHADOW_HPP_
+#define WRATH_HEADER_GL_STATE_SHADOW_HPP_
+
+#include "WRATHConfig.hpp"
+#include <boost/utility.hpp>
+#include "WRATHgl.hpp"
+#include "vectorGL.hpp"
+
+/*! \addtogroup GLUtility
+ * @{
+ */
+
+/*!\class WRATHGLStateShadow
+  A WRATHGLStateShadow holds a client side
+  copy of GL state of the GL context that
+  WRATH renders with. WRATH changes the GL
+  state it tracks through WRATHGLStateShadow,
+  doing so has two benefits:
+  - setting a state to the value it already
+    has does not issue a GL call
+  - reading the state (for example by \ref
+    WRATHGLStateStack::push()) does not issue
+    a glGet call which on many GL implementations
+    stalls the pipeline.
+
+  A value not yet known to the shadow (i.e.
+  after \ref invalidate()) is fetched from
+  GL with glGet only when it is read; setting
+  a value that is not known issues the GL call
+  and makes the value known.
+
+  All methods are static and must only be
+  called from the thread that has the GL
+  context current. There is one shadow for
+  the process, as such it assumes that WRATH
+  renders with one GL context: if the GL context
+  changes, call \ref invalidate(). With assertions
+  active, using the shadow from a second thread
+  without an invalidate() in between asserts.
+
+  The shadow is authoritative by default: WRATH
+  never invalidates it by itself, thus state
+  known to the shadow is never queried again.
+  An application that changes GL state tracked
+  by WRATHGLStateShadow directly must either call
+  \ref invalidate() after doing so or set
+  \ref external_gl_state_changes(bool) to true.
+
+  The state tracked is:
+  - enable/disable of GL_BLEND, GL_DEPTH_TEST,
+    GL_STENCIL_TEST, GL_SCISSOR_TEST, GL_CULL_FACE
+    and GL_POLYGON_OFFSET_FILL
+  - blend functions, blend equations, blend color,
+    color write mask and clear color
+  - depth function, depth write mask, depth range
+    and depth clear value
+  - stencil function, stencil operations and
+    stencil write mask of each face, stencil
+    clear value
+  - bound framebuffer (GL_FRAMEBUFFER), viewport
+    and scissor box
+  - polygon offset, cull face mode and front face
+  - bound GLSL program and active texture unit
+ */
+class WRATHGLStateShadow:boost::noncopyable
+{
+public:
+
+  /*!\class stencil_face_state
+    A stencil_face_state holds the
+    stencil state of one face.
+   */
+  class stencil_face_state
+  {
+  public:
+    /*!\var m_func
+      Stencil function, see glStencilFuncSeparate.
+     */
+    GLenum m_func;
+
+    /*!\var m_ref
+      Stencil reference value, see glStencilFuncSeparate.
+     */
+    GLint m_ref;
+
+    /*!\var m_value_mask
+      Stencil value mask, see glStencilFuncSeparate.
+     */
+    GLuint m_value_mask;
+
+    /*!\var m_sfail
+      Op on stencil fail, see glStencilOpSeparate.
+     */
+    GLenum m_sfail;
+
+    /*!\var m_dpfail
+      Op on depth fail, see glStencilOpSeparate.
+     */
+    GLenum m_dpfail;
+
+    /*!\var m_dppass
+      Op on depth pass, see glStencilOpSeparate.
+     */
+    GLenum m_dppass;
+
+    /*!\var m_write_mask
+      Stencil write mask, see glStencilMaskSeparate.
+     */
+    GLuint m_write_mask;
+  };
+
+  /*!\fn void invalidate
+    Marks all state of the shadow as unknown.
+    Call when the GL context changes or when
+    GL state has been modified outside of
+    WRATHGLStateShadow.
+   */
+  static
+  void
+  invalidate(void);
+
+  /*!\fn bool external_gl_state_changes(void)
+    If true, the application may change GL state
+    directly (i.e. without going through
+    WRATHGLStateShadow) between frames, and thus
+    WRATHLayer::clear_and_draw(), which starts
+    a frame, calls \ref invalidate() first; the
+    shadow is then invalidated once per frame.
+    An application that changes GL state directly
+    within a frame must still call invalidate()
+    itself. Default value is false, i.e. the
+    shadow stays valid across frames.
+   */
+  static
+  bool
+  external_gl_state_changes(void);
+
+  /*!\fn void external_gl_state_changes(bool)
+    Sets the value returned by external_gl_state_changes(void).
+    \param v value to use
+   */
+  static
+  void
+  external_gl_state_changes(bool v);
+
+  /*!\fn unsigned int issued_call_count
+    Returns the number of GL calls that
+    WRATHGLStateShadow issued to change state
+    since the last call to \ref reset_counters().
+   */
+  static
+  unsigned int
+  issued_call_count(void);
+
+  /*!\fn unsigned int filtered_call_count
+    Returns the number of state changes that
+    were not sent to GL because the state
+    already had the requested value since the
+    last call to \ref reset_counters().
+   */
+  static
+  unsigned int
+  filtered_call_count(void);
+
+  /*!\fn unsigned int query_count
+    Returns the number of glGet and glIsEnabled
+    calls WRATHGLStateShadow issued since the
+    last call to \ref reset_counters().
+   */
+  static
+  unsigned int
+  query_count(void);
+
+  /*!\fn void reset_counters
+    Resets the counters, see \ref issued_call_count(),
+    \ref filtered_call_count() and \ref query_count().
+   */
+  static
+  void
+  reset_counters(void);
+
+  /*!\fn void enable(GLenum, bool)
+    Enables or disables a GL capability,
+    i.e. calls glEnable or glDisable. If
+    the capability is not tracked by
+    WRATHGLStateShadow, the GL call is
+    always issued.
+    \param cap GL capability
+    \param v if true enable, otherwise disable
+   */
+  static
+  void
+  enable(GLenum cap, bool v=true);
+
+  /*!\fn void disable(GLenum)
+    Equivalent to enable(cap, false).
+    \param cap GL capability
+   */
+  static
+  void
+  disable(GLenum cap)
+  {
+    enable(cap, false);
+  }
+
+  /*!\fn bool is_enabled(GLenum)
+    Returns true if the named capability
+    is enabled.
+    \param cap GL capability
+   */
+  static
+  bool
+  is_enabled(GLenum cap);
+
+  /*!\fn void blend_func(GLenum, GLenum)
+    Equivalent to glBlendFunc.
+   */
+  static
+  void
+  blend_func(GLenum src, GLenum dst)
+  {
+    blend_func_separate(src, dst, src, dst);
+  }
+
+  /*!\fn void blend_func_separate(GLenum, GLenum, GLenum, GLenum)
+    Equivalent to glBlendFuncSeparate.
+   */
+  static
+  void
+  blend_func_separate(GLenum src_rgb, GLenum dst_rgb,
+                      GLenum src_alpha, GLenum dst_alpha);
+
+  /*!\fn vecN<GLenum, 4> blend_func_separate(void)
+    Returns the blend functions as
+    (src_rgb, dst_rgb, src_alpha, dst_alpha).
+   */
+  static
+  vecN<GLenum, 4>
+  blend_func_separate(void);
+
+  /*!\fn void blend_equation_separate(GLenum, GLenum)
+    Equivalent to glBlendEquationSeparate.
+   */
+  static
+  void
+  blend_equation_separate(GLenum mode_rgb, GLenum mode_alpha);
+
+  /*!\fn vecN<GLenum, 2> blend_equation_separate(void)
+    Returns the blend equations as (rgb, alpha).
+   */
+  static
+  vecN<GLenum, 2>
+  blend_equation_separate(void);
+
+  /*!\fn void blend_color(const vec4&)
+    Equivalent to glBlendColor.
+   */
+  static
+  void
+  blend_color(const vec4 &v);
+
+  /*!\fn const vec4& blend_color(void)
+    Returns the blend color.
+   */
+  static
+  const vec4&
+  blend_color(void);
+
+  /*!\fn void color_mask(const vecN<GLboolean, 4>&)
+    Equivalent to glColorMask.
+   */
+  static
+  void
+  color_mask(const vecN<GLboolean, 4> &v);
+
+  /*!\fn void color_mask(GLboolean, GLboolean, GLboolean, GLboolean)
+    Equivalent to glColorMask.
+   */
+  static
+  void
+  color_mask(GLboolean r, GLboolean g, GLboolean b, GLboolean a)
+  {
+    color_mask(vecN<GLboolean, 4>(r, g, b, a));
+  }
+
+  /*!\fn const vecN<GLboolean, 4>& color_mask(void)
+    Returns the color write mask.
+   */
+  static
+  const vecN<GLboolean, 4>&
+  color_mask(void);
+
+  /*!\fn void clear_color(const vec4&)
+    Equivalent to glClearColor.
+   */
+  static
+  void
+  clear_color(const vec4 &v);
+
+  /*!\fn const vec4& clear_color(void)
+    Returns the clear color.
+   */
+  static
+  const vec4&
+  clear_color(void);
+
+  /*!\fn void depth_func(GLenum)
+    Equivalent to glDepthFunc.
+   */
+  static
+  void
+  depth_func(GLenum v);
+
+  /*!\fn GLenum depth_func(void)
+    Returns the depth function.
+   */
+  static
+  GLenum
+  depth_func(void);
+
+  /*!\fn void depth_mask(GLboolean)
+    Equivalent to glDepthMask.
+   */
+  static
+  void
+  depth_mask(GLboolean v);
+
+  /*!\fn GLboolean depth_mask(void)
+    Returns the depth write mask.
+   */
+  static
+  GLboolean
+  depth_mask(void);
+
+  /*!\fn void clear_depth(float)
+    Equivalent to glClearDepth (glClearDepthf
+    under GLES2).
+   */
+  static
+  void
+  clear_depth(float v);
+
+  /*!\fn float clear_depth(void)
+    Returns the depth clear value.
+   */
+  static
+  float
+  clear_depth(void);
+
+  /*!\fn void depth_range(const vec2&)
+    Equivalent to glDepthRange (glDepthRangef
+    under GLES2).
+   */
+  static
+  void
+  depth_range(const vec2 &v);
+
+  /*!\fn const vec2& depth_range(void)
+    Returns the depth range.
+   */
+  static
+  const vec2&
+  depth_range(void);
+
+  /*!\fn void stencil_func(GLenum, GLint, GLuint)
+    Equivalent to glStencilFunc.
+   */
+  static
+  void
+  stencil_func(GLenum func, GLint ref, GLuint mask)
+  {
+    stencil_func_separate(GL_FRONT_AND_BACK, func, ref, mask);
+  }
+
+  /*!\fn void stencil_func_separate(GLenum, GLenum, GLint, GLuint)
+    Equivalent to glStencilFuncSeparate.
+   */
+  static
+  void
+  stencil_func_separate(GLenum face, GLenum func, GLint ref, GLuint mask);
+
+  /*!\fn void stencil_op(GLenum, GLenum, GLenum)
+    Equivalent to glStencilOp.
+   */
+  static
+  void
+  stencil_op(GLenum sfail, GLenum dpfail, GLenum dppass)
+  {
+    stencil_op_separate(GL_FRONT_AND_BACK, sfail, dpfail, dppass);
+  }
+
+  /*!\fn void stencil_op_separate(GLenum, GLenum, GLenum, GLenum)
+    Equivalent to glStencilOpSeparate.
+   */
+  static
+  void
+  stencil_op_separate(GLenum face, GLenum sfail, GLenum dpfail, GLenum dppass);
+
+  /*!\fn void stencil_mask(GLuint)
+    Equivalent to glStencilMask.
+   */
+  static
+  void
+  stencil_mask(GLuint mask)
+  {
+    stencil_mask_separate(GL_FRONT_AND_BACK, mask);
+  }
+
+  /*!\fn void stencil_mask_separate(GLenum, GLuint)
+    Equivalent to glStencilMaskSeparate.
+   */
+  static
+  void
+  stencil_mask_separate(GLenum face, GLuint mask);
+
+  /*!\fn const stencil_face_state& stencil_state(GLenum)
+    Returns the stencil state of a face.
+    \param face GL_FRONT or GL_BACK
+   */
+  static
+  const stencil_face_state&
+  stencil_state(GLenum face);
+
+  /*!\fn void clear_stencil(GLint)
+    Equivalent to glClearStencil.
+   */
+  static
+  void
+  clear_stencil(GLint v);
+
+  /*!\fn GLint clear_stencil(void)
+    Returns the stencil clear value.
+   */
+  static
+  GLint
+  clear_stencil(void);
+
+  /*!\fn void bind_framebuffer(GLuint)
+    Equivalent to glBindFramebuffer(GL_FRAMEBUFFER, fbo).
+   */
+  static
+  void
+  bind_framebuffer(GLuint fbo);
+
+  /*!\fn GLuint bind_framebuffer(void)
+    Returns the framebuffer bound to GL_FRAMEBUFFER.
+   */
+  static
+  GLuint
+  bind_framebuffer(void);
+
+  /*!\fn void framebuffer_deleted(GLuint)
+    To be called when a framebuffer object is
+    deleted, deleting the bound framebuffer
+    object makes GL bind the default framebuffer.
+   */
+  static
+  void
+  framebuffer_deleted(GLuint fbo);
+
+  /*!\fn void viewport(const vecN<GLint, 4>&)
+    Equivalent to glViewport.
+   */
+  static
+  void
+  viewport(const vecN<GLint, 4> &v);
+
+  /*!\fn const vecN<GLint, 4>& viewport(void)
+    Returns the viewport.
+   */
+  static
+  const vecN<GLint, 4>&
+  viewport(void);
+
+  /*!\fn void scissor(const vecN<GLint, 4>&)
+    Equivalent to glScissor.
+   */
+  static
+  void
+  scissor(const vecN<GLint, 4> &v);
+
+  /*!\fn const vecN<GLint, 4>& scissor(void)
+    Returns the scissor box.
+   */
+  static
+  const vecN<GLint, 4>&
+  scissor(void);
+
+  /*!\fn void polygon_offset(const vec2&)
+    Equivalent to glPolygonOffset(v.x(), v.y()).
+   */
+  static
+  void
+  polygon_offset(const vec2 &v);
+
+  /*!\fn const vec2& polygon_offset(void)
+    Returns the polygon offset as (factor, units).
+   */
+  static
+  const vec2&
+  polygon_offset(void);
+
+  /*!\fn void cull_face(GLenum)
+    Equivalent to glCullFace.
+   */
+  static
+  void
+  cull_face(GLenum v);
+
+  /*!\fn GLenum cull_face(void)
+    Returns the cull face mode.
+   */
+  static
+  GLenum
+  cull_face(void);
+
+  /*!\fn void front_face(GLenum)
+    Equivalent to glFrontFace.
+   */
+  static
+  void
+  front_face(GLenum v);
+
+  /*!\fn GLenum front_face(void)
+    Returns the front face.
+   */
+  static
+  GLenum
+  front_face(void);
+
+  /*!\fn void use_program(GLuint)
+    Equivalent to glUseProgram.
+   */
+  static
+  void
+  use_program(GLuint program);
+
+  /*!\fn void program_deleted(GLuint)
+    To be called when a GLSL program is deleted,
+    so that a program later created with the
+    same name is not mistaken as bound.
+   */
+  static
+  void
+  program_deleted(GLuint program);
+
+  /*!\fn void active_texture(GLenum)
+    Equivalent to glActiveTexture.
+   */
+  static
+  void
+  active_texture(GLenum unit);
+};
+
+/*! @} */
+
+#endif
@@ -45,6 +45,15 @@
   (for example distance field generation
   via GPU).
 
+  The state is read from and restored through
+  \ref WRATHGLStateShadow, thus push() only
+  queries GL for state not known to the shadow
+  and pop() only issues GL calls for state that
+  changed since the matching push(). An
+  application that changed the tracked GL state
+  directly must call WRATHGLStateShadow::invalidate()
+  before push().
+
   On desconstruction, all state of a
   WRATHGLStateStack is popped, thus
   one can safely push state to
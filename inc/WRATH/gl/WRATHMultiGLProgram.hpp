@@ -25,6 +25,7 @@
 #include "WRATHConfig.hpp"
 #include "WRATHGLProgram.hpp"
 #include "WRATHReferenceCountedObject.hpp"
+#include "WRATHStableID.hpp"
 #include <boost/utility.hpp>
 #include <boost/signals2.hpp>
 #include <boost/bind.hpp>
@@ -256,7 +257,22 @@ public:
     return m_resource_name;
   }
 
+  /*!\fn int sort_id
+    Returns a small integer ID unique among the
+    alive WRATHMultiGLProgram objects. ID's are assigned
+    in creation order and reused, so unlike pointer
+    values they are small and the same from run to
+    run. Used by \ref WRATHRawDrawData to build
+    the sort keys of draw calls.
+   */
+  int
+  sort_id(void) const
+  {
+    return m_sort_id.value();
+  }
+
 private:
+  WRATHStableID<WRATHMultiGLProgram> m_sort_id;
   typedef std::pair<WRATHGLProgram*, boost::signals2::connection> per_program;
 
   void
@@ -23,6 +23,9 @@
 
 #include "WRATHConfig.hpp"
 #include <set>
+#include <map>
+#include <vector>
+#include <stdint.h>
 #include <boost/utility.hpp>
 #include <boost/signals2.hpp>
 #include <boost/bind.hpp>
@@ -473,6 +476,7 @@ public:
   explicit
   WRATHRawDrawDataElement(const WRATHDrawCallSpec &spec):
     m_spec(spec),
+    m_sort_key(compute_sort_key(spec)),
     m_raw_draw_data(NULL),
     m_location_in_raw_draw_data(-1)
   {}
@@ -504,10 +508,45 @@ public:
     return m_spec;
   }
 
+  /*!\fn uint64_t sort_key
+    Returns the key used by \ref WRATHRawDrawData
+    to sort elements by GL state. The key is 
+    computed once at construction from the
+    \ref WRATHStableID values of the objects
+    of draw_spec(), from most significant to
+    least significant bits:
+    - 14 bits: \ref WRATHDrawCallSpec::m_program
+    - 12 bits: \ref WRATHDrawCallSpec::m_bind_textures
+    -  8 bits: \ref WRATHDrawCallSpec::m_gl_state_change
+    - 12 bits: first non-NULL of \ref WRATHDrawCallSpec::m_data_source
+    - 10 bits: \ref WRATHDrawCallSpec::m_uniform_data
+    -  8 bits: WRATHBufferObject of \ref WRATHDrawCallSpec::m_draw_command
+
+    A NULL pointer or invalid handle gives the
+    value 0 in its field. ID's too large for
+    their field wrap, so different objects may
+    share a field value. For this reason, and
+    since the key holds neither all attribute 
+    sources nor \ref WRATHDrawCallSpec::m_attribute_format_location,
+    \ref WRATHRawDrawData orders elements with equal
+    keys by comparing the full ID's of all of
+    the above and the attribute formats.
+   */
+  uint64_t
+  sort_key(void) const
+  {
+    return m_sort_key;
+  }
+
 private:
   friend class WRATHRawDrawData;
 
+  static
+  uint64_t
+  compute_sort_key(const WRATHDrawCallSpec &spec);
+
   WRATHDrawCallSpec m_spec;
+  uint64_t m_sort_key;
 
   /*
     used by WRATHRawDrawData book-keeping.
@@ -527,6 +566,9 @@ private:
 class WRATHRawDrawData:
   public WRATHTripleBufferEnabler::PhasedDeletedObject
 {
+private:
+  typedef std::pair<uint64_t, WRATHRawDrawDataElement*> sort_entry;
+
 public:
 
   /*!\fn WRATHRawDrawData
@@ -537,14 +579,19 @@ public:
          WRATHDrawCallSpec::m_force_draw_order is not a valid
          handle comes first, followed by those with a valid handle
          sorted by draw_order_sorter()
-    - 1) WRATHMultiGLProgram \ref WRATHDrawCallSpec::m_program 
-    - 2) WRATHTextureChoice \ref WRATHDrawCallSpec::m_bind_textures
-    - 3) WRATHGLStateChange \ref WRATHDrawCallSpec::m_gl_state_change
-    - 4) WRATHBufferObject \ref WRATHDrawCallSpec::m_data_source 
-    - 5) \ref WRATHDrawCallSpec::attribute_array_params \ref WRATHDrawCallSpec::m_attribute_format_location
-    - 6) WRATHUniformData \ref WRATHDrawCallSpec::m_uniform_data
-    - 7) WRATHBufferObject of WRATHDrawCommand \ref WRATHDrawCallSpec::m_draw_command
-    - 8) WRATHDrawCommand \ref WRATHDrawCallSpec::m_draw_command
+    - 1) \ref WRATHRawDrawDataElement::sort_key(), which
+         orders by program, textures, GL state change,
+         attribute source, uniform data and index buffer
+         object, in that order
+    - 2) elements with equal sort key by the full ID's
+         of the same objects, all attribute sources
+         and \ref WRATHDrawCallSpec::m_attribute_format_location
+    - 3) elements with equal draw order and GL state
+         keep the order in which they were added
+
+    Since the sort keys are built from \ref WRATHStableID
+    values rather than pointer values, the order is the
+    same from run to run.
 
     \param ptriple_buffer_enabler handle to a WRATHTripleBufferEnabler to
                                   which the created WRATHRawDrawData will
@@ -702,11 +749,14 @@ public:
       m_prog(NULL),
       m_current_glsl(NULL),
       m_attr_source(NULL),
+      m_attr_name(0),
+      m_attr_divisor(0),
       m_currently_bound(NULL),
       m_indx_source(NULL),
       m_init_attributes(true),
       m_primitive_type(GL_INVALID_ENUM),
       m_index_type(GL_INVALID_ENUM),
+      m_instance_vertex_count(0),
       m_active(false),
       m_selector(selector),
       m_draw_information_ptr(pdraw_information!=NULL?
@@ -841,6 +891,10 @@ public:
 
     /*!\fn void set_attribute_sources
       Set the attribute format and location values.
+      If binding a source moves a streaming
+      WRATHBufferObject (see WRATHBufferObject::stream_buffer_count(int))
+      to another GL buffer object, the attributes
+      sourced from it are re-pointed as well.
       \param p_attr_source source of attribute data
       \param p_attr_fmt format and location within source of attribute data
      */
@@ -850,7 +904,13 @@ public:
 
     /*!\fn void queue_drawing
       Queue a draw command, draw command is NOT necessarily
-      executed immediately.
+      executed immediately. If the draw command is
+      instanced (see WRATHDrawCommand::instance_vertex_count()),
+      the queued instance ranges are drawn with one
+      glDrawArraysInstanced() per range, re-pointing
+      the attributes with a non-zero divisor
+      (see opengl_trait_value::m_divisor) to the
+      first instance of the range.
      */
     void
     queue_drawing(WRATHDrawCommand *draw_command);
@@ -947,6 +1007,18 @@ public:
 
     void
     index_buffer(WRATHDrawCommand *draw_command);
+
+    void
+    repoint_streamed_attributes(WRATHBufferObject *bo);
+
+    void
+    attribute_divisor(int i);
+
+    void
+    draw_instances(void);
+
+    void
+    point_instanced_attributes(int first_instance);
     
     
     WRATHMultiGLProgram *m_prog;
@@ -954,6 +1026,8 @@ public:
     WRATHUniformData::const_handle m_uniform;
     WRATHTextureChoice::const_handle m_tex;
     vecN<WRATHBufferObject*, attribute_count> m_attr_source;
+    vecN<GLuint, attribute_count> m_attr_name;
+    vecN<GLuint, attribute_count> m_attr_divisor;
     std::set<WRATHBufferObject*> m_locked_bos;
     WRATHBufferObject *m_currently_bound;
     WRATHBufferObject *m_indx_source;
@@ -964,6 +1038,7 @@ public:
     std::vector<WRATHDrawCommand::index_range> m_draw_ranges;
     GLenum m_primitive_type;
     GLenum m_index_type;
+    int m_instance_vertex_count;
 
     std::vector<uint8_t> m_temp_bytes;
 
@@ -1018,6 +1093,70 @@ public:
   void
   draw(DrawState &draw_state);
 
+  /*!\class merged_draw_list
+    A merged_draw_list draws the WRATHRawDrawDataElement
+    objects of several WRATHRawDrawData objects as
+    one list sorted by \ref WRATHRawDrawDataElement::sort_key().
+    Thus elements of different WRATHRawDrawData objects that
+    share GL state are drawn together. Since the list
+    is sorted across WRATHRawDrawData objects, the order
+    given by \ref WRATHDrawCallSpec::m_force_draw_order
+    is NOT respected; a merged_draw_list should only be
+    used for drawing where the draw order does not matter,
+    for example opaque drawing with depth test on.
+    The storage of a merged_draw_list is reused between
+    draws, so a merged_draw_list should be kept rather
+    than created for each draw. A merged_draw_list may
+    only be used from the rendering thread.
+   */
+  class merged_draw_list:boost::noncopyable
+  {
+  public:
+    /*!\fn merged_draw_list
+      Ctor.
+     */
+    merged_draw_list(void)
+    {}
+
+    /*!\fn void clear
+      Clear the list.
+     */
+    void
+    clear(void)
+    {
+      m_entries.clear();
+    }
+
+    /*!\fn void add(const WRATHRawDrawData*)
+      Add the elements that a WRATHRawDrawData
+      draws in the rendering thread to the list.
+      \param p WRATHRawDrawData whose elements to add
+     */
+    void
+    add(const WRATHRawDrawData *p);
+
+    /*!\fn void add(const std::map<int, WRATHRawDrawData*>&)
+      Provided as a conveniance, add the elements
+      of each WRATHRawDrawData of a map.
+      \param items WRATHRawDrawData objects whose elements to add
+     */
+    void
+    add(const std::map<int, WRATHRawDrawData*> &items);
+
+    /*!\fn void draw
+      Sort the list and draw the elements. May 
+      only be called within a DrawState::draw_begin()
+      DrawState::draw_end() pair of the passed
+      \ref DrawState object.
+      \param draw_state DrawState tracking the GL state
+     */
+    void
+    draw(DrawState &draw_state);
+
+  private:
+    std::vector<sort_entry> m_entries, m_scratch;
+  };
+
 
   /*!\fn bool render_empty
     Returns true if there are no element to
@@ -1040,22 +1179,26 @@ protected:
   
 private:
 
-  class sorter
+  class draw_order_sorter_t
   {
   public:
     
-    sorter(const WRATHDrawOrderComparer::const_handle &cmp):
+    draw_order_sorter_t(const WRATHDrawOrderComparer::const_handle &cmp):
       m_comparer(cmp)
     {}
 
     bool
     operator()(const WRATHRawDrawDataElement *lhs,
-               const WRATHRawDrawDataElement *rhs);
+               const WRATHRawDrawDataElement *rhs) const;
 
     WRATHDrawOrderComparer::const_handle m_comparer;
-    
   };
 
+
+  static
+  void
+  draw_element(DrawState &draw_state, const WRATHRawDrawDataElement &element);
+
   void
   check_sort_elements(void);
 
@@ -1072,13 +1215,18 @@ private:
     Sorting occurs only in the simulation thread.
     The strategy is as follows:
     1) on signal (on_complete_simulation_frame, pre_update_no_lock)
-       if m_list_dirty sort the buffers of list of m_buffers[current_simulation_ID()]
+       if m_list_dirty sort the buffers of list of m_buffers[current_simulation_ID()],
+       the sort is a radix sort on sort_key(), a sort by the full
+       state of runs of equal keys that are out of order, followed,
+       if necessary, by a stable sort on draw order. m_sort_scratch is the storage
+       for the radix sort, kept to avoid allocating on each sort.
     2) on signal (on_complete_simulation_frame, post_update_no_lock)
        copy the contents of m_buffers[last_simulation_ID()] to m_buffers[current_simulation_ID()].
     3) ordering changes fire a signal
    */
-  sorter m_sorter;
+  WRATHDrawOrderComparer::const_handle m_comparer;
   bool m_list_dirty;
+  vecN<std::vector<sort_entry>, 2> m_sort_scratch;
 
   vecN<std::vector<WRATHRawDrawDataElement*>, 3> m_buffers;
   vecN<WRATHTripleBufferEnabler::connect_t, 2> m_connections;
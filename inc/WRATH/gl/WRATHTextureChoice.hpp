@@ -29,6 +29,7 @@
 #include "WRATHgl.hpp"
 #include "WRATHglGet.hpp"
 #include "WRATHNew.hpp"
+#include "WRATHStableID.hpp"
 #include "WRATHUniformData.hpp"
 
 /*! \addtogroup GLUtility
@@ -290,7 +291,22 @@ public:
   compare(const WRATHTextureChoice::const_handle &lhs,
           const WRATHTextureChoice::const_handle &rhs);
 
+  /*!\fn int sort_id
+    Returns a small integer ID unique among the
+    alive WRATHTextureChoice objects. ID's are assigned
+    in creation order and reused, so unlike pointer
+    values they are small and the same from run to
+    run. Used by \ref WRATHRawDrawData to build
+    the sort keys of draw calls.
+   */
+  int
+  sort_id(void) const
+  {
+    return m_sort_id.value();
+  }
+
 private:
+  WRATHStableID<WRATHTextureChoice> m_sort_id;
   std::map<GLenum, texture_base::handle> m_values;
 };
 
@@ -27,6 +27,7 @@
 #include "WRATHReferenceCountedObject.hpp"
 #include "WRATHgl.hpp"
 #include "WRATHNew.hpp"
+#include "WRATHStableID.hpp"
 #include "WRATHgluniform.hpp"
 #include "WRATHGLProgram.hpp"
 #include "WRATHTripleBufferEnabler.hpp"
@@ -415,7 +416,22 @@ public:
           const WRATHUniformData::const_handle &rhs);
 
 
+  /*!\fn int sort_id
+    Returns a small integer ID unique among the
+    alive WRATHUniformData objects. ID's are assigned
+    in creation order and reused, so unlike pointer
+    values they are small and the same from run to
+    run. Used by \ref WRATHRawDrawData to build
+    the sort keys of draw calls.
+   */
+  int
+  sort_id(void) const
+  {
+    return m_sort_id.value();
+  }
+
 private:
+  WRATHStableID<WRATHUniformData> m_sort_id;
   std::set<uniform_setter_base::handle> m_uniforms;
 };
 
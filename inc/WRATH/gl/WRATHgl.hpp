@@ -37,4 +37,15 @@
  #error Neither WRATH_GL_VERSION nor WRATH_GLES_VERSION defined
 #endif
 
+/*
+  GL enumeration for 16-bit floating point data,
+  for GLES2 using it for vertex attribute data requires
+  the extension GL_OES_vertex_half_float.
+ */
+#if defined(WRATH_GLES_VERSION) && WRATH_GLES_VERSION==2
+ #define WRATH_GL_HALF_FLOAT GL_HALF_FLOAT_OES
+#else
+ #define WRATH_GL_HALF_FLOAT GL_HALF_FLOAT
+#endif
+
 #endif
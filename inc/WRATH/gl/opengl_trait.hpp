@@ -132,18 +132,30 @@ public:
     the 6'th argument (ptr) to glVertexAttribPointer(GLuint indx, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* ptr).
    */
   int m_offset;
+
+  /*!\var m_divisor
+    The instance divisor of the attribute, i.e. the
+    argument to glVertexAttribDivisor(GLuint index, GLuint divisor).
+    A value of 0 indicates that the attribute advances
+    per vertex, a value of N>0 indicates that the
+    attribute advances once every N instances. Non-zero
+    values require GL 3.3 or GLES3.
+   */
+  GLuint m_divisor;
   
   /*!\fn opengl_trait_value(void)
     Ctor, initialize all enumeration as GL_INVALID_ENUM,
     normalization as GL_FALSE, \ref m_count and \ref
-    m_stride as -1 and \ref m_offset as 0.
+    m_stride as -1 and \ref m_offset and \ref m_divisor
+    as 0.
    */
   opengl_trait_value(void):
     m_type(GL_INVALID_ENUM),
     m_count(-1),
     m_stride(-1),
     m_normalized(GL_FALSE),
-    m_offset(0)
+    m_offset(0),
+    m_divisor(0)
   {}
 
   /*!\fn opengl_trait_value(type_tag<T>, int)
@@ -158,7 +170,8 @@ public:
     m_count(opengl_trait<T>::count),
     m_stride(opengl_trait<T>::stride),
     m_normalized(GL_FALSE),
-    m_offset(loc)
+    m_offset(loc),
+    m_divisor(0)
   {}
 
   /*!\fn opengl_trait_value(GLenum, int, int, int)
@@ -174,7 +187,8 @@ public:
     m_count(pcount),
     m_stride(pstride),
     m_normalized(GL_FALSE),
-    m_offset(loc)
+    m_offset(loc),
+    m_divisor(0)
   {}
 
   /*!\fn valid
@@ -200,7 +214,8 @@ public:
        and m_count==obj.m_count
        and m_stride==obj.m_stride
        and m_normalized==obj.m_normalized
-       and m_offset==obj.m_offset);
+       and m_offset==obj.m_offset
+       and m_divisor==obj.m_divisor);
   }
 
  
@@ -251,6 +266,11 @@ public:
         return m_normalized<obj.m_normalized;
       }
 
+    if(m_divisor!=obj.m_divisor)
+      {
+        return m_divisor<obj.m_divisor;
+      }
+
     return false;
   }
 
@@ -265,6 +285,17 @@ public:
     return *this;
   }
 
+  /*!\fn divisor
+    Set \ref m_divisor, returns a reference to this.
+    \param v value to which to set \ref m_divisor
+   */
+  opengl_trait_value&
+  divisor(GLuint v)
+  {
+    m_divisor=v; 
+    return *this;
+  }
+
   /*!\fn count
     Set m_count, returns a reference to this.
     \param pcount value to which to set \ref m_count
@@ -37,7 +37,14 @@
   A WRATHDefaultRectAttributePacker is an
   example of a WRATHRectAttributePacker.
   It supports texturing by exactly one 
-  texture.
+  texture. There is a WRATHDefaultRectAttributePacker
+  for each \ref attribute_format_type, the attribute
+  names are the same for each, thus the same shaders
+  can be used for each. With \ref half_precision_format
+  only the brush values are packed as 16-bit floats
+  making a vertex 24 bytes instead of 32 bytes; the
+  size and z of a rectangle stay 32-bit floats so that
+  neither the rectangle nor the depth order changes.
  */
 class WRATHDefaultRectAttributePacker:public WRATHRectAttributePacker
 {
@@ -139,15 +146,28 @@ public:
   /*!\fn WRATHDefaultRectAttributePacker* fetch 
     WRATHDefaultRectAttributePacker is stateless and
     only at most one WRATHDefaultRectAttributePacker
-    needs to exist. The function fetch(), if necessary
-    contructs the WRATHDefaultRectAttributePacker, and
-    then returns a pointer to it.
+    for each attribute format needs to exist. The 
+    function fetch(), if necessary contructs the 
+    WRATHDefaultRectAttributePacker, and then returns
+    a pointer to it.
+    \param fmt attribute format of the packer to fetch
    */
   static
   WRATHDefaultRectAttributePacker*
-  fetch(void)
+  fetch(enum attribute_format_type fmt=full_precision_format)
   {
-    return WRATHAttributePacker::fetch_make<WRATHDefaultRectAttributePacker>(Factory());
+    return WRATHAttributePacker::fetch_make<WRATHDefaultRectAttributePacker>(resource_label(fmt),
+                                                                              Factory(fmt));
+  }
+
+  /*!\fn enum attribute_format_type attribute_format
+    Returns the attribute format with which
+    this WRATHDefaultRectAttributePacker packs.
+   */
+  enum attribute_format_type
+  attribute_format(void) const
+  {
+    return m_format;
   }
 
   /*!\fn Rect::handle rect_properties(float, float, float)
@@ -201,16 +221,30 @@ private:
   class Factory:public WRATHAttributePacker::AttributePackerFactory
   {
   public:
+    explicit
+    Factory(enum attribute_format_type fmt):
+      m_format(fmt)
+    {}
+
     virtual
     WRATHAttributePacker*
     create(void) const 
     {
-      return WRATHNew WRATHDefaultRectAttributePacker();
+      return WRATHNew WRATHDefaultRectAttributePacker(m_format);
     }
+
+  private:
+    enum attribute_format_type m_format;
   };
 
-  WRATHDefaultRectAttributePacker(void);
-                              
+  static
+  std::string
+  resource_label(enum attribute_format_type fmt);
+
+  explicit
+  WRATHDefaultRectAttributePacker(enum attribute_format_type fmt);
+
+  enum attribute_format_type m_format;                              
 };
 
 
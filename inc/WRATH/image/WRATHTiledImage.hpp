@@ -0,0 +1,382 @@
+/*! 
+ * \file WRATHTiledImage.hpp
+ * \brief file WRATHTiledImage.hpp
+ * 
+ * Copyright 2013 by Nomovok Ltd.
+ * 
+ * Contact: info@nomovok.com
+ * 
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ * 
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ * 
+ */
+
+
+#ifndef WRATH_HEADER_TILED_IMAGE_HPP_
+#define WRATH_HEADER_TILED_IMAGE_HPP_
+
+#include "WRATHConfig.hpp"
+#include <vector>
+#include <boost/utility.hpp>
+#include "WRATHImage.hpp"
+#include "WRATHBrush.hpp"
+#include "WRATHTextureCoordinate.hpp"
+#include "WRATHUniformData.hpp"
+
+/*! \addtogroup Imaging
+ * @{
+ */
+
+/*!\class WRATHTiledImage
+  A WRATHTiledImage breaks an image into tiles of
+  \ref tile_size by \ref tile_size pixels. The tiles
+  are stored in a tile store, a texture shared by
+  many WRATHTiledImage objects, and an index image
+  (a \ref WRATHImage of format RGBA8, one texel per tile)
+  gives the location of each tile within the tile store.
+
+  Tiles are shared by content: each tile (including
+  its boundary of \ref tile_border pixels on each side,
+  needed for filtering) is hashed, and if an identical
+  tile is already present in the tile store it is
+  reused instead of uploaded again. Thus an image with
+  large uniform regions only stores the uniform regions
+  once and two WRATHTiledImage objects with common tiles
+  share them. Within an image, tiles are compared by
+  value. Between images, tiles are matched by a 128-bit
+  hash of their texels, no CPU copy of the tiles of a
+  tile store is kept. See memory_stats() for the
+  texture memory saved.
+
+  A WRATHTiledImage is drawn with a \ref WRATHBrush
+  set by set_brush(), which uses the texture coordinate
+  source returned by texture_coordinate_source().
+  That source reads from the index image on the texture
+  unit GL_TEXTURE0 + \ref index_texture_unit, as such
+  a WRATHTiledImage brush may be used together with
+  a gradient. Items drawn with different WRATHTiledImage
+  objects are not batched together.
+
+  Mipmapping is not supported by a WRATHTiledImage;
+  the tile store uses the magnification filter of
+  the image format for minification too.
+
+  WRATHTiledImage objects can be created from any thread,
+  the tile stores are protected by a mutex which is only
+  held to find or add the tiles of an image, the tiles 
+  are extracted and hashed without it. As with
+  \ref WRATHImage, they must only be deleted from within
+  the GL context.
+
+  A tile store is never larger than max_tile_store_size().
+  If the unique tiles of an image do not fit in a single
+  tile store of that size, a warning is printed and the
+  image is stored whole in a plain \ref WRATHImage
+  instead (see tiled()); set_brush() then sets the brush
+  to draw that image with the usual texture coordinate
+  source.
+ */
+class WRATHTiledImage:boost::noncopyable
+{
+public:
+
+  enum
+    {
+      /*!
+        Size in pixels of the side of a tile.
+       */
+      tile_size=32,
+
+      /*!
+        Size in pixels of the boundary of each
+        tile as stored in the tile store.
+       */
+      tile_border=1,
+
+      /*!
+        Size in texels of the side of a tile
+        as stored in the tile store.
+       */
+      tile_cell_size=tile_size + 2*tile_border,
+
+      /*!
+        Texture unit of the index image
+        is GL_TEXTURE0 + index_texture_unit
+       */
+      index_texture_unit=2
+    };
+
+  /*!\class memory_stats_type
+    A memory_stats_type reports the memory used
+    by all WRATHTiledImage objects alive against
+    the memory the same images would use if stored
+    whole.
+   */
+  class memory_stats_type
+  {
+  public:
+    memory_stats_type(void):
+      m_number_images(0),
+      m_number_tiles(0),
+      m_number_unique_tiles(0),
+      m_number_tile_stores(0),
+      m_number_untiled_images(0),
+      m_image_bytes(0),
+      m_tile_bytes(0),
+      m_index_bytes(0),
+      m_tile_store_bytes(0),
+      m_untiled_bytes(0)
+    {}
+
+    /*!\var m_number_images
+      Number of WRATHTiledImage objects.
+     */
+    int m_number_images;
+
+    /*!\var m_number_tiles
+      Number of tiles of all the WRATHTiledImage objects.
+     */
+    int m_number_tiles;
+
+    /*!\var m_number_unique_tiles
+      Number of tiles stored in the tile stores.
+     */
+    int m_number_unique_tiles;
+
+    /*!\var m_number_tile_stores
+      Number of tile stores (textures).
+     */
+    int m_number_tile_stores;
+
+    /*!\var m_number_untiled_images
+      Number of WRATHTiledImage objects whose
+      tiles did not fit in a tile store and
+      are stored whole, see tiled(). These
+      are not counted in \ref m_number_images.
+     */
+    int m_number_untiled_images;
+
+    /*!\var m_image_bytes
+      Number of bytes the images would
+      take if stored whole.
+     */
+    size_t m_image_bytes;
+
+    /*!\var m_tile_bytes
+      Number of bytes the stored tiles
+      take, including their boundary.
+     */
+    size_t m_tile_bytes;
+
+    /*!\var m_index_bytes
+      Number of bytes the index images take.
+     */
+    size_t m_index_bytes;
+
+    /*!\var m_tile_store_bytes
+      Number of bytes of the textures
+      of the tile stores, including
+      the room not used by any tile.
+     */
+    size_t m_tile_store_bytes;
+
+    /*!\var m_untiled_bytes
+      Number of bytes of the images of
+      the WRATHTiledImage objects that
+      are stored whole.
+     */
+    size_t m_untiled_bytes;
+  };
+
+  /*!\fn WRATHTiledImage
+    Ctor.
+    \param sz size of the image in pixels
+    \param fmt image format of the image,
+               mipmapping is ignored
+    \param pixels pixel data of the image, tightly packed,
+                  rows from bottom to top, each pixel
+                  being fmt.bytes_per_pixel() bytes
+   */
+  WRATHTiledImage(const ivec2 &sz,
+                  const WRATHImage::ImageFormat &fmt,
+                  const std::vector<uint8_t> &pixels);
+
+  ~WRATHTiledImage();
+
+  /*!\fn const ivec2& size
+    Returns the size of the image in pixels.
+   */
+  const ivec2&
+  size(void) const
+  {
+    return m_size;
+  }
+
+  /*!\fn const ivec2& number_tiles
+    Returns the number of tiles in
+    each dimension of the image.
+   */
+  const ivec2&
+  number_tiles(void) const
+  {
+    return m_number_tiles;
+  }
+
+  /*!\fn int number_new_tiles
+    Returns the number of tiles that were
+    added to the tile store when this
+    WRATHTiledImage was created, i.e. the
+    number of tiles that were not shared.
+   */
+  int
+  number_new_tiles(void) const
+  {
+    return m_number_new_tiles;
+  }
+
+  /*!\fn bool tiled
+    Returns true if this WRATHTiledImage is
+    stored as tiles in a tile store, false
+    if its tiles did not fit in a tile store
+    of max_tile_store_size() texels and it is
+    stored whole in untiled_image().
+   */
+  bool
+  tiled(void) const
+  {
+    return m_store!=NULL;
+  }
+
+  /*!\fn WRATHImage* tile_image
+    Returns the WRATHImage of the tile
+    store of this WRATHTiledImage, or
+    NULL if !tiled().
+   */
+  WRATHImage*
+  tile_image(void) const;
+
+  /*!\fn WRATHImage* index_image
+    Returns the index image of this
+    WRATHTiledImage, or NULL if !tiled().
+   */
+  WRATHImage*
+  index_image(void) const
+  {
+    return m_index_image;
+  }
+
+  /*!\fn WRATHImage* untiled_image
+    Returns the WRATHImage holding the whole
+    image if !tiled(), otherwise NULL.
+   */
+  WRATHImage*
+  untiled_image(void) const
+  {
+    return m_untiled_image;
+  }
+
+  /*!\fn void set_brush
+    Set the image, texture coordinate source and the
+    draw state of a \ref WRATHBrush to draw this
+    WRATHTiledImage. The brush coordinates are in
+    pixels of the image.
+    \param brush WRATHBrush to modify
+    \param repeat_mode_x repeat mode in x-direction
+    \param repeat_mode_y repeat mode in y-direction
+   */
+  void
+  set_brush(WRATHBrush &brush,
+            enum WRATHTextureCoordinate::repeat_mode_type repeat_mode_x=WRATHTextureCoordinate::simple,
+            enum WRATHTextureCoordinate::repeat_mode_type repeat_mode_y=WRATHTextureCoordinate::simple) const;
+
+  /*!\fn const WRATHTextureCoordinateSourceBase* texture_coordinate_source
+    Returns the texture coordinate source that
+    converts a coordinate in the image to a
+    coordinate in the tile store via the index
+    image. The source reads the uniforms set by
+    the draw state of set_brush().
+    \param repeat_mode_x repeat mode in x-direction
+    \param repeat_mode_y repeat mode in y-direction
+   */
+  static
+  const WRATHTextureCoordinateSourceBase*
+  texture_coordinate_source(enum WRATHTextureCoordinate::repeat_mode_type repeat_mode_x,
+                            enum WRATHTextureCoordinate::repeat_mode_type repeat_mode_y);
+
+  /*!\fn memory_stats_type memory_stats
+    Returns the memory statistics of all
+    WRATHTiledImage objects.
+   */
+  static
+  memory_stats_type
+  memory_stats(void);
+
+  /*!\fn void tile_store_size(int)
+    Sets the size of the side, in texels, of the
+    textures of the tile stores created after
+    the call. A tile store is made larger, up to
+    max_tile_store_size(), if needed to hold all
+    the tiles of an image. Default value is 1024.
+    \param v value to use
+   */
+  static
+  void
+  tile_store_size(int v);
+
+  /*!\fn int tile_store_size(void)
+    Gets the size of the side, in texels, of the
+    textures of the tile stores, see
+    tile_store_size(int).
+   */
+  static
+  int
+  tile_store_size(void);
+
+  /*!\fn void max_tile_store_size(int)
+    Sets the largest size of the side, in texels,
+    of the texture of a tile store. A WRATHTiledImage
+    may be created outside of the GL context, so the
+    value of GL_MAX_TEXTURE_SIZE cannot be queried
+    when creating tile stores; an application should
+    set this to that value (or less) if it differs
+    from the default. The size is also limited by
+    the index image storing cell locations as bytes,
+    i.e. to 256*\ref tile_cell_size texels.
+    Default value is 2048.
+    \param v value to use
+   */
+  static
+  void
+  max_tile_store_size(int v);
+
+  /*!\fn int max_tile_store_size(void)
+    Gets the largest size of the side, in texels,
+    of the texture of a tile store, see
+    max_tile_store_size(int).
+   */
+  static
+  int
+  max_tile_store_size(void);
+
+private:
+  ivec2 m_size;
+  ivec2 m_number_tiles;
+  int m_number_new_tiles;
+  size_t m_image_bytes;
+
+  void *m_store;
+  std::vector<int> m_cells;
+  WRATHImage *m_index_image;
+  WRATHImage *m_untiled_image;
+
+  vecN<WRATHUniformData::uniform_setter_base::handle, 4> m_uniforms;
+};
+
+/*! @} */
+
+#endif
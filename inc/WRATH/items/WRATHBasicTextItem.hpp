@@ -324,6 +324,18 @@ private:
 
     void
     change_attribute_store(void);
+
+    bool
+    instanced(void) const
+    {
+      return m_attribute_key.m_instance_vertex_count>0;
+    }
+
+    void
+    create_instance_groups(void);
+
+    void
+    delete_instance_groups(void);
     
     WRATHBasicTextItem *m_parent;
     std::set<WRATHItemDrawState> m_key;
@@ -335,6 +347,13 @@ private:
     std::vector<range_type<int> > m_attribute_location;
     WRATHTextAttributePacker::allocation_requirement_type m_required, m_allocated;
     WRATHIndexGroupAllocator::index_group<GLushort> m_index_data_location;
+
+    /*
+      if the packer draws instanced, the glyphs are
+      drawn by instance groups covering the attributes
+      packed rather than by m_index_data_location
+     */
+    std::vector<WRATHIndexGroupAllocator::instance_group> m_instance_groups;
   };
 
 
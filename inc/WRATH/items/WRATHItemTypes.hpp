@@ -194,7 +194,8 @@ namespace WRATHItemTypes
      */
     Drawer(void):
       m_packer(NULL),
-      m_buffer_object_hint(GL_STATIC_DRAW)
+      m_buffer_object_hint(GL_STATIC_DRAW),
+      m_stream_buffer_count(0)
     {}
 
     /*!\fn Drawer(const WRATHShaderSpecifier*,const AttributePacker*, WRATHDrawType)
@@ -210,7 +211,8 @@ namespace WRATHItemTypes
            WRATHDrawType ppass=WRATHDrawType::opaque_pass()):
       m_packer(pk),
       m_draw_passes(1, Pass(sh,ppass) ),
-      m_buffer_object_hint(GL_STATIC_DRAW)
+      m_buffer_object_hint(GL_STATIC_DRAW),
+      m_stream_buffer_count(0)
     {}
 
     /*!\fn void set_item_draw_state_value(WRATHItemDrawState&, int, 
@@ -308,6 +310,18 @@ namespace WRATHItemTypes
       is GL_STATIC_DRAW.
      */
     GLenum m_buffer_object_hint;
+
+    /*!\var m_stream_buffer_count
+      Streaming mode of the buffer object
+      holding the attribute data of the item as in
+      \ref WRATHAttributeStoreKey::m_stream_buffer_count,
+      for items whose attribute data changes every
+      frame. WRATHRectItem honors the value, text
+      items take it from
+      WRATHTextItemTypes::TextExtraDrawState::m_stream_buffer_count.
+      Default value is 0 (no streaming).
+     */
+    int m_stream_buffer_count;
   };
 }
 
@@ -326,7 +326,8 @@ namespace WRATHTextItemTypes
       Ctor initializing the TextExtraDrawState
       as empty.
      */
-    TextExtraDrawState(void)
+    TextExtraDrawState(void):
+      m_stream_buffer_count(0)
     {}
 
     /*!\fn TextExtraDrawState(const WRATHSubItemDrawState&)
@@ -337,7 +338,8 @@ namespace WRATHTextItemTypes
                            initialize m_common_pass_state
      */
     TextExtraDrawState(const WRATHSubItemDrawState &pcommon_state):
-      m_common_pass_state(pcommon_state)
+      m_common_pass_state(pcommon_state),
+      m_stream_buffer_count(0)
     {}
 
     /*!\var m_named_pass_state
@@ -354,6 +356,28 @@ namespace WRATHTextItemTypes
      */
     WRATHSubItemDrawState m_common_pass_state;
 
+    /*!\var m_stream_buffer_count
+      Streaming mode of the buffer object holding
+      the attribute data of the text, as in
+      \ref WRATHAttributeStoreKey::m_stream_buffer_count.
+      Set it to a non-zero value for text whose
+      attribute data changes every frame, for
+      example animated text that is re-added
+      each frame. Default value is 0 (no streaming).
+     */
+    int m_stream_buffer_count;
+
+    /*!\fn TextExtraDrawState& stream_buffer_count
+      Sets \ref m_stream_buffer_count.
+      \param v value to which to set \ref m_stream_buffer_count
+     */
+    TextExtraDrawState&
+    stream_buffer_count(int v)
+    {
+      m_stream_buffer_count=v;
+      return *this;
+    }
+
     /*!\fn WRATHSubItemDrawState& opaque_pass_state
       Returns the extra state of
       which is only for the opaque 
@@ -288,13 +288,46 @@ public:
      */
     draw_information(void):
       WRATHRawDrawData::draw_information(),
-      m_layer_count(0)
+      m_layer_count(0),
+      m_batched_layer_count(0),
+      m_layer_batch_count(0),
+      m_scissor_clip_count(0),
+      m_shared_clip_count(0)
     {}
 
     /*!\var m_layer_count  
       Number of \ref WRATHLayer objects drawn.
      */ 
     int m_layer_count;
+
+    /*!\var m_batched_layer_count
+      Number of \ref WRATHLayer objects drawn
+      as part of a batch of sibling layers,
+      see \ref batch_with_siblings(bool).
+     */
+    int m_batched_layer_count;
+
+    /*!\var m_layer_batch_count
+      Number of batches of sibling \ref WRATHLayer 
+      objects drawn, see \ref batch_with_siblings(bool).
+     */
+    int m_layer_batch_count;
+
+    /*!\var m_scissor_clip_count
+      Number of \ref WRATHLayer objects whose
+      clipping was applied with the scissor test
+      instead of the stencil buffer, see \ref
+      WRATHLayerClipDrawer::DrawStateElementClipping::m_device_bbox_exact.
+     */
+    int m_scissor_clip_count;
+
+    /*!\var m_shared_clip_count
+      Number of \ref WRATHLayer objects that 
+      reused the stencil clipping of the sibling
+      drawn before them, see \ref
+      WRATHLayerClipDrawer::shares_clip_region().
+     */
+    int m_shared_clip_count;
   };
 
   /*!\class matrix_state
@@ -578,6 +611,54 @@ public:
   void
   visible(bool v);
 
+  /*!\fn bool batch_with_siblings(void)
+    Returns true if this WRATHLayer may be
+    drawn batched with its siblings, see
+    \ref batch_with_siblings(bool).
+   */
+  bool
+  batch_with_siblings(void);
+
+  /*!\fn void batch_with_siblings(bool)
+    Sets if this WRATHLayer may be drawn batched
+    with its siblings. Consecutive (in child order)
+    siblings that are batchable are drawn together:
+    the opaque items (\ref WRATHDrawType::opaque_draw)
+    of all the layers of the batch are merged into a single
+    list sorted by GL state (see \ref 
+    WRATHRawDrawData::merged_draw_list), and the other
+    passes are drawn for all layers of the batch, in
+    child order, without resetting the GL state between
+    layers. Thus layers of a batch share program, texture
+    and buffer binds. A WRATHLayer is only drawn batched 
+    if it has batching enabled, is visible, has no
+    children, has no \ref WRATHLayerClipDrawer and no
+    clipping items (\ref WRATHDrawType::clip_inside_draw
+    and \ref WRATHDrawType::clip_outside_draw), i.e. it
+    has the same clipping as its parent. Otherwise it is
+    drawn as usual. Enabling batching changes the draw
+    order: a batch is drawn pass by pass rather than
+    layer by layer, i.e. the opaque items of all layers
+    of the batch are drawn (in GL state order, not child
+    order), then the \ref WRATHDrawType::opaque_overdraw
+    items of all layers, then the transparent items of
+    all layers and then the \ref WRATHDrawType::transparent_overdraw
+    items of all layers. Thus an opaque_overdraw item of
+    a layer is drawn after the opaque items of the later
+    siblings of the batch, which differs from drawing
+    the layers unbatched; only enable batching for layers
+    whose overdraw items do not overlap the opaque items
+    of their siblings. In addition draw_content_pre_children()
+    and draw_content_post_children() are NOT called
+    for layers drawn batched, thus a layer is only
+    drawn batched if batchable_content() returns true.
+    Default value is false. The value is not triple
+    buffered and is set and returned via atomic ops.
+    \param v if true, this WRATHLayer may be drawn batched
+   */
+  void
+  batch_with_siblings(bool v);
+
   /*!\fn const float4x4& simulation_matrix(enum matrix_type)
     Returns the current value of the matrix
     as last set in the simulation thread,
@@ -879,6 +960,24 @@ protected:
   virtual
   void
   draw_content_post_children(WRATHRawDrawData::DrawState &gl_state);
+
+  /*!\fn bool batchable_content
+    To be optionally implemented by a derived class
+    to return true if the content of the WRATHLayer
+    is drawn exactly as by the default implementations
+    of draw_content_pre_children() and 
+    draw_content_post_children(), which is required
+    for the WRATHLayer to be drawn batched with its
+    siblings (see \ref batch_with_siblings(bool)).
+    Default implementation returns true only if the
+    WRATHLayer is not of a derived type, i.e. a derived
+    class that does not reimplement those methods
+    must reimplement batchable_content() to return
+    true to be drawn batched.
+   */
+  virtual
+  bool
+  batchable_content(void);
   
   virtual
   void
@@ -912,6 +1011,36 @@ private:
     bool m_write_z;
     bool m_clipped;
     enum WRATHLayerClipDrawer::clip_mode_type m_clipping_mode;
+
+    /*
+      m_scissored is true if the element
+      clips with the scissor test, m_scissor_test
+      and m_scissor_box give the scissor
+      state active for the element.
+     */
+    bool m_scissored;
+    bool m_scissor_test;
+    vecN<GLint, 4> m_scissor_box;
+  };
+
+  /*
+    a retained_clip records the stencil values
+    written by a layer clipped with layer_clipped_sibling
+    that have not yet been cleared so that the next 
+    sibling can reuse them.
+   */
+  class retained_clip
+  {
+  public:
+    retained_clip(void):
+      m_render_parent(NULL),
+      m_stencil_value(0)
+    {}
+
+    WRATHLayerClipDrawer::handle m_clip_drawer;
+    WRATHLayerClipDrawer::DrawStateElement m_element;
+    WRATHLayer *m_render_parent;
+    int m_stencil_value;
   };
 
   class draw_state
@@ -923,6 +1052,7 @@ private:
     ~draw_state()
     {
       WRATHassert(m_stack.size()==1);
+      WRATHassert(!m_retained_clip.m_clip_drawer.valid());
     }
 
     void
@@ -946,6 +1076,25 @@ private:
       return m_draw_stack;
     }
 
+    /*
+      used to draw the clip region of m_retained_clip
+      after the element of the retained layer has 
+      been popped.
+     */
+    void
+    push_draw_stack(const WRATHLayerClipDrawer::DrawStateElement &v)
+    {
+      m_draw_stack.push_back(v);
+    }
+
+    void
+    pop_draw_stack(void)
+    {
+      m_draw_stack.pop_back();
+    }
+
+    retained_clip m_retained_clip;
+
   private:
     std::vector<draw_state_element> m_stack;
     std::vector<WRATHLayerClipDrawer::DrawStateElement> m_draw_stack;
@@ -976,9 +1125,19 @@ private:
                  draw_information &stats,
                  WRATHLayer *from);
 
+  bool
+  render_batchable(void);
+
+  void
+  draw_batched_children(std::list<WRATHLayer*>::iterator begin,
+                        std::list<WRATHLayer*>::iterator end,
+                        WRATHRawDrawData::DrawState &gl_state,
+                        draw_information &stats);
+
   bool
   push_clipping(draw_state &state_stack, bool &have_clip_items,
-                WRATHRawDrawData::DrawState &gl_state);
+                WRATHRawDrawData::DrawState &gl_state,
+                draw_information &stats);
 
   void
   push_clipped_in_items(draw_state &state_stack, bool &have_clip_items,
@@ -992,6 +1151,11 @@ private:
   pop_clipped_in_items(draw_state &state_stack, bool have_clip_items,
                        WRATHRawDrawData::DrawState &gl_state);
 
+  static
+  void
+  release_retained_clip(draw_state &state_stack,
+                        WRATHRawDrawData::DrawState &gl_state);
+
   void
   on_end_simulation_frame(void);
   
@@ -1033,6 +1197,12 @@ private:
    */
   int m_visible;
 
+  /*
+    +1=batch with siblings
+    0=do not batch with siblings
+   */
+  int m_batch_with_siblings;
+
   /*
     effective matrix values only valid during rendering!
    */
@@ -1046,6 +1216,13 @@ private:
   bool m_render_children_need_sorting;
   std::list<WRATHLayer*> m_render_children;  
   std::list<WRATHLayer*>::iterator m_render_slot;
+
+  /*
+    work room for drawing batched children,
+    only used in the rendering thread.
+   */
+  std::vector<WRATHLayer*> m_render_batch;
+  WRATHRawDrawData::merged_draw_list m_render_merged_list;
 };
 
 
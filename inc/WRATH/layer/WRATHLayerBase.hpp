@@ -441,13 +441,17 @@ private:
   class MetaGroupBase;
   class MetaGroup;
 
-  
-  typedef WRATHInterleavedAttributes<GLubyte> NodeIndexAttribute;
+  /*
+    GLushort rather than GLubyte so that node
+    packers backed by buffer objects can have
+    more than 256 slots per draw call.
+   */
+  typedef WRATHInterleavedAttributes<GLushort> NodeIndexAttribute;
 
   class CustomData:public CustomDataBaseT<NodeIndexAttribute>
   {
   public:
-    CustomData(GLubyte pslot, 
+    CustomData(GLushort pslot, 
                WRATHLayerItemNodeBase *p,
                MetaGroup *mg):
       m_subkey(p),
@@ -463,13 +467,13 @@ private:
       slot()=obj.slot();
     }
 
-    GLubyte&
+    GLushort&
     slot(void)
     {
       return m_value.get<0>();
     }
 
-    GLubyte
+    GLushort
     slot(void) const
     {
       return m_value.get<0>();
@@ -158,7 +158,8 @@ public:
      */
     DrawStateElementClipping(enum clip_mode_type c=layer_unclipped):
       m_device_bbox(vec2(-1.0f, -1.0f), vec2(1.0f, 1.0f)),
-      m_clip_mode(c)
+      m_clip_mode(c),
+      m_device_bbox_exact(false)
     {}
 
     /*!\var m_device_bbox
@@ -173,6 +174,20 @@ public:
      */
     enum clip_mode_type m_clip_mode;
 
+    /*!\var m_device_bbox_exact
+      If true, indicates that the clipping region 
+      is exactly \ref m_device_bbox, i.e. the clipping
+      region is a rectangle that is aligned to the
+      screen axis after transformation. When \ref 
+      m_clip_mode is \ref layer_clipped_sibling and
+      m_device_bbox_exact is true, WRATHLayer clips 
+      with the scissor test instead of drawing the 
+      clipping region to the stencil buffer, and 
+      draw_region() is not called. Default value 
+      is false.
+     */
+    bool m_device_bbox_exact;
+
     /*!\var m_clip_state
       The clipping state from the WRATHLayerClipDrawer
       that applied clipping to the WRATHLayer
@@ -273,6 +288,35 @@ public:
               const DrawStateElement &layer,
               const_c_array<DrawStateElement> draw_stack) const=0;
 
+  /*!\fn bool shares_clip_region
+    To be optionally implemented by a derived class
+    to indicate that the clipping region drawn by
+    this WRATHLayerClipDrawer for one WRATHLayer is 
+    the same as the clipping region drawn by another
+    WRATHLayerClipDrawer for a sibling WRATHLayer 
+    drawn immediately after it. When true and
+    both are clipped with \ref layer_clipped_sibling,
+    the stencil values written for the first layer 
+    are reused by the second, saving the draws 
+    of draw_region() that restore and then write the 
+    stencil buffer again. Default implementation 
+    returns false.
+    \param layer the DrawStateElement of the WRATHLayer
+                 clipped by this WRATHLayerClipDrawer
+    \param next_drawer WRATHLayerClipDrawer of the next sibling
+    \param next_layer the DrawStateElement of the next sibling,
+                      note that next_layer.m_layer has not 
+                      yet had draw_region() called for it
+   */
+  virtual
+  bool
+  shares_clip_region(const DrawStateElement &/*layer*/,
+                     const WRATHLayerClipDrawer* /*next_drawer*/,
+                     const DrawStateElement &/*next_layer*/) const
+  {
+    return false;
+  }
+
 };
 
 
@@ -411,6 +411,38 @@ public:
   void
   extract_values(reorder_c_array<float> out_value)=0;
 
+  /*!\fn bool extract_values_and_rates
+    Variant of extract_values() that also extracts
+    the rate of change of each value. It is only
+    called by a WRATHLayerNodeValuePackerBase when
+    some node value of the node type has an
+    extrapolation type other than
+    WRATHLayerNodeValuePackerBase::extrapolate_none
+    (see WRATHLayerNodeValuePackerBase::ActiveNodeValuesCollection::set_extrapolation()).
+    The meaning of each rate is given by the
+    extrapolation type of the value (see
+    WRATHLayerNodeValuePackerBase::extrapolation_type).
+    Should return true if the rates were written
+    and false if they were not, in which case
+    the WRATHLayerNodeValuePackerBase computes the
+    rates from the values of the previous simulation
+    frame. Default implementation calls extract_values()
+    and returns false. Like extract_values(), the
+    function is only called from the simulation thread.
+    \param out_value location to which to write the values
+                     for extraction.
+    \param out_rate location to which to write the rates
+                    of the values, same indexing as out_value
+   */
+  virtual
+  bool
+  extract_values_and_rates(reorder_c_array<float> out_value,
+                           reorder_c_array<float> /*out_rate*/)
+  {
+    extract_values(out_value);
+    return false;
+  }
+
   /*!\fn bool compare_children
     To be optionally implemented to compare
     child object to sort the order in which
@@ -0,0 +1,639 @@
+/*! 
+ * \file WRATHLayerItemNodeSpatialIndex.hpp
+ * \brief file WRATHLayerItemNodeSpatialIndex.hpp
+ * 
+ * Copyright 2013 by Nomovok Ltd.
+ * 
+ * Contact: info@nomovok.com
+ * 
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ * 
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ * 
+ */
+
+
+#ifndef WRATH_HEADER_LAYER_ITEM_NODE_SPATIAL_INDEX_HPP_
+#define WRATH_HEADER_LAYER_ITEM_NODE_SPATIAL_INDEX_HPP_
+
+#include "WRATHConfig.hpp"
+#include <vector>
+#include <limits>
+#include <boost/utility.hpp>
+#include <boost/bind.hpp>
+#include "WRATHassert.hpp"
+#include "WRATHTripleBufferEnabler.hpp"
+#include "WRATHSpatialIndex.hpp"
+
+
+/*! \addtogroup Layer
+ * @{
+ */
+
+/*!\class WRATHLayerItemNodeSpatialIndex
+  A WRATHLayerItemNodeSpatialIndex keeps a \ref
+  WRATHSpatialIndex of objects (for example nodes,
+  WRATHLayer's or application objects built from
+  them) whose bounding boxes are given in the
+  coordinate system of a reference node, typically
+  the node that all the objects are placed under.
+  Since the bounding boxes are relative to the
+  reference node, changing the transformation of
+  the reference node (for example panning or zooming
+  a document) does not require updating the index;
+  only an object whose bounding box changes relative
+  to the reference node needs to be updated, with
+  bbox(int, const BBox&).
+
+  An object added with add(T*, const BBox&) does not
+  follow changes to nodes: if it moves relative to the
+  reference node, the application must call
+  bbox(int, const BBox&) with the new bounding box,
+  otherwise cull() and query() use the stale box.
+  An object added with add(T*, const BBox&, N*) instead
+  has its bounding box given in the coordinate system
+  of a node of the same hierarchy as the reference node.
+  After each hierarchy walk that follows a change of a
+  node of the hierarchy (i.e. whenever ef
+  WRATHLayerItemNodeBase::hierarchy_dirty() was true
+  at the end of the simulation frame), the boxes of
+  such objects are recomputed from the global values
+  of their nodes, thus the index follows those objects
+  as their nodes move; frames without node changes
+  do no work.
+
+  The methods cull() and query() take rectangles and
+  points in the coordinate system in which the
+  transformation of \ref WRATHLayerItemNodeTranslateValues::m_transformation
+  of the global values of the reference node is expressed,
+  i.e. the coordinates of the root node of the hierarchy,
+  which is the window coordinate system for the common
+  case of a WRATHLayer whose modelview matrix is the identity
+  and whose projection matrix is pixel-based.
+  Each query walks the tree of the \ref WRATHSpatialIndex,
+  so culling and picking are O(log N + K) rather than O(N).
+
+  cull() only changes the visibility of those objects whose
+  visibility changes from the previous call to cull(),
+  thus when the view changes a little, only a few
+  objects are touched.
+
+  A WRATHLayerItemNodeSpatialIndex is not thread safe and
+  should only be used from the simulation thread, the
+  same thread that modifies the nodes.
+
+  \tparam N node type of the reference node, must provide
+            global_values().m_transformation where the
+            transformation type provides inverse() and
+            apply_to_point(const vec2&), for example
+            \ref WRATHLayerItemNodeTranslate and \ref
+            WRATHLayerItemNodeRotateTranslate
+  \tparam T object type, if cull() or uncull() are used,
+            T must provide the method visible(bool) to
+            set if the object is visible
+ */
+template<typename N, typename T>
+class WRATHLayerItemNodeSpatialIndex:boost::noncopyable
+{
+public:
+  /*!\typedef BBox
+    Type of the bounding boxes.
+   */
+  typedef WRATHSpatialIndex::BBox BBox;
+
+  /*!\fn WRATHLayerItemNodeSpatialIndex
+    Ctor.
+    \param reference_node node in whose coordinate system
+                          the bounding boxes of the objects
+                          are given, the node must stay alive
+                          for the lifetime of the
+                          WRATHLayerItemNodeSpatialIndex
+    \param margin margin of the underlying \ref WRATHSpatialIndex
+   */
+  explicit
+  WRATHLayerItemNodeSpatialIndex(N *reference_node, float margin=0.0f):
+    m_reference_node(reference_node),
+    m_index(margin),
+    m_current_stamp(0),
+    m_order_counter(0),
+    m_hierarchy_changed(false)
+  {
+    WRATHassert(m_reference_node!=NULL);
+
+    /*
+      the first slot runs before the hierarchy walk
+      (whose group order is negative) to record if
+      the hierarchy changed, the second after it to 
+      update the boxes of the tracked objects.
+     */
+    m_connections[0]=m_reference_node->connect(WRATHTripleBufferEnabler::on_complete_simulation_frame,
+                                               WRATHTripleBufferEnabler::pre_update_no_lock,
+                                               boost::bind(&WRATHLayerItemNodeSpatialIndex::note_hierarchy_changed, this),
+                                               std::numeric_limits<int>::min());
+
+    m_connections[1]=m_reference_node->connect(WRATHTripleBufferEnabler::on_complete_simulation_frame,
+                                               WRATHTripleBufferEnabler::pre_update_no_lock,
+                                               boost::bind(&WRATHLayerItemNodeSpatialIndex::update_tracked_on_change, this),
+                                               0);
+  }
+
+  ~WRATHLayerItemNodeSpatialIndex()
+  {
+    m_connections[0].disconnect();
+    m_connections[1].disconnect();
+  }
+
+  /*!\fn N* reference_node
+    Returns the reference node as passed in the ctor.
+   */
+  N*
+  reference_node(void) const
+  {
+    return m_reference_node;
+  }
+
+  /*!\fn int add
+    Add an object, returning an ID for the object
+    which is valid until it is removed with remove().
+    The object is regarded as visible until the
+    next call to cull().
+    \param object object to add
+    \param box bounding box of the object in the coordinate
+               system of reference_node(), may not be empty
+   */
+  int
+  add(T *object, const BBox &box)
+  {
+    int id;
+
+    id=m_index.add(box, object);
+    if(id>=static_cast<int>(m_entries.size()))
+      {
+        m_entries.resize(id+1);
+      }
+    m_entries[id].m_in_use=true;
+    m_entries[id].m_visible_slot=m_visible.size();
+    m_entries[id].m_stamp=0;
+    m_entries[id].m_order=m_order_counter++;
+    m_entries[id].m_node=NULL;
+    m_entries[id].m_tracked_slot=-1;
+    m_visible.push_back(id);
+    return id;
+  }
+
+  /*!n int add(T*, const BBox&, N*)
+    Add an object whose bounding box is given in the
+    coordinate system of a node and follows that node,
+    see the class description. Returns an ID for the
+    object which is valid until it is removed with remove().
+    The object is regarded as visible until the
+    next call to cull().
+    \param object object to add
+    \param box bounding box of the object in the coordinate
+               system of node, may not be empty
+    \param node node of the same hierarchy as reference_node(),
+                the node must stay alive until the object is 
+                removed
+   */
+  int
+  add(T *object, const BBox &box, N *node)
+  {
+    int id;
+
+    WRATHassert(node!=NULL);
+    id=add(object, global_to_local_box(node, box));
+    m_entries[id].m_node=node;
+    m_entries[id].m_node_box=box;
+    m_entries[id].m_tracked_slot=m_tracked.size();
+    m_tracked.push_back(id);
+    return id;
+  }
+
+  /*!\fn void remove
+    Remove an object, the visibility of the
+    object is not changed.
+    \param id ID of object as returned by add()
+   */
+  void
+  remove(int id)
+  {
+    remove_from_visible(id);
+    remove_from_tracked(id);
+    m_entries[id].m_in_use=false;
+    m_index.remove(id);
+  }
+
+  /*!\fn void bbox(int, const BBox&)
+    Set the bounding box of an object.
+    \param id ID of object as returned by add()
+    \param box bounding box of the object, may not be empty,
+               in the coordinate system of the node of the
+               object if it was added with add(T*, const BBox&, N*)
+               and otherwise of reference_node()
+   */
+  void
+  bbox(int id, const BBox &box)
+  {
+    if(m_entries[id].m_node!=NULL)
+      {
+        m_entries[id].m_node_box=box;
+        m_index.move(id, global_to_local_box(m_entries[id].m_node, box));
+      }
+    else
+      {
+        m_index.move(id, box);
+      }
+  }
+
+  /*!\fn BBox bbox(int) const
+    Returns the bounding box of an object in
+    the coordinate system of reference_node().
+    \param id ID of object as returned by add()
+   */
+  BBox
+  bbox(int id) const
+  {
+    return m_index.bbox(id);
+  }
+
+  /*!\fn T* object
+    Returns the object of an ID.
+    \param id ID of object as returned by add()
+   */
+  T*
+  object(int id) const
+  {
+    return static_cast<T*>(m_index.user_data(id));
+  }
+
+  /*!\fn int size
+    Returns the number of objects.
+   */
+  int
+  size(void) const
+  {
+    return m_index.size();
+  }
+
+  /*!\fn void clear
+    Remove all objects, the visibility
+    of the objects is not changed.
+   */
+  void
+  clear(void)
+  {
+    m_index.clear();
+    m_entries.clear();
+    m_visible.clear();
+    m_tracked.clear();
+    m_order_counter=0;
+  }
+
+  /*!\fn void update_tracked
+    Recompute the bounding boxes of the objects added
+    with add(T*, const BBox&, N*) from the current global
+    values of their nodes. This is done automatically after
+    each hierarchy walk following a change of the hierarchy,
+    an application only needs to call it if it walks the 
+    hierarchy itself (for example with \ref
+    WRATHLayerItemNodeBase::walk_hierarchy_if_necessary())
+    and needs the boxes before the end of the simulation frame.
+   */
+  void
+  update_tracked(void)
+  {
+    for(std::vector<int>::const_iterator iter=m_tracked.begin(),
+          end=m_tracked.end(); iter!=end; ++iter)
+      {
+        const per_entry &E(m_entries[*iter]);
+        m_index.move(*iter, global_to_local_box(E.m_node, E.m_node_box));
+      }
+  }
+
+  /*!\fn BBox local_box
+    Returns the bounding box in the coordinate
+    system of reference_node() of a rectangle.
+    \param box rectangle in the coordinate system of the
+               global values of the reference node
+   */
+  BBox
+  local_box(const BBox &box) const
+  {
+    BBox return_value;
+
+    if(!box.empty())
+      {
+        const vec2 &pmin(box.min_corner());
+        const vec2 &pmax(box.max_corner());
+
+        return_value.set_or(local_point(pmin));
+        return_value.set_or(local_point(pmax));
+        return_value.set_or(local_point(vec2(pmin.x(), pmax.y())));
+        return_value.set_or(local_point(vec2(pmax.x(), pmin.y())));
+      }
+    return return_value;
+  }
+
+  /*!\fn vec2 local_point
+    Returns a point in the coordinate system
+    of reference_node().
+    \param pt point in the coordinate system of the
+              global values of the reference node
+   */
+  vec2
+  local_point(const vec2 &pt) const
+  {
+    return m_reference_node->global_values().m_transformation.inverse().apply_to_point(pt);
+  }
+
+  /*!\fn void cull
+    Make those objects visible whose bounding box
+    intersects a rectangle and all other objects
+    not visible. Only those objects whose visibility
+    changes from the previous call to cull() (or
+    uncull()) have T::visible(bool) called.
+    \param view rectangle in the coordinate system of the
+                global values of the reference node
+   */
+  void
+  cull(const BBox &view)
+  {
+    unsigned int stamp;
+
+    m_query.clear();
+    m_index.query(local_box(view), m_query);
+
+    /*
+      mark the objects in view with
+      a new stamp
+     */
+    stamp=next_stamp();
+    for(std::vector<int>::const_iterator iter=m_query.begin(),
+          end=m_query.end(); iter!=end; ++iter)
+      {
+        m_entries[*iter].m_stamp=stamp;
+      }
+
+    /*
+      hide those objects that were visible
+      but are no longer in view.
+     */
+    for(unsigned int i=0; i<m_visible.size(); )
+      {
+        int id(m_visible[i]);
+
+        if(m_entries[id].m_stamp!=stamp)
+          {
+            object(id)->visible(false);
+            remove_from_visible(id);
+          }
+        else
+          {
+            ++i;
+          }
+      }
+
+    /*
+      show those objects that are in
+      view but were not visible.
+     */
+    for(std::vector<int>::const_iterator iter=m_query.begin(),
+          end=m_query.end(); iter!=end; ++iter)
+      {
+        if(m_entries[*iter].m_visible_slot==-1)
+          {
+            object(*iter)->visible(true);
+            m_entries[*iter].m_visible_slot=m_visible.size();
+            m_visible.push_back(*iter);
+          }
+      }
+  }
+
+  /*!\fn void uncull
+    Make all objects visible, only those objects
+    that are not visible from the previous call
+    to cull() have T::visible(bool) called.
+   */
+  void
+  uncull(void)
+  {
+    for(int id=0, end_id=m_entries.size(); id<end_id; ++id)
+      {
+        if(m_entries[id].m_in_use and m_entries[id].m_visible_slot==-1)
+          {
+            object(id)->visible(true);
+            m_entries[id].m_visible_slot=m_visible.size();
+            m_visible.push_back(id);
+          }
+      }
+  }
+
+  /*!\fn void query(const BBox&, std::vector<T*>&) const
+    Append to a std::vector the objects whose
+    bounding box intersects a rectangle.
+    \param box rectangle in the coordinate system of the
+               global values of the reference node
+    \param out location to which to append the objects
+   */
+  void
+  query(const BBox &box, std::vector<T*> &out) const
+  {
+    query_local(local_box(box), out);
+  }
+
+  /*!\fn void query(const vec2&, std::vector<T*>&) const
+    Append to a std::vector the objects whose
+    bounding box contains a point.
+    \param pt point in the coordinate system of the
+              global values of the reference node
+    \param out location to which to append the objects
+   */
+  void
+  query(const vec2 &pt, std::vector<T*> &out) const
+  {
+    vec2 p(local_point(pt));
+    query_local(BBox(p, p), out);
+  }
+
+  /*!\fn T* first_at
+    Returns the object whose bounding box contains
+    a point and was added first among all such objects,
+    returns NULL if there is no such object.
+    \param pt point in the coordinate system of the
+              global values of the reference node
+   */
+  T*
+  first_at(const vec2 &pt) const
+  {
+    vec2 p(local_point(pt));
+    int best(-1);
+
+    m_query.clear();
+    m_index.query(BBox(p, p), m_query);
+    for(std::vector<int>::const_iterator iter=m_query.begin(),
+          end=m_query.end(); iter!=end; ++iter)
+      {
+        if(best==-1 or m_entries[*iter].m_order<m_entries[best].m_order)
+          {
+            best=*iter;
+          }
+      }
+    return (best!=-1)?
+      object(best):
+      NULL;
+  }
+
+private:
+
+  class per_entry
+  {
+  public:
+    per_entry(void):
+      m_in_use(false),
+      m_visible_slot(-1),
+      m_stamp(0),
+      m_order(0),
+      m_node(NULL),
+      m_tracked_slot(-1)
+    {}
+
+    bool m_in_use;
+
+    /*
+      location in m_visible or -1
+      if not visible
+     */
+    int m_visible_slot;
+    unsigned int m_stamp;
+    unsigned int m_order;
+
+    /*
+      node and box in the coordinates of the
+      node for those objects added with
+      add(T*, const BBox&, N*), m_tracked_slot
+      is the location in m_tracked or -1.
+     */
+    N *m_node;
+    BBox m_node_box;
+    int m_tracked_slot;
+  };
+
+  void
+  remove_from_tracked(int id)
+  {
+    int slot(m_entries[id].m_tracked_slot);
+
+    if(slot!=-1)
+      {
+        int moved(m_tracked.back());
+
+        m_tracked[slot]=moved;
+        m_entries[moved].m_tracked_slot=slot;
+        m_tracked.pop_back();
+        m_entries[id].m_tracked_slot=-1;
+        m_entries[id].m_node=NULL;
+      }
+  }
+
+  /*
+    box in the coordinate system of reference_node()
+    of a box in the coordinate system of a node
+   */
+  BBox
+  global_to_local_box(N *node, const BBox &box) const
+  {
+    BBox global;
+
+    if(!box.empty())
+      {
+        const vec2 &pmin(box.min_corner());
+        const vec2 &pmax(box.max_corner());
+
+        global.set_or(node->global_values().m_transformation.apply_to_point(pmin));
+        global.set_or(node->global_values().m_transformation.apply_to_point(pmax));
+        global.set_or(node->global_values().m_transformation.apply_to_point(vec2(pmin.x(), pmax.y())));
+        global.set_or(node->global_values().m_transformation.apply_to_point(vec2(pmax.x(), pmin.y())));
+      }
+    return local_box(global);
+  }
+
+  void
+  note_hierarchy_changed(void)
+  {
+    m_hierarchy_changed=m_reference_node->hierarchy_dirty();
+  }
+
+  void
+  update_tracked_on_change(void)
+  {
+    if(m_hierarchy_changed)
+      {
+        m_hierarchy_changed=false;
+        update_tracked();
+      }
+  }
+
+  void
+  remove_from_visible(int id)
+  {
+    int slot(m_entries[id].m_visible_slot);
+
+    if(slot!=-1)
+      {
+        int moved(m_visible.back());
+
+        m_visible[slot]=moved;
+        m_entries[moved].m_visible_slot=slot;
+        m_visible.pop_back();
+        m_entries[id].m_visible_slot=-1;
+      }
+  }
+
+  void
+  query_local(const BBox &box, std::vector<T*> &out) const
+  {
+    m_query.clear();
+    m_index.query(box, m_query);
+    for(std::vector<int>::const_iterator iter=m_query.begin(),
+          end=m_query.end(); iter!=end; ++iter)
+      {
+        out.push_back(object(*iter));
+      }
+  }
+
+  unsigned int
+  next_stamp(void)
+  {
+    ++m_current_stamp;
+    if(m_current_stamp==0)
+      {
+        for(typename std::vector<per_entry>::iterator iter=m_entries.begin(),
+              end=m_entries.end(); iter!=end; ++iter)
+          {
+            iter->m_stamp=0;
+          }
+        m_current_stamp=1;
+      }
+    return m_current_stamp;
+  }
+
+  N *m_reference_node;
+  WRATHSpatialIndex m_index;
+  std::vector<per_entry> m_entries;
+  std::vector<int> m_visible;
+  unsigned int m_current_stamp;
+  unsigned int m_order_counter;
+  mutable std::vector<int> m_query;
+
+  std::vector<int> m_tracked;
+  bool m_hierarchy_changed;
+  vecN<WRATHTripleBufferEnabler::connect_t, 2> m_connections;
+};
+
+/*! @} */
+
+#endif
@@ -52,6 +52,59 @@ class WRATHLayerNodeValuePackerBase:
   public WRATHLayerBase::GLStateOfNodeCollection
 {
 public:
+  /*!\enum extrapolation_type
+    Enumeration to specify how a per-node value
+    is extrapolated by elapsed time in the rendering
+    thread so that the simulation thread can run
+    at a lower rate than the rendering thread,
+    see \ref max_extrapolation_time(). The rate
+    of a value is either provided by the node
+    (see WRATHLayerItemNodeBase::extract_values_and_rates())
+    or computed from the values of the previous
+    two simulation frames.
+   */
+  enum extrapolation_type
+    {
+      /*!
+        Value is not extrapolated, this is 
+        the default.
+       */
+      extrapolate_none,
+
+      /*!
+        Value is extrapolated linearly,
+        i.e. value + rate*t. The rate is
+        the derivative of the value in 
+        units per second.
+       */
+      extrapolate_linear,
+
+      /*!
+        Value is extrapolated exponentially,
+        i.e. value*exp(rate*t), appropiate for
+        scaling factors. The sign of the value
+        is preserved. The rate is the derivative
+        of log(|value|) per second.
+       */
+      extrapolate_exponential,
+
+      /*!
+        The value and the value that follows it
+        form a complex number (real part first),
+        for example the rotation-scale of a 
+        WRATH2DRigidTransformation. The pair is
+        extrapolated by multiplying by 
+        exp( (rate_real + i*rate_imag)*t ),
+        where rate_real is the derivative of
+        log of the magnitude and rate_imag
+        is the derivative of the angle, both
+        per second. Hence rotations are
+        extrapolated along the circle rather
+        than along its tangent.
+       */
+      extrapolate_complex_exponential
+    };
+
   /*!\class ActiveNodeValue
     Because not all per-node values are used by each
     shader stage, the location of the node-value
@@ -371,9 +424,53 @@ public:
       return m_one_plus_highest_index;
     }
 
+    /*!\fn ActiveNodeValuesCollection& set_extrapolation(int, enum extrapolation_type)
+      Set how a node value is extrapolated by the
+      rendering thread, see \ref extrapolation_type.
+      For \ref extrapolate_complex_exponential, only
+      set the value for the source index of the
+      real part.
+      \param idx source index of the node value, i.e. a valid
+                 entry for \ref ActiveNodeValue::m_source_index
+      \param tp extrapolation type
+     */
+    ActiveNodeValuesCollection&
+    set_extrapolation(int idx, enum extrapolation_type tp)
+    {
+      m_extrapolation[idx]=tp;
+      return *this;
+    }
+
+    /*!\fn enum extrapolation_type extrapolation(int) const
+      Returns how a node value is extrapolated
+      as set by set_extrapolation(), if never set
+      returns \ref extrapolate_none.
+      \param idx source index of the node value
+     */
+    enum extrapolation_type
+    extrapolation(int idx) const
+    {
+      std::map<int, enum extrapolation_type>::const_iterator iter;
+      iter=m_extrapolation.find(idx);
+      return (iter!=m_extrapolation.end())?
+        iter->second:
+        extrapolate_none;
+    }
+
+    /*!\fn const std::map<int, enum extrapolation_type>& extrapolation_entries(void) const
+      Returns the extrapolation types set by
+      set_extrapolation(), keyed by source index.
+     */
+    const std::map<int, enum extrapolation_type>&
+    extrapolation_entries(void) const
+    {
+      return m_extrapolation;
+    }
+
   private:
     map_type m_entries;
     int m_one_plus_highest_index;
+    std::map<int, enum extrapolation_type> m_extrapolation;
   };
   
   /*!\class NodeDataPackParameters
@@ -1016,6 +1113,17 @@ public:
     bool
     non_empty(void) const;
 
+    /*!\fn bool extrapolated
+      Returns true if the values returned by
+      data_to_pack_to_GL() are extrapolated
+      by the time elapsed since the simulation
+      frame that produced them, see \ref
+      extrapolation_type. Must only be called
+      from the rendering thread.
+     */
+    bool
+    extrapolated(void) const;
+
   private:
     explicit
     DataToGL(const void *ptr):
@@ -1081,6 +1189,66 @@ public:
   DataToGL
   data_to_gl_indexed(unsigned int idx);
 
+  /*!\fn int32_t max_extrapolation_time(void)
+    Returns the maximum time in milliseconds by
+    which per-node values are extrapolated in the
+    rendering thread, see \ref extrapolation_type.
+    Extrapolation only takes place for those node
+    values whose node type specifies an extrapolation
+    type (see ActiveNodeValuesCollection::set_extrapolation()).
+    A value of 0 indicates to not extrapolate at all,
+    in which case the rates of the values are not
+    computed either. Extrapolation is opt-in, the
+    default value is 0.
+    In addition to this limit, values are never
+    extrapolated further than the time between the
+    two most recent simulation frames, so that an
+    application that only runs a simulation frame
+    in response to events does not draw items past
+    where they stopped.
+   */
+  static
+  int32_t
+  max_extrapolation_time(void);
+
+  /*!\fn void max_extrapolation_time(int32_t)
+    Sets the maximum time in milliseconds by
+    which per-node values are extrapolated in
+    the rendering thread, see max_extrapolation_time(void).
+    \param v value to use, a value of 0 disables extrapolation
+   */
+  static
+  void
+  max_extrapolation_time(int32_t v);
+
+  /*!\fn float max_extrapolation_jump(void)
+    Returns the largest change between two
+    simulation frames of a value extrapolated
+    with \ref extrapolate_linear that is still
+    regarded as motion. A larger change (for
+    example an item teleported to a new position)
+    is regarded as a discontinuity and the rates
+    of all the values of that node are set to zero
+    for that simulation frame. The rates of a node
+    are also set to zero if none of its extrapolated
+    values changed from the previous simulation
+    frame. Default value is 64.0.
+   */
+  static
+  float
+  max_extrapolation_jump(void);
+
+  /*!\fn void max_extrapolation_jump(float)
+    Sets the largest change between two simulation
+    frames of a linearly extrapolated value that is
+    still regarded as motion, see max_extrapolation_jump(void).
+    \param v value to use, a non-positive value
+              indicates to not detect discontinuities
+   */
+  static
+  void
+  max_extrapolation_jump(float v);
+
 protected:
 
   virtual
@@ -1096,7 +1264,7 @@ private:
     per_packer_datum(WRATHLayerNodeValuePackerBase *pparent,
                      const ActiveNodeValues &used_per_node_values,
                      const NodeDataPackParameters &packing_params,
-                     int one_plus_highest_index);
+                     const ActiveNodeValuesCollection &original_data);
 
     /*
       no shader stage, etc indicates a per_shader_stage
@@ -1138,14 +1306,58 @@ private:
     */
     std::vector<float> m_pack_work_room;
 
+    /*
+      extrapolation: m_extrapolation lists the
+      packed values (by offset into a node's row)
+      that are extrapolated, m_rates holds their
+      rates (triple buffered, same layout as 
+      m_data_to_pack_to_GL_padded). m_extrapolated
+      is only touched by the rendering thread
+      and holds the extrapolated values of
+      the present ID.
+     */
+    class extrapolation_entry
+    {
+    public:
+      enum extrapolation_type m_type;
+      int m_offset, m_offset_imag;
+    };
+    std::vector<extrapolation_entry> m_extrapolation;
+    vecN<std::vector<float>, 3> m_rates;
+    std::vector<float> m_rate_work_room;
+    std::vector<float> m_extrapolated;
+    bool m_extrapolated_valid;
+
+    int
+    location(int node, int offset) const
+    {
+      return (m_packing_type==NodeDataPackParameters::packed_by_node)?
+        node*m_padded_row_size_in_floats + offset:
+        offset*m_padded_row_size_in_floats + node;
+    }
+
     void
     pack_data(int number_slots);
-    
+
+    void
+    compute_rates(int node, float dt);
+
+    bool
+    rates_are_stale(int node) const;
+
+    void
+    zero_rates(int node);
+
+    void
+    extrapolate_data(int number_slots, float t);
   };
  
   void
   pack_data(void);
 
+  void
+  extrapolate_data(void);
+
 
   SpecDataProcessedPayload::const_handle m_payload;
   int m_highest_slot;
@@ -1155,6 +1367,22 @@ private:
   std::vector<WRATHLayerItemNodeBase*> m_nodes;
   WRATHTripleBufferEnabler::connect_t m_sim_signal;
 
+  /*
+    extrapolation book keeping: time at which each 
+    buffer was packed, the time since the buffer
+    packed before it, the buffer packed the previous
+    simulation frame and what nodes were packed to it.
+    m_extrapolate is true if any value is extrapolated,
+    m_extrapolating is true if in addition extrapolation
+    was enabled at the last pack.
+   */
+  bool m_extrapolate, m_extrapolating;
+  vecN<int32_t, 3> m_pack_time;
+  vecN<int32_t, 3> m_pack_interval;
+  int m_previous_pack_ID;
+  std::vector<WRATHLayerItemNodeBase*> m_previous_nodes;
+  WRATHTripleBufferEnabler::connect_t m_present_signal;
+
   std::vector<per_packer_datum*> m_packers;
   per_packer_datum m_empty_packer;
   std::map<GLenum, int> m_packers_by_shader;
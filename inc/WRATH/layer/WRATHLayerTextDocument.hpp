@@ -0,0 +1,629 @@
+/*! 
+ * \file WRATHLayerTextDocument.hpp
+ * \brief file WRATHLayerTextDocument.hpp
+ * 
+ * Copyright 2013 by Nomovok Ltd.
+ * 
+ * Contact: info@nomovok.com
+ * 
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ * 
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ * 
+ */
+
+
+#ifndef WRATH_HEADER_LAYER_TEXT_DOCUMENT_HPP_
+#define WRATH_HEADER_LAYER_TEXT_DOCUMENT_HPP_
+
+#include "WRATHConfig.hpp"
+#include <vector>
+#include <string>
+#include <boost/utility.hpp>
+#include <boost/function.hpp>
+#include "WRATHNew.hpp"
+#include "WRATHassert.hpp"
+#include "WRATHLayer.hpp"
+#include "WRATHTextItem.hpp"
+#include "WRATHTextDataStream.hpp"
+#include "WRATHLayerItemNodeSpatialIndex.hpp"
+
+
+/*! \addtogroup Layer
+ * @{
+ */
+
+/*!\class WRATHLayerTextDocumentBase
+  WRATHLayerTextDocumentBase holds the text, the
+  chunks and the formatting of a \ref WRATHLayerTextDocument
+  that do not depend on the node type, see
+  \ref WRATHLayerTextDocument for details.
+ */
+class WRATHLayerTextDocumentBase:boost::noncopyable
+{
+public:
+  /*!\typedef BBox
+    Type of the bounding boxes.
+   */
+  typedef WRATHSpatialIndex::BBox BBox;
+
+  /*!\typedef stream_setup_type
+    Function type to set the state (for example
+    font, pixel size and color) of the \ref
+    WRATHTextDataStream before the text of a
+    chunk is added to it. The stream is cleared
+    before the function is called.
+   */
+  typedef boost::function<void (WRATHTextDataStream&)> stream_setup_type;
+
+  /*!\class parameters
+    Specifies how the text of a WRATHLayerTextDocument
+    is drawn, formatted and split into chunks.
+   */
+  class parameters
+  {
+  public:
+    /*!\fn parameters
+      Ctor, initializes the values as follows:
+      - m_opacity=WRATHTextItemTypes::text_opaque
+      - m_estimated_line_height=38
+      - m_estimated_width=800
+      - m_chunk_size=4096
+      - m_load_margin=256
+      - m_release_margin=1024
+     */
+    parameters(void):
+      m_opacity(WRATHTextItemTypes::text_opaque),
+      m_estimated_line_height(38.0f),
+      m_estimated_width(800.0f),
+      m_chunk_size(4096),
+      m_load_margin(256.0f),
+      m_release_margin(1024.0f)
+    {}
+
+    /*!\var m_layout
+      Layout used to format each chunk.
+     */
+    WRATHColumnFormatter::LayoutSpecification m_layout;
+
+    /*!\var m_opacity
+      Opacity passed to the ctor of each \ref WRATHTextItem.
+     */
+    enum WRATHTextItemTypes::text_opacity_t m_opacity;
+
+    /*!\var m_drawer
+      Drawer passed to the ctor of each \ref WRATHTextItem.
+     */
+    WRATHTextItem::Drawer m_drawer;
+
+    /*!\var m_draw_order
+      Draw order passed to the ctor of each \ref WRATHTextItem.
+     */
+    WRATHTextItem::draw_order m_draw_order;
+
+    /*!\var m_extra_state
+      Extra draw state passed to the ctor of each \ref WRATHTextItem.
+     */
+    WRATHTextItem::ExtraDrawState m_extra_state;
+
+    /*!\var m_stream_setup
+      If valid, called to set the state of
+      the \ref WRATHTextDataStream before the
+      text of each chunk is added.
+     */
+    stream_setup_type m_stream_setup;
+
+    /*!\var m_estimated_line_height
+      Initial estimate of the height of a line,
+      used for the extent of chunks not yet
+      formatted until a chunk is formatted.
+     */
+    float m_estimated_line_height;
+
+    /*!\var m_estimated_width
+      Estimate of the width of chunks not
+      yet formatted.
+     */
+    float m_estimated_width;
+
+    /*!\var m_chunk_size
+      Number of bytes of UTF8 text after which
+      the text is split into a new chunk at the
+      next line break.
+     */
+    int m_chunk_size;
+
+    /*!\var m_load_margin
+      Chunks whose extent comes within m_load_margin
+      of the view passed to update() are formatted.
+     */
+    float m_load_margin;
+
+    /*!\var m_release_margin
+      Formatted chunks whose extent is further than
+      m_release_margin from the view passed to update()
+      are released, should be atleast m_load_margin so that
+      chunks at the edge of the view are not formatted
+      and released on alternate frames.
+     */
+    float m_release_margin;
+  };
+
+  /*!\fn WRATHLayerTextDocumentBase
+    Ctor.
+    \param layer WRATHLayer where the \ref WRATHTextItem's are placed
+    \param fact factory passed to the ctor of each \ref WRATHTextItem,
+                a copy of fact is made
+    \param subdrawer_id sub-drawer ID passed to the ctor of each
+                        \ref WRATHTextItem
+    \param params parameters of the document
+   */
+  WRATHLayerTextDocumentBase(WRATHLayer *layer,
+                             const WRATHItemDrawerFactory &fact,
+                             int subdrawer_id,
+                             const parameters &params);
+
+  /*
+    the derived class must call clear_chunks()
+    in its dtor.
+   */
+  virtual
+  ~WRATHLayerTextDocumentBase();
+
+  /*!\fn void append_utf8(const char*, const char*)
+    Append UTF8 text to the document. The text
+    is only split into chunks, formatting is
+    done by update(). If the last chunk is formatted,
+    it is released so that it is formatted again
+    with the new text.
+    \param begin pointer to 1st byte of the UTF8 data
+    \param end pointer to one past the last byte of the UTF8 data
+   */
+  void
+  append_utf8(const char *begin, const char *end);
+
+  /*!\fn void append_utf8(const std::string&)
+    Equivalent to
+    \code
+    append_utf8(str.data(), str.data() + str.size());
+    \endcode
+    \param str UTF8 text to append
+   */
+  void
+  append_utf8(const std::string &str)
+  {
+    append_utf8(str.data(), str.data() + str.size());
+  }
+
+  /*!\fn int number_chunks
+    Returns the number of chunks the
+    text of the document is split into.
+   */
+  int
+  number_chunks(void) const
+  {
+    return m_chunks.size();
+  }
+
+  /*!\fn int number_loaded_chunks
+    Returns the number of chunks that are
+    currently formatted, i.e. that have a
+    \ref WRATHTextItem.
+   */
+  int
+  number_loaded_chunks(void) const
+  {
+    return m_loaded.size();
+  }
+
+  /*!\fn float estimated_line_height
+    Returns the current estimate of the height
+    of a line, refined as chunks are formatted.
+   */
+  float
+  estimated_line_height(void) const
+  {
+    return m_line_height;
+  }
+
+  /*!\fn const parameters& params
+    Returns the parameters as passed in the ctor.
+   */
+  const parameters&
+  params(void) const
+  {
+    return m_params;
+  }
+
+protected:
+
+  /*!\class chunk
+    A chunk of the text of the document.
+   */
+  class chunk:boost::noncopyable
+  {
+  public:
+    chunk(void):
+      m_lines(1),
+      m_offset(0.0f),
+      m_height(0.0f),
+      m_exact(false),
+      m_closed(false),
+      m_item(NULL),
+      m_node(NULL),
+      m_index_id(-1)
+    {}
+
+    std::string m_text;
+    int m_lines;
+
+    /*
+      offset along y from the parent node
+      and height, m_height is measured if
+      m_exact is true and estimated otherwise
+     */
+    float m_offset, m_height;
+    vecN<float, 2> m_x_range;
+    bool m_exact;
+
+    /*
+      true once a line break ended the
+      chunk, no more text is added to it
+     */
+    bool m_closed;
+
+    /*
+      text item and node of the chunk,
+      non-NULL only while the chunk is
+      formatted
+     */
+    WRATHTextItem *m_item;
+    WRATHLayerItemNodeBase *m_node;
+    int m_index_id;
+  };
+
+  /*!\fn void on_chunk_created(chunk*)
+    To be implemented by a derived class
+    to add a newly created chunk to its
+    spatial index, the box of the chunk
+    is chunk_box(c).
+    \param c chunk created
+   */
+  virtual
+  void
+  on_chunk_created(chunk *c)=0;
+
+  /*!\fn void on_chunk_box_change(chunk*)
+    To be implemented by a derived class
+    to update the box of a chunk in its
+    spatial index and, if the chunk is
+    formatted, the translation of its node.
+    \param c chunk whose offset or extent changed
+   */
+  virtual
+  void
+  on_chunk_box_change(chunk *c)=0;
+
+  /*!\fn void delete_node(chunk*)
+    To be implemented by a derived class
+    to delete (with WRATHPhasedDelete) the
+    node of a chunk that is released.
+    \param c chunk whose node, c->m_node, to delete
+   */
+  virtual
+  void
+  delete_node(chunk *c)=0;
+
+  /*!\fn BBox expand(const BBox&, float)
+    Returns a box grown by a margin
+    on each side, an empty box stays empty.
+    \param box box to expand
+    \param margin margin to add
+   */
+  static
+  BBox
+  expand(const BBox &box, float margin);
+
+  /*!\fn BBox chunk_box(chunk*) const
+    Returns the box of a chunk in the
+    coordinate system of the parent node.
+    \param c chunk to query
+   */
+  BBox
+  chunk_box(chunk *c) const;
+
+  /*!\fn void layout(void)
+    Sets the estimated heights and the offsets
+    of all chunks if text was added or a chunk
+    was formatted since the last call, calling
+    on_chunk_box_change() for each chunk whose
+    offset or height changes.
+   */
+  void
+  layout(void);
+
+  /*!\fn void format_chunk(chunk*)
+    Formats the text of a chunk into a new
+    \ref WRATHTextItem under c->m_node, which
+    the caller creates, and measures the extent
+    of the chunk the first time it is formatted.
+    \param c chunk to format, must not be formatted
+   */
+  void
+  format_chunk(chunk *c);
+
+  /*!\fn void release(chunk*)
+    Deletes the text item and, via delete_node(),
+    the node of a chunk if it is formatted.
+    \param c chunk to release
+   */
+  void
+  release(chunk *c);
+
+  /*!\fn void clear_chunks(void)
+    Releases and deletes all chunks.
+   */
+  void
+  clear_chunks(void);
+
+  /*!\var m_chunks
+    Chunks of the document in order.
+   */
+  std::vector<chunk*> m_chunks;
+
+  /*!\var m_loaded
+    Chunks currently formatted.
+   */
+  std::vector<chunk*> m_loaded;
+
+private:
+
+  chunk*
+  open_chunk(void);
+
+  WRATHLayer *m_layer;
+  WRATHItemDrawerFactory *m_factory;
+  int m_subdrawer_id;
+  parameters m_params;
+
+  WRATHTextDataStream m_stream;
+
+  float m_line_height, m_measured_height;
+  int m_measured_lines;
+  bool m_layout_dirty;
+  float m_direction;
+};
+
+/*!\class WRATHLayerTextDocument
+  A WRATHLayerTextDocument holds a (possibly very large)
+  document of UTF8 text that is formatted and packed
+  lazily. The text is split into chunks at line breaks,
+  each chunk holding roughly parameters::m_chunk_size
+  bytes of text. A chunk that is not near the view only
+  stores its raw UTF8 text and an estimate of its extent,
+  computed from its number of lines and an estimated line
+  height. When a chunk comes near the view, update() formats
+  the chunk, creates a \ref WRATHTextItem for it (under
+  its own child node of the parent node) and replaces the
+  estimated extent with the measured one. When a chunk
+  is far from the view, update() deletes the \ref WRATHTextItem
+  and node of the chunk, releasing its attribute and index
+  data, and keeps only its raw text and measured extent.
+  Thus opening a document of several megabytes only costs
+  splitting the text into chunks.
+
+  The estimated line height is refined from the measured
+  heights of the chunks as they are formatted, and the
+  chunks following a chunk whose height changes are moved
+  on the next call to update(). Each chunk is formatted
+  starting on a new line at \ref WRATHColumnFormatter::LayoutSpecification::m_start_position
+  of parameters::m_layout, so the layout of the document
+  matches formatting all the text at once for layouts where
+  lines advance along y, i.e. horizontal text. The line
+  break at which the text is split is not added to either
+  chunk; the leading EOL of the layout starts the next
+  chunk on its own line, thus parameters::m_layout should
+  have \ref WRATHColumnFormatter::LayoutSpecification::m_add_leading_eol
+  as true.
+
+  A WRATHLayerTextDocument is not thread safe and should
+  only be used from the simulation thread, the same thread
+  that modifies the nodes.
+
+  \tparam N node type, must provide a ctor taking a
+            parent node N*, translation(const vec2&),
+            visible(bool) and those requirements of
+            \ref WRATHLayerItemNodeSpatialIndex, for example
+            \ref WRATHLayerItemNodeTranslate and
+            \ref WRATHLayerItemNodeRotateTranslate
+ */
+template<typename N>
+class WRATHLayerTextDocument:public WRATHLayerTextDocumentBase
+{
+public:
+  /*!\fn WRATHLayerTextDocument
+    Ctor.
+    \param parent_node node under which the nodes of the
+                       chunks are created, the extents of the
+                       chunks are in the coordinate system of
+                       parent_node, which must stay alive for
+                       the lifetime of the WRATHLayerTextDocument
+    \param layer WRATHLayer where the \ref WRATHTextItem's are placed
+    \param fact factory passed to the ctor of each \ref WRATHTextItem,
+                a copy of fact is made
+    \param subdrawer_id sub-drawer ID passed to the ctor of each
+                        \ref WRATHTextItem
+    \param params parameters of the document
+   */
+  WRATHLayerTextDocument(N *parent_node, WRATHLayer *layer,
+                         const WRATHItemDrawerFactory &fact,
+                         int subdrawer_id,
+                         const parameters &params=parameters()):
+    WRATHLayerTextDocumentBase(layer, fact, subdrawer_id, params),
+    m_parent_node(parent_node),
+    m_index(parent_node)
+  {
+    WRATHassert(m_parent_node!=NULL);
+  }
+
+  ~WRATHLayerTextDocument()
+  {
+    clear();
+  }
+
+  /*!\fn void clear
+    Remove all text of the document, the text items
+    and nodes of formatted chunks are deleted.
+   */
+  void
+  clear(void)
+  {
+    clear_chunks();
+    m_index.clear();
+  }
+
+  /*!\fn void update
+    Format those chunks near a rectangle, release
+    those chunks far from the rectangle and set
+    the formatted chunks visible if and only if
+    their extent intersects the rectangle. Typically
+    called each frame with the visible region.
+    \param view rectangle in the coordinate system of the
+                global values of the parent node, i.e.
+                the same coordinate system as the rectangles
+                passed to \ref WRATHLayerItemNodeSpatialIndex::query()
+   */
+  void
+  update(const BBox &view)
+  {
+    BBox local_view, local_release;
+
+    layout();
+
+    m_query.clear();
+    m_index.query(expand(view, params().m_load_margin), m_query);
+    for(typename std::vector<chunk*>::iterator iter=m_query.begin(),
+          end=m_query.end(); iter!=end; ++iter)
+      {
+        load(*iter);
+      }
+
+    /*
+      formatting gives the exact heights of
+      the chunks, move the following chunks
+      before placing the nodes
+     */
+    layout();
+
+    local_view=m_index.local_box(view);
+    local_release=m_index.local_box(expand(view, params().m_release_margin));
+    for(unsigned int i=0; i<m_loaded.size(); )
+      {
+        chunk *c(m_loaded[i]);
+        BBox box(m_index.bbox(c->m_index_id));
+
+        if(!box.intersects(local_release))
+          {
+            release(c);
+          }
+        else
+          {
+            node(c)->visible(box.intersects(local_view));
+            ++i;
+          }
+      }
+  }
+
+  /*!\fn BBox bounding_box
+    Returns the bounding box of the document in the
+    coordinate system of the parent node, formed from
+    the measured extents of formatted chunks and the
+    estimated extents of those chunks never formatted.
+   */
+  BBox
+  bounding_box(void)
+  {
+    BBox return_value;
+
+    layout();
+    for(typename std::vector<chunk*>::const_iterator iter=m_chunks.begin(),
+          end=m_chunks.end(); iter!=end; ++iter)
+      {
+        return_value.set_or(m_index.bbox((*iter)->m_index_id));
+      }
+    return return_value;
+  }
+
+  /*!\fn N* parent_node
+    Returns the parent node as passed in the ctor.
+   */
+  N*
+  parent_node(void) const
+  {
+    return m_parent_node;
+  }
+
+protected:
+
+  virtual
+  void
+  on_chunk_created(chunk *c)
+  {
+    c->m_index_id=m_index.add(c, chunk_box(c));
+  }
+
+  virtual
+  void
+  on_chunk_box_change(chunk *c)
+  {
+    m_index.bbox(c->m_index_id, chunk_box(c));
+    if(c->m_node!=NULL)
+      {
+        node(c)->translation(vec2(0.0f, c->m_offset));
+      }
+  }
+
+  virtual
+  void
+  delete_node(chunk *c)
+  {
+    WRATHPhasedDelete(node(c));
+  }
+
+private:
+
+  static
+  N*
+  node(chunk *c)
+  {
+    return static_cast<N*>(c->m_node);
+  }
+
+  void
+  load(chunk *c)
+  {
+    N *n;
+
+    if(c->m_item!=NULL)
+      {
+        return;
+      }
+
+    n=WRATHNew N(m_parent_node);
+    n->translation(vec2(0.0f, c->m_offset));
+    c->m_node=n;
+    format_chunk(c);
+  }
+
+  N *m_parent_node;
+  WRATHLayerItemNodeSpatialIndex<N, chunk> m_index;
+  std::vector<chunk*> m_query;
+};
+
+/*! @} */
+
+#endif
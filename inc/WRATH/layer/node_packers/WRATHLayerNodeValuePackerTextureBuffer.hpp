@@ -0,0 +1,116 @@
+/*! 
+ * \file WRATHLayerNodeValuePackerTextureBuffer.hpp
+ * \brief file WRATHLayerNodeValuePackerTextureBuffer.hpp
+ * 
+ * Copyright 2013 by Nomovok Ltd.
+ * 
+ * Contact: info@nomovok.com
+ * 
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ * 
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ * 
+ */
+
+
+#ifndef WRATH_HEADER_LAYER_ITEM_UNIFORM_PACKER_TEXTURE_BUFFER_HPP_
+#define WRATH_HEADER_LAYER_ITEM_UNIFORM_PACKER_TEXTURE_BUFFER_HPP_
+
+#include "WRATHConfig.hpp"
+#include "WRATHLayerNodeValuePackerBase.hpp"
+
+#if defined(WRATH_GL_VERSION)
+
+/*! \addtogroup Layer
+ * @{
+ */
+
+/*!\class WRATHLayerNodeValuePackerTextureBuffer
+  An implementation of WRATHLayerNodeValuePackerBase
+  using a texture buffer object (an fp32 RGBA buffer
+  texture) to pack the per node value data. The values
+  are available from both the vertex and fragment shaders.
+  The packing is the same as \ref WRATHLayerNodeValuePackerUniformArrays,
+  i.e. one texel holds 4 values and the values of a node
+  start at a new texel. The size of a buffer texture
+  is only limited by GL_MAX_TEXTURE_BUFFER_SIZE (atleast
+  65536 texels), so many more nodes fit in one draw call
+  than with uniforms. Each time the texture is bound for
+  drawing, only the range of the data that changed since
+  the last upload is sent to GL.
+
+  Only available for GL (not GLES), requires GL 3.1
+  or the extensions GL_ARB_texture_buffer_object and
+  GL_EXT_gpu_shader4.
+ */
+class WRATHLayerNodeValuePackerTextureBuffer:public WRATHLayerNodeValuePackerBase
+{
+public:
+  /*!\fn WRATHLayerNodeValuePackerTextureBuffer
+    Ctor
+    \param layer passed to ctor of \ref WRATHLayerNodeValuePackerBase
+    \param payload passed to ctor of \ref WRATHLayerNodeValuePackerBase
+    \param spec passed to ctor of \ref WRATHLayerNodeValuePackerBase
+   */
+  WRATHLayerNodeValuePackerTextureBuffer(WRATHLayerBase *layer,
+                                         const SpecDataProcessedPayload::const_handle &payload,
+                                         const ProcessedActiveNodeValuesCollection &spec);
+
+  virtual
+  ~WRATHLayerNodeValuePackerTextureBuffer();
+
+  /*!\fn unsigned int number_slots(void)
+    Returns the number of nodes per draw call that
+    WRATHLayerNodeValuePackerTextureBuffer objects
+    support. The memory used by each
+    WRATHLayerNodeValuePackerTextureBuffer is
+    proportional to this value. Only change the value
+    before any WRATHBaseItem or WRATHLayerBase derived
+    objects are created to avoid inconsistent results.
+    Default value is 2048.
+   */
+  static
+  unsigned int
+  number_slots(void);
+
+  /*!\fn void number_slots(unsigned int)
+    Sets the number of nodes per draw call that
+    WRATHLayerNodeValuePackerTextureBuffer objects
+    support, see number_slots(void). The value is
+    clamped to 65535.
+   */
+  static
+  void
+  number_slots(unsigned int v);
+
+  virtual
+  void
+  append_state(WRATHSubItemDrawState &skey);
+
+  /*!\fn const WRATHLayerNodeValuePackerBase::function_packet& functions()
+    function packet to be used that uses WRATHLayerNodeValuePackerTextureBuffer
+    to pack node values.
+   */
+  static
+  const WRATHLayerNodeValuePackerBase::function_packet&
+  functions(void);
+
+protected:
+
+  virtual
+  void
+  phase_render_deletion(void);
+
+private:
+  WRATHTextureChoice::texture_base::handle m_texture;
+};
+
+/*! @} */
+
+#endif
+
+#endif
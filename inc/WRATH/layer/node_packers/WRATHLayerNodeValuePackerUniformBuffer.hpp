@@ -0,0 +1,118 @@
+/*! 
+ * \file WRATHLayerNodeValuePackerUniformBuffer.hpp
+ * \brief file WRATHLayerNodeValuePackerUniformBuffer.hpp
+ * 
+ * Copyright 2013 by Nomovok Ltd.
+ * 
+ * Contact: info@nomovok.com
+ * 
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ * 
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ * 
+ */
+
+
+#ifndef WRATH_HEADER_LAYER_ITEM_UNIFORM_PACKER_UNIFORM_BUFFER_HPP_
+#define WRATH_HEADER_LAYER_ITEM_UNIFORM_PACKER_UNIFORM_BUFFER_HPP_
+
+#include "WRATHConfig.hpp"
+#include "WRATHLayerNodeValuePackerBase.hpp"
+
+#if defined(WRATH_GL_VERSION) || WRATH_GLES_VERSION>=3
+
+/*! \addtogroup Layer
+ * @{
+ */
+
+/*!\class WRATHLayerNodeValuePackerUniformBuffer
+  An implementation of WRATHLayerNodeValuePackerBase
+  using a uniform buffer object (i.e. a std140 uniform
+  block of an array of vec4's) to pack the per node
+  value data. The values are available from both
+  the vertex and fragment shaders. The packing is
+  the same as \ref WRATHLayerNodeValuePackerUniformArrays,
+  but a uniform block can be much larger than the
+  room for an array of uniforms, so many more nodes
+  fit in one draw call. Each time the buffer object
+  is bound for drawing, only the range of the data
+  that changed since the last upload is sent to GL.
+
+  Requires GLES3 or GL with GL_ARB_uniform_buffer_object.
+ */
+class WRATHLayerNodeValuePackerUniformBuffer:public WRATHLayerNodeValuePackerBase
+{
+public:
+  /*!\fn WRATHLayerNodeValuePackerUniformBuffer
+    Ctor
+    \param layer passed to ctor of \ref WRATHLayerNodeValuePackerBase
+    \param payload passed to ctor of \ref WRATHLayerNodeValuePackerBase
+    \param spec passed to ctor of \ref WRATHLayerNodeValuePackerBase
+   */
+  WRATHLayerNodeValuePackerUniformBuffer(WRATHLayerBase *layer,
+                                         const SpecDataProcessedPayload::const_handle &payload,
+                                         const ProcessedActiveNodeValuesCollection &spec);
+
+  virtual
+  ~WRATHLayerNodeValuePackerUniformBuffer();
+
+  /*!\fn unsigned int size_of_vec4_block(void)
+    Returns the number of vec4's of the uniform
+    block that WRATHLayerNodeValuePackerUniformBuffer
+    objects use to pack the per-node values. The number
+    of nodes of a type N supported by a
+    WRATHLayerNodeValuePackerUniformBuffer is given by
+    (4*size_of_vec4_block())/K where K is the number of
+    values per node rounded up to a multiple of 4.
+    Only change the value before any WRATHBaseItem
+    or WRATHLayerBase derived objects are created to
+    avoid inconsistent results. Default value is 1024,
+    i.e. 16KB, the minimum value GL guarantees for
+    GL_MAX_UNIFORM_BLOCK_SIZE.
+   */
+  static
+  unsigned int
+  size_of_vec4_block(void);
+
+  /*!\fn void size_of_vec4_block(unsigned int)
+    Sets the number of vec4's of the uniform block that
+    WRATHLayerNodeValuePackerUniformBuffer objects use
+    to pack the per-node values, see size_of_vec4_block(void).
+    The value times 16 must not exceed the value of
+    GL_MAX_UNIFORM_BLOCK_SIZE.
+   */
+  static
+  void
+  size_of_vec4_block(unsigned int v);
+
+  virtual
+  void
+  append_state(WRATHSubItemDrawState &skey);
+
+  /*!\fn const WRATHLayerNodeValuePackerBase::function_packet& functions()
+    function packet to be used that uses WRATHLayerNodeValuePackerUniformBuffer
+    to pack node values.
+   */
+  static
+  const WRATHLayerNodeValuePackerBase::function_packet&
+  functions(void);
+
+protected:
+
+  virtual
+  void
+  phase_render_deletion(void);
+
+private:
+  WRATHUniformData::uniform_setter_base::handle m_buffer;
+};
+
+/*! @} */
+
+#endif
+
+#endif
@@ -178,20 +178,30 @@ namespace WRATHDefaultFillShapeAttributePacker
     \param fill_params provides a translation and fill rule used                   
                        filling the WRATHShape<T> that was used
                        to create payload
+    \param fmt attribute format with which to pack, must match
+               the format passed to attribute_key()
    */
   void
   set_attribute_data(WRATHShapeTriangulatorPayload::handle payload,
                      WRATHAbstractDataSink &attribute_store,
                      const std::vector<range_type<int> > &attr_location,
                      WRATHAbstractDataSink *index_group,
-                     const FillingParameters &fill_params);
+                     const FillingParameters &fill_params,
+                     enum WRATHAttributePacker::attribute_format_type fmt
+                     =WRATHAttributePacker::full_precision_format);
 
-  /*!\fn GLenum attribute_key(WRATHAttributeStoreKey&)  
+  /*!\fn GLenum attribute_key(WRATHAttributeStoreKey&, enum WRATHAttributePacker::attribute_format_type)  
     Attribute key for the packing of a filled shape.
+    With WRATHAttributePacker::half_precision_format
+    the position is packed as 16-bit floats, which
+    represent integer coordinates exactly only up to 2048.
     \param attrib_key key to which to write
+    \param fmt attribute format with which to pack
    */
   GLenum
-  attribute_key(WRATHAttributeStoreKey &attrib_key);
+  attribute_key(WRATHAttributeStoreKey &attrib_key,
+                enum WRATHAttributePacker::attribute_format_type fmt
+                =WRATHAttributePacker::full_precision_format);
 
   /*!\fn const_c_array<const char*> attribute_names 
     Returns the attribute names as a const_c_array<>.
@@ -212,14 +222,19 @@ class WRATHDefaultFillShapeAttributePackerT:public WRATHShapeAttributePacker<T>
 public:
 
   /*!\fn WRATHShapeAttributePacker<T>* fetch
-    For each type T, onle one WRATHDefaultFillShapeAttributePackerT<T> object
+    For each type T and each attribute format, only one 
+    WRATHDefaultFillShapeAttributePackerT<T> object
     exists, use fetch() to get that object.
+    \param fmt attribute format of the packer to fetch, see
+               WRATHDefaultFillShapeAttributePacker::attribute_key()
    */
   static
   WRATHShapeAttributePacker<T>*
-  fetch(void)
+  fetch(enum WRATHAttributePacker::attribute_format_type fmt
+        =WRATHAttributePacker::full_precision_format)
   {
-    return WRATHAttributePacker::fetch_make<WRATHDefaultFillShapeAttributePackerT>(Factory());
+    return WRATHAttributePacker::fetch_make<WRATHDefaultFillShapeAttributePackerT>(resource_label(fmt),
+                                                                                    Factory(fmt));
   }
 
   virtual
@@ -261,7 +276,7 @@ public:
   GLenum
   attribute_key(WRATHAttributeStoreKey &attrib_key) const
   {
-    return WRATHDefaultFillShapeAttributePacker::attribute_key(attrib_key);
+    return WRATHDefaultFillShapeAttributePacker::attribute_key(attrib_key, m_format);
   }
 
 protected:
@@ -297,7 +312,7 @@ protected:
    
     WRATHDefaultFillShapeAttributePacker::set_attribute_data(h, attribute_store, 
                                                              attr_location, primary_index_group,
-                                                             *pptr);
+                                                             *pptr, m_format);
   }
 
 private:
@@ -305,22 +320,45 @@ private:
   class Factory:public WRATHAttributePacker::AttributePackerFactory
   {
   public:
+    explicit
+    Factory(enum WRATHAttributePacker::attribute_format_type fmt):
+      m_format(fmt)
+    {}
+
     virtual
     WRATHAttributePacker*
     create(void) const 
     {
-      return WRATHNew WRATHDefaultFillShapeAttributePackerT();
+      return WRATHNew WRATHDefaultFillShapeAttributePackerT(m_format);
     }
 
+  private:
+    enum WRATHAttributePacker::attribute_format_type m_format;
   };
 
+  static
+  std::string
+  resource_label(enum WRATHAttributePacker::attribute_format_type fmt)
+  {
+    std::string R(typeid(WRATHDefaultFillShapeAttributePackerT).name());
+
+    if(fmt==WRATHAttributePacker::half_precision_format)
+      {
+        R+="-half";
+      }
+    return R;
+  }
+
   explicit
-  WRATHDefaultFillShapeAttributePackerT(void):
-    WRATHShapeAttributePacker<T>(typeid(WRATHDefaultFillShapeAttributePackerT).name(), 
+  WRATHDefaultFillShapeAttributePackerT(enum WRATHAttributePacker::attribute_format_type fmt):
+    WRATHShapeAttributePacker<T>(resource_label(fmt), 
                                  WRATHDefaultFillShapeAttributePacker::attribute_names().begin(), 
-                                 WRATHDefaultFillShapeAttributePacker::attribute_names().end())
+                                 WRATHDefaultFillShapeAttributePacker::attribute_names().end()),
+    m_format(fmt)
   {}
 
+  enum WRATHAttributePacker::attribute_format_type m_format;
+
 };
 
 /*!\typedef WRATHDefaultFillShapeAttributePackerF
@@ -24,6 +24,7 @@
 
 #include "WRATHConfig.hpp"
 #include <vector>
+#include <stdint.h>
 #include <boost/utility.hpp>
 #include "vecN.hpp"
 #include "vectorGL.hpp"
@@ -735,6 +736,69 @@ public:
     return stream;
   }
 
+  /*!\fn enum return_code content_hash(uint64_t&) const
+    Computes a hash value (64-bit FNV-1a) of 
+    the positions and interpolators of the
+    points of this WRATHOutline. Payloads of 
+    a WRATHShape use the hash to reuse the
+    processing of an outline whose contents 
+    did not change. Note that the hash also
+    reflects changes made directly to
+    \ref BezierInterpolator::m_control_points
+    and to the fields of \ref ArcInterpolator. 
+    The curve of a \ref GenericInterpolator 
+    cannot be hashed, as such if any point
+    uses a \ref GenericInterpolator, returns
+    routine_fail and the value written to
+    out_hash is not to be used. Otherwise
+    returns routine_success.
+    \param out_hash location to which to write the hash
+   */
+  enum return_code
+  content_hash(uint64_t &out_hash) const
+  {
+    uint32_t sz(m_points.size());
+
+    out_hash=14695981039346656037ULL;
+    add_to_hash(out_hash, &sz, sizeof(sz));
+
+    for(typename std::vector<point>::const_iterator
+          iter=m_points.begin(), end=m_points.end(); iter!=end; ++iter)
+      {
+        const BezierInterpolator *bez;
+        const ArcInterpolator *arc;
+        uint32_t tag;
+
+        add_to_hash(out_hash, &iter->m_position, sizeof(position_type));
+
+        bez=dynamic_cast<const BezierInterpolator*>(iter->m_interpolator);
+        arc=dynamic_cast<const ArcInterpolator*>(iter->m_interpolator);
+        if(bez!=NULL)
+          {
+            tag=bez->m_control_points.size();
+            add_to_hash(out_hash, &tag, sizeof(tag));
+            if(!bez->m_control_points.empty())
+              {
+                add_to_hash(out_hash, &bez->m_control_points[0],
+                            sizeof(position_type)*bez->m_control_points.size());
+              }
+          }
+        else if(arc!=NULL)
+          {
+            tag=~uint32_t(0);
+            add_to_hash(out_hash, &tag, sizeof(tag));
+            add_to_hash(out_hash, &arc->m_angle, sizeof(arc->m_angle));
+            tag=arc->m_counter_clockwise?1:0;
+            add_to_hash(out_hash, &tag, sizeof(tag));
+          }
+        else if(iter->m_interpolator!=NULL)
+          {
+            return routine_fail;
+          }
+      }
+    return routine_success;
+  }
+
 protected:
 
   /*!\fn on_change
@@ -749,6 +813,18 @@ protected:
 
 private:
 
+  static
+  void
+  add_to_hash(uint64_t &hash, const void *data, unsigned int number_bytes)
+  {
+    const uint8_t *ptr(static_cast<const uint8_t*>(data));
+
+    for(unsigned int i=0; i<number_bytes; ++i)
+      {
+        hash^=ptr[i];
+        hash*=1099511628211ULL;
+      }
+  }
 
   unsigned int m_ID;
   std::vector<point> m_points;
@@ -298,6 +298,33 @@ public:
     return this->fetch_payload_implement(type_tag<P>(), params, false);
   }
 
+  /*!\fn P::handle fetch_previous_payload
+    Returns the payload of type P that this 
+    WRATHShape held before the last change to
+    the WRATHShape, provided that a payload of 
+    type P has not been generated since then.
+    If there is no such payload, returns an
+    invalid handle. The use case is for a 
+    payload type to reuse the processing 
+    of those outlines that did not change
+    (see \ref WRATHOutline::content_hash()) 
+    when generating a new payload.
+   */
+  template<typename P>
+  typename P::handle
+  fetch_previous_payload(void) const
+  {
+    payload_iterator iter;
+    typename P::handle H;
+
+    iter=m_previous_payloads.find(typeid(P));
+    if(iter!=m_previous_payloads.end())
+      {
+        H=iter->second->get_handle(type_tag<P>());
+      }
+    return H;
+  }
+
   /*!\fn const std::string& label(void) const
     Returns the label of the WRATHShape,
     the label of a WRATHShape is a user
@@ -499,6 +526,13 @@ private:
     V=WRATHNew payload_hoard_entry<P>(params, H);
     m_payloads.insert( payload_entry(typeid(P), V) );
 
+    /*
+      the previous payload of type P is
+      no longer needed once a new one 
+      is generated.
+     */
+    m_previous_payloads.erase(typeid(P));
+
     return H;
 
   }
@@ -514,6 +548,17 @@ private:
   void
   mark_dirty(void)
   {
+    /*
+      retain the payloads so that the
+      generation of the next payload can
+      reuse the processing of outlines
+      that did not change.
+     */
+    for(payload_iterator iter=m_payloads.begin(), 
+          end=m_payloads.end(); iter!=end; ++iter)
+      {
+        m_previous_payloads[iter->first]=iter->second;
+      }
     m_payloads.clear();
   }
 
@@ -524,6 +569,12 @@ private:
     keyed by payload type, values as (params, handles)
    */
   mutable payload_hoard m_payloads;
+
+  /*
+    payloads from before the last call to mark_dirty()
+    whose payload type has not been generated since.
+   */
+  mutable payload_hoard m_previous_payloads;
 };
 
 
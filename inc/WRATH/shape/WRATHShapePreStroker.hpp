@@ -515,13 +515,20 @@ public:
     the tessellation of a WRATHShape<T> held in a
     WRATHShapeSimpleTessellatorPayload.
     \param ph tessellation of a WRATHShape<T>
+    \param previous if valid, a WRATHShapePreStrokerPayload
+                    of an earlier version of the same WRATHShape<T>,
+                    the data of those outlines whose tessellation
+                    is shared between ph and the tessellation of
+                    previous is copied from previous instead
+                    of being regenerated
   */
   explicit
-  WRATHShapePreStrokerPayload(const WRATHShapeSimpleTessellatorPayload::handle &ph):
+  WRATHShapePreStrokerPayload(const WRATHShapeSimpleTessellatorPayload::handle &ph,
+                              const handle &previous=handle()):
     m_flags(generate_all),
     m_h(ph)
   {
-    generate_data();
+    generate_data(previous);
   }
 
   /*!\fn WRATHShapePreStrokerPayload(uint32_t, const WRATHShapeSimpleTessellatorPayload::handle&)
@@ -532,13 +539,20 @@ public:
     \param pflags bit-flags indicating what types of joins
                   and caps to generate. 
     \param ph tessellation of a WRATHShape<T>
+    \param previous if valid, a WRATHShapePreStrokerPayload
+                    of an earlier version of the same WRATHShape<T>,
+                    the data of those outlines whose tessellation
+                    is shared between ph and the tessellation of
+                    previous is copied from previous instead
+                    of being regenerated
   */
   WRATHShapePreStrokerPayload(uint32_t pflags,
-                              const WRATHShapeSimpleTessellatorPayload::handle &ph):
+                              const WRATHShapeSimpleTessellatorPayload::handle &ph,
+                              const handle &previous=handle()):
     m_flags(pflags&generate_all),
     m_h(ph)
   {
-    generate_data();
+    generate_data(previous);
   }
   
   /*!\fn uint32_t flags
@@ -584,7 +598,7 @@ public:
   const_c_array<CapPoint>
   square_cap_pts(void) const
   {
-    return m_square_caps.m_pts;
+    return m_data.m_square_caps.m_pts;
   }
 
   /*!\fn const_c_array<GLushort> square_cap_indices
@@ -597,7 +611,7 @@ public:
   const_c_array<GLushort>
   square_cap_indices(void) const
   {
-    return m_square_caps.m_indices;
+    return m_data.m_square_caps.m_indices;
   }
   
   /*!\fn const_c_array<CapPoint> rounded_cap_pts
@@ -609,7 +623,7 @@ public:
   const_c_array<CapPoint>
   rounded_cap_pts(void) const
   {
-    return m_rounded_caps.m_pts;
+    return m_data.m_rounded_caps.m_pts;
   }
 
   /*!\fn const_c_array<GLushort> rounded_cap_indices
@@ -622,7 +636,7 @@ public:
   const_c_array<GLushort>
   rounded_cap_indices(void) const
   {
-    return m_rounded_caps.m_indices;
+    return m_data.m_rounded_caps.m_indices;
   }
   
   /*!\fn const_c_array<MiterJoinPoint> all_miter_join_pts
@@ -634,7 +648,7 @@ public:
   const_c_array<MiterJoinPoint>
   all_miter_join_pts(void) const
   {
-    return m_miter_joins.all_pts();
+    return m_data.m_miter_joins.all_pts();
   }
 
   /*!\fn const_c_array<MiterJoinPoint> core_miter_join_pts
@@ -649,7 +663,7 @@ public:
   const_c_array<MiterJoinPoint>
   core_miter_join_pts(void) const
   {
-    return m_miter_joins.pts_up_to_marker();
+    return m_data.m_miter_joins.pts_up_to_marker();
   }
 
   /*!\fn const_c_array<MiterJoinPoint> miter_join_pts
@@ -661,7 +675,7 @@ public:
   const_c_array<MiterJoinPoint>
   miter_join_pts(bool all_joins) const
   {
-    return m_miter_joins.pts(all_joins);
+    return m_data.m_miter_joins.pts(all_joins);
   }
 
   /*!\fn const_c_array<GLushort> all_miter_join_indices
@@ -674,7 +688,7 @@ public:
   const_c_array<GLushort>
   all_miter_join_indices(void) const
   {
-    return m_miter_joins.all_indices();
+    return m_data.m_miter_joins.all_indices();
   }
 
   /*!\fn const_c_array<GLushort> core_miter_join_indices
@@ -691,7 +705,7 @@ public:
   const_c_array<GLushort>
   core_miter_join_indices(void) const
   {
-    return m_miter_joins.ind_up_to_marker();
+    return m_data.m_miter_joins.ind_up_to_marker();
   }
 
   /*!\fn const_c_array<GLushort> miter_join_indices
@@ -703,7 +717,7 @@ public:
   const_c_array<GLushort>
   miter_join_indices(bool all_joins) const
   {
-    return m_miter_joins.inds(all_joins);
+    return m_data.m_miter_joins.inds(all_joins);
   }
 
   /*!\fn const_c_array<JoinPoint> all_bevel_join_pts
@@ -715,7 +729,7 @@ public:
   const_c_array<JoinPoint>
   all_bevel_join_pts(void) const
   {
-    return m_bevel_joins.all_pts();
+    return m_data.m_bevel_joins.all_pts();
   }
 
   /*!\fn const_c_array<JoinPoint> core_bevel_join_pts
@@ -730,7 +744,7 @@ public:
   const_c_array<JoinPoint>
   core_bevel_join_pts(void) const
   {
-    return m_bevel_joins.pts_up_to_marker();
+    return m_data.m_bevel_joins.pts_up_to_marker();
   }
 
   /*!\fn const_c_array<JoinPoint> bevel_join_pts
@@ -742,7 +756,7 @@ public:
   const_c_array<JoinPoint>
   bevel_join_pts(bool all_joins) const
   {
-    return m_bevel_joins.pts(all_joins);
+    return m_data.m_bevel_joins.pts(all_joins);
   }
 
   /*!\fn const_c_array<GLushort> all_bevel_join_indices 
@@ -755,7 +769,7 @@ public:
   const_c_array<GLushort>
   all_bevel_join_indices(void) const
   {
-    return m_bevel_joins.all_indices();
+    return m_data.m_bevel_joins.all_indices();
   }
   
   /*!\fn const_c_array<GLushort> core_bevel_join_indices
@@ -772,7 +786,7 @@ public:
   const_c_array<GLushort>
   core_bevel_join_indices(void) const
   {
-    return m_bevel_joins.ind_up_to_marker();
+    return m_data.m_bevel_joins.ind_up_to_marker();
   }
 
   /*!\fn const_c_array<GLushort> bevel_join_indices  
@@ -784,7 +798,7 @@ public:
   const_c_array<GLushort>
   bevel_join_indices(bool all_joins) const
   {
-    return m_bevel_joins.inds(all_joins);
+    return m_data.m_bevel_joins.inds(all_joins);
   }
 
   /*!\fn const_c_array<JoinPoint> all_rounded_join_pts
@@ -796,7 +810,7 @@ public:
   const_c_array<JoinPoint>
   all_rounded_join_pts(void) const
   {
-    return m_rounded_joins.all_pts();
+    return m_data.m_rounded_joins.all_pts();
   }
 
   /*!\fn const_c_array<JoinPoint> core_rounded_join_pts
@@ -811,7 +825,7 @@ public:
   const_c_array<JoinPoint>
   core_rounded_join_pts(void) const
   {
-    return m_rounded_joins.pts_up_to_marker();
+    return m_data.m_rounded_joins.pts_up_to_marker();
   }
 
   /*!\fn const_c_array<JoinPoint> rounded_join_pts 
@@ -823,7 +837,7 @@ public:
   const_c_array<JoinPoint>
   rounded_join_pts(bool all_joins) const
   {
-    return m_rounded_joins.pts(all_joins);
+    return m_data.m_rounded_joins.pts(all_joins);
   }
 
   /*!\fn const_c_array<GLushort> all_rounded_join_indices 
@@ -836,7 +850,7 @@ public:
   const_c_array<GLushort>
   all_rounded_join_indices(void) const
   {
-    return m_rounded_joins.all_indices();
+    return m_data.m_rounded_joins.all_indices();
   }
 
   /*!\fn const_c_array<GLushort> core_rounded_join_indices
@@ -853,7 +867,7 @@ public:
   const_c_array<GLushort>
   core_rounded_join_indices(void) const
   {
-    return m_rounded_joins.ind_up_to_marker();
+    return m_data.m_rounded_joins.ind_up_to_marker();
   }
 
   /*!\fn const_c_array<GLushort> rounded_join_indices
@@ -865,7 +879,7 @@ public:
   const_c_array<GLushort>
   rounded_join_indices(bool all_joins) const
   {
-    return m_rounded_joins.inds(all_joins);
+    return m_data.m_rounded_joins.inds(all_joins);
   }
 
   /*!\fn handle generate_payload(const WRATHShape<T>&, const PayloadParams&)
@@ -876,6 +890,11 @@ public:
     then routine will trigger the WRATHShape object to
     store and generate a new WRATHShapeSimpleTessellatorPayload
     object created using the tessellation parameters specified.
+    The join and cap data of those outlines whose tessellation
+    is unchanged since the previous WRATHShapePreStrokerPayload
+    of the WRATHShape (see \ref WRATHShape::fetch_previous_payload())
+    is reused, the data of the other outlines is generated
+    in parallel with WRATHParallelFor.
  
     \param pshape WRATHShape from which to generate payload
     \param pp payload parameters specifying tessellation parameters
@@ -890,7 +909,8 @@ public:
     WRATHShapeSimpleTessellatorPayload::handle tess;
 
     tess=pshape.template fetch_matching_payload<WRATHShapeSimpleTessellatorPayload>(pp.m_tess_params);
-    return WRATHNew WRATHShapePreStrokerPayload(pp.m_flags, tess);
+    return WRATHNew WRATHShapePreStrokerPayload(pp.m_flags, tess, 
+                                                pshape.template fetch_previous_payload<WRATHShapePreStrokerPayload>());
   }
 
   /*!\fn handle generate_payload(const WRATHShape<T>&)
@@ -899,7 +919,9 @@ public:
     Will use any pre-existing WRATHShapeSimpleTessellatorPayload
     stored in the WRATHShape object and will generate a
     WRATHShapePreStrokerPayload object holding data for
-    stroking all cap and join types.
+    stroking all cap and join types. As with the other
+    overload, the data of unchanged outlines is reused
+    from the previous WRATHShapePreStrokerPayload.
     \param pshape WRATHShape from which to generate the payload
    */
   template<typename T>
@@ -910,7 +932,8 @@ public:
     WRATHShapeSimpleTessellatorPayload::handle tess;
 
     tess=pshape.template fetch_payload<WRATHShapeSimpleTessellatorPayload>();
-    return WRATHNew WRATHShapePreStrokerPayload(tess); 
+    return WRATHNew WRATHShapePreStrokerPayload(tess,
+                                                pshape.template fetch_previous_payload<WRATHShapePreStrokerPayload>()); 
   }
 
 
@@ -987,29 +1010,87 @@ private:
     }
   };
 
+  class PacketSet
+  {
+  public:
+    DataPacket<CapPoint> m_square_caps, m_rounded_caps;
+    DataPacketWithMarkers<MiterJoinPoint> m_miter_joins;
+    DataPacketWithMarkers<JoinPoint> m_bevel_joins, m_rounded_joins;
+  };
+
+  class PacketRange
+  {
+  public:
+    range_type<unsigned int> m_pts, m_indices;
+  };
+
+  /*
+    Location of the data of one outline within
+    a PacketSet. For joins, [0] holds the joins
+    within the outline and [1] holds the joins 
+    made when the outline is closed.
+   */
+  class OutlineLocation
+  {
+  public:
+    PacketRange m_square_caps, m_rounded_caps;
+    vecN<PacketRange, 2> m_miter_joins, m_bevel_joins, m_rounded_joins;
+  };
+
+  /*
+    WRATHParallelFor::Job generating the 
+    PacketSet of several outlines
+   */
+  class GenerateOutlineJob;
+  friend class GenerateOutlineJob;
+
+  void
+  generate_data(const handle &previous);
+
   void
-  generate_data(void);
+  generate_outline(const Outline::handle &O, PacketSet &out) const;
 
   void
-  handle_outline(const Outline::handle &O);
+  handle_outline(const Outline::handle &O, PacketSet &out) const;
 
   void
   handle_cap(const Outline::handle &O,
              const CurvePoint &pt,
-             bool is_starting_cap);
+             bool is_starting_cap,
+             PacketSet &out) const;
 
 
   void
   handle_join(const Outline::handle &O,
               const Edge::handle &pre,
-              const Edge::handle &post);
+              const Edge::handle &post,
+              PacketSet &out) const;
+
+  void
+  append_outline(int pass, 
+                 const PacketSet &src, const OutlineLocation &src_location,
+                 OutlineLocation &dst_location);
+
+  static
+  OutlineLocation
+  local_location(const PacketSet &src);
+
+  template<typename P>
+  static
+  void
+  append_slice(const P &src, const PacketRange &src_range,
+               P &dst, PacketRange &dst_range);
 
   int m_flags;
   float m_effective_curve_thresh;
   WRATHShapeSimpleTessellatorPayload::handle m_h;
-  DataPacket<CapPoint> m_square_caps, m_rounded_caps;
-  DataPacketWithMarkers<MiterJoinPoint> m_miter_joins;
-  DataPacketWithMarkers<JoinPoint> m_bevel_joins, m_rounded_joins;
+  PacketSet m_data;
+
+  /*
+    location within m_data of the data of
+    each outline of m_h->tessellation()
+   */
+  std::vector<OutlineLocation> m_outline_locations;
 };
 
 /*! @} */
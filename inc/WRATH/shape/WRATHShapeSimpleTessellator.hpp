@@ -21,7 +21,10 @@
 #define WRATH_HEADER_SHAPE_SIMPLE_TESSELLATOR_HPP_
 
 #include "WRATHConfig.hpp"
+#include <map>
+#include <stdint.h>
 #include "WRATHBBox.hpp"
+#include "WRATHParallelFor.hpp"
 #include "WRATHShape.hpp"
 #include "WRATHInterleavedAttributes.hpp"
 
@@ -54,12 +57,15 @@ public:
     typedef WRATHShapeSimpleTessellatorPayload PayloadType;
     
     /*!\fn PayloadParams
-      Ctor initializes \ref m_curve_tessellation as 60 and
-      \ref m_max_recurse as 4
+      Ctor initializes \ref m_curve_tessellation as 60,
+      \ref m_max_recurse as 4, \ref m_tolerance as 0.0
+      and \ref m_max_scale as 1.0
      */
     PayloadParams(void):
       m_curve_tessellation(60), //a circle is then tessellated to 60 pts.
-      m_max_recurse(4)
+      m_max_recurse(4),
+      m_tolerance(0.0f),
+      m_max_scale(1.0f)
     {}
     
     /*!\fn PayloadParams& max_recurse
@@ -83,6 +89,50 @@ public:
       m_curve_tessellation=v;
       return *this;
     }
+
+    /*!\fn PayloadParams& tolerance
+      Sets \ref m_tolerance.
+      \param v value to use
+    */
+    PayloadParams&
+    tolerance(float v)
+    {
+      m_tolerance=v;
+      return *this;
+    }
+
+    /*!\fn PayloadParams& max_scale
+      Sets \ref m_max_scale.
+      \param v value to use
+    */
+    PayloadParams&
+    max_scale(float v)
+    {
+      m_max_scale=v;
+      return *this;
+    }
+
+    /*!\fn bool use_tolerance
+      Returns true if the tessellation is
+      driven by \ref m_tolerance, i.e.
+      if \ref m_tolerance is positive.
+     */
+    bool
+    use_tolerance(void) const
+    {
+      return m_tolerance>0.0f;
+    }
+
+    /*!\fn float local_tolerance
+      Returns the tolerance in the coordinates
+      of the WRATHShape, i.e. returns
+      \ref m_tolerance / \ref m_max_scale.
+     */
+    float
+    local_tolerance(void) const
+    {
+      return m_tolerance/std::max(m_max_scale, 0.0001f);
+    }
     
     /*!\fn float curve_tessellation_threshhold
       Returns the cumalative curve threshhold 
@@ -103,7 +153,9 @@ public:
     operator==(const PayloadParams &rhs) const
     {
       return m_max_recurse==rhs.m_max_recurse
-        and m_curve_tessellation==rhs.m_curve_tessellation;
+        and m_curve_tessellation==rhs.m_curve_tessellation
+        and m_tolerance==rhs.m_tolerance
+        and m_max_scale==rhs.m_max_scale;
     }
 
     /*!\var m_curve_tessellation
@@ -127,9 +179,40 @@ public:
       the maximum number of points a 
       path is decomposed into is
       \f$ 1+ 2^{m\_max\_recurse} \f$.
+      Not used when \ref m_tolerance is positive.
       Default value is 4
     */
     int m_max_recurse;
+
+    /*!\var m_tolerance
+      If positive, curves are tessellated so that
+      the distance between the tessellation and
+      the curve is no more than m_tolerance once
+      the WRATHShape is drawn scaled by \ref m_max_scale,
+      i.e. m_tolerance is in pixels when \ref m_max_scale
+      is the largest scale factor from the coordinates
+      of the WRATHShape to pixels. Bezier curves are
+      subdivided where a parabolic approximation 
+      of the curve deviates from the chord by more 
+      than the tolerance and arcs are split into 
+      equal pieces whose sagitta is within the tolerance. 
+      In this mode, \ref m_curve_tessellation and
+      \ref m_max_recurse are not used for curves, the 
+      number of points of an edge is instead bounded by 
+      \f$ 1+ 2^{12} \f$. A value of zero or less
+      indicates to use the curvature driven 
+      tessellation of \ref m_curve_tessellation 
+      and \ref m_max_recurse. Default value is 0.0.
+    */
+    float m_tolerance;
+
+    /*!\var m_max_scale
+      Hint for the largest scale factor at which the
+      WRATHShape is drawn, used to convert \ref m_tolerance
+      to the coordinates of the WRATHShape. Default 
+      value is 1.0.
+    */
+    float m_max_scale;
   };
 
 
@@ -423,10 +506,20 @@ public:
       \param pedges a _reference_ to a vector of TessellatedEdge::handle 's.
                     The vector is swapped with that of the created
                     TessellatedOutline, not copied.
+      \param hash_code value that \ref content_hash() returns,
+                       routine_fail indicates that the hash
+                       of the WRATHOutline is not available
+      \param hash value that \ref content_hash() writes, i.e.
+                  the value of WRATHOutline::content_hash()
+                  of the WRATHOutline tessellated
      */
     explicit
-    TessellatedOutline(int ID, std::vector<TessellatedEdge::handle> &pedges):
-      m_outlineID(ID)
+    TessellatedOutline(int ID, std::vector<TessellatedEdge::handle> &pedges,
+                       enum return_code hash_code=routine_fail,
+                       uint64_t hash=0):
+      m_outlineID(ID),
+      m_content_hash_code(hash_code),
+      m_content_hash(hash)
     {
       std::swap(pedges, m_edges);
       if(!m_edges.empty())
@@ -481,6 +574,26 @@ public:
     {
       return m_box;
     }
+
+    /*!\fn enum return_code content_hash(uint64_t&) const
+      Returns the hash, as computed by 
+      WRATHOutline::content_hash(), of the 
+      WRATHOutline from which this TessellatedOutline
+      was created. If the hash is not available,
+      returns routine_fail and does not write to
+      out_hash.
+      \param out_hash location to which to write the hash
+     */
+    enum return_code
+    content_hash(uint64_t &out_hash) const
+    {
+      if(m_content_hash_code==routine_success)
+        {
+          out_hash=m_content_hash;
+        }
+      return m_content_hash_code;
+    }
+
   private:
     
     void
@@ -490,12 +603,22 @@ public:
     TessellatedEdge::handle m_edge_to_last_point;
     int m_outlineID;
     WRATHBBox<2> m_box;
+    enum return_code m_content_hash_code;
+    uint64_t m_content_hash;
   };
 
   
   /*!\fn WRATHShapeSimpleTessellatorPayload
     Ctor. Create a WRATHShapeSimpleTessellatorPayload from
-    tessellation parameters and a WRATHShape<T>
+    tessellation parameters and a WRATHShape<T>.
+    If the WRATHShape<T> holds a previous 
+    WRATHShapeSimpleTessellatorPayload (see
+    \ref WRATHShape::fetch_previous_payload())
+    generated with the same parameters, then the
+    tessellation of those outlines whose 
+    WRATHOutline::content_hash() did not change
+    is reused. The remaining outlines are 
+    tessellated in parallel with WRATHParallelFor.
     \param pshape WRATHShape<T> to tessellate
     \param pp tessellation parameters 
    */
@@ -515,7 +638,9 @@ public:
   /*!\fn const std::vector<TessellatedOutline::handle>& tessellation
     Actual tessellation of the WRATHShape.
     Each entry in the returned array is a
-    WRATHOutline tessellated. Additionally
+    WRATHOutline tessellated. Outlines with
+    no points are skipped, as such if no
+    outline of the WRATHShape is empty, then
     one is guaranteed that 
     \code
     tessellation()[ID].outlineID()==ID
@@ -94,6 +94,21 @@ namespace WRATHShapeSimpleTessellatorPrivateImplement
     void
     compute(float t, analytic_point_data &output) const=0;
 
+    /*
+      Returns the number of pieces, of equal
+      length in time, to break the curve into
+      so that the tessellation is within tol
+      of the curve. A return value of 0 indicates
+      that the curve is to be subdivided adaptively
+      instead.
+     */
+    virtual
+    int
+    uniform_segment_count(float /*tol*/, int /*max_count*/) const
+    {
+      return 0;
+    }
+
   protected:
     
     template<typename T>
@@ -200,6 +215,10 @@ namespace WRATHShapeSimpleTessellatorPrivateImplement
     void
     compute(float t, analytic_point_data &output) const;
 
+    virtual
+    int
+    uniform_segment_count(float tol, int max_count) const;
+
   private:
     void
     init(float angle,
@@ -294,7 +313,7 @@ namespace WRATHShapeSimpleTessellatorPrivateImplement
   /*
     real implementation to tessellation is in geometry_computer
    */
-  class geometry_computer
+  class geometry_computer:private WRATHParallelFor::Job
   {
   public:  
     typedef std::vector<interpolator_base*> outline_type;
@@ -305,13 +324,34 @@ namespace WRATHShapeSimpleTessellatorPrivateImplement
                       std::vector<WRATHShapeSimpleTessellatorPayload::TessellatedOutline::handle> &rtessellation_data,
                       WRATHBBox<2> &rbox):
       m_tessellation(rtessellation_data),
-      m_box(rbox)
+      m_box(rbox),
+      m_params(params)
     {
+      WRATHShapeSimpleTessellatorPayload::handle prev;
+
+      /*
+        the tessellation of the payload from before
+        the last change to pshape can be reused for
+        those outlines that did not change, provided
+        it was made with the same parameters.
+       */
+      prev=pshape.template fetch_previous_payload<WRATHShapeSimpleTessellatorPayload>();
+      if(prev.valid() and prev->parameters()==params)
+        {
+          for(std::vector<WRATHShapeSimpleTessellatorPayload::TessellatedOutline::handle>::const_iterator
+                iter=prev->tessellation().begin(), end=prev->tessellation().end(); 
+              iter!=end; ++iter)
+            {
+              m_previous_outlines[(*iter)->outlineID()]=*iter;
+            }
+        }
+
+      m_input_outline_data.resize(pshape.number_outlines());
       for(int i=0, endi=pshape.number_outlines(); i<endi; ++i)
         {
-          add_outline<T>(pshape.outline(i));
+          add_outline<T>(i, pshape.outline(i));
         }
-      compute_implement(params);
+      compute_implement();
     }
 
     virtual
@@ -319,17 +359,52 @@ namespace WRATHShapeSimpleTessellatorPrivateImplement
 
   private:
 
+    class outline_entry
+    {
+    public:
+      outline_entry(void):
+        m_hash_code(routine_fail),
+        m_hash(0)
+      {}
+
+      outline_type m_interpolators;
+      enum return_code m_hash_code;
+      uint64_t m_hash;
+      WRATHShapeSimpleTessellatorPayload::TessellatedOutline::handle m_reused;
+    };
+
     template<typename T>
     void
-    add_outline(const WRATHOutline<T> *outline)
+    add_outline(int outlineID, const WRATHOutline<T> *outline)
     {
-      m_input_outline_data.push_back(outline_type());
+      outline_entry &entry(m_input_outline_data[outlineID]);
+      std::map<int, WRATHShapeSimpleTessellatorPayload::TessellatedOutline::handle>::const_iterator prev;
+      uint64_t prev_hash;
+
+      entry.m_hash_code=outline->content_hash(entry.m_hash);
+      prev=m_previous_outlines.find(outlineID);
+      if(entry.m_hash_code==routine_success
+         and prev!=m_previous_outlines.end()
+         and prev->second->content_hash(prev_hash)==routine_success
+         and prev_hash==entry.m_hash)
+        {
+          entry.m_reused=prev->second;
+          return;
+        }
 
+      /*
+        interpolators are built from the calling
+        thread, the tessellation from them is 
+        done by WRATHParallelFor in compute_implement()
+        except for outlines using a GenericInterpolator
+        (entry.m_hash_code is then routine_fail), those
+        are tessellated from the calling thread.
+       */
       for(typename std::vector<typename WRATHOutline<T>::point>::const_iterator
             iter=outline->points().begin(), end=outline->points().end();
           iter!=end; ++iter)
         {
-          m_input_outline_data.back().push_back(construct_interpolator<T>(*iter));
+          entry.m_interpolators.push_back(construct_interpolator<T>(*iter));
         }
     }
 
@@ -337,11 +412,19 @@ namespace WRATHShapeSimpleTessellatorPrivateImplement
       This is the method that does the actual tesselation, etc.
      */
     void
-    compute_implement(const WRATHShapeSimpleTessellatorPayload::PayloadParams &params);
+    compute_implement(void);
+
+    /*
+      WRATHParallelFor::Job interface, tessellates
+      the outline m_pending[i]
+     */
+    virtual
+    void
+    execute(int i);
 
     WRATHShapeSimpleTessellatorPayload::TessellatedOutline::handle
     create_outline(int outlineID,
-                   const outline_type &outline,
+                   const outline_entry &outline,
                    const WRATHShapeSimpleTessellatorPayload::PayloadParams &param);
 
     WRATHShapeSimpleTessellatorPayload::TessellatedEdge::handle
@@ -352,8 +435,17 @@ namespace WRATHShapeSimpleTessellatorPrivateImplement
 
     std::vector<WRATHShapeSimpleTessellatorPayload::TessellatedOutline::handle> &m_tessellation;
     WRATHBBox<2> &m_box;
+    const WRATHShapeSimpleTessellatorPayload::PayloadParams &m_params;
+
+    std::vector<outline_entry> m_input_outline_data;
+    std::map<int, WRATHShapeSimpleTessellatorPayload::TessellatedOutline::handle> m_previous_outlines;
 
-    std::list<outline_type> m_input_outline_data;
+    /*
+      outline ID's to tessellate and 
+      the tessellation of each
+     */
+    std::vector<int> m_pending;
+    std::vector<WRATHShapeSimpleTessellatorPayload::TessellatedOutline::handle> m_pending_results;
   };
 
 }
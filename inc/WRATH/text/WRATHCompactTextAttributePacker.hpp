@@ -0,0 +1,292 @@
+/*! 
+ * \file WRATHCompactTextAttributePacker.hpp
+ * \brief file WRATHCompactTextAttributePacker.hpp
+ * 
+ * Copyright 2013 by Nomovok Ltd.
+ * 
+ * Contact: info@nomovok.com
+ * 
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ * 
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ * 
+ */
+
+
+
+
+#ifndef WRATH_HEADER_COMPACT_TEXT_ATTRIBUTE_PACKER_HPP_
+#define WRATH_HEADER_COMPACT_TEXT_ATTRIBUTE_PACKER_HPP_
+
+
+#include "WRATHConfig.hpp"
+#include "WRATHGenericTextAttributePacker.hpp"
+
+/*! \addtogroup Text
+ * @{
+ */
+
+/*!\class WRATHCompactTextAttributePacker
+  A WRATHCompactTextAttributePacker packs glyphs with
+  smaller attributes than \ref WRATHDefaultTextAttributePacker.
+  It comes in two flavors.
+
+  The packers returned by fetch() pack a single quad per
+  glyph as does \ref WRATHDefaultTextAttributePacker
+  (with \ref SingleQuadPacker): the effective scale and
+  stretching of the glyph are combined into a single vec2
+  and the normalized coordinate of each corner of the
+  glyph is encoded in the high bits of the glyph size.
+  An attribute is 32 bytes (without custom data), 28
+  bytes with \ref WRATHAttributePacker::half_precision_format
+  (the glyph scale is then 16-bit floats), instead of
+  40 bytes of \ref WRATHDefaultTextAttributePacker; a
+  glyph is 4 attributes and 6 indices. Use them with 
+  \ref WRATHFontShaderSpecifier::compact_aa() or
+  \ref WRATHFontShaderSpecifier::compact_non_aa().
+
+  The packers returned by fetch_instanced() pack one
+  attribute per glyph and no indices (see
+  \ref InstancedPacker); a glyph is drawn as one instance
+  of 6 vertices (see WRATHAttributeStoreKey::instance_vertex_count()).
+  The attribute holds the position, scale, the colors of
+  the 4 corners and the location of the glyph in a per-font
+  table (see glyph_table()) which holds the texel size and
+  location of the glyphs. An attribute is 40 bytes (without
+  custom data), 36 bytes with 
+  \ref WRATHAttributePacker::half_precision_format. Instanced
+  drawing requires GL 3.3 or GLES3. Use them with
+  \ref WRATHFontShaderSpecifier::compact_instanced_aa() or
+  \ref WRATHFontShaderSpecifier::compact_instanced_non_aa().
+
+  The texel size of a glyph must be less than 16384
+  in each dimension.
+ */
+class WRATHCompactTextAttributePacker:public WRATHGenericTextAttributePacker
+{
+public:
+  enum
+    {
+      /*!
+        location of draw position, a vec3 (in GLSL),
+        attribute name is "pos"
+        - .xy=position of bottom left relative to transformation node
+        - .z=geometric z_position
+       */
+      position_location,
+
+      /*!
+        location of the scale of the glyph, a vec2
+        in GLSL, the product of the scaling factor
+        (see \ref WRATHText::effective_scale) and the
+        stretching (see \ref WRATHText::horizontal_stretching
+        and \ref WRATHText::vertical_stretching) of the glyph.
+        Attribute name in GLSL is "glyph_scale".
+       */
+      glyph_scale_location,
+
+      /*!
+        Location of the attribute named "glyph_size_and_bottom_left"
+        which is vec4 comprised of
+        - .xy holds \ref WRATHTextureFont::glyph_data_type::texel_size()
+          with 32768 added to .x (respectively .y) if the corner is
+          on the right (respectively top) of the glyph and 16384
+          added to .y if the y-coordinate increases downwards
+        - .zw holds \ref WRATHTextureFont::glyph_data_type::texel_lower_left().
+       */
+      glyph_size_and_bottom_left_location,
+
+      /*!
+        location of color, a vec4 (in GLSL) .
+        Attribute name in GLSL is "color".
+      */
+      color_location,
+
+      /*!
+        Custom data location, the custom data
+        is packed as in \ref WRATHDefaultTextAttributePacker
+       */
+      custom_data_location
+    };
+
+  enum
+    {
+      /*!
+        location of draw position of an instanced
+        packer, a vec3 (in GLSL), attribute name is "pos",
+        as \ref position_location
+       */
+      instanced_position_location=0,
+
+      /*!
+        location of the scale of the glyph of an
+        instanced packer, a vec2 (in GLSL), attribute
+        name is "glyph_scale", as \ref glyph_scale_location
+       */
+      instanced_glyph_scale_location,
+
+      /*!
+        location of the attribute named "glyph_table_location",
+        a vec2 (in GLSL), of an instanced packer:
+        - .x the column of the glyph in the table of the font
+          (see glyph_table()), with 32768 added if the
+          y-coordinate increases downwards
+        - .y the row of the glyph in the table of the font
+       */
+      glyph_table_location_location,
+
+      /*!
+        location of the color of the bottom left corner
+        of the glyph of an instanced packer, a vec4 (in GLSL),
+        attribute name is "color_bottom_left". The colors of
+        the corners are in the order of 
+        WRATHFormattedTextStream::corner_type.
+       */
+      color_bottom_left_location,
+
+      /*!
+        location of the color of the bottom right corner,
+        attribute name is "color_bottom_right"
+       */
+      color_bottom_right_location,
+
+      /*!
+        location of the color of the top right corner,
+        attribute name is "color_top_right"
+       */
+      color_top_right_location,
+
+      /*!
+        location of the color of the top left corner,
+        attribute name is "color_top_left"
+       */
+      color_top_left_location,
+
+      /*!
+        Custom data location of an instanced packer
+       */
+      instanced_custom_data_location
+    };
+
+  /*!\fn fetch
+    A WRATHCompactTextAttributePacker is stateless,
+    returns the WRATHCompactTextAttributePacker,
+    which packs 4 attributes per glyph, of an 
+    attribute format.
+    \param fmt attribute format of the packer to fetch
+   */
+  static
+  WRATHCompactTextAttributePacker*
+  fetch(enum WRATHAttributePacker::attribute_format_type fmt
+        =WRATHAttributePacker::full_precision_format);
+
+  /*!\fn fetch_instanced
+    Returns the WRATHCompactTextAttributePacker,
+    which packs one instanced attribute per glyph,
+    of an attribute format. Requires GL 3.3 or GLES3.
+    \param fmt attribute format of the packer to fetch
+   */
+  static
+  WRATHCompactTextAttributePacker*
+  fetch_instanced(enum WRATHAttributePacker::attribute_format_type fmt
+                  =WRATHAttributePacker::full_precision_format);
+
+  /*!\fn bool instanced
+    Returns true if this packer packs one
+    instanced attribute per glyph, i.e. if it
+    was returned by fetch_instanced().
+   */
+  bool
+  instanced(void) const
+  {
+    return type()==InstancedPacker;
+  }
+
+  virtual
+  ~WRATHCompactTextAttributePacker();
+
+  virtual
+  size_t
+  attribute_size(int number_custom_data_to_use) const;
+
+  virtual
+  void
+  attribute_names(std::vector<std::string> &out_names, int n) const;
+
+  virtual
+  void
+  generate_custom_data_glsl(WRATHGLShader::shader_source &out_src,
+                            int number_custom_data_to_use) const;
+
+  virtual
+  void
+  pack_attribute(enum WRATHFormattedTextStream::corner_type ct,
+                 const glyph_data &in_glyph,
+                 const vec2 &normalized_glyph_coordinate_float,
+                 vecN<GLshort,2> normalized_glyph_coordinate_short,
+                 const std::vector<int> &custom_data_use,
+                 c_array<uint8_t> packing_destination,
+                 const PackerState &packer_state) const;
+
+  virtual
+  void
+  attribute_key(WRATHAttributeStoreKey &pkey,
+                int number_custom_data_to_use) const;
+
+  virtual
+  PackerState
+  begin_range(const range_type<int> &R,
+              WRATHTextureFont *font,
+              int texture_page,
+              const WRATHFormattedTextStream &pdata,
+              const WRATHStateStream &state_stream) const;
+
+  /*!\fn const char* glyph_table_sampler_name
+    For an instanced packer, returns "wrath_glyph_metrics",
+    the name of the usampler2D of the glyph table in
+    the vertex shader, otherwise returns NULL.
+   */
+  virtual
+  const char*
+  glyph_table_sampler_name(void) const;
+
+  /*!\fn WRATHTextureChoice::texture_base::handle glyph_table
+    For an instanced packer, returns the table of the
+    glyphs of a font, creating it if necessary. The
+    table is a GL_RGBA16UI texture, 256 texels wide,
+    a texel holding the texel size (.xy) and bottom
+    left corner (.zw) of a glyph. A glyph is added to
+    the table the first time it is packed and the table
+    is uploaded to GL when bound. The table is released
+    when the font is deleted. For a non-instanced packer,
+    returns an invalid handle.
+    \param font font of the table
+   */
+  virtual
+  WRATHTextureChoice::texture_base::handle
+  glyph_table(WRATHTextureFont *font) const;
+
+private:
+
+  class per_font_glyph_table;
+  typedef std::map<WRATHTextureFont*, per_font_glyph_table*> glyph_table_map;
+
+  WRATHCompactTextAttributePacker(enum WRATHAttributePacker::attribute_format_type fmt,
+                                  bool pinstanced);
+
+  void
+  on_font_delete(WRATHTextureFont *font) const;
+
+  enum WRATHAttributePacker::attribute_format_type m_format;
+
+  mutable WRATHMutex m_glyph_tables_mutex;
+  mutable glyph_table_map m_glyph_tables;
+};
+/*! @} */
+
+
+#endif
@@ -33,6 +33,14 @@
   A WRATHDefaultTextAttributePacker is an
   example of a WRATHGenericTextAttributePacker.
 
+  There is a WRATHDefaultTextAttributePacker for each
+  \ref PackerType and each \ref attribute_format_type;
+  with \ref WRATHAttributePacker::half_precision_format the glyph stretch
+  is packed as 16-bit floats making an attribute 36
+  bytes instead of 40 bytes (the position is not
+  reduced since it is relative to the transformation
+  node and thus can be large).
+
   TODO: 
     1) have it "work" so that number of
        custom data slots can be specified in 
@@ -96,10 +104,13 @@ public:
     a single quad per glyph or using multiple primitives
     per glyph (see \ref WRATHTextureFont::glyph_data_type::support_sub_primitives() ).
     \param tp Determines which packer type to fetch
+    \param fmt Determines the attribute format of the packer to fetch
    */
   static
   WRATHDefaultTextAttributePacker*
-  fetch(enum PackerType tp=SingleQuadPacker);
+  fetch(enum PackerType tp=SingleQuadPacker,
+        enum WRATHAttributePacker::attribute_format_type fmt
+        =WRATHAttributePacker::full_precision_format);
 
   /*!\fn fetch_single_quad_packer
     A WRATHDefaultTextAttributePacker is stateless.
@@ -164,8 +175,10 @@ public:
   
 private:
 
-  explicit
-  WRATHDefaultTextAttributePacker(enum PackerType subpacker);
+  WRATHDefaultTextAttributePacker(enum PackerType subpacker,
+                                  enum WRATHAttributePacker::attribute_format_type fmt);
+
+  enum WRATHAttributePacker::attribute_format_type m_format;
 };
 /*! @} */
 
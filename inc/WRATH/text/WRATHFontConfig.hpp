@@ -225,6 +225,47 @@ namespace WRATHFontConfig
    */
   typedef std::map<WRATHFontDatabase::Font::const_handle, FontSpecification> FontList;
 
+  /*!\fn const std::string& index_file(void)
+    WRATHFontConfig does not ask Fontconfig to
+    list the fonts (which may require Fontconfig to
+    open every font file). Instead it keeps an index
+    on disk of the scalable outline fonts found in 
+    the font directories of the Fontconfig configuration.
+    An entry of the index is keyed by file name, file
+    modification time, file size and face index and stores 
+    the family, foundry, style, weight, slant and language
+    coverage of the face. On first use of WRATHFontConfig,
+    only those directories whose modification time
+    differs from the index are listed again; in the
+    other directories only the files of the index are
+    checked. Only font files that are new or whose
+    modification time or size changed are opened (in 
+    parallel), and the index is rewritten if anything
+    changed. Fonts are added
+    to \ref WRATHFontDatabase without opening them,
+    see WRATHFontDatabase::fetch_font_entry(const std::string&, int, const WRATHFontDatabase::FontProperties&).
+
+    Returns the file name of the index. Default value is
+    the value of the environmental variable WRATH_FONT_INDEX
+    if it is set, otherwise $HOME/.wrath_font_index. If
+    the value is an empty string, no index is read or
+    written and all font directories are scanned.
+   */
+  const std::string&
+  index_file(void);
+
+  /*!\fn void index_file(const std::string&)
+    Set the file name of the font index, see 
+    \ref index_file(void). Must be called before
+    any fonts are fetched via WRATHFontConfig
+    (or \ref WRATHFontDatabase) to have effect.
+    \param filename file name to use, an empty 
+                    string indicates to not use
+                    an index file
+   */
+  void
+  index_file(const std::string &filename);
+
   /*!\fn const FontList& font_list(void)
     Returns a reference to a map
     containing all those fonts that
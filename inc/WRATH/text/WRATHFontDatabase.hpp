@@ -390,7 +390,8 @@ namespace WRATHFontDatabase
 
     friend class FontDatabaseImplement;
     Font(const FontMemorySource::const_handle &h, 
-         const std::string &pfilename, int pindex, FT_Face pface);
+         const std::string &pfilename, int pindex, 
+         const FontProperties &props);
 
     FontMemorySource::const_handle m_memory_source;
     std::string m_filename;
@@ -573,6 +574,27 @@ namespace WRATHFontDatabase
   fetch_font_entries(const std::string &pfilename,
                      const FontMemorySource::const_handle &h=FontMemorySource::const_handle());
 
+  /*!\fn Font::const_handle fetch_font_entry(const std::string&, int, const FontProperties&)
+    Returns a handle to a Font sourcing from the specified
+    filename and face index whose properties are already
+    known, for example from a font index (see \ref WRATHFontConfig).
+    The font file is NOT opened, the FT_Face of the font
+    is only created when the font is first used (see
+    WRATHFreeTypeSupport::load_face()). It is the caller's 
+    responsibility that the file is a scalable font file
+    with the face index. If the (filename, face_index) 
+    pair already exists in the font database, returns
+    that Font and the passed properties are ignored.
+    Maybe called from multiple threads concurrently.
+    \param pfilename filename from which to source the font
+    \param pface_index face index within the file from which
+                       to source the font
+    \param props properties of the font
+   */
+  Font::const_handle
+  fetch_font_entry(const std::string &pfilename, int pface_index,
+                   const FontProperties &props);
+
  
 
   /*!\fn Font::const_handle create_unregistered_font(const std::string&, int, 
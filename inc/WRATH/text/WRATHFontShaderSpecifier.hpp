@@ -193,6 +193,26 @@ public:
   static
   const WRATHGLShader::shader_source&
   default_vertex_shader(void);
+
+  /*!\fn const WRATHGLShader::shader_source& compact_vertex_shader
+    Returns a vertex shader that works with
+    \ref WRATHCompactTextAttributePacker for vertex
+    shading of font drawing.
+   */
+  static
+  const WRATHGLShader::shader_source&
+  compact_vertex_shader(void);
+  
+  /*!\fn const WRATHGLShader::shader_source& compact_instanced_vertex_shader
+    Returns a vertex shader that works with the
+    instanced packers of \ref WRATHCompactTextAttributePacker
+    (see WRATHCompactTextAttributePacker::fetch_instanced())
+    for vertex shading of font drawing. Requires
+    GL 3.3 or GLES3.
+   */
+  static
+  const WRATHGLShader::shader_source&
+  compact_instanced_vertex_shader(void);
   
   /*!\fn const WRATHGLShader::shader_source& default_aa_fragment_shader
     Returns a default fragment shader for drawing
@@ -248,6 +268,58 @@ public:
   const WRATHFontShaderSpecifier&
   default_non_aa(void);
 
+  /*!\fn const WRATHFontShaderSpecifier& compact_aa
+    Returns the pre-built WRATHFontShaderSpecifier
+    for drawing AA-text whose attributes are packed
+    with \ref WRATHCompactTextAttributePacker.
+   */
+  static
+  const WRATHFontShaderSpecifier&
+  compact_aa(void);
+
+  /*!\fn const WRATHFontShaderSpecifier& compact_non_aa
+    Returns the pre-built WRATHFontShaderSpecifier
+    for drawing non-AA text whose attributes are packed
+    with \ref WRATHCompactTextAttributePacker.
+   */
+  static
+  const WRATHFontShaderSpecifier&
+  compact_non_aa(void);
+
+  /*!\fn const WRATHFontShaderSpecifier& compact_instanced_aa
+    Returns the pre-built WRATHFontShaderSpecifier
+    for drawing AA-text whose attributes are packed
+    with the instanced packers of
+    \ref WRATHCompactTextAttributePacker.
+   */
+  static
+  const WRATHFontShaderSpecifier&
+  compact_instanced_aa(void);
+
+  /*!\fn const WRATHFontShaderSpecifier& compact_instanced_non_aa
+    Returns the pre-built WRATHFontShaderSpecifier
+    for drawing non-AA text whose attributes are packed
+    with the instanced packers of 
+    \ref WRATHCompactTextAttributePacker.
+   */
+  static
+  const WRATHFontShaderSpecifier&
+  compact_instanced_non_aa(void);
+
+  /*!\fn int glyph_table_texture_unit
+    Returns the texture unit, as an offset from
+    GL_TEXTURE0, at which the drawers fetched by
+    fetch_texture_font_drawer() read the glyph
+    table of a WRATHTextAttributePacker, see
+    WRATHTextAttributePacker::glyph_table(). The
+    unit follows those of the samplers of the
+    font and of the additional textures.
+    \param fs_source WRATHTextureFont::GlyphGLSL of the font
+   */
+  static
+  int
+  glyph_table_texture_unit(const WRATHTextureFont::GlyphGLSL *fs_source);
+
   /*!\fn const WRATHFontShaderSpecifier& default_brush_item_non_aa
     Returns a pre-built WRATHFontShaderSpecifier
     for drawing non-AA text with a brush applied on
@@ -772,7 +844,12 @@ private:
 
  
   typedef WRATHTextureFont::GlyphGLSL GlyphGLSL;
-  typedef std::map<const GlyphGLSL*, WRATHShaderSpecifier*> map_type;
+  /*
+    keyed by the GlyphGLSL and the glyph table
+    sampler name of the packer (empty if none)
+   */
+  typedef std::pair<const GlyphGLSL*, std::string> map_key;
+  typedef std::map<map_key, WRATHShaderSpecifier*> map_type;
   
   ResourceKey m_resource_name;
   bool m_remove_from_manager;
@@ -46,6 +46,7 @@
 #include "WRATHUtil.hpp"
 #include "WRATHPolynomial.hpp"
 #include "WRATHFontDatabase.hpp"
+#include "WRATHatomic.hpp"
 
 
 
@@ -2912,6 +2913,138 @@ namespace WRATHFreeTypeSupport
     bool m_own_mutex;
   };
   
+  /*!\class KerningTable
+    A KerningTable holds the kerning pairs of an
+    FT_Face scaled to a pixel size, as read directly
+    from the 'kern' table of the font. Once constructed
+    a KerningTable is immutable, thus it can be queried
+    from multiple threads without locking the FT_Face.
+    The pairs are stored in an open addressing hash
+    table using 8 bytes per slot.
+   */
+  class KerningTable:boost::noncopyable
+  {
+  public:
+    /*!\fn KerningTable(FT_Face, int)
+      Ctor. Reads the kerning pairs of the 'kern'
+      table of an FT_Face. The caller must hold
+      the lock of the face (see LockableFace::mutex()),
+      the ctor changes the pixel size of the face.
+      \param face FT_Face from which to read the kerning
+      \param pixel_height pixel size to which to scale
+                          the kerning values
+     */
+    KerningTable(FT_Face face, int pixel_height);
+
+    /*!\fn bool valid(void) const
+      Returns true if the kerning of the face
+      could be read. If the face has kerning
+      that is not stored in a 'kern' table that
+      can be read directly (for example Type1
+      fonts with AFM files), returns false and
+      kerning must be queried from FreeType.
+     */
+    bool
+    valid(void) const
+    {
+      return m_valid;
+    }
+
+    /*!\fn int pixel_height(void) const
+      Returns the pixel size to which the 
+      kerning values are scaled.
+     */
+    int
+    pixel_height(void) const
+    {
+      return m_pixel_height;
+    }
+
+    /*!\fn int number_pairs(void) const
+      Returns the number of kerning pairs
+      with a non-zero value.
+     */
+    int
+    number_pairs(void) const
+    {
+      return m_number_pairs;
+    }
+
+    /*!\fn ivec2 kerning_offset(uint32_t, uint32_t) const
+      Returns the kerning between two glyphs
+      in 26.6 fixed point pixels, the same value
+      as FT_Get_Kerning with FT_KERNING_UNFITTED
+      returns.
+      \param left_glyph glyph index of glpyh on the left
+      \param right_glyph glyph index of glpyh on the right      
+     */
+    ivec2
+    kerning_offset(uint32_t left_glyph, uint32_t right_glyph) const
+    {
+      uint32_t key, slot;
+
+      if(m_entries.empty() or left_glyph>0xFFFF or right_glyph>0xFFFF)
+        {
+          return ivec2(0, 0);
+        }
+
+      key=(left_glyph<<16u)|right_glyph;
+      for(slot=first_slot(key); m_entries[slot].m_key!=empty_key; slot=(slot+1)&m_mask)
+        {
+          if(m_entries[slot].m_key==key)
+            {
+              return ivec2(m_entries[slot].m_value, 0);
+            }
+        }
+      return ivec2(0, 0);
+    }
+
+  private:
+    enum
+      {
+        empty_key=0xFFFFFFFFu
+      };
+
+    class entry
+    {
+    public:
+      uint32_t m_key;
+      int32_t m_value;
+    };
+
+    uint32_t
+    first_slot(uint32_t key) const
+    {
+      return (key*2654435761u)>>m_shift;
+    }
+
+    std::vector<entry> m_entries;
+    uint32_t m_mask, m_shift;
+    int m_pixel_height;
+    int m_number_pairs;
+    bool m_valid;
+  };
+
+  /*!\fn bool kerning_table_enabled(void)
+    Returns true if CharacterMapSupport 
+    uses a KerningTable to answer kerning
+    queries, see CharacterMapSupport::kerning_table().
+    Default value is true.
+   */
+  bool
+  kerning_table_enabled(void);
+
+  /*!\fn void kerning_table_enabled(bool)
+    Sets if CharacterMapSupport uses a 
+    KerningTable to answer kerning queries,
+    see kerning_table_enabled(void). Provided
+    mostly for measuring the performance
+    difference.
+    \param v value to use
+   */
+  void
+  kerning_table_enabled(bool v);
+
   /*!\class CharacterMapSupport
     FreeType proveds a mapping from character codes
     to glyph indexes, (called a character mapping).
@@ -3042,7 +3175,8 @@ namespace WRATHFreeTypeSupport
     CharacterMapSupport(LockableFace::handle h):
       m_ttf_face(h),
       m_total_time_to_generate(0),
-      m_number_glyphs_generated(0)
+      m_number_glyphs_generated(0),
+      m_kerning_table(NULL)
     {
       init();
     }
@@ -3060,6 +3194,10 @@ namespace WRATHFreeTypeSupport
               WRATHDelete(iter->m_value);
             }
         }
+      if(m_kerning_table!=NULL)
+        {
+          WRATHDelete(m_kerning_table);
+        }
       WRATHUnlockMutex(m_ttf_face->mutex());
       WRATHUnlockMutex(m_set_get_data_mutex);
     }
@@ -3082,10 +3220,22 @@ namespace WRATHFreeTypeSupport
       
       if(glyph.valid() and glyph.value()<m_data.size())
         {
+          T *ptr;
+
+          /*
+            once generated, the data of a glyph 
+            never changes, so if it is already
+            generated there is no need to lock.
+           */
+          ptr=WRATHAtomicLoad(&m_data[glyph.value()].m_value);
+          if(ptr!=NULL)
+            {
+              return ptr;
+            }
+
           WRATHLockMutex(m_set_get_data_mutex);
           if(m_data[glyph.value()].m_value==NULL and !m_data[glyph.value()].m_is_waiting)
             {
-              T *ptr;
 
               /*
                 m_data[glyph.value()] is NULL, 
@@ -3115,7 +3265,7 @@ namespace WRATHFreeTypeSupport
                 Relock and set the value.
                */
               WRATHLockMutex(m_set_get_data_mutex);
-              m_data[glyph.value()].m_value=ptr;
+              WRATHAtomicStore(&m_data[glyph.value()].m_value, ptr);
               m_data[glyph.value()].m_is_waiting=false;
               m_data[glyph.value()].m_time_to_generate=delta;
 
@@ -3362,7 +3512,14 @@ namespace WRATHFreeTypeSupport
       
       if(m_supports_kerning and left_glyph.valid() and right_glyph.valid())
         {
+          const KerningTable *table;
           FT_Vector v;
+
+          table=kerning_table(pixel_height);
+          if(table!=NULL)
+            {
+              return table->kerning_offset(left_glyph.value(), right_glyph.value());
+            }
           
           WRATHLockMutex(m_ttf_face->mutex());
 
@@ -3379,6 +3536,46 @@ namespace WRATHFreeTypeSupport
       return R;
     }
 
+    /*!\fn const KerningTable* kerning_table(int)
+      Returns the KerningTable of the face
+      of this CharacterMapSupport, creating it
+      on the first call. Once created, the table
+      is read without locking. Returns NULL if
+      kerning tables are disabled (see \ref
+      kerning_table_enabled()), if the kerning
+      of the face cannot be read directly or if
+      the table was created for a different
+      pixel size.
+      \param pixel_height pixel size of kerning values
+     */
+    const KerningTable*
+    kerning_table(int pixel_height)
+    {
+      KerningTable *table;
+
+      if(!kerning_table_enabled())
+        {
+          return NULL;
+        }
+
+      table=WRATHAtomicLoad(&m_kerning_table);
+      if(table==NULL)
+        {
+          WRATHLockMutex(m_ttf_face->mutex());
+          table=m_kerning_table;
+          if(table==NULL)
+            {
+              table=WRATHNew KerningTable(m_ttf_face->face(), pixel_height);
+              WRATHAtomicStore(&m_kerning_table, table);
+            }
+          WRATHUnlockMutex(m_ttf_face->mutex());
+        }
+
+      return (table->valid() and table->pixel_height()==pixel_height)?
+        table:
+        NULL;
+    }
+
     /*!\fn void print_stats(std::ostream&)
       Print the stats to an std::ostream
      */
@@ -3497,15 +3694,51 @@ namespace WRATHFreeTypeSupport
     std::map<glyph_index_type, character_code_type> m_ascii;
     std::vector<data_type> m_data;
     bool m_supports_kerning;
+    KerningTable *m_kerning_table;
   };
   
+  /*!\fn FT_Library shared_library
+    Returns the FT_Library shared by all FT_Face
+    objects that WRATH creates (for example by
+    load_face() and by \ref WRATHFontDatabase).
+    The library is created on first call and lives
+    until the program exits. FreeType requires that
+    creating and releasing FT_Face objects of a
+    common FT_Library is serialized, use
+    new_face() and done_face() which do so.
+   */
+  FT_Library
+  shared_library(void);
+
+  /*!\fn FT_Face new_face(const std::string&, int, const WRATHFontDatabase::FontMemorySource::const_handle&)
+    Create a FT_Face from the \ref shared_library().
+    Returns NULL on failure or if the face is not
+    scalable. Thread safe.
+    \param filename file from which to source the face
+    \param face_index face index within the file
+    \param h if valid, source the face from the
+             memory of h instead of the file
+   */
+  FT_Face
+  new_face(const std::string &filename, int face_index,
+           const WRATHFontDatabase::FontMemorySource::const_handle &h);
+
+  /*!\fn void done_face(FT_Face)
+    Release a FT_Face returned by new_face().
+    Thread safe.
+    \param face FT_Face to release
+   */
+  void
+  done_face(FT_Face face);
+
   /*!\fn LockableFace::handle load_face(const WRATHFontDatabase::Font::const_handle &)
     Load a FT_Face from a file given a filename
     and a face_index returning a handle to a
     LockableFace. The FT_Face of the returned 
-    handle has it's private FT_Library, as such
-    can be used in parallel safely with other
-    handles returned by load_face(). 
+    handle is created from \ref shared_library(),
+    faces of different handles returned by load_face()
+    can be used in parallel safely since each
+    handle has its own mutex.
 
     \param fnt handle to WRATHFontDatabase::Font from which to source font data,
                specifies from where to source the Font (file, memory, etc)
@@ -45,15 +45,28 @@
 
   - \ref begin_range()
   - \ref end_range().
+
+  The attribute and index data is packed into
+  buffers local to the calling thread without
+  locking the WRATHAbstractDataSink objects
+  passed to set_attribute_data(); their mutexes
+  are only locked to copy the packed data.
+  Hence, pack_attribute(), begin_range(),
+  current_glyph() and end_range() are called
+  without any lock held and several text items
+  may be packed concurrently from different
+  threads, provided the implementations of those
+  methods are thread safe.
  */
 class WRATHGenericTextAttributePacker:public WRATHTextAttributePacker
 {
 public:
 
   /*!\enum PackerType
-    There are two versions for it's packing: using
-    a single quad per glyph or using multiple primitives
-    per glyph (see \ref WRATHTextureFont::glyph_data_type::support_sub_primitives() ).
+    There are three versions for it's packing: using
+    a single quad per glyph, using multiple primitives
+    per glyph (see \ref WRATHTextureFont::glyph_data_type::support_sub_primitives() )
+    or using a single instanced attribute per glyph.
    */
   enum PackerType
     {
@@ -70,7 +83,22 @@ public:
         cover a smaller area than the primitive
         of the glyph.
        */
-      SubPrimitivePacker=1
+      SubPrimitivePacker=1,
+
+      /*!
+        Use a packer that packs a single attribute,
+        drawn as one instance, per glyph and no
+        index data, see 
+        WRATHAttributeStoreKey::instance_vertex_count().
+        pack_attribute() is called once per glyph
+        with the corner WRATHFormattedTextStream::not_corner
+        and the normalized coordinate of the top right
+        corner of the glyph, the vertex shader computes
+        the corners of the glyph. The WRATHAbstractDataSink
+        for the indices passed to set_attribute_data()
+        is not used and may be invalid.
+       */
+      InstancedPacker=2
     };
 
   /*!\class glyph_data
@@ -343,6 +371,51 @@ public:
                  const PackerState &packer_state) const=0;
 
 protected:
+  /*!\fn void append_custom_data_attribute_names
+    Conveniance function for derived classes that
+    pack the custom data of glyphs as floats following
+    their attribute, every 4 floats making one vec4
+    attribute. Appends the names of the attributes
+    of the custom data, custom_data0, custom_data1, etc.
+    \param out_names location to which to append the names
+    \param number_custom_data_to_use number of custom data values
+   */
+  static
+  void
+  append_custom_data_attribute_names(std::vector<std::string> &out_names,
+                                     int number_custom_data_to_use);
+
+  /*!\fn void generate_custom_data_attribute_glsl
+    Conveniance function implementing
+    generate_custom_data_glsl() for the custom data
+    layout of \ref append_custom_data_attribute_names().
+    \param out_src location to which to add GLSL source code
+    \param number_custom_data_to_use number of custom data values
+   */
+  static
+  void
+  generate_custom_data_attribute_glsl(WRATHGLShader::shader_source &out_src,
+                                      int number_custom_data_to_use);
+
+  /*!\fn void set_custom_data_attribute_key
+    Conveniance function to set the attribute formats
+    of the custom data for the custom data layout of
+    \ref append_custom_data_attribute_names() and to
+    set the stride of all attributes to pkey.m_type_size.
+    \param pkey key to modify, pkey.m_type_size must already
+                be set to the size of the attribute with the
+                custom data
+    \param first_slot attribute slot of the first custom data attribute
+    \param offset offset in bytes of the first custom data value
+                  within the attribute
+    \param number_custom_data_to_use number of custom data values
+   */
+  static
+  void
+  set_custom_data_attribute_key(WRATHAttributeStoreKey &pkey,
+                                int first_slot, ptrdiff_t offset,
+                                int number_custom_data_to_use);
+
   /*!\fn set_attribute_data_implement
     Implementation of \ref set_attribute_data().
     WRATHGenericTextAttributePacker derived objects
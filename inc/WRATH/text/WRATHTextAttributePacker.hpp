@@ -85,12 +85,15 @@ public:
     int m_number_indices;
 
     /*!\fn empty
-      Returns true if \ref m_number_indices is zero.
+      Returns true if both \ref m_number_indices
+      and \ref m_number_attributes are zero. Note
+      that a packer that draws glyphs instanced
+      requires attributes but no indices.
      */
     bool
     empty(void) const
     {
-      return m_number_indices==0;
+      return m_number_indices==0 and m_number_attributes==0;
     }
   };
 
@@ -347,7 +350,6 @@ public:
     Provided as a conveniance, equivalent to
     \code
     WRATHassert(item_group.valid());
-    WRATHassert(index_group.valid());
     WRATHAttributeStore::DataSink attribute_sink(item_group.data_sink());
     WRATHIndexGroupAllocator::DataSink idx_sink(index_group.data_sink());
     set_attribute_data(R, font, texture_page, 
@@ -368,6 +370,9 @@ public:
                          of the attribute data to write to
     \param index_group handle to index group to where to pack indices.
                        Indices beyond those that are needed are to be set as 0.
+                       May be invalid if the packer requires no indices
+                       (see allocation_requirement()), for example if
+                       it draws glyphs instanced.
     \param pdata formatted text stream to get the characters from
     \param state_stream state change stream of pdata  
     \param out_bounds_box if non-NULL, or's the packed letters bounding boxes
@@ -385,7 +390,6 @@ public:
                      BBox *out_bounds_box) const
   {
     WRATHassert(item_group.valid());
-    WRATHassert(index_group.valid());
     WRATHAttributeStore::DataSink attribute_sink(item_group.attribute_store()->data_sink());
     WRATHIndexGroupAllocator::DataSink idx_sink(index_group.data_sink());
     set_attribute_data(R, font, texture_page, 
@@ -426,6 +430,39 @@ public:
   attribute_key(WRATHAttributeStoreKey &attrib_key,
                 int number_custom_data_to_use) const=0;
 
+  /*!\fn const char* glyph_table_sampler_name
+    May be implemented by a derived class whose
+    vertex shader reads data of glyphs from a
+    per-font table, see glyph_table(), to return
+    the name of the sampler of the table. Default
+    implementation is to return NULL, indicating
+    that the packer does not use a table.
+   */
+  virtual
+  const char*
+  glyph_table_sampler_name(void) const
+  {
+    return NULL;
+  }
+
+  /*!\fn WRATHTextureChoice::texture_base::handle glyph_table
+    To be implemented by a derived class whose
+    glyph_table_sampler_name() is non-NULL to
+    return the texture holding the table of the
+    glyphs of a font. A text item binds it to the
+    texture unit
+    WRATHFontShaderSpecifier::glyph_table_texture_unit().
+    The table may be filled lazily by set_attribute_data().
+    Default implementation is to return an invalid handle.
+    \param font font of the table
+   */
+  virtual
+  WRATHTextureChoice::texture_base::handle
+  glyph_table(WRATHTextureFont*) const
+  {
+    return WRATHTextureChoice::texture_base::handle();
+  }
+
   /*!\fn unsigned int number_of_characters(range_type<int>, 
                                            const WRATHFormattedTextStream&,
                                            WRATHTextureFont*, int)
@@ -259,8 +259,41 @@ public:
         push_back(*begin);
       }
   }
- 
-  
+
+  /*!\fn void append_utf8
+    Appends UTF8 encoded text, decoding it directly
+    into this WRATHTextData. Runs of ASCII characters
+    are copied without decoding. The decoding matches
+    \ref WRATHUTF8, in particular a badly encoded
+    character is decoded as 0xDC80. The UTF8 must not
+    start with a BOM marker.
+    \param begin pointer to 1st byte of the UTF8 data
+    \param end pointer to one past the last byte of the UTF8 data
+   */
+  void
+  append_utf8(const uint8_t *begin, const uint8_t *end);
+
+  /*!\fn void append_utf32
+    Appends UTF32 encoded text, i.e. character codes,
+    to this WRATHTextData.
+    \param begin pointer to 1st character code
+    \param end pointer to one past the last character code
+   */
+  void
+  append_utf32(const uint32_t *begin, const uint32_t *end);
+
+  /*!\fn void decode_utf8
+    Decodes UTF8 encoded text as in append_utf8(),
+    appending the character codes to an std::vector.
+    \param begin pointer to 1st byte of the UTF8 data
+    \param end pointer to one past the last byte of the UTF8 data
+    \param out_codes std::vector to which to append the character codes
+   */
+  static
+  void
+  decode_utf8(const uint8_t *begin, const uint8_t *end,
+              std::vector<uint32_t> &out_codes);
+
 private:
   std::vector<character> m_data;
 };
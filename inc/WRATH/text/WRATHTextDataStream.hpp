@@ -351,6 +351,58 @@ public:
   void
   append(WRATHTextData::character C);
 
+  /*!\fn void append_utf8(const uint8_t*, const uint8_t*)
+    Append UTF8 encoded text. The text is decoded
+    directly, without going through a stream or a
+    std::locale, into the raw text. If the
+    capitalization mode is not \ref
+    WRATHText::capitalization_as_in_stream, the
+    decoded text is capitalized exactly as text
+    added with append(). The decoding is as
+    in \ref WRATHTextData::append_utf8().
+    \param begin pointer to 1st byte of the UTF8 data
+    \param end pointer to one past the last byte of the UTF8 data
+   */
+  void
+  append_utf8(const uint8_t *begin, const uint8_t *end);
+
+  /*!\fn void append_utf8(const char*, const char*)
+    Provided as a conveniance, equivalent to
+    \code
+    append_utf8(reinterpret_cast<const uint8_t*>(begin),
+                reinterpret_cast<const uint8_t*>(end));
+    \endcode
+    \param begin pointer to 1st byte of the UTF8 data
+    \param end pointer to one past the last byte of the UTF8 data
+   */
+  void
+  append_utf8(const char *begin, const char *end)
+  {
+    append_utf8(reinterpret_cast<const uint8_t*>(begin),
+                reinterpret_cast<const uint8_t*>(end));
+  }
+
+  /*!\fn void append_utf8(const std::string&)
+    Provided as a conveniance, append
+    the UTF8 encoded text of an std::string.
+    \param str UTF8 encoded text
+   */
+  void
+  append_utf8(const std::string &str)
+  {
+    append_utf8(str.data(), str.data() + str.size());
+  }
+
+  /*!\fn void append_utf32
+    Append UTF32 encoded text, i.e. character codes,
+    directly to the raw text. Capitalization is
+    handled as in append_utf8().
+    \param begin pointer to 1st character code
+    \param end pointer to one past the last character code
+   */
+  void
+  append_utf32(const uint32_t *begin, const uint32_t *end);
+
   /*!\fn void set_state
     Absorb current state values of a WRATHStateStream
     \param st WRATHStateStream from which to take the state values 
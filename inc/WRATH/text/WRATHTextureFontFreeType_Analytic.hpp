@@ -32,6 +32,7 @@
 #include "c_array.hpp"
 #include "WRATHTextureFontFreeType.hpp"
 #include "WRATHNew.hpp"
+#include "WRATHMutex.hpp"
 #include "vectorGL.hpp"
 #include "WRATHTextureFontUtil.hpp"
 
@@ -63,6 +64,20 @@
   or if the pixel height is small, rounded glyphs
   look less curvy.
 
+  A WRATHTextureFontFreeType_Analytic can also store
+  its glyphs with an index level (see \ref
+  indexed_generation(bool)), where the glyph is
+  broken into blocks of \ref index_block_size
+  texels in each dimension. Blocks that contain no
+  part of the outline are realized by a single texel
+  shared by all such blocks of the glyph and only the
+  blocks containing the outline are stored at full
+  resolution. The memory used by a font for its glyphs
+  under both layouts is reported by \ref memory_usage().
+  The index is a single level, not a quadtree: a block
+  is either shared or stored at full resolution, so
+  glyphs whose outline touches most blocks save little.
+
   Class is thread safe, i.e. glyphs (of the 
   same font) can be generated on a seperate thread 
   than the rendering thread and multiple glyphs may
@@ -91,6 +106,53 @@ public:
        */
       font_scalability_value=font_is_scalable
     };
+
+  enum
+    {
+      /*!
+        Size in texels of the side of a block
+        of the index level, see \ref
+        indexed_generation(bool).
+       */
+      index_block_size=8
+    };
+
+  /*!\class memory_usage_type
+    A memory_usage_type reports the texture
+    memory used by the glyphs of a
+    WRATHTextureFontFreeType_Analytic under
+    the full resolution layout and under the
+    indexed layout (see \ref indexed_generation(bool)),
+    regardless of which layout the font uses.
+   */
+  class memory_usage_type
+  {
+  public:
+    memory_usage_type(void):
+      m_number_glyphs(0),
+      m_full_layout_bytes(0),
+      m_indexed_layout_bytes(0)
+    {}
+
+    /*!\var m_number_glyphs
+      Number of glyphs generated.
+     */
+    int m_number_glyphs;
+
+    /*!\var m_full_layout_bytes
+      Number of bytes of texture data
+      the glyphs take with the full
+      resolution layout.
+     */
+    size_t m_full_layout_bytes;
+
+    /*!\var m_indexed_layout_bytes
+      Number of bytes of texture data
+      (index and data textures) the glyphs
+      take with the indexed layout.
+     */
+    size_t m_indexed_layout_bytes;
+  };
   
   virtual
   ~WRATHTextureFontFreeType_Analytic();
@@ -215,6 +277,57 @@ public:
   unsigned int
   mipmap_level(void);
 
+  /*!\fn void indexed_generation(bool)
+    Sets if the next created WRATHTextureFontFreeType_Analytic
+    stores its glyphs with an index level. With an index
+    level, each texel of the index texture (RGBA8) covers
+    \ref index_block_size by \ref index_block_size texels
+    of the glyph and gives the location in the data
+    textures of that block. Blocks that are entirely
+    inside or outside of the glyph (and whose neighboring
+    texels are too) are mapped to a single shared texel,
+    thus glyphs with large empty or solid regions (large
+    pixel sizes, CJK glyphs) use much less texture memory
+    at the cost of an additional dependent texture lookup
+    in the fragment shader. The index level is not used
+    if \ref mipmap_level() is non-zero. Default value
+    is false.
+    \param v value to use
+   */
+  static
+  void
+  indexed_generation(bool v);
+
+  /*!\fn bool indexed_generation(void)
+    Gets if the next created WRATHTextureFontFreeType_Analytic
+    stores its glyphs with an index level,
+    see \ref indexed_generation(bool).
+    Default value is false.
+   */
+  static
+  bool
+  indexed_generation(void);
+
+  /*!\fn bool indexed
+    Returns true if this WRATHTextureFontFreeType_Analytic
+    stores its glyphs with an index level,
+    see \ref indexed_generation(bool).
+   */
+  bool
+  indexed(void) const
+  {
+    return m_indexed;
+  }
+
+  /*!\fn memory_usage_type memory_usage
+    Returns the texture memory used by the glyphs
+    generated so far by this WRATHTextureFontFreeType_Analytic
+    under both the full resolution and the indexed
+    layout.
+   */
+  memory_usage_type
+  memory_usage(void);
+
   /*!\fn WRATHImage::TextureAllocatorHandle::texture_consumption_data_type texture_consumption
     Returns the texture utilization of all 
     WRATHTextureFontFreeType_Analytic objects.
@@ -249,6 +362,14 @@ private:
   allocate_glyph(std::vector< vecN<std::vector<uint8_t>, number_textures_per_page> > &analytic_pixel_data,
                  const ivec2 &sz);
 
+  void
+  allocate_indexed_glyph(vecN<c_array<uint8_t>, number_textures_per_page> analytic_pixel_data,
+                         const ivec2 &sz,
+                         const boost::multi_array<int, 2> &block_slots,
+                         int number_fine_blocks,
+                         WRATHImage *&out_index_image,
+                         WRATHImage *&out_data_image);
+
   void
   generate_LOD_bitmap(const WRATHFreeTypeSupport::OutlineData &outline_data,
                       const ivec2 &glyph_size,
@@ -260,14 +381,26 @@ private:
 
   float m_new_line_height;
   bool m_generate_sub_quads;
+  bool m_indexed;
   unsigned int m_mipmap_level;
   bool m_is_ttf;
   float m_pow2_mipmap_level;
 
   vecN<int, number_textures_per_page> m_bytes_per_pixel;
   WRATHImage::ImageFormatArray m_format;
+  WRATHImage::ImageFormatArray m_index_format;
 
   WRATHTextureFontUtil::TexturePageTracker m_page_tracker;
+
+  /*
+    m_mutex protects m_memory_usage and
+    m_data_atlas_size, the latter is the 
+    atlas size of the data image of the glyph
+    whose texture page is being fetched.
+   */
+  WRATHMutex m_mutex;
+  memory_usage_type m_memory_usage;
+  ivec2 m_data_atlas_size;
 };
 
 /*! @} */
@@ -80,6 +80,36 @@ public:
       font_scalability_value=font_is_not_scalable
     };
 
+  /*!\enum mipmap_generation_type
+    Enumeration to specify how the mipmap
+    levels of a glyph are created.
+   */
+  enum mipmap_generation_type
+    {
+      /*!
+        Each mipmap level is rendered by FreeType
+        at a reduced pixel size, this is done
+        while holding the lock of the FT_Face.
+       */
+      render_each_mipmap_level,
+
+      /*!
+        Only the base level is rendered by FreeType,
+        each other level is computed by averaging 
+        2x2 blocks of the level above it. Since
+        coverage values are linear, the average
+        is the correct box filter. The averaging is 
+        done without holding the lock of the FT_Face.
+        The first glyphs of each font are checked
+        against re-rendered levels and the font
+        falls back to \ref render_each_mipmap_level
+        if they differ by more than 
+        downsample_tolerance(void), see also
+        downsample_check_glyph_count(void).
+       */
+      downsample_mipmap_levels
+    };
+
   /*!\fn WRATHTextureFontFreeType_Coverage
     Ctor for WRATHTextureFontFreeType_Coverage, it is HIGHLY advised
     to use fetch_font() to create/get fonts from files.
@@ -325,6 +355,124 @@ public:
   void
   mipmap_slacking_threshhold_level(int v);
 
+  /*!\fn enum mipmap_generation_type mipmap_generation(void)
+    Returns how the mipmap levels of glyphs
+    are created. The value is read at construction
+    of a WRATHTextureFontFreeType_Coverage, changing
+    it does not affect fonts already created.
+    Default value is \ref render_each_mipmap_level.
+    
+    Method is thread safe and may be called from
+    multiple threads safely.
+   */
+  static
+  enum mipmap_generation_type
+  mipmap_generation(void);
+
+  /*!\fn void mipmap_generation(enum mipmap_generation_type)
+    Sets how the mipmap levels of glyphs
+    of WRATHTextureFontFreeType_Coverage
+    objects created afterwards are created,
+    see mipmap_generation(void).
+
+    Method is thread safe and may be called from
+    multiple threads safely.
+
+    \param v value to use
+   */
+  static
+  void
+  mipmap_generation(enum mipmap_generation_type v);
+
+  /*!\fn int downsample_tolerance(void)
+    Returns the largest mean absolute difference, 
+    in units of 1/255 of coverage, allowed between
+    mipmap level 1 computed by downsampling and 
+    mipmap level 1 rendered by FreeType for a font
+    to keep \ref downsample_mipmap_levels. A negative
+    value disables the check. The value is read at
+    construction of a WRATHTextureFontFreeType_Coverage.
+    Default value is 12.
+    
+    Method is thread safe and may be called from
+    multiple threads safely.
+   */
+  static
+  int
+  downsample_tolerance(void);
+
+  /*!\fn void downsample_tolerance(int)
+    Sets downsample_tolerance(void).
+
+    Method is thread safe and may be called from
+    multiple threads safely.
+
+    \param v value to use
+   */
+  static
+  void
+  downsample_tolerance(int v);
+
+  /*!\fn int downsample_check_glyph_count(void)
+    Returns the number of glyphs of a font created
+    with \ref downsample_mipmap_levels for which
+    mipmap level 1 is also rendered by FreeType to
+    compare against, see downsample_tolerance(void).
+    Once that many glyphs are checked, a font whose
+    mean difference exceeds downsample_tolerance(void)
+    renders each mipmap level of the glyphs it
+    creates afterwards. The value is read at 
+    construction of a WRATHTextureFontFreeType_Coverage.
+    Default value is 32.
+    
+    Method is thread safe and may be called from
+    multiple threads safely.
+   */
+  static
+  int
+  downsample_check_glyph_count(void);
+
+  /*!\fn void downsample_check_glyph_count(int)
+    Sets downsample_check_glyph_count(void).
+
+    Method is thread safe and may be called from
+    multiple threads safely.
+
+    \param v value to use
+   */
+  static
+  void
+  downsample_check_glyph_count(int v);
+
+  /*!\fn enum mipmap_generation_type font_mipmap_generation(void)
+    Returns how this font creates the mipmap 
+    levels of the glyphs it generates from now on,
+    i.e. the value of mipmap_generation(void) at
+    construction unless the font fell back to
+    \ref render_each_mipmap_level, see 
+    downsample_tolerance(void).
+   */
+  enum mipmap_generation_type
+  font_mipmap_generation(void);
+
+  /*!\fn float mean_downsample_difference(void)
+    Returns the mean absolute difference, in units
+    of 1/255 of coverage, between the downsampled 
+    and the rendered mipmap level 1 of the glyphs
+    checked so far, see downsample_check_glyph_count(void).
+    Returns 0 if no glyph was checked.
+   */
+  float
+  mean_downsample_difference(void);
+
+  /*!\fn int number_downsample_checked_glyphs(void)
+    Returns the number of glyphs of this font
+    whose downsampled mipmap level 1 was compared
+    against a rendered mipmap level 1.
+   */
+  int
+  number_downsample_checked_glyphs(void);
+
   /*!\fn WRATHImage::TextureAllocatorHandle::texture_consumption_data_type texture_consumption
     Returns the texture utilization of all 
     WRATHTextureFontFreeType_Coverage objects.
@@ -355,6 +503,13 @@ private:
     void
     create_pixel_data(ivec2 sz);
 
+    void
+    downsample(const glyph_mipmap_level &src);
+
+    void
+    accumulate_difference(const glyph_mipmap_level &rendered,
+                          int64_t &sum, int &count) const;
+
     const ivec2&
     size(void)
     {
@@ -398,6 +553,10 @@ private:
   GLenum m_minification_filter, m_magnification_filter;
   bool m_use_mipmaps;
   int m_mipmap_deepness_concern;
+  enum mipmap_generation_type m_mipmap_generation;
+  int m_downsample_tolerance, m_downsample_check_glyph_count;
+  int m_downsample_glyphs_checked, m_downsample_pixels_checked;
+  int64_t m_downsample_difference;
 
   WRATHTextureFontUtil::TexturePageTracker m_page_tracker;
  
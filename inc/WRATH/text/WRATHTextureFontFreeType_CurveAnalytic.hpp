@@ -51,7 +51,10 @@
   others. Additionally, the texture memory
   usage of a WRATHTextureFontFreeType_CurveAnalytic
   is width*height + M*NumberCurves bytes
-  per glyph. M is:
+  per glyph (there is no indexed layout as in
+  \ref WRATHTextureFontFreeType_Analytic, the
+  width*height part is a single byte per texel
+  already). M is:
   - 22 for non-separate curve storage with no scaling data present 
   - 26 for non-separate curve storage with scaling data present 
   - 15 for separate curve storage with no scaling data present 
@@ -0,0 +1,327 @@
+/*! 
+ * \file WRATHActionQueue.hpp
+ * \brief file WRATHActionQueue.hpp
+ * 
+ * Copyright 2013 by Nomovok Ltd.
+ * 
+ * Contact: info@nomovok.com
+ * 
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ * 
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ * 
+ */
+
+
+#ifndef WRATH_HEADER_ACTION_QUEUE_HPP_
+#define WRATH_HEADER_ACTION_QUEUE_HPP_
+
+#include "WRATHConfig.hpp"
+#include <new>
+#include <vector>
+#include <stdint.h>
+#include <boost/utility.hpp>
+#include "WRATHNew.hpp"
+#include "WRATHassert.hpp"
+#include "WRATHMutex.hpp"
+#include "WRATHatomic.hpp"
+
+/*! \addtogroup Utility
+ * @{
+ */
+
+/*!\class WRATHActionQueue
+  A WRATHActionQueue is a multi-producer, single
+  consumer queue of actions. Any thread may add
+  actions with schedule() and a single thread
+  executes them with execute_actions().
+
+  Adding an action does not lock a mutex and does
+  not allocate from the heap for small actions:
+  the action object is copied into a chunk of
+  storage owned by the queue, a slot in the chunk
+  being reserved with a single atomic add. Only
+  when a chunk is full does a producer take the
+  chunk free-list mutex to fetch a new chunk.
+  Actions whose size is too large to be stored
+  inline are allocated on the heap with \ref WRATHNew
+  and a small forwarding action is stored inline.
+
+  Actions are executed in the order in which their
+  slots were reserved. Actions scheduled while
+  execute_actions() is running (including those
+  added by actions that execute_actions() runs)
+  are executed on the next call to execute_actions().
+ */
+class WRATHActionQueue:boost::noncopyable
+{
+public:
+
+  /*!\fn WRATHActionQueue
+    Ctor.
+   */
+  WRATHActionQueue(void);
+
+  /*!\fn ~WRATHActionQueue
+    Dtor. Actions that were scheduled but not
+    executed are destroyed without being executed.
+   */
+  ~WRATHActionQueue();
+
+  /*!\fn void schedule(const T&)
+    Schedule an action, thread safe and may
+    be called from any thread.
+    \tparam T functor class that must be copyable and provides
+              the method operator() to execute its action(s)
+    \param v functor object to execute
+   */
+  template<typename T>
+  void
+  schedule(const T &v)
+  {
+    enum
+      {
+        room=record_room<action<T> >::value,
+        max_room=max_inline_record_size
+      };
+    schedule_implement<T>(v, inline_tag<(room<=max_room)>());
+  }
+
+  /*!\fn int execute_actions
+    Execute all the actions that have been
+    scheduled, returning the number of actions
+    executed. May only be called from one thread,
+    the consumer thread of the WRATHActionQueue.
+   */
+  int
+  execute_actions(void);
+
+  /*!\fn bool empty
+    Returns true if there are no actions
+    waiting to be executed. May only be called
+    from the consumer thread of the WRATHActionQueue.
+   */
+  bool
+  empty(void);
+
+private:
+
+  class base_action
+  {
+  public:
+    virtual
+    ~base_action(void)
+    {}
+
+    virtual
+    void
+    execute(void)=0;
+  };
+
+  template<typename T>
+  class action:public base_action
+  {
+  public:
+    T m_value;
+
+    explicit
+    action(const T &v):
+      m_value(v)
+    {}
+
+    virtual
+    void
+    execute(void)
+    {
+      m_value();
+    }
+  };
+
+  /*
+    action stored inline for actions too
+    large to be stored inline.
+   */
+  class heap_action:public base_action
+  {
+  public:
+    base_action *m_ptr;
+
+    explicit
+    heap_action(base_action *p):
+      m_ptr(p)
+    {}
+
+    ~heap_action()
+    {
+      WRATHDelete(m_ptr);
+    }
+
+    virtual
+    void
+    execute(void)
+    {
+      m_ptr->execute();
+    }
+  };
+
+  template<bool>
+  class inline_tag
+  {};
+
+  enum
+    {
+      /*
+        size of storage of a single chunk
+       */
+      chunk_size=4096,
+
+      /*
+        all records are aligned to and a multiple of
+        record_alignment bytes, a record header takes
+        record_alignment bytes
+       */
+      record_alignment=16,
+
+      /*
+        records larger than this are placed
+        on the heap instead.
+       */
+      max_inline_record_size=chunk_size/4
+    };
+
+  enum record_state
+    {
+      /* slot is reserved but not yet written */
+      record_pending=0,
+
+      /* slot holds an action to execute */
+      record_action=1,
+
+      /* the chunk has no more records after this slot */
+      record_end_of_chunk=2
+    };
+
+  class record_header
+  {
+  public:
+    uint32_t m_size;
+    int m_state;
+  };
+
+  /*
+    number of bytes a record of an object
+    of type S takes
+   */
+  template<typename S>
+  class record_room
+  {
+  public:
+    enum
+      {
+        value=record_alignment
+        + ((sizeof(S) + record_alignment - 1) & ~(record_alignment - 1))
+      };
+  };
+
+  class chunk
+  {
+  public:
+    /*
+      m_data first so that it has the
+      alignment that WRATHNew gives.
+     */
+    char m_data[chunk_size];
+    uint32_t m_reserved;
+    chunk *m_next;
+
+    chunk(void);
+
+    void
+    reset(void);
+
+    record_header*
+    header(uint32_t offset)
+    {
+      WRATHassert(offset + record_alignment<=chunk_size);
+      return reinterpret_cast<record_header*>(m_data + offset);
+    }
+
+    static
+    base_action*
+    payload(record_header *h)
+    {
+      return reinterpret_cast<base_action*>(reinterpret_cast<char*>(h) + record_alignment);
+    }
+  };
+
+  template<typename T>
+  void
+  schedule_implement(const T &v, inline_tag<true>)
+  {
+    record_header *h;
+
+    h=reserve_record(record_room<action<T> >::value);
+    ::new(chunk::payload(h)) action<T>(v);
+    publish_record(h, record_action);
+  }
+
+  template<typename T>
+  void
+  schedule_implement(const T &v, inline_tag<false>)
+  {
+    record_header *h;
+    base_action *ptr;
+
+    ptr=WRATHNew action<T>(v);
+    h=reserve_record(record_room<heap_action>::value);
+    ::new(chunk::payload(h)) heap_action(ptr);
+    publish_record(h, record_action);
+  }
+
+  record_header*
+  reserve_record(uint32_t sz);
+
+  void
+  publish_record(record_header *h, enum record_state st);
+
+  chunk*
+  fetch_chunk(void);
+
+  void
+  recycle_retired_chunks(void);
+
+  static
+  int
+  wait_record(record_header *h);
+
+  /*
+    producer side: chunk into which
+    records are reserved and number
+    of producers within reserve_record()
+    and publish_record().
+   */
+  chunk *m_tail;
+  int m_active_producers;
+
+  /*
+    consumer side, only touched by the
+    consumer thread
+   */
+  chunk *m_head;
+  uint32_t m_read;
+  std::vector<chunk*> m_retired;
+
+  /*
+    free list of chunks
+   */
+  WRATHMutex m_free_chunks_mutex;
+  std::vector<chunk*> m_free_chunks;
+};
+
+/*! @} */
+
+#endif
@@ -0,0 +1,184 @@
+/*! 
+ * \file WRATHFrameSignal.hpp
+ * \brief file WRATHFrameSignal.hpp
+ * 
+ * Copyright 2013 by Nomovok Ltd.
+ * 
+ * Contact: info@nomovok.com
+ * 
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ * 
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ * 
+ */
+
+
+#ifndef WRATH_HEADER_FRAME_SIGNAL_HPP_
+#define WRATH_HEADER_FRAME_SIGNAL_HPP_
+
+#include "WRATHConfig.hpp"
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/utility.hpp>
+#include "WRATHReferenceCountedObject.hpp"
+#include "WRATHMutex.hpp"
+#include "WRATHatomic.hpp"
+
+/*! \addtogroup Utility
+ * @{
+ */
+
+/*!\class WRATHFrameSignal
+  A WRATHFrameSignal is a light weight signal
+  (in the sense of boost::signals2) intended for
+  signals that are emitted every frame to many
+  slots, such as those of \ref WRATHTripleBufferEnabler.
+  The slots are held in a plain array sorted by
+  group order and emitting the signal is a walk
+  over that array. 
+
+  Connecting and disconnecting are thread safe and
+  may be done while the signal is emitted:
+  - a slot connected during an emission of the
+    signal is first called at the next emission.
+  - a slot disconnected is never called after
+    \ref connection::disconnect() returns (unless the
+    slot is executing at that moment in another
+    thread); its storage is reclaimed at the next
+    emission.
+
+  Emitting the signal is NOT reentrant: a given
+  WRATHFrameSignal may only be emitted from one
+  thread at a time and a slot may not emit the 
+  signal that called it.
+ */
+class WRATHFrameSignal:boost::noncopyable
+{
+private:
+  class slot_record;
+
+public:
+  /*!\typedef slot_type
+    Type for the functor of a slot
+   */
+  typedef boost::function<void ()> slot_type;
+
+  /*!\class connection
+    A connection represents a slot connected
+    to a WRATHFrameSignal, and is used to 
+    disconnect the slot.
+   */
+  class connection
+  {
+  public:
+    /*!\fn connection(void)
+      Ctor. Initializes the connection
+      as not connected to any slot.
+     */
+    connection(void)
+    {}
+
+    /*!\fn void disconnect
+      Disconnect the slot, may be called from 
+      any thread and may be called more than once.
+     */
+    void
+    disconnect(void) const;
+
+    /*!\fn bool connected
+      Returns true if the slot is still connected.
+     */
+    bool
+    connected(void) const;
+
+  private:
+    friend class WRATHFrameSignal;
+
+    explicit
+    connection(slot_record *r):
+      m_record(r)
+    {}
+
+    WRATHReferenceCountedObject::handle_t<slot_record> m_record;
+  };
+
+  /*!\fn WRATHFrameSignal
+    Ctor.
+   */
+  WRATHFrameSignal(void);
+
+  ~WRATHFrameSignal();
+
+  /*!\fn connection connect
+    Connect a slot to the signal.
+    \param subscriber functor to call
+    \param gp_order slots connected with a lower gp_order 
+                    are called before slots connected with
+                    a higher gp_order. Slots with the same
+                    gp_order are called in the order they 
+                    were connected
+   */
+  connection
+  connect(const slot_type &subscriber, int gp_order=0);
+
+  /*!\fn void operator()(void)
+    Emit the signal, i.e. call each of the
+    connected slots.
+   */
+  void
+  operator()(void);
+
+private:
+
+  class slot_record:
+    public WRATHReferenceCountedObjectT<slot_record>
+  {
+  public:
+    slot_record(const slot_type &s, int gp_order):
+      m_slot(s),
+      m_gp_order(gp_order),
+      m_connected(1)
+    {}
+
+    slot_type m_slot;
+    int m_gp_order;
+    int m_connected;
+  };
+
+  typedef slot_record::handle record_handle;
+
+  class compare_gp_order
+  {
+  public:
+    bool
+    operator()(const record_handle &lhs, const record_handle &rhs) const
+    {
+      return lhs->m_gp_order<rhs->m_gp_order;
+    }
+  };
+
+  void
+  merge_pending_slots(void);
+
+  /*
+    slots in the order they are called,
+    only accessed by the emitting thread.
+   */
+  std::vector<record_handle> m_slots;
+  std::vector<record_handle> m_scratch;
+
+  /*
+    slots added but not yet in m_slots
+   */
+  WRATHMutex m_pending_mutex;
+  std::vector<record_handle> m_pending;
+  int m_has_pending;
+};
+
+/*! @} */
+
+#endif
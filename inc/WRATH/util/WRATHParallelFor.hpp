@@ -0,0 +1,109 @@
+/*! 
+ * \file WRATHParallelFor.hpp
+ * \brief file WRATHParallelFor.hpp
+ * 
+ * Copyright 2013 by Nomovok Ltd.
+ * 
+ * Contact: info@nomovok.com
+ * 
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ * 
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ * 
+ */
+
+
+#ifndef WRATH_HEADER_PARALLEL_FOR_HPP_
+#define WRATH_HEADER_PARALLEL_FOR_HPP_
+
+#include "WRATHConfig.hpp"
+#include <boost/utility.hpp>
+
+/*! \addtogroup Utility
+ * @{
+ */
+
+/*!\class WRATHParallelFor
+  WRATHParallelFor runs a job over each index
+  of a range [0, N) from several threads. The
+  calling thread also executes indices and
+  run() returns only once every index has been
+  executed. Indices are handed out one at a
+  time, so jobs whose indices take very 
+  different amounts of time still balance
+  across the threads. Threads are created for
+  each call to run(), as such WRATHParallelFor
+  is meant for jobs where each index is a
+  substantial amount of work (for example 
+  tessellating one outline of a path).
+ */
+class WRATHParallelFor:boost::noncopyable
+{
+public:
+  /*!\class Job
+    A Job is the interface for the work
+    done by WRATHParallelFor::run(). 
+   */
+  class Job
+  {
+  public:
+    virtual
+    ~Job()
+    {}
+
+    /*!\fn void execute(int)
+      To be implemented by a derived class
+      to do the work for one index. The method
+      is called from several threads simultaneously
+      with different indices, as such an
+      implementation must be thread safe.
+      \param i index of the work to perform
+     */
+    virtual
+    void
+    execute(int i)=0;
+  };
+
+  /*!\fn void run(Job&, int)
+    Execute Job::execute(int) of a Job
+    for each index in the range [0, count).
+    If count is less than two or if 
+    max_number_threads() is one, the job is
+    executed from the calling thread only.
+    \param job Job to execute
+    \param count number of indices
+   */
+  static
+  void
+  run(Job &job, int count);
+
+  /*!\fn int max_number_threads(void)
+    Returns the maximum number of threads, 
+    including the calling thread, that run()
+    uses. Default value is the number of 
+    processors online.
+   */
+  static
+  int
+  max_number_threads(void);
+
+  /*!\fn void max_number_threads(int)
+    Sets the maximum number of threads, 
+    including the calling thread, that run()
+    uses. A value of one makes run() 
+    execute all work from the calling thread.
+    \param v value, values less than one are 
+             clamped to one
+   */
+  static
+  void
+  max_number_threads(int v);
+};
+
+/*! @} */
+
+#endif
@@ -0,0 +1,184 @@
+/*! 
+ * \file WRATHProfiler.hpp
+ * \brief file WRATHProfiler.hpp
+ * 
+ * Copyright 2013 by Nomovok Ltd.
+ * 
+ * Contact: info@nomovok.com
+ * 
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ * 
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ * 
+ */
+
+
+#ifndef WRATH_HEADER_PROFILER_HPP_
+#define WRATH_HEADER_PROFILER_HPP_
+
+#include "WRATHConfig.hpp"
+#include <iostream>
+#include <stdint.h>
+#include <boost/utility.hpp>
+
+/*! \addtogroup Utility
+ * @{
+ */
+
+/*!\namespace WRATHProfiler
+  The WRATHProfiler namespace provides a light weight
+  profiler of CPU time. Code is instrumented with
+  \ref WRATHProfileZone, which records the time at
+  which the enclosing scope is entered and left. Each
+  thread records its zones into its own ring buffer
+  (of \ref ring_buffer_size zones), so recording a zone
+  does not lock a mutex. The recorded zones can be
+  written as Chrome trace JSON (to be viewed with
+  chrome://tracing) with write_chrome_trace() or as
+  a summary table with write_summary().
+
+  Zones are only recorded if WRATH is built with
+  WRATH_ENABLE_PROFILER defined (set USE_PROFILER
+  to 1 in Makefile.settings); otherwise \ref
+  WRATHProfileZone expands to nothing and the
+  functions of WRATHProfiler report no zones.
+ */
+namespace WRATHProfiler
+{
+  enum
+    {
+      /*!
+        Number of zones each thread can hold
+        before its oldest zones are overwritten.
+       */
+      ring_buffer_size=1<<14
+    };
+
+  /*!\fn uint64_t time_ns
+    Returns the time in nanoseconds since
+    an arbitary fixed point in the past,
+    using a monotonic clock.
+   */
+  uint64_t
+  time_ns(void);
+
+  /*!\fn void record_zone
+    Record a zone in the ring buffer of the
+    calling thread. Usually called by
+    \ref scoped_zone rather than directly.
+    \param name name of zone, the pointer is saved, thus
+                the string must stay alive until the zone
+                is written or cleared, typically a string
+                literal
+    \param begin_ns start time of zone as returned by time_ns()
+    \param end_ns end time of zone as returned by time_ns()
+   */
+  void
+  record_zone(const char *name, uint64_t begin_ns, uint64_t end_ns);
+
+  /*!\fn void enabled(bool)
+    Set if zones are recorded, default is true.
+    Has no effect if WRATH_ENABLE_PROFILER was
+    not defined when WRATH was built.
+    \param v new value
+   */
+  void
+  enabled(bool v);
+
+  /*!\fn bool enabled(void)
+    Returns true if zones are recorded.
+   */
+  bool
+  enabled(void);
+
+  /*!\fn void thread_name
+    Set the name of the calling thread as
+    it appears in the output of write_chrome_trace().
+    \param name name of the thread, the string is copied.
+   */
+  void
+  thread_name(const char *name);
+
+  /*!\fn void clear
+    Discard all zones recorded so far.
+   */
+  void
+  clear(void);
+
+  /*!\fn void write_chrome_trace
+    Write the recorded zones of all threads as
+    Chrome trace JSON. May be called from any thread,
+    a zone that is being overwritten as it is read
+    is dropped.
+    \param ostr stream to which to write
+   */
+  void
+  write_chrome_trace(std::ostream &ostr);
+
+  /*!\fn void write_summary
+    Write for each zone name the number of times
+    the zone was recorded and the total, mean,
+    minimum and maximum time of the zone,
+    sorted by total time. May be called from
+    any thread.
+    \param ostr stream to which to write
+   */
+  void
+  write_summary(std::ostream &ostr);
+
+  /*!\class scoped_zone
+    A scoped_zone records a zone covering
+    its lifetime. Usually created with \ref
+    WRATHProfileZone rather than directly.
+   */
+  class scoped_zone:boost::noncopyable
+  {
+  public:
+    /*!\fn scoped_zone
+      Ctor.
+      \param name name of zone, see record_zone()
+     */
+    explicit
+    scoped_zone(const char *name):
+      m_name(enabled()? name : NULL),
+      m_begin(m_name!=NULL ? time_ns() : 0)
+    {}
+
+    ~scoped_zone()
+    {
+      if(m_name!=NULL)
+        {
+          record_zone(m_name, m_begin, time_ns());
+        }
+    }
+
+  private:
+    const char *m_name;
+    uint64_t m_begin;
+  };
+}
+
+#define WRATHProfileZoneConcatImplement(X, Y) X##Y
+#define WRATHProfileZoneConcat(X, Y) WRATHProfileZoneConcatImplement(X, Y)
+
+/*!\def WRATHProfileZone
+  Record the time spent from the point of the macro
+  to the end of the enclosing scope as a zone of
+  \ref WRATHProfiler. If WRATH_ENABLE_PROFILER is
+  not defined, expands to nothing.
+  \param name name of zone, must be a string literal
+ */
+#ifdef WRATH_ENABLE_PROFILER
+  #define WRATHProfileZone(name) \
+    WRATHProfiler::scoped_zone WRATHProfileZoneConcat(wrath_profile_zone_, __LINE__)(name)
+#else
+  #define WRATHProfileZone(name)
+#endif
+
+/*! @} */
+
+#endif
@@ -124,6 +124,17 @@ public:
 
   virtual
   ~WRATHReferenceCountedObject();
+
+  /*!\fn int reference_count
+    Returns the number of handles referencing
+    this object. If handles are copied or released
+    by other threads the value may already be stale
+    when returned; a value of 1 returned to the
+    holder of a handle means that handle is the
+    only one and no other thread can create another.
+   */
+  int
+  reference_count(void) const;
   
   /*!\class handle_t
     Handle class for WRATHReferenceCountedObject,
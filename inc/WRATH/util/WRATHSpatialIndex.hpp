@@ -0,0 +1,244 @@
+/*! 
+ * \file WRATHSpatialIndex.hpp
+ * \brief file WRATHSpatialIndex.hpp
+ * 
+ * Copyright 2013 by Nomovok Ltd.
+ * 
+ * Contact: info@nomovok.com
+ * 
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ * 
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ * 
+ */
+
+
+#ifndef WRATH_HEADER_SPATIAL_INDEX_HPP_
+#define WRATH_HEADER_SPATIAL_INDEX_HPP_
+
+#include "WRATHConfig.hpp"
+#include <vector>
+#include <boost/utility.hpp>
+#include "WRATHassert.hpp"
+#include "WRATHBBox.hpp"
+#include "vectorGL.hpp"
+
+/*! \addtogroup Utility
+ * @{
+ */
+
+/*!\class WRATHSpatialIndex
+  A WRATHSpatialIndex is a dynamic bounding box
+  tree of 2D rectangles, each rectangle having
+  an opaque user pointer. It supports adding,
+  removing and moving rectangles and querying
+  all rectangles that intersect a rectangle or
+  contain a point in O(log N + K) time,
+  K being the number of rectangles returned.
+
+  Each rectangle is stored enlarged by a margin
+  (see \ref WRATHSpatialIndex(float)) in the tree,
+  so that moving a rectangle by less than the
+  margin does not change the tree. The tree is
+  kept balanced by rotations on insertion and
+  removal.
+
+  A WRATHSpatialIndex is not thread safe.
+ */
+class WRATHSpatialIndex:boost::noncopyable
+{
+public:
+  /*!\typedef BBox
+    Type of the rectangles of a WRATHSpatialIndex.
+   */
+  typedef WRATHBBox<2, float> BBox;
+
+  /*!\fn WRATHSpatialIndex
+    Ctor.
+    \param margin amount by which to enlarge each
+                  rectangle in the tree, a larger
+                  value makes move() cheaper but
+                  queries more expensive
+   */
+  explicit
+  WRATHSpatialIndex(float margin=0.0f);
+
+  /*!\fn int add
+    Add a rectangle, returning an ID for the
+    rectangle. The ID is valid until the rectangle
+    is removed with remove().
+    \param box rectangle to add, may not be empty
+    \param user_data pointer value to associate to the rectangle
+   */
+  int
+  add(const BBox &box, void *user_data);
+
+  /*!\fn void remove
+    Remove a rectangle.
+    \param id ID of rectangle as returned by add()
+   */
+  void
+  remove(int id);
+
+  /*!\fn bool move
+    Change the rectangle of an ID. Returns true
+    if the tree was changed, i.e. if the new
+    rectangle is not contained in the enlarged
+    rectangle stored in the tree.
+    \param id ID of rectangle as returned by add()
+    \param box new value of the rectangle, may not be empty
+   */
+  bool
+  move(int id, const BBox &box);
+
+  /*!\fn void* user_data
+    Returns the user pointer of a rectangle.
+    \param id ID of rectangle as returned by add()
+   */
+  void*
+  user_data(int id) const
+  {
+    WRATHassert(is_leaf(id));
+    return m_nodes[id].m_user_data;
+  }
+
+  /*!\fn BBox bbox
+    Returns the rectangle of an ID.
+    \param id ID of rectangle as returned by add()
+   */
+  BBox
+  bbox(int id) const
+  {
+    WRATHassert(is_leaf(id));
+    return BBox(m_nodes[id].m_exact_min, m_nodes[id].m_exact_max);
+  }
+
+  /*!\fn int size
+    Returns the number of rectangles.
+   */
+  int
+  size(void) const
+  {
+    return m_size;
+  }
+
+  /*!\fn void clear
+    Remove all rectangles.
+   */
+  void
+  clear(void);
+
+  /*!\fn void query(const BBox&, std::vector<int>&) const
+    Append to a std::vector the ID's of all rectangles
+    that intersect a rectangle.
+    \param box rectangle to query against
+    \param out location to which to append the ID's
+   */
+  void
+  query(const BBox &box, std::vector<int> &out) const;
+
+  /*!\fn void query(const vec2&, std::vector<int>&) const
+    Append to a std::vector the ID's of all rectangles
+    that contain a point.
+    \param pt point to query against
+    \param out location to which to append the ID's
+   */
+  void
+  query(const vec2 &pt, std::vector<int> &out) const
+  {
+    query(BBox(pt, pt), out);
+  }
+
+  /*!\fn int height
+    Returns the height of the tree, an empty
+    tree has height -1 and a tree with a single
+    rectangle has height 0.
+   */
+  int
+  height(void) const
+  {
+    return (m_root==null_node)?
+      -1:
+      m_nodes[m_root].m_height;
+  }
+
+private:
+
+  enum
+    {
+      null_node=-1
+    };
+
+  class node
+  {
+  public:
+    /*
+      bounding box of node, for leaves
+      it is enlarged by m_margin
+     */
+    vec2 m_min, m_max;
+
+    /*
+      exact box of leaves
+     */
+    vec2 m_exact_min, m_exact_max;
+
+    /*
+      m_parent is the next free node
+      if the node is on the free list
+     */
+    int m_parent;
+    int m_child[2];
+
+    /*
+      0 for leaves, -1 for free nodes
+     */
+    int m_height;
+    void *m_user_data;
+
+    bool
+    leaf(void) const
+    {
+      return m_child[0]==null_node;
+    }
+  };
+
+  bool
+  is_leaf(int id) const
+  {
+    return id>=0
+      and id<static_cast<int>(m_nodes.size())
+      and m_nodes[id].m_height==0;
+  }
+
+  int
+  allocate_node(void);
+
+  void
+  free_node(int id);
+
+  void
+  insert_leaf(int leaf);
+
+  void
+  remove_leaf(int leaf);
+
+  int
+  balance(int a);
+
+  void
+  refit_ancestors(int id);
+
+  float m_margin;
+  int m_root, m_free_list, m_size;
+  std::vector<node> m_nodes;
+  mutable std::vector<int> m_stack;
+};
+
+/*! @} */
+
+#endif
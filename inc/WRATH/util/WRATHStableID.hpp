@@ -0,0 +1,124 @@
+/*! 
+ * \file WRATHStableID.hpp
+ * \brief file WRATHStableID.hpp
+ * 
+ * Copyright 2013 by Nomovok Ltd.
+ * 
+ * Contact: info@nomovok.com
+ * 
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ * 
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ * 
+ */
+
+
+#ifndef WRATH_HEADER_STABLE_ID_HPP_
+#define WRATH_HEADER_STABLE_ID_HPP_
+
+#include "WRATHConfig.hpp"
+#include <vector>
+#include <boost/utility.hpp>
+#include "WRATHMutex.hpp"
+
+/*! \addtogroup Utility
+ * @{
+ */
+
+/*!\class WRATHStableIDPool
+  A WRATHStableIDPool hands out small non-negative
+  integer ID's. An ID released back to the pool is
+  reused, and the smallest released ID is always
+  reused first. Hence the ID's stay small (bounded
+  by the largest number of ID's alive at any one time)
+  and, for a fixed sequence of acquire() and release() 
+  calls, the ID's are the same from run to run, in 
+  contrast to pointer values. Thread safe.
+ */
+class WRATHStableIDPool:boost::noncopyable
+{
+public:
+  /*!\fn WRATHStableIDPool
+    Ctor.
+   */
+  WRATHStableIDPool(void):
+    m_next(0)
+  {}
+
+  /*!\fn int acquire
+    Returns an ID not currently in use.
+   */
+  int
+  acquire(void);
+
+  /*!\fn void release
+    Return an ID to the pool.
+    \param v ID to return, must have been 
+             returned by acquire() and not
+             yet released.
+   */
+  void
+  release(int v);
+
+private:
+  WRATHMutex m_mutex;
+  std::vector<int> m_free;
+  int m_next;
+};
+
+/*!\class WRATHStableID
+  A WRATHStableID is an object holding an ID
+  from a WRATHStableIDPool, one pool per tag type. 
+  The ID is acquired at construction and released 
+  at destruction. Intended to be placed as a member
+  of a class to give its objects small ID's that 
+  can be used in place of pointer values to build
+  compact and deterministic sort keys.
+  \tparam Tag type to select the pool, typically
+              the class which has the WRATHStableID
+              as a member.
+ */
+template<typename Tag>
+class WRATHStableID:boost::noncopyable
+{
+public:
+  /*!\fn WRATHStableID
+    Ctor, acquires an ID.
+   */
+  WRATHStableID(void):
+    m_value(pool().acquire())
+  {}
+
+  ~WRATHStableID()
+  {
+    pool().release(m_value);
+  }
+
+  /*!\fn int value
+    Returns the ID.
+   */
+  int
+  value(void) const
+  {
+    return m_value;
+  }
+
+private:
+  static
+  WRATHStableIDPool&
+  pool(void)
+  {
+    static WRATHStableIDPool R;
+    return R;
+  }
+
+  int m_value;
+};
+
+/*! @} */
+
+#endif
@@ -29,6 +29,8 @@
 #include "WRATHNew.hpp"
 #include "WRATHassert.hpp"
 #include "WRATHMutex.hpp"
+#include "WRATHActionQueue.hpp"
+#include "WRATHFrameSignal.hpp"
 
 /*! \addtogroup Utility
  * @{
@@ -112,18 +114,21 @@ class WRATHTripleBufferEnabler:
 public:
   /*!\typedef signal_t
     Conveniance typedef for the signal type.
+    The signals are emitted every frame to 
+    many slots, hence they are \ref WRATHFrameSignal
+    objects rather than boost::signals2 signals.
    */
-  typedef boost::signals2::signal<void ()> signal_t;
+  typedef WRATHFrameSignal signal_t;
 
   /*!\typedef connect_t
     Conveniance typedef for the connection type.
    */
-  typedef boost::signals2::connection connect_t;
+  typedef WRATHFrameSignal::connection connect_t;
 
   /*!\enum signal_time
     The methods signal_begin_presentation_frame()
     and signal_complete_simulation_frame() each emit
-    4 signals (in the boost::signals2 sense) that
+    4 signals (see \ref WRATHFrameSignal) 
     to which one can connect, the enumeration type
     signal_time enumerates the when of each signal.
     The operations performed are as follows:
@@ -305,8 +310,8 @@ public:
                       are guaranteed to be called before slots 
                       connected with a higher (for a fixed 
                       signal_type-signal_time pair). Slots
-                      in the same gp_order have no guarantee
-                      of which is called first.
+                      in the same gp_order are called in the
+                      order they were connected.
     */
     connect_t
     connect(enum signal_type tp,
@@ -581,8 +586,10 @@ public:
                     are guaranteed to be called before slots 
                     connected with a higher (for a fixed 
                     signal_type-signal_time pair). Slots
-                    in the same gp_order have no guarantee
-                    of which is called first.
+                    in the same gp_order are called in the
+                    order they were connected. Slots connected
+                    while the signal is emitted are first
+                    called on the next emission.
    */
   connect_t
   connect(enum signal_type tp,
@@ -686,12 +693,7 @@ public:
   void
   schedule_rendering_action(const T &v)
   {
-    base_action *ptr;
-
-    ptr=create_action<T>(v);
-    WRATHLockMutex(m_render_actions_mutex);
-    m_render_actions.push_back(ptr);
-    WRATHUnlockMutex(m_render_actions_mutex);
+    m_render_actions.schedule<T>(v);
   }
 
   /*!\fn void schedule_simulation_action(const T&)  
@@ -708,12 +710,7 @@ public:
   void
   schedule_simulation_action(const T &v)
   {
-    base_action *ptr;
-
-    ptr=create_action<T>(v);
-    WRATHLockMutex(m_simulation_actions_mutex);
-    m_simulation_actions.push_back(ptr);
-    WRATHUnlockMutex(m_simulation_actions_mutex);
+    m_simulation_actions.schedule<T>(v);
   }
 
   /*!\fn int purge_cleanup
@@ -735,50 +732,6 @@ public:
 
 private:
 
-  /*
-    private class magic to allow one to use boost::bind
-    to name operations to be executed
-   */
-  class base_action
-  {
-  public:
-    virtual
-    ~base_action(void)
-    {}
-
-    virtual
-    void
-    execute(void)=0;
-  };
-
-  template<typename T>
-  class action:public base_action
-  {
-  public:
-    T m_value;
-
-    action(const T &v):
-      m_value(v)
-    {}
-
-    virtual
-    void
-    execute(void)
-    {
-      m_value();
-    }
-  };
-
-
-  template<typename T>
-  static
-  base_action*
-  create_action(const T &v)
-  {
-    return WRATHNew action<T>(v);
-  }
-
-  
   class PhasedDeletedObjectEntry
   {
   public:
@@ -799,25 +752,17 @@ private:
   };
 
 
-  static
-  void
-  do_actions(std::list<base_action*> &actions,
-             WRATHMutex &mutex);
-
-  
   void
   fire_signal(signal_t &sig);
 
   std::list<PhasedDeletedObjectEntry> m_phase0, m_phase1, m_phase2;
-  std::list<base_action*> m_render_actions;
-  std::list<base_action*> m_simulation_actions;  
+  WRATHActionQueue m_render_actions;
+  WRATHActionQueue m_simulation_actions;  
   vecN<vecN<signal_t, number_signal_time_enums>, number_signal_type_enums> m_sigs;
 
   bool m_purging;
   WRATHMutex m_mutex;
   WRATHMutex m_phase_mutex;
-  WRATHMutex m_render_actions_mutex;
-  WRATHMutex m_simulation_actions_mutex;
   int m_present_ID;
   int m_last_simulation_ID;
   int m_current_simulation_ID;
@@ -218,7 +218,12 @@ namespace WRATHUtil
   filename_fullpath(const std::string &S);
   
   /*!\fn void convert_to_halfp_from_float_raw(void*, const void*, int)
-    Converts from 32bit-floats to 16bit-floats.
+    Converts from 32bit-floats to 16bit-floats, rounding
+    to nearest even. The conversion is vectorized with the
+    F16C instructions (x86) or NEON (ARM) when the compiler
+    targets them and is otherwise branch free, thus it is
+    intended for converting large arrays at once, for
+    example when packing attribute data.
 
     \param dest destination to which to write 16bit-floats
     \param src source from which to read 32bit-floats
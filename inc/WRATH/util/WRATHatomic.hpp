@@ -47,14 +47,57 @@
   \param Y how much to add to X
  */
 
+/*!\def WRATHAtomicLoad
+  Atomic load with acquire semantics, i.e.
+  reads made after the load are not reordered
+  to before the load.
+  \param X pointer to value to read
+ */
+
+/*!\def WRATHAtomicStore
+  Atomic store with release semantics, i.e.
+  writes made before the store are visible
+  to any thread that reads the stored value
+  with \ref WRATHAtomicLoad.
+  \param X pointer to value to write
+  \param Y value to write
+ */
+
+/*!\def WRATHAtomicCompareAndSwap
+  Atomic compare and swap. Atomic version of
+  \code
+  if(*X==Y)
+    {
+      *X=Z;
+      return true;
+    }
+  return false;
+  \endcode
+  \param X pointer to value to affect
+  \param Y value that *X is expected to have
+  \param Z value to write to *X if *X is Y
+ */
+
+/*!\def WRATHAtomicFence
+  Full memory barrier, no reads or writes are
+  reordered across the barrier.
+ */
+
 #if __GNUC__>4 || (__GNUC__>=4 && __GNUC_MINOR__>=7)
   #define WRATHAtomicAddAndFetch(X, Y) __atomic_add_fetch((X),  (Y), __ATOMIC_SEQ_CST)
   #define WRATHAtomicSubtractAndFetch(X, Y) __atomic_sub_fetch((X),  (Y), __ATOMIC_SEQ_CST)
+  #define WRATHAtomicLoad(X) __atomic_load_n((X), __ATOMIC_ACQUIRE)
+  #define WRATHAtomicStore(X, Y) __atomic_store_n((X), (Y), __ATOMIC_RELEASE)
+  #define WRATHAtomicCompareAndSwap(X, Y, Z) __sync_bool_compare_and_swap((X), (Y), (Z))
 #else  
   #define WRATHAtomicAddAndFetch(X, Y) __sync_add_and_fetch((X),  (Y))
   #define WRATHAtomicSubtractAndFetch(X, Y) __sync_sub_and_fetch((X),  (Y))
+  #define WRATHAtomicLoad(X) __sync_fetch_and_add((X), 0)
+  #define WRATHAtomicStore(X, Y) do { __sync_synchronize(); *(X)=(Y); __sync_synchronize(); } while(0)
+  #define WRATHAtomicCompareAndSwap(X, Y, Z) __sync_bool_compare_and_swap((X), (Y), (Z))
 #endif
 
+#define WRATHAtomicFence() __sync_synchronize()
 
 /*! @} */
 
@@ -20,6 +20,8 @@
 
 #include "WRATHConfig.hpp"
 #include "FURYQtEvent.hpp"
+#include "FURYEventQueue.hpp"
+#include <boost/bind.hpp>
 #include <QEvent>
 #include <QKeyEvent>
 #include <QMouseEvent>
@@ -37,8 +39,11 @@ namespace
       m_handle_all(false),
       m_accept_auto_repeat(false),
       m_text_mode(false),
-      m_delta_non_zero(false)
-    {}
+      m_delta_non_zero(false),
+      m_coalesce(false)
+    {
+      m_queue.connect(boost::bind(&FilterState::forward_event, this, _1));
+    }
 
     void
     capture_all(bool v)
@@ -58,6 +63,22 @@ namespace
       m_text_mode=v;
     }
 
+    void
+    enable_coalescing(bool v)
+    {
+      if(!v)
+        {
+          m_queue.dispatch();
+        }
+      m_coalesce=v;
+    }
+
+    void
+    dispatch_events(void)
+    {
+      m_queue.dispatch();
+    }
+
     void
     process_event(QEvent *ev);
 
@@ -84,6 +105,25 @@ namespace
         }
     }
 
+    void
+    forward_event(FURYEvent::handle h)
+    {
+      m_sig(h);
+    }
+
+    void
+    emit_event(FURYEvent::handle h)
+    {
+      if(m_coalesce)
+        {
+          m_queue.push(h);
+        }
+      else
+        {
+          m_sig(h);
+        }
+    }
+
     FURYEvent::handle
     make_touch_pt(const QTouchEvent::TouchPoint &in_pt);
 
@@ -96,6 +136,8 @@ namespace
     bool m_accept_auto_repeat;
     bool m_text_mode;
     bool m_delta_non_zero;
+    bool m_coalesce;
+    FURYEventQueue m_queue;
   };
 
   vec2
@@ -150,10 +192,19 @@ handle_touch_event(QTouchEvent *ev)
     {
       FURYEvent::handle h;
 
+      if(m_coalesce and iter->state()==Qt::TouchPointMoved)
+        {
+          m_queue.push_touch_motion(FURYTouchID(iter->id()),
+                                    make_vec2(iter->pos()),
+                                    make_vec2(iter->pos()) - make_vec2(iter->lastPos()),
+                                    iter->pressure());
+          continue;
+        }
+
       h=make_touch_pt(*iter);
       if(h.valid())
         {
-          m_sig(h);
+          emit_event(h);
         }
     }
 }
@@ -202,7 +253,13 @@ process_event(QEvent *ev)
       default:
         if(m_handle_all)
           {
-            h=WRATHNew FURYQT::UnknownEvent(ev);
+            /*
+              Qt deletes the QEvent, so the held 
+              events go out first and the UnknownEvent
+              is signaled immediately.
+             */
+            m_queue.dispatch();
+            m_sig(WRATHNew FURYQT::UnknownEvent(ev));
           }
       break;
 
@@ -218,8 +275,16 @@ process_event(QEvent *ev)
       {
         QMouseEvent *qev(static_cast<QMouseEvent*>(ev));
 
-        h=WRATHNew FURYMouseMotionEvent( ivec2(qev->x(), qev->y()),
-                                         compute_delta(qev->x(), qev->y()) );
+        if(m_coalesce)
+          {
+            m_queue.push_mouse_motion(ivec2(qev->x(), qev->y()),
+                                      compute_delta(qev->x(), qev->y()));
+          }
+        else
+          {
+            h=WRATHNew FURYMouseMotionEvent( ivec2(qev->x(), qev->y()),
+                                             compute_delta(qev->x(), qev->y()) );
+          }
         m_delta_non_zero=true;
         m_last_mouse_position=ivec2(qev->x(), qev->y());
       }
@@ -238,7 +303,7 @@ process_event(QEvent *ev)
         h=WRATHNew FURYMouseButtonEvent(qev->button(),
                                         ivec2(qev->x(), qev->y()),
                                         true);
-        m_sig(h);
+        emit_event(h);
 
         h=WRATHNew FURYMouseButtonEvent(qev->button(),
                                         ivec2(qev->x(), qev->y()),
@@ -324,7 +389,7 @@ process_event(QEvent *ev)
 
   if(h.valid())
     {
-      m_sig(h);
+      emit_event(h);
     }
 
 }
@@ -399,6 +464,24 @@ enable_text_mode(bool v)
 }
 
 
+void
+FURYQT::EventProducer::
+enable_coalescing(bool v)
+{
+  FilterState *d(FILTER(m_state));
+  
+  d->enable_coalescing(v);
+}
+
+void
+FURYQT::EventProducer::
+dispatch_events(void)
+{
+  FilterState *d(FILTER(m_state));
+  
+  d->dispatch_events();
+}
+
 void
 FURYQT::EventProducer::
 capture_all(bool v)
@@ -22,6 +22,8 @@
 #include "FURYSDLEvent.hpp"
 #include "FURYJoystickEvent.hpp"
 #include "FURYTextEvent.hpp"
+#include "FURYEventQueue.hpp"
+#include <boost/bind.hpp>
 
 namespace
 {
@@ -34,9 +36,30 @@ namespace
       m_text_mode(false),
       m_repeat_enabled(false),
       m_repeat_delay(1),
-      m_repeat_interval(1)
+      m_repeat_interval(1),
+      m_coalesce(false)
     {
       //SDL_EnableUNICODE(0);
+      m_queue.connect(boost::bind(&sdl_fury_event_state::forward_event, this, _1));
+    }
+
+    void
+    forward_event(FURYEvent::handle h)
+    {
+      m_sig(h);
+    }
+
+    void
+    emit_event(FURYEvent::handle h)
+    {
+      if(m_coalesce)
+        {
+          m_queue.push(h);
+        }
+      else
+        {
+          m_sig(h);
+        }
     }
 
     FURYSDL::EventProducer::signal_t m_sig;
@@ -45,6 +68,8 @@ namespace
     bool m_text_mode;
     bool m_repeat_enabled;
     int m_repeat_delay, m_repeat_interval;
+    bool m_coalesce;
+    FURYEventQueue m_queue;
   };
 
   sdl_fury_event_state&
@@ -224,9 +249,22 @@ feed_event(const SDL_Event *ev)
 
     case SDL_MOUSEMOTION:
       {
-        h=WRATHNew FURYMouseMotionEvent(ivec2(ev->motion.x, ev->motion.y),
-                                        ivec2(ev->motion.xrel, ev->motion.yrel),
-                                        FURYMouse(ev->motion.which));
+        if(st(m_state).m_coalesce)
+          {
+            /*
+              queue the motion by value, a FURYEvent
+              is made only for the merged motion
+             */
+            st(m_state).m_queue.push_mouse_motion(ivec2(ev->motion.x, ev->motion.y),
+                                                  ivec2(ev->motion.xrel, ev->motion.yrel),
+                                                  FURYMouse(ev->motion.which));
+          }
+        else
+          {
+            h=WRATHNew FURYMouseMotionEvent(ivec2(ev->motion.x, ev->motion.y),
+                                            ivec2(ev->motion.xrel, ev->motion.yrel),
+                                            FURYMouse(ev->motion.which));
+          }
       }
       break;
 
@@ -306,7 +344,7 @@ feed_event(const SDL_Event *ev)
 
   if(h.valid())
     {
-      st(m_state).m_sig(h);
+      st(m_state).emit_event(h);
     }
 }
 
@@ -337,6 +375,24 @@ enable_text_mode(bool v)
 }
 
 
+void
+FURYSDL::EventProducer::
+enable_coalescing(bool v)
+{
+  if(!v)
+    {
+      st(m_state).m_queue.dispatch();
+    }
+  st(m_state).m_coalesce=v;
+}
+
+void
+FURYSDL::EventProducer::
+dispatch_events(void)
+{
+  st(m_state).m_queue.dispatch();
+}
+
 FURYSDL::EventProducer::connect_t
 FURYSDL::EventProducer::
 connect(const slot_type &subscriber)
@@ -0,0 +1,248 @@
+/*! 
+ * \file FURYEventQueue.cpp
+ * \brief file FURYEventQueue.cpp
+ * 
+ * Copyright 2013 by Nomovok Ltd.
+ * 
+ * Contact: info@nomovok.com
+ * 
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ * 
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ * 
+ */
+
+
+#include "WRATHConfig.hpp"
+#include "FURYEventQueue.hpp"
+
+////////////////////////////////////////
+// FURYEventQueue methods
+FURYEventQueue::
+FURYEventQueue(void):
+  m_coalesce(true),
+  m_in_dispatch(false),
+  m_number_coalesced(0)
+{}
+
+FURYEventQueue::connect_t
+FURYEventQueue::
+connect(const slot_type &subscriber)
+{
+  return m_sig.connect(subscriber);
+}
+
+FURYEvent::handle
+FURYEventQueue::
+make_event(const entry &e)
+{
+  switch(e.m_type)
+    {
+    default:
+    case event_entry:
+      return e.m_event;
+
+    case mouse_motion_entry:
+      {
+        ivec2 pt(static_cast<int>(e.m_position.x()), static_cast<int>(e.m_position.y()));
+        ivec2 delta(static_cast<int>(e.m_delta.x()), static_cast<int>(e.m_delta.y()));
+        FURYMouseMotionEvent *ev;
+
+        ev=m_mouse_motion_arena.reuse();
+        if(ev!=NULL)
+          {
+            ev->ignore();
+            ev->m_pt=pt;
+            ev->m_delta=delta;
+            ev->m_mouse=FURYMouse(e.m_pointer);
+          }
+        else
+          {
+            ev=WRATHNew FURYMouseMotionEvent(pt, delta, FURYMouse(e.m_pointer));
+            m_mouse_motion_arena.add(ev);
+          }
+        return ev;
+      }
+
+    case touch_motion_entry:
+      {
+        FURYTouchEvent *ev;
+
+        ev=m_touch_motion_arena.reuse();
+        if(ev!=NULL)
+          {
+            ev->ignore();
+            ev->m_position=e.m_position;
+            ev->m_delta=e.m_delta;
+            ev->m_pressure=e.m_pressure;
+            ev->m_id=FURYTouchID(e.m_pointer);
+          }
+        else
+          {
+            ev=WRATHNew FURYTouchEvent(FURYEvent::TouchMotion,
+                                       FURYTouchID(e.m_pointer),
+                                       e.m_position, e.m_delta, e.m_pressure);
+            m_touch_motion_arena.add(ev);
+          }
+        return ev;
+      }
+    }
+}
+
+FURYEventQueue::entry*
+FURYEventQueue::
+find_motion_entry(enum entry_type tp, int pointer)
+{
+  if(!m_coalesce)
+    {
+      return NULL;
+    }
+
+  /*
+    walk back over the motion events queued
+    since the last event that is not a motion
+    event; those are the only events a motion
+    event may merge with without changing its
+    order relative to the other events.
+   */
+  for(std::vector<entry>::reverse_iterator iter=m_pending.rbegin(),
+        end=m_pending.rend(); iter!=end and iter->m_type!=event_entry; ++iter)
+    {
+      if(iter->m_type==tp and iter->m_pointer==pointer)
+        {
+          return &*iter;
+        }
+    }
+  return NULL;
+}
+
+void
+FURYEventQueue::
+push(const FURYEvent::handle &ev)
+{
+  if(!ev.valid())
+    {
+      return;
+    }
+
+  if(ev->type()==FURYEvent::MouseMotion)
+    {
+      FURYMouseMotionEvent::handle m;
+
+      m=ev.dynamic_cast_handle<FURYMouseMotionEvent>();
+      if(m.valid())
+        {
+          push_mouse_motion(m->pt(), m->delta(), m->mouse());
+          return;
+        }
+    }
+  else if(ev->type()==FURYEvent::TouchMotion)
+    {
+      FURYTouchEvent::handle t;
+
+      t=ev.dynamic_cast_handle<FURYTouchEvent>();
+      if(t.valid())
+        {
+          push_touch_motion(t->id(), t->position(), t->delta(), t->pressure());
+          return;
+        }
+    }
+
+  m_pending.push_back(entry());
+  m_pending.back().m_type=event_entry;
+  m_pending.back().m_event=ev;
+}
+
+void
+FURYEventQueue::
+push_mouse_motion(const ivec2 &pt, const ivec2 &delta, FURYMouse mouse)
+{
+  entry *e;
+  vec2 fpt(pt.x(), pt.y()), fdelta(delta.x(), delta.y());
+
+  e=find_motion_entry(mouse_motion_entry, mouse.m_mouse_index);
+  if(e!=NULL)
+    {
+      e->m_position=fpt;
+      e->m_delta+=fdelta;
+      ++m_number_coalesced;
+      return;
+    }
+
+  m_pending.push_back(entry());
+  e=&m_pending.back();
+  e->m_type=mouse_motion_entry;
+  e->m_pointer=mouse.m_mouse_index;
+  e->m_position=fpt;
+  e->m_delta=fdelta;
+  e->m_pressure=0.0f;
+}
+
+void
+FURYEventQueue::
+push_touch_motion(FURYTouchID id,
+                  const vec2 &position, const vec2 &delta,
+                  float pressure)
+{
+  entry *e;
+
+  e=find_motion_entry(touch_motion_entry, id.m_value);
+  if(e!=NULL)
+    {
+      e->m_position=position;
+      e->m_delta+=delta;
+      e->m_pressure=pressure;
+      ++m_number_coalesced;
+      return;
+    }
+
+  m_pending.push_back(entry());
+  e=&m_pending.back();
+  e->m_type=touch_motion_entry;
+  e->m_pointer=id.m_value;
+  e->m_position=position;
+  e->m_delta=delta;
+  e->m_pressure=pressure;
+}
+
+void
+FURYEventQueue::
+dispatch(void)
+{
+  if(m_in_dispatch)
+    {
+      return;
+    }
+
+  /*
+    swap so that events queued by the slots
+    go to the next dispatch; both arrays keep
+    their capacity from frame to frame.
+   */
+  m_in_dispatch=true;
+  std::swap(m_pending, m_dispatching);
+  m_number_coalesced=0;
+  m_mouse_motion_arena.begin_frame();
+  m_touch_motion_arena.begin_frame();
+
+  for(std::vector<entry>::const_iterator iter=m_dispatching.begin(),
+        end=m_dispatching.end(); iter!=end; ++iter)
+    {
+      m_sig(make_event(*iter));
+    }
+
+  m_dispatching.clear();
+  m_in_dispatch=false;
+}
+
+void
+FURYEventQueue::
+clear(void)
+{
+  m_pending.clear();
+  m_number_coalesced=0;
+}
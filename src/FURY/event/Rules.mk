@@ -4,7 +4,7 @@ dirstack_$(sp)	:= $(d)
 d		:= $(dir)
 # End standard header
 
-LIB_SOURCES += $(call filelist, FURYEvent.cpp)
+LIB_SOURCES += $(call filelist, FURYEvent.cpp FURYEventQueue.cpp)
 
 # Begin standard footer
 d		:= $(dirstack_$(sp))
@@ -35,6 +35,11 @@ operator<(const WRATHAttributeStoreKey &rhs) const
       return m_buffer_object_hint<rhs.m_buffer_object_hint;
     }
 
+  if(m_stream_buffer_count!=rhs.m_stream_buffer_count)
+    {
+      return m_stream_buffer_count<rhs.m_stream_buffer_count;
+    }
+
   if(m_index_bit_count!=rhs.m_index_bit_count)
     {
       return m_index_bit_count<rhs.m_index_bit_count;
@@ -50,6 +55,11 @@ operator<(const WRATHAttributeStoreKey &rhs) const
       return m_type_size < rhs.m_type_size;
     }
 
+  if(m_instance_vertex_count!=rhs.m_instance_vertex_count)
+    {
+      return m_instance_vertex_count < rhs.m_instance_vertex_count;
+    }
+
   if(m_attribute_format_location!=rhs.m_attribute_format_location)
     {
       return m_attribute_format_location<rhs.m_attribute_format_location;
@@ -66,8 +76,10 @@ operator==(const WRATHAttributeStoreKey &rhs) const
   //WRATHassert(rhs.m_type!=NULL);
 
   return m_buffer_object_hint==rhs.m_buffer_object_hint
+    and m_stream_buffer_count==rhs.m_stream_buffer_count
     and m_index_bit_count==rhs.m_index_bit_count
     and m_type_size==rhs.m_type_size
+    and m_instance_vertex_count==rhs.m_instance_vertex_count
     and m_attribute_format_location==rhs.m_attribute_format_location;
 }
 
@@ -379,6 +391,7 @@ WRATHAttributeStore(const WRATHAttributeStoreKey &pkey,
   m_vertex_buffer=WRATHNew WRATHBufferAllocator(m_allocator->triple_buffer_enabler(),
                                                 m_buffer_object_hint, 
                                                 bo_end_byte);
+  m_vertex_buffer->buffer_object()->stream_buffer_count(m_key.m_stream_buffer_count);
 
   
 
@@ -394,6 +407,23 @@ WRATHAttributeStore(const WRATHAttributeStoreKey &pkey,
       m_attribute_format_location[I]=m_implicit_attribute_format[K];
     }
 
+  if(m_key.m_instance_vertex_count>0)
+    {
+      /*
+        each element is an instance, thus every 
+        attribute, including the implicit ones,
+        advances once per instance.
+       */
+      for(int I=0; I<WRATHDrawCallSpec::attribute_count; ++I)
+        {
+          if(m_attribute_format_location[I].valid()
+             and m_attribute_format_location[I].m_divisor==0)
+            {
+              m_attribute_format_location[I].m_divisor=1;
+            }
+        }
+    }
+
   WRATHassert(proxy_attribute_allocate(1)==routine_success);
 
   if(allocate_implicit_attribute_data)
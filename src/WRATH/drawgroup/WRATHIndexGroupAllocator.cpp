@@ -86,6 +86,40 @@ append_draw_elements(std::vector<index_range> &output)
     }
 }
 
+int
+WRATHIndexGroupAllocator::DrawCommand::
+instance_vertex_count(void)
+{
+  return m_src->attribute_store()->instance_vertex_count();
+}
+
+/////////////////////////////////////////////
+// WRATHIndexGroupAllocator::instance_group methods
+range_type<int>
+WRATHIndexGroupAllocator::instance_group::
+range(void) const
+{
+  WRATHassert(valid());
+  return m_data->m_range;
+}
+
+void
+WRATHIndexGroupAllocator::instance_group::
+delete_group(void)
+{
+  WRATHassert(valid());
+
+  /*
+    make sure the handle m_source does not
+    go out of scope until after 
+    deallocate_instance_group_implement()
+    returns:
+  */
+  WRATHIndexGroupAllocator::handle s(m_data->m_source);
+  s->deallocate_instance_group_implement(m_data);
+  m_data=NULL;
+}
+
 /////////////////////////////////////////////////
 //WRATHIndexGroupAllocator methods
 WRATHIndexGroupAllocator::
@@ -120,12 +154,13 @@ WRATHIndexGroupAllocator::
   
   #ifdef WRATHDEBUG  
   {  
-    if(!m_index_chunks.empty())
+    if(!m_index_chunks.empty() or !m_instance_chunks.empty())
       {
         WRATHwarning("[" << this << "]"
                      << m_index_buffer 
                      << ": Warning: not all index data de-allocated! "
-                     << m_index_chunks.size() << " index groups remain");
+                     << m_index_chunks.size() << " index groups and "
+                     << m_instance_chunks.size() << " instance groups remain");
       }
   }
   #endif
@@ -165,6 +200,42 @@ deallocate_group_implement(index_chunk *p)
   WRATHUnlockMutex(m_mutex);
 }
 
+void
+WRATHIndexGroupAllocator::
+deallocate_instance_group_implement(index_chunk *p)
+{
+  WRATHLockMutex(m_mutex);
+
+  WRATHassert(p!=NULL);
+  m_instance_chunks.erase(p->m_range.m_begin);
+  m_draw_ranges_dirty=true;
+  WRATHPhasedDelete(p);
+
+  WRATHUnlockMutex(m_mutex);
+}
+
+WRATHIndexGroupAllocator::instance_group
+WRATHIndexGroupAllocator::
+allocate_instance_group(range_type<int> attribute_range)
+{
+  WRATHassert(m_attribute_store->instance_vertex_count()>0);
+  if(attribute_range.m_end<=attribute_range.m_begin)
+    {
+      return instance_group();
+    }
+
+  WRATHAutoLockMutex(m_mutex);
+
+  index_chunk *G;
+  G=WRATHNew index_chunk(this, attribute_range.m_begin,
+                         attribute_range.m_end - attribute_range.m_begin);
+  WRATHassert(m_instance_chunks.find(G->m_range.m_begin)==m_instance_chunks.end());
+  m_instance_chunks[G->m_range.m_begin]=G;
+  m_draw_ranges_dirty=true;
+
+  return instance_group(G);
+}
+
 WRATHIndexGroupAllocator::index_chunk*
 WRATHIndexGroupAllocator::
 allocate_index_group_implement(int number_elements)
@@ -194,7 +265,7 @@ WRATHIndexGroupAllocator::
 empty(void) const
 {
   WRATHAutoLockMutex(m_mutex);
-  return m_index_chunks.empty();
+  return m_index_chunks.empty() and m_instance_chunks.empty();
 }
 
 void
@@ -205,11 +276,22 @@ update_draw_ranges(void)
   if(m_draw_ranges_dirty)
     {
       int last_end(-1);
+      bool instanced(m_attribute_store->instance_vertex_count()>0);
+      /*
+        for instancing the ranges are of attribute
+        elements (i.e. instances) rather than indices
+        and a range location is an element rather than
+        a byte offset.
+       */
+      const std::map<int, index_chunk*> &chunks((instanced)?
+                                                m_instance_chunks:
+                                                m_index_chunks);
+      int location_factor((instanced)?1:index_type_size());
 
       m_draw_ranges.clear();
-      for(std::map<int, index_chunk*>::iterator 
-            iter=m_index_chunks.begin(),
-            end=m_index_chunks.end();
+      for(std::map<int, index_chunk*>::const_iterator 
+            iter=chunks.begin(),
+            end=chunks.end();
           iter!=end; ++iter)
         {
           const index_chunk *chunk(iter->second);
@@ -224,11 +306,11 @@ update_draw_ranges(void)
             {
               WRATHDrawCommand::index_range V;
 
-              last_end=R.m_end;
-              V.m_location=index_type_size()*R.m_begin;
+              V.m_location=location_factor*R.m_begin;
               V.m_count=count;
               m_draw_ranges.push_back(V);
             }
+          last_end=R.m_end;
         }
       m_draw_ranges_dirty=false;
     }
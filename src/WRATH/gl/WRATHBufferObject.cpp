@@ -19,8 +19,10 @@
 
 #include "WRATHConfig.hpp"
 #include <iostream>
+#include <algorithm>
 #include "WRATHBufferObject.hpp"
 #include "WRATHStaticInit.hpp"
+#include "WRATHProfiler.hpp"
 
 namespace
 {
@@ -51,7 +53,9 @@ WRATHBufferObject(const WRATHTripleBufferEnabler::handle &h,
   m_buffer_object_size_in_bytes(0),
   m_virtual_size(0),
   m_cache_size(0),
-  m_mutex(pmutex)
+  m_mutex(pmutex),
+  m_stream_buffer_count(0),
+  m_stream_index(0)
 {
 }
 
@@ -66,7 +70,13 @@ void
 WRATHBufferObject::
 phase_render_deletion(void)
 {
-  if(m_name!=0)
+  if(!m_stream_names.empty())
+    {
+      glDeleteBuffers(m_stream_names.size(), &m_stream_names[0]);
+      m_stream_names.clear();
+      m_name=0;
+    }
+  else if(m_name!=0)
     {
       glDeleteBuffers(1, &m_name);
       m_name=0;
@@ -192,6 +202,8 @@ bool
 WRATHBufferObject::
 flush_no_lock(GLenum bind_target)
 {
+  WRATHProfileZone("WRATHBufferObject::flush");
+
   if(m_usage==GL_INVALID_ENUM)
     {
       return false;
@@ -199,10 +211,31 @@ flush_no_lock(GLenum bind_target)
 
   if(m_name==0)
     {
-      glGenBuffers(1, &m_name);
+      if(m_stream_buffer_count>1)
+        {
+          /*
+            start at the last buffer so that
+            the first upload goes to the first
+            buffer.
+           */
+          m_stream_names.resize(m_stream_buffer_count, 0);
+          m_stream_sizes.resize(m_stream_buffer_count, 0);
+          glGenBuffers(m_stream_buffer_count, &m_stream_names[0]);
+          m_stream_index=m_stream_buffer_count-1;
+          m_name=m_stream_names[m_stream_index];
+        }
+      else
+        {
+          glGenBuffers(1, &m_name);
+        }
       WRATHassert(m_name!=0);
     }
 
+  if(m_stream_buffer_count>0)
+    {
+      return flush_streaming_no_lock(bind_target);
+    }
+
   bool bounded(false);
 
   
@@ -249,6 +282,61 @@ flush_no_lock(GLenum bind_target)
   return bounded;
 }
 
+bool
+WRATHBufferObject::
+flush_streaming_no_lock(GLenum bind_target)
+{
+  if(!is_dirty_no_lock())
+    {
+      return false;
+    }
+
+  WRATHLockMutex(sm_total_bytes_uploaded_mutex());
+  sm_total_bytes_uploaded()+=m_cache_size;
+  WRATHUnlockMutex(sm_total_bytes_uploaded_mutex());
+
+  if(m_stream_buffer_count==1)
+    {
+      /*
+        orphan the current store so that the upload
+        does not wait on draws still reading from it.
+       */
+      glBindBuffer(bind_target, m_name);
+      glBufferData(bind_target, m_cache_size, NULL, m_usage);
+      if(m_cache_size>0)
+        {
+          glBufferSubData(bind_target, 0, m_cache_size, raw_data_pointer());
+        }
+    }
+  else
+    {
+      /*
+        upload to the next buffer of the ring,
+        the draws of the previous frames use
+        the other buffers of the ring.
+       */
+      m_stream_index=(m_stream_index+1)%m_stream_buffer_count;
+      m_name=m_stream_names[m_stream_index];
+      glBindBuffer(bind_target, m_name);
+
+      if(m_cache_size>m_stream_sizes[m_stream_index])
+        {
+          m_stream_sizes[m_stream_index]=m_cache_size;
+          glBufferData(bind_target, m_cache_size, raw_data_pointer(), m_usage);
+        }
+      else if(m_cache_size>0)
+        {
+          glBufferSubData(bind_target, 0, m_cache_size, raw_data_pointer());
+        }
+    }
+
+  m_buffer_object_size_in_bytes=std::max(m_buffer_object_size_in_bytes, m_cache_size);
+  m_dirty=false;
+  m_dirty_blocks.clear();
+
+  return true;
+}
+
 
 void
 WRATHBufferObject::
@@ -267,6 +355,14 @@ mark_bytes_dirty_no_lock(int begin_byte_location, int end_byte_location)
 
       m_dirty=true;
 
+      if(m_stream_buffer_count>0)
+        {
+          /*
+            a streaming buffer uploads all of
+            its contents on flush.
+           */
+          return;
+        }
       
       /*
         TODO:
@@ -30,6 +30,7 @@
 #include "WRATHUtil.hpp"
 #include "WRATHShaderSourceResource.hpp"
 #include "WRATHGPUConfig.hpp"
+#include "WRATHGLStateShadow.hpp"
 
 namespace
 {
@@ -975,6 +976,7 @@ WRATHGLProgram::
   if(m_name)
     {
       glDeleteProgram(m_name);
+      WRATHGLStateShadow::program_deleted(m_name);
     }
   m_dtor_signal();
   resource_manager().remove_resource(this);
@@ -1285,7 +1287,7 @@ use_program(void)
       return;
     }
 
-  glUseProgram(m_name);
+  WRATHGLStateShadow::use_program(m_name);
   for(std::vector<WRATHGLProgramInitializer::const_handle>::const_iterator
         iter=m_initializers.begin(), end=m_initializers.end();
       iter!=end; ++iter)
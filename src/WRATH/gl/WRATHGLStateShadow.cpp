@@ -0,0 +1,891 @@
+/*! 
+ * \file WRATHGLStateShadow.cpp
+ * \brief file WRATHGLStateShadow.cpp
+ * 
+ * Copyright 2013 by Nomovok Ltd.
+ * 
+ * Contact: info@nomovok.com
+ * 
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ * 
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ * 
+ */
+
+
+#include "WRATHConfig.hpp"
+#include <pthread.h>
+#include "WRATHGLStateShadow.hpp"
+#include "WRATHglGet.hpp"
+#include "WRATHStaticInit.hpp"
+
+namespace
+{
+  template<typename T>
+  class tracked_value
+  {
+  public:
+    tracked_value(void):
+      m_known(false)
+    {}
+
+    T m_value;
+    bool m_known;
+  };
+
+  enum tracked_cap_type
+    {
+      blend_cap,
+      depth_test_cap,
+      stencil_test_cap,
+      scissor_test_cap,
+      cull_face_cap,
+      polygon_offset_fill_cap,
+
+      number_tracked_caps
+    };
+
+  class per_face_stencil
+  {
+  public:
+    /*
+      (func, ref, value mask)
+     */
+    tracked_value<vecN<GLint, 3> > m_func;
+
+    /*
+      (sfail, dpfail, dppass)
+     */
+    tracked_value<vecN<GLenum, 3> > m_op;
+    tracked_value<GLuint> m_write_mask;
+
+    WRATHGLStateShadow::stencil_face_state m_return_value;
+  };
+
+  class shadow_data
+  {
+  public:
+    shadow_data(void):
+      m_external_gl_state_changes(false),
+      m_issued(0),
+      m_filtered(0),
+      m_queries(0),
+      m_has_owner(false)
+    {}
+
+    void
+    invalidate(void)
+    {
+      *this=shadow_data(m_external_gl_state_changes,
+                        m_issued, m_filtered, m_queries);
+    }
+
+    template<typename T>
+    bool
+    needs_set(tracked_value<T> &v, const T &value)
+    {
+      if(v.m_known and v.m_value==value)
+        {
+          ++m_filtered;
+          return false;
+        }
+
+      v.m_value=value;
+      v.m_known=true;
+      ++m_issued;
+      return true;
+    }
+
+    template<typename T>
+    void
+    fetch(tracked_value<T> &v, GLenum pname)
+    {
+      if(!v.m_known)
+        {
+          ++m_queries;
+          v.m_value=WRATHglGet<T>(pname);
+          v.m_known=true;
+        }
+    }
+
+    void
+    fetch_enum(tracked_value<GLenum> &v, GLenum pname)
+    {
+      if(!v.m_known)
+        {
+          ++m_queries;
+          v.m_value=WRATHglGet<GLint>(pname);
+          v.m_known=true;
+        }
+    }
+
+    per_face_stencil&
+    stencil(GLenum face)
+    {
+      WRATHassert(face==GL_FRONT or face==GL_BACK);
+      return (face==GL_FRONT)?
+        m_stencil[0]:
+        m_stencil[1];
+    }
+
+    bool m_external_gl_state_changes;
+    unsigned int m_issued, m_filtered, m_queries;
+
+    /*
+      thread that used the shadow since the
+      last invalidate(), only to check the
+      assumption that there is one GL context.
+     */
+    bool m_has_owner;
+    pthread_t m_owner;
+
+    vecN<tracked_value<bool>, number_tracked_caps> m_caps;
+    tracked_value<vecN<GLenum, 4> > m_blend_func;
+    tracked_value<vecN<GLenum, 2> > m_blend_equation;
+    tracked_value<vec4> m_blend_color;
+    tracked_value<vecN<GLboolean, 4> > m_color_mask;
+    tracked_value<vec4> m_clear_color;
+
+    tracked_value<GLenum> m_depth_func;
+    tracked_value<GLboolean> m_depth_mask;
+    tracked_value<float> m_clear_depth;
+    tracked_value<vec2> m_depth_range;
+
+    vecN<per_face_stencil, 2> m_stencil;
+    tracked_value<GLint> m_clear_stencil;
+
+    tracked_value<GLuint> m_fbo;
+    tracked_value<vecN<GLint, 4> > m_viewport;
+    tracked_value<vecN<GLint, 4> > m_scissor;
+
+    tracked_value<vec2> m_polygon_offset;
+    tracked_value<GLenum> m_cull_face;
+    tracked_value<GLenum> m_front_face;
+
+    tracked_value<GLuint> m_program;
+    tracked_value<GLenum> m_active_texture;
+
+  private:
+    shadow_data(bool ext, unsigned int issued,
+                unsigned int filtered, unsigned int queries):
+      m_external_gl_state_changes(ext),
+      m_issued(issued),
+      m_filtered(filtered),
+      m_queries(queries),
+      m_has_owner(false)
+    {}
+  };
+
+  shadow_data&
+  data(void)
+  {
+    WRATHStaticInit();
+    static shadow_data R;
+
+    #ifdef WRATH_ASSERT_ACTIVE
+    {
+      /*
+        the shadow is of one GL context, a use
+        from a different thread without an
+        invalidate() in between means a second
+        context (or a GL call without a current
+        context).
+       */
+      if(!R.m_has_owner)
+        {
+          R.m_has_owner=true;
+          R.m_owner=pthread_self();
+        }
+      WRATHassert(pthread_equal(R.m_owner, pthread_self()));
+    }
+    #endif
+
+    return R;
+  }
+
+  int
+  cap_index(GLenum cap)
+  {
+    switch(cap)
+      {
+      case GL_BLEND:
+        return blend_cap;
+      case GL_DEPTH_TEST:
+        return depth_test_cap;
+      case GL_STENCIL_TEST:
+        return stencil_test_cap;
+      case GL_SCISSOR_TEST:
+        return scissor_test_cap;
+      case GL_CULL_FACE:
+        return cull_face_cap;
+      case GL_POLYGON_OFFSET_FILL:
+        return polygon_offset_fill_cap;
+      default:
+        return -1;
+      }
+  }
+
+  /*
+    returns the faces of a face enumeration
+    that need a GL call, f is a functor taking
+    a per_face_stencil& that returns true if
+    the face needs the call.
+   */
+  template<typename F>
+  GLenum
+  stencil_faces_to_set(GLenum face, F f)
+  {
+    shadow_data &d(data());
+    bool front(false), back(false);
+
+    if(face==GL_FRONT or face==GL_FRONT_AND_BACK)
+      {
+        front=f(d.m_stencil[0]);
+      }
+
+    if(face==GL_BACK or face==GL_FRONT_AND_BACK)
+      {
+        back=f(d.m_stencil[1]);
+      }
+
+    if(front and back)
+      {
+        return GL_FRONT_AND_BACK;
+      }
+    else if(front)
+      {
+        return GL_FRONT;
+      }
+    else if(back)
+      {
+        return GL_BACK;
+      }
+    return GL_NONE;
+  }
+
+  template<typename T>
+  class stencil_setter
+  {
+  public:
+    stencil_setter(tracked_value<T> per_face_stencil::*member,
+                   const T &value):
+      m_member(member),
+      m_value(value)
+    {}
+
+    bool
+    operator()(per_face_stencil &s) const
+    {
+      return data().needs_set(s.*m_member, m_value);
+    }
+
+    tracked_value<T> per_face_stencil::*m_member;
+    T m_value;
+  };
+
+  template<typename T>
+  GLenum
+  set_stencil_value(GLenum face, tracked_value<T> per_face_stencil::*member,
+                    const T &value)
+  {
+    return stencil_faces_to_set(face, stencil_setter<T>(member, value));
+  }
+}
+
+///////////////////////////////////
+// WRATHGLStateShadow methods
+void
+WRATHGLStateShadow::
+invalidate(void)
+{
+  data().invalidate();
+}
+
+bool
+WRATHGLStateShadow::
+external_gl_state_changes(void)
+{
+  return data().m_external_gl_state_changes;
+}
+
+void
+WRATHGLStateShadow::
+external_gl_state_changes(bool v)
+{
+  data().m_external_gl_state_changes=v;
+}
+
+unsigned int
+WRATHGLStateShadow::
+issued_call_count(void)
+{
+  return data().m_issued;
+}
+
+unsigned int
+WRATHGLStateShadow::
+filtered_call_count(void)
+{
+  return data().m_filtered;
+}
+
+unsigned int
+WRATHGLStateShadow::
+query_count(void)
+{
+  return data().m_queries;
+}
+
+void
+WRATHGLStateShadow::
+reset_counters(void)
+{
+  shadow_data &d(data());
+  d.m_issued=d.m_filtered=d.m_queries=0;
+}
+
+void
+WRATHGLStateShadow::
+enable(GLenum cap, bool v)
+{
+  shadow_data &d(data());
+  int I(cap_index(cap));
+
+  if(I!=-1 and !d.needs_set(d.m_caps[I], v))
+    {
+      return;
+    }
+
+  if(v)
+    {
+      glEnable(cap);
+    }
+  else
+    {
+      glDisable(cap);
+    }
+}
+
+bool
+WRATHGLStateShadow::
+is_enabled(GLenum cap)
+{
+  shadow_data &d(data());
+  int I(cap_index(cap));
+
+  if(I==-1)
+    {
+      ++d.m_queries;
+      return glIsEnabled(cap)==GL_TRUE;
+    }
+
+  if(!d.m_caps[I].m_known)
+    {
+      ++d.m_queries;
+      d.m_caps[I].m_value=(glIsEnabled(cap)==GL_TRUE);
+      d.m_caps[I].m_known=true;
+    }
+  return d.m_caps[I].m_value;
+}
+
+void
+WRATHGLStateShadow::
+blend_func_separate(GLenum src_rgb, GLenum dst_rgb,
+                    GLenum src_alpha, GLenum dst_alpha)
+{
+  shadow_data &d(data());
+  if(d.needs_set(d.m_blend_func, vecN<GLenum, 4>(src_rgb, dst_rgb, src_alpha, dst_alpha)))
+    {
+      if(src_rgb==src_alpha and dst_rgb==dst_alpha)
+        {
+          glBlendFunc(src_rgb, dst_rgb);
+        }
+      else
+        {
+          glBlendFuncSeparate(src_rgb, dst_rgb, src_alpha, dst_alpha);
+        }
+    }
+}
+
+vecN<GLenum, 4>
+WRATHGLStateShadow::
+blend_func_separate(void)
+{
+  shadow_data &d(data());
+  if(!d.m_blend_func.m_known)
+    {
+      d.m_queries+=4;
+      d.m_blend_func.m_value=vecN<GLenum, 4>(WRATHglGet<GLint>(GL_BLEND_SRC_RGB),
+                                             WRATHglGet<GLint>(GL_BLEND_DST_RGB),
+                                             WRATHglGet<GLint>(GL_BLEND_SRC_ALPHA),
+                                             WRATHglGet<GLint>(GL_BLEND_DST_ALPHA));
+      d.m_blend_func.m_known=true;
+    }
+  return d.m_blend_func.m_value;
+}
+
+void
+WRATHGLStateShadow::
+blend_equation_separate(GLenum mode_rgb, GLenum mode_alpha)
+{
+  shadow_data &d(data());
+  if(d.needs_set(d.m_blend_equation, vecN<GLenum, 2>(mode_rgb, mode_alpha)))
+    {
+      glBlendEquationSeparate(mode_rgb, mode_alpha);
+    }
+}
+
+vecN<GLenum, 2>
+WRATHGLStateShadow::
+blend_equation_separate(void)
+{
+  shadow_data &d(data());
+  if(!d.m_blend_equation.m_known)
+    {
+      d.m_queries+=2;
+      d.m_blend_equation.m_value=vecN<GLenum, 2>(WRATHglGet<GLint>(GL_BLEND_EQUATION_RGB),
+                                                 WRATHglGet<GLint>(GL_BLEND_EQUATION_ALPHA));
+      d.m_blend_equation.m_known=true;
+    }
+  return d.m_blend_equation.m_value;
+}
+
+void
+WRATHGLStateShadow::
+blend_color(const vec4 &v)
+{
+  shadow_data &d(data());
+  if(d.needs_set(d.m_blend_color, v))
+    {
+      glBlendColor(v[0], v[1], v[2], v[3]);
+    }
+}
+
+const vec4&
+WRATHGLStateShadow::
+blend_color(void)
+{
+  shadow_data &d(data());
+  d.fetch(d.m_blend_color, GL_BLEND_COLOR);
+  return d.m_blend_color.m_value;
+}
+
+void
+WRATHGLStateShadow::
+color_mask(const vecN<GLboolean, 4> &v)
+{
+  shadow_data &d(data());
+  if(d.needs_set(d.m_color_mask, v))
+    {
+      glColorMask(v[0], v[1], v[2], v[3]);
+    }
+}
+
+const vecN<GLboolean, 4>&
+WRATHGLStateShadow::
+color_mask(void)
+{
+  shadow_data &d(data());
+  d.fetch(d.m_color_mask, GL_COLOR_WRITEMASK);
+  return d.m_color_mask.m_value;
+}
+
+void
+WRATHGLStateShadow::
+clear_color(const vec4 &v)
+{
+  shadow_data &d(data());
+  if(d.needs_set(d.m_clear_color, v))
+    {
+      glClearColor(v[0], v[1], v[2], v[3]);
+    }
+}
+
+const vec4&
+WRATHGLStateShadow::
+clear_color(void)
+{
+  shadow_data &d(data());
+  d.fetch(d.m_clear_color, GL_COLOR_CLEAR_VALUE);
+  return d.m_clear_color.m_value;
+}
+
+void
+WRATHGLStateShadow::
+depth_func(GLenum v)
+{
+  shadow_data &d(data());
+  if(d.needs_set(d.m_depth_func, v))
+    {
+      glDepthFunc(v);
+    }
+}
+
+GLenum
+WRATHGLStateShadow::
+depth_func(void)
+{
+  shadow_data &d(data());
+  d.fetch_enum(d.m_depth_func, GL_DEPTH_FUNC);
+  return d.m_depth_func.m_value;
+}
+
+void
+WRATHGLStateShadow::
+depth_mask(GLboolean v)
+{
+  shadow_data &d(data());
+  if(d.needs_set(d.m_depth_mask, v))
+    {
+      glDepthMask(v);
+    }
+}
+
+GLboolean
+WRATHGLStateShadow::
+depth_mask(void)
+{
+  shadow_data &d(data());
+  d.fetch(d.m_depth_mask, GL_DEPTH_WRITEMASK);
+  return d.m_depth_mask.m_value;
+}
+
+void
+WRATHGLStateShadow::
+clear_depth(float v)
+{
+  shadow_data &d(data());
+  if(d.needs_set(d.m_clear_depth, v))
+    {
+      #if defined(WRATH_GL_VERSION)
+        glClearDepth(v);
+      #else
+        glClearDepthf(v);
+      #endif
+    }
+}
+
+float
+WRATHGLStateShadow::
+clear_depth(void)
+{
+  shadow_data &d(data());
+  d.fetch(d.m_clear_depth, GL_DEPTH_CLEAR_VALUE);
+  return d.m_clear_depth.m_value;
+}
+
+void
+WRATHGLStateShadow::
+depth_range(const vec2 &v)
+{
+  shadow_data &d(data());
+  if(d.needs_set(d.m_depth_range, v))
+    {
+      #if defined(WRATH_GL_VERSION)
+        glDepthRange(v[0], v[1]);
+      #else
+        glDepthRangef(v[0], v[1]);
+      #endif
+    }
+}
+
+const vec2&
+WRATHGLStateShadow::
+depth_range(void)
+{
+  shadow_data &d(data());
+  d.fetch(d.m_depth_range, GL_DEPTH_RANGE);
+  return d.m_depth_range.m_value;
+}
+
+void
+WRATHGLStateShadow::
+stencil_func_separate(GLenum face, GLenum func, GLint ref, GLuint mask)
+{
+  GLenum F;
+
+  F=set_stencil_value(face, &per_face_stencil::m_func,
+                      vecN<GLint, 3>(func, ref, mask));
+  if(F!=GL_NONE)
+    {
+      glStencilFuncSeparate(F, func, ref, mask);
+    }
+}
+
+void
+WRATHGLStateShadow::
+stencil_op_separate(GLenum face, GLenum sfail, GLenum dpfail, GLenum dppass)
+{
+  GLenum F;
+
+  F=set_stencil_value(face, &per_face_stencil::m_op,
+                      vecN<GLenum, 3>(sfail, dpfail, dppass));
+  if(F!=GL_NONE)
+    {
+      glStencilOpSeparate(F, sfail, dpfail, dppass);
+    }
+}
+
+void
+WRATHGLStateShadow::
+stencil_mask_separate(GLenum face, GLuint mask)
+{
+  GLenum F;
+
+  F=set_stencil_value(face, &per_face_stencil::m_write_mask, mask);
+  if(F!=GL_NONE)
+    {
+      glStencilMaskSeparate(F, mask);
+    }
+}
+
+const WRATHGLStateShadow::stencil_face_state&
+WRATHGLStateShadow::
+stencil_state(GLenum face)
+{
+  shadow_data &d(data());
+  per_face_stencil &s(d.stencil(face));
+  bool front(face==GL_FRONT);
+
+  if(!s.m_func.m_known)
+    {
+      d.m_queries+=3;
+      s.m_func.m_value=vecN<GLint, 3>(WRATHglGet<GLint>(front?GL_STENCIL_FUNC:GL_STENCIL_BACK_FUNC),
+                                      WRATHglGet<GLint>(front?GL_STENCIL_REF:GL_STENCIL_BACK_REF),
+                                      WRATHglGet<GLint>(front?GL_STENCIL_VALUE_MASK:GL_STENCIL_BACK_VALUE_MASK));
+      s.m_func.m_known=true;
+    }
+
+  if(!s.m_op.m_known)
+    {
+      d.m_queries+=3;
+      s.m_op.m_value=vecN<GLenum, 3>(WRATHglGet<GLint>(front?
+                                                       GL_STENCIL_FAIL:
+                                                       GL_STENCIL_BACK_FAIL),
+                                     WRATHglGet<GLint>(front?
+                                                       GL_STENCIL_PASS_DEPTH_FAIL:
+                                                       GL_STENCIL_BACK_PASS_DEPTH_FAIL),
+                                     WRATHglGet<GLint>(front?
+                                                       GL_STENCIL_PASS_DEPTH_PASS:
+                                                       GL_STENCIL_BACK_PASS_DEPTH_PASS));
+      s.m_op.m_known=true;
+    }
+
+  if(!s.m_write_mask.m_known)
+    {
+      ++d.m_queries;
+      s.m_write_mask.m_value=WRATHglGet<GLint>(front?
+                                               GL_STENCIL_WRITEMASK:
+                                               GL_STENCIL_BACK_WRITEMASK);
+      s.m_write_mask.m_known=true;
+    }
+
+  s.m_return_value.m_func=s.m_func.m_value[0];
+  s.m_return_value.m_ref=s.m_func.m_value[1];
+  s.m_return_value.m_value_mask=s.m_func.m_value[2];
+  s.m_return_value.m_sfail=s.m_op.m_value[0];
+  s.m_return_value.m_dpfail=s.m_op.m_value[1];
+  s.m_return_value.m_dppass=s.m_op.m_value[2];
+  s.m_return_value.m_write_mask=s.m_write_mask.m_value;
+
+  return s.m_return_value;
+}
+
+void
+WRATHGLStateShadow::
+clear_stencil(GLint v)
+{
+  shadow_data &d(data());
+  if(d.needs_set(d.m_clear_stencil, v))
+    {
+      glClearStencil(v);
+    }
+}
+
+GLint
+WRATHGLStateShadow::
+clear_stencil(void)
+{
+  shadow_data &d(data());
+  d.fetch(d.m_clear_stencil, GL_STENCIL_CLEAR_VALUE);
+  return d.m_clear_stencil.m_value;
+}
+
+void
+WRATHGLStateShadow::
+bind_framebuffer(GLuint fbo)
+{
+  shadow_data &d(data());
+  if(d.needs_set(d.m_fbo, fbo))
+    {
+      glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    }
+}
+
+GLuint
+WRATHGLStateShadow::
+bind_framebuffer(void)
+{
+  shadow_data &d(data());
+  if(!d.m_fbo.m_known)
+    {
+      ++d.m_queries;
+      d.m_fbo.m_value=WRATHglGet<GLint>(GL_FRAMEBUFFER_BINDING);
+      d.m_fbo.m_known=true;
+    }
+  return d.m_fbo.m_value;
+}
+
+void
+WRATHGLStateShadow::
+framebuffer_deleted(GLuint fbo)
+{
+  shadow_data &d(data());
+  if(d.m_fbo.m_known and d.m_fbo.m_value==fbo)
+    {
+      d.m_fbo.m_value=0;
+    }
+}
+
+void
+WRATHGLStateShadow::
+viewport(const vecN<GLint, 4> &v)
+{
+  shadow_data &d(data());
+  if(d.needs_set(d.m_viewport, v))
+    {
+      glViewport(v[0], v[1], v[2], v[3]);
+    }
+}
+
+const vecN<GLint, 4>&
+WRATHGLStateShadow::
+viewport(void)
+{
+  shadow_data &d(data());
+  d.fetch(d.m_viewport, GL_VIEWPORT);
+  return d.m_viewport.m_value;
+}
+
+void
+WRATHGLStateShadow::
+scissor(const vecN<GLint, 4> &v)
+{
+  shadow_data &d(data());
+  if(d.needs_set(d.m_scissor, v))
+    {
+      glScissor(v[0], v[1], v[2], v[3]);
+    }
+}
+
+const vecN<GLint, 4>&
+WRATHGLStateShadow::
+scissor(void)
+{
+  shadow_data &d(data());
+  d.fetch(d.m_scissor, GL_SCISSOR_BOX);
+  return d.m_scissor.m_value;
+}
+
+void
+WRATHGLStateShadow::
+polygon_offset(const vec2 &v)
+{
+  shadow_data &d(data());
+  if(d.needs_set(d.m_polygon_offset, v))
+    {
+      glPolygonOffset(v[0], v[1]);
+    }
+}
+
+const vec2&
+WRATHGLStateShadow::
+polygon_offset(void)
+{
+  shadow_data &d(data());
+  if(!d.m_polygon_offset.m_known)
+    {
+      d.m_queries+=2;
+      d.m_polygon_offset.m_value=vec2(WRATHglGet<float>(GL_POLYGON_OFFSET_FACTOR),
+                                      WRATHglGet<float>(GL_POLYGON_OFFSET_UNITS));
+      d.m_polygon_offset.m_known=true;
+    }
+  return d.m_polygon_offset.m_value;
+}
+
+void
+WRATHGLStateShadow::
+cull_face(GLenum v)
+{
+  shadow_data &d(data());
+  if(d.needs_set(d.m_cull_face, v))
+    {
+      glCullFace(v);
+    }
+}
+
+GLenum
+WRATHGLStateShadow::
+cull_face(void)
+{
+  shadow_data &d(data());
+  d.fetch_enum(d.m_cull_face, GL_CULL_FACE_MODE);
+  return d.m_cull_face.m_value;
+}
+
+void
+WRATHGLStateShadow::
+front_face(GLenum v)
+{
+  shadow_data &d(data());
+  if(d.needs_set(d.m_front_face, v))
+    {
+      glFrontFace(v);
+    }
+}
+
+GLenum
+WRATHGLStateShadow::
+front_face(void)
+{
+  shadow_data &d(data());
+  d.fetch_enum(d.m_front_face, GL_FRONT_FACE);
+  return d.m_front_face.m_value;
+}
+
+void
+WRATHGLStateShadow::
+use_program(GLuint program)
+{
+  shadow_data &d(data());
+  if(d.needs_set(d.m_program, program))
+    {
+      glUseProgram(program);
+    }
+}
+
+void
+WRATHGLStateShadow::
+program_deleted(GLuint program)
+{
+  shadow_data &d(data());
+  if(d.m_program.m_known and d.m_program.m_value==program)
+    {
+      d.m_program.m_known=false;
+    }
+}
+
+void
+WRATHGLStateShadow::
+active_texture(GLenum unit)
+{
+  shadow_data &d(data());
+  if(d.needs_set(d.m_active_texture, unit))
+    {
+      glActiveTexture(unit);
+    }
+}
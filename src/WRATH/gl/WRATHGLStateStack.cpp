@@ -19,12 +19,19 @@
 
 #include "WRATHConfig.hpp"
 #include "WRATHGLStateStack.hpp"
-#include "WRATHglGet.hpp"
+#include "WRATHGLStateShadow.hpp"
 #include "WRATHNew.hpp"
 #include "vectorGL.hpp"
 
 namespace
 {
+  /*
+    All state is read from and restored through 
+    WRATHGLStateShadow, thus pushing state does 
+    not query GL for state already known to the 
+    shadow and popping only issues GL calls for 
+    state that changed.
+   */
   class enable_disable_bit
   {
   public:
@@ -32,7 +39,7 @@ namespace
     ~enable_disable_bit();
 
   private:
-    GLboolean m_value;
+    bool m_value;
     GLenum m_enumeration;
 
   };
@@ -48,9 +55,8 @@ namespace
     ~color_buffer_action();
   private:
     enable_disable_bit m_blend_enable;
-    GLint m_blend_src_rgb, m_blend_src_a;
-    GLint m_blend_dest_rgb, m_blend_dest_a;
-    GLint m_blend_equation_rgb, m_blend_equation_a;
+    vecN<GLenum, 4> m_blend_func;
+    vecN<GLenum, 2> m_blend_equation;
     vec4 m_blend_color;  
     vecN<GLboolean, 4> m_color_mask;
     vec4 m_clear_color;
@@ -64,7 +70,7 @@ namespace
 
   private:
     enable_disable_bit m_enable;
-    GLint m_func;
+    GLenum m_func;
     GLfloat m_clear;
     GLboolean m_mask;
   };
@@ -86,9 +92,7 @@ namespace
 
     private:
       GLenum m_face;
-      GLint m_mask;
-      GLint m_func, m_func_mask, m_func_ref;
-      GLint m_sfail, m_dpfail, m_dppass;
+      WRATHGLStateShadow::stencil_face_state m_state;
     };
 
     enable_disable_bit m_enable;
@@ -103,7 +107,7 @@ namespace
     ~rendering_target_action();
 
   private:
-    GLint m_fbo;
+    GLuint m_fbo;
     vecN<GLint,4> m_viewport;
     vec2 m_depth_range;
     enable_disable_bit m_scissor_enable;
@@ -119,10 +123,10 @@ namespace
 
   private:
     enable_disable_bit m_polygon_offset;
-    float m_polygon_offset_factor, m_polygon_offset_units;
+    vec2 m_polygon_offset_values;
     enable_disable_bit m_culling_enabled;
-    GLint m_culling_mode;
-    GLint m_front_face;
+    GLenum m_culling_mode;
+    GLenum m_front_face;
   };
 
   class action_packet:public generic_action
@@ -201,22 +205,14 @@ action_packet(uint32_t flags)
 //enable_disable_bit methods
 enable_disable_bit::
 enable_disable_bit(GLenum enumeration):
+  m_value(WRATHGLStateShadow::is_enabled(enumeration)),
   m_enumeration(enumeration)
-{
-  m_value=glIsEnabled(enumeration);
-}
+{}
 
 enable_disable_bit::
 ~enable_disable_bit()
 {
-  if(m_value==GL_TRUE)
-    {
-      glEnable(m_enumeration);
-    }
-  else
-    {
-      glDisable(m_enumeration);
-    }
+  WRATHGLStateShadow::enable(m_enumeration, m_value);
 }
 
 /////////////////////////////////////////////
@@ -224,28 +220,22 @@ enable_disable_bit::
 color_buffer_action::
 color_buffer_action(void):
   m_blend_enable(GL_BLEND),
-  m_blend_src_rgb(WRATHglGet<GLint>(GL_BLEND_SRC_RGB)),
-  m_blend_src_a(WRATHglGet<GLint>(GL_BLEND_SRC_ALPHA)),
-  m_blend_dest_rgb(WRATHglGet<GLint>(GL_BLEND_DST_RGB)),
-  m_blend_dest_a(WRATHglGet<GLint>(GL_BLEND_DST_ALPHA)),
-  m_blend_equation_rgb(WRATHglGet<GLint>(GL_BLEND_EQUATION_RGB)),
-  m_blend_equation_a(WRATHglGet<GLint>(GL_BLEND_EQUATION_ALPHA)),
-  m_blend_color(WRATHglGet<vec4>(GL_BLEND_COLOR)),
-  m_color_mask(WRATHglGet<vecN<GLboolean, 4> >(GL_COLOR_WRITEMASK)),
-  m_clear_color(WRATHglGet<vec4>(GL_COLOR_CLEAR_VALUE))
+  m_blend_func(WRATHGLStateShadow::blend_func_separate()),
+  m_blend_equation(WRATHGLStateShadow::blend_equation_separate()),
+  m_blend_color(WRATHGLStateShadow::blend_color()),
+  m_color_mask(WRATHGLStateShadow::color_mask()),
+  m_clear_color(WRATHGLStateShadow::clear_color())
 {}
 
 color_buffer_action::
 ~color_buffer_action()
 {
-  glBlendFuncSeparate(m_blend_src_rgb, m_blend_dest_rgb,
-                      m_blend_src_a, m_blend_dest_a);
-  glBlendEquationSeparate(m_blend_equation_rgb, m_blend_equation_a);
-  glBlendColor(m_blend_color[0], m_blend_color[1], 
-               m_blend_color[2], m_blend_color[3]);
-  
-  glClearColor(m_clear_color[0], m_clear_color[1],
-               m_clear_color[2], m_clear_color[3]);
+  WRATHGLStateShadow::blend_func_separate(m_blend_func[0], m_blend_func[1],
+                                          m_blend_func[2], m_blend_func[3]);
+  WRATHGLStateShadow::blend_equation_separate(m_blend_equation[0], m_blend_equation[1]);
+  WRATHGLStateShadow::blend_color(m_blend_color);
+  WRATHGLStateShadow::color_mask(m_color_mask);
+  WRATHGLStateShadow::clear_color(m_clear_color);
 }
 
 ///////////////////////////////////////////////
@@ -253,22 +243,17 @@ color_buffer_action::
 depth_buffer_action::
 depth_buffer_action():
   m_enable(GL_DEPTH_TEST),
-  m_func(WRATHglGet<GLint>(GL_DEPTH_FUNC)),
-  m_clear(WRATHglGet<GLfloat>(GL_DEPTH_CLEAR_VALUE)),
-  m_mask(WRATHglGet<GLboolean>(GL_DEPTH_WRITEMASK))
+  m_func(WRATHGLStateShadow::depth_func()),
+  m_clear(WRATHGLStateShadow::clear_depth()),
+  m_mask(WRATHGLStateShadow::depth_mask())
 {}
 
 depth_buffer_action::
 ~depth_buffer_action()
 {
-  glDepthFunc(m_func);
-  glDepthMask(m_mask);
-
-  #if defined(WRATH_GL_VERSION)
-    glClearDepth(m_clear);
-  #else
-    glClearDepthf(m_clear);
-  #endif
+  WRATHGLStateShadow::depth_func(m_func);
+  WRATHGLStateShadow::depth_mask(m_mask);
+  WRATHGLStateShadow::clear_depth(m_clear);
 }
 
 //////////////////////////////////
@@ -276,24 +261,17 @@ depth_buffer_action::
 stencil_buffer_action::per_face::
 per_face(GLenum face):
   m_face(face),
-  m_mask(WRATHglGet<GLint>( face==GL_FRONT?GL_STENCIL_VALUE_MASK:GL_STENCIL_BACK_VALUE_MASK)),
-  m_func(WRATHglGet<GLint>( face==GL_FRONT?GL_STENCIL_FUNC:GL_STENCIL_BACK_FUNC)),
-  m_func_mask(WRATHglGet<GLint>( face==GL_FRONT?GL_STENCIL_VALUE_MASK:GL_STENCIL_BACK_VALUE_MASK)),
-  m_func_ref(WRATHglGet<GLint>( face==GL_FRONT?GL_STENCIL_REF:GL_STENCIL_BACK_REF)),
-  m_sfail(WRATHglGet<GLint>( face==GL_FRONT?GL_STENCIL_FAIL:GL_STENCIL_BACK_FAIL)),
-  m_dpfail(WRATHglGet<GLint>( face==GL_FRONT?
-                              GL_STENCIL_PASS_DEPTH_FAIL:
-                              GL_STENCIL_BACK_PASS_DEPTH_FAIL)),
-  m_dppass(WRATHglGet<GLint>( face==GL_FRONT?
-                              GL_STENCIL_PASS_DEPTH_PASS:
-                              GL_STENCIL_BACK_PASS_DEPTH_PASS))
+  m_state(WRATHGLStateShadow::stencil_state(face))
 {}
         
 stencil_buffer_action::per_face::
 ~per_face()
 {
-  glStencilOpSeparate(m_face, m_sfail, m_dpfail, m_dppass);
-  glStencilFuncSeparate(m_face, m_func, m_func_ref, m_func_mask);
+  WRATHGLStateShadow::stencil_op_separate(m_face, m_state.m_sfail, 
+                                          m_state.m_dpfail, m_state.m_dppass);
+  WRATHGLStateShadow::stencil_func_separate(m_face, m_state.m_func, 
+                                            m_state.m_ref, m_state.m_value_mask);
+  WRATHGLStateShadow::stencil_mask_separate(m_face, m_state.m_write_mask);
 }
 
 
@@ -304,32 +282,33 @@ stencil_buffer_action():
   m_enable(GL_STENCIL_TEST),
   m_front(GL_FRONT),
   m_back(GL_BACK),
-  m_clear_value(WRATHglGet<GLint>(GL_STENCIL_CLEAR_VALUE))
+  m_clear_value(WRATHGLStateShadow::clear_stencil())
 {}
 
 stencil_buffer_action::
 ~stencil_buffer_action()
 {
-  glClearStencil(m_clear_value);
+  WRATHGLStateShadow::clear_stencil(m_clear_value);
 }
 
 /////////////////////////////////////
 // rendering_target_action methods
 rendering_target_action::
 rendering_target_action(void):
-  m_fbo(WRATHglGet<GLint>(GL_FRAMEBUFFER_BINDING)),
-  m_viewport(WRATHglGet<vecN<GLint,4> >(GL_VIEWPORT)),
-  m_depth_range(WRATHglGet<vec2>(GL_DEPTH_RANGE)),
+  m_fbo(WRATHGLStateShadow::bind_framebuffer()),
+  m_viewport(WRATHGLStateShadow::viewport()),
+  m_depth_range(WRATHGLStateShadow::depth_range()),
   m_scissor_enable(GL_SCISSOR_TEST),
-  m_scissor(WRATHglGet<vecN<GLint,4> >(GL_SCISSOR_BOX))
+  m_scissor(WRATHGLStateShadow::scissor())
 {}
 
 rendering_target_action::
 ~rendering_target_action()
 {
-  glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
-  glViewport(m_viewport[0], m_viewport[1], m_viewport[2], m_viewport[3]);
-  glScissor(m_scissor[0], m_scissor[1], m_scissor[2], m_scissor[3]);
+  WRATHGLStateShadow::bind_framebuffer(m_fbo);
+  WRATHGLStateShadow::viewport(m_viewport);
+  WRATHGLStateShadow::depth_range(m_depth_range);
+  WRATHGLStateShadow::scissor(m_scissor);
 }
 
 ///////////////////////////////////
@@ -337,17 +316,16 @@ rendering_target_action::
 rendering_action_action::
 rendering_action_action(void):
   m_polygon_offset(GL_POLYGON_OFFSET_FILL),
-  m_polygon_offset_factor(WRATHglGet<float>(GL_POLYGON_OFFSET_FACTOR)),
-  m_polygon_offset_units(WRATHglGet<float>(GL_POLYGON_OFFSET_UNITS)),
+  m_polygon_offset_values(WRATHGLStateShadow::polygon_offset()),
   m_culling_enabled(GL_CULL_FACE),
-  m_culling_mode(WRATHglGet<int>(GL_CULL_FACE_MODE)),
-  m_front_face(WRATHglGet<int>(GL_FRONT_FACE))
+  m_culling_mode(WRATHGLStateShadow::cull_face()),
+  m_front_face(WRATHGLStateShadow::front_face())
 {}
 
 rendering_action_action::
 ~rendering_action_action()
 {
-  glPolygonOffset(m_polygon_offset_factor, m_polygon_offset_units);
-  glCullFace(m_culling_mode);
-  glFrontFace(m_front_face); 
+  WRATHGLStateShadow::polygon_offset(m_polygon_offset_values);
+  WRATHGLStateShadow::cull_face(m_culling_mode);
+  WRATHGLStateShadow::front_face(m_front_face); 
 }
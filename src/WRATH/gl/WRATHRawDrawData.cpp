@@ -18,11 +18,234 @@
 
 
 #include "WRATHConfig.hpp"
+#include <algorithm>
 #include "WRATHRawDrawData.hpp"
+#include "WRATHProfiler.hpp"
 
 namespace
 {
+  /*
+    Append to key the field for object p; the field value 
+    is 0 for NULL and otherwise the sort_id() of p plus one,
+    wrapped to the field width.
+   */
+  template<typename T>
+  uint64_t
+  pack_sort_key_field(uint64_t key, const T *p, unsigned int num_bits)
+  {
+    uint64_t mask, v;
+
+    mask=(uint64_t(1) << num_bits) - uint64_t(1);
+    v=(p!=NULL)?
+      static_cast<uint64_t>(p->sort_id() + 1):
+      uint64_t(0);
+
+    return (key << num_bits) | (v & mask);
+  }
+
+  template<typename T>
+  bool
+  compare_sort_entry(const T &lhs, const T &rhs)
+  {
+    return lhs.first<rhs.first;
+  }
+
+  /*
+    LSD radix sort of entries by their key, 8 bits
+    at a time. The sort is stable. Passes for which
+    every key has the same digit are skipped, which 
+    is the common case for the upper bits since the 
+    ID's are small. scratch is used as temporary
+    storage.
+   */
+  template<typename T>
+  void
+  radix_sort_entries(std::vector<T> &entries, std::vector<T> &scratch)
+  {
+    enum
+      {
+        radix_bits=8,
+        radix_size=1<<radix_bits,
+        number_passes=64/radix_bits,
+
+        /*
+          below this size std::stable_sort
+          is faster than the radix sort.
+         */
+        small_size=64
+      };
+
+    if(entries.size()<small_size)
+      {
+        std::stable_sort(entries.begin(), entries.end(), compare_sort_entry<T>);
+        return;
+      }
+
+    vecN<vecN<unsigned int, radix_size>, number_passes> counts;
+    for(unsigned int p=0; p<number_passes; ++p)
+      {
+        counts[p]=vecN<unsigned int, radix_size>(0);
+      }
+
+    for(typename std::vector<T>::const_iterator iter=entries.begin(), 
+          end=entries.end(); iter!=end; ++iter)
+      {
+        uint64_t key(iter->first);
+        for(unsigned int p=0; p<number_passes; ++p, key>>=radix_bits)
+          {
+            ++counts[p][key & (radix_size - 1)];
+          }
+      }
+
+    scratch.resize(entries.size());
+    for(unsigned int p=0; p<number_passes; ++p)
+      {
+        unsigned int shift(p*radix_bits);
+        unsigned int digit(entries.front().first >> shift & (radix_size - 1));
+        vecN<unsigned int, radix_size> &offsets(counts[p]);
+        unsigned int total(0);
+
+        if(offsets[digit]==entries.size())
+          {
+            continue;
+          }
+
+        for(unsigned int d=0; d<radix_size; ++d)
+          {
+            unsigned int c(offsets[d]);
+            offsets[d]=total;
+            total+=c;
+          }
+
+        for(typename std::vector<T>::const_iterator iter=entries.begin(), 
+              end=entries.end(); iter!=end; ++iter)
+          {
+            scratch[offsets[iter->first >> shift & (radix_size - 1)]++]=*iter;
+          }
+        entries.swap(scratch);
+      }
+  }
   
+  /*
+    sort_id() of p plus one and 0 for NULL, i.e. the
+    value pack_sort_key_field() uses before wrapping.
+   */
+  template<typename T>
+  int
+  full_sort_id(const T *p)
+  {
+    return (p!=NULL)?
+      p->sort_id() + 1:
+      0;
+  }
+
+  /*
+    Compares the GL state of two elements using the
+    full ID's. Elements with equal sort keys are 
+    ordered by it since the fields of the sort key 
+    may wrap and the key holds neither all attribute
+    sources nor the attribute formats.
+   */
+  bool
+  compare_full_state(const WRATHRawDrawDataElement *plhs,
+                     const WRATHRawDrawDataElement *prhs)
+  {
+    const WRATHDrawCallSpec &lhs(plhs->draw_spec());
+    const WRATHDrawCallSpec &rhs(prhs->draw_spec());
+    int l, r;
+
+    l=full_sort_id(lhs.m_program);
+    r=full_sort_id(rhs.m_program);
+    if(l!=r)
+      {
+        return l<r;
+      }
+
+    l=full_sort_id(lhs.m_bind_textures.raw_pointer());
+    r=full_sort_id(rhs.m_bind_textures.raw_pointer());
+    if(l!=r)
+      {
+        return l<r;
+      }
+
+    l=full_sort_id(lhs.m_gl_state_change.raw_pointer());
+    r=full_sort_id(rhs.m_gl_state_change.raw_pointer());
+    if(l!=r)
+      {
+        return l<r;
+      }
+
+    for(unsigned int i=0; i<WRATHDrawCallSpec::attribute_count; ++i)
+      {
+        l=full_sort_id(lhs.m_data_source[i]);
+        r=full_sort_id(rhs.m_data_source[i]);
+        if(l!=r)
+          {
+            return l<r;
+          }
+      }
+
+    if(lhs.m_attribute_format_location!=rhs.m_attribute_format_location)
+      {
+        return lhs.m_attribute_format_location<rhs.m_attribute_format_location;
+      }
+
+    l=full_sort_id(lhs.m_uniform_data.raw_pointer());
+    r=full_sort_id(rhs.m_uniform_data.raw_pointer());
+    if(l!=r)
+      {
+        return l<r;
+      }
+
+    l=(lhs.m_draw_command!=NULL)?
+      full_sort_id(lhs.m_draw_command->buffer_object()):
+      0;
+    r=(rhs.m_draw_command!=NULL)?
+      full_sort_id(rhs.m_draw_command->buffer_object()):
+      0;
+    return l<r;
+  }
+
+  template<typename T>
+  bool
+  compare_sort_entry_state(const T &lhs, const T &rhs)
+  {
+    return compare_full_state(lhs.second, rhs.second);
+  }
+
+  /*
+    Sorts entries by key with radix_sort_entries()
+    and then each run of equal keys by the full
+    GL state. A run is almost always of elements
+    with the same state, so a run is only sorted
+    if it is not already in order.
+   */
+  template<typename T>
+  void
+  sort_entries(std::vector<T> &entries, std::vector<T> &scratch)
+  {
+    radix_sort_entries(entries, scratch);
+
+    typename std::vector<T>::iterator begin(entries.begin()), end(entries.end());
+    while(begin!=end)
+      {
+        typename std::vector<T>::iterator run_end(begin+1);
+        bool in_order(true);
+
+        for(; run_end!=end and run_end->first==begin->first; ++run_end)
+          {
+            in_order=in_order 
+              and !compare_sort_entry_state(*run_end, *(run_end-1));
+          }
+
+        if(!in_order)
+          {
+            std::stable_sort(begin, run_end, compare_sort_entry_state<T>);
+          }
+        begin=run_end;
+      }
+  }
+
   void
   init_attributes(void)
   {
@@ -376,7 +599,9 @@ set_attribute_sources(const vecN<WRATHBufferObject*, attribute_count> &p_attr_so
                                     m_attr_format[i].m_normalized, 
                                     m_attr_format[i].m_stride, 
                                     m_attr_source[i]->offset_pointer(m_attr_format[i].m_offset));
-              
+              attribute_divisor(i);
+              m_attr_name[i]=m_attr_source[i]->name();
+              repoint_streamed_attributes(m_attr_source[i]);
               
               ++m_draw_information_ptr->m_attribute_change_count;
             }
@@ -427,12 +652,140 @@ set_attribute_sources(const vecN<WRATHBufferObject*, attribute_count> &p_attr_so
                                     m_attr_format[i].m_normalized, 
                                     m_attr_format[i].m_stride, 
                                     m_attr_source[i]->offset_pointer(m_attr_format[i].m_offset));
+              attribute_divisor(i);
+              m_attr_name[i]=m_attr_source[i]->name();
               
             }
         }
     }
 }
 
+void
+WRATHRawDrawData::DrawState::
+repoint_streamed_attributes(WRATHBufferObject *bo)
+{
+  /*
+    binding a streaming WRATHBufferObject may
+    have moved it to another GL buffer object,
+    in which case the attributes still sourcing
+    from it need to be pointed to the new GL
+    buffer object. Note that bo is bound to
+    GL_ARRAY_BUFFER at this point.
+   */
+  if(bo->stream_buffer_count()<2)
+    {
+      return;
+    }
+
+  for(int i=0; i<WRATHDrawCallSpec::attribute_count; ++i)
+    {
+      if(m_attr_source[i]==bo 
+         and m_attr_format[i].valid()
+         and m_attr_name[i]!=bo->name())
+        {
+          glVertexAttribPointer(i, //index
+                                m_attr_format[i].m_count, 
+                                m_attr_format[i].m_type, 
+                                m_attr_format[i].m_normalized, 
+                                m_attr_format[i].m_stride, 
+                                bo->offset_pointer(m_attr_format[i].m_offset));
+          m_attr_name[i]=bo->name();
+          ++m_draw_information_ptr->m_attribute_change_count;
+        }
+    }
+}
+
+
+void
+WRATHRawDrawData::DrawState::
+attribute_divisor(int i)
+{
+  if(m_attr_divisor[i]!=m_attr_format[i].m_divisor)
+    {
+      #if WRATH_GL_GLES_VERSION>=3
+      {
+        glVertexAttribDivisor(i, m_attr_format[i].m_divisor);
+      }
+      #else
+      {
+        //instancing requires GL 3.3 or GLES3
+        WRATHassert(0);
+      }
+      #endif
+      m_attr_divisor[i]=m_attr_format[i].m_divisor;
+    }
+}
+
+void
+WRATHRawDrawData::DrawState::
+point_instanced_attributes(int first_instance)
+{
+  /*
+    GL3 and GLES3 do not have a base instance
+    argument to glDrawArraysInstanced, so the
+    per-instance attributes are pointed to
+    the first instance to draw instead.
+   */
+  for(int i=0; i<WRATHDrawCallSpec::attribute_count; ++i)
+    {
+      if(m_attr_source[i]!=NULL
+         and m_attr_format[i].valid()
+         and m_attr_format[i].m_divisor!=0)
+        {
+          int offset;
+
+          offset=m_attr_format[i].m_offset 
+            + m_attr_format[i].m_stride*(first_instance/static_cast<int>(m_attr_format[i].m_divisor));
+
+          if(m_currently_bound!=m_attr_source[i])
+            {
+              glBindBuffer(GL_ARRAY_BUFFER, 
+                           m_attr_source[i]->has_buffer_object_on_bind()?
+                           m_attr_source[i]->name():0);
+              m_currently_bound=m_attr_source[i];
+              ++m_draw_information_ptr->m_buffer_object_bind_count;
+            }
+
+          glVertexAttribPointer(i, //index
+                                m_attr_format[i].m_count, 
+                                m_attr_format[i].m_type, 
+                                m_attr_format[i].m_normalized, 
+                                m_attr_format[i].m_stride, 
+                                m_attr_source[i]->offset_pointer(offset));
+          ++m_draw_information_ptr->m_attribute_change_count;
+        }
+    }
+}
+
+void
+WRATHRawDrawData::DrawState::
+draw_instances(void)
+{
+  #if WRATH_GL_GLES_VERSION>=3
+  {
+    for(unsigned int r=0, endr=m_draw_ranges.size(); r<endr; ++r)
+      {
+        point_instanced_attributes(m_draw_ranges[r].m_location);
+        glDrawArraysInstanced(m_primitive_type, 0, 
+                              m_instance_vertex_count, 
+                              m_draw_ranges[r].m_count);
+      }
+    m_draw_information_ptr->m_draw_count+=m_draw_ranges.size();
+
+    /*
+      point the attributes back to the start of 
+      their source so that set_attribute_sources()
+      finds them as it left them.
+     */
+    point_instanced_attributes(0);
+  }
+  #else
+  {
+    //instancing requires GL 3.3 or GLES3
+    WRATHassert(0);
+  }
+  #endif
+}
 
 void
 WRATHRawDrawData::DrawState::
@@ -440,14 +793,17 @@ index_buffer(WRATHDrawCommand *draw_command)
 {
   WRATHBufferObject *indx_source;
   GLenum primitive_type, index_type;
+  int instance_vertex_count;
 
   primitive_type=draw_command->primitive_type();
   index_type=draw_command->index_type();  
   indx_source=draw_command->buffer_object();
+  instance_vertex_count=draw_command->instance_vertex_count();
 
   if(primitive_type!=m_primitive_type
      or index_type!=m_index_type
-     or indx_source!=m_indx_source)
+     or indx_source!=m_indx_source
+     or instance_vertex_count!=m_instance_vertex_count)
     {
       flush_draws();
     }
@@ -455,6 +811,7 @@ index_buffer(WRATHDrawCommand *draw_command)
   m_primitive_type=primitive_type;
   m_index_type=index_type;
   m_indx_source=indx_source;
+  m_instance_vertex_count=instance_vertex_count;
 }
 
 
@@ -465,7 +822,11 @@ flush_draws(void)
 {
   WRATHassert(m_active);
   make_program_active();
-  if(m_current_glsl!=NULL and m_indx_source!=NULL and !m_draw_ranges.empty())
+  if(m_current_glsl!=NULL and m_instance_vertex_count>0 and !m_draw_ranges.empty())
+    {
+      draw_instances();
+    }
+  else if(m_current_glsl!=NULL and m_indx_source!=NULL and !m_draw_ranges.empty())
     {
       static MultiDrawElementsChooser draw_elements;
       unsigned int cnt;
@@ -527,6 +888,20 @@ draw_end(void)
       WRATHUnlockMutex(ptr->mutex());
     }
 
+  /*
+    leave the attribute divisors as GL 
+    defaults them, i.e. 0, for drawing
+    done outside of WRATHRawDrawData
+   */
+  for(int i=0; i<WRATHDrawCallSpec::attribute_count; ++i)
+    {
+      if(m_attr_divisor[i]!=0)
+        {
+          m_attr_format[i].m_divisor=0;
+          attribute_divisor(i);
+        }
+    }
+
   if(m_tex.valid())
     {
       m_tex->unbind_textures();
@@ -537,103 +912,111 @@ draw_end(void)
 
 
 /////////////////////////////////////
-//WRATHRawDrawData::sorter  methods
-bool
-WRATHRawDrawData::sorter::
-operator()(const WRATHRawDrawDataElement *plhs,
-           const WRATHRawDrawDataElement *prhs) 
+//WRATHRawDrawDataElement methods
+uint64_t
+WRATHRawDrawDataElement::
+compute_sort_key(const WRATHDrawCallSpec &spec)
 {
-  /*
-    make NULL come last, thus NULL<obj is always false
-   */
-  if(plhs==NULL or plhs==prhs)
+  uint64_t return_value(0);
+  WRATHBufferObject *data_source(NULL);
+  WRATHBufferObject *index_source(NULL);
+
+  for(unsigned int i=0; i<WRATHDrawCallSpec::attribute_count and data_source==NULL; ++i)
     {
-      return false;
+      data_source=spec.m_data_source[i];
     }
 
-  /*
-    and obj<NULL is always true.
-   */
-  if(prhs==NULL)
+  if(spec.m_draw_command!=NULL)
     {
-      return true;
+      index_source=spec.m_draw_command->buffer_object();
     }
 
+  return_value=pack_sort_key_field(return_value, spec.m_program, 14);
+  return_value=pack_sort_key_field(return_value, spec.m_bind_textures.raw_pointer(), 12);
+  return_value=pack_sort_key_field(return_value, spec.m_gl_state_change.raw_pointer(), 8);
+  return_value=pack_sort_key_field(return_value, data_source, 12);
+  return_value=pack_sort_key_field(return_value, spec.m_uniform_data.raw_pointer(), 10);
+  return_value=pack_sort_key_field(return_value, index_source, 8);
+
+  return return_value;
+}
+
+/////////////////////////////////////
+//WRATHRawDrawData::draw_order_sorter_t  methods
+bool
+WRATHRawDrawData::draw_order_sorter_t::
+operator()(const WRATHRawDrawDataElement *plhs,
+           const WRATHRawDrawDataElement *prhs) const
+{
   WRATHassert(plhs!=NULL);
   WRATHassert(prhs!=NULL);
+  WRATHassert(m_comparer.valid());
 
   const WRATHDrawCallSpec &lhs(plhs->draw_spec());
   const WRATHDrawCallSpec &rhs(prhs->draw_spec());
 
-  if(lhs.m_force_draw_order!=rhs.m_force_draw_order
-     and m_comparer.valid())
+  if(lhs.m_force_draw_order==rhs.m_force_draw_order)
     {
-      enum WRATHDrawOrderComparer::draw_sort_order_type v;
-
-      v=m_comparer->compare_objects(lhs.m_force_draw_order, 
-                                    rhs.m_force_draw_order);
-
-      if(v!=WRATHDrawOrderComparer::equal_draw_sort_order)
-        {
-          return v==WRATHDrawOrderComparer::less_draw_sort_order;
-        }
+      return false;
     }
 
-  if(lhs.m_program!=rhs.m_program)
-    {
-      return lhs.m_program<rhs.m_program;
-    }
+  return m_comparer->compare_objects(lhs.m_force_draw_order, 
+                                     rhs.m_force_draw_order)
+    ==WRATHDrawOrderComparer::less_draw_sort_order;
+}
 
-  if(lhs.m_bind_textures!=rhs.m_bind_textures)
-    {
-      return lhs.m_bind_textures<rhs.m_bind_textures;
-    }
 
-  if(lhs.m_gl_state_change!=rhs.m_gl_state_change)
-    {
-      return lhs.m_gl_state_change<rhs.m_gl_state_change;
-    }
+/////////////////////////////////////
+//WRATHRawDrawData::merged_draw_list  methods
+void
+WRATHRawDrawData::merged_draw_list::
+add(const WRATHRawDrawData *p)
+{
+  const std::vector<WRATHRawDrawDataElement*> &elements(p->m_buffers[p->present_ID()]);
 
-  if(lhs.m_data_source!=rhs.m_data_source)
+  for(std::vector<WRATHRawDrawDataElement*>::const_iterator 
+        iter=elements.begin(), end=elements.end(); 
+      iter!=end; ++iter)
     {
-      return lhs.m_data_source<rhs.m_data_source;
+      WRATHassert(NULL!=*iter);
+      m_entries.push_back(sort_entry((*iter)->sort_key(), *iter));
     }
+}
 
-  if(lhs.m_attribute_format_location!=rhs.m_attribute_format_location)
+void
+WRATHRawDrawData::merged_draw_list::
+add(const std::map<int, WRATHRawDrawData*> &items)
+{
+  for(std::map<int, WRATHRawDrawData*>::const_iterator 
+        iter=items.begin(), end=items.end();
+      iter!=end; ++iter)
     {
-      return lhs.m_attribute_format_location<rhs.m_attribute_format_location;
+      add(iter->second);
     }
+}
 
-  if(lhs.m_uniform_data!=rhs.m_uniform_data)
-    {
-      return lhs.m_uniform_data<rhs.m_uniform_data;
-    }
+void
+WRATHRawDrawData::merged_draw_list::
+draw(DrawState &draw_state)
+{
+  WRATHassert(draw_state.draw_active());
 
-  if(lhs.m_draw_command!=rhs.m_draw_command)
+  sort_entries(m_entries, m_scratch);
+  for(std::vector<sort_entry>::const_iterator 
+        iter=m_entries.begin(), end=m_entries.end();
+      iter!=end; ++iter)
     {
-      if(lhs.m_draw_command!=NULL
-         and rhs.m_draw_command!=NULL
-         and lhs.m_draw_command->buffer_object()!=rhs.m_draw_command->buffer_object())
-        {
-          return lhs.m_draw_command->buffer_object()<rhs.m_draw_command->buffer_object();
-        }
-      else
-        {
-          return lhs.m_draw_command<rhs.m_draw_command;
-        }
+      draw_element(draw_state, *iter->second);
     }
-
-  return false;
 }
 
-
 /////////////////////////////////
 // WRATHRawDrawData methods
 WRATHRawDrawData::
 WRATHRawDrawData(const WRATHTripleBufferEnabler::handle &ptriple_buffer_enabler,
                  const WRATHDrawOrderComparer::const_handle &h):
   WRATHTripleBufferEnabler::PhasedDeletedObject(ptriple_buffer_enabler),
-  m_sorter(h),
+  m_comparer(h),
   m_list_dirty(false)
 {
   
@@ -692,29 +1075,34 @@ draw(DrawState &draw_state)
       iter!=end; ++iter)
     {
       WRATHassert(NULL!=*iter);
+      draw_element(draw_state, **iter);
+    }
+}
 
-      const WRATHRawDrawDataElement &current_element(**iter);
-      const WRATHDrawCallSpec &current(current_element.draw_spec());
+void
+WRATHRawDrawData::
+draw_element(DrawState &draw_state, const WRATHRawDrawDataElement &element)
+{
+  const WRATHDrawCallSpec &current(element.draw_spec());
 
-      if(!current.valid()
-         or current.m_draw_command->draw_elements_empty())
-        {
-          continue;
-        }
-      
-      draw_state.program(current.m_program);
-      if(!draw_state.valid_program_active())
-        {
-          continue;
-        }
+  if(!current.valid()
+     or current.m_draw_command->draw_elements_empty())
+    {
+      return;
+    }
       
-      draw_state.texture(current.m_bind_textures);
-      draw_state.gl_state_change(current.m_gl_state_change);
-      draw_state.uniform(current.m_uniform_data);
-      draw_state.set_attribute_sources(current.m_data_source,
-                                       current.m_attribute_format_location);
-      draw_state.queue_drawing(current.m_draw_command);
+  draw_state.program(current.m_program);
+  if(!draw_state.valid_program_active())
+    {
+      return;
     }
+      
+  draw_state.texture(current.m_bind_textures);
+  draw_state.gl_state_change(current.m_gl_state_change);
+  draw_state.uniform(current.m_uniform_data);
+  draw_state.set_attribute_sources(current.m_data_source,
+                                   current.m_attribute_format_location);
+  draw_state.queue_drawing(current.m_draw_command);
 }
 
 
@@ -734,17 +1122,17 @@ const WRATHDrawOrderComparer::const_handle&
 WRATHRawDrawData::
 draw_order_sorter(void) const
 {
-  return m_sorter.m_comparer;
+  return m_comparer;
 }
 
 void
 WRATHRawDrawData::
 draw_order_sorter(const WRATHDrawOrderComparer::const_handle &v)
 {
-  if(v!=m_sorter.m_comparer)
+  if(v!=m_comparer)
     {
       mark_list_dirty();
-      m_sorter.m_comparer=v;    
+      m_comparer=v;    
     }
 }
 
@@ -814,21 +1202,54 @@ check_sort_elements(void)
 
   if(m_list_dirty)
     {
-      unsigned int actual_size, end;
-      std::sort(m_buffers[w].begin(), m_buffers[w].end(), m_sorter);
+      WRATHProfileZone("WRATHRawDrawData::check_sort_elements");
+      std::vector<WRATHRawDrawDataElement*> &elements(m_buffers[w]);
+      std::vector<sort_entry> &entries(m_sort_scratch[0]);
+      bool has_draw_order(false);
+
+      /*
+        drop the NULL entries left by remove_element()
+        and fetch the sort keys so that the radix sort
+        does not need to chase the element pointers.
+       */
+      entries.clear();
+      for(std::vector<WRATHRawDrawDataElement*>::const_iterator 
+            iter=elements.begin(), end=elements.end(); 
+          iter!=end; ++iter)
+        {
+          if(*iter!=NULL)
+            {
+              entries.push_back(sort_entry((*iter)->sort_key(), *iter));
+              has_draw_order=has_draw_order 
+                or (*iter)->draw_spec().m_force_draw_order.valid();
+            }
+        }
+
+      sort_entries(entries, m_sort_scratch[1]);
+
+      elements.resize(entries.size());
+      for(unsigned int i=0, end=entries.size(); i<end; ++i)
+        {
+          elements[i]=entries[i].second;
+        }
 
-      for(actual_size=0, end=m_buffers[w].size(); 
-          actual_size<end and m_buffers[w][actual_size]!=NULL;
-          ++actual_size)
+      /*
+        the radix sort is stable and so is std::stable_sort,
+        thus sorting by draw order afterwards makes the 
+        draw order the leading component of the sort.
+        If no element has a draw order, then all elements
+        compare as equal and there is nothing to do.
+       */
+      if(has_draw_order and m_comparer.valid())
         {
-          m_buffers[w][actual_size]->m_location_in_raw_draw_data=actual_size;
+          std::stable_sort(elements.begin(), elements.end(), 
+                           draw_order_sorter_t(m_comparer));
         }
 
-      for(unsigned int i=actual_size; i<end; ++i)
+      for(unsigned int i=0, end=elements.size(); i<end; ++i)
         {
-          WRATHassert(m_buffers[w][i]==NULL);
+          elements[i]->m_location_in_raw_draw_data=i;
         }
-      m_buffers[w].resize(actual_size);
       m_list_dirty=false;
     }
 }
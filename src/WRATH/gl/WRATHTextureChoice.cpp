@@ -19,6 +19,7 @@
 
 #include "WRATHConfig.hpp"
 #include "WRATHTextureChoice.hpp"
+#include "WRATHGLStateShadow.hpp"
 
 ////////////////////////////
 // WRATHTextureChoice::texture_base methods
@@ -102,7 +103,7 @@ bind_textures(const const_handle &h) const
                 {
                   GLenum unit(i1->first);
 
-                  glActiveTexture(unit);
+                  WRATHGLStateShadow::active_texture(unit);
                   i1->second->unbind_texture(unit);
                   i2->second->bind_texture(unit);
                   ++return_value;
@@ -124,7 +125,7 @@ bind_textures(const const_handle &h) const
                 {
                   GLenum unit(i2->first);
 
-                  glActiveTexture(unit);
+                  WRATHGLStateShadow::active_texture(unit);
                   i2->second->bind_texture(unit);
                   ++return_value;
                 } 
@@ -142,7 +143,7 @@ bind_textures(const const_handle &h) const
         {
           GLenum unit(i2->first);
           
-          glActiveTexture(unit);
+          WRATHGLStateShadow::active_texture(unit);
           i2->second->bind_texture(unit);
           ++return_value;
         } 
@@ -155,7 +156,7 @@ bind_textures(const const_handle &h) const
             iter=m_values.begin(), end=m_values.end();
           iter!=end; ++iter)
         {    
-          glActiveTexture(iter->first);
+          WRATHGLStateShadow::active_texture(iter->first);
           iter->second->bind_texture(iter->first);
         }
       return m_values.size();
@@ -7,7 +7,7 @@ d		:= $(dir)
 dir := $(d)/shaders
 include $(dir)/Rules.mk
 
-LIB_SOURCES += $(call filelist, WRATHDefaultRectAttributePacker.cpp WRATHImage.cpp WRATHGradientSourceBase.cpp WRATHGradientSource.cpp WRATHGradient.cpp WRATHColorValueSource.cpp WRATHLinearGradientValue.cpp WRATHRadialGradientValue.cpp WRATHRepeatGradientValue.cpp WRATHGradientValueBase.cpp WRATHTextureCoordinateSourceBase.cpp WRATHTextureCoordinateSource.cpp WRATHTextureCoordinate.cpp WRATHTextureCoordinateDynamic.cpp WRATHBrush.cpp WRATHShaderBrushSourceHoard.cpp WRATHDefaultRectShader.cpp)
+LIB_SOURCES += $(call filelist, WRATHDefaultRectAttributePacker.cpp WRATHImage.cpp WRATHGradientSourceBase.cpp WRATHGradientSource.cpp WRATHGradient.cpp WRATHColorValueSource.cpp WRATHLinearGradientValue.cpp WRATHRadialGradientValue.cpp WRATHRepeatGradientValue.cpp WRATHGradientValueBase.cpp WRATHTextureCoordinateSourceBase.cpp WRATHTextureCoordinateSource.cpp WRATHTextureCoordinate.cpp WRATHTextureCoordinateDynamic.cpp WRATHBrush.cpp WRATHShaderBrushSourceHoard.cpp WRATHDefaultRectShader.cpp WRATHTiledImage.cpp)
 
 # Begin standard footer
 d		:= $(dirstack_$(sp))
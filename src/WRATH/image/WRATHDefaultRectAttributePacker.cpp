@@ -24,6 +24,7 @@
 #include "WRATHDefaultRectAttributePacker.hpp"
 #include "WRATHInterleavedAttributes.hpp"
 #include "WRATHStaticInit.hpp"
+#include "WRATHUtil.hpp"
 
 
 namespace
@@ -53,6 +54,40 @@ namespace
       return get<WRATHDefaultRectAttributePacker::normalized_location>();
     }
   };
+
+  /*
+    attribute for WRATHAttributePacker::half_precision_format:
+    size_and_z stays 32-bit floats (z feeds the depth
+    test and the size is in pixels, neither survives
+    a 16-bit float), only the brush values are 16-bit 
+    floats and the normalized coordinate is padded to 
+    4 bytes so that the vertex size is a multiple of 4 bytes.
+   */
+  typedef vecN<GLushort,4> half4_type;
+  typedef vecN<GLubyte,4> normalized_coord_padded_type;
+
+  class attribute_type_half:
+    public WRATHInterleavedAttributes<vec3, half4_type, normalized_coord_padded_type>
+  {
+  public:
+    vec3&
+    size_and_z(void)
+    {
+      return get<WRATHDefaultRectAttributePacker::size_and_z_location>();
+    }
+
+    half4_type&
+    brush_values(void)
+    {
+      return get<WRATHDefaultRectAttributePacker::brush_position_stretch_location>();
+    }
+
+    normalized_coord_padded_type&
+    normalized_coord(void)
+    {
+      return get<WRATHDefaultRectAttributePacker::normalized_location>();
+    }
+  };
   
   typedef const char *attribute_label_type;
   
@@ -74,17 +109,39 @@ namespace
 //////////////////////////////////////////
 // WRATHDefaultRectAttributePacker methods
 WRATHDefaultRectAttributePacker::
-WRATHDefaultRectAttributePacker(void):
-  WRATHRectAttributePacker(typeid(WRATHDefaultRectAttributePacker).name(),
+WRATHDefaultRectAttributePacker(enum attribute_format_type fmt):
+  WRATHRectAttributePacker(resource_label(fmt),
                            attribute_name_list().begin(),
-                           attribute_name_list().end())
+                           attribute_name_list().end()),
+  m_format(fmt)
 {}
 
+std::string
+WRATHDefaultRectAttributePacker::
+resource_label(enum attribute_format_type fmt)
+{
+  std::string R(typeid(WRATHDefaultRectAttributePacker).name());
+
+  if(fmt==half_precision_format)
+    {
+      R+="-half";
+    }
+  return R;
+}
+
 void
 WRATHDefaultRectAttributePacker::
 attribute_key(WRATHAttributeStoreKey &attrib_key) const 
 {
-  attrib_key.type_and_format(type_tag<attribute_type>());
+  if(m_format==half_precision_format)
+    {
+      attrib_key.type_and_format(type_tag<attribute_type_half>());
+      attrib_key.half_float_format(brush_position_stretch_location);
+    }
+  else
+    {
+      attrib_key.type_and_format(type_tag<attribute_type>());
+    }
   attrib_key.m_attribute_format_location[normalized_location].m_normalized=GL_TRUE;
 }
 
@@ -102,7 +159,6 @@ set_attribute_data_implement(WRATHAbstractDataSink &sink, int attr_location,
       normalized_coord_type(255,0)
     };   
 
-  c_array<attribute_type> attrs;
   Rect::handle rect;
   vec3 value(0.0f, 0.0f, -1.0f);
   vec4 brush_value(0.0f, 0.0f, 1.0f, 1.0f);
@@ -125,12 +181,34 @@ set_attribute_data_implement(WRATHAbstractDataSink &sink, int attr_location,
     }
 
   WRATHassert(&sink!=NULL);
-  WRATHAutoLockMutex(sink.mutex());    
-  attrs=sink.pointer<attribute_type>(range_type<int>(attr_location, attr_location+4));
-  for(int i=0;i<4;++i)
+
+  if(m_format==half_precision_format)
+    {
+      c_array<attribute_type_half> attrs;
+      half4_type brush_half;
+
+      WRATHUtil::convert_to_halfp_from_float(brush_half, brush_value);
+
+      WRATHAutoLockMutex(sink.mutex());    
+      attrs=sink.pointer<attribute_type_half>(range_type<int>(attr_location, attr_location+4));
+      for(int i=0;i<4;++i)
+        {
+          attrs[i].size_and_z()=value;
+          attrs[i].normalized_coord()=normalized_coord_padded_type(vs[i].x(), vs[i].y(), 0, 0);
+          attrs[i].brush_values()=brush_half; 
+        }
+    }
+  else
     {
-      attrs[i].size_and_z()=value;
-      attrs[i].normalized_coord()=vs[i];
-      attrs[i].brush_values()=brush_value; 
+      c_array<attribute_type> attrs;
+
+      WRATHAutoLockMutex(sink.mutex());    
+      attrs=sink.pointer<attribute_type>(range_type<int>(attr_location, attr_location+4));
+      for(int i=0;i<4;++i)
+        {
+          attrs[i].size_and_z()=value;
+          attrs[i].normalized_coord()=vs[i];
+          attrs[i].brush_values()=brush_value; 
+        }
     }
 }
@@ -24,6 +24,8 @@
 #include <math.h>
 
 #define NUMBER_GRADIENTS_PER_TEXTURE 128
+#define LOG2_GRADIENT_TEXTURE_WIDTH 8
+#define GRADIENT_TEXTURE_WIDTH (1<<LOG2_GRADIENT_TEXTURE_WIDTH)
 
 /*
   Basic idea:
@@ -34,10 +36,17 @@
       A RawGradientData is reference counted object and a
       WRATHGradient object stores such a reference. Additionally,
       a RawGradientData stores a reference to which GradientTexture
-      it is a part.
+      it is a part. The color stops are stored as sorted arrays of
+      texels and colors.
 
    1) A GradientTexture represents a set of RawGradientData of
-      all the same resolution storted on a single GL texture.
+      all the same repeat mode stored on a single GL texture.
+      Each RawGradientData takes one row of the texture, the
+      rows are GRADIENT_TEXTURE_WIDTH texels wide regardless
+      of the resolution of the gradient: a gradient of lower
+      resolution is resampled to the row width the same way
+      GL would filter a texture of the lower resolution, thus
+      gradients of all resolutions share the same texture.
       It stores a _pointer_ to each RawGradientData. A GradientTexture
       is a texture binder, thus reference counted. 
 
@@ -61,7 +70,12 @@
       spots available, and if not removes itself from the list of available
       GradientTexture objects from the GradientTextureAllocator
 
-   5) When a RawGradientData is deleted, it frees the spot it has from
+   5) When a GradientTexture is bound, all dirty rows are interpolated
+      into one float buffer, which is then converted to bytes run by run
+      of consecutive rows; each such run is uploaded with one
+      glTexSubImage2D call.
+
+   6) When a RawGradientData is deleted, it frees the spot it has from
       the GradientTexture which in turn triggers the GradientTexture to mark
       itself as available to the GradientTextureAllocator. When a GradientTexture
       it marks itself as unavailable.
@@ -93,7 +107,8 @@ namespace
   public:
     typedef handle_t<GradientTexture> handle;
 
-    GradientTexture(uint32_t log2_resolution, enum WRATHGradient::repeat_type_t r);
+    explicit
+    GradientTexture(enum WRATHGradient::repeat_type_t r);
     ~GradientTexture();
 
     void
@@ -103,7 +118,10 @@ namespace
     mark_dirty(int);
 
     WRATHReferenceCountedObject::handle
-    allocate(void);
+    allocate(uint32_t log2_resolution);
+
+    bool
+    full(void);
 
     void
     deregister(RawGradientData*);
@@ -119,10 +137,12 @@ namespace
     void
     flush(void);
 
+    void
+    upload_rows(int first_row, int last_row);
+
     /*
       ctor params
      */
-    uint32_t m_log2_resolution;
     enum WRATHGradient::repeat_type_t m_r;
 
     /*
@@ -148,6 +168,16 @@ namespace
       that are dirty
      */
     std::set<int> m_dirty_grads;
+
+    /*
+      only accessed from the GL context,
+      i.e. from flush():
+      - m_pixels holds the texture data client side,
+      - m_float_rows holds the interpolated colors
+        of the dirty rows before converting to bytes
+     */
+    std::vector<uint8_t> m_pixels;
+    std::vector<vec4> m_float_rows;
   };
 
 
@@ -180,9 +210,19 @@ namespace
       mark_dirty();
       
       int I;
+      std::vector<int>::iterator iter;
 
       I=texel(t);
-      m_stops[I]=pcolor;
+      iter=std::lower_bound(m_stop_texels.begin(), m_stop_texels.end(), I);
+      if(iter!=m_stop_texels.end() and *iter==I)
+        {
+          m_stop_colors[iter-m_stop_texels.begin()]=pcolor;
+        }
+      else
+        {
+          m_stop_colors.insert(m_stop_colors.begin() + (iter-m_stop_texels.begin()), pcolor);
+          m_stop_texels.insert(iter, I);
+        }
 
       return I;
     }
@@ -192,19 +232,23 @@ namespace
     {
       WRATHAutoLockMutex(m_mutex);
 
-      if(m_stops.find(I)!=m_stops.end())
+      std::vector<int>::iterator iter;
+
+      iter=std::lower_bound(m_stop_texels.begin(), m_stop_texels.end(), I);
+      if(iter!=m_stop_texels.end() and *iter==I)
         {
-          m_stops.erase(I);
+          m_stop_colors.erase(m_stop_colors.begin() + (iter-m_stop_texels.begin()));
+          m_stop_texels.erase(iter);
           mark_dirty();
         }
     }
 
-    const std::vector<uint8_t>&
-    color_bits(void)
-    {
-      flush();
-      return m_raw_color_bits;
-    }
+    /*
+      compute the colors of the row of the
+      gradient at the width of a GradientTexture
+     */
+    void
+    interpolate(c_array<vec4> out_row);
 
     int
     y(void) const
@@ -227,7 +271,7 @@ namespace
     mark_dirty(void);
 
     void
-    flush(void);
+    interpolate_texels(void);
 
     GradientTexture::handle m_parent;
     int m_y;
@@ -237,12 +281,16 @@ namespace
     WRATHStateBasedPackingData::handle m_texture_coordinate_y_state_based_packing_data;
     enum WRATHGradient::repeat_type_t m_repeat_mode;
 
-    std::map<int, vec4> m_stops;
+    /*
+      color stops sorted by texel, 
+      m_stop_colors[i] is the color
+      at texel m_stop_texels[i].
+     */
+    std::vector<int> m_stop_texels;
+    std::vector<vec4> m_stop_colors;
 
     WRATHMutex m_mutex;
     std::vector<vec4> m_interpolate_color_value_float;
-    std::vector<uint8_t> m_raw_color_bits;
-    bool m_user_alive;
   };
 
 
@@ -250,21 +298,19 @@ namespace
   {
   public:
     void
-    put_on_free_list(uint32_t log2_resolution, 
-                     enum WRATHGradient::repeat_type_t r,
+    put_on_free_list(enum WRATHGradient::repeat_type_t r,
                      GradientTexture *q)
     {
       WRATHAutoLockMutex(m_mutex);
-      m_have_free[log2_resolution][r].insert(q);
+      m_have_free[r].insert(q);
     }
 
     void
-    remove_from_free_list(uint32_t log2_resolution, 
-                          enum WRATHGradient::repeat_type_t r,
+    remove_from_free_list(enum WRATHGradient::repeat_type_t r,
                           GradientTexture *q)
     {
       WRATHAutoLockMutex(m_mutex);
-      m_have_free[log2_resolution][r].erase(q);
+      m_have_free[r].erase(q);
     }
 
     WRATHReferenceCountedObject::handle
@@ -273,30 +319,43 @@ namespace
       GradientTexture *q;
 
       WRATHAutoLockMutex(m_mutex);
-      if(m_have_free[log2_resolution][r].empty())
+      if(m_have_free[r].empty())
         {
-          q=WRATHNew GradientTexture(log2_resolution, r);
-          m_have_free[log2_resolution][r].insert(q);
+          q=WRATHNew GradientTexture(r);
+          m_have_free[r].insert(q);
         }
       else
         {
-          q=*m_have_free[log2_resolution][r].begin();
+          q=*m_have_free[r].begin();
         }
 
-      return q->allocate();
+      /*
+        the texture is taken off the free list
+        here, with m_mutex locked, rather than by
+        GradientTexture::allocate() which would
+        lock m_mutex again.
+       */
+      WRATHReferenceCountedObject::handle R;
+      R=q->allocate(log2_resolution);
+      if(q->full())
+        {
+          m_have_free[r].erase(q);
+        }
+      return R;
     }
 
   private:
     typedef std::set<GradientTexture*> free_texture_list;
 
     /*
-      m_have_free[Resolution][repeat_mode] gives a list
-      of GradientTexture objects that can be used to hold
-      gradient texture data for the specified resolution
-      for the specified repeat mode.
+      m_have_free[repeat_mode] gives a list
+      of GradientTexture objects that can be used 
+      to hold gradient texture data for the specified 
+      repeat mode. Gradients of all resolutions share
+      the same GradientTexture objects.
      */
     WRATHMutex m_mutex;
-    vecN< vecN<free_texture_list, 3>, 8> m_have_free;
+    vecN<free_texture_list, 3> m_have_free;
   };
 
   GradientTextureAllocator&
@@ -313,13 +372,13 @@ namespace
 ////////////////////////////////////////////////
 //GradientTexture methods
 GradientTexture::
-GradientTexture(uint32_t log2_resolution, enum WRATHGradient::repeat_type_t r):
-  m_log2_resolution(log2_resolution),
+GradientTexture(enum WRATHGradient::repeat_type_t r):
   m_r(r),
   m_texture(0),
-  m_resolution(1<<log2_resolution, NUMBER_GRADIENTS_PER_TEXTURE),
+  m_resolution(GRADIENT_TEXTURE_WIDTH, NUMBER_GRADIENTS_PER_TEXTURE),
   m_current_y(0),
-  m_grads(NULL)
+  m_grads(NULL),
+  m_pixels(4*GRADIENT_TEXTURE_WIDTH*NUMBER_GRADIENTS_PER_TEXTURE, 255u)
 {
 }
 
@@ -344,7 +403,7 @@ GradientTexture::
     {
       glDeleteTextures(1, &m_texture);
     }
-  gradient_allocator().remove_from_free_list(m_log2_resolution, m_r, this);
+  gradient_allocator().remove_from_free_list(m_r, this);
 
 }
 
@@ -360,29 +419,44 @@ void
 GradientTexture::
 deregister(RawGradientData *q)
 {
-  WRATHAutoLockMutex(m_mutex);
-
-  unsigned int y;
-
-  y=q->y();
-  WRATHassert(m_grads[y]==q);
-  WRATHassert(m_current_y>0);
-
-  if(y==m_current_y-1)
-    {
-      --m_current_y;
-    }
-  else
-    {
-      m_free_ys.push_back(y);
-    }
-  m_grads[y]=NULL;
-
-  WRATHassert(m_current_y>=m_free_ys.size());
-  gradient_allocator().put_on_free_list(m_log2_resolution, m_r, this);
+  /*
+    m_mutex is released before putting this
+    on the free list because the allocator
+    locks its mutex before m_mutex.
+   */
+  {
+    WRATHAutoLockMutex(m_mutex);
+    
+    unsigned int y;
+    
+    y=q->y();
+    WRATHassert(m_grads[y]==q);
+    WRATHassert(m_current_y>0);
+    
+    if(y==m_current_y-1)
+      {
+        --m_current_y;
+      }
+    else
+      {
+        m_free_ys.push_back(y);
+      }
+    m_grads[y]=NULL;
+    
+    WRATHassert(m_current_y>=m_free_ys.size());
+  }
+  gradient_allocator().put_on_free_list(m_r, this);
   
 }
 
+bool
+GradientTexture::
+full(void)
+{
+  WRATHAutoLockMutex(m_mutex);
+  return NUMBER_GRADIENTS_PER_TEXTURE==m_current_y and m_free_ys.empty();
+}
+
 void
 GradientTexture::
 bind_texture(GLenum)
@@ -419,12 +493,46 @@ bind_texture(GLenum)
   flush();
 }
 
+void
+GradientTexture::
+upload_rows(int first_row, int last_row)
+{
+  int row_size(4*m_resolution.x());
+  int number_rows(last_row-first_row+1);
+  const float *src;
+  uint8_t *dst;
+
+  /*
+    convert the float colors of the rows to bytes 
+    with a single loop over the floats of the rows,
+    so that the loop can be vectorized.
+   */
+  src=m_float_rows[first_row*m_resolution.x()].c_ptr();
+  dst=&m_pixels[first_row*row_size];
+  for(int i=0, endi=number_rows*row_size; i<endi; ++i)
+    {
+      float v;
+
+      v=std::max(0.0f, std::min(1.0f, src[i]));
+      dst[i]=static_cast<uint8_t>(255.0f*v);
+    }
+
+  glTexSubImage2D(GL_TEXTURE_2D,
+                  0, //LOD
+                  0, first_row, // coordinate of rect
+                  m_resolution.x(), number_rows, //size of rect
+                  GL_RGBA,
+                  GL_UNSIGNED_BYTE,
+                  dst);
+}
+
 void
 GradientTexture::
 flush(void)
 {
   std::set<int> dirty_grads;
   vecN<RawGradientData::handle, NUMBER_GRADIENTS_PER_TEXTURE> temp_handles;
+  int run_begin(-1), run_end(-1);
  
 
   /*
@@ -438,31 +546,54 @@ flush(void)
   std::swap(dirty_grads, m_dirty_grads);
   std::copy(m_grads.begin(), m_grads.end(), temp_handles.begin());
   WRATHUnlockMutex(m_mutex);
-  
 
+  if(dirty_grads.empty())
+    {
+      return;
+    }
+  
+  /*
+    m_float_rows is laid out as the texture,
+    only the dirty rows are written and read.
+    Rows of dirty gradients that are consecutive
+    are uploaded with one glTexSubImage2D call.
+   */
+  m_float_rows.resize(m_resolution.x()*m_resolution.y());
   for(std::set<int>::iterator iter=dirty_grads.begin(),
         end=dirty_grads.end(); iter!=end; ++iter)
     {
       int y(*iter);
 
-      if(temp_handles[y].valid())
+      if(!temp_handles[y].valid())
         {
-          const_c_array<uint8_t> color_bits(temp_handles[y]->color_bits());
-          glTexSubImage2D(GL_TEXTURE_2D,
-                          0, //LOD
-                          0, y, // coordinate of rect
-                          m_resolution.x(), 1, //size of rect
-                          GL_RGBA,
-                          GL_UNSIGNED_BYTE,
-                          color_bits.c_ptr());
+          continue;
         }
+
+      temp_handles[y]->interpolate(c_array<vec4>(&m_float_rows[y*m_resolution.x()], 
+                                                 m_resolution.x()));
+      if(run_begin!=-1 and run_end+1!=y)
+        {
+          upload_rows(run_begin, run_end);
+          run_begin=-1;
+        }
+
+      if(run_begin==-1)
+        {
+          run_begin=y;
+        }
+      run_end=y;
+    }
+
+  if(run_begin!=-1)
+    {
+      upload_rows(run_begin, run_end);
     }
 }
 
 
 WRATHReferenceCountedObject::handle
 GradientTexture::
-allocate(void)
+allocate(uint32_t log2_resolution)
 {
   int y;
 
@@ -481,16 +612,17 @@ allocate(void)
       m_free_ys.pop_back();
     }
 
-  if(NUMBER_GRADIENTS_PER_TEXTURE==m_current_y and m_free_ys.empty())
-    {
-      gradient_allocator().remove_from_free_list(m_log2_resolution, m_r, this);
-    }
-
   RawGradientData *ptr;
 
-  ptr=WRATHNew RawGradientData(m_resolution.x(), this, y);
+  ptr=WRATHNew RawGradientData(1<<log2_resolution, this, y);
   m_grads[y]=ptr;
 
+  /*
+    the row may hold the colors of 
+    a previously deleted gradient
+   */
+  m_dirty_grads.insert(y);
+
   return ptr;
 
 }
@@ -506,9 +638,7 @@ RawGradientData(int x_size, GradientTexture *pparent, int py):
   m_conversion_factor(static_cast<float>(x_size)),
   m_y_normalized(compute_texture_coordinate(py)),
   m_repeat_mode(pparent->repeat_mode()),
-  m_interpolate_color_value_float(x_size, vec4(1.0f, 1.0f, 1.0f, 1.0f)),
-  m_raw_color_bits(4*x_size, 255u),
-  m_user_alive(true)
+  m_interpolate_color_value_float(x_size, vec4(1.0f, 1.0f, 1.0f, 1.0f))
 {
   m_texture_coordinate_y_state_based_packing_data=WRATHNew WRATHGradient::GradientYCoordinate(m_y_normalized);
 }
@@ -567,110 +697,134 @@ texel(float t)
 
 void
 RawGradientData::
-flush(void)
+interpolate_texels(void)
 {
-  WRATHAutoLockMutex(m_mutex);
-  if(!m_stops.empty())
+  int lastIndex = 0;
+  vec4 lastColor;
+  int number_stops(m_stop_texels.size());
+
+  WRATHassert(number_stops>0);
+  switch(m_repeat_mode)
     {
-      int lastIndex = 0;
-      vec4 lastColor;
+    case WRATHGradient::Clamp:
+    case WRATHGradient::MirrorRepeat:
+      lastColor=m_stop_colors.front();
+      lastIndex=0;
+      break;
+    case WRATHGradient::Repeat:
+      lastColor=m_stop_colors.back();
+      lastIndex=-(m_resolution-1-m_stop_texels.back());
+      break;
+    }
       
-      switch(m_repeat_mode)
+  for(int s=0; s<number_stops; ++s)
+    {
+      vec4 nextColor(m_stop_colors[s]);
+      int nextIndex(m_stop_texels[s]);
+      float delta_t(nextIndex-lastIndex);
+          
+      if(nextIndex!=lastIndex)
         {
-        case WRATHGradient::Clamp:
-        case WRATHGradient::MirrorRepeat:
-          lastColor=m_stops.begin()->second;
-          lastIndex=0;
-          break;
-        case WRATHGradient::Repeat:
-          lastColor=m_stops.rbegin()->second;
-          lastIndex=-(m_resolution-1-m_stops.rbegin()->first);
-          break;
+          delta_t=1.0f/delta_t;
         }
-      
-      
-      for(std::map<int, vec4>::iterator iter=m_stops.begin(),
-            end=m_stops.end(); iter!=end; ++iter)
-        {
-          vec4 nextColor(iter->second);
-          float delta_t(iter->first-lastIndex);
-          
-          if(iter->first!=lastIndex)
-            {
-              delta_t=1.0f/delta_t;
-            }
           
-          for(int I=std::max(0,lastIndex), endI=iter->first; I<endI; ++I)
-            {
-              float t;
+      for(int I=std::max(0,lastIndex), endI=nextIndex; I<endI; ++I)
+        {
+          float t;
               
-              t=static_cast<float>(I-lastIndex)*delta_t;
-              m_interpolate_color_value_float[I] = (1.0f-t)*lastColor + t*nextColor;
-            }
-          lastColor=nextColor;
-          lastIndex=iter->first;
+          t=static_cast<float>(I-lastIndex)*delta_t;
+          m_interpolate_color_value_float[I] = (1.0f-t)*lastColor + t*nextColor;
         }
+      lastColor=nextColor;
+      lastIndex=nextIndex;
+    }
       
-      
-      
-      switch(m_repeat_mode)
+  switch(m_repeat_mode)
+    {
+    case WRATHGradient::Clamp:
+    case WRATHGradient::MirrorRepeat:
+      for(int I=lastIndex; I<m_resolution; ++I)
         {
-        case WRATHGradient::Clamp:
-        case WRATHGradient::MirrorRepeat:
-          for(int I=lastIndex; I<m_resolution; ++I)
-            {
-              m_interpolate_color_value_float[I]=lastColor;
-            }
-          break;
+          m_interpolate_color_value_float[I]=lastColor;
+        }
+      break;
           
-        case WRATHGradient::Repeat:
-          {
-            vec4 nextColor;
-            int delta_tI;
-            float delta_t;
+    case WRATHGradient::Repeat:
+      {
+        vec4 nextColor;
+        int delta_tI;
+        float delta_t;
             
-            nextColor=m_stops.begin()->second;
-            delta_tI=m_resolution-1-lastIndex+m_stops.begin()->first;
-            delta_t=(delta_tI!=0)?
-              1.0f/static_cast<float>(delta_tI):
-              0.0f;
+        nextColor=m_stop_colors.front();
+        delta_tI=m_resolution-1-lastIndex+m_stop_texels.front();
+        delta_t=(delta_tI!=0)?
+          1.0f/static_cast<float>(delta_tI):
+          0.0f;
             
-            for(int I=lastIndex; I<m_resolution; ++I)
-              {
-                float t;
+        for(int I=lastIndex; I<m_resolution; ++I)
+          {
+            float t;
                 
-                t=static_cast<float>(I-lastIndex)*delta_t;
-                m_interpolate_color_value_float[I] = (1.0f-t)*lastColor + t*nextColor;
-              }
+            t=static_cast<float>(I-lastIndex)*delta_t;
+            m_interpolate_color_value_float[I] = (1.0f-t)*lastColor + t*nextColor;
           }
-          break;
-        }
+      }
+      break;
+    }
+}
 
-      /*
-        dump that into m_image, note that raw_bytes is
-        twice as long, so that we set both "lines"
-        within m_image
-      */
-      c_array<uint8_t> raw_bytes_ptr(m_raw_color_bits);
-      c_array< vecN<uint8_t,4> > color_ptr;
-      
-      color_ptr=raw_bytes_ptr.reinterpret_pointer<vecN<uint8_t,4> >();
-      for(int i=0;i<m_resolution;++i)
-        {
-          for(int c=0;c<4;++c)
-            {
-              int32_t pre_clamp, clamped;
-              
-              pre_clamp=static_cast<int32_t>(255.0f*m_interpolate_color_value_float[i][c]);
-              clamped=std::max(0, std::min(255, pre_clamp));
-              
-              color_ptr[i][c]= static_cast<uint8_t>(clamped); 
-            }
-        }
+void
+RawGradientData::
+interpolate(c_array<vec4> out_row)
+{
+  WRATHAutoLockMutex(m_mutex);
+
+  if(m_stop_texels.empty())
+    {
+      std::fill(out_row.begin(), out_row.end(), vec4(1.0f, 1.0f, 1.0f, 1.0f));
+      return;
     }
-  else
+
+  interpolate_texels();
+  if(m_resolution==static_cast<int>(out_row.size()))
+    {
+      std::copy(m_interpolate_color_value_float.begin(), 
+                m_interpolate_color_value_float.end(),
+                out_row.begin());
+      return;
+    }
+
+  /*
+    resample to the width of the row as GL would 
+    linearly filter a texture of width m_resolution
+    with the wrap mode of the gradient. The sample
+    points are texel centers within [0,1], so only
+    the texels -1 and m_resolution need wrapping.
+   */
+  float scale(static_cast<float>(m_resolution)/static_cast<float>(out_row.size()));
+  for(int J=0, endJ=out_row.size(); J<endJ; ++J)
     {
-      std::fill(m_raw_color_bits.begin(), m_raw_color_bits.end(), 0xFF);
+      float s, f;
+      int i0, i1;
+
+      s=(static_cast<float>(J) + 0.5f)*scale - 0.5f;
+      i0=static_cast<int>(floorf(s));
+      f=s - static_cast<float>(i0);
+      i1=i0+1;
+
+      if(m_repeat_mode==WRATHGradient::Repeat)
+        {
+          i0=(i0<0)?m_resolution-1:i0;
+          i1=(i1>=m_resolution)?0:i1;
+        }
+      else
+        {
+          i0=std::max(i0, 0);
+          i1=std::min(i1, m_resolution-1);
+        }
+
+      out_row[J]=(1.0f-f)*m_interpolate_color_value_float[i0] 
+        + f*m_interpolate_color_value_float[i1];
     }
 }
 
@@ -729,7 +883,7 @@ void
 WRATHGradient::
 construct(const parameters &pp)
 {
-  m_data_handle=gradient_allocator().allocate(std::max(0, std::min(8, pp.m_log2_resolution)), 
+  m_data_handle=gradient_allocator().allocate(std::max(0, std::min(LOG2_GRADIENT_TEXTURE_WIDTH, pp.m_log2_resolution)), 
                                               pp.m_repeat_type);
 
   m_binder=m_data_handle.static_cast_handle<RawGradientData>()->binder();
@@ -26,6 +26,7 @@
 #include "WRATHUtil.hpp"
 #include "WRATHGPUConfig.hpp"
 #include "WRATHStaticInit.hpp"
+#include "WRATHProfiler.hpp"
 
 namespace
 {
@@ -606,6 +607,7 @@ bind_texture(int layer)
         iter=cmds.begin(), end=cmds.end();
       iter!=end; ++iter)
     {
+      WRATHProfileZone("WRATHImage::texture_upload");
       const TexSubImageCommand &value(*iter);
 
       if(value.m_clear_region)
@@ -0,0 +1,882 @@
+/*! 
+ * \file WRATHTiledImage.cpp
+ * \brief file WRATHTiledImage.cpp
+ * 
+ * Copyright 2013 by Nomovok Ltd.
+ * 
+ * Contact: info@nomovok.com
+ * 
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ * 
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ * 
+ */
+
+
+#include "WRATHConfig.hpp"
+#include <map>
+#include <list>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include "WRATHTiledImage.hpp"
+#include "WRATHTextureCoordinateSource.hpp"
+#include "WRATHMutex.hpp"
+#include "WRATHStaticInit.hpp"
+
+namespace
+{
+  /*
+    A TileStore is a texture holding tiles, each tile
+    is a cell of WRATHTiledImage::tile_cell_size texels
+    on a side. A tile of the TileStore may be shared
+    by any number of WRATHTiledImage objects, tiles
+    are found by their tile_key, a 128-bit hash of 
+    their texels. The texels of the tiles are not
+    kept on the CPU; the chance that two different
+    tiles of a process have the same tile_key is 
+    negligible.
+   */
+  typedef std::pair<uint64_t, uint64_t> tile_key;
+
+  class TileStore:boost::noncopyable
+  {
+  public:
+    TileStore(const WRATHImage::ImageFormat &fmt,
+              int number_cells_per_side);
+
+    ~TileStore();
+
+    WRATHImage*
+    image(void) const
+    {
+      return m_image;
+    }
+
+    const WRATHImage::ImageFormat&
+    format(void) const
+    {
+      return m_format;
+    }
+
+    int
+    number_free_cells(void) const
+    {
+      return m_free_cells.size();
+    }
+
+    int
+    number_used_cells(void) const
+    {
+      return m_ref_counts.size() - m_free_cells.size();
+    }
+
+    bool
+    empty(void) const
+    {
+      return m_free_cells.size()==m_ref_counts.size();
+    }
+
+    size_t
+    texture_bytes(void) const
+    {
+      return m_cell_bytes*m_ref_counts.size();
+    }
+
+    size_t
+    cell_bytes(void) const
+    {
+      return m_cell_bytes;
+    }
+
+    ivec2
+    cell_location(int cell) const
+    {
+      return ivec2(cell%m_number_cells_per_side,
+                   cell/m_number_cells_per_side);
+    }
+
+    /*
+      returns the cell holding the tile
+      with the key, or -1 if no such cell.
+     */
+    int
+    find(const tile_key &key) const;
+
+    /*
+      adds a tile to a free cell with a 
+      reference count of 1 and uploads it,
+      returns the cell. The contents of
+      tile are consumed by the upload.
+     */
+    int
+    add(const tile_key &key, std::vector<uint8_t> &tile);
+
+    void
+    acquire(int cell)
+    {
+      WRATHassert(m_ref_counts[cell]>0);
+      ++m_ref_counts[cell];
+    }
+
+    void
+    release(int cell);
+
+  private:
+    typedef std::map<tile_key, int> hash_map;
+
+    WRATHImage::ImageFormat m_format;
+    int m_number_cells_per_side;
+    size_t m_cell_bytes;
+    WRATHImage *m_image;
+
+    std::vector<int> m_ref_counts;
+    std::vector<int> m_free_cells;
+    std::vector<hash_map::iterator> m_hash_entries;
+    hash_map m_hash;
+  };
+
+  class TiledImageSource:public WRATHTextureCoordinateSource
+  {
+  public:
+    TiledImageSource(int xmode, int ymode);
+
+    const WRATHGLShader::shader_source&
+    shader_code(enum precision_t prec, enum interpolation_behaviour_t) const
+    {
+      return m_shader[prec];
+    }
+
+    virtual
+    enum interpolation_behaviour_t
+    adjust_interpolation_behavior(enum interpolation_behaviour_t) const
+    {
+      /*
+        the index lookup must be done
+        per fragment.
+       */
+      return fully_nonlinear_computation;
+    }
+
+    virtual
+    const_c_array<std::string>
+    global_scoped_symbols(enum precision_t, enum interpolation_behaviour_t) const;
+
+  private:
+    static
+    std::string
+    repeat_function(int mode);
+
+    vecN<WRATHGLShader::shader_source, 3> m_shader;
+  };
+
+  class TiledImageAllSources
+  {
+  public:
+    enum
+      {
+        count=WRATHTextureCoordinate::number_modes
+      };
+
+    TiledImageAllSources(void);
+    ~TiledImageAllSources();
+
+    vecN< vecN<TiledImageSource*,count>, count> m_sources;
+  };
+
+  class TileStoreRegistry:boost::noncopyable
+  {
+  public:
+    typedef std::list<TileStore*> store_list;
+
+    TileStoreRegistry(void):
+      m_tile_store_size(1024),
+      m_max_tile_store_size(2048)
+    {}
+
+    ~TileStoreRegistry();
+
+    WRATHMutex m_mutex;
+    std::map<WRATHImage::ImageFormat, store_list> m_stores;
+    int m_tile_store_size;
+    int m_max_tile_store_size;
+
+    /*
+      values of memory_stats() that are
+      tracked per WRATHTiledImage, the
+      values from the TileStore objects
+      are computed when requested.
+     */
+    WRATHTiledImage::memory_stats_type m_stats;
+  };
+
+  TileStoreRegistry&
+  registry(void)
+  {
+    WRATHStaticInit();
+    static TileStoreRegistry R;
+    return R;
+  }
+
+  /*
+    .first is the 64-bit FNV-1a hash, .second an
+    unrelated multiply-xorshift hash so that the
+    pair behaves as a 128-bit hash.
+   */
+  tile_key
+  compute_key(const std::vector<uint8_t> &values)
+  {
+    uint64_t h(14695981039346656037ULL), g(0);
+
+    for(std::vector<uint8_t>::const_iterator iter=values.begin(),
+          end=values.end(); iter!=end; ++iter)
+      {
+        h^=static_cast<uint64_t>(*iter);
+        h*=1099511628211ULL;
+
+        g=(g + static_cast<uint64_t>(*iter) + 1)*0x9E3779B97F4A7C15ULL;
+        g^=g >> 29;
+      }
+    return tile_key(h, g);
+  }
+
+  /*
+    extract the texels of the cell of a tile,
+    the boundary of the cell takes its values
+    from the neighbouring tiles, clamped to
+    the image.
+   */
+  void
+  extract_tile(const ivec2 &image_size, int bpp,
+               const std::vector<uint8_t> &pixels,
+               const ivec2 &tile,
+               std::vector<uint8_t> &out_tile)
+  {
+    const int C(WRATHTiledImage::tile_cell_size);
+    ivec2 start(tile*static_cast<int>(WRATHTiledImage::tile_size)
+                - ivec2(WRATHTiledImage::tile_border, WRATHTiledImage::tile_border));
+
+    out_tile.resize(C*C*bpp);
+    for(int y=0; y<C; ++y)
+      {
+        int sy(std::min(std::max(start.y() + y, 0), image_size.y() - 1));
+
+        for(int x=0; x<C; ++x)
+          {
+            int sx(std::min(std::max(start.x() + x, 0), image_size.x() - 1));
+
+            std::memcpy(&out_tile[(x + y*C)*bpp],
+                        &pixels[(sx + sy*image_size.x())*bpp],
+                        bpp);
+          }
+      }
+  }
+
+  class tile_entry
+  {
+  public:
+    tile_key m_key;
+
+    /*
+      texels of the tile, only kept until 
+      uploaded and only for the first tile
+      of each value.
+     */
+    std::vector<uint8_t> m_values;
+
+    /*
+      index into the tiles of the image
+      of the first tile with the same
+      value or -1 if this tile is the
+      first.
+     */
+    int m_same_as;
+  };
+}
+
+//////////////////////////////////////////
+// TileStore methods
+TileStore::
+TileStore(const WRATHImage::ImageFormat &fmt,
+          int number_cells_per_side):
+  m_format(fmt),
+  m_number_cells_per_side(number_cells_per_side),
+  m_ref_counts(number_cells_per_side*number_cells_per_side, 0),
+  m_hash_entries(number_cells_per_side*number_cells_per_side)
+{
+  int sz(number_cells_per_side*WRATHTiledImage::tile_cell_size);
+
+  m_cell_bytes=WRATHTiledImage::tile_cell_size
+    *WRATHTiledImage::tile_cell_size
+    *fmt.bytes_per_pixel();
+
+  m_image=WRATHNew WRATHImage(ivec2(sz, sz), fmt,
+                              WRATHImage::UniquePixelStore,
+                              GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
+
+  /*
+    take free cells from the back so that
+    the first cells are used first.
+   */
+  m_free_cells.reserve(m_ref_counts.size());
+  for(int c=m_ref_counts.size()-1; c>=0; --c)
+    {
+      m_free_cells.push_back(c);
+    }
+}
+
+TileStore::
+~TileStore()
+{
+  WRATHassert(empty());
+  WRATHDelete(m_image);
+}
+
+int
+TileStore::
+find(const tile_key &key) const
+{
+  hash_map::const_iterator iter;
+
+  iter=m_hash.find(key);
+  return (iter!=m_hash.end())?
+    iter->second:
+    -1;
+}
+
+int
+TileStore::
+add(const tile_key &key, std::vector<uint8_t> &tile)
+{
+  int cell;
+
+  WRATHassert(!m_free_cells.empty());
+  cell=m_free_cells.back();
+  m_free_cells.pop_back();
+
+  WRATHassert(m_ref_counts[cell]==0);
+  m_ref_counts[cell]=1;
+  m_hash_entries[cell]=m_hash.insert(hash_map::value_type(key, cell)).first;
+
+  m_image->respecify_sub_image(0, 0, m_format.m_pixel_format,
+                               tile,
+                               cell_location(cell)*static_cast<int>(WRATHTiledImage::tile_cell_size),
+                               ivec2(WRATHTiledImage::tile_cell_size,
+                                     WRATHTiledImage::tile_cell_size));
+  return cell;
+}
+
+void
+TileStore::
+release(int cell)
+{
+  WRATHassert(m_ref_counts[cell]>0);
+  --m_ref_counts[cell];
+  if(m_ref_counts[cell]==0)
+    {
+      m_hash.erase(m_hash_entries[cell]);
+      m_hash_entries[cell]=hash_map::iterator();
+      m_free_cells.push_back(cell);
+    }
+}
+
+//////////////////////////////////////////
+// TileStoreRegistry methods
+TileStoreRegistry::
+~TileStoreRegistry()
+{
+  for(std::map<WRATHImage::ImageFormat, store_list>::iterator
+        iter=m_stores.begin(), end=m_stores.end(); iter!=end; ++iter)
+    {
+      if(!iter->second.empty())
+        {
+          WRATHwarning("\n" << iter->second.size()
+                       << " tile stores of WRATHTiledImage not deleted");
+        }
+    }
+}
+
+//////////////////////////////////////////
+// TiledImageSource methods
+TiledImageSource::
+TiledImageSource(int x, int y)
+{
+  for(int iprec=0; iprec<3; ++iprec)
+    {
+      enum precision_t prec(static_cast<enum precision_t>(iprec));
+      const std::string &prec_as_string(prec_string(prec));
+
+      m_shader[iprec]
+        .add_macro("WRATH_IMAGE_REPEAT_MODE_PREC", prec_as_string)
+        .add_source("image-repeat-mode-functions.wrath-shader.glsl", WRATHGLShader::from_resource)
+        .add_macro("WRATH_IMAGE_REPEAT_MODE_X", repeat_function(x))
+        .add_macro("WRATH_IMAGE_REPEAT_MODE_Y", repeat_function(y))
+        .add_macro("WRATH_TILED_IMAGE_TILE_SIZE", static_cast<int>(WRATHTiledImage::tile_size))
+        .add_macro("WRATH_TILED_IMAGE_TILE_BORDER", static_cast<int>(WRATHTiledImage::tile_border))
+        .add_macro("WRATH_TILED_IMAGE_TILE_CELL_SIZE", static_cast<int>(WRATHTiledImage::tile_cell_size))
+        .add_source("tiled-image.compute.wrath-shader.glsl",
+                    WRATHGLShader::from_resource)
+        .remove_macro("WRATH_TILED_IMAGE_TILE_SIZE")
+        .remove_macro("WRATH_TILED_IMAGE_TILE_BORDER")
+        .remove_macro("WRATH_TILED_IMAGE_TILE_CELL_SIZE")
+        .remove_macro("WRATH_IMAGE_REPEAT_MODE_X")
+        .remove_macro("WRATH_IMAGE_REPEAT_MODE_Y")
+        .remove_macro("WRATH_IMAGE_REPEAT_MODE_PREC");
+    }
+}
+
+std::string
+TiledImageSource::
+repeat_function(int mode)
+{
+  switch(mode)
+    {
+    default:
+      WRATHwarning("unreconized mode " << mode);
+
+    case WRATHTextureCoordinate::simple:
+      return "wrath_compute_simple";
+
+    case WRATHTextureCoordinate::clamp:
+      return "wrath_compute_clamp";
+
+    case WRATHTextureCoordinate::repeat:
+      return "wrath_compute_repeat";
+
+    case WRATHTextureCoordinate::mirror_repeat:
+      return "wrath_compute_mirror_repeat";
+    }
+}
+
+const_c_array<std::string>
+TiledImageSource::
+global_scoped_symbols(enum precision_t, enum interpolation_behaviour_t) const
+{
+  static vecN<std::string, 4> values("wrath_compute_simple",
+                                     "wrath_compute_repeat",
+                                     "wrath_compute_clamp",
+                                     "wrath_compute_mirror_repeat");
+  return values;
+}
+
+//////////////////////////////////////////
+// TiledImageAllSources methods
+TiledImageAllSources::
+TiledImageAllSources(void)
+{
+  for(int x=0; x<count; ++x)
+    {
+      for(int y=0; y<count; ++y)
+        {
+          m_sources[x][y]=WRATHNew TiledImageSource(x,y);
+        }
+    }
+}
+
+TiledImageAllSources::
+~TiledImageAllSources(void)
+{
+  for(int x=0; x<count; ++x)
+    {
+      for(int y=0; y<count; ++y)
+        {
+          WRATHDelete(m_sources[x][y]);
+        }
+    }
+}
+
+//////////////////////////////////////////
+// WRATHTiledImage methods
+WRATHTiledImage::
+WRATHTiledImage(const ivec2 &sz,
+                const WRATHImage::ImageFormat &pfmt,
+                const std::vector<uint8_t> &pixels):
+  m_size(sz),
+  m_number_tiles((sz.x() + tile_size - 1)/tile_size,
+                 (sz.y() + tile_size - 1)/tile_size),
+  m_number_new_tiles(0),
+  m_store(NULL),
+  m_index_image(NULL),
+  m_untiled_image(NULL)
+{
+  WRATHImage::ImageFormat fmt(pfmt);
+  int bpp(fmt.bytes_per_pixel());
+  int number_tiles(m_number_tiles.x()*m_number_tiles.y());
+  std::vector<tile_entry> tiles(number_tiles);
+  std::vector<int> first_of_value;
+  TileStore *store(NULL);
+  int max_tile_store_size(0);
+
+  WRATHassert(sz.x()>0 and sz.y()>0);
+  WRATHassert(pixels.size()>=static_cast<size_t>(sz.x()*sz.y()*bpp));
+
+  /*
+    tiles are stored without mipmaps
+   */
+  fmt
+    .minification_filter(fmt.m_magnification_filter)
+    .automatic_mipmap_generation(false);
+
+  m_image_bytes=sz.x()*sz.y()*bpp;
+
+  /*
+    extract and hash the tiles outside of the
+    lock, then dedupe within the image itself
+   */
+  {
+    std::multimap<tile_key, int> local;
+
+    for(int ty=0, t=0; ty<m_number_tiles.y(); ++ty)
+      {
+        for(int tx=0; tx<m_number_tiles.x(); ++tx, ++t)
+          {
+            std::pair<std::multimap<tile_key, int>::iterator,
+                      std::multimap<tile_key, int>::iterator> R;
+
+            extract_tile(sz, bpp, pixels, ivec2(tx, ty), tiles[t].m_values);
+            tiles[t].m_key=compute_key(tiles[t].m_values);
+            tiles[t].m_same_as=-1;
+
+            R=local.equal_range(tiles[t].m_key);
+            for(std::multimap<tile_key, int>::iterator iter=R.first;
+                iter!=R.second and tiles[t].m_same_as==-1; ++iter)
+              {
+                if(tiles[iter->second].m_values==tiles[t].m_values)
+                  {
+                    tiles[t].m_same_as=iter->second;
+                  }
+              }
+
+            if(tiles[t].m_same_as==-1)
+              {
+                local.insert(std::make_pair(tiles[t].m_key, t));
+                first_of_value.push_back(t);
+              }
+            else
+              {
+                std::vector<uint8_t>().swap(tiles[t].m_values);
+              }
+          }
+      }
+  }
+
+  /*
+    the lock is only held to find and add the
+    tiles; the tiles to add are already extracted
+    and adding one only queues its upload.
+   */
+  {
+    TileStoreRegistry &R(registry());
+    WRATHAutoLockMutex(R.m_mutex);
+    TileStoreRegistry::store_list &stores(R.m_stores[fmt]);
+    int max_cells_per_side;
+
+    /*
+      the index image stores the cell location
+      as bytes and a tile store is never larger
+      than max_tile_store_size(), if the unique
+      tiles of the image do not fit in a single
+      tile store, the image is stored untiled.
+     */
+    max_tile_store_size=R.m_max_tile_store_size;
+    max_cells_per_side=std::min(256, max_tile_store_size/static_cast<int>(tile_cell_size));
+    if(static_cast<int>(first_of_value.size()) > max_cells_per_side*max_cells_per_side)
+      {
+        ++R.m_stats.m_number_untiled_images;
+        R.m_stats.m_untiled_bytes+=m_image_bytes;
+      }
+    else
+      {
+        m_cells.resize(number_tiles, -1);
+
+        /*
+          use the first store that can hold all the
+          tiles of this image that it does not already
+          have.
+         */
+        for(TileStoreRegistry::store_list::iterator iter=stores.begin(),
+              end=stores.end(); iter!=end and store==NULL; ++iter)
+          {
+            int needed(0);
+
+            for(std::vector<int>::const_iterator t=first_of_value.begin(),
+                  tend=first_of_value.end(); t!=tend; ++t)
+              {
+                if((*iter)->find(tiles[*t].m_key)==-1)
+                  {
+                    ++needed;
+                  }
+              }
+
+            if(needed<=(*iter)->number_free_cells())
+              {
+                store=*iter;
+              }
+          }
+
+        if(store==NULL)
+          {
+            int cells_per_side, needed_per_side;
+
+            cells_per_side=std::max(1, R.m_tile_store_size/static_cast<int>(tile_cell_size));
+            needed_per_side=static_cast<int>(std::ceil(std::sqrt(static_cast<float>(first_of_value.size()))));
+            cells_per_side=std::max(cells_per_side, needed_per_side);
+            cells_per_side=std::min(cells_per_side, max_cells_per_side);
+
+            store=WRATHNew TileStore(fmt, cells_per_side);
+            stores.push_back(store);
+            ++R.m_stats.m_number_tile_stores;
+          }
+
+        for(std::vector<int>::const_iterator t=first_of_value.begin(),
+              tend=first_of_value.end(); t!=tend; ++t)
+          {
+            int cell;
+
+            cell=store->find(tiles[*t].m_key);
+            if(cell==-1)
+              {
+                cell=store->add(tiles[*t].m_key, tiles[*t].m_values);
+                ++m_number_new_tiles;
+              }
+            else
+              {
+                store->acquire(cell);
+              }
+            m_cells[*t]=cell;
+          }
+
+        for(int t=0; t<number_tiles; ++t)
+          {
+            if(tiles[t].m_same_as!=-1)
+              {
+                m_cells[t]=m_cells[tiles[t].m_same_as];
+                store->acquire(m_cells[t]);
+              }
+          }
+
+        ++R.m_stats.m_number_images;
+        R.m_stats.m_number_tiles+=number_tiles;
+        R.m_stats.m_image_bytes+=m_image_bytes;
+        R.m_stats.m_index_bytes+=4*number_tiles;
+      }
+  }
+
+  if(store==NULL)
+    {
+      std::vector<uint8_t> upload(pixels.begin(), pixels.begin() + m_image_bytes);
+
+      WRATHwarning("\nWRATHTiledImage of size " << sz.x() << "x" << sz.y()
+                   << " has " << first_of_value.size()
+                   << " unique tiles, more than fit in a tile store of "
+                   << max_tile_store_size << " texels per side, storing it untiled");
+
+      m_untiled_image=WRATHNew WRATHImage(m_size, pfmt);
+      m_untiled_image->respecify_sub_image(0, 0, pfmt.m_pixel_format,
+                                           upload, ivec2(0, 0), m_size);
+      return;
+    }
+
+  m_store=store;
+
+  /*
+    the index image, one RGBA8 texel per tile
+    with .xy holding the location of the
+    cell of the tile in the tile store.
+   */
+  {
+    std::vector<uint8_t> index_values(4*number_tiles);
+    WRATHImage::ImageFormat index_fmt;
+
+    index_fmt
+      .internal_format(GL_RGBA)
+      .pixel_data_format(GL_RGBA)
+      .pixel_type(GL_UNSIGNED_BYTE)
+      .magnification_filter(GL_NEAREST)
+      .minification_filter(GL_NEAREST)
+      .automatic_mipmap_generation(false);
+
+    for(int t=0; t<number_tiles; ++t)
+      {
+        ivec2 loc(store->cell_location(m_cells[t]));
+
+        index_values[4*t + 0]=static_cast<uint8_t>(loc.x());
+        index_values[4*t + 1]=static_cast<uint8_t>(loc.y());
+        index_values[4*t + 2]=0;
+        index_values[4*t + 3]=255;
+      }
+
+    m_index_image=WRATHNew WRATHImage(m_number_tiles, index_fmt);
+    m_index_image->respecify_sub_image(0, 0, index_fmt.m_pixel_format,
+                                       index_values,
+                                       ivec2(0, 0), m_number_tiles);
+  }
+
+  /*
+    uniforms read by tiled-image.compute.wrath-shader.glsl
+   */
+  {
+    vec2 store_size(store->image()->size());
+    vec2 image_size(m_size);
+    vec2 index_atlas_size(m_index_image->atlas_size());
+    vec2 index_min(m_index_image->minX_minY());
+    vec2 recip_atlas(1.0f/index_atlas_size.x(), 1.0f/index_atlas_size.y());
+
+    m_uniforms[0]=WRATHNew WRATHUniformData::uniform_by_name<GLint>("wrath_tiled_image_IndexTexture",
+                                                                   index_texture_unit);
+    m_uniforms[1]=WRATHNew WRATHUniformData::uniform_by_name<vec4>("wrath_tiled_image_size",
+                                                                  vec4(image_size.x()/store_size.x(),
+                                                                       image_size.y()/store_size.y(),
+                                                                       image_size.x(),
+                                                                       image_size.y()));
+    m_uniforms[2]=WRATHNew WRATHUniformData::uniform_by_name<vec4>("wrath_tiled_image_index",
+                                                                  vec4(index_min.x(), index_min.y(),
+                                                                       recip_atlas.x(), recip_atlas.y()));
+    m_uniforms[3]=WRATHNew WRATHUniformData::uniform_by_name<vec2>("wrath_tiled_image_store_reciprocal_size",
+                                                                  vec2(1.0f/store_size.x(),
+                                                                       1.0f/store_size.y()));
+  }
+}
+
+WRATHTiledImage::
+~WRATHTiledImage()
+{
+  TileStore *store(static_cast<TileStore*>(m_store));
+  TileStoreRegistry &R(registry());
+  WRATHAutoLockMutex(R.m_mutex);
+
+  if(store==NULL)
+    {
+      WRATHDelete(m_untiled_image);
+      --R.m_stats.m_number_untiled_images;
+      R.m_stats.m_untiled_bytes-=m_image_bytes;
+      return;
+    }
+
+  for(std::vector<int>::const_iterator iter=m_cells.begin(),
+        end=m_cells.end(); iter!=end; ++iter)
+    {
+      store->release(*iter);
+    }
+
+  if(store->empty())
+    {
+      TileStoreRegistry::store_list &stores(R.m_stores[store->format()]);
+
+      stores.remove(store);
+      WRATHDelete(store);
+      --R.m_stats.m_number_tile_stores;
+    }
+
+  WRATHDelete(m_index_image);
+
+  --R.m_stats.m_number_images;
+  R.m_stats.m_number_tiles-=m_cells.size();
+  R.m_stats.m_image_bytes-=m_image_bytes;
+  R.m_stats.m_index_bytes-=4*m_cells.size();
+}
+
+WRATHImage*
+WRATHTiledImage::
+tile_image(void) const
+{
+  return (m_store!=NULL)?
+    static_cast<TileStore*>(m_store)->image():
+    NULL;
+}
+
+void
+WRATHTiledImage::
+set_brush(WRATHBrush &brush,
+          enum WRATHTextureCoordinate::repeat_mode_type repeat_mode_x,
+          enum WRATHTextureCoordinate::repeat_mode_type repeat_mode_y) const
+{
+  if(m_untiled_image!=NULL)
+    {
+      brush.m_image=m_untiled_image;
+      brush.m_texture_coordinate_source=WRATHTextureCoordinate::source(repeat_mode_x, repeat_mode_y);
+      return;
+    }
+
+  brush.m_image=tile_image();
+  brush.m_texture_coordinate_source=texture_coordinate_source(repeat_mode_x, repeat_mode_y);
+  brush.m_draw_state
+    .add_texture(GL_TEXTURE0 + index_texture_unit, m_index_image->texture_binder(0));
+
+  for(int i=0; i<4; ++i)
+    {
+      brush.m_draw_state.add_uniform(m_uniforms[i]);
+    }
+}
+
+const WRATHTextureCoordinateSourceBase*
+WRATHTiledImage::
+texture_coordinate_source(enum WRATHTextureCoordinate::repeat_mode_type repeat_mode_x,
+                          enum WRATHTextureCoordinate::repeat_mode_type repeat_mode_y)
+{
+  WRATHStaticInit();
+  static TiledImageAllSources R;
+  return R.m_sources[repeat_mode_x][repeat_mode_y];
+}
+
+WRATHTiledImage::memory_stats_type
+WRATHTiledImage::
+memory_stats(void)
+{
+  TileStoreRegistry &R(registry());
+  WRATHAutoLockMutex(R.m_mutex);
+  memory_stats_type return_value(R.m_stats);
+
+  for(std::map<WRATHImage::ImageFormat, TileStoreRegistry::store_list>::const_iterator
+        iter=R.m_stores.begin(), end=R.m_stores.end(); iter!=end; ++iter)
+    {
+      for(TileStoreRegistry::store_list::const_iterator s=iter->second.begin(),
+            send=iter->second.end(); s!=send; ++s)
+        {
+          return_value.m_number_unique_tiles+=(*s)->number_used_cells();
+          return_value.m_tile_bytes+=(*s)->number_used_cells()*(*s)->cell_bytes();
+          return_value.m_tile_store_bytes+=(*s)->texture_bytes();
+        }
+    }
+  return return_value;
+}
+
+void
+WRATHTiledImage::
+tile_store_size(int v)
+{
+  TileStoreRegistry &R(registry());
+  WRATHAutoLockMutex(R.m_mutex);
+  R.m_tile_store_size=std::max(v, static_cast<int>(tile_cell_size));
+}
+
+void
+WRATHTiledImage::
+max_tile_store_size(int v)
+{
+  TileStoreRegistry &R(registry());
+  WRATHAutoLockMutex(R.m_mutex);
+  R.m_max_tile_store_size=std::max(v, static_cast<int>(tile_cell_size));
+}
+
+int
+WRATHTiledImage::
+max_tile_store_size(void)
+{
+  TileStoreRegistry &R(registry());
+  WRATHAutoLockMutex(R.m_mutex);
+  return R.m_max_tile_store_size;
+}
+
+int
+WRATHTiledImage::
+tile_store_size(void)
+{
+  TileStoreRegistry &R(registry());
+  WRATHAutoLockMutex(R.m_mutex);
+  return R.m_tile_store_size;
+}
@@ -0,0 +1,85 @@
+/*! 
+ * \file tiled-image.compute.wrath-shader.glsl
+ * \brief file tiled-image.compute.wrath-shader.glsl
+ * 
+ * Copyright 2013 by Nomovok Ltd.
+ * 
+ * Contact: info@nomovok.com
+ * 
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ * 
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ * 
+ */
+
+
+
+
+/*
+  requires the symbols WRATH_IMAGE_REPEAT_MODE_X
+  and WRATH_IMAGE_REPEAT_MODE_Y which is a function
+  that consumes normalized coordinate and gives
+  normalized coordinates and the symbols
+  WRATH_TILED_IMAGE_TILE_SIZE, WRATH_TILED_IMAGE_TILE_BORDER
+  and WRATH_TILED_IMAGE_TILE_CELL_SIZE, see WRATHTiledImage.
+
+  Uniforms, set by WRATHTiledImage::set_brush():
+   - wrath_tiled_image_IndexTexture index image of the WRATHTiledImage,
+     .rg holds the location (in cells) of the tile in the tile store
+   - wrath_tiled_image_size .xy = size of image relative to the tile store
+     .zw = size of image in pixels
+   - wrath_tiled_image_index .xy = location of the index image within
+     its atlas, .zw = reciprocal of size of the atlas of the index image
+   - wrath_tiled_image_store_reciprocal_size reciprocal of size of the tile store
+ */
+
+uniform mediump sampler2D wrath_tiled_image_IndexTexture;
+uniform WRATH_IMAGE_REPEAT_MODE_PREC vec4 wrath_tiled_image_size;
+uniform WRATH_IMAGE_REPEAT_MODE_PREC vec4 wrath_tiled_image_index;
+uniform WRATH_IMAGE_REPEAT_MODE_PREC vec2 wrath_tiled_image_store_reciprocal_size;
+
+
+WRATH_IMAGE_REPEAT_MODE_PREC vec2
+wrath_compute_texture_coordinate(in WRATH_IMAGE_REPEAT_MODE_PREC vec2 p)
+{
+  WRATH_IMAGE_REPEAT_MODE_PREC vec2 q, pixel, tile, local, cell;
+  mediump vec4 index_value;
+
+  /*
+    p is relative to the tile store, q is
+    normalized to the image.
+   */
+  q=p/wrath_tiled_image_size.xy;
+
+  q.x=WRATH_IMAGE_REPEAT_MODE_X(q.x);
+  q.y=WRATH_IMAGE_REPEAT_MODE_Y(q.y);
+
+  #ifdef WRATH_BRUSH_FLIP_IMAGE_Y
+  {
+    q.y = 1.0 - q.y;
+  }
+  #endif
+
+  /*
+    keep the pixel within the image so that
+    tile never refers past the index image
+   */
+  pixel=clamp(q*wrath_tiled_image_size.zw,
+              vec2(0.0, 0.0),
+              wrath_tiled_image_size.zw - vec2(0.5, 0.5));
+
+  tile=floor(pixel/float(WRATH_TILED_IMAGE_TILE_SIZE));
+  local=pixel - float(WRATH_TILED_IMAGE_TILE_SIZE)*tile;
+
+  index_value=texture2D(wrath_tiled_image_IndexTexture,
+                        (wrath_tiled_image_index.xy + tile + vec2(0.5, 0.5))*wrath_tiled_image_index.zw);
+  cell=floor(255.0*index_value.xy + vec2(0.5, 0.5));
+
+  return (cell*float(WRATH_TILED_IMAGE_TILE_CELL_SIZE)
+          + vec2(float(WRATH_TILED_IMAGE_TILE_BORDER), float(WRATH_TILED_IMAGE_TILE_BORDER))
+          + local)*wrath_tiled_image_store_reciprocal_size;
+}
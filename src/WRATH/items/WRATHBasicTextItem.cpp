@@ -21,6 +21,7 @@
 #include <limits>
 #include "WRATHBasicTextItem.hpp"
 #include "WRATHTextAttributePacker.hpp"
+#include "WRATHFontShaderSpecifier.hpp"
 
 
 
@@ -59,6 +60,7 @@ WRATHBasicTextItem::per_page_type::
     {
       m_index_data_location.delete_group();
     }
+  delete_instance_groups();
 
   if(m_item_group.valid())
     {
@@ -80,9 +82,50 @@ clear(void)
       c_array<GLushort> ptr(m_index_data_location.pointer());
       std::fill(ptr.begin(), ptr.end(), 0);
     }
+  delete_instance_groups();
   m_required=WRATHTextAttributePacker::allocation_requirement_type();
 }
 
+void
+WRATHBasicTextItem::per_page_type::
+delete_instance_groups(void)
+{
+  for(std::vector<WRATHIndexGroupAllocator::instance_group>::iterator 
+        iter=m_instance_groups.begin(), end=m_instance_groups.end();
+      iter!=end; ++iter)
+    {
+      if(iter->valid())
+        {
+          iter->delete_group();
+        }
+    }
+  m_instance_groups.clear();
+}
+
+void
+WRATHBasicTextItem::per_page_type::
+create_instance_groups(void)
+{
+  int remaining(m_required.m_number_attributes);
+
+  /*
+    the packer packs its attributes into the
+    first m_required.m_number_attributes elements
+    of m_attribute_location, in order.
+   */
+  delete_instance_groups();
+  for(std::vector<range_type<int> >::const_iterator 
+        iter=m_attribute_location.begin(), end=m_attribute_location.end();
+      iter!=end and remaining>0; ++iter)
+    {
+      int count(std::min(remaining, iter->m_end - iter->m_begin));
+
+      m_instance_groups.push_back(m_item_group.allocate_instance_group(range_type<int>(iter->m_begin,
+                                                                                      iter->m_begin + count)));
+      remaining-=count;
+    }
+}
+
 void
 WRATHBasicTextItem::per_page_type::
 change_attribute_store(void)
@@ -148,6 +191,13 @@ allocate_room_if_needed(void)
            */
           m_allocated.m_number_indices=0;
 
+          /*
+            the instance groups belong to the
+            old group, they are re-created by
+            set_text()
+           */
+          delete_instance_groups();
+
           if(m_item_group.valid())
             {
               m_item_group.release_group();
@@ -192,16 +242,17 @@ set_text(const_c_array<range_type<int> > R,
 
   if(m_item_group.valid())
     {
-      {
-        /*
-          "clear" all the indices since any indices within
-          m_index_data_location beyond m_required.m_number_indices
-          are not set by the attribute packer.
-         */
-        WRATHAutoLockMutex(m_index_data_location.mutex());
-        c_array<GLushort> indices_ptr(m_index_data_location.pointer());
-        std::fill(indices_ptr.begin(), indices_ptr.end(), 0);
-      }
+      if(m_index_data_location.valid())
+        {
+          /*
+            "clear" all the indices since any indices within
+            m_index_data_location beyond m_required.m_number_indices
+            are not set by the attribute packer.
+          */
+          WRATHAutoLockMutex(m_index_data_location.mutex());
+          c_array<GLushort> indices_ptr(m_index_data_location.pointer());
+          std::fill(indices_ptr.begin(), indices_ptr.end(), 0);
+        }
       m_parent->m_packer->set_attribute_data(R, 
                                              m_parent->m_font, 
                                              m_texture_page, 
@@ -210,7 +261,10 @@ set_text(const_c_array<range_type<int> > R,
                                              m_index_data_location, 
                                              pdata, state_stream, out_bounds_box);
 
-      
+      if(instanced())
+        {
+          create_instance_groups();
+        }
 
     }
   
@@ -223,9 +277,18 @@ canvas(WRATHCanvas *c)
 {
   enum return_code R;
 
-  R=c->transfer(m_item_group,
-                m_attribute_location,
-                m_index_data_location);
+  if(instanced())
+    {
+      R=c->transfer(m_item_group,
+                    m_attribute_location,
+                    m_instance_groups);
+    }
+  else
+    {
+      R=c->transfer(m_item_group,
+                    m_attribute_location,
+                    m_index_data_location);
+    }
   
   WRATHassert(R==routine_success);
   WRATHunused(R);
@@ -378,8 +441,12 @@ generate_key(std::set<WRATHItemDrawState> &skey,
              int page)
 {
 
+  WRATHTextureChoice::texture_base::handle glyph_table;
+
   m_packer->attribute_key(attribute_key,
                           m_font->glyph_glsl()->m_custom_data_use.size());
+  attribute_key.stream_buffer_count(m_extra_state.m_stream_buffer_count);
+  glyph_table=m_packer->glyph_table(m_font);
 
   for(int i=0, end_i=m_passes.size(); i!=end_i; ++i)
     {
@@ -410,6 +477,14 @@ generate_key(std::set<WRATHItemDrawState> &skey,
         {
           pkey.add_texture(GL_TEXTURE0+i, Ts[i]);
         }
+
+      if(glyph_table.valid())
+        {
+          int unit;
+
+          unit=WRATHFontShaderSpecifier::glyph_table_texture_unit(m_font->glyph_glsl());
+          pkey.add_texture(GL_TEXTURE0+unit, glyph_table);
+        }
       pkey.absorb(m_extra_state.named_state(tp));
       pkey.absorb(m_extra_state.m_common_pass_state);
       
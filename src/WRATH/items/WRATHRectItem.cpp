@@ -59,7 +59,9 @@ WRATHRectItem(const WRATHItemDrawerFactory &factory, int subdrawer_id,
   WRATHassert(canvas!=NULL);
 
 
-  attr_key.buffer_object_hint(drawer.m_buffer_object_hint);
+  attr_key
+    .buffer_object_hint(drawer.m_buffer_object_hint)
+    .stream_buffer_count(drawer.m_stream_buffer_count);
   m_packer->attribute_key(attr_key);
   attr_handle=canvas->attribute_store(attr_key, 4, m_attribute_data_location);
    
@@ -10,7 +10,7 @@ include $(dir)/Rules.mk
 dir := $(d)/node_packers
 include $(dir)/Rules.mk
 
-LIB_SOURCES += $(call filelist, WRATHLayerBase.cpp WRATHLayer.cpp WRATHLayerNodeValuePackerBase.cpp WRATHLayerItemDrawerFactory.cpp WRATHLayerItemNodeBase.cpp WRATHLayerClipDrawerMesh.cpp)
+LIB_SOURCES += $(call filelist, WRATHLayerBase.cpp WRATHLayer.cpp WRATHLayerNodeValuePackerBase.cpp WRATHLayerItemDrawerFactory.cpp WRATHLayerItemNodeBase.cpp WRATHLayerClipDrawerMesh.cpp WRATHLayerTextDocument.cpp)
 
 # Begin standard footer
 d		:= $(dirstack_$(sp))
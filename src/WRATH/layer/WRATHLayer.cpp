@@ -19,8 +19,13 @@
 
 
 #include "WRATHConfig.hpp"
+#include <cmath>
+#include <algorithm>
+#include <typeinfo>
 #include "WRATHLayer.hpp"
 #include "WRATHBaseItem.hpp"
+#include "WRATHProfiler.hpp"
+#include "WRATHGLStateShadow.hpp"
 
 /*
   Implementation overview:
@@ -80,12 +85,77 @@
          clipping. Popping the stack non-trivially just means drawing to the
          stencil buffer with stencil op to decrementing and setting the stencil
          test to one less once done drawing.
+
+   7) Clipping by a clip drawer is done with the scissor test instead
+      of the stencil buffer when the clip mode is layer_clipped_sibling 
+      and the clip drawer reports that the region is exactly its device 
+      bounding box (DrawStateElementClipping::m_device_bbox_exact). The 
+      scissor box is intersected with the scissor box of the enclosing
+      element of the draw_state and restored when the stack is popped.
+
+   8) When a layer clipped with layer_clipped_sibling by the stencil 
+      buffer (and without clipped-in items) pops its clipping, the stencil 
+      values are not decremented right away; instead they are recorded in 
+      draw_state::m_retained_clip. If the next sibling's clip drawer 
+      reports (via WRATHLayerClipDrawer::shares_clip_region()) that it clips 
+      to the same region, the sibling uses the stencil values as is. 
+      Otherwise, the retained region is decremented by release_retained_clip() 
+      before anything else is drawn. The parent releases any retained region 
+      once its children are drawn and before drawing batched children.
  
 */
 
 
 namespace
 {
+  vecN<GLint, 4>
+  compute_scissor_box(const WRATHBBox<2> &device_bbox,
+                      const vecN<GLint, 4> &viewport)
+  {
+    /*
+      the rasterizer covers a pixel if its center 
+      is inside a primitive, so we round to the 
+      pixels whose centers are inside of device_bbox.
+     */
+    vecN<GLint, 4> R;
+    vec2 pmin, pmax;
+    
+    pmin=device_bbox.min_corner();
+    pmax=device_bbox.max_corner();
+    for(int i=0;i<2;++i)
+      {
+        float fmin, fmax;
+        GLint imin, imax;
+
+        fmin=0.5f*(pmin[i] + 1.0f)*static_cast<float>(viewport[2+i]);
+        fmax=0.5f*(pmax[i] + 1.0f)*static_cast<float>(viewport[2+i]);
+
+        imin=static_cast<GLint>(std::ceil(fmin - 0.5f));
+        imax=static_cast<GLint>(std::ceil(fmax - 0.5f));
+
+        R[i]=viewport[i] + imin;
+        R[2+i]=std::max(0, imax - imin);
+      }
+    return R;
+  }
+
+  vecN<GLint, 4>
+  intersect_scissor_box(const vecN<GLint, 4> &a, const vecN<GLint, 4> &b)
+  {
+    vecN<GLint, 4> R;
+
+    for(int i=0;i<2;++i)
+      {
+        GLint imin, imax;
+
+        imin=std::max(a[i], b[i]);
+        imax=std::min(a[i] + a[2+i], b[i] + b[2+i]);
+        R[i]=imin;
+        R[2+i]=std::max(0, imax - imin);
+      }
+    return R;
+  }
+
   const float4x4&
   matrix(const WRATHLayer *v,
          enum WRATHLayer::matrix_type tp)
@@ -103,14 +173,14 @@ namespace
     {
        /**
          N9's GLES2 implementation how do I hate thee.
-         Doing glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE)
+         Doing WRATHGLStateShadow::color_mask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE)
          also disables depth and stencil writes.
          
          So to get around one does:
           
-          glEnable(GL_BLEND);
-          glBlendFunc(GL_ZERO, GL_ONE);
-          glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+          WRATHGLStateShadow::enable(GL_BLEND);
+          WRATHGLStateShadow::blend_func(GL_ZERO, GL_ONE);
+          WRATHGLStateShadow::color_mask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
 
         but we also need to note the state vector,
         so what we do is that we make the "current"
@@ -123,13 +193,13 @@ namespace
         {
           gl_state.gl_state_change(NULL);
         }
-      glEnable(GL_BLEND);
-      glBlendFunc(GL_ZERO, GL_ONE);
+      WRATHGLStateShadow::enable(GL_BLEND);
+      WRATHGLStateShadow::blend_func(GL_ZERO, GL_ONE);
     }
     #else
     {
       WRATHunused(gl_state);
-      glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+      WRATHGLStateShadow::color_mask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
     }
     #endif
   }
@@ -143,12 +213,12 @@ namespace
         {
           gl_state.gl_state_change(NULL);        
         }
-      glDisable(GL_BLEND);
+      WRATHGLStateShadow::disable(GL_BLEND);
     }
     #else
     {
       WRATHunused(gl_state);
-      glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+      WRATHGLStateShadow::color_mask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
     }
     #endif
   }
@@ -276,6 +346,15 @@ WRATHLayer::draw_state::
 draw_state(void)
 {
   push_back(NULL, WRATHLayerClipDrawer::layer_unclipped, 0);
+
+  /*
+    respect the scissor test set by the application
+   */
+  m_stack.back().m_scissor_test=WRATHGLStateShadow::is_enabled(GL_SCISSOR_TEST);
+  if(m_stack.back().m_scissor_test)
+    {
+      m_stack.back().m_scissor_box=WRATHGLStateShadow::scissor();
+    }
 }
 
 void
@@ -297,6 +376,42 @@ push_back(WRATHLayer *layer,
 
   m_stack.back().m_write_z=false;
   m_stack.back().m_clipped=true;
+  m_stack.back().m_scissored=false;
+
+  if(m_stack.size()>1)
+    {
+      const draw_state_element &parent(m_stack[m_stack.size()-2]);
+
+      m_stack.back().m_scissor_test=parent.m_scissor_test;
+      m_stack.back().m_scissor_box=parent.m_scissor_box;
+    }
+  else
+    {
+      m_stack.back().m_scissor_test=false;
+    }
+
+  if(m_stack.back().m_clipping_mode==WRATHLayerClipDrawer::layer_clipped_sibling
+     and cl.m_device_bbox_exact)
+    {
+      /*
+        clipping region is a screen aligned 
+        rectangle, use the scissor test instead 
+        of the stencil buffer.
+       */
+      vecN<GLint, 4> box;
+      const vecN<GLint, 4> &viewport(WRATHGLStateShadow::viewport());
+
+      box=compute_scissor_box(cl.m_device_bbox, viewport);
+      box=intersect_scissor_box(box, 
+                                (m_stack.back().m_scissor_test)?
+                                m_stack.back().m_scissor_box:
+                                viewport);
+
+      m_stack.back().m_scissored=true;
+      m_stack.back().m_clipping_mode=WRATHLayerClipDrawer::layer_unclipped;
+      m_stack.back().m_scissor_test=true;
+      m_stack.back().m_scissor_box=box;
+    }
 
   switch(m_stack.back().m_clipping_mode)
     {
@@ -351,6 +466,7 @@ WRATHLayer(const WRATHTripleBufferEnabler::handle &tr,
   m_child_order(0), 
   m_clip_drawer(pclipper),
   m_visible(1),
+  m_batch_with_siblings(0),
   m_render_children_need_sorting(true)
 {
   /*
@@ -377,6 +493,7 @@ WRATHLayer(WRATHLayer *pparent,
   m_child_order(0), 
   m_clip_drawer(pclipper),
   m_visible(1),
+  m_batch_with_siblings(0),
   m_render_children_need_sorting(true)
 {
   parent(pparent);
@@ -643,6 +760,27 @@ visible(void)
   return __sync_fetch_and_or(&m_visible, 0)!=0;
 }
 
+void
+WRATHLayer::
+batch_with_siblings(bool b)
+{
+  if(b)
+    {
+      __sync_fetch_and_or(&m_batch_with_siblings, 1);
+    }
+  else
+    {
+      __sync_fetch_and_and(&m_batch_with_siblings, 0);
+    }
+}
+
+bool
+WRATHLayer::
+batch_with_siblings(void) 
+{
+  return __sync_fetch_and_or(&m_batch_with_siblings, 0)!=0;
+}
+
 
 void
 WRATHLayer::
@@ -680,16 +818,23 @@ clear_and_draw(GLbitfield mask,
                const float4x4 *pre_modelview_matrix,
                draw_information *p)
 {
-  glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-  glDepthMask(GL_TRUE);
-  glStencilMask(~0);
-  glClearStencil(0);
+  /*
+    clear_and_draw() starts a frame, so this
+    is where the shadow is invalidated once 
+    per frame if the application changes GL
+    state without going through WRATHGLStateShadow.
+   */
+  if(WRATHGLStateShadow::external_gl_state_changes())
+    {
+      WRATHGLStateShadow::invalidate();
+    }
+
+  WRATHGLStateShadow::color_mask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+  WRATHGLStateShadow::depth_mask(GL_TRUE);
+  WRATHGLStateShadow::stencil_mask(~0);
+  WRATHGLStateShadow::clear_stencil(0);
 
-#if defined(WRATH_GL_VERSION)
-  glClearDepth(1.0);
-#else
-  glClearDepthf(1.0f);
-#endif
+  WRATHGLStateShadow::clear_depth(1.0f);
 
   glClear(mask);
   draw(pre_modelview_matrix, p);
@@ -700,7 +845,6 @@ WRATHLayer::
 draw(const float4x4 *pre_modelview_matrix,
      draw_information *p)
 {
-  draw_state state_stack;
   draw_information R;
 
   if(p==NULL)
@@ -708,19 +852,25 @@ draw(const float4x4 *pre_modelview_matrix,
       p=&R;
     }
 
+  WRATHGLStateShadow::color_mask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+  WRATHGLStateShadow::depth_mask(GL_TRUE);
+  WRATHGLStateShadow::stencil_mask(~0);
 
-  glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-  glDepthMask(GL_TRUE);
-  glStencilMask(~0);
-
-  glEnable(GL_STENCIL_TEST);
-  glEnable(GL_DEPTH_TEST);
-  glDepthFunc(GL_LESS);
+  WRATHGLStateShadow::enable(GL_STENCIL_TEST);
+  WRATHGLStateShadow::enable(GL_DEPTH_TEST);
+  WRATHGLStateShadow::depth_func(GL_LESS);
 
+  /*
+    draw_state reads the scissor state
+    from WRATHGLStateShadow, so it is created
+    after WRATHGLStateShadow is invalidated.
+   */
+  draw_state state_stack;
   WRATHRawDrawData::DrawState gl_state(WRATHMultiGLProgram::Selector(), p);
 
   gl_state.draw_begin();
   draw_implement(pre_modelview_matrix, state_stack, gl_state, *p, NULL);
+  release_retained_clip(state_stack, gl_state);
   gl_state.draw_end();
 }
 
@@ -733,6 +883,7 @@ draw_implement(const float4x4 *pre_modelview_matrix,
                draw_information &stats,
                WRATHLayer *from)
 {
+  WRATHProfileZone("WRATHLayer::draw_implement");
   bool have_clip_items(false);
 
   if(!visible())
@@ -755,7 +906,7 @@ draw_implement(const float4x4 *pre_modelview_matrix,
   /*
     push clipping
    */
-  if(false==push_clipping(state_stack, have_clip_items, gl_state))
+  if(false==push_clipping(state_stack, have_clip_items, gl_state, stats))
     {
       /*
         completely clipped, return immediately
@@ -774,9 +925,9 @@ draw_implement(const float4x4 *pre_modelview_matrix,
    */
   if(!render_raw_datas(WRATHDrawType::clip_outside_draw).empty())
     {
-      glDepthMask(GL_TRUE);
-      glEnable(GL_DEPTH_TEST);
-      glDepthFunc(GL_LESS);
+      WRATHGLStateShadow::depth_mask(GL_TRUE);
+      WRATHGLStateShadow::enable(GL_DEPTH_TEST);
+      WRATHGLStateShadow::depth_func(GL_LESS);
       disable_color_buffer_write(gl_state);
       gl_state.selector(WRATHBaseItem::selector_non_color_draw());
       draw_render_items(gl_state, render_raw_datas(WRATHDrawType::clip_outside_draw) );
@@ -795,14 +946,35 @@ draw_implement(const float4x4 *pre_modelview_matrix,
     }
 
   /*
-    draw children
+    draw children, consecutive children
+    that are batchable are drawn together
    */
   for(std::list<WRATHLayer*>::iterator iter=m_render_children.begin(),
-        end=m_render_children.end(); iter!=end; ++iter)
+        end=m_render_children.end(); iter!=end; )
     {
-      //note: only the root WRATHLayer uses pre_modelview_matrix.
-      (*iter)->draw_implement(NULL, state_stack, gl_state, stats, this);
+      std::list<WRATHLayer*>::iterator batch_end(iter);
+      int batch_size(0);
+
+      while(batch_end!=end and (*batch_end)->render_batchable())
+        {
+          ++batch_end;
+          ++batch_size;
+        }
+
+      if(batch_size>1)
+        {
+          release_retained_clip(state_stack, gl_state);
+          draw_batched_children(iter, batch_end, gl_state, stats);
+          iter=batch_end;
+        }
+      else
+        {
+          //note: only the root WRATHLayer uses pre_modelview_matrix.
+          (*iter)->draw_implement(NULL, state_stack, gl_state, stats, this);
+          ++iter;
+        }
     }
+  release_retained_clip(state_stack, gl_state);
 
   draw_content_post_children(gl_state);
 
@@ -814,6 +986,123 @@ draw_implement(const float4x4 *pre_modelview_matrix,
   m_render_parent=NULL;
 }
 
+bool
+WRATHLayer::
+render_batchable(void)
+{
+  return batch_with_siblings()
+    and batchable_content()
+    and visible()
+    and m_render_children.empty()
+    and !render_clip_drawer().valid()
+    and render_raw_datas(WRATHDrawType::clip_inside_draw).empty()
+    and render_raw_datas(WRATHDrawType::clip_outside_draw).empty();
+}
+
+bool
+WRATHLayer::
+batchable_content(void)
+{
+  /*
+    a derived class may draw its content differently
+    in draw_content_pre_children() or 
+    draw_content_post_children(), which batched drawing
+    skips, so only plain WRATHLayer objects are batchable
+    unless the derived class says otherwise.
+   */
+  return typeid(*this)==typeid(WRATHLayer);
+}
+
+void
+WRATHLayer::
+draw_batched_children(std::list<WRATHLayer*>::iterator begin,
+                      std::list<WRATHLayer*>::iterator end,
+                      WRATHRawDrawData::DrawState &gl_state,
+                      draw_information &stats)
+{
+  /*
+    The layers of the batch have the same clipping 
+    as this WRATHLayer, thus there is no clipping
+    to push or pop. We need though to compute the 
+    matrices of all the layers before drawing any 
+    of them, since the uniforms of the layers read
+    the matrices when they are bound.
+   */
+  m_render_batch.clear();
+  for(std::list<WRATHLayer*>::iterator iter=begin; iter!=end; ++iter)
+    {
+      WRATHLayer *layer(*iter);
+
+      WRATHassert(layer->render_batchable());
+      layer->m_render_parent=this;
+      layer->set_render_matrices(NULL);
+      m_render_batch.push_back(layer);
+    }
+  stats.m_layer_count+=m_render_batch.size();
+  stats.m_batched_layer_count+=m_render_batch.size();
+  ++stats.m_layer_batch_count;
+
+  /*
+    opaque items: the draw order does not matter, 
+    so merge them into a single list sorted by
+    GL state.
+   */
+  enable_color_buffer_write(gl_state);
+  WRATHGLStateShadow::depth_mask(GL_TRUE);
+  WRATHGLStateShadow::enable(GL_DEPTH_TEST);
+  WRATHGLStateShadow::depth_func(GL_LESS);
+  WRATHGLStateShadow::disable(GL_BLEND);
+
+  gl_state.selector(WRATHBaseItem::selector_draw());
+  m_render_merged_list.clear();
+  for(std::vector<WRATHLayer*>::iterator iter=m_render_batch.begin(),
+        iter_end=m_render_batch.end(); iter!=iter_end; ++iter)
+    {
+      m_render_merged_list.add((*iter)->render_raw_datas(WRATHDrawType::opaque_draw));
+    }
+  m_render_merged_list.draw(gl_state);
+  gl_state.flush_draws();
+
+  /*
+    the remaining passes depend on draw order,
+    draw them layer by layer in child order.
+   */
+  WRATHGLStateShadow::depth_func(GL_ALWAYS);
+  gl_state.selector(WRATHBaseItem::selector_draw());
+  for(std::vector<WRATHLayer*>::iterator iter=m_render_batch.begin(),
+        iter_end=m_render_batch.end(); iter!=iter_end; ++iter)
+    {
+      draw_render_items(gl_state, (*iter)->render_raw_datas(WRATHDrawType::opaque_overdraw));
+    }
+  gl_state.flush_draws();
+
+  WRATHGLStateShadow::depth_mask(GL_FALSE);
+  WRATHGLStateShadow::depth_func(GL_LESS);
+  WRATHGLStateShadow::enable(GL_BLEND);
+  gl_state.selector(WRATHBaseItem::selector_draw());
+  for(std::vector<WRATHLayer*>::iterator iter=m_render_batch.begin(),
+        iter_end=m_render_batch.end(); iter!=iter_end; ++iter)
+    {
+      draw_render_items(gl_state, (*iter)->render_raw_datas(WRATHDrawType::transparent_draw));
+    }
+  gl_state.flush_draws();
+
+  WRATHGLStateShadow::disable(GL_DEPTH_TEST);
+  gl_state.selector(WRATHBaseItem::selector_draw());
+  for(std::vector<WRATHLayer*>::iterator iter=m_render_batch.begin(),
+        iter_end=m_render_batch.end(); iter!=iter_end; ++iter)
+    {
+      draw_render_items(gl_state, (*iter)->render_raw_datas(WRATHDrawType::transparent_overdraw));
+    }
+  gl_state.flush_draws();
+
+  for(std::vector<WRATHLayer*>::iterator iter=m_render_batch.begin(),
+        iter_end=m_render_batch.end(); iter!=iter_end; ++iter)
+    {
+      (*iter)->m_render_parent=NULL;
+    }
+}
+
 void
 WRATHLayer::
 draw_render_items(WRATHRawDrawData::DrawState &gl_state,
@@ -841,17 +1130,17 @@ draw_content_pre_children(WRATHRawDrawData::DrawState &gl_state)
     futzes with the blending state.
    */
   enable_color_buffer_write(gl_state);
-  glDepthMask(GL_TRUE);
-  glEnable(GL_DEPTH_TEST);
-  glDepthFunc(GL_LESS);
+  WRATHGLStateShadow::depth_mask(GL_TRUE);
+  WRATHGLStateShadow::enable(GL_DEPTH_TEST);
+  WRATHGLStateShadow::depth_func(GL_LESS);
 
-  glDisable(GL_BLEND);
+  WRATHGLStateShadow::disable(GL_BLEND);
 
   gl_state.selector(WRATHBaseItem::selector_draw());
   draw_render_items(gl_state, render_raw_datas(WRATHDrawType::opaque_draw));
   gl_state.flush_draws();
 
-  glDepthFunc(GL_ALWAYS);
+  WRATHGLStateShadow::depth_func(GL_ALWAYS);
   gl_state.selector(WRATHBaseItem::selector_draw());
   draw_render_items(gl_state, render_raw_datas(WRATHDrawType::opaque_overdraw));
   gl_state.flush_draws();
@@ -879,16 +1168,16 @@ draw_content_post_children(WRATHRawDrawData::DrawState &gl_state)
     futzes with the blending state.
    */
   enable_color_buffer_write(gl_state);
-  glDepthMask(GL_FALSE);
-  glEnable(GL_DEPTH_TEST);
-  glDepthFunc(GL_LESS);
-  glEnable(GL_BLEND);
+  WRATHGLStateShadow::depth_mask(GL_FALSE);
+  WRATHGLStateShadow::enable(GL_DEPTH_TEST);
+  WRATHGLStateShadow::depth_func(GL_LESS);
+  WRATHGLStateShadow::enable(GL_BLEND);
 
   gl_state.selector(WRATHBaseItem::selector_draw());
   draw_render_items(gl_state, render_raw_datas(WRATHDrawType::transparent_draw));
   gl_state.flush_draws();
 
-  glDisable(GL_DEPTH_TEST);
+  WRATHGLStateShadow::disable(GL_DEPTH_TEST);
   gl_state.selector(WRATHBaseItem::selector_draw());
   draw_render_items(gl_state, render_raw_datas(WRATHDrawType::transparent_overdraw));
   gl_state.flush_draws();
@@ -928,11 +1217,11 @@ push_clipped_in_items(draw_state &state_stack, bool &have_clip_items,
         the values of the z-buffer either.
        */
       disable_color_buffer_write(gl_state);
-      glStencilFunc(GL_EQUAL, current_stencil, ~0);
-      glDepthMask(GL_FALSE);
-      glDepthFunc(GL_ALWAYS);
+      WRATHGLStateShadow::stencil_func(GL_EQUAL, current_stencil, ~0);
+      WRATHGLStateShadow::depth_mask(GL_FALSE);
+      WRATHGLStateShadow::depth_func(GL_ALWAYS);
 
-      glStencilOp(GL_KEEP, GL_KEEP, GL_INCR);
+      WRATHGLStateShadow::stencil_op(GL_KEEP, GL_KEEP, GL_INCR);
       gl_state.selector(WRATHBaseItem::selector_non_color_draw());
       for(;i!=e; ++i)
         {
@@ -940,8 +1229,8 @@ push_clipped_in_items(draw_state &state_stack, bool &have_clip_items,
         }
       gl_state.flush_draws();
 
-      glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);  
-      glStencilFunc(GL_EQUAL, state_stack.back().m_stencil_value, ~0);
+      WRATHGLStateShadow::stencil_op(GL_KEEP, GL_KEEP, GL_KEEP);  
+      WRATHGLStateShadow::stencil_func(GL_EQUAL, state_stack.back().m_stencil_value, ~0);
     }
 }
 
@@ -969,16 +1258,16 @@ pop_clipped_in_items(draw_state &state_stack, bool have_clip_items,
 
       disable_color_buffer_write(gl_state);
 
-      glStencilFunc(GL_EQUAL, v.m_stencil_value, ~0);
-      glStencilOp(GL_KEEP, GL_KEEP, GL_DECR);
+      WRATHGLStateShadow::stencil_func(GL_EQUAL, v.m_stencil_value, ~0);
+      WRATHGLStateShadow::stencil_op(GL_KEEP, GL_KEEP, GL_DECR);
 
       //depth func is set to always so that
       //regardless of what was drawn, the stencil
       //buffer gets decremented; but we do NOT
       //want to change the depth values, so
       //depth buffer is masked out.
-      glDepthFunc(GL_ALWAYS);
-      glDepthMask(GL_FALSE);
+      WRATHGLStateShadow::depth_func(GL_ALWAYS);
+      WRATHGLStateShadow::depth_mask(GL_FALSE);
 
       gl_state.selector(WRATHBaseItem::selector_non_color_draw_cover());
       draw_render_items(gl_state, render_raw_datas(WRATHDrawType::clip_inside_draw));
@@ -986,8 +1275,8 @@ pop_clipped_in_items(draw_state &state_stack, bool have_clip_items,
 
       state_stack.pop_back();
 
-      glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
-      glStencilFunc(GL_EQUAL, state_stack.back().m_stencil_value, ~0);
+      WRATHGLStateShadow::stencil_op(GL_KEEP, GL_KEEP, GL_KEEP);
+      WRATHGLStateShadow::stencil_func(GL_EQUAL, state_stack.back().m_stencil_value, ~0);
     }
 }
 
@@ -995,7 +1284,8 @@ pop_clipped_in_items(draw_state &state_stack, bool have_clip_items,
 bool
 WRATHLayer::
 push_clipping(draw_state &state_stack, bool &have_clip_items,
-              WRATHRawDrawData::DrawState &gl_state)
+              WRATHRawDrawData::DrawState &gl_state,
+              draw_information &stats)
 {
   WRATHLayerClipDrawer::DrawStateElementClipping cl(WRATHLayerClipDrawer::layer_unclipped);
   int current_stencil;
@@ -1013,6 +1303,34 @@ push_clipping(draw_state &state_stack, bool &have_clip_items,
       return false;
     }
 
+  /*
+    if the previous sibling left its clipping region 
+    in the stencil buffer, reuse it if we clip to
+    the same region, otherwise clear it.
+   */
+  bool reuse_retained_clip(false);
+  const retained_clip &retained(state_stack.m_retained_clip);
+
+  if(retained.m_clip_drawer.valid())
+    {
+      if(cl.m_clip_mode==WRATHLayerClipDrawer::layer_clipped_sibling
+         and !cl.m_device_bbox_exact
+         and render_raw_datas(WRATHDrawType::clip_inside_draw).empty())
+        {
+          WRATHLayerClipDrawer::DrawStateElement next(this);
+
+          next.m_transformations=m_current_render_transformation;
+          next.m_clipping=cl;
+          reuse_retained_clip=retained.m_clip_drawer->shares_clip_region(retained.m_element,
+                                                                         clip_drawer.raw_pointer(),
+                                                                         next);
+        }
+
+      if(!reuse_retained_clip)
+        {
+          release_retained_clip(state_stack, gl_state);
+        }
+    }
   
   /*
     Draw clipped in items first
@@ -1030,7 +1348,23 @@ push_clipping(draw_state &state_stack, bool &have_clip_items,
    */
   state_stack.push_back(this, cl, current_stencil);
 
-  if(state_stack.back().m_clipped)
+  if(reuse_retained_clip)
+    {
+      WRATHassert(state_stack.back().m_clipped);
+      WRATHassert(state_stack.back().m_stencil_value==retained.m_stencil_value);
+
+      ++stats.m_shared_clip_count;
+      state_stack.m_retained_clip=retained_clip();
+      WRATHGLStateShadow::stencil_func(GL_EQUAL, state_stack.back().m_stencil_value, ~0);
+    }
+  else if(state_stack.back().m_scissored)
+    {
+      ++stats.m_scissor_clip_count;
+      gl_state.flush_draws();
+      WRATHGLStateShadow::enable(GL_SCISSOR_TEST);
+      WRATHGLStateShadow::scissor(state_stack.back().m_scissor_box);
+    }
+  else if(state_stack.back().m_clipped)
     {
       WRATHassert(clip_drawer.valid());
 
@@ -1039,7 +1373,7 @@ push_clipping(draw_state &state_stack, bool &have_clip_items,
       
       // pass stencil test only if stencil value equals
       // current render depth.
-      glStencilFunc(GL_EQUAL, current_stencil, ~0);
+      WRATHGLStateShadow::stencil_func(GL_EQUAL, current_stencil, ~0);
       
       if(state_stack.back().m_write_z)
         {
@@ -1050,8 +1384,8 @@ push_clipping(draw_state &state_stack, bool &have_clip_items,
             clip region will draw z values that
             need to pass the depth test.
           */
-          glDepthMask(GL_TRUE);
-          glDepthFunc(GL_LESS);
+          WRATHGLStateShadow::depth_mask(GL_TRUE);
+          WRATHGLStateShadow::depth_func(GL_LESS);
         }
       else
         {
@@ -1063,27 +1397,27 @@ push_clipping(draw_state &state_stack, bool &have_clip_items,
             z-test always passing ANd we do
             NOT write to z-buffer.
            */
-          glDepthMask(GL_FALSE);
-          glDepthFunc(GL_ALWAYS);
+          WRATHGLStateShadow::depth_mask(GL_FALSE);
+          WRATHGLStateShadow::depth_func(GL_ALWAYS);
         }
 
       // increment when both depth and stencil tests pass
-      glStencilOp(GL_KEEP, GL_KEEP, GL_INCR);
+      WRATHGLStateShadow::stencil_op(GL_KEEP, GL_KEEP, GL_INCR);
 
       //now draw the region with the "usual z".
       clip_drawer->draw_region(false, state_stack.draw_stack().back(), state_stack.draw_stack());
 
       
-      glStencilFunc(GL_EQUAL, state_stack.back().m_stencil_value, ~0);
-      glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+      WRATHGLStateShadow::stencil_func(GL_EQUAL, state_stack.back().m_stencil_value, ~0);
+      WRATHGLStateShadow::stencil_op(GL_KEEP, GL_KEEP, GL_KEEP);
 
       if(state_stack.back().m_write_z)
         {
           //now draw the region but clearing the z-values,
           //use the stencil test only to get the correct pixels
           //touched
-          glDepthMask(GL_TRUE);
-          glDepthFunc(GL_ALWAYS);
+          WRATHGLStateShadow::depth_mask(GL_TRUE);
+          WRATHGLStateShadow::depth_func(GL_ALWAYS);
 
           //draw the region so z written is 1.0 (clear value).
           clip_drawer->draw_region(true, state_stack.draw_stack().back(), state_stack.draw_stack());
@@ -1106,15 +1440,38 @@ pop_clipping(draw_state &state_stack, bool have_clip_items,
   const draw_state_element &v(state_stack.back());
   const WRATHLayerClipDrawer::handle &clip_drawer(render_clip_drawer());
 
-  if(v.m_clipped)
+  if(v.m_clipped 
+     and v.m_clipping_mode==WRATHLayerClipDrawer::layer_clipped_sibling
+     and !have_clip_items)
+    {
+      /*
+        do not restore the stencil buffer yet,
+        the next sibling may clip to the same
+        region, see release_retained_clip().
+       */
+      retained_clip &retained(state_stack.m_retained_clip);
+
+      WRATHassert(!retained.m_clip_drawer.valid());
+      WRATHassert(clip_drawer.valid());
+
+      retained.m_clip_drawer=clip_drawer;
+      retained.m_element=state_stack.draw_stack().back();
+      retained.m_render_parent=m_render_parent;
+      retained.m_stencil_value=v.m_stencil_value;
+    }
+  else if(v.m_scissored)
+    {
+      gl_state.flush_draws();
+    }
+  else if(v.m_clipped)
     {
       disable_color_buffer_write(gl_state);
       gl_state.draw_end();
 
-      glStencilFunc(GL_EQUAL, v.m_stencil_value, ~0);
-      glStencilOp(GL_KEEP, GL_KEEP, GL_DECR);
+      WRATHGLStateShadow::stencil_func(GL_EQUAL, v.m_stencil_value, ~0);
+      WRATHGLStateShadow::stencil_op(GL_KEEP, GL_KEEP, GL_DECR);
 
-      glDepthFunc(GL_ALWAYS);
+      WRATHGLStateShadow::depth_func(GL_ALWAYS);
       if(state_stack.back().m_write_z)
         {
           /*
@@ -1129,25 +1486,83 @@ pop_clipping(draw_state &state_stack, bool have_clip_items,
               we can cap the "portal" with the z
               write of clip_draw()
            */
-          glDepthMask(GL_TRUE);
+          WRATHGLStateShadow::depth_mask(GL_TRUE);
         }
       else
         {
-          glDepthMask(GL_FALSE);
+          WRATHGLStateShadow::depth_mask(GL_FALSE);
         }
 
       WRATHassert(clip_drawer.valid());
       clip_drawer->draw_region(false, state_stack.draw_stack().back(), state_stack.draw_stack());
 
       //make stencil op do nothing
-      glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+      WRATHGLStateShadow::stencil_op(GL_KEEP, GL_KEEP, GL_KEEP);
 
       gl_state.draw_begin();
     }
 
   //restore stencil test
+  bool restore_scissor(v.m_scissored);
+
   state_stack.pop_back();
-  glStencilFunc(GL_EQUAL, state_stack.back().m_stencil_value, ~0);
+  WRATHGLStateShadow::stencil_func(GL_EQUAL, state_stack.back().m_stencil_value, ~0);
+
+  if(restore_scissor)
+    {
+      if(state_stack.back().m_scissor_test)
+        {
+          WRATHGLStateShadow::scissor(state_stack.back().m_scissor_box);
+        }
+      else
+        {
+          WRATHGLStateShadow::disable(GL_SCISSOR_TEST);
+        }
+    }
 
   pop_clipped_in_items(state_stack, have_clip_items, gl_state);
 }
+
+void
+WRATHLayer::
+release_retained_clip(draw_state &state_stack,
+                      WRATHRawDrawData::DrawState &gl_state)
+{
+  retained_clip &retained(state_stack.m_retained_clip);
+
+  if(!retained.m_clip_drawer.valid())
+    {
+      return;
+    }
+
+  WRATHLayer *layer(retained.m_element.m_layer);
+
+  /*
+    the clip drawer may read the render parent
+    of the layer, which was reset when the layer 
+    finished drawing.
+   */
+  WRATHassert(layer!=NULL);
+  WRATHassert(layer->m_render_parent==NULL);
+  layer->m_render_parent=retained.m_render_parent;
+
+  disable_color_buffer_write(gl_state);
+  gl_state.draw_end();
+
+  WRATHGLStateShadow::stencil_func(GL_EQUAL, retained.m_stencil_value, ~0);
+  WRATHGLStateShadow::stencil_op(GL_KEEP, GL_KEEP, GL_DECR);
+  WRATHGLStateShadow::depth_func(GL_ALWAYS);
+  WRATHGLStateShadow::depth_mask(GL_FALSE);
+
+  state_stack.push_draw_stack(retained.m_element);
+  retained.m_clip_drawer->draw_region(false, state_stack.draw_stack().back(), state_stack.draw_stack());
+  state_stack.pop_draw_stack();
+
+  WRATHGLStateShadow::stencil_op(GL_KEEP, GL_KEEP, GL_KEEP);
+  WRATHGLStateShadow::stencil_func(GL_EQUAL, state_stack.back().m_stencil_value, ~0);
+
+  gl_state.draw_begin();
+
+  layer->m_render_parent=NULL;
+  state_stack.m_retained_clip=retained_clip();
+}
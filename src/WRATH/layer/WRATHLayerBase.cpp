@@ -520,7 +520,7 @@ WRATHLayerBase::
 WRATHLayerBase(const WRATHTripleBufferEnabler::handle &tr,
                const WRATHDrawOrderComparer::handle sorter):
   WRATHCanvas(tr, type_tag<NodeIndexAttribute>(), 
-                           NodeIndexAttribute( GLubyte(0) )),
+                           NodeIndexAttribute( GLushort(0) )),
   m_sorter(sorter)
 {
 }
@@ -20,6 +20,7 @@
 
 #include "WRATHConfig.hpp"
 #include "WRATHLayerItemNodeBase.hpp"
+#include "WRATHProfiler.hpp"
 
 namespace
 {
@@ -305,6 +306,7 @@ root_walk(void)
   WRATHassert(m_root==this);
   if(m_is_dirty)
     {
+      WRATHProfileZone("WRATHLayerItemNodeBase::root_walk");
       compute_values();
       walk_hierarchy();
       m_is_dirty=false;
@@ -20,6 +20,9 @@
 #include "WRATHConfig.hpp"
 #include "WRATHLayerNodeValuePackerBase.hpp"
 #include "WRATHLayerItemNodeBase.hpp"
+#include "WRATHProfiler.hpp"
+#include "WRATHTime.hpp"
+#include <cmath>
 
 /*
   Implementation overview:
@@ -36,8 +39,52 @@
      written to directly or the values are copied
      into the correct index of m_data_to_pack_to_GL
 
+  3) If the node type specifies an extrapolation type for
+     some of its values, pack_data also records when the
+     data was packed and the rates of the values (either
+     from the node via extract_values_and_rates() or by
+     differencing against the buffer packed the previous
+     simulation frame). The rates of a node are zeroed if
+     its values did not change or jumped from the previous
+     simulation frame. At the start of each presentation
+     frame, the rendering thread extrapolates the values
+     of the present ID by the elapsed time (clamped to the
+     time between the two most recent packs) into
+     m_extrapolated, which is then what is returned by
+     DataToGL::data_to_pack_to_GL().
+
  */
 
+namespace
+{
+  int32_t&
+  max_extrapolation_time_int(void)
+  {
+    static int32_t R(0);
+    return R;
+  }
+
+  float&
+  max_extrapolation_jump_float(void)
+  {
+    static float R(64.0f);
+    return R;
+  }
+
+  /*
+    constructed at static initialization so that
+    the simulation and rendering thread do not 
+    race to create it.
+   */
+  WRATHTime extrapolation_timer;
+
+  int32_t
+  extrapolation_clock(void)
+  {
+    return extrapolation_timer.elapsed();
+  }
+}
+
 
 
 
@@ -158,6 +205,13 @@ absorb(const ActiveNodeValuesCollection &obj, GLenum shader_stage,
     {
       absorb(iter->second, shader_stage, hnd);
     }
+
+  for(std::map<int, enum extrapolation_type>::const_iterator 
+        eiter=obj.m_extrapolation.begin(), eend=obj.m_extrapolation.end();
+      eiter!=eend; ++eiter)
+    {
+      m_extrapolation.insert(*eiter);
+    }
   return *this;
 }
 
@@ -294,7 +348,8 @@ per_packer_datum(WRATHLayerNodeValuePackerBase *pparent):
   m_number_active(0),
   m_data_to_pack_to_GL(m_data_to_pack_to_GL_padded[0],
                        m_data_to_pack_to_GL_padded[1],
-                       m_data_to_pack_to_GL_padded[2])
+                       m_data_to_pack_to_GL_padded[2]),
+  m_extrapolated_valid(false)
 {}
 
 
@@ -302,15 +357,51 @@ WRATHLayerNodeValuePackerBase::per_packer_datum::
 per_packer_datum(WRATHLayerNodeValuePackerBase *pparent,
                  const ActiveNodeValues &used_per_node_values,
                  const NodeDataPackParameters &packing_params,
-                 int one_plus_highest_index):
+                 const ActiveNodeValuesCollection &original_data):
   m_parent(pparent),
   m_permutation_array(used_per_node_values.m_permutation_array),
   m_packing_type(packing_params.m_packing_type),
   m_float_alignment(packing_params.m_float_alignment),
-  m_number_active(used_per_node_values.number_active())
+  m_number_active(used_per_node_values.number_active()),
+  m_extrapolated_valid(false)
 {
   
-  m_permutation_array.resize(one_plus_highest_index, -1);
+  m_permutation_array.resize(original_data.one_plus_highest_index(), -1);
+
+  /*
+    record those active values that are extrapolated,
+    a complex pair is only extrapolated if both
+    parts are active.
+   */
+  for(std::map<int, enum extrapolation_type>::const_iterator
+        iter=original_data.extrapolation_entries().begin(),
+        end=original_data.extrapolation_entries().end();
+      iter!=end; ++iter)
+    {
+      extrapolation_entry E;
+
+      E.m_type=iter->second;
+      E.m_offset=used_per_node_values.node_value_active(iter->first)?
+        used_per_node_values.m_permutation_array[iter->first]:
+        -1;
+      E.m_offset_imag=-1;
+
+      if(E.m_type==extrapolate_complex_exponential)
+        {
+          E.m_offset_imag=used_per_node_values.node_value_active(iter->first+1)?
+            used_per_node_values.m_permutation_array[iter->first+1]:
+            -1;
+          if(E.m_offset_imag==-1)
+            {
+              E.m_offset=-1;
+            }
+        }
+
+      if(E.m_type!=extrapolate_none and E.m_offset!=-1)
+        {
+          m_extrapolation.push_back(E);
+        }
+    }
 
   /*
     substitute the -1 for values starting at m_number_active
@@ -364,9 +455,19 @@ per_packer_datum(WRATHLayerNodeValuePackerBase *pparent,
        */
       entire_array=m_data_to_pack_to_GL_padded[i];
       m_data_to_pack_to_GL[i]=entire_array.sub_array(0, m_padded_row_size_in_floats*number_rows);
+
+      if(!m_extrapolation.empty())
+        {
+          m_rates[i].resize(new_size, 0.0f);
+        }
     }
 
   m_pack_work_room.resize(m_permutation_array.size());  
+  if(!m_extrapolation.empty())
+    {
+      m_rate_work_room.resize(m_permutation_array.size(), 0.0f);
+      m_extrapolated.resize(m_data_to_pack_to_GL_padded[0].size(), 0.0f);
+    }
 }
   
 void
@@ -374,8 +475,61 @@ WRATHLayerNodeValuePackerBase::per_packer_datum::
 pack_data(int number_slots)
 {
   c_array<float> write_to;
+  int ID(m_parent->triple_buffer_enabler()->current_simulation_ID());
+
+  write_to=m_data_to_pack_to_GL_padded[ID];
+  if(!m_extrapolation.empty() and m_parent->m_extrapolating)
+    {
+      c_array<float> rate_to(m_rates[ID]);
+      int32_t dt_ms(m_parent->m_pack_time[ID] - m_parent->m_pack_time[m_parent->m_previous_pack_ID]);
+      float dt(static_cast<float>(dt_ms)/1000.0f);
+
+      for(int node=0; node<number_slots; ++node)
+        {
+          WRATHLayerItemNodeBase *N(m_parent->m_nodes[node]);
+          bool have_rates;
+
+          if(N==NULL)
+            {
+              continue;
+            }
+
+          if(m_packing_type==NodeDataPackParameters::packed_by_node)
+            {
+              int start(node*m_padded_row_size_in_floats);
+
+              have_rates=N->extract_values_and_rates(reorder_c_array<float>(write_to.sub_array(start, m_permutation_array.size()), 
+                                                                            m_permutation_array),
+                                                     reorder_c_array<float>(rate_to.sub_array(start, m_permutation_array.size()), 
+                                                                            m_permutation_array));
+            }
+          else
+            {
+              have_rates=N->extract_values_and_rates(reorder_c_array<float>(m_pack_work_room, m_permutation_array),
+                                                     reorder_c_array<float>(m_rate_work_room, m_permutation_array));
+              for(int V=0; V<m_number_active; ++V)
+                {
+                  write_to[V*m_padded_row_size_in_floats + node]=m_pack_work_room[V];
+                  rate_to[V*m_padded_row_size_in_floats + node]=m_rate_work_room[V];
+                }
+            }
+
+          bool same_node(dt_ms>0 
+                         and node<static_cast<int>(m_parent->m_previous_nodes.size())
+                         and m_parent->m_previous_nodes[node]==N);
+
+          if(same_node and rates_are_stale(node))
+            {
+              zero_rates(node);
+            }
+          else if(!have_rates)
+            {
+              compute_rates(node, same_node?dt:0.0f);
+            }
+        }
+      return;
+    }
 
-  write_to=m_data_to_pack_to_GL_padded[m_parent->triple_buffer_enabler()->current_simulation_ID()];
   if(m_packing_type==NodeDataPackParameters::packed_by_node)
     {
       c_array<float> node_write_to;
@@ -411,6 +565,191 @@ pack_data(int number_slots)
     }
 }
 
+void
+WRATHLayerNodeValuePackerBase::per_packer_datum::
+compute_rates(int node, float dt)
+{
+  /*
+    compute the rates from the values packed now
+    and the values packed the previous simulation
+    frame, a dt of 0 indicates that there are no
+    previous values for the node, thus the rates
+    are zero.
+   */
+  int ID(m_parent->triple_buffer_enabler()->current_simulation_ID());
+  const std::vector<float> &current(m_data_to_pack_to_GL_padded[ID]);
+  const std::vector<float> &previous(m_data_to_pack_to_GL_padded[m_parent->m_previous_pack_ID]);
+  std::vector<float> &rates(m_rates[ID]);
+
+  for(std::vector<extrapolation_entry>::const_iterator 
+        iter=m_extrapolation.begin(), end=m_extrapolation.end();
+      iter!=end; ++iter)
+    {
+      int L(location(node, iter->m_offset));
+
+      if(dt<=0.0f)
+        {
+          rates[L]=0.0f;
+          if(iter->m_offset_imag!=-1)
+            {
+              rates[location(node, iter->m_offset_imag)]=0.0f;
+            }
+          continue;
+        }
+
+      switch(iter->m_type)
+        {
+        default:
+        case extrapolate_linear:
+          rates[L]=(current[L] - previous[L])/dt;
+          break;
+
+        case extrapolate_exponential:
+          /*
+            only extrapolate if the sign did
+            not change.
+           */
+          rates[L]=(current[L]*previous[L]>0.0f)?
+            std::log(current[L]/previous[L])/dt:
+            0.0f;
+          break;
+
+        case extrapolate_complex_exponential:
+          {
+            int LI(location(node, iter->m_offset_imag));
+            float re1(current[L]), im1(current[LI]);
+            float re0(previous[L]), im0(previous[LI]);
+            float mag1(re1*re1 + im1*im1), mag0(re0*re0 + im0*im0);
+
+            if(mag1>0.0f and mag0>0.0f)
+              {
+                /*
+                  z1/z0 = |z1|/|z0| * exp(i*theta) where 
+                  theta is the angle from z0 to z1.
+                 */
+                rates[L]=0.5f*std::log(mag1/mag0)/dt;
+                rates[LI]=std::atan2(re0*im1 - im0*re1, re0*re1 + im0*im1)/dt;
+              }
+            else
+              {
+                rates[L]=rates[LI]=0.0f;
+              }
+          }
+          break;
+        }
+    }
+}
+
+bool
+WRATHLayerNodeValuePackerBase::per_packer_datum::
+rates_are_stale(int node) const
+{
+  /*
+    the rates of a node are not to be used if none
+    of its extrapolated values changed since the
+    previous simulation frame (the node stopped) or
+    if a linearly extrapolated value changed by more
+    than max_extrapolation_jump() (the node was moved
+    discontinuously). Must only be called if the node
+    at the slot is the same node as the previous
+    simulation frame.
+   */
+  int ID(m_parent->triple_buffer_enabler()->current_simulation_ID());
+  const std::vector<float> &current(m_data_to_pack_to_GL_padded[ID]);
+  const std::vector<float> &previous(m_data_to_pack_to_GL_padded[m_parent->m_previous_pack_ID]);
+  float jump(max_extrapolation_jump_float());
+  bool changed(false);
+
+  for(std::vector<extrapolation_entry>::const_iterator 
+        iter=m_extrapolation.begin(), end=m_extrapolation.end();
+      iter!=end; ++iter)
+    {
+      int L(location(node, iter->m_offset));
+      float delta(std::abs(current[L] - previous[L]));
+
+      if(iter->m_type==extrapolate_linear and jump>0.0f and delta>jump)
+        {
+          return true;
+        }
+
+      changed=changed or delta>0.0f;
+      if(iter->m_offset_imag!=-1)
+        {
+          int LI(location(node, iter->m_offset_imag));
+          changed=changed or current[LI]!=previous[LI];
+        }
+    }
+  return !changed;
+}
+
+void
+WRATHLayerNodeValuePackerBase::per_packer_datum::
+zero_rates(int node)
+{
+  int ID(m_parent->triple_buffer_enabler()->current_simulation_ID());
+  std::vector<float> &rates(m_rates[ID]);
+
+  for(std::vector<extrapolation_entry>::const_iterator 
+        iter=m_extrapolation.begin(), end=m_extrapolation.end();
+      iter!=end; ++iter)
+    {
+      rates[location(node, iter->m_offset)]=0.0f;
+      if(iter->m_offset_imag!=-1)
+        {
+          rates[location(node, iter->m_offset_imag)]=0.0f;
+        }
+    }
+}
+
+void
+WRATHLayerNodeValuePackerBase::per_packer_datum::
+extrapolate_data(int number_slots, float t)
+{
+  if(m_extrapolation.empty())
+    {
+      return;
+    }
+
+  int ID(m_parent->triple_buffer_enabler()->present_ID());
+  const std::vector<float> &values(m_data_to_pack_to_GL_padded[ID]);
+  const std::vector<float> &rates(m_rates[ID]);
+
+  std::copy(values.begin(), values.end(), m_extrapolated.begin());
+  for(int node=0; node<number_slots; ++node)
+    {
+      for(std::vector<extrapolation_entry>::const_iterator 
+            iter=m_extrapolation.begin(), end=m_extrapolation.end();
+          iter!=end; ++iter)
+        {
+          int L(location(node, iter->m_offset));
+
+          switch(iter->m_type)
+            {
+            default:
+            case extrapolate_linear:
+              m_extrapolated[L]=values[L] + t*rates[L];
+              break;
+
+            case extrapolate_exponential:
+              m_extrapolated[L]=values[L]*std::exp(t*rates[L]);
+              break;
+
+            case extrapolate_complex_exponential:
+              {
+                int LI(location(node, iter->m_offset_imag));
+                float s(std::exp(t*rates[L]));
+                float c(s*std::cos(t*rates[LI])), d(s*std::sin(t*rates[LI]));
+
+                m_extrapolated[L]=values[L]*c - values[LI]*d;
+                m_extrapolated[LI]=values[L]*d + values[LI]*c;
+              }
+              break;
+            }
+        }
+    }
+  m_extrapolated_valid=true;
+}
+
 /////////////////////////////////////////////////////
 // WRATHLayerNodeValuePackerBase::DataToGL methods
 WRATHLayerNodeValuePackerBase*
@@ -444,6 +783,11 @@ data_to_pack_to_GL(void) const
 {
   const per_packer_datum *p(static_cast<const per_packer_datum*>(m_actual_data));
   int I(p->m_parent->triple_buffer_enabler()->present_ID());
+
+  if(p->m_extrapolated_valid)
+    {
+      return const_c_array<float>(p->m_extrapolated).sub_array(0, p->m_data_to_pack_to_GL[I].size());
+    }
   return p->m_data_to_pack_to_GL[I];
 }
 
@@ -465,11 +809,16 @@ data_to_pack_to_GL_restrict(void) const
   int I(p->m_parent->triple_buffer_enabler()->present_ID());
   int num_slots(p->m_parent->m_number_slots_to_pack_to_GL[I]);
   int size(num_slots*p->m_padded_row_size_in_floats);
+  const_c_array<float> data(p->m_data_to_pack_to_GL[I]);
             
+  if(p->m_extrapolated_valid)
+    {
+      data=const_c_array<float>(p->m_extrapolated).sub_array(0, data.size());
+    }
 
   return(p->m_packing_type==NodeDataPackParameters::packed_by_node and p->m_padded_row_size_in_floats>0)?
-    p->m_data_to_pack_to_GL[I].sub_array(0, size):
-    p->m_data_to_pack_to_GL[I];
+    data.sub_array(0, size):
+    data;
 }
 
 bool
@@ -480,6 +829,14 @@ non_empty(void) const
   return p->m_number_active!=0;
 }
 
+bool
+WRATHLayerNodeValuePackerBase::DataToGL::
+extrapolated(void) const
+{
+  const per_packer_datum *p(static_cast<const per_packer_datum*>(m_actual_data));
+  return p->m_extrapolated_valid;
+}
+
 
 
 /////////////////////////////////////////////////////
@@ -493,6 +850,11 @@ WRATHLayerNodeValuePackerBase(WRATHLayerBase *layer,
   m_highest_slot(-1),
   m_number_slots_to_pack_to_GL(0, 0, 0),
   m_nodes(m_payload->m_number_slots, static_cast<WRATHLayerItemNodeBase*>(NULL)),
+  m_extrapolate(false),
+  m_extrapolating(false),
+  m_pack_time(0, 0, 0),
+  m_pack_interval(0, 0, 0),
+  m_previous_pack_ID(0),
   m_empty_packer(this),
   m_packers_by_shader(spec.shader_entries())
 {
@@ -504,10 +866,14 @@ WRATHLayerNodeValuePackerBase(WRATHLayerBase *layer,
       m_packers[i]=WRATHNew per_packer_datum(this, 
                                              spec.active_node_values(i),
                                              spec.packer_parameters(i),
-                                             spec.original_data().one_plus_highest_index());
-        
+                                             spec.original_data());
+      m_extrapolate=m_extrapolate or !m_packers[i]->m_extrapolation.empty();
     }
 
+  /*
+    m_present_signal is connected by pack_data()
+    the first time extrapolation is enabled.
+   */
   m_sim_signal=connect(WRATHTripleBufferEnabler::on_complete_simulation_frame,
                        WRATHTripleBufferEnabler::pre_update_no_lock,
                        boost::bind(&WRATHLayerNodeValuePackerBase::pack_data, this));
@@ -532,6 +898,7 @@ WRATHLayerNodeValuePackerBase::
 on_place_on_deletion_list(void)
 {
   m_sim_signal.disconnect();
+  m_present_signal.disconnect();
 }
 
 
@@ -577,6 +944,7 @@ pack_data(void)
     that though means that the array
     gets copied... alot. 
    */
+  WRATHProfileZone("WRATHLayerNodeValuePackerBase::pack_data");
   WRATHAutoLockMutex(m_nodes_mutex);
   int number_slots;
 
@@ -585,6 +953,36 @@ pack_data(void)
   number_slots=1 + m_highest_slot;
   m_number_slots_to_pack_to_GL[triple_buffer_enabler()->current_simulation_ID()]=number_slots;
 
+  /*
+    rates are only computed while extrapolation is
+    enabled, so node types that specify extrapolation
+    cost nothing extra by default.
+   */
+  m_extrapolating=m_extrapolate and max_extrapolation_time_int()>0;
+  if(m_extrapolating)
+    {
+      int ID(triple_buffer_enabler()->current_simulation_ID());
+
+      m_pack_time[ID]=extrapolation_clock();
+      m_pack_interval[ID]=m_pack_time[ID] - m_pack_time[m_previous_pack_ID];
+
+      if(!m_present_signal.connected())
+        {
+          m_present_signal=connect(WRATHTripleBufferEnabler::on_begin_presentation_frame,
+                                   WRATHTripleBufferEnabler::post_update_no_lock,
+                                   boost::bind(&WRATHLayerNodeValuePackerBase::extrapolate_data, this));
+        }
+    }
+  else if(m_extrapolate)
+    {
+      /*
+        the rates of this buffer are not computed,
+        a zero interval makes extrapolate_data()
+        use the values as packed should extrapolation
+        be enabled before the next pack.
+       */
+      m_pack_interval[triple_buffer_enabler()->current_simulation_ID()]=0;
+    }
 
   for(std::vector<per_packer_datum*>::const_iterator 
         iter=m_packers.begin(), end=m_packers.end(); iter!=end; ++iter)
@@ -592,6 +990,75 @@ pack_data(void)
       per_packer_datum *ptr(*iter);
       ptr->pack_data(number_slots);
     }
+
+  if(m_extrapolating)
+    {
+      m_previous_pack_ID=triple_buffer_enabler()->current_simulation_ID();
+      m_previous_nodes.assign(m_nodes.begin(), m_nodes.begin() + number_slots);
+    }
+  else
+    {
+      m_previous_nodes.clear();
+    }
+}
+
+void
+WRATHLayerNodeValuePackerBase::
+extrapolate_data(void)
+{
+  int I(triple_buffer_enabler()->present_ID());
+  int32_t dt_ms(extrapolation_clock() - m_pack_time[I]);
+  float t;
+
+  /*
+    do not extrapolate further than the time between
+    the two most recent packs: if no simulation frame
+    came since, the values are likely no longer
+    changing at the rates computed.
+   */
+  dt_ms=std::min(dt_ms, m_pack_interval[I]);
+  dt_ms=std::max(0, std::min(dt_ms, max_extrapolation_time_int()));
+  t=static_cast<float>(dt_ms)/1000.0f;
+
+  for(std::vector<per_packer_datum*>::const_iterator 
+        iter=m_packers.begin(), end=m_packers.end(); iter!=end; ++iter)
+    {
+      per_packer_datum *ptr(*iter);
+
+      ptr->m_extrapolated_valid=false;
+      if(max_extrapolation_time_int()>0)
+        {
+          ptr->extrapolate_data(m_number_slots_to_pack_to_GL[I], t);
+        }
+    }
+}
+
+int32_t
+WRATHLayerNodeValuePackerBase::
+max_extrapolation_time(void)
+{
+  return max_extrapolation_time_int();
+}
+
+void
+WRATHLayerNodeValuePackerBase::
+max_extrapolation_time(int32_t v)
+{
+  max_extrapolation_time_int()=std::max(0, v);
+}
+
+float
+WRATHLayerNodeValuePackerBase::
+max_extrapolation_jump(void)
+{
+  return max_extrapolation_jump_float();
+}
+
+void
+WRATHLayerNodeValuePackerBase::
+max_extrapolation_jump(float v)
+{
+  max_extrapolation_jump_float()=v;
 }
 
 int
@@ -0,0 +1,291 @@
+/*!
+ * \file WRATHLayerTextDocument.cpp
+ * \brief file WRATHLayerTextDocument.cpp
+ *
+ * Copyright 2013 by Nomovok Ltd.
+ *
+ * Contact: info@nomovok.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ *
+ */
+
+
+
+#include "WRATHConfig.hpp"
+#include <algorithm>
+#include <cmath>
+#include "WRATHLayerTextDocument.hpp"
+
+//////////////////////////////////////////
+// WRATHLayerTextDocumentBase methods
+WRATHLayerTextDocumentBase::
+WRATHLayerTextDocumentBase(WRATHLayer *layer,
+                           const WRATHItemDrawerFactory &fact,
+                           int subdrawer_id,
+                           const parameters &params):
+  m_layer(layer),
+  m_factory(fact.copy()),
+  m_subdrawer_id(subdrawer_id),
+  m_params(params),
+  m_stream(params.m_layout),
+  m_line_height(params.m_estimated_line_height),
+  m_measured_height(0.0f),
+  m_measured_lines(0),
+  m_layout_dirty(false),
+  m_direction(params.m_layout.m_screen_orientation==WRATHFormatter::y_increases_downward?
+              1.0f:-1.0f)
+{
+  WRATHassert(m_layer!=NULL);
+  WRATHassert(m_params.m_chunk_size>0);
+  WRATHassert(m_params.m_estimated_line_height>0.0f);
+}
+
+WRATHLayerTextDocumentBase::
+~WRATHLayerTextDocumentBase()
+{
+  /*
+    deleting the nodes of the chunks needs
+    the node type, the derived class clears
+   */
+  WRATHassert(m_chunks.empty());
+  WRATHDelete(m_factory);
+}
+
+void
+WRATHLayerTextDocumentBase::
+append_utf8(const char *begin, const char *end)
+{
+  while(begin!=end)
+    {
+      chunk *c(open_chunk());
+      size_t room, sz(c->m_text.size());
+      const char *cut;
+
+      room=(sz<static_cast<size_t>(m_params.m_chunk_size))?
+        m_params.m_chunk_size - sz:
+        0;
+      cut=begin + std::min(room, static_cast<size_t>(end - begin));
+
+      /*
+        split at a line break so that
+        each chunk starts on a new line
+       */
+      cut=std::find(cut, end, '\n');
+      c->m_lines+=std::count(begin, cut, '\n');
+      c->m_text.append(begin, cut);
+      if(cut!=end)
+        {
+          c->m_closed=true;
+          ++cut;
+        }
+      begin=cut;
+
+      if(!c->m_exact)
+        {
+          m_layout_dirty=true;
+        }
+    }
+}
+
+WRATHLayerTextDocumentBase::chunk*
+WRATHLayerTextDocumentBase::
+open_chunk(void)
+{
+  if(!m_chunks.empty() and !m_chunks.back()->m_closed)
+    {
+      chunk *c(m_chunks.back());
+
+      if(c->m_exact)
+        {
+          /*
+            the text changes, so the
+            measured height is no longer
+            valid
+           */
+          release(c);
+          m_measured_height-=c->m_height;
+          m_measured_lines-=c->m_lines;
+          c->m_exact=false;
+        }
+      return c;
+    }
+
+  chunk *c;
+
+  c=WRATHNew chunk();
+  c->m_x_range=vecN<float, 2>(m_params.m_layout.m_start_position.x(),
+                              m_params.m_layout.m_start_position.x() + m_params.m_estimated_width);
+  c->m_height=m_line_height;
+  if(!m_chunks.empty())
+    {
+      chunk *prev(m_chunks.back());
+      c->m_offset=prev->m_offset + m_direction*prev->m_height;
+    }
+  m_chunks.push_back(c);
+  on_chunk_created(c);
+  return c;
+}
+
+WRATHLayerTextDocumentBase::BBox
+WRATHLayerTextDocumentBase::
+expand(const BBox &box, float margin)
+{
+  if(box.empty())
+    {
+      return box;
+    }
+  return BBox(box.min_corner() - vec2(margin, margin),
+              box.max_corner() + vec2(margin, margin));
+}
+
+WRATHLayerTextDocumentBase::BBox
+WRATHLayerTextDocumentBase::
+chunk_box(chunk *c) const
+{
+  float y0, y1;
+
+  y0=m_params.m_layout.m_start_position.y() + c->m_offset;
+  y1=y0 + m_direction*c->m_height;
+  return BBox(vec2(c->m_x_range[0], std::min(y0, y1)),
+              vec2(c->m_x_range[1], std::max(y0, y1)));
+}
+
+void
+WRATHLayerTextDocumentBase::
+layout(void)
+{
+  float offset(0.0f);
+
+  if(!m_layout_dirty)
+    {
+      return;
+    }
+  m_layout_dirty=false;
+
+  for(std::vector<chunk*>::iterator iter=m_chunks.begin(),
+        end=m_chunks.end(); iter!=end; ++iter)
+    {
+      chunk *c(*iter);
+      float h;
+
+      h=(c->m_exact)?
+        c->m_height:
+        m_line_height*static_cast<float>(c->m_lines);
+
+      if(h!=c->m_height or offset!=c->m_offset)
+        {
+          c->m_height=h;
+          c->m_offset=offset;
+          on_chunk_box_change(c);
+        }
+      offset+=m_direction*h;
+    }
+}
+
+void
+WRATHLayerTextDocumentBase::
+format_chunk(chunk *c)
+{
+  float h;
+
+  WRATHassert(c->m_item==NULL);
+  WRATHassert(c->m_node!=NULL);
+
+  m_stream.clear();
+  if(m_params.m_stream_setup)
+    {
+      m_params.m_stream_setup(m_stream);
+    }
+  m_stream.append_utf8(c->m_text);
+
+  c->m_item=WRATHNew WRATHTextItem(*m_factory, m_subdrawer_id,
+                                   m_layer, WRATHLayer::SubKey(c->m_node),
+                                   m_params.m_opacity,
+                                   m_params.m_drawer,
+                                   m_params.m_draw_order,
+                                   m_params.m_extra_state);
+  c->m_item->add_text(m_stream);
+  m_loaded.push_back(c);
+
+  if(c->m_exact)
+    {
+      return;
+    }
+
+  /*
+    replace the estimated extent with the
+    measured one and refine the estimate
+    of the line height.
+   */
+  h=std::fabs(m_stream.end_text_pen_position().m_descend_start_pen_position.y()
+              - m_params.m_layout.m_start_position.y());
+  h=std::max(h, 1.0f);
+
+  const WRATHTextAttributePacker::BBox &text_box(c->m_item->bounding_box());
+  if(!text_box.empty())
+    {
+      c->m_x_range=vecN<float, 2>(text_box.min_corner().x(),
+                                  std::max(text_box.max_corner().x(),
+                                           text_box.min_corner().x() + 1.0f));
+    }
+
+  c->m_exact=true;
+  c->m_height=h;
+  m_measured_height+=h;
+  m_measured_lines+=c->m_lines;
+  m_line_height=m_measured_height/static_cast<float>(m_measured_lines);
+
+  /*
+    force the box to be set, layout() only
+    sets it if the height or offset changes
+   */
+  on_chunk_box_change(c);
+  m_layout_dirty=true;
+}
+
+void
+WRATHLayerTextDocumentBase::
+release(chunk *c)
+{
+  if(c->m_item==NULL)
+    {
+      return;
+    }
+
+  std::vector<chunk*>::iterator iter;
+
+  iter=std::find(m_loaded.begin(), m_loaded.end(), c);
+  WRATHassert(iter!=m_loaded.end());
+  *iter=m_loaded.back();
+  m_loaded.pop_back();
+
+  WRATHPhasedDelete(c->m_item);
+  delete_node(c);
+  c->m_item=NULL;
+  c->m_node=NULL;
+}
+
+void
+WRATHLayerTextDocumentBase::
+clear_chunks(void)
+{
+  for(std::vector<chunk*>::iterator iter=m_chunks.begin(),
+        end=m_chunks.end(); iter!=end; ++iter)
+    {
+      release(*iter);
+      WRATHDelete(*iter);
+    }
+  m_chunks.clear();
+  m_loaded.clear();
+  m_line_height=m_params.m_estimated_line_height;
+  m_measured_height=0.0f;
+  m_measured_lines=0;
+  m_layout_dirty=false;
+}
@@ -112,6 +112,18 @@ namespace
         .add_source(2, "WRATH_LAYER_ROTATE_TRANSLATE_TRANSFORMATION_TX", GL_VERTEX_SHADER)
         .add_source(3, "WRATH_LAYER_ROTATE_TRANSLATE_TRANSFORMATION_TY", GL_VERTEX_SHADER)
         .add_source(4, "WRATH_LAYER_ROTATE_TRANSLATE_Z", GL_VERTEX_SHADER);
+
+      /*
+        (RX, RY) is the rotation times the scale as
+        a complex number, extrapolating it linearly
+        would shrink/grow the item as it rotates.
+        The z-value is not extrapolated since it 
+        also encodes visibility.
+       */
+      spec
+        .set_extrapolation(0, WRATHLayerNodeValuePackerBase::extrapolate_complex_exponential)
+        .set_extrapolation(2, WRATHLayerNodeValuePackerBase::extrapolate_linear)
+        .set_extrapolation(3, WRATHLayerNodeValuePackerBase::extrapolate_linear);
     }
 
     virtual
@@ -56,6 +56,39 @@ namespace
     return q;
   }
 
+  /*
+    the corners of the clipping rectangle
+    are the same for every rectangle drawn,
+    they are placed in a buffer object once
+    instead of being sourced from client memory
+    each time the clipping region is drawn.
+   */
+  GLuint
+  quad_corners_buffer(void)
+  {
+    static GLuint R(0);
+
+    if(R==0)
+      {
+        const GLbyte corners_as_01[]=
+          {
+            0, 0,
+            1, 0,
+            1, 1,
+            
+            0, 0,
+            1, 1,
+            0, 1,
+          };
+
+        glGenBuffers(1, &R);
+        WRATHassert(R!=0);
+        glBindBuffer(GL_ARRAY_BUFFER, R);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(corners_as_01), corners_as_01, GL_STATIC_DRAW);
+      }
+    return R;
+  }
+
   class QuadDrawer
   {
   public:
@@ -177,6 +210,12 @@ namespace
                 const DrawStateElement &layer,
                 const_c_array<DrawStateElement> draw_stack) const;
 
+    virtual
+    bool
+    shares_clip_region(const DrawStateElement &layer,
+                       const WRATHLayerClipDrawer *next_drawer,
+                       const DrawStateElement &next_layer) const;
+
   private:
     
     void
@@ -223,6 +262,21 @@ namespace
         .add_source(5, "WRATH_LAYER_TRANSLATE_CLIP_WINDOW_MAX_X", GL_VERTEX_SHADER)
         .add_source(6, "WRATH_LAYER_TRANSLATE_CLIP_WINDOW_MIN_Y", GL_VERTEX_SHADER)
         .add_source(7, "WRATH_LAYER_TRANSLATE_CLIP_WINDOW_MAX_Y", GL_VERTEX_SHADER);
+
+      /*
+        the z-value is not extrapolated since it also
+        encodes visibility. The scale is extrapolated
+        exponentially, that also preserves its sign
+        which encodes if clipping is active. The clip
+        window is not extrapolated either: the stencil
+        clipping of NodeMagic is drawn from the values
+        of the simulation frame, so the shader clip
+        window must use those same values.
+       */
+      spec
+        .set_extrapolation(0, WRATHLayerNodeValuePackerBase::extrapolate_linear)
+        .set_extrapolation(1, WRATHLayerNodeValuePackerBase::extrapolate_linear)
+        .set_extrapolation(3, WRATHLayerNodeValuePackerBase::extrapolate_exponential);
     }
 
     virtual
@@ -298,26 +352,14 @@ draw(const float4x4 &pvm,
   WRATHglUniform(m_p, p);
   WRATHglUniform(m_q, q);
 
-  const GLbyte corners_as_01[]=
-    {
-      0, 0,
-      1, 0,
-      1, 1,
-
-      0, 0,
-      1, 1,
-      0, 1,
-
-    };
-
   glEnableVertexAttribArray(0);
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindBuffer(GL_ARRAY_BUFFER, quad_corners_buffer());
   glVertexAttribPointer(0, //index
                         2, //count 
                         opengl_trait<GLbyte>::type, //type
                         GL_FALSE, //normalize
                         0, //stride
-                        corners_as_01); //offset/ptr
+                        NULL); //offset/ptr
 
   for(int i=1;i<WRATHDrawCallSpec::attribute_count; ++i)
     {
@@ -421,10 +463,12 @@ clip_mode(WRATHLayer*,
         rectangle that is infrom of w>0.
        */
       WRATHBBox<2> pbox;
+      bool w_positive(true);
       for(int i=0;i<4;++i)
         {
           screen_pts[i]=vec2(proj_points[i].x(), proj_points[i].y())/proj_points[i].w();
           pbox.set_or(screen_pts[i]);
+          w_positive=w_positive and proj_points[i].w()>0.0f;
         }
      
 
@@ -434,6 +478,21 @@ clip_mode(WRATHLayer*,
         skip_layer:
         layer_clipped_sibling;
 
+      /*
+        if pvm only scales and translates x and y, 
+        the clipping rectangle stays a screen aligned 
+        rectangle, in which case the clipping is exactly
+        the device bounding box (and so WRATHLayer
+        can use the scissor test). The parent's
+        device bounding box is a screen aligned
+        rectangle so the intersection stays exact.
+       */
+      return_value.m_device_bbox_exact=w_positive
+        and screen_pts[0].x()==screen_pts[2].x()
+        and screen_pts[1].x()==screen_pts[3].x()
+        and screen_pts[0].y()==screen_pts[3].y()
+        and screen_pts[1].y()==screen_pts[2].y();
+
       /*
       return_value.m_device_bbox=state_stack.back().m_clipping.m_device_bbox;
       return_value.m_clip_mode=layer_clipped_sibling;
@@ -489,6 +548,40 @@ draw_region(bool clear_z,
   m_quad_drawer.draw(pvm, value.m_p, value.m_q);
 }
 
+bool
+NodeMagic::
+shares_clip_region(const DrawStateElement &player,
+                   const WRATHLayerClipDrawer *next_drawer,
+                   const DrawStateElement &next_player) const
+{
+  const NodeMagic *next(dynamic_cast<const NodeMagic*>(next_drawer));
+
+  /*
+    draw_region() draws the rectangle with the
+    pvm of the render parent, siblings share 
+    the parent, thus the regions are the same 
+    exactly when the rectangles are the same.
+    The rectangle of a layer without a parent
+    is drawn with its own projection matrix, 
+    so do not bother in that case.
+   */
+  if(next==NULL
+     or player.m_layer==NULL
+     or next_player.m_layer==NULL
+     or next_player.m_layer->current_render_parent()==NULL)
+    {
+      return false;
+    }
+
+  const FromNodeValues &value(m_values[m_tr->present_ID()]);
+  const FromNodeValues &next_value(next->m_values[next->m_tr->present_ID()]);
+
+  return value.m_visible and value.m_clipped
+    and next_value.m_visible and next_value.m_clipped
+    and value.m_p==next_value.m_p
+    and value.m_q==next_value.m_q;
+}
+
 
 
 //////////////////////////////////////////////
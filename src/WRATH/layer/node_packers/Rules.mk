@@ -5,7 +5,7 @@ d		:= $(dir)
 # End standard header
 
 
-LIB_SOURCES += $(call filelist, WRATHLayerNodeValuePackerUniformArrays.cpp WRATHLayerNodeValuePackerTexture.cpp WRATHLayerNodeValuePackerHybrid.cpp)
+LIB_SOURCES += $(call filelist, WRATHLayerNodeValuePackerUniformArrays.cpp WRATHLayerNodeValuePackerTexture.cpp WRATHLayerNodeValuePackerHybrid.cpp WRATHLayerNodeValuePackerUniformBuffer.cpp WRATHLayerNodeValuePackerTextureBuffer.cpp)
 
 # Begin standard footer
 d		:= $(dirstack_$(sp))
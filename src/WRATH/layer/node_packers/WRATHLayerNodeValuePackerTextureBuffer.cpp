@@ -0,0 +1,411 @@
+/*! 
+ * \file WRATHLayerNodeValuePackerTextureBuffer.cpp
+ * \brief file WRATHLayerNodeValuePackerTextureBuffer.cpp
+ * 
+ * Copyright 2013 by Nomovok Ltd.
+ * 
+ * Contact: info@nomovok.com
+ * 
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ * 
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ * 
+ */
+
+
+
+#include "WRATHConfig.hpp"
+#include "WRATHLayerNodeValuePackerTextureBuffer.hpp"
+#include "WRATHStaticInit.hpp"
+
+#if defined(WRATH_GL_VERSION)
+
+/*
+  Implementation overview:
+
+  0) The per-node values are packed as for
+     WRATHLayerNodeValuePackerUniformArrays: the values of a
+     fixed node are continuous and padded to a multiple
+     of 4, so each node takes a fixed number of RGBA32F
+     texels of a buffer texture.
+
+  1) pre_fetch_node_values() fetches each texel of the
+     node once with texelFetch and assigns the per-node
+     values from the components.
+
+  2) Each WRATHLayerNodeValuePackerTextureBuffer has its own
+     buffer object and buffer texture. A copy of the data
+     last uploaded is kept, and only the range of floats
+     that changed is uploaded with glBufferSubData when
+     the texture is bound.
+*/
+
+namespace
+{
+  const char *texture_name="WRATH_LAYER_UNIFORM_PACKER_TEXTURE_BUFFER_sampler";
+
+  static
+  unsigned int&
+  number_slots_int(void)
+  {
+    static unsigned int R(2048);
+    return R;
+  }
+
+  class Payload:public WRATHLayerNodeValuePackerBase::SpecDataProcessedPayload
+  {
+  public:
+    typedef handle_t<Payload> handle;
+    typedef const_handle_t<Payload> const_handle;
+
+    Payload(void):
+      m_texture_unit(GL_INVALID_ENUM),
+      m_texels_per_node(0)
+    {
+      m_number_slots=WRATHLayerNodeValuePackerTextureBuffer::number_slots();
+    }
+
+    GLenum m_texture_unit;
+    int m_texels_per_node;
+  };
+
+  class TextureBufferFunction:public WRATHLayerNodeValuePackerBase::function_packet
+  {
+  public:
+
+    virtual
+    bool
+    supports_per_node_value(GLenum) const
+    {
+      return true;
+    }
+
+    virtual
+    SpecDataProcessedPayload::handle
+    create_handle(const ActiveNodeValuesCollection &) const
+    {
+      return WRATHNew Payload();
+    }
+
+    virtual
+    void
+    add_actions(const SpecDataProcessedPayload::handle &h,
+                const ProcessedActiveNodeValuesCollection &pr,
+                WRATHShaderSpecifier::ReservedBindings &reserved_bindings,
+                WRATHGLProgramOnBindActionArray&,
+                WRATHGLProgramInitializerArray &initers) const
+    {
+      Payload::handle payload;
+
+      WRATHassert(h.dynamic_cast_handle<Payload>().valid());
+      payload=h.static_cast_handle<Payload>();
+
+      /*
+        there should be one packing way (or zero
+        if there are none-to pack)
+       */
+      WRATHassert(pr.number_indices()<=1);
+      if(pr.number_indices()>0)
+        {
+          payload->m_texels_per_node=(pr.active_node_values(0).number_active() + 3)/4;
+        }
+
+      if(payload->m_texels_per_node==0)
+        {
+          return;
+        }
+
+      /*
+        find the first texture unit not used by
+        reserved_bindings.m_texture_binding_points
+       */
+      GLenum tex_unit(GL_TEXTURE0);
+      for(std::set<GLenum>::const_iterator current=reserved_bindings.m_texture_binding_points.begin(),
+            end=reserved_bindings.m_texture_binding_points.end(); current!=end; ++current)
+        {
+          if(tex_unit<*current)
+            {
+              break;
+            }
+          else
+            {
+              tex_unit=std::max(tex_unit, *current + 1);
+            }
+        }
+
+      payload->m_texture_unit=tex_unit;
+      initers
+        .add_sampler_initializer(texture_name, tex_unit-GL_TEXTURE0);
+
+      reserved_bindings.add_texture_binding(tex_unit);
+    }
+
+    virtual
+    void
+    append_fetch_code(WRATHGLShader::shader_source &src,
+                      GLenum /*shader_stage*/,
+                      const ActiveNodeValues &node_values,
+                      const SpecDataProcessedPayload::handle& /*hnd*/,
+                      const std::string &index_name) const
+    {
+      std::ostringstream ostr;
+      int size(node_values.number_active());
+      int texels_per_node((size + 3)/4);
+      std::vector<std::string> entries_ordered_by_offset(4*texels_per_node);
+      static const char *temp_label="WRATH_LAYER_UNIFORM_PACKER_TEXTURE_BUFFER_temp";
+      const char component_name[]=
+        {
+          'x',
+          'y',
+          'z',
+          'w'
+        };
+
+      /*
+        GLSL 1.30 only has buffer textures
+        via GL_EXT_gpu_shader4.
+       */
+      src.specify_extension("GL_EXT_gpu_shader4");
+
+      ostr << "\n\n#define fetch_node_value(X) X\n";
+      for(ActiveNodeValues::map_type::const_iterator iter=node_values.entries().begin(),
+            end=node_values.entries().end(); iter!=end; ++iter)
+        {
+          ostr << "\nhighp float " << iter->second.label() << ";";
+          entries_ordered_by_offset[iter->second.m_offset]=iter->second.label();
+        }
+
+      ostr << "\nuniform highp samplerBuffer " << texture_name << ";\n"
+           << "\n#ifdef GL_EXT_gpu_shader4"
+           << "\n#define WRATH_LAYER_UNIFORM_PACKER_TEXTURE_BUFFER_fetch(I) texelFetchBuffer("
+           << texture_name << ", I)"
+           << "\n#else"
+           << "\n#define WRATH_LAYER_UNIFORM_PACKER_TEXTURE_BUFFER_fetch(I) texelFetch("
+           << texture_name << ", I)"
+           << "\n#endif\n\n"
+           << "void pre_fetch_node_values(void)"
+           << "\n{"
+           << "\n\tint node_start_index;"
+           << "\n\thighp vec4 " << temp_label << ";"
+           << "\n\tnode_start_index=int("
+           << index_name
+           << ")*"
+           << texels_per_node << ";";
+
+      for(int texel=0; texel<texels_per_node; ++texel)
+        {
+          ostr << "\n\t" << temp_label
+               << "=WRATH_LAYER_UNIFORM_PACKER_TEXTURE_BUFFER_fetch(node_start_index+"
+               << texel << ");";
+
+          for(int c=0; c<4; ++c)
+            {
+              const std::string &label(entries_ordered_by_offset[4*texel + c]);
+              if(!label.empty())
+                {
+                  ostr << "\n\t" << label << "=" << temp_label
+                       << "." << component_name[c] << ";";
+                }
+            }
+        }
+      ostr << "\n}\n\n";
+      src.add_source(ostr.str(), WRATHGLShader::from_string);
+    }
+  };
+
+  class TextureBufferForNode:public WRATHTextureChoice::texture_base
+  {
+  public:
+    typedef handle_t<TextureBufferForNode> handle;
+
+    TextureBufferForNode(WRATHLayerNodeValuePackerBase::DataToGL q,
+                         const Payload::const_handle &hnd):
+      m_active(true),
+      m_source(q),
+      m_texture_unit(hnd->m_texture_unit),
+      m_size_in_floats(4*hnd->m_texels_per_node*hnd->m_number_slots),
+      m_buffer_name(0),
+      m_texture_name(0)
+    {}
+
+    GLenum
+    texture_unit(void) const
+    {
+      return m_texture_unit;
+    }
+
+    void
+    deactivate(void)
+    {
+      if(m_texture_name!=0)
+        {
+          glDeleteTextures(1, &m_texture_name);
+          m_texture_name=0;
+        }
+      if(m_buffer_name!=0)
+        {
+          glDeleteBuffers(1, &m_buffer_name);
+          m_buffer_name=0;
+        }
+      m_active=false;
+    }
+
+    virtual
+    void
+    bind_texture(GLenum ptexture_unit)
+    {
+      WRATHassert(ptexture_unit==texture_unit());
+      WRATHunused(ptexture_unit);
+
+      if(!m_active)
+        {
+          return;
+        }
+
+      const_c_array<float> data(m_source.data_to_pack_to_GL_restrict());
+      int data_size(std::min(static_cast<int>(data.size()), m_size_in_floats));
+
+      if(m_buffer_name==0)
+        {
+          /*
+            allocate the buffer for all the slots
+            and upload all of the data the first time.
+           */
+          m_uploaded.resize(m_size_in_floats, 0.0f);
+          std::copy(data.begin(), data.begin() + data_size, m_uploaded.begin());
+
+          glGenBuffers(1, &m_buffer_name);
+          WRATHassert(m_buffer_name!=0);
+          glBindBuffer(GL_TEXTURE_BUFFER, m_buffer_name);
+          glBufferData(GL_TEXTURE_BUFFER, m_size_in_floats*sizeof(float),
+                       &m_uploaded[0], GL_DYNAMIC_DRAW);
+
+          glGenTextures(1, &m_texture_name);
+          WRATHassert(m_texture_name!=0);
+          glBindTexture(GL_TEXTURE_BUFFER, m_texture_name);
+          glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, m_buffer_name);
+          return;
+        }
+
+      int first(0), last(data_size);
+
+      /*
+        only upload the range that changed
+        from the previous upload.
+       */
+      while(first<last and data[first]==m_uploaded[first])
+        {
+          ++first;
+        }
+      while(last>first and data[last-1]==m_uploaded[last-1])
+        {
+          --last;
+        }
+
+      if(first<last)
+        {
+          std::copy(data.begin() + first, data.begin() + last, m_uploaded.begin() + first);
+
+          glBindBuffer(GL_TEXTURE_BUFFER, m_buffer_name);
+          glBufferSubData(GL_TEXTURE_BUFFER,
+                          first*sizeof(float), (last - first)*sizeof(float),
+                          &m_uploaded[first]);
+        }
+      glBindTexture(GL_TEXTURE_BUFFER, m_texture_name);
+    }
+
+  private:
+    bool m_active;
+    WRATHLayerNodeValuePackerBase::DataToGL m_source;
+    GLenum m_texture_unit;
+    int m_size_in_floats;
+    GLuint m_buffer_name, m_texture_name;
+    std::vector<float> m_uploaded;
+  };
+}
+
+///////////////////////////////////////////////
+// WRATHLayerNodeValuePackerTextureBuffer methods
+WRATHLayerNodeValuePackerTextureBuffer::
+WRATHLayerNodeValuePackerTextureBuffer(WRATHLayerBase *layer,
+                                       const SpecDataProcessedPayload::const_handle &h,
+                                       const ProcessedActiveNodeValuesCollection &spec):
+  WRATHLayerNodeValuePackerBase(layer, h, spec)
+{
+  Payload::const_handle payload;
+
+  WRATHassert(h.dynamic_cast_handle<Payload>().valid());
+  payload=h.static_cast_handle<Payload>();
+
+  if(payload->m_texels_per_node>0)
+    {
+      m_texture=WRATHNew TextureBufferForNode(data_to_gl_indexed(0), payload);
+    }
+}
+
+WRATHLayerNodeValuePackerTextureBuffer::
+~WRATHLayerNodeValuePackerTextureBuffer()
+{}
+
+void
+WRATHLayerNodeValuePackerTextureBuffer::
+phase_render_deletion(void)
+{
+  if(m_texture.valid())
+    {
+      WRATHassert(m_texture.dynamic_cast_handle<TextureBufferForNode>().valid());
+
+      /*
+        deletes the texture and buffer object
+        and makes the texture inactive
+       */
+      m_texture.static_cast_handle<TextureBufferForNode>()->deactivate();
+      m_texture=NULL;
+    }
+
+  WRATHLayerNodeValuePackerBase::phase_render_deletion();
+}
+
+void
+WRATHLayerNodeValuePackerTextureBuffer::
+append_state(WRATHSubItemDrawState &skey)
+{
+  if(m_texture.valid())
+    {
+      TextureBufferForNode::handle H;
+
+      WRATHassert(m_texture.dynamic_cast_handle<TextureBufferForNode>().valid());
+      H=m_texture.static_cast_handle<TextureBufferForNode>();
+
+      skey.add_texture(H->texture_unit(), H);
+    }
+}
+
+const WRATHLayerNodeValuePackerBase::function_packet&
+WRATHLayerNodeValuePackerTextureBuffer::
+functions(void)
+{
+  WRATHStaticInit();
+  static TextureBufferFunction return_value;
+  return return_value;
+}
+
+unsigned int
+WRATHLayerNodeValuePackerTextureBuffer::
+number_slots(void)
+{
+  return number_slots_int();
+}
+
+void
+WRATHLayerNodeValuePackerTextureBuffer::
+number_slots(unsigned int v)
+{
+  number_slots_int()=std::min(v, 65535u);
+}
+
+#endif
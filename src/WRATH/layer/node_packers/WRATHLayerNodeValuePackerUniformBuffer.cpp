@@ -0,0 +1,428 @@
+/*! 
+ * \file WRATHLayerNodeValuePackerUniformBuffer.cpp
+ * \brief file WRATHLayerNodeValuePackerUniformBuffer.cpp
+ * 
+ * Copyright 2013 by Nomovok Ltd.
+ * 
+ * Contact: info@nomovok.com
+ * 
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ * 
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ * 
+ */
+
+
+
+#include "WRATHConfig.hpp"
+#include "WRATHLayerNodeValuePackerUniformBuffer.hpp"
+#include "WRATHStaticInit.hpp"
+
+#if defined(WRATH_GL_VERSION) || WRATH_GLES_VERSION>=3
+
+/*
+  Implementation overview:
+
+  0) The per-node values are packed exactly as for
+     WRATHLayerNodeValuePackerUniformArrays: into an array
+     of vec4's, the values of a fixed node continuous and
+     padded so that the next node starts at the next vec4.
+     The array is the only member of a std140 uniform block,
+     so the array stride is exactly one vec4 and the data of
+     DataToGL::data_to_pack_to_GL() can be uploaded as is.
+
+  1) Each WRATHLayerNodeValuePackerUniformBuffer has its own
+     buffer object. The uniform block of each GLSL program
+     is bound to one buffer binding point (found from the
+     ReservedBindings, set with an initializer) and the
+     buffer object of the packer is bound to that binding
+     point when the packer's uniforms are set for a draw call.
+
+  2) A copy of the data last uploaded is kept, and only
+     the range of floats that changed is uploaded with
+     glBufferSubData. When nodes are static, nothing is
+     uploaded.
+*/
+
+namespace
+{
+  const char *block_name="WRATH_LAYER_UNIFORM_PACKER_UNIFORM_BUFFER_block";
+  const char *array_name="WRATH_LAYER_UNIFORM_PACKER_UNIFORM_BUFFER";
+
+  static
+  unsigned int&
+  size_of_vec4_block_int(void)
+  {
+    static unsigned int R(1024);
+    return R;
+  }
+
+  int
+  max_number_slots_from_index(void)
+  {
+    /*
+      the node index is a mediump float in GLSL
+      (see WRATHLayerItemDrawerFactory), so for GLES
+      restrict to the values exactly representable,
+      and always to the range of the GLushort attribute.
+     */
+    #if defined(WRATH_GLES_VERSION)
+      return 1024;
+    #else
+      return 65535;
+    #endif
+  }
+
+  class Payload:public WRATHLayerNodeValuePackerBase::SpecDataProcessedPayload
+  {
+  public:
+    typedef handle_t<Payload> handle;
+    typedef const_handle_t<Payload> const_handle;
+
+    Payload(void):
+      m_binding_index(0),
+      m_block_size_in_vec4s(0)
+    {}
+
+    GLuint m_binding_index;
+    int m_block_size_in_vec4s;
+  };
+
+  class BlockBindingInitializer:public WRATHGLProgramInitializer
+  {
+  public:
+    explicit
+    BlockBindingInitializer(GLuint binding_index):
+      m_binding_index(binding_index)
+    {}
+
+    virtual
+    void
+    perform_initialization(WRATHGLProgram *pr) const
+    {
+      GLuint block_index;
+
+      block_index=glGetUniformBlockIndex(pr->name(), block_name);
+      if(block_index!=GL_INVALID_INDEX)
+        {
+          glUniformBlockBinding(pr->name(), block_index, m_binding_index);
+        }
+      else
+        {
+          WRATHwarning("Unable to find uniform block \""
+                       << block_name
+                       << " in program "
+                       << pr->resource_name());
+        }
+    }
+
+  private:
+    GLuint m_binding_index;
+  };
+
+  class UniformBufferFunction:public WRATHLayerNodeValuePackerBase::function_packet
+  {
+  public:
+
+    int
+    max_number_slots_allowed(int number_per_node_values) const
+    {
+      int number_vec4s_per_node, return_value;
+
+      number_vec4s_per_node=std::max(1, (number_per_node_values + 3)/4);
+      return_value=WRATHLayerNodeValuePackerUniformBuffer::size_of_vec4_block()/number_vec4s_per_node;
+      return std::min(return_value, max_number_slots_from_index());
+    }
+
+    virtual
+    bool
+    supports_per_node_value(GLenum) const
+    {
+      return true;
+    }
+
+    virtual
+    SpecDataProcessedPayload::handle
+    create_handle(const ActiveNodeValuesCollection &) const
+    {
+      /*
+        set return value's m_number_slots in
+        append_fetch_code
+       */
+      return WRATHNew Payload();
+    }
+
+    virtual
+    void
+    add_actions(const SpecDataProcessedPayload::handle &h,
+                const ProcessedActiveNodeValuesCollection&,
+                WRATHShaderSpecifier::ReservedBindings &reserved_bindings,
+                WRATHGLProgramOnBindActionArray&,
+                WRATHGLProgramInitializerArray &initers) const
+    {
+      Payload::handle payload;
+      GLuint binding_index(0);
+
+      WRATHassert(h.dynamic_cast_handle<Payload>().valid());
+      payload=h.static_cast_handle<Payload>();
+
+      /*
+        find the first uniform buffer binding
+        point not used by reserved_bindings
+       */
+      while(reserved_bindings.m_buffer_binding_points.find(WRATHBufferBindingPoint(GL_UNIFORM_BUFFER, binding_index))
+            !=reserved_bindings.m_buffer_binding_points.end())
+        {
+          ++binding_index;
+        }
+
+      payload->m_binding_index=binding_index;
+      reserved_bindings.add_buffer_binding(GL_UNIFORM_BUFFER, binding_index);
+      initers.add(WRATHNew BlockBindingInitializer(binding_index));
+    }
+
+    virtual
+    void
+    append_fetch_code(WRATHGLShader::shader_source &src,
+                      GLenum /*shader_stage*/,
+                      const ActiveNodeValues &node_values,
+                      const SpecDataProcessedPayload::handle &hnd,
+                      const std::string &index_name) const
+    {
+      Payload::handle payload;
+      std::ostringstream ostr;
+      int padded_size(node_values.number_active());
+      int modulas(padded_size%4);
+
+      WRATHassert(hnd.dynamic_cast_handle<Payload>().valid());
+      payload=hnd.static_cast_handle<Payload>();
+
+      if(modulas!=0)
+        {
+          padded_size+= (4-modulas);
+        }
+
+      payload->m_number_slots=max_number_slots_allowed(node_values.number_active());
+      payload->m_block_size_in_vec4s=std::max(1, payload->m_number_slots*(padded_size/4));
+
+      #if defined(WRATH_GL_VERSION)
+      {
+        src.specify_extension("GL_ARB_uniform_buffer_object");
+      }
+      #endif
+
+      ostr << "\n\n#define fetch_node_value(X) X\n";
+      for(ActiveNodeValues::map_type::const_iterator iter=node_values.entries().begin(),
+            end=node_values.entries().end(); iter!=end; ++iter)
+        {
+          ostr << "\nhighp float " << iter->second.label() << ";";
+        }
+
+      /*
+        the block must be declared identically
+        in each shader stage, so its size only
+        depends on the payload.
+       */
+      ostr << "\n\nlayout(std140) uniform " << block_name
+           << "\n{"
+           << "\n\thighp vec4 " << array_name
+           << "[" << payload->m_block_size_in_vec4s << "];"
+           << "\n};\n\n"
+           << "void pre_fetch_node_values(void)"
+           << "\n{"
+           << "\n\tint node_start_index;"
+           << "\n\tnode_start_index=int("
+           << index_name
+           << ")*"
+           << padded_size/4 << ";";
+
+      for(ActiveNodeValues::map_type::const_iterator iter=node_values.entries().begin(),
+            end=node_values.entries().end(); iter!=end; ++iter)
+        {
+          int component(iter->second.m_offset%4);
+          const char component_name[]=
+            {
+              'x',
+              'y',
+              'z',
+              'w'
+            };
+
+          ostr << "\n\t" << iter->second.label()
+               << "=" << array_name << "[node_start_index+"
+               << iter->second.m_offset/4 << "]."
+               << component_name[component] << ";";
+        }
+      ostr << "\n}\n\n";
+      src.add_source(ostr.str(), WRATHGLShader::from_string);
+    }
+  };
+
+  class UniformBufferForNode:public WRATHUniformData::uniform_setter_base
+  {
+  public:
+    typedef handle_t<UniformBufferForNode> handle;
+
+    UniformBufferForNode(WRATHLayerNodeValuePackerBase::DataToGL q,
+                         const Payload::const_handle &hnd):
+      m_active(true),
+      m_source(q),
+      m_binding_index(hnd->m_binding_index),
+      m_size_in_floats(4*hnd->m_block_size_in_vec4s),
+      m_buffer_name(0)
+    {}
+
+    void
+    deactivate(void)
+    {
+      if(m_buffer_name!=0)
+        {
+          glDeleteBuffers(1, &m_buffer_name);
+          m_buffer_name=0;
+        }
+      m_active=false;
+    }
+
+    virtual
+    void
+    gl_command(WRATHGLProgram*)
+    {
+      if(!m_active)
+        {
+          return;
+        }
+
+      const_c_array<float> data(m_source.data_to_pack_to_GL_restrict());
+      int data_size(std::min(static_cast<int>(data.size()), m_size_in_floats));
+
+      if(m_buffer_name==0)
+        {
+          /*
+            allocate the buffer for the entire block
+            and upload all of the data the first time.
+           */
+          glGenBuffers(1, &m_buffer_name);
+          WRATHassert(m_buffer_name!=0);
+
+          m_uploaded.resize(m_size_in_floats, 0.0f);
+          std::copy(data.begin(), data.begin() + data_size, m_uploaded.begin());
+
+          glBindBuffer(GL_UNIFORM_BUFFER, m_buffer_name);
+          glBufferData(GL_UNIFORM_BUFFER, m_size_in_floats*sizeof(float),
+                       &m_uploaded[0], GL_DYNAMIC_DRAW);
+        }
+      else
+        {
+          int first(0), last(data_size);
+
+          /*
+            only upload the range that changed
+            from the previous upload.
+           */
+          while(first<last and data[first]==m_uploaded[first])
+            {
+              ++first;
+            }
+          while(last>first and data[last-1]==m_uploaded[last-1])
+            {
+              --last;
+            }
+
+          if(first<last)
+            {
+              std::copy(data.begin() + first, data.begin() + last, m_uploaded.begin() + first);
+
+              glBindBuffer(GL_UNIFORM_BUFFER, m_buffer_name);
+              glBufferSubData(GL_UNIFORM_BUFFER,
+                              first*sizeof(float), (last - first)*sizeof(float),
+                              &m_uploaded[first]);
+            }
+        }
+      glBindBufferBase(GL_UNIFORM_BUFFER, m_binding_index, m_buffer_name);
+    }
+
+  private:
+    bool m_active;
+    WRATHLayerNodeValuePackerBase::DataToGL m_source;
+    GLuint m_binding_index;
+    int m_size_in_floats;
+    GLuint m_buffer_name;
+    std::vector<float> m_uploaded;
+  };
+
+}
+
+///////////////////////////////////////////////
+// WRATHLayerNodeValuePackerUniformBuffer methods
+WRATHLayerNodeValuePackerUniformBuffer::
+WRATHLayerNodeValuePackerUniformBuffer(WRATHLayerBase *layer,
+                                       const SpecDataProcessedPayload::const_handle &h,
+                                       const ProcessedActiveNodeValuesCollection &spec):
+  WRATHLayerNodeValuePackerBase(layer, h, spec)
+{
+  Payload::const_handle payload;
+
+  WRATHassert(h.dynamic_cast_handle<Payload>().valid());
+  payload=h.static_cast_handle<Payload>();
+
+  /*
+    all shader stages share the same
+    array, i.e. the default packing group.
+   */
+  m_buffer=WRATHNew UniformBufferForNode(data_to_gl_indexed(0), payload);
+}
+
+WRATHLayerNodeValuePackerUniformBuffer::
+~WRATHLayerNodeValuePackerUniformBuffer()
+{}
+
+void
+WRATHLayerNodeValuePackerUniformBuffer::
+phase_render_deletion(void)
+{
+  WRATHassert(m_buffer.dynamic_cast_handle<UniformBufferForNode>().valid());
+
+  /*
+    deletes the buffer object and makes the uniform inactive
+   */
+  m_buffer.static_cast_handle<UniformBufferForNode>()->deactivate();
+  m_buffer=NULL;
+
+  WRATHLayerNodeValuePackerBase::phase_render_deletion();
+}
+
+void
+WRATHLayerNodeValuePackerUniformBuffer::
+append_state(WRATHSubItemDrawState &skey)
+{
+  skey.add_uniform(m_buffer);
+}
+
+const WRATHLayerNodeValuePackerBase::function_packet&
+WRATHLayerNodeValuePackerUniformBuffer::
+functions(void)
+{
+  WRATHStaticInit();
+  static UniformBufferFunction return_value;
+  return return_value;
+}
+
+unsigned int
+WRATHLayerNodeValuePackerUniformBuffer::
+size_of_vec4_block(void)
+{
+  return size_of_vec4_block_int();
+}
+
+void
+WRATHLayerNodeValuePackerUniformBuffer::
+size_of_vec4_block(unsigned int v)
+{
+  size_of_vec4_block_int()=v;
+}
+
+#endif
@@ -22,6 +22,7 @@
 #include "WRATHDefaultFillShapeAttributePacker.hpp"
 #include "WRATHDefaultStrokeAttributePacker.hpp"
 #include "WRATHAttributePackerHelper.hpp"
+#include "WRATHUtil.hpp"
 
 
 
@@ -38,6 +39,14 @@ namespace
     }
   };
 
+  /*
+    attribute for WRATHAttributePacker::half_precision_format,
+    position as 16-bit floats
+   */
+  class attribute_type_half:
+    public WRATHInterleavedAttributes<vecN<GLushort, 2> >
+  {};
+
   enum fake_iterator_begin_t
     {
       fake_iterator_begin
@@ -176,9 +185,19 @@ allocation_requirement(WRATHShapeTriangulatorPayload::handle h,
 
 GLenum
 WRATHDefaultFillShapeAttributePacker::
-attribute_key(WRATHAttributeStoreKey &attrib_key)
+attribute_key(WRATHAttributeStoreKey &attrib_key,
+              enum WRATHAttributePacker::attribute_format_type fmt)
 { 
-  attrib_key.type_and_format(type_tag<attribute_type>());
+  if(fmt==WRATHAttributePacker::half_precision_format)
+    {
+      attrib_key
+        .type_and_format(type_tag<attribute_type_half>())
+        .half_float_format(position_location);
+    }
+  else
+    {
+      attrib_key.type_and_format(type_tag<attribute_type>());
+    }
   return GL_TRIANGLES;  
 }
 
@@ -188,7 +207,8 @@ set_attribute_data(WRATHShapeTriangulatorPayload::handle h,
                    WRATHAbstractDataSink &attribute_store,
                    const std::vector<range_type<int> > &attr_location,
                    WRATHAbstractDataSink *index_group,
-                   const FillingParameters &fill_params)
+                   const FillingParameters &fill_params,
+                   enum WRATHAttributePacker::attribute_format_type fmt)
 {
   WRATHassert(h.valid());
   WRATHassert(&attribute_store!=NULL);
@@ -204,6 +224,26 @@ set_attribute_data(WRATHShapeTriangulatorPayload::handle h,
       return;
     }
 
+  /*
+    for half_precision_format, convert all the
+    positions to 16-bit floats in one go before
+    locking the sinks
+   */
+  std::vector<attribute_type_half> half_attributes;
+  if(fmt==WRATHAttributePacker::half_precision_format)
+    {
+      int number_points(h->number_points_without_splits());
+      std::vector<vec2> positions(number_points);
+
+      WRATHassert(sizeof(attribute_type_half)==2*sizeof(GLushort));
+      half_attributes.resize(number_points);
+      for(int i=0; i<number_points; ++i)
+        {
+          positions[i]=h->point(i)->m_position + fill_params.m_translate;
+        }
+      WRATHUtil::convert_to_halfp_from_float_raw(&half_attributes[0], &positions[0], 2*number_points);
+    }
+
   WRATHAutoLockMutex(attribute_store.mutex());
   WRATHAutoLockMutex(index_group->mutex());
 
@@ -211,14 +251,25 @@ set_attribute_data(WRATHShapeTriangulatorPayload::handle h,
   c_array<GLushort> index_array;
   index_array=index_group->pointer<GLushort>(0, AA.m_primary_number_indices);
 
+  if(fmt==WRATHAttributePacker::half_precision_format)
+    {
+      WRATHAttributePackerHelper<attribute_type_half, GLushort> worker(attribute_store,
+                                                                       attr_location.begin(), 
+                                                                       attr_location.end());
+      worker.set_attribute_src(half_attributes.size(), 
+                               half_attributes.begin(), half_attributes.end());
+      add_indices(worker, index_array, h->components(), fill_params);
+    }
+  else
+    {
+      WRATHAttributePackerHelper<attribute_type, GLushort> worker(attribute_store,
+                                                                  attr_location.begin(), 
+                                                                  attr_location.end());
   
-  WRATHAttributePackerHelper<attribute_type, GLushort> worker(attribute_store,
-                                                              attr_location.begin(), 
-                                                              attr_location.end());
-  
-  worker.set_attribute_src(h->number_points_without_splits(),
-                           FakePtIterator<attribute_type>(h, fake_iterator_begin, fill_params), 
-                           FakePtIterator<attribute_type>(h, fake_iterator_end, fill_params));
-  add_indices(worker, index_array, h->components(), fill_params);
+      worker.set_attribute_src(h->number_points_without_splits(),
+                               FakePtIterator<attribute_type>(h, fake_iterator_begin, fill_params), 
+                               FakePtIterator<attribute_type>(h, fake_iterator_end, fill_params));
+      add_indices(worker, index_array, h->components(), fill_params);
+    }
 
 }
@@ -28,6 +28,7 @@
 #include "WRATHgluniform.hpp"
 #include "WRATHGLExtensionList.hpp"
 #include "WRATHGLStateStack.hpp"
+#include "WRATHGLStateShadow.hpp"
 #include "WRATHStaticInit.hpp"
 #include "WRATHStaticInit.hpp"
 
@@ -396,14 +397,14 @@ draw_to_stencil(const float4x4 &pvm) const
    */
 
 
-  glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
-  glStencilMask(~0);
-  glDisable(GL_DEPTH_TEST);
-  glEnable(GL_STENCIL_TEST);
-  glStencilFuncSeparate(GL_FRONT, GL_ALWAYS, 0, ~0);
-  glStencilFuncSeparate(GL_BACK, GL_ALWAYS, 0, ~0);
-  glStencilOpSeparate(GL_FRONT, GL_INCR_WRAP, GL_INCR_WRAP, GL_INCR_WRAP);
-  glStencilOpSeparate(GL_BACK, GL_DECR_WRAP, GL_DECR_WRAP, GL_DECR_WRAP);
+  WRATHGLStateShadow::color_mask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+  WRATHGLStateShadow::stencil_mask(~0);
+  WRATHGLStateShadow::disable(GL_DEPTH_TEST);
+  WRATHGLStateShadow::enable(GL_STENCIL_TEST);
+  WRATHGLStateShadow::stencil_func_separate(GL_FRONT, GL_ALWAYS, 0, ~0);
+  WRATHGLStateShadow::stencil_func_separate(GL_BACK, GL_ALWAYS, 0, ~0);
+  WRATHGLStateShadow::stencil_op_separate(GL_FRONT, GL_INCR_WRAP, GL_INCR_WRAP, GL_INCR_WRAP);
+  WRATHGLStateShadow::stencil_op_separate(GL_BACK, GL_DECR_WRAP, GL_DECR_WRAP, GL_DECR_WRAP);
   draw_fans(pvm);
 }
 
@@ -718,22 +719,22 @@ draw(const float4x4 &pvm, const FillRenderer &f, bool use_depth_buffer) const
 {
   
   //first in shape distance values using non-zero winding rule:
-  glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-  glDisable(GL_DEPTH_TEST);
-  glEnable(GL_STENCIL_TEST);
+  WRATHGLStateShadow::color_mask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+  WRATHGLStateShadow::disable(GL_DEPTH_TEST);
+  WRATHGLStateShadow::enable(GL_STENCIL_TEST);
   
   //draw whenever the winding rule is non-zero, note the +128
-  glStencilFuncSeparate(GL_FRONT_AND_BACK, GL_NOTEQUAL, 128, ~0); 
-  glStencilOpSeparate(GL_FRONT_AND_BACK, GL_KEEP, GL_KEEP, GL_KEEP);
+  WRATHGLStateShadow::stencil_func_separate(GL_FRONT_AND_BACK, GL_NOTEQUAL, 128, ~0); 
+  WRATHGLStateShadow::stencil_op_separate(GL_FRONT_AND_BACK, GL_KEEP, GL_KEEP, GL_KEEP);
 
   f.draw_fans(pvm); //draw first to where primitive is value (1,1,1,1)
 
   //use depth buffer if should:
   if(use_depth_buffer)
     {
-      glDepthMask(GL_TRUE);
-      glEnable(GL_DEPTH_TEST);
-      glDepthFunc(GL_LESS);
+      WRATHGLStateShadow::depth_mask(GL_TRUE);
+      WRATHGLStateShadow::enable(GL_DEPTH_TEST);
+      WRATHGLStateShadow::depth_func(GL_LESS);
     }
   m_edges.draw(pvm, true);
 
@@ -743,7 +744,7 @@ draw(const float4x4 &pvm, const FillRenderer &f, bool use_depth_buffer) const
     }
 
   //then negative distance values, i.e. those outside of shape:
-  glStencilFuncSeparate(GL_FRONT_AND_BACK, GL_EQUAL, 128, ~0); 
+  WRATHGLStateShadow::stencil_func_separate(GL_FRONT_AND_BACK, GL_EQUAL, 128, ~0); 
   m_edges.draw(pvm, false);
 
   if(m_points!=NULL)
@@ -884,28 +885,23 @@ generate_distance_field(const WRATHShapeSimpleTessellatorPayload::handle &h,
   glBindBuffer(GL_ARRAY_BUFFER, 0);
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
-  glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-  glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+  WRATHGLStateShadow::clear_color(vec4(0.0f, 0.0f, 0.0f, 0.0f));
+  WRATHGLStateShadow::color_mask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
 
   //note that 128 for the stencil clear value
-  glClearStencil(128);  
-  glStencilMask(~0);
-  glEnable(GL_STENCIL_TEST);
+  WRATHGLStateShadow::clear_stencil(128);  
+  WRATHGLStateShadow::stencil_mask(~0);
+  WRATHGLStateShadow::enable(GL_STENCIL_TEST);
 
-  glDisable(GL_BLEND);
-  glDisable(GL_CULL_FACE);
+  WRATHGLStateShadow::disable(GL_BLEND);
+  WRATHGLStateShadow::disable(GL_CULL_FACE);
 
   if(need_depth_buffer)
     {
-      #if defined(WRATH_GL_VERSION)
-        glDepthRange(0.0, 1.0);
-        glClearDepth(1.0);
-      #else
-        glDepthRangef(0.0f, 1.0f);
-        glClearDepthf(1.0f);
-      #endif
+      WRATHGLStateShadow::depth_range(vec2(0.0f, 1.0f));
+      WRATHGLStateShadow::clear_depth(1.0f);
       
-      glDepthMask(GL_TRUE);
+      WRATHGLStateShadow::depth_mask(GL_TRUE);
       glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT|GL_STENCIL_BUFFER_BIT);
     }
   else
@@ -21,6 +21,7 @@
 #include "WRATHConfig.hpp"
 #include "WRATHShapeDistanceFieldGPUutil.hpp"
 #include "WRATHGLExtensionList.hpp"
+#include "WRATHGLStateShadow.hpp"
 #include "WRATHStaticInit.hpp"
 
 /*
@@ -82,6 +83,7 @@ operator()(void) const
   if(m_fbo)
     {
       glDeleteFramebuffers(1, &m_fbo);
+      WRATHGLStateShadow::framebuffer_deleted(m_fbo);
     }
 
   if(m_texture)
@@ -182,13 +184,13 @@ init_and_bind_fbo(ivec2 pdims, bool)
               */
               WRATHwarning("Cannot create FBO: GL implementation out of spec, faking via drawing to screen");
               m_current_dim=pdims;
-              glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
-              glViewport(0, 0, m_current_dim.x(), m_current_dim.y());
+              WRATHGLStateShadow::bind_framebuffer(m_fbo);
+              WRATHGLStateShadow::viewport(vecN<GLint, 4>(0, 0, m_current_dim.x(), m_current_dim.y()));
               return routine_success;
             }
         }
 
-      glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+      WRATHGLStateShadow::bind_framebuffer(m_fbo);
 
       #ifdef FBO_COLOR_USE_RENDERBUFFER
       {
@@ -285,8 +287,8 @@ init_and_bind_fbo(ivec2 pdims, bool)
   #endif
 
   m_current_dim=pdims;
-  glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
-  glViewport(0, 0, m_current_dim.x(), m_current_dim.y());
+  WRATHGLStateShadow::bind_framebuffer(m_fbo);
+  WRATHGLStateShadow::viewport(vecN<GLint, 4>(0, 0, m_current_dim.x(), m_current_dim.y()));
 
   return routine_success;
 }
@@ -20,6 +20,7 @@
 
 #include "WRATHConfig.hpp"
 #include <complex>
+#include <map>
 #include <stdint.h>
 #include "WRATHShapePreStroker.hpp"
 
@@ -579,72 +580,286 @@ do_rounded_join(float curve_thresh,
     }
 }
 
+//////////////////////////////////////////////////////
+// WRATHShapePreStrokerPayload::GenerateOutlineJob methods
+class WRATHShapePreStrokerPayload::GenerateOutlineJob:
+  public WRATHParallelFor::Job
+{
+public:
+  GenerateOutlineJob(const WRATHShapePreStrokerPayload *payload,
+                     const std::vector<int> &pending,
+                     std::vector<PacketSet> &output):
+    m_payload(payload),
+    m_pending(pending),
+    m_output(output)
+  {}
+
+  virtual
+  void
+  execute(int i)
+  {
+    m_payload->generate_outline(m_payload->m_h->tessellation()[m_pending[i]],
+                                m_output[i]);
+  }
+
+private:
+  const WRATHShapePreStrokerPayload *m_payload;
+  const std::vector<int> &m_pending;
+  std::vector<PacketSet> &m_output;
+};
+
 /////////////////////////////////////
 // WRATHShapePreStrokerPayload methods
 void
 WRATHShapePreStrokerPayload::
-generate_data(void)
+generate_data(const handle &previous)
 {
   WRATHassert(m_h.valid());
 
+  const std::vector<Outline::handle> &outlines(m_h->tessellation());
+  std::map<const Outline*, int> previous_outlines;
+  std::vector<int> reuse(outlines.size(), -1);
+  std::vector<int> pending;
+  std::vector<PacketSet> generated;
+
   m_effective_curve_thresh=std::max(float(M_PI)/256.0f,
                                     m_h->parameters().curve_tessellation_threshhold());
 
-  for(std::vector<Outline::handle>::const_iterator 
-        iter=m_h->tessellation().begin(),
-        end=m_h->tessellation().end(); iter!=end; ++iter)
+  /*
+    The tessellation payload reuses the TessellatedOutline
+    objects of those outlines that did not change, thus
+    the data of an outline can be taken from the previous 
+    payload exactly when the TessellatedOutline is 
+    the same object and the joins and caps are made
+    the same way.
+   */
+  if(previous.valid() 
+     and previous->m_flags==m_flags
+     and previous->m_effective_curve_thresh==m_effective_curve_thresh)
     {
-      /*
-        Handle outline does NOT make the joins that
-        are formed if the outline is closed
-        We want to make those joins at the end of our 
-        arrays, thus we do those at the end.
-       */
-      handle_outline(*iter);
+      const std::vector<Outline::handle> &prev_outlines(previous->m_h->tessellation());
+
+      WRATHassert(prev_outlines.size()==previous->m_outline_locations.size());
+      for(int k=0, endk=prev_outlines.size(); k<endk; ++k)
+        {
+          previous_outlines[prev_outlines[k].raw_pointer()]=k;
+        }
+    }
+
+  for(int k=0, endk=outlines.size(); k<endk; ++k)
+    {
+      std::map<const Outline*, int>::const_iterator iter;
+
+      iter=previous_outlines.find(outlines[k].raw_pointer());
+      if(iter!=previous_outlines.end())
+        {
+          reuse[k]=iter->second;
+        }
+      else
+        {
+          pending.push_back(k);
+        }
     }
 
   /*
-    Mark the location of where the joins
-    for closing the outline will be made.
+    generate the data of each changed outline
+    in parallel, each to its own PacketSet.
+    The work only reads the tessellation, it
+    does not call into the interpolators of
+    the WRATHOutline objects. Threads are only
+    worth creating if there are atleast two
+    outlines to process.
    */
-  m_miter_joins.set_markers();
-  m_bevel_joins.set_markers();
-  m_rounded_joins.set_markers();
+  generated.resize(pending.size());
+  GenerateOutlineJob job(this, pending, generated);
+  if(pending.size()>1)
+    {
+      WRATHParallelFor::run(job, pending.size());
+    }
+  else if(pending.size()==1)
+    {
+      job.execute(0);
+    }
 
-  for(std::vector<Outline::handle>::const_iterator 
-        iter=m_h->tessellation().begin(),
-        end=m_h->tessellation().end(); iter!=end; ++iter)
+  /*
+    Concatenate the data of the outlines. The joins
+    that are formed if an outline is closed are placed
+    at the end of our arrays, thus pass 0 takes the caps
+    and the joins within each outline and pass 1 takes 
+    the joins closing each outline.
+   */
+  m_outline_locations.resize(outlines.size());
+  for(int pass=0; pass<2; ++pass)
     {
-      const Outline::handle &O(*iter);
-      
-      if(!O->edges().empty())
+      for(int k=0, g=0, endk=outlines.size(); k<endk; ++k)
         {
-          /*
-            The join at the start point of the outline
-           */
-          handle_join(O, 
-                      O->edges().back(), 
-                      O->edges().front());
-
-          /*
-            The join at the end point of the outline
-            which is the join from the 2nd to last
-            edge to the last edge.
-           */
-          if(O->edges().size()>1)
+          if(reuse[k]!=-1)
+            {
+              append_outline(pass, 
+                             previous->m_data, 
+                             previous->m_outline_locations[reuse[k]],
+                             m_outline_locations[k]);
+            }
+          else
             {
-              unsigned int last(O->edges().size()-1);
-              handle_join(O, 
-                          O->edges()[last-1],
-                          O->edges()[last]);
+              append_outline(pass, 
+                             generated[g], 
+                             local_location(generated[g]),
+                             m_outline_locations[k]);
+              ++g;
             }
         }
+
+      if(pass==0)
+        {
+          /*
+            Mark the location of where the joins
+            for closing the outline will be made.
+          */
+          m_data.m_miter_joins.set_markers();
+          m_data.m_bevel_joins.set_markers();
+          m_data.m_rounded_joins.set_markers();
+        }
     }
 }
 
 void
 WRATHShapePreStrokerPayload::
-handle_outline(const Outline::handle &O)
+generate_outline(const Outline::handle &O, PacketSet &out) const
+{
+  /*
+    Handle outline does NOT make the joins that
+    are formed if the outline is closed.
+  */
+  handle_outline(O, out);
+
+  out.m_miter_joins.set_markers();
+  out.m_bevel_joins.set_markers();
+  out.m_rounded_joins.set_markers();
+
+  if(!O->edges().empty())
+    {
+      /*
+        The join at the start point of the outline
+      */
+      handle_join(O, 
+                  O->edges().back(), 
+                  O->edges().front(),
+                  out);
+      
+      /*
+        The join at the end point of the outline
+        which is the join from the 2nd to last
+        edge to the last edge.
+      */
+      if(O->edges().size()>1)
+        {
+          unsigned int last(O->edges().size()-1);
+          handle_join(O, 
+                      O->edges()[last-1],
+                      O->edges()[last],
+                      out);
+        }
+    }
+}
+
+void
+WRATHShapePreStrokerPayload::
+append_outline(int pass, 
+               const PacketSet &src, const OutlineLocation &src_location,
+               OutlineLocation &dst_location)
+{
+  if(pass==0)
+    {
+      append_slice(src.m_square_caps, src_location.m_square_caps,
+                   m_data.m_square_caps, dst_location.m_square_caps);
+
+      append_slice(src.m_rounded_caps, src_location.m_rounded_caps,
+                   m_data.m_rounded_caps, dst_location.m_rounded_caps);
+    }
+
+  append_slice(src.m_miter_joins, src_location.m_miter_joins[pass],
+               m_data.m_miter_joins, dst_location.m_miter_joins[pass]);
+
+  append_slice(src.m_bevel_joins, src_location.m_bevel_joins[pass],
+               m_data.m_bevel_joins, dst_location.m_bevel_joins[pass]);
+
+  append_slice(src.m_rounded_joins, src_location.m_rounded_joins[pass],
+               m_data.m_rounded_joins, dst_location.m_rounded_joins[pass]);
+}
+
+WRATHShapePreStrokerPayload::OutlineLocation
+WRATHShapePreStrokerPayload::
+local_location(const PacketSet &src)
+{
+  OutlineLocation R;
+
+  R.m_square_caps.m_pts=range_type<unsigned int>(0, src.m_square_caps.m_pts.size());
+  R.m_square_caps.m_indices=range_type<unsigned int>(0, src.m_square_caps.m_indices.size());
+
+  R.m_rounded_caps.m_pts=range_type<unsigned int>(0, src.m_rounded_caps.m_pts.size());
+  R.m_rounded_caps.m_indices=range_type<unsigned int>(0, src.m_rounded_caps.m_indices.size());
+
+  R.m_miter_joins[0].m_pts=range_type<unsigned int>(0, src.m_miter_joins.m_pt_marker);
+  R.m_miter_joins[0].m_indices=range_type<unsigned int>(0, src.m_miter_joins.m_ind_marker);
+  R.m_miter_joins[1].m_pts=range_type<unsigned int>(src.m_miter_joins.m_pt_marker, 
+                                                    src.m_miter_joins.m_pts.size());
+  R.m_miter_joins[1].m_indices=range_type<unsigned int>(src.m_miter_joins.m_ind_marker, 
+                                                        src.m_miter_joins.m_indices.size());
+
+  R.m_bevel_joins[0].m_pts=range_type<unsigned int>(0, src.m_bevel_joins.m_pt_marker);
+  R.m_bevel_joins[0].m_indices=range_type<unsigned int>(0, src.m_bevel_joins.m_ind_marker);
+  R.m_bevel_joins[1].m_pts=range_type<unsigned int>(src.m_bevel_joins.m_pt_marker, 
+                                                    src.m_bevel_joins.m_pts.size());
+  R.m_bevel_joins[1].m_indices=range_type<unsigned int>(src.m_bevel_joins.m_ind_marker, 
+                                                        src.m_bevel_joins.m_indices.size());
+
+  R.m_rounded_joins[0].m_pts=range_type<unsigned int>(0, src.m_rounded_joins.m_pt_marker);
+  R.m_rounded_joins[0].m_indices=range_type<unsigned int>(0, src.m_rounded_joins.m_ind_marker);
+  R.m_rounded_joins[1].m_pts=range_type<unsigned int>(src.m_rounded_joins.m_pt_marker, 
+                                                      src.m_rounded_joins.m_pts.size());
+  R.m_rounded_joins[1].m_indices=range_type<unsigned int>(src.m_rounded_joins.m_ind_marker, 
+                                                          src.m_rounded_joins.m_indices.size());
+
+  return R;
+}
+
+template<typename P>
+void
+WRATHShapePreStrokerPayload::
+append_slice(const P &src, const PacketRange &src_range,
+             P &dst, PacketRange &dst_range)
+{
+  /*
+    the joins and caps of an outline only
+    reference their own points, thus the
+    indices are just moved by the difference
+    in where the points are located.
+   */
+  dst_range.m_pts.m_begin=dst.m_pts.size();
+  dst_range.m_indices.m_begin=dst.m_indices.size();
+
+  dst.m_pts.insert(dst.m_pts.end(),
+                   src.m_pts.begin() + src_range.m_pts.m_begin,
+                   src.m_pts.begin() + src_range.m_pts.m_end);
+
+  for(unsigned int i=src_range.m_indices.m_begin; i<src_range.m_indices.m_end; ++i)
+    {
+      WRATHassert(src.m_indices[i]>=src_range.m_pts.m_begin);
+      WRATHassert(src.m_indices[i]<src_range.m_pts.m_end);
+
+      dst.m_indices.push_back(static_cast<GLushort>(src.m_indices[i] 
+                                                    - src_range.m_pts.m_begin
+                                                    + dst_range.m_pts.m_begin));
+    }
+
+  dst_range.m_pts.m_end=dst.m_pts.size();
+  dst_range.m_indices.m_end=dst.m_indices.size();
+}
+
+void
+WRATHShapePreStrokerPayload::
+handle_outline(const Outline::handle &O, PacketSet &out) const
 {
   if(O->edges().empty())
     {
@@ -655,7 +870,8 @@ handle_outline(const Outline::handle &O)
     {
       handle_join(O, 
                   O->edges()[i-1],
-                  O->edges()[i]);
+                  O->edges()[i],
+                  out);
     }
 
   //make caps at the last point:
@@ -665,20 +881,21 @@ handle_outline(const Outline::handle &O)
   //so we want the edge before the last one:
   handle_cap(O, 
              O->edge_to_last_point()->curve_points().back(),
-             false);
+             false, out);
   
   
   //make caps at the first point:
   handle_cap(O, 
              O->edges().front()->curve_points().front(),
-             true);
+             true, out);
 }
 
 void
 WRATHShapePreStrokerPayload::
 handle_join(const Outline::handle &O,
             const Edge::handle &pre,
-            const Edge::handle &post)
+            const Edge::handle &post,
+            PacketSet &out) const
 {
   if(m_flags&generate_joins)
     {
@@ -686,23 +903,23 @@ handle_join(const Outline::handle &O,
 
       if(m_flags&generate_bevel_joins)
         {
-          CJD.do_bevel_join(m_bevel_joins.m_pts,
-                            m_bevel_joins.m_indices);
+          CJD.do_bevel_join(out.m_bevel_joins.m_pts,
+                            out.m_bevel_joins.m_indices);
         }
 
       
 
       if(m_flags&generate_miter_joins)
         {
-          CJD.do_miter_join(m_miter_joins.m_pts,
-                            m_miter_joins.m_indices);
+          CJD.do_miter_join(out.m_miter_joins.m_pts,
+                            out.m_miter_joins.m_indices);
         }
 
       if(m_flags&generate_rounded_joins)
         {
           CJD.do_rounded_join(m_effective_curve_thresh,
-                              m_rounded_joins.m_pts,
-                              m_rounded_joins.m_indices);
+                              out.m_rounded_joins.m_pts,
+                              out.m_rounded_joins.m_indices);
         }
       
     }
@@ -713,7 +930,8 @@ void
 WRATHShapePreStrokerPayload::
 handle_cap(const Outline::handle &O,
            const CurvePoint &pt,
-           bool is_starting_cap)
+           bool is_starting_cap,
+           PacketSet &out) const
 {
   if(m_flags&generate_caps)
     {
@@ -721,16 +939,16 @@ handle_cap(const Outline::handle &O,
 
       if(m_flags&generate_square_caps)
         {
-          CCD.do_square_cap(m_square_caps.m_pts,
-                            m_square_caps.m_indices);
+          CCD.do_square_cap(out.m_square_caps.m_pts,
+                            out.m_square_caps.m_indices);
                             
         }
 
       if(m_flags&generate_rounded_caps)
         {
           CCD.do_rounded_cap(m_effective_curve_thresh,
-                             m_rounded_caps.m_pts,
-                             m_rounded_caps.m_indices);
+                             out.m_rounded_caps.m_pts,
+                             out.m_rounded_caps.m_indices);
         }
     }
 }
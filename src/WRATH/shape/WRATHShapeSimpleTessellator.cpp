@@ -163,21 +163,107 @@ namespace
   }
 
 
+  /*
+    bound on the number of recursions when
+    tessellating to a tolerance, an edge is 
+    then tessellated to at most 1+2^12 points
+   */
+  const int max_tolerance_recurse=12;
+
+  void
+  do_flatten_worker(std::vector<analytic_point_data_with_time> &output_pts,
+                    unsigned int index_of_start, unsigned int index_of_end,
+                    const WRATHShapeSimpleTessellatorPrivateImplement::interpolator_base *edge, 
+                    float tol, int max_recurse)
+  {
+    if(max_recurse<=0)
+      {
+        return;
+      }
+
+    unsigned int mid_pt_index;
+    float delta_t, max_p_tt, err;
+    float start_t(output_pts[index_of_start].time());
+    float end_t(output_pts[index_of_end].time());
+
+    analytic_point_data_with_time mid_pt(edge, (start_t + end_t)*0.5f);
+
+    delta_t=end_t - start_t;
+    WRATHassert(delta_t>=0.0f);
+
+    /*
+      Approximate the curve over [start_t, end_t]
+      by a parabola: the distance between the curve 
+      and the line segment connecting its end points
+      is then no more than delta_t*delta_t*max||p_tt||/8.
+      For quadratic and cubic Bezier curves, p_tt is 
+      linear in t, so taking the max at the end points 
+      gives the exact bound; the midpoint is included
+      for curves of higher degree and generic curves.
+     */
+    max_p_tt=std::max(output_pts[index_of_start].m_p_tt.magnitude(),
+                      output_pts[index_of_end].m_p_tt.magnitude());
+    max_p_tt=std::max(max_p_tt, mid_pt.m_p_tt.magnitude());
+    err=0.125f*delta_t*delta_t*max_p_tt;
+
+    if(err<=tol)
+      {
+        return;
+      }
+
+    mid_pt_index=output_pts.size();
+    output_pts.push_back(mid_pt);
+
+    do_flatten_worker(output_pts,
+                      index_of_start, mid_pt_index,
+                      edge, tol, max_recurse-1);
+    
+    do_flatten_worker(output_pts,
+                      mid_pt_index, index_of_end,
+                      edge, tol, max_recurse-1);
+  }
+
   void
-  do_tessellation(int max_recurse,
+  do_tessellation(const WRATHShapeSimpleTessellatorPayload::PayloadParams &params,
                   std::vector<analytic_point_data_with_time> &output_pts,
-                  const WRATHShapeSimpleTessellatorPrivateImplement::interpolator_base *edge, 
-                  float curc_tthresh)
+                  const WRATHShapeSimpleTessellatorPrivateImplement::interpolator_base *edge)
   {
 
     output_pts.push_back( analytic_point_data_with_time(edge->start_pt(), 0.0f));
     output_pts.push_back( analytic_point_data_with_time(edge->end_pt(), 1.0f));
 
-    if(!edge->is_flat())
+    if(edge->is_flat())
       {
-        do_tessellation_worker(output_pts, 0, 1, edge, curc_tthresh, max_recurse);
-        std::sort(output_pts.begin(), output_pts.end());
+        return;
       }
+
+    if(!params.use_tolerance())
+      {
+        do_tessellation_worker(output_pts, 0, 1, edge, 
+                               params.curve_tessellation_threshhold(), 
+                               params.m_max_recurse);
+      }
+    else
+      {
+        float tol(params.local_tolerance());
+        int N;
+
+        N=edge->uniform_segment_count(tol, 1<<max_tolerance_recurse);
+        if(N>0)
+          {
+            float recipN(1.0f/static_cast<float>(N));
+            for(int i=1; i<N; ++i)
+              {
+                output_pts.push_back(analytic_point_data_with_time(edge, 
+                                                                   static_cast<float>(i)*recipN));
+              }
+          }
+        else
+          {
+            do_flatten_worker(output_pts, 0, 1, edge, tol, max_tolerance_recurse);
+          }
+      }
+    std::sort(output_pts.begin(), output_pts.end());
   }
 
   
@@ -366,17 +452,44 @@ compute(float t, analytic_point_data &output) const
 
 }
 
+int
+WRATHShapeSimpleTessellatorPrivateImplement::arc_interpolator::
+uniform_segment_count(float tol, int max_count) const
+{
+  /*
+    A chord of a circle of radius R that spans
+    an angle theta is at most R*(1-cos(theta/2))
+    from the circle, thus break the arc into pieces
+    each spanning no more than 2*acos(1 - tol/R).
+   */
+  float max_theta, N;
+
+  if(tol>=m_radius)
+    {
+      return 1;
+    }
+
+  max_theta=2.0f*acosf(1.0f - tol/m_radius);
+  if(max_theta<=0.0f)
+    {
+      return max_count;
+    }
+
+  N=std::ceil(std::abs(m_angle_speed)/max_theta);
+  return std::max(1, std::min(max_count, static_cast<int>(N)));
+}
+
 
 /////////////////////////////////////////
 // WRATHShapeSimpleTessellatorPrivateImplement::geometry_computer methods
 WRATHShapeSimpleTessellatorPrivateImplement::geometry_computer::
 ~geometry_computer()
 {
-  for(std::list<outline_type>::iterator iter=m_input_outline_data.begin(),
+  for(std::vector<outline_entry>::iterator iter=m_input_outline_data.begin(),
         end=m_input_outline_data.end(); iter!=end; ++iter)
     {
-      for(outline_type::iterator i=iter->begin(), 
-            e=iter->end(); i!=e; ++i)
+      for(outline_type::iterator i=iter->m_interpolators.begin(), 
+            e=iter->m_interpolators.end(); i!=e; ++i)
         {
           WRATHDelete(*i);
         }          
@@ -385,30 +498,90 @@ WRATHShapeSimpleTessellatorPrivateImplement::geometry_computer::
 
 void
 WRATHShapeSimpleTessellatorPrivateImplement::geometry_computer::
-compute_implement(const WRATHShapeSimpleTessellatorPayload::PayloadParams &params)
+compute_implement(void)
 {
-  std::list<outline_type>::const_iterator iter, end;
-  int outlineID;
+  int outlineID, endOutlineID;
+  unsigned int pendingID;
 
-  for(outlineID=0, iter=m_input_outline_data.begin(),
-        end=m_input_outline_data.end(); iter!=end; ++iter)
+  endOutlineID=m_input_outline_data.size();
+  for(outlineID=0; outlineID<endOutlineID; ++outlineID)
+    {
+      const outline_entry &entry(m_input_outline_data[outlineID]);
+      if(!entry.m_reused.valid() 
+         and !entry.m_interpolators.empty()
+         and entry.m_hash_code==routine_success)
+        {
+          m_pending.push_back(outlineID);
+        }
+    }
+
+  /*
+    each outline is tessellated independently
+    of the others, so let them run in parallel.
+    Each index writes only its own slot of
+    m_pending_results. Outlines that use a
+    GenericInterpolator (i.e. whose content_hash()
+    failed) are not in m_pending, they are
+    tessellated from the calling thread below
+    because GenericInterpolator::compute() is
+    user code not required to be thread safe.
+   */
+  m_pending_results.resize(m_pending.size());
+  if(m_pending.size()>1)
+    {
+      WRATHParallelFor::run(*this, m_pending.size());
+    }
+  else if(m_pending.size()==1)
+    {
+      execute(0);
+    }
+
+  for(outlineID=0, pendingID=0; outlineID<endOutlineID; ++outlineID)
     {
-      if(!iter->empty())
+      const outline_entry &entry(m_input_outline_data[outlineID]);
+
+      if(entry.m_reused.valid())
         {
-          m_tessellation.push_back(create_outline(outlineID, *iter, params));
-          m_box.set_or(m_tessellation.back()->bounding_box());
+          m_tessellation.push_back(entry.m_reused);
         }
+      else if(entry.m_interpolators.empty())
+        {
+          continue;
+        }
+      else if(entry.m_hash_code==routine_success)
+        {
+          WRATHassert(pendingID<m_pending.size() and m_pending[pendingID]==outlineID);
+          m_tessellation.push_back(m_pending_results[pendingID]);
+          ++pendingID;
+        }
+      else
+        {
+          m_tessellation.push_back(create_outline(outlineID, entry, m_params));
+        }
+      m_box.set_or(m_tessellation.back()->bounding_box());
     }
 }
 
+void
+WRATHShapeSimpleTessellatorPrivateImplement::geometry_computer::
+execute(int i)
+{
+  int outlineID(m_pending[i]);
+
+  m_pending_results[i]=create_outline(outlineID, 
+                                      m_input_outline_data[outlineID], 
+                                      m_params);
+}
+
 WRATHShapeSimpleTessellatorPayload::TessellatedOutline::handle
 WRATHShapeSimpleTessellatorPrivateImplement::geometry_computer::
 create_outline(int outlineID,
-               const outline_type &outline,
+               const outline_entry &entry,
                const WRATHShapeSimpleTessellatorPayload::PayloadParams &params)
 {
   WRATHShapeSimpleTessellatorPayload::TessellatedOutline::handle R;
   std::vector<WRATHShapeSimpleTessellatorPayload::TessellatedEdge::handle> edges;
+  const outline_type &outline(entry.m_interpolators);
   
   for(unsigned int i=1, endi=outline.size(); i!=endi; ++i)
     {
@@ -423,7 +596,9 @@ create_outline(int outlineID,
                               params, outlineID));
 
   R=WRATHNew WRATHShapeSimpleTessellatorPayload::TessellatedOutline(outlineID,
-                                                                    edges);
+                                                                    edges,
+                                                                    entry.m_hash_code,
+                                                                    entry.m_hash);
 
   return R;
 }
@@ -446,9 +621,7 @@ create_edge(const interpolator_base *edge,
   */
   std::vector<analytic_point_data_with_time> tess_pts;
   
-  do_tessellation(params.m_max_recurse, 
-                  tess_pts, edge, 
-                  params.curve_tessellation_threshhold());
+  do_tessellation(params, tess_pts, edge);
   
   /*
     Now that we've got the points,
@@ -0,0 +1,838 @@
+/*! 
+ * \file WRATHCompactTextAttributePacker.cpp
+ * \brief file WRATHCompactTextAttributePacker.cpp
+ * 
+ * Copyright 2013 by Nomovok Ltd.
+ * 
+ * Contact: info@nomovok.com
+ * 
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ * 
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ * 
+ */
+
+
+
+#include "WRATHConfig.hpp"
+#include <boost/bind.hpp>
+#include "WRATHCompactTextAttributePacker.hpp"
+#include "WRATHInterleavedAttributes.hpp"
+#include "WRATHCanvas.hpp"
+#include "WRATHUtil.hpp"
+
+namespace
+{
+  typedef vec3 position_type;
+  typedef vec2 glyph_scale_type;
+  typedef vecN<GLushort,2> glyph_scale_half_type;
+  typedef vecN<GLushort,4> glyph_size_and_bottom_left_type;
+  typedef vecN<GLushort,2> glyph_table_location_type;
+  typedef vecN<GLubyte,4> color_type;
+
+  enum
+    {
+      /*
+        added to the glyph size to encode
+        the corner of the glyph and the
+        sign of the y-coordinate, see
+        compact_ui_font.vert.wrath-shader.glsl
+       */
+      corner_bit=32768,
+      y_negative_bit=16384,
+      max_glyph_size=y_negative_bit,
+
+      /*
+        added to the column of the glyph table
+        location of an instanced attribute if
+        the y-coordinate increases downwards.
+       */
+      table_y_negative_bit=32768,
+
+      /*
+        width of a glyph table in texels,
+        i.e. glyphs per row
+       */
+      log2_glyph_table_width=8,
+      glyph_table_width=1<<log2_glyph_table_width
+    };
+
+  void
+  set_scale(glyph_scale_type &dest, const vec2 &v)
+  {
+    dest=v;
+  }
+  
+  void
+  set_scale(glyph_scale_half_type &dest, const vec2 &v)
+  {
+    WRATHUtil::convert_to_halfp_from_float(dest, v);
+  }
+
+  /*
+    S is the type of the glyph scale, glyph_scale_type
+    for WRATHAttributePacker::full_precision_format and 
+    glyph_scale_half_type (16-bit floats) for 
+    WRATHAttributePacker::half_precision_format
+   */
+  template<typename S>
+  class character_attribute_t:
+    public WRATHInterleavedAttributes<position_type, //position -- 0
+                                      S, //glyph_scale -- 1
+                                      glyph_size_and_bottom_left_type, //glyph_size_and_bottom_left -- 2
+                                      color_type //color --3
+                                      >
+  {
+  public:
+
+    position_type&
+    position(void)
+    {
+      return this->template get<WRATHCompactTextAttributePacker::position_location>();
+    }
+
+    void
+    glyph_scale(const vec2 &v)
+    {
+      set_scale(this->template get<WRATHCompactTextAttributePacker::glyph_scale_location>(), v);
+    }
+
+    glyph_size_and_bottom_left_type&
+    glyph_size_and_bottom_left(void)
+    {
+      return this->template get<WRATHCompactTextAttributePacker::glyph_size_and_bottom_left_location>();
+    }
+
+    color_type&
+    color(void)
+    {
+      return this->template get<WRATHCompactTextAttributePacker::color_location>();
+    }
+  };
+
+  typedef character_attribute_t<glyph_scale_type> character_attribute;
+  typedef character_attribute_t<glyph_scale_half_type> character_attribute_half;
+
+  /*
+    attribute of a glyph of an instanced packer,
+    S is as in character_attribute_t
+   */
+  template<typename S>
+  class instance_attribute_t:
+    public WRATHInterleavedAttributes<position_type, //position -- 0
+                                      S, //glyph_scale -- 1
+                                      glyph_table_location_type, //glyph_table_location -- 2
+                                      color_type, //color_bottom_left -- 3
+                                      color_type, //color_bottom_right -- 4
+                                      color_type, //color_top_right -- 5
+                                      color_type //color_top_left -- 6
+                                      >
+  {
+  public:
+
+    position_type&
+    position(void)
+    {
+      return this->template get<WRATHCompactTextAttributePacker::instanced_position_location>();
+    }
+
+    void
+    glyph_scale(const vec2 &v)
+    {
+      set_scale(this->template get<WRATHCompactTextAttributePacker::instanced_glyph_scale_location>(), v);
+    }
+
+    glyph_table_location_type&
+    glyph_table_location(void)
+    {
+      return this->template get<WRATHCompactTextAttributePacker::glyph_table_location_location>();
+    }
+
+    void
+    colors(const vecN<WRATHText::color_type, 4> &c)
+    {
+      this->template get<WRATHCompactTextAttributePacker::color_bottom_left_location>()
+        =c[WRATHFormattedTextStream::bottom_left_corner];
+      this->template get<WRATHCompactTextAttributePacker::color_bottom_right_location>()
+        =c[WRATHFormattedTextStream::bottom_right_corner];
+      this->template get<WRATHCompactTextAttributePacker::color_top_right_location>()
+        =c[WRATHFormattedTextStream::top_right_corner];
+      this->template get<WRATHCompactTextAttributePacker::color_top_left_location>()
+        =c[WRATHFormattedTextStream::top_left_corner];
+    }
+  };
+
+  typedef instance_attribute_t<glyph_scale_type> instance_attribute;
+  typedef instance_attribute_t<glyph_scale_half_type> instance_attribute_half;
+
+  /*
+    The table of the glyphs of a font for the
+    instanced packers. It holds its texels client
+    side and, as GradientTexture of WRATHGradient.cpp,
+    uploads the dirty rows when bound. A glyph is
+    given the next slot of the table the first time
+    it is packed.
+   */
+  class GlyphTable:public WRATHTextureChoice::texture_base
+  {
+  public:
+    typedef handle_t<GlyphTable> handle;
+
+    GlyphTable(void);
+    ~GlyphTable();
+
+    void
+    bind_texture(GLenum);
+
+    /*
+      returns the location of the glyph in the
+      table, adding the glyph if necessary. May
+      be called from several threads.
+     */
+    glyph_table_location_type
+    location(const WRATHTextureFont::glyph_data_type *G);
+
+  private:
+
+    void
+    flush(void);
+
+    WRATHMutex m_mutex;
+    std::map<const WRATHTextureFont::glyph_data_type*, int> m_slots;
+    std::vector<GLushort> m_texels;
+    int m_first_dirty_row, m_last_dirty_row;
+
+    /*
+      GL .. stuff.
+     */
+    GLuint m_texture;
+    int m_texture_height;
+  };
+
+  template<unsigned int N, typename A=character_attribute>
+  class character_attribute_with_custom
+  {
+  public:
+    A m_base;
+    GLfloat m_custom[N];
+  };
+
+  WRATHCompactTextAttributePacker*&
+  the_ptr(enum WRATHAttributePacker::attribute_format_type fmt, bool instanced)
+  {
+    static vecN<WRATHCompactTextAttributePacker*, 4> R(NULL, NULL, NULL, NULL);
+    return R[fmt + ((instanced)?2:0)];
+  }
+
+  typedef const char *attribute_label_type;
+
+  const_c_array<attribute_label_type>
+  packer_attribute_names(void)
+  {
+    static const attribute_label_type attribute_labels[]=
+      {
+        "pos",
+        "glyph_scale",
+        "glyph_size_and_bottom_left",
+        "color",
+      };
+    static const_c_array<attribute_label_type> R(attribute_labels, 4);
+    return R;
+  }
+
+  const_c_array<attribute_label_type>
+  instanced_packer_attribute_names(void)
+  {
+    static const attribute_label_type attribute_labels[]=
+      {
+        "pos",
+        "glyph_scale",
+        "glyph_table_location",
+        "color_bottom_left",
+        "color_bottom_right",
+        "color_top_right",
+        "color_top_left",
+      };
+    static const_c_array<attribute_label_type> R(attribute_labels, 7);
+    return R;
+  }
+
+  const char*
+  packer_label(enum WRATHAttributePacker::attribute_format_type fmt, bool instanced)
+  {
+    if(instanced)
+      {
+        return fmt==WRATHAttributePacker::half_precision_format?
+          "WRATHCompactTextAttributePacker-instanced-half":
+          "WRATHCompactTextAttributePacker-instanced";
+      }
+    return fmt==WRATHAttributePacker::half_precision_format?
+      "WRATHCompactTextAttributePacker-half":
+      "WRATHCompactTextAttributePacker";
+  }
+
+  template<typename A>
+  size_t
+  attribute_size_implement(int n)
+  {
+    return (n==0)?
+      sizeof(A):
+      sizeof(character_attribute_with_custom<1, A>) + sizeof(float)*(n-1);
+  }
+
+  template<typename A>
+  ptrdiff_t
+  custom_data_offset(void)
+  {
+    const char *p1, *p2;
+    character_attribute_with_custom<1, A> conveniance;
+
+    p1=reinterpret_cast<const char*>(boost::addressof(conveniance));
+    p2=reinterpret_cast<const char*>(boost::addressof(conveniance.m_custom[0]));
+    return p2-p1;
+  }
+
+  template<typename A>
+  void
+  pack_attribute_implement(enum WRATHFormattedTextStream::corner_type ct,
+                           const WRATHGenericTextAttributePacker::glyph_data &in_glyph,
+                           const vec2 &normalized_glyph_coordinate_float,
+                           const std::vector<int> &custom_data_use,
+                           c_array<uint8_t> packing_destination)
+  {
+    c_array<A> attr;
+    ivec2 native_bl(in_glyph.m_glyph->texel_lower_left());
+    ivec2 native_sz(in_glyph.m_glyph->texel_size());
+    float scale(in_glyph.m_scale);
+
+    WRATHassert(ct!=WRATHFormattedTextStream::not_corner);
+    WRATHassert(native_sz.x()<max_glyph_size and native_sz.y()<max_glyph_size);
+
+    attr=packing_destination
+      .sub_array(0, sizeof(A))
+      .template reinterpret_pointer<A>();
+
+    /*
+      the normalized coordinate of a corner of
+      the quad is (0 or 1, 0 or 1) when y increases
+      upwards and (0 or 1, 0 or -1) when y increases
+      downwards.
+     */
+    if(normalized_glyph_coordinate_float.x()>0.5f)
+      {
+        native_sz.x()+=corner_bit;
+      }
+
+    if(normalized_glyph_coordinate_float.y()>0.5f)
+      {
+        native_sz.y()+=corner_bit;
+      }
+    else if(normalized_glyph_coordinate_float.y()<-0.5f)
+      {
+        native_sz.y()+=corner_bit + y_negative_bit;
+      }
+
+    attr[0].position()=position_type(in_glyph.m_native_position[0].x(),
+                                     in_glyph.m_native_position[0].y(),
+                                     in_glyph.m_z_position);
+    attr[0].glyph_scale(vec2(scale*in_glyph.m_horizontal_stretching,
+                             scale*in_glyph.m_vertical_stretching));
+    attr[0].glyph_size_and_bottom_left()
+      =glyph_size_and_bottom_left_type(native_sz.x(), native_sz.y(),
+                                       native_bl.x(), native_bl.y());
+    attr[0].color()=in_glyph.m_color[ct];
+
+    if(!custom_data_use.empty())
+      {
+        c_array<character_attribute_with_custom<1, A> > attr_with;
+        attr_with=packing_destination
+          .sub_array(0, sizeof(character_attribute_with_custom<1, A>))
+          .template reinterpret_pointer<character_attribute_with_custom<1, A> >();
+
+        WRATHassert(&attr_with[0].m_base==&attr[0]);
+
+        for(int i=0, endi=custom_data_use.size(); i<endi; ++i)
+          {
+            attr_with[0].m_custom[i]=in_glyph.m_glyph->fetch_custom_float(custom_data_use[i]);
+          }
+      }
+  }
+
+  template<typename A>
+  void
+  pack_instance_implement(const WRATHGenericTextAttributePacker::glyph_data &in_glyph,
+                          const vec2 &normalized_glyph_coordinate_float,
+                          const std::vector<int> &custom_data_use,
+                          c_array<uint8_t> packing_destination,
+                          GlyphTable *table)
+  {
+    c_array<A> attr;
+    glyph_table_location_type loc;
+    ivec2 native_sz(in_glyph.m_glyph->texel_size());
+    float scale(in_glyph.m_scale);
+
+    WRATHassert(table!=NULL);
+    WRATHassert(native_sz.x()<max_glyph_size and native_sz.y()<max_glyph_size);
+    WRATHunused(native_sz);
+
+    attr=packing_destination
+      .sub_array(0, sizeof(A))
+      .template reinterpret_pointer<A>();
+
+    /*
+      the normalized coordinate passed is that of 
+      the top right corner, whose y is negative
+      when y increases downwards.
+     */
+    loc=table->location(in_glyph.m_glyph);
+    if(normalized_glyph_coordinate_float.y()<0.0f)
+      {
+        loc.x()+=table_y_negative_bit;
+      }
+
+    attr[0].position()=position_type(in_glyph.m_native_position[0].x(),
+                                     in_glyph.m_native_position[0].y(),
+                                     in_glyph.m_z_position);
+    attr[0].glyph_scale(vec2(scale*in_glyph.m_horizontal_stretching,
+                             scale*in_glyph.m_vertical_stretching));
+    attr[0].glyph_table_location()=loc;
+    attr[0].colors(in_glyph.m_color);
+
+    if(!custom_data_use.empty())
+      {
+        c_array<character_attribute_with_custom<1, A> > attr_with;
+        attr_with=packing_destination
+          .sub_array(0, sizeof(character_attribute_with_custom<1, A>))
+          .template reinterpret_pointer<character_attribute_with_custom<1, A> >();
+
+        WRATHassert(&attr_with[0].m_base==&attr[0]);
+
+        for(int i=0, endi=custom_data_use.size(); i<endi; ++i)
+          {
+            attr_with[0].m_custom[i]=in_glyph.m_glyph->fetch_custom_float(custom_data_use[i]);
+          }
+      }
+  }
+}
+
+///////////////////////////////////////
+// GlyphTable methods
+GlyphTable::
+GlyphTable(void):
+  m_first_dirty_row(-1),
+  m_last_dirty_row(-1),
+  m_texture(0),
+  m_texture_height(0)
+{}
+
+GlyphTable::
+~GlyphTable()
+{
+  /*
+    as GradientTexture, we assume the GL
+    context is current when the last handle
+    to the table goes out of scope.
+   */
+  if(m_texture!=0)
+    {
+      glDeleteTextures(1, &m_texture);
+    }
+}
+
+glyph_table_location_type
+GlyphTable::
+location(const WRATHTextureFont::glyph_data_type *G)
+{
+  std::map<const WRATHTextureFont::glyph_data_type*, int>::iterator iter;
+  int slot, row;
+
+  WRATHAutoLockMutex(m_mutex);
+
+  iter=m_slots.find(G);
+  if(iter!=m_slots.end())
+    {
+      slot=iter->second;
+      return glyph_table_location_type(slot&(glyph_table_width-1),
+                                       slot>>log2_glyph_table_width);
+    }
+
+  slot=m_slots.size();
+  row=slot>>log2_glyph_table_width;
+  m_slots[G]=slot;
+
+  /*
+    the table is grown a row at a time,
+    a texel is 4 GLushort's.
+   */
+  m_texels.resize(4*glyph_table_width*(row+1), 0);
+
+  c_array<GLushort> texel(&m_texels[4*slot], 4);
+  texel[0]=G->texel_size().x();
+  texel[1]=G->texel_size().y();
+  texel[2]=G->texel_lower_left().x();
+  texel[3]=G->texel_lower_left().y();
+
+  m_first_dirty_row=(m_first_dirty_row==-1)?row:std::min(row, m_first_dirty_row);
+  m_last_dirty_row=std::max(row, m_last_dirty_row);
+
+  return glyph_table_location_type(slot&(glyph_table_width-1), row);
+}
+
+void
+GlyphTable::
+bind_texture(GLenum)
+{
+  #if WRATH_GL_GLES_VERSION>=3
+  {
+    if(m_texture==0)
+      {
+        glGenTextures(1, &m_texture);
+        glBindTexture(GL_TEXTURE_2D, m_texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+      }
+    else
+      {
+        glBindTexture(GL_TEXTURE_2D, m_texture);
+      }
+    flush();
+  }
+  #else
+  {
+    WRATHwarning("Instanced glyph tables require GL 3.3 or GLES3");
+  }
+  #endif
+}
+
+void
+GlyphTable::
+flush(void)
+{
+  #if WRATH_GL_GLES_VERSION>=3
+  {
+    /*
+      the texels are uploaded with m_mutex locked since
+      location() may resize m_texels from another thread.
+     */
+    WRATHAutoLockMutex(m_mutex);
+    int number_rows(m_texels.size()/(4*glyph_table_width));
+
+    if(m_texture_height<std::max(1, number_rows))
+      {
+        /*
+          (re)create the storage of the texture
+          doubling its height, then upload all
+          rows.
+         */
+        m_texture_height=std::max(1, std::max(2*m_texture_height, number_rows));
+        glTexImage2D(GL_TEXTURE_2D, 
+                     0, //mipmap
+                     GL_RGBA16UI,
+                     glyph_table_width, m_texture_height, 0, //size
+                     GL_RGBA_INTEGER,
+                     GL_UNSIGNED_SHORT,
+                     NULL);
+        m_first_dirty_row=(number_rows>0)?0:-1;
+        m_last_dirty_row=number_rows-1;
+      }
+
+    if(m_first_dirty_row!=-1)
+      {
+        glTexSubImage2D(GL_TEXTURE_2D,
+                        0, //LOD
+                        0, m_first_dirty_row, //coordinate of rect
+                        glyph_table_width, 
+                        m_last_dirty_row - m_first_dirty_row + 1, //size of rect
+                        GL_RGBA_INTEGER,
+                        GL_UNSIGNED_SHORT,
+                        &m_texels[4*glyph_table_width*m_first_dirty_row]);
+        m_first_dirty_row=-1;
+        m_last_dirty_row=-1;
+      }
+  }
+  #endif
+}
+
+//////////////////////////////////////////////////////
+// WRATHCompactTextAttributePacker::per_font_glyph_table methods
+class WRATHCompactTextAttributePacker::per_font_glyph_table
+{
+public:
+  GlyphTable::handle m_table;
+  boost::signals2::connection m_dtor_connection;
+};
+
+WRATHCompactTextAttributePacker::
+WRATHCompactTextAttributePacker(enum WRATHAttributePacker::attribute_format_type fmt,
+                                bool pinstanced):
+  WRATHGenericTextAttributePacker(packer_label(fmt, pinstanced),
+                                  (pinstanced)?InstancedPacker:SingleQuadPacker),
+  m_format(fmt)
+{
+  WRATHassert(the_ptr(fmt, pinstanced)==NULL);
+  the_ptr(fmt, pinstanced)=this;
+}
+
+WRATHCompactTextAttributePacker::
+~WRATHCompactTextAttributePacker()
+{
+  WRATHassert(the_ptr(m_format, instanced())==this);
+  the_ptr(m_format, instanced())=NULL;
+
+  for(glyph_table_map::iterator iter=m_glyph_tables.begin(),
+        end=m_glyph_tables.end(); iter!=end; ++iter)
+    {
+      iter->second->m_dtor_connection.disconnect();
+      WRATHDelete(iter->second);
+    }
+}
+
+WRATHCompactTextAttributePacker*
+WRATHCompactTextAttributePacker::
+fetch(enum WRATHAttributePacker::attribute_format_type fmt)
+{
+  if(the_ptr(fmt, false)==NULL)
+    {
+      WRATHNew WRATHCompactTextAttributePacker(fmt, false);
+    }
+  WRATHassert(the_ptr(fmt, false)!=NULL);
+  return the_ptr(fmt, false);
+}
+
+WRATHCompactTextAttributePacker*
+WRATHCompactTextAttributePacker::
+fetch_instanced(enum WRATHAttributePacker::attribute_format_type fmt)
+{
+  if(the_ptr(fmt, true)==NULL)
+    {
+      WRATHNew WRATHCompactTextAttributePacker(fmt, true);
+    }
+  WRATHassert(the_ptr(fmt, true)!=NULL);
+  return the_ptr(fmt, true);
+}
+
+size_t
+WRATHCompactTextAttributePacker::
+attribute_size(int n) const
+{
+  if(instanced())
+    {
+      return (m_format==WRATHAttributePacker::half_precision_format)?
+        attribute_size_implement<instance_attribute_half>(n):
+        attribute_size_implement<instance_attribute>(n);
+    }
+  return (m_format==WRATHAttributePacker::half_precision_format)?
+    attribute_size_implement<character_attribute_half>(n):
+    attribute_size_implement<character_attribute>(n);
+}
+
+void
+WRATHCompactTextAttributePacker::
+attribute_names(std::vector<std::string> &out_names, int number_custom_data) const
+{
+  const_c_array<attribute_label_type> names;
+
+  names=(instanced())?
+    instanced_packer_attribute_names():
+    packer_attribute_names();
+
+  out_names.resize(names.size());
+  std::copy(names.begin(), names.end(), out_names.begin());
+  append_custom_data_attribute_names(out_names, number_custom_data);
+}
+
+void
+WRATHCompactTextAttributePacker::
+generate_custom_data_glsl(WRATHGLShader::shader_source &out_src,
+                          int number_custom_data_to_use) const
+{
+  generate_custom_data_attribute_glsl(out_src, number_custom_data_to_use);
+}
+
+void
+WRATHCompactTextAttributePacker::
+attribute_key(WRATHAttributeStoreKey &pkey,
+              int number_custom_floats) const
+{
+  ptrdiff_t offset;
+  int first_custom_slot;
+
+  if(instanced())
+    {
+      if(m_format==WRATHAttributePacker::half_precision_format)
+        {
+          pkey
+            .type_and_format(type_tag<instance_attribute_half>())
+            .half_float_format(instanced_glyph_scale_location);
+          offset=custom_data_offset<instance_attribute_half>();
+        }
+      else
+        {
+          pkey
+            .type_and_format(type_tag<instance_attribute>());
+          offset=custom_data_offset<instance_attribute>();
+        }
+
+      for(int c=color_bottom_left_location; c<=color_top_left_location; ++c)
+        {
+          pkey.m_attribute_format_location[c].m_normalized=GL_TRUE;
+        }
+
+      /*
+        each attribute is one instance of
+        the 6 vertices of the quad of the glyph
+       */
+      pkey.instance_vertex_count(6);
+      first_custom_slot=instance_attribute::number_attributes;
+    }
+  else
+    {
+      if(m_format==WRATHAttributePacker::half_precision_format)
+        {
+          pkey
+            .type_and_format(type_tag<character_attribute_half>())
+            .half_float_format(glyph_scale_location);
+          offset=custom_data_offset<character_attribute_half>();
+        }
+      else
+        {
+          pkey
+            .type_and_format(type_tag<character_attribute>());
+          offset=custom_data_offset<character_attribute>();
+        }
+      
+      pkey.m_attribute_format_location[color_location].m_normalized=GL_TRUE;
+      first_custom_slot=character_attribute::number_attributes;
+    }
+
+  if(number_custom_floats!=0)
+    {
+      pkey.m_type_size=attribute_size(number_custom_floats);
+      set_custom_data_attribute_key(pkey, first_custom_slot,
+                                    offset, number_custom_floats);
+    }
+}
+
+const char*
+WRATHCompactTextAttributePacker::
+glyph_table_sampler_name(void) const
+{
+  return (instanced())?
+    "wrath_glyph_metrics":
+    NULL;
+}
+
+WRATHTextureChoice::texture_base::handle
+WRATHCompactTextAttributePacker::
+glyph_table(WRATHTextureFont *font) const
+{
+  if(!instanced())
+    {
+      return WRATHTextureChoice::texture_base::handle();
+    }
+
+  WRATHAutoLockMutex(m_glyph_tables_mutex);
+  glyph_table_map::iterator iter;
+
+  iter=m_glyph_tables.find(font);
+  if(iter!=m_glyph_tables.end())
+    {
+      return iter->second->m_table;
+    }
+
+  per_font_glyph_table *p;
+
+  p=WRATHNew per_font_glyph_table();
+  p->m_table=WRATHNew GlyphTable();
+  p->m_dtor_connection=
+    font->connect_dtor(boost::bind(&WRATHCompactTextAttributePacker::on_font_delete,
+                                   this, font));
+  m_glyph_tables[font]=p;
+  return p->m_table;
+}
+
+void
+WRATHCompactTextAttributePacker::
+on_font_delete(WRATHTextureFont *font) const
+{
+  WRATHAutoLockMutex(m_glyph_tables_mutex);
+  glyph_table_map::iterator iter;
+
+  iter=m_glyph_tables.find(font);
+  if(iter!=m_glyph_tables.end())
+    {
+      WRATHDelete(iter->second);
+      m_glyph_tables.erase(iter);
+    }
+}
+
+WRATHGenericTextAttributePacker::PackerState
+WRATHCompactTextAttributePacker::
+begin_range(const range_type<int>&,
+            WRATHTextureFont *font,
+            int,
+            const WRATHFormattedTextStream&,
+            const WRATHStateStream&) const
+{
+  /*
+    the table of the font is fetched once per
+    range rather than once per glyph.
+   */
+  return (instanced())?
+    PackerState(glyph_table(font)):
+    PackerState();
+}
+
+void
+WRATHCompactTextAttributePacker::
+pack_attribute(enum WRATHFormattedTextStream::corner_type ct,
+               const glyph_data &in_glyph,
+               const vec2 &normalized_glyph_coordinate_float,
+               vecN<GLshort,2>,
+               const std::vector<int> &custom_data_use,
+               c_array<uint8_t> packing_destination,
+               const PackerState &packer_state) const
+{
+  if(instanced())
+    {
+      GlyphTable *table;
+
+      table=static_cast<GlyphTable*>(packer_state.raw_pointer());
+      if(m_format==WRATHAttributePacker::half_precision_format)
+        {
+          pack_instance_implement<instance_attribute_half>(in_glyph,
+                                                           normalized_glyph_coordinate_float,
+                                                           custom_data_use,
+                                                           packing_destination,
+                                                           table);
+        }
+      else
+        {
+          pack_instance_implement<instance_attribute>(in_glyph,
+                                                      normalized_glyph_coordinate_float,
+                                                      custom_data_use,
+                                                      packing_destination,
+                                                      table);
+        }
+    }
+  else if(m_format==WRATHAttributePacker::half_precision_format)
+    {
+      pack_attribute_implement<character_attribute_half>(ct, in_glyph,
+                                                         normalized_glyph_coordinate_float,
+                                                         custom_data_use,
+                                                         packing_destination);
+    }
+  else
+    {
+      pack_attribute_implement<character_attribute>(ct, in_glyph,
+                                                    normalized_glyph_coordinate_float,
+                                                    custom_data_use,
+                                                    packing_destination);
+    }
+}
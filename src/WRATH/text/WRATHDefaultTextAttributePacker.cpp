@@ -22,20 +22,29 @@
 #include "WRATHDefaultTextAttributePacker.hpp"
 #include "WRATHInterleavedAttributes.hpp"
 #include "WRATHCanvas.hpp"
+#include "WRATHUtil.hpp"
 
 namespace
 {
   typedef vec4 position_type;
   typedef vec2 glyph_stretch_type;
+  typedef vecN<GLushort,2> glyph_stretch_half_type;
   typedef vecN<GLushort,4> glyph_size_and_bottom_left_type;
   typedef vecN<GLshort,2> glyph_normalized_coordinate_type;
   typedef vecN<GLubyte,4> color_type;
   
           
 
-  class character_attribute:
+  /*
+    S is the type of the glyph stretch, glyph_stretch_type
+    for WRATHAttributePacker::full_precision_format and 
+    glyph_stretch_half_type (16-bit floats) for 
+    WRATHAttributePacker::half_precision_format
+   */
+  template<typename S>
+  class character_attribute_t:
     public WRATHInterleavedAttributes<position_type, //position -- 0
-                                      glyph_stretch_type, //stretch -- 1
+                                      S, //stretch -- 1
                                       glyph_size_and_bottom_left_type, //glyph_size_and_bottom_left -- 2
                                       glyph_normalized_coordinate_type, //glyph_normalized -- 3
                                       color_type //color --4
@@ -46,31 +55,31 @@ namespace
     glyph_normalized_coordinate_type&
     glyph_normalized_coordinate(void)
     {
-      return get<WRATHDefaultTextAttributePacker::glyph_normalized_coordinate_location>();
+      return this->template get<WRATHDefaultTextAttributePacker::glyph_normalized_coordinate_location>();
     }
 
     color_type&
     color(void)
     {
-      return get<WRATHDefaultTextAttributePacker::color_location>();
+      return this->template get<WRATHDefaultTextAttributePacker::color_location>();
     }
 
     glyph_size_and_bottom_left_type&
     glyph_size_and_bottom_left(void)
     {
-      return get<WRATHDefaultTextAttributePacker::glyph_size_and_bottom_left_location>();
+      return this->template get<WRATHDefaultTextAttributePacker::glyph_size_and_bottom_left_location>();
     }
     
     position_type&
     position(void)
     {
-      return get<WRATHDefaultTextAttributePacker::position_location>();
+      return this->template get<WRATHDefaultTextAttributePacker::position_location>();
     }
 
-    glyph_stretch_type&
-    glyph_stretch(void)
+    void
+    glyph_stretch(const vec2 &v)
     {
-      return get<WRATHDefaultTextAttributePacker::glyph_stretch_location>();
+      set_stretch(this->template get<WRATHDefaultTextAttributePacker::glyph_stretch_location>(), v);
     }
 
     void
@@ -79,23 +88,42 @@ namespace
       position().x()=v.x();
       position().y()=v.y();
     }
-    
+
+  private:
+    static
+    void
+    set_stretch(glyph_stretch_type &dest, const vec2 &v)
+    {
+      dest=v;
+    }
+
+    static
+    void
+    set_stretch(glyph_stretch_half_type &dest, const vec2 &v)
+    {
+      WRATHUtil::convert_to_halfp_from_float(dest, v);
+    }
   };
 
-  template<unsigned int N>
+  typedef character_attribute_t<glyph_stretch_type> character_attribute;
+  typedef character_attribute_t<glyph_stretch_half_type> character_attribute_half;
+
+
+  template<unsigned int N, typename A=character_attribute>
   class character_attribute_with_custom
   {
   public:
-    character_attribute m_base;
+    A m_base;
     GLfloat m_custom[N];
   };
   
   typedef WRATHDefaultTextAttributePacker* WRATHDefaultTextAttributePackerPtr;
   WRATHDefaultTextAttributePackerPtr&
-  the_ptr(int e)
+  the_ptr(enum WRATHGenericTextAttributePacker::PackerType subpacker,
+          enum WRATHAttributePacker::attribute_format_type fmt)
   {
-    static vecN<WRATHDefaultTextAttributePackerPtr,2> R(NULL, NULL);
-    return R[e];
+    static vecN<WRATHDefaultTextAttributePackerPtr,4> R(NULL, NULL, NULL, NULL);
+    return R[subpacker + 2*fmt];
   }
 
   typedef const char *attribute_label_type;
@@ -115,15 +143,20 @@ namespace
     return R;
   }
 
-  const char*
-  packer_label(enum WRATHGenericTextAttributePacker::PackerType subpacker)
+  std::string
+  packer_label(enum WRATHGenericTextAttributePacker::PackerType subpacker,
+               enum WRATHAttributePacker::attribute_format_type fmt)
   {
-    return subpacker==WRATHGenericTextAttributePacker::SubPrimitivePacker?
-      "WRATHDefaultTextAttributePacker-SubPrimitives":
-      "WRATHDefaultTextAttributePacker-FullQuad";
+    std::string R(subpacker==WRATHGenericTextAttributePacker::SubPrimitivePacker?
+                  "WRATHDefaultTextAttributePacker-SubPrimitives":
+                  "WRATHDefaultTextAttributePacker-FullQuad");
+    if(fmt==WRATHAttributePacker::half_precision_format)
+      {
+        R+="-half";
+      }
+    return R;
   }
 
-                               
   color_type
   interpolate_color(const vecN<WRATHText::color_type, 4> &input_color,
                     vec2 glyph_coord)
@@ -156,46 +189,115 @@ namespace
 
     return R;
   }
+
+  template<typename A>
+  size_t
+  attribute_size_implement(int n)
+  {
+    return (n==0)?
+      sizeof(A):
+      sizeof(character_attribute_with_custom<1, A>) + sizeof(float)*(n-1);
+  }
+
+  template<typename A>
+  void
+  pack_attribute_implement(enum WRATHFormattedTextStream::corner_type ct,
+                           const WRATHGenericTextAttributePacker::glyph_data &in_glyph,
+                           const vec2 &normalized_glyph_coordinate_float,
+                           vecN<GLshort,2> normalized_glyph_coordinate_short,
+                           const std::vector<int> &custom_data_use,
+                           c_array<uint8_t> packing_destination)
+  {
+    c_array<A> attr;
+
+    attr=packing_destination
+      .sub_array(0, sizeof(A))
+      .template reinterpret_pointer<A>();
+  
+    ivec2 native_bl(in_glyph.m_glyph->texel_lower_left());
+    ivec2 native_sz(in_glyph.m_glyph->texel_size());
+
+    attr[0].position()=position_type(in_glyph.m_native_position[0].x(), 
+                                     in_glyph.m_native_position[0].y(), 
+                                     in_glyph.m_z_position, 
+                                     in_glyph.m_scale);
+    attr[0].glyph_stretch(vec2(in_glyph.m_horizontal_stretching,
+                               in_glyph.m_vertical_stretching));
+    attr[0].glyph_size_and_bottom_left()
+      =glyph_size_and_bottom_left_type(native_sz.x(), native_sz.y(),
+                                       native_bl.x(), native_bl.y());  
+
+    attr[0].glyph_normalized_coordinate()=normalized_glyph_coordinate_short;
+  
+    if(ct==WRATHFormattedTextStream::not_corner)
+      {
+        attr[0].color()=interpolate_color(in_glyph.m_color,
+                                          normalized_glyph_coordinate_float);
+      }
+    else
+      {
+        attr[0].color()=in_glyph.m_color[ct];
+      }
+
+    if(!custom_data_use.empty())
+      {
+        c_array<character_attribute_with_custom<1, A> > attr_with;
+        attr_with=packing_destination
+          .sub_array(0, sizeof(character_attribute_with_custom<1, A>))
+          .template reinterpret_pointer<character_attribute_with_custom<1, A> >();
+
+        WRATHassert(&attr_with[0].m_base==&attr[0]);
+
+        for(int i=0, endi=custom_data_use.size(); i<endi; ++i)
+          {
+            attr_with[0].m_custom[i]=in_glyph.m_glyph->fetch_custom_float(custom_data_use[i]);
+          }
+      }
+  }
 }
 
 WRATHDefaultTextAttributePacker::
-WRATHDefaultTextAttributePacker(enum PackerType subpacker):
-  WRATHGenericTextAttributePacker(packer_label(subpacker),
-                                  subpacker)
+WRATHDefaultTextAttributePacker(enum PackerType subpacker,
+                                enum WRATHAttributePacker::attribute_format_type fmt):
+  WRATHGenericTextAttributePacker(packer_label(subpacker, fmt),
+                                  subpacker),
+  m_format(fmt)
 {
-  WRATHassert(the_ptr(subpacker)==NULL);
-  the_ptr(subpacker)=this;
+  WRATHassert(the_ptr(subpacker, fmt)==NULL);
+  the_ptr(subpacker, fmt)=this;
 }
 
 WRATHDefaultTextAttributePacker::
 ~WRATHDefaultTextAttributePacker()
 {
-  WRATHassert(the_ptr(type())==this);
-  the_ptr(type())=NULL;
+  WRATHassert(the_ptr(type(), m_format)==this);
+  the_ptr(type(), m_format)=NULL;
 }
 
 WRATHDefaultTextAttributePacker*
 WRATHDefaultTextAttributePacker::
-fetch(enum PackerType e)
+fetch(enum PackerType e, enum WRATHAttributePacker::attribute_format_type fmt)
 {
-  if(the_ptr(e)==NULL)
+  if(the_ptr(e, fmt)==NULL)
     {
-      WRATHNew WRATHDefaultTextAttributePacker(e);
+      WRATHNew WRATHDefaultTextAttributePacker(e, fmt);
     }
-  WRATHassert(the_ptr(e)!=NULL);
-  return the_ptr(e);
+  WRATHassert(the_ptr(e, fmt)!=NULL);
+  return the_ptr(e, fmt);
 }
 
 size_t
 WRATHDefaultTextAttributePacker::
 attribute_size(int n) const
 {
-  return (n==0)?
-    sizeof(character_attribute):
-    sizeof(character_attribute_with_custom<1>) + sizeof(float)*(n-1);
+  return (m_format==WRATHAttributePacker::half_precision_format)?
+    attribute_size_implement<character_attribute_half>(n):
+    attribute_size_implement<character_attribute>(n);
 }
 
-#define CHECK_SIZE(i) WRATHassert((i)==0 or sizeof(character_attribute_with_custom<(i)>)==attribute_size((i)))
+#define CHECK_SIZE(i) WRATHassert((i)==0 or attribute_size((i))==(m_format==WRATHAttributePacker::half_precision_format? \
+                                                                   sizeof(character_attribute_with_custom<(i), character_attribute_half>): \
+                                                                   sizeof(character_attribute_with_custom<(i)>)))
 #define CHECK_SIZE_GRP(n) \
   CHECK_SIZE(4*n); \
   CHECK_SIZE(4*n+1); \
@@ -214,25 +316,11 @@ attribute_names(std::vector<std::string> &out_names, int number_custom_data) con
   CHECK_SIZE(5);
   CHECK_SIZE(6);
 
-  unsigned int N, R;
-
-  N=number_custom_data/4;
-  R=number_custom_data%4;
-  if(R>0) 
-    {
-      ++N;
-    }
-  
-  out_names.resize(packer_attribute_names().size()+N);
+  out_names.resize(packer_attribute_names().size());
   std::copy(packer_attribute_names().begin(),
             packer_attribute_names().end(),
             out_names.begin());
-  for(unsigned int i=0, k=packer_attribute_names().size(); i<N; ++i, ++k)
-    {
-      std::ostringstream ostr;
-      ostr << "custom_data" << i;
-      out_names[k]=ostr.str();
-    }
+  append_custom_data_attribute_names(out_names, number_custom_data);
 }
 
 
@@ -241,58 +329,7 @@ WRATHDefaultTextAttributePacker::
 generate_custom_data_glsl(WRATHGLShader::shader_source &out_src,
                           int number_custom_data_to_use) const
 {
-  int N, R, idx;
-  const char *swizzle[]={".x", ".y", ".z", ".w" };
-  std::ostringstream ostr;
-
-  N=number_custom_data_to_use/4;
-  R=number_custom_data_to_use%4;
-  for(int i=0; i<N; ++i)
-    {
-      ostr << "\nshader_in highp vec4 custom_data" << i << ";";
-    }
-  
-  if(R==1)
-    {
-      ostr << "\nshader_in highp float custom_data" << N << ";";
-    }
-  else if(R>1)
-    {
-      ostr << "\nshader_in highp vec" << R << " custom_data" << N << ";";
-    }
-  
-  /*
-    create the function that returns the data as an array
-  */
-  ostr << "\nvoid wrath_font_shader_custom_data_func(out wrath_font_custom_data_t v)"
-       << "\n{";
-  
-  idx=0;
-  for(int i=0; i<N; ++i)
-    {
-      for(int j=0; j<4; ++j, ++idx)
-        {
-          ostr << "\n\tv.values[" << idx << "]=" 
-               << "custom_data" << i << swizzle[j] << ";";
-        }
-    }
-
-  if(R==1)
-    {
-      ostr << "\n\tv.values[" << idx 
-           << "]=custom_data" << N << ";";
-    }
-  else
-    {
-      for(int j=0; j<R; ++j, ++idx)
-        {
-          ostr << "\n\tv.values[" << idx << "]=" 
-               << "custom_data" << N << swizzle[j] << ";";
-        }
-    }
-  ostr << "\n}\n";
-
-  out_src.add_source(ostr.str(), WRATHGLShader::from_string);
+  generate_custom_data_attribute_glsl(out_src, number_custom_data_to_use);
 }
   
 void
@@ -300,79 +337,49 @@ WRATHDefaultTextAttributePacker::
 attribute_key(WRATHAttributeStoreKey &pkey,
               int number_custom_floats) const
 {
-  pkey
-    .type_and_format(type_tag<character_attribute>());
+  ptrdiff_t offset;
 
-  pkey.m_attribute_format_location[color_location].m_normalized=GL_TRUE;
-  pkey.m_attribute_format_location[glyph_normalized_coordinate_location].m_normalized=GL_TRUE;
+  if(m_format==WRATHAttributePacker::half_precision_format)
+    {
+      const char *p1, *p2;
+      character_attribute_with_custom<1, character_attribute_half> conveniance;
 
-   if(number_custom_floats!=0)
+      pkey
+        .type_and_format(type_tag<character_attribute_half>())
+        .half_float_format(glyph_stretch_location);
+
+      p1=reinterpret_cast<const char*>(boost::addressof(conveniance));
+      p2=reinterpret_cast<const char*>(boost::addressof(conveniance.m_custom[0]));
+      offset=p2-p1;
+    }
+  else
     {
-      ptrdiff_t offset;
       const char *p1, *p2;
       character_attribute_with_custom<1> conveniance;
-      int attr_slot, num_remaining;
 
-      /*
-        we are going to potentially unsafely assume that
-        sizeof(character_attribute_with_custom<N+1>) is
-        same as sizeof(character_attribute_with_custom<N>) + 4
-        for N>=1
-       */
-      pkey.m_type_size = sizeof(character_attribute_with_custom<1>)
-        + sizeof(float)*(number_custom_floats-1);
+      pkey
+        .type_and_format(type_tag<character_attribute>());
 
       p1=reinterpret_cast<const char*>(boost::addressof(conveniance));
       p2=reinterpret_cast<const char*>(boost::addressof(conveniance.m_custom[0]));
       offset=p2-p1;
-      num_remaining=number_custom_floats;
+    }
 
-      attr_slot=character_attribute::number_attributes;
-      /*
-        every 4 custom values adds a new vec4 attribute
-       */      
-      for(;num_remaining>=4 and attr_slot<WRATHDrawCallSpec::attribute_count;
-          num_remaining-=4, ++attr_slot, offset+=4*sizeof(float))
-        {
-          pkey.m_attribute_format_location[attr_slot].m_offset=offset;
-          pkey.m_attribute_format_location[attr_slot].traits( type_tag<vec4>() );
-        }
+  pkey.m_attribute_format_location[color_location].m_normalized=GL_TRUE;
+  pkey.m_attribute_format_location[glyph_normalized_coordinate_location].m_normalized=GL_TRUE;
+
+   if(number_custom_floats!=0)
+    {
       /*
-        remaining values use a float, vec2, or vec3
+        we are going to potentially unsafely assume that
+        sizeof(character_attribute_with_custom<N+1>) is
+        same as sizeof(character_attribute_with_custom<N>) + 4
+        for N>=1
        */
-      if(attr_slot<WRATHDrawCallSpec::attribute_count)
-        {
-          WRATHassert(num_remaining<4);
-          switch(num_remaining)
-            {
-            case 0:
-              break;
-
-            case 1:
-              pkey.m_attribute_format_location[attr_slot].m_offset=offset;
-              pkey.m_attribute_format_location[attr_slot].traits( type_tag<float>() );
-              ++attr_slot;
-              break;
-
-            case 2:
-              pkey.m_attribute_format_location[attr_slot].m_offset=offset;
-              pkey.m_attribute_format_location[attr_slot].traits( type_tag<vec2>() );
-              ++attr_slot;
-              break;
-
-            case 3:
-              pkey.m_attribute_format_location[attr_slot].m_offset=offset;
-              pkey.m_attribute_format_location[attr_slot].traits( type_tag<vec3>() );
-              ++attr_slot;
-              break;
-            }
-        }
-
-      //now adjust the stride:
-      for(int i=0; i<attr_slot; ++i)
-        {
-          pkey.m_attribute_format_location[i].m_stride = pkey.m_type_size;          
-        }
+      pkey.m_type_size=attribute_size(number_custom_floats);
+
+      set_custom_data_attribute_key(pkey, character_attribute::number_attributes,
+                                    offset, number_custom_floats);
     }
 }
 
@@ -390,59 +397,20 @@ pack_attribute(enum WRATHFormattedTextStream::corner_type ct,
                c_array<uint8_t> packing_destination,
                const PackerState&) const
 {
-  c_array<character_attribute> attr;
-
-  attr=packing_destination
-    .sub_array(0, sizeof(character_attribute))
-    .reinterpret_pointer<character_attribute>();
-  
-  ivec2 native_bl(in_glyph.m_glyph->texel_lower_left());
-  ivec2 native_sz(in_glyph.m_glyph->texel_size());
-
-  attr[0].position()=position_type(in_glyph.m_native_position[0].x(), 
-                                   in_glyph.m_native_position[0].y(), 
-                                   in_glyph.m_z_position, 
-                                   in_glyph.m_scale);
-  attr[0].glyph_stretch()=glyph_stretch_type(in_glyph.m_horizontal_stretching,
-                                             in_glyph.m_vertical_stretching);
-  attr[0].glyph_size_and_bottom_left()
-    =glyph_size_and_bottom_left_type(native_sz.x(), native_sz.y(),
-                                     native_bl.x(), native_bl.y());  
-
-  attr[0].glyph_normalized_coordinate()=normalized_glyph_coordinate_short;
-  
-  if(ct==WRATHFormattedTextStream::not_corner)
+  if(m_format==WRATHAttributePacker::half_precision_format)
     {
-      attr[0].color()=interpolate_color(in_glyph.m_color,
-                                               normalized_glyph_coordinate_float);
+      pack_attribute_implement<character_attribute_half>(ct, in_glyph, 
+                                                         normalized_glyph_coordinate_float,
+                                                         normalized_glyph_coordinate_short,
+                                                         custom_data_use,
+                                                         packing_destination);
     }
   else
     {
-      attr[0].color()=in_glyph.m_color[ct];
-    }
-
-  if(!custom_data_use.empty())
-    {
-      c_array<character_attribute_with_custom<1> > attr_with;
-      attr_with=packing_destination
-        .sub_array(0, sizeof(character_attribute_with_custom<1>))
-        .reinterpret_pointer<character_attribute_with_custom<1> >();
-
-      WRATHassert(&attr_with[0].m_base==&attr[0]);
-
-      for(int i=0, endi=custom_data_use.size(); i<endi; ++i)
-        {
-          attr_with[0].m_custom[i]=in_glyph.m_glyph->fetch_custom_float(custom_data_use[i]);
-        }
+      pack_attribute_implement<character_attribute>(ct, in_glyph, 
+                                                    normalized_glyph_coordinate_float,
+                                                    normalized_glyph_coordinate_short,
+                                                    custom_data_use,
+                                                    packing_destination);
     }
 }
-
-
-
-
-
-
-
-
-
-  
@@ -19,9 +19,17 @@
 
 
 #include "WRATHConfig.hpp"
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <unistd.h>
 #include "WRATHFontConfig.hpp"
 #include "ostream_utility.hpp"
 #include "WRATHStaticInit.hpp"
+#include "WRATHMutex.hpp"
 
 namespace
 {
@@ -39,15 +47,86 @@ namespace
     bool m_exists;
   };
 
-  class FontEntry
+  /*
+    An IndexEntry is a face of a font file
+    as stored in the font index.
+   */
+  class IndexEntry
   {
   public:
-    FontEntry(void):
+    IndexEntry(void):
+      m_modified(0),
+      m_size(0),
       m_face_index(0)
     {}
 
     std::string m_filename;
+    long m_modified;
+    long m_size;
     int m_face_index;
+    WRATHFontConfig::InFontSpecification m_spec;
+  };
+
+  /*
+    The faces of a font directory, the list
+    of files of a directory is valid as long 
+    as the modification time of the directory 
+    is unchanged. Overwriting a file does not
+    change the modification time of its
+    directory, hence the modification time
+    and size of each file is also stored.
+   */
+  class IndexDirectory
+  {
+  public:
+    IndexDirectory(void):
+      m_modified(0)
+    {}
+
+    long m_modified;
+    std::vector<IndexEntry> m_entries;
+  };
+
+  /*
+    keyed by directory name.
+   */
+  typedef std::map<std::string, IndexDirectory> FontIndex;
+
+  /*
+    If m_files_only is true, the directory 
+    is unchanged and only the files of
+    m_previous are checked, otherwise the
+    directory is listed. m_changed is set
+    by the scan to indicate if the output
+    differs from m_previous.
+   */
+  class ScanJob
+  {
+  public:
+    ScanJob(void):
+      m_previous(NULL),
+      m_output(NULL),
+      m_files_only(false),
+      m_changed(true)
+    {}
+
+    std::string m_directory;
+    const IndexDirectory *m_previous;
+    IndexDirectory *m_output;
+    bool m_files_only;
+    bool m_changed;
+  };
+
+  class ScanJobList:boost::noncopyable
+  {
+  public:
+    ScanJobList(void):
+      m_next(0)
+    {}
+
+    WRATHMutex m_mutex;
+    std::vector<ScanJob> m_jobs;
+    unsigned int m_next;
   };
 
   void
@@ -211,6 +290,637 @@ namespace
     ostr << "\n[FontConfig]\n";
   }
 
+  const char*
+  index_file_version(void)
+  {
+    return "WRATHFontIndex 2";
+  }
+
+  std::string&
+  index_filename(void)
+  {
+    WRATHStaticInit();
+    static std::string R;
+    static bool initialized(false);
+
+    if(!initialized)
+      {
+        const char *env;
+
+        initialized=true;
+        env=std::getenv("WRATH_FONT_INDEX");
+        if(env!=NULL)
+          {
+            R=env;
+          }
+        else
+          {
+            env=std::getenv("HOME");
+            if(env!=NULL)
+              {
+                R=std::string(env) + "/.wrath_font_index";
+              }
+          }
+      }
+    return R;
+  }
+
+  void
+  get_languages(FcLangSet *lang, std::set<std::string> &out_languages)
+  {
+    #if (FC_MAJOR>=2 && FC_MINOR>=7) || (FC_MAJOR>=3)   
+    {        
+      FcStrSet *langs_as_strs;
+      FcStrList *iter;
+      FcChar8 *current;
+            
+      langs_as_strs=FcLangSetGetLangs(lang);
+      iter=FcStrListCreate(langs_as_strs);
+      
+      for(current=FcStrListNext(iter); current; current=FcStrListNext(iter))
+        {
+          const char *str(reinterpret_cast<const char*>(current));
+          out_languages.insert(std::string(str));
+        }
+      FcStrListDone(iter);
+      FcStrSetDestroy(langs_as_strs);
+    }
+    #else
+    {
+      WRATHunused(lang);
+      WRATHunused(out_languages);
+    }
+    #endif
+  }
+
+  /*
+    returns false if the pattern is not
+    of a scalable outline font.
+   */
+  bool
+  make_index_entry(FcPattern *p, IndexEntry &out_entry)
+  {
+    FcMagicValue<FcChar8*> family_name, file_name, foundary_name, font_style;
+    FcMagicValue<int> font_index, font_weight, font_slant;
+    FcMagicValue<bool> outline, scalable;
+    FcMagicValue<FcLangSet*> lang;
+
+    FcGetMagicValue(p, FC_OUTLINE, outline);
+    FcGetMagicValue(p, FC_SCALABLE, scalable);
+    FcGetMagicValue(p, FC_FILE, file_name);
+    if(!outline.m_exists or !outline.m_value
+       or !scalable.m_exists or !scalable.m_value
+       or !file_name.m_exists)
+      {
+        return false;
+      }
+
+    GetPairFromFcMagicValue(out_entry.m_filename, file_name);
+      
+    FcGetMagicValue(p, FC_INDEX, font_index);
+    GetPairFromFcMagicValue(out_entry.m_face_index, font_index);
+      
+    FcGetMagicValue(p, FC_FAMILY, family_name);
+    GetPairFromFcMagicValue(out_entry.m_spec.m_family_name, family_name);
+      
+    FcGetMagicValue(p, FC_FOUNDRY, foundary_name);
+    GetPairFromFcMagicValue(out_entry.m_spec.m_foundary_name, foundary_name);
+      
+    FcGetMagicValue(p, FC_WEIGHT, font_weight);
+    GetPairFromFcMagicValue(out_entry.m_spec.m_weight, font_weight);
+      
+    FcGetMagicValue(p, FC_SLANT, font_slant);
+    GetPairFromFcMagicValue(out_entry.m_spec.m_slant, font_slant);
+      
+    FcGetMagicValue(p, FC_STYLE, font_style);
+    GetPairFromFcMagicValue(out_entry.m_spec.m_style, font_style);
+
+    FcGetMagicValue(p, FC_LANG, lang);
+    if(lang.m_exists)
+      {
+        get_languages(lang.m_value, out_entry.m_spec.m_languages);
+      }
+    return true;
+  }
+
+  FcPattern*
+  create_pattern(const IndexEntry &entry)
+  {
+    FcPattern *p;
+
+    p=FcPatternCreate();
+    FcPatternAddString(p, FC_FILE, 
+                       reinterpret_cast<const FcChar8*>(entry.m_filename.c_str()));
+    FcPatternAddInteger(p, FC_INDEX, entry.m_face_index);
+    FcPatternAddBool(p, FC_OUTLINE, FcTrue);
+    FcPatternAddBool(p, FC_SCALABLE, FcTrue);
+    FcPatternHelper(p, entry.m_spec.m_family_name, FC_FAMILY);
+    FcPatternHelper(p, entry.m_spec.m_foundary_name, FC_FOUNDRY);
+    FcPatternHelper(p, entry.m_spec.m_style, FC_STYLE);
+    FcPatternHelper(p, entry.m_spec.m_weight, FC_WEIGHT);
+    FcPatternHelper(p, entry.m_spec.m_slant, FC_SLANT);
+
+    if(!entry.m_spec.m_languages.empty())
+      {
+        FcLangSet *fc_langs;
+
+        fc_langs=FcLangSetCreate();
+        for(std::set<std::string>::const_iterator iter=entry.m_spec.m_languages.begin(),
+              end=entry.m_spec.m_languages.end(); iter!=end; ++iter)
+          {
+            FcLangSetAdd(fc_langs,
+                         reinterpret_cast<const FcChar8*>(iter->c_str()));
+          }
+        FcPatternAddLangSet(p, FC_LANG, fc_langs);
+        FcLangSetDestroy(fc_langs);
+      }
+    return p;
+  }
+
+  /*
+    list all directories (including sub-directories)
+    of the font directories of a Fontconfig configuration
+    together with their modification times.
+   */
+  void
+  list_font_directories(FcConfig *config, std::map<std::string, long> &out_dirs)
+  {
+    FcStrList *fc_dirs;
+    FcChar8 *current;
+    std::vector<std::string> to_visit;
+    std::set<std::pair<dev_t, ino_t> > visited;
+
+    fc_dirs=FcConfigGetFontDirs(config);
+    if(fc_dirs==NULL)
+      {
+        return;
+      }
+
+    for(current=FcStrListNext(fc_dirs); current; current=FcStrListNext(fc_dirs))
+      {
+        to_visit.push_back(reinterpret_cast<const char*>(current));
+      }
+    FcStrListDone(fc_dirs);
+
+    while(!to_visit.empty())
+      {
+        std::string dir_name;
+        struct stat dir_stat;
+        DIR *dir;
+
+        dir_name=to_visit.back();
+        to_visit.pop_back();
+
+        if(0!=stat(dir_name.c_str(), &dir_stat)
+           or !S_ISDIR(dir_stat.st_mode)
+           or !visited.insert(std::make_pair(dir_stat.st_dev, dir_stat.st_ino)).second)
+          {
+            continue;
+          }
+        out_dirs[dir_name]=dir_stat.st_mtime;
+
+        dir=opendir(dir_name.c_str());
+        if(dir==NULL)
+          {
+            continue;
+          }
+
+        for(struct dirent *entry=readdir(dir); entry!=NULL; entry=readdir(dir))
+          {
+            std::string name;
+            struct stat entry_stat;
+
+            if(entry->d_name[0]=='.')
+              {
+                continue;
+              }
+
+            name=dir_name + "/" + entry->d_name;
+            if(0==stat(name.c_str(), &entry_stat) and S_ISDIR(entry_stat.st_mode))
+              {
+                to_visit.push_back(name);
+              }
+          }
+        closedir(dir);
+      }
+  }
+
+  /*
+    add the faces of the font file name to output,
+    reusing the entries of previous if the file
+    has the same modification time and size.
+    Returns true if previous was reused.
+   */
+  bool
+  scan_file(const std::string &name, const struct stat &file_stat,
+            const std::vector<const IndexEntry*> *previous,
+            IndexDirectory &output)
+  {
+    int number_faces(0);
+
+    if(previous!=NULL and !previous->empty()
+       and previous->front()->m_modified==static_cast<long>(file_stat.st_mtime)
+       and previous->front()->m_size==static_cast<long>(file_stat.st_size))
+      {
+        for(std::vector<const IndexEntry*>::const_iterator 
+              iter=previous->begin(), end=previous->end();
+            iter!=end; ++iter)
+          {
+            output.m_entries.push_back(**iter);
+          }
+        return true;
+      }
+
+    for(int face=0; face==0 or face<number_faces; ++face)
+      {
+        FcPattern *p;
+        IndexEntry index_entry;
+
+        p=FcFreeTypeQuery(reinterpret_cast<const FcChar8*>(name.c_str()),
+                          face, NULL, &number_faces);
+        if(p==NULL)
+          {
+            break;
+          }
+
+        if(make_index_entry(p, index_entry))
+          {
+            index_entry.m_filename=name;
+            index_entry.m_face_index=face;
+            index_entry.m_modified=file_stat.st_mtime;
+            index_entry.m_size=file_stat.st_size;
+            output.m_entries.push_back(index_entry);
+          }
+        FcPatternDestroy(p);
+      }
+    return false;
+  }
+
+  /*
+    scan the font files of a directory, files whose 
+    modification time and size are the same as in 
+    previous are not opened. If files_only is true,
+    the directory is not listed, only the files
+    of previous are examined. Returns true if the 
+    output differs from previous.
+   */
+  bool
+  scan_directory(const std::string &dir_name, 
+                 const IndexDirectory *previous,
+                 bool files_only,
+                 IndexDirectory &output)
+  {
+    typedef std::map<std::string, std::vector<const IndexEntry*> > previous_map;
+    previous_map previous_entries;
+    bool changed(false);
+
+    if(previous!=NULL)
+      {
+        for(std::vector<IndexEntry>::const_iterator iter=previous->m_entries.begin(),
+              end=previous->m_entries.end(); iter!=end; ++iter)
+          {
+            previous_entries[iter->m_filename].push_back(&*iter);
+          }
+      }
+
+    if(files_only)
+      {
+        for(previous_map::const_iterator iter=previous_entries.begin(),
+              end=previous_entries.end(); iter!=end; ++iter)
+          {
+            struct stat file_stat;
+
+            if(0!=stat(iter->first.c_str(), &file_stat) or !S_ISREG(file_stat.st_mode))
+              {
+                changed=true;
+                continue;
+              }
+
+            if(!scan_file(iter->first, file_stat, &iter->second, output))
+              {
+                changed=true;
+              }
+          }
+        return changed;
+      }
+
+    DIR *dir;
+
+    dir=opendir(dir_name.c_str());
+    if(dir==NULL)
+      {
+        return true;
+      }
+
+    for(struct dirent *entry=readdir(dir); entry!=NULL; entry=readdir(dir))
+      {
+        std::string name;
+        struct stat file_stat;
+        previous_map::const_iterator prev;
+        
+        if(entry->d_name[0]=='.')
+          {
+            continue;
+          }
+
+        name=dir_name + "/" + entry->d_name;
+        if(0!=stat(name.c_str(), &file_stat) or !S_ISREG(file_stat.st_mode))
+          {
+            continue;
+          }
+
+        prev=previous_entries.find(name);
+        scan_file(name, file_stat,
+                  (prev!=previous_entries.end())?&prev->second:NULL,
+                  output);
+      }
+    closedir(dir);
+    return true;
+  }
+
+  void*
+  scan_thread(void *ptr)
+  {
+    ScanJobList *jobs(static_cast<ScanJobList*>(ptr));
+    
+    for(;;)
+      {
+        unsigned int J;
+
+        WRATHLockMutex(jobs->m_mutex);
+        J=jobs->m_next;
+        ++jobs->m_next;
+        WRATHUnlockMutex(jobs->m_mutex);
+
+        if(J>=jobs->m_jobs.size())
+          {
+            return NULL;
+          }
+
+        jobs->m_jobs[J].m_changed=scan_directory(jobs->m_jobs[J].m_directory,
+                                                 jobs->m_jobs[J].m_previous,
+                                                 jobs->m_jobs[J].m_files_only,
+                                                 *jobs->m_jobs[J].m_output);
+      }
+  }
+
+  void
+  run_scan_jobs(ScanJobList &jobs)
+  {
+    long number_cpus;
+    unsigned int number_threads;
+    std::vector<WRATHThreadID> threads;
+
+    if(jobs.m_jobs.empty())
+      {
+        return;
+      }
+
+    number_cpus=sysconf(_SC_NPROCESSORS_ONLN);
+    number_threads=std::max(1L, std::min(8L, number_cpus));
+    number_threads=std::min(number_threads, 
+                            static_cast<unsigned int>(jobs.m_jobs.size()));
+
+    /*
+      the calling thread also scans.
+     */
+    for(unsigned int i=1; i<number_threads; ++i)
+      {
+        threads.push_back(WRATHThreadID::create_thread(scan_thread, &jobs));
+      }
+    scan_thread(&jobs);
+
+    for(unsigned int i=0, endi=threads.size(); i<endi; ++i)
+      {
+        WRATHThreadID::wait_thread(threads[i]);
+      }
+  }
+
+  /*
+    Index file format, one record per line with 
+    fields separated by tabs:
+      D mtime directory
+      F mtime size face_index weight slant family foundry style languages filename
+    F records belong to the last D record. String fields
+    are prefixed with '+' if present and are '-' if absent,
+    integer fields are '-' if absent, the languages are
+    comma separated.
+   */
+  std::string
+  index_field(const std::pair<bool, std::string> &v)
+  {
+    std::string R;
+
+    if(!v.first)
+      {
+        return "-";
+      }
+
+    R="+" + v.second;
+    for(std::string::iterator iter=R.begin(), end=R.end(); iter!=end; ++iter)
+      {
+        if(*iter=='\t' or *iter=='\n')
+          {
+            *iter=' ';
+          }
+      }
+    return R;
+  }
+
+  std::string
+  index_field(const std::pair<bool, int> &v)
+  {
+    std::ostringstream ostr;
+
+    if(!v.first)
+      {
+        return "-";
+      }
+    ostr << v.second;
+    return ostr.str();
+  }
+
+  void
+  read_index_field(const std::string &field, std::pair<bool, std::string> &v)
+  {
+    v.first=(!field.empty() and field[0]=='+');
+    v.second=(v.first)?
+      field.substr(1):
+      std::string();
+  }
+
+  void
+  read_index_field(const std::string &field, std::pair<bool, int> &v)
+  {
+    std::istringstream istr(field);
+
+    v.second=0;
+    v.first=(field!="-") and !(istr >> v.second).fail();
+  }
+
+  void
+  split_index_line(const std::string &line, std::vector<std::string> &fields)
+  {
+    std::string::size_type start(0), pos;
+
+    fields.clear();
+    while( (pos=line.find('\t', start))!=std::string::npos)
+      {
+        fields.push_back(line.substr(start, pos-start));
+        start=pos+1;
+      }
+    fields.push_back(line.substr(start));
+  }
+
+  void
+  load_index(const std::string &filename, FontIndex &out_index)
+  {
+    std::ifstream file(filename.c_str());
+    std::string line;
+    std::vector<std::string> fields;
+    IndexDirectory *current(NULL);
+
+    if(!file or !std::getline(file, line) or line!=index_file_version())
+      {
+        return;
+      }
+
+    while(std::getline(file, line))
+      {
+        split_index_line(line, fields);
+        if(fields.size()==3 and fields[0]=="D")
+          {
+            current=&out_index[fields[2]];
+            current->m_modified=std::atol(fields[1].c_str());
+          }
+        else if(fields.size()==11 and fields[0]=="F" and current!=NULL)
+          {
+            IndexEntry entry;
+            std::string::size_type start(0), pos;
+
+            entry.m_modified=std::atol(fields[1].c_str());
+            entry.m_size=std::atol(fields[2].c_str());
+            entry.m_face_index=std::atoi(fields[3].c_str());
+            read_index_field(fields[4], entry.m_spec.m_weight);
+            read_index_field(fields[5], entry.m_spec.m_slant);
+            read_index_field(fields[6], entry.m_spec.m_family_name);
+            read_index_field(fields[7], entry.m_spec.m_foundary_name);
+            read_index_field(fields[8], entry.m_spec.m_style);
+            
+            while(start<fields[9].size())
+              {
+                pos=fields[9].find(',', start);
+                if(pos==std::string::npos)
+                  {
+                    pos=fields[9].size();
+                  }
+                if(pos>start)
+                  {
+                    entry.m_spec.m_languages.insert(fields[9].substr(start, pos-start));
+                  }
+                start=pos+1;
+              }
+            entry.m_filename=fields[10];
+            current->m_entries.push_back(entry);
+          }
+        else
+          {
+            /*
+              corrupt index, rescan everything.
+             */
+            out_index.clear();
+            return;
+          }
+      }
+  }
+
+  void
+  save_index(const std::string &filename, const FontIndex &index)
+  {
+    std::string temp_filename;
+
+    /*
+      write to a temporary file first so that
+      a concurrently starting process does not
+      read a partially written index.
+     */
+    {
+      std::ostringstream ostr;
+      ostr << filename << "." << getpid();
+      temp_filename=ostr.str();
+    }
+
+    std::ofstream file(temp_filename.c_str());
+    if(!file)
+      {
+        return;
+      }
+
+    file << index_file_version() << "\n";
+    for(FontIndex::const_iterator diter=index.begin(), dend=index.end();
+        diter!=dend; ++diter)
+      {
+        long modified(diter->second.m_modified);
+
+        /*
+          a directory whose name or font file names
+          cannot be stored is marked to be always
+          rescanned.
+         */
+        if(diter->first.find_first_of("\t\n")!=std::string::npos)
+          {
+            continue;
+          }
+
+        for(std::vector<IndexEntry>::const_iterator iter=diter->second.m_entries.begin(),
+              end=diter->second.m_entries.end(); iter!=end; ++iter)
+          {
+            if(iter->m_filename.find_first_of("\t\n")!=std::string::npos)
+              {
+                modified=-1;
+              }
+          }
+
+        file << "D\t" << modified << "\t" << diter->first << "\n";
+        for(std::vector<IndexEntry>::const_iterator iter=diter->second.m_entries.begin(),
+              end=diter->second.m_entries.end(); iter!=end; ++iter)
+          {
+            if(iter->m_filename.find_first_of("\t\n")!=std::string::npos)
+              {
+                continue;
+              }
+
+            file << "F\t" << iter->m_modified 
+                 << "\t" << iter->m_size
+                 << "\t" << iter->m_face_index
+                 << "\t" << index_field(iter->m_spec.m_weight)
+                 << "\t" << index_field(iter->m_spec.m_slant)
+                 << "\t" << index_field(iter->m_spec.m_family_name)
+                 << "\t" << index_field(iter->m_spec.m_foundary_name)
+                 << "\t" << index_field(iter->m_spec.m_style)
+                 << "\t";
+
+            for(std::set<std::string>::const_iterator 
+                  liter=iter->m_spec.m_languages.begin(), 
+                  lend=iter->m_spec.m_languages.end(); liter!=lend; ++liter)
+              {
+                if(liter!=iter->m_spec.m_languages.begin())
+                  {
+                    file << ",";
+                  }
+                file << *liter;
+              }
+            file << "\t" << iter->m_filename << "\n";
+          }
+      }
+    file.close();
+
+    if(!file or 0!=std::rename(temp_filename.c_str(), filename.c_str()))
+      {
+        std::remove(temp_filename.c_str());
+      }
+  }
+
   class font_config_magic_class
   {
   public:
@@ -230,9 +940,10 @@ namespace
 
   private:
     void
-    add_entry(FcPattern *p);
+    add_entry(const IndexEntry &index_entry);
 
     WRATHMutex m_fc_mutex;
+    FcConfig *m_fc_config;
     FcFontSet *m_fc_font_list;
     FontList m_font_list;
   };
@@ -251,53 +962,91 @@ namespace
 /////////////////////////////////
 // font_config_magic_class methods
 font_config_magic_class::
-font_config_magic_class(void)
+font_config_magic_class(void):
+  m_fc_config(FcInitLoadConfig()),
+  m_fc_font_list(FcFontSetCreate())
 {
-  FcPattern *fc_pattern; 
-  FcObjectSet *fc_object_set; 
-  
+  std::map<std::string, long> dirs;
+  FontIndex previous_index, index;
+  ScanJobList jobs;
+  std::string filename(index_filename());
+  bool index_changed(false);
 
   /*
-    require those fonts that are both scalable
-    and outline fonts.
-  */
-  fc_pattern=FcPatternCreate();
-  
-  FcPatternAddBool(fc_pattern, FC_OUTLINE, FcTrue);
-  FcPatternAddBool(fc_pattern, FC_SCALABLE, FcTrue);
-  
-  
+    we do not use FcFontList with the default
+    configuration since that requires Fontconfig
+    to load its font cache (or to open every
+    font file when the cache is out of date). 
+    Instead we load a configuration without fonts 
+    and maintain our own index of the directories
+    of the configuration.
+   */
+  if(m_fc_config!=NULL)
+    {
+      list_font_directories(m_fc_config, dirs);
+    }
+
+  if(!filename.empty())
+    {
+      load_index(filename, previous_index);
+    }
+
+  for(std::map<std::string, long>::const_iterator iter=dirs.begin(),
+        end=dirs.end(); iter!=end; ++iter)
+    {
+      FontIndex::iterator prev;
+      IndexDirectory &dir(index[iter->first]);
+      ScanJob J;
+
+      /*
+        if the directory did not change, its list
+        of files is reused but each file is still
+        checked as overwriting a font file does not
+        change the modification time of the directory.
+       */
+      prev=previous_index.find(iter->first);
+      dir.m_modified=iter->second;
+      J.m_directory=iter->first;
+      J.m_previous=(prev!=previous_index.end())?
+        &prev->second:
+        NULL;
+      J.m_files_only=(prev!=previous_index.end() and prev->second.m_modified==iter->second);
+      J.m_output=&dir;
+      jobs.m_jobs.push_back(J);
+    }
+
   /*
-    add the properties we care about to fc_object_set
-  */
-  const char *fc_properties[]=
+    scan the directories in parallel, 
+    FcFreeTypeQuery opens each font file
+    so this is the expensive part.
+   */
+  run_scan_jobs(jobs);
+  for(std::vector<ScanJob>::const_iterator iter=jobs.m_jobs.begin(),
+        end=jobs.m_jobs.end(); iter!=end; ++iter)
     {
-      FC_FAMILY, FC_WEIGHT, FC_SLANT,
-      FC_FILE, FC_INDEX, FC_FOUNDRY, 
-      FC_SCALABLE, FC_OUTLINE,
-      FC_LANG, FC_STYLE,
-      NULL
-    };
-  
-  fc_object_set=FcObjectSetCreate();
-  for(const char **iter=fc_properties; *iter!=NULL; ++iter)
+      index_changed=index_changed or iter->m_changed;
+    }
+
+  for(FontIndex::const_iterator diter=index.begin(), dend=index.end();
+      diter!=dend; ++diter)
     {
-      FcObjectSetAdd(fc_object_set, *iter);
-    } 
-  
+      for(std::vector<IndexEntry>::const_iterator iter=diter->second.m_entries.begin(),
+            end=diter->second.m_entries.end(); iter!=end; ++iter)
+        {
+          add_entry(*iter);
+        }
+    }
+
   /*
-    get a list of fonts from the default
-    font configuration which are scalable
-    outline fonts.
-  */
-  m_fc_font_list=FcFontList(NULL, fc_pattern, fc_object_set);
-  
-  for(int i=0; i<m_fc_font_list->nfont; ++i)
+    if every directory was found in the previous 
+    index unchanged and no directory was removed,
+    there is no need to write the index.
+   */
+  if(!filename.empty() 
+     and (index_changed or previous_index.size()!=index.size()))
     {
-      add_entry(m_fc_font_list->fonts[i]);
+      save_index(filename, index);
     }
-  FcPatternDestroy(fc_pattern);
-  FcObjectSetDestroy(fc_object_set);
 
   /*
   for(FontList::const_iterator iter=m_font_list.begin(),
@@ -310,64 +1059,38 @@ font_config_magic_class(void)
 
 void
 font_config_magic_class::
-add_entry(FcPattern *p)
+add_entry(const IndexEntry &index_entry)
 {
-  FcMagicValue<FcChar8*> family_name, file_name, foundary_name, font_style;
-  FcMagicValue<int> font_index, font_weight, font_slant;
-  FcMagicValue<FcLangSet*> lang;
-  
-  FcGetMagicValue(p, FC_FILE, file_name);
-  if(file_name.m_exists)
+  WRATHFontConfig::FontSpecification entry;
+  WRATHFontDatabase::FontProperties props;
+  const WRATHFontConfig::InFontSpecification &spec(index_entry.m_spec);
+
+  /*
+    the properties are taken from the index
+    so that the font file is not opened until
+    the font is used.
+   */
+  if(spec.m_family_name.first)
     {
-      FontEntry entry_key;
-      WRATHFontConfig::FontSpecification entry;
-      
-      GetPairFromFcMagicValue(entry_key.m_filename, file_name);
-      
-      FcGetMagicValue(p, FC_INDEX, font_index);
-      GetPairFromFcMagicValue(entry_key.m_face_index, font_index);
-      
-      entry.font()=WRATHFontDatabase::fetch_font_entry(entry_key.m_filename, entry_key.m_face_index);
-      
-      FcGetMagicValue(p, FC_FAMILY, family_name);
-      GetPairFromFcMagicValue(entry.m_fontconfig_details.m_family_name, family_name);
-      
-      FcGetMagicValue(p, FC_FOUNDRY, foundary_name);
-      GetPairFromFcMagicValue(entry.m_fontconfig_details.m_foundary_name, foundary_name);
-      
-      FcGetMagicValue(p, FC_WEIGHT, font_weight);
-      GetPairFromFcMagicValue(entry.m_fontconfig_details.m_weight, font_weight);
-      
-      FcGetMagicValue(p, FC_SLANT, font_slant);
-      GetPairFromFcMagicValue(entry.m_fontconfig_details.m_slant, font_slant);
-      
-      FcGetMagicValue(p, FC_STYLE, font_style);
-      GetPairFromFcMagicValue(entry.m_fontconfig_details.m_style, font_style);
-      
-      #if (FC_MAJOR>=2 && FC_MINOR>=7) || (FC_MAJOR>=3)   
-      {        
-        FcGetMagicValue(p, FC_LANG, lang);
-        if(lang.m_exists)
-          {
-            FcStrSet *langs_as_strs;
-            FcStrList *iter;
-            FcChar8 *current;
-            
-            langs_as_strs=FcLangSetGetLangs(lang.m_value); //do we need to free this thing??
-            iter=FcStrListCreate(langs_as_strs);
-            
-            for(current=FcStrListNext(iter); current; current=FcStrListNext(iter))
-              {
-                const char *str(reinterpret_cast<const char*>(current));
-                entry.m_fontconfig_details.m_languages.insert(std::string(str));
-              }
-            FcStrListDone(iter);
-            FcStrSetDestroy(langs_as_strs);
-          }
-      }
-      #endif
-              
-      WRATHassert(m_font_list.find(entry.font())==m_font_list.end());
+      props.m_family_name=spec.m_family_name.second;
+    }
+
+  if(spec.m_style.first)
+    {
+      props.m_style_name=spec.m_style.second;
+    }
+
+  props.m_bold=spec.m_weight.first and spec.m_weight.second>=FC_WEIGHT_BOLD;
+  props.m_italic=spec.m_slant.first and spec.m_slant.second!=FC_SLANT_ROMAN;
+
+  entry.font()=WRATHFontDatabase::fetch_font_entry(index_entry.m_filename, 
+                                                   index_entry.m_face_index,
+                                                   props);
+  entry.m_fontconfig_details=spec;
+
+  if(m_font_list.find(entry.font())==m_font_list.end())
+    {
+      FcFontSetAdd(m_fc_font_list, create_pattern(index_entry));
       m_font_list[entry.font()]=entry;
     }
 }
@@ -376,6 +1099,10 @@ font_config_magic_class::
 ~font_config_magic_class()
 {
   FcFontSetDestroy(m_fc_font_list);
+  if(m_fc_config!=NULL)
+    {
+      FcConfigDestroy(m_fc_config);
+    }
 }
 
 WRATHFontFetch::font_handle
@@ -431,7 +1158,7 @@ fetch_font_entry(const WRATHFontConfig::InFontSpecification &in_spec)
   FcResult fc_result;
   WRATHFontFetch::font_handle R;
 
-  fc_font_choice=FcFontSetMatch(NULL, &m_fc_font_list, 1, fc_filter, &fc_result);
+  fc_font_choice=FcFontSetMatch(m_fc_config, &m_fc_font_list, 1, fc_filter, &fc_result);
   if(fc_font_choice!=NULL)
     {
       FcMagicValue<FcChar8*> file_name;
@@ -463,6 +1190,20 @@ fetch_font_entry(const WRATHFontConfig::InFontSpecification &in_spec)
 }
 
 
+const std::string&
+WRATHFontConfig::
+index_file(void)
+{
+  return index_filename();
+}
+
+void
+WRATHFontConfig::
+index_file(const std::string &filename)
+{
+  index_filename()=filename;
+}
+
 const WRATHFontConfig::FontList&
 WRATHFontConfig::
 font_list(void)
@@ -77,6 +77,14 @@ namespace WRATHFontDatabase
                 const FontMemorySource::const_handle &h,
                 bool register_font);
 
+    /*
+      registers the font with the given properties
+      without opening the font file
+     */
+    Font::const_handle
+    fetch_font(const std::string &pfilename, int pindex,
+               const FontProperties &props);
+
     /*
       attempts a match...
      */
@@ -96,6 +104,12 @@ namespace WRATHFontDatabase
 
     typedef std::map<FontProperties, MetaFont*> map_type;
 
+    Font::const_handle
+    add_font(const std::string &pfilename, int pindex,
+             const FontMemorySource::const_handle &h,
+             const FontProperties &props,
+             bool register_font);
+
     void
     place_font_entry_into_meta_fonts(const Font::handle &h);
 
@@ -232,46 +246,20 @@ fetch_fonts(const std::string &pfilename,
             const FontMemorySource::const_handle &h,
             bool register_font)
 {
-  FT_Face face(NULL);
-  FT_Library lib(NULL);
-  int lib_error, face_error;
+  FT_Face face;
+  int num_faces;
   std::vector<WRATHFontDatabase::Font::const_handle> H;
 
-  lib_error=FT_Init_FreeType(&lib);
-  if(lib_error)
+  face=WRATHFreeTypeSupport::new_face(pfilename, 0, h);
+  if(face==NULL)
     {
       return H;
     }
+  num_faces=face->num_faces;
+  WRATHFreeTypeSupport::done_face(face);
 
-  if(!h.valid())
-    {
-      face_error=FT_New_Face(lib,
-                             pfilename.c_str(),
-                             0, &face);
-    }
-  else
-    {
-      /*
-        read from memory
-       */
-      face_error=FT_New_Memory_Face(lib,
-                                    h->data().c_ptr(),
-                                    h->data().size(),
-                                    0, &face);
-    }
-
-  if(face_error!=0 or face==NULL)
-    {
-      if(face!=NULL)
-        {
-          FT_Done_Face(face);
-        }
-      FT_Done_FreeType(lib);
-      return H;
-    }
-
-  H.reserve(face->num_faces);
-  for(int i=0; i<face->num_faces; ++i)
+  H.reserve(num_faces);
+  for(int i=0; i<num_faces; ++i)
     {
       Font::const_handle R;
       R=fetch_font(pfilename, i, h, register_font);
@@ -290,12 +278,11 @@ fetch_font(const std::string &pfilename, int pindex,
            const FontMemorySource::const_handle &h,
            bool register_font)
 {
-  std::map<font_key, Font::handle>::iterator iter;
-
-  WRATHAutoLockMutex(m_fonts_mutex);
-
   if(register_font)
     {
+      std::map<font_key, Font::handle>::iterator iter;
+      WRATHAutoLockMutex(m_fonts_mutex);
+
       iter=m_fonts.find( font_key(pfilename, pindex));
       if(iter!=m_fonts.end())
         {
@@ -303,50 +290,90 @@ fetch_font(const std::string &pfilename, int pindex,
         }
     }
 
-  Font::handle H;
-  
   /*
-    first attempt to get the FT_Face from freetype
+    get the properties from the FT_Face without
+    holding m_fonts_mutex, opening a face
+    can take a while.
    */
-  FT_Face face(NULL);
-  FT_Library lib(NULL);
-  int lib_error, face_error;
+  FT_Face face;
+  FontProperties props;
 
-  lib_error=FT_Init_FreeType(&lib);
-  if(lib_error)
+  face=WRATHFreeTypeSupport::new_face(pfilename, pindex, h);
+  if(face==NULL)
     {
-      return H;
+      return Font::const_handle();
     }
 
-  if(!h.valid())
+  /*
+    only scalable faces can be used by the
+    WRATHTextureFont types, as does the
+    Fontconfig index with FC_SCALABLE.
+   */
+  if((face->face_flags&FT_FACE_FLAG_SCALABLE)==0)
     {
-      face_error=FT_New_Face(lib,
-                             pfilename.c_str(),
-                             pindex, &face);
+      WRATHFreeTypeSupport::done_face(face);
+      return Font::const_handle();
     }
-  else
+
+  if(face->family_name!=NULL)
     {
-      /*
-        read from memory
-       */
-      face_error=FT_New_Memory_Face(lib,
-                                    h->data().c_ptr(),
-                                    h->data().size(),
-                                    pindex, &face);
+      props.m_family_name=face->family_name;
     }
 
-  if(face_error!=0 or face==NULL or (face->face_flags&FT_FACE_FLAG_SCALABLE)==0) 
+  if(face->style_name!=NULL)
     {
-      if(face!=NULL)
-          {
-            FT_Done_Face(face);
-          }
-      FT_Done_FreeType(lib);
-      return H;
+      props.m_style_name=face->style_name;
     }
 
+  props.m_bold= (face->style_flags & FT_STYLE_FLAG_BOLD);
+  props.m_italic= (face->style_flags & FT_STYLE_FLAG_ITALIC);
+
+  /*
+    the foundry name is a touch hosed from Freetype,
+    so we don't get it and the foundry name is empty.
+    sighs.
+   */
+  WRATHFreeTypeSupport::done_face(face);
 
-  H=WRATHNew Font(h, pfilename, pindex, face); 
+  return add_font(pfilename, pindex, h, props, register_font);
+}
+
+WRATHFontDatabase::Font::const_handle
+WRATHFontDatabase::FontDatabaseImplement::
+fetch_font(const std::string &pfilename, int pindex,
+           const FontProperties &props)
+{
+  return add_font(pfilename, pindex, FontMemorySource::const_handle(),
+                  props, true);
+}
+
+WRATHFontDatabase::Font::const_handle
+WRATHFontDatabase::FontDatabaseImplement::
+add_font(const std::string &pfilename, int pindex,
+         const FontMemorySource::const_handle &h,
+         const FontProperties &props,
+         bool register_font)
+{
+  Font::handle H;
+
+  WRATHAutoLockMutex(m_fonts_mutex);
+
+  if(register_font)
+    {
+      std::map<font_key, Font::handle>::iterator iter;
+
+      /*
+        another thread may have added the font
+        while the lock was not held.
+       */
+      iter=m_fonts.find( font_key(pfilename, pindex));
+      if(iter!=m_fonts.end())
+        {
+          return iter->second;
+        }
+    }
+
+  H=WRATHNew Font(h, pfilename, pindex, props); 
   H->m_is_registered_font=register_font;
 
   if(register_font)
@@ -355,10 +382,6 @@ fetch_font(const std::string &pfilename, int pindex,
     }
   place_font_entry_into_meta_fonts(H);
 
-  
-  FT_Done_Face(face);
-  FT_Done_FreeType(lib);
-
   return H;
 }
 
@@ -539,38 +562,17 @@ connect_and_append(const signal_t::slot_type &subscriber, int gp_order,
 // WRATHFontDatabase::Font methods
 WRATHFontDatabase::Font::
 Font(const FontMemorySource::const_handle &h,
-     const std::string &pfilename, int pindex, FT_Face pface):
+     const std::string &pfilename, int pindex, 
+     const FontProperties &props):
   m_memory_source(h),
   m_filename(pfilename), 
-  m_face_index(pindex)
+  m_face_index(pindex),
+  m_properties(props)
 {
   std::ostringstream ostr;
 
   ostr << m_filename << ":" << m_face_index;
   m_label=ostr.str();
-
-  /*
-    get the values for m_properties from pface.
-   */
-  if(pface->family_name!=NULL)
-    {
-      m_properties.m_family_name=pface->family_name;
-    }
-
-  if(pface->style_name!=NULL)
-    {
-      m_properties.m_style_name=pface->style_name;
-    }
-
-  m_properties.m_bold= (pface->style_flags & FT_STYLE_FLAG_BOLD);
-  m_properties.m_italic= (pface->style_flags & FT_STYLE_FLAG_ITALIC);
-
-  /*
-    the foundry name is a touch hosed from Freetype,
-    so we don't get it and the foundry name is empty.
-    sighs.
-   */
-
 }
 
 
@@ -593,6 +595,13 @@ namespace WRATHFontDatabase
     return font_database().fetch_fonts(pfilename, h, true);
   }
 
+  Font::const_handle
+  fetch_font_entry(const std::string &pfilename, int pface_index,
+                   const FontProperties &props)
+  {
+    return font_database().fetch_font(pfilename, pface_index, props);
+  }
+
   Font::const_handle
   create_unregistered_font(const std::string &pfilename, int pface_index,
                            const FontMemorySource::const_handle &h)
@@ -29,6 +29,8 @@ namespace
   {
   public:    
     WRATHGLShader::shader_source m_vertex_shader;
+    WRATHGLShader::shader_source m_compact_vertex_shader;
+    WRATHGLShader::shader_source m_compact_instanced_vertex_shader;
     WRATHGLShader::shader_source m_aa_fragment_shader;
     WRATHGLShader::shader_source m_non_aa_fragment_shader;
     
@@ -45,6 +47,10 @@ namespace
     DefaultShaders(void)
     {
       m_vertex_shader.add_source("simple_ui_font.vert.wrath-shader.glsl", WRATHGLShader::from_resource);
+      m_compact_vertex_shader.add_source("compact_ui_font.vert.wrath-shader.glsl", WRATHGLShader::from_resource);
+      m_compact_instanced_vertex_shader
+        .add_macro("WRATH_COMPACT_TEXT_INSTANCED")
+        .add_source("compact_ui_font.vert.wrath-shader.glsl", WRATHGLShader::from_resource);
       m_aa_fragment_shader.add_source("font_generic_aa.frag.wrath-shader.glsl", WRATHGLShader::from_resource);
       m_non_aa_fragment_shader.add_source("font_generic.frag.wrath-shader.glsl", WRATHGLShader::from_resource);
     }
@@ -174,14 +180,18 @@ fetch_texture_font_drawer(const WRATHTextureFont::GlyphGLSL *fs_source,
 
   const WRATHAttributePacker *attribute_packer;
   int number_custom_to_use;
+  const char *glyph_table_sampler;
+  map_key key;
   
   number_custom_to_use=fs_source->m_custom_data_use.size();
   attribute_packer=text_packer->fetch_attribute_packer(number_custom_to_use);
+  glyph_table_sampler=text_packer->glyph_table_sampler_name();
+  key=map_key(fs_source, (glyph_table_sampler!=NULL)?glyph_table_sampler:"");
 
   map_type::iterator iter;
   m_modifiable=false;
 
-  iter=m_actual_creators.find(fs_source);
+  iter=m_actual_creators.find(key);
   if(iter!=m_actual_creators.end())
     {
       WRATHShaderSpecifier *sp(iter->second);
@@ -234,6 +244,19 @@ fetch_texture_font_drawer(const WRATHTextureFont::GlyphGLSL *fs_source,
         .add_texture_binding(GL_TEXTURE0+S);
     }
 
+  if(glyph_table_sampler!=NULL)
+    {
+      unsigned int S;
+
+      S=glyph_table_texture_unit(fs_source);
+
+      new_specifier->append_initializers()
+        .add_sampler_initializer(glyph_table_sampler, S);
+
+      new_specifier->append_bindings()
+        .add_texture_binding(GL_TEXTURE0+S);
+    }
+
   /*
     ISSUE: The font shading system does not support shading
     stages beyond vertex and fragment shading; we should 
@@ -317,7 +340,7 @@ fetch_texture_font_drawer(const WRATHTextureFont::GlyphGLSL *fs_source,
     .absorb(fs_source->m_fragment_processor[v])
     .absorb(fragment_shader_source());
     
-  m_actual_creators[fs_source]=new_specifier;
+  m_actual_creators[key]=new_specifier;
 
   
   return new_specifier->fetch_two_pass_drawer<WRATHTextureFontDrawer>(factory, 
@@ -333,6 +356,20 @@ default_vertex_shader(void)
 }
 
 
+const WRATHGLShader::shader_source&
+WRATHFontShaderSpecifier::
+compact_vertex_shader(void)
+{
+  return DefaultShaders::instance().m_compact_vertex_shader;
+}
+
+const WRATHGLShader::shader_source&
+WRATHFontShaderSpecifier::
+compact_instanced_vertex_shader(void)
+{
+  return DefaultShaders::instance().m_compact_instanced_vertex_shader;
+}
+
 const WRATHGLShader::shader_source&
 WRATHFontShaderSpecifier::
 default_aa_fragment_shader(void)
@@ -368,6 +405,54 @@ default_non_aa(void)
   return R;                                    
 }
 
+const WRATHFontShaderSpecifier&
+WRATHFontShaderSpecifier::
+compact_aa(void)
+{
+  WRATHStaticInit();
+  static WRATHFontShaderSpecifier R(compact_vertex_shader(),
+                                    default_aa_fragment_shader());
+  return R;
+}
+
+const WRATHFontShaderSpecifier&
+WRATHFontShaderSpecifier::
+compact_non_aa(void)
+{
+  WRATHStaticInit();
+  static WRATHFontShaderSpecifier R(compact_vertex_shader(),
+                                    default_non_aa_fragment_shader());
+  return R;
+}
+
+const WRATHFontShaderSpecifier&
+WRATHFontShaderSpecifier::
+compact_instanced_aa(void)
+{
+  WRATHStaticInit();
+  static WRATHFontShaderSpecifier R(compact_instanced_vertex_shader(),
+                                    default_aa_fragment_shader());
+  return R;
+}
+
+const WRATHFontShaderSpecifier&
+WRATHFontShaderSpecifier::
+compact_instanced_non_aa(void)
+{
+  WRATHStaticInit();
+  static WRATHFontShaderSpecifier R(compact_instanced_vertex_shader(),
+                                    default_non_aa_fragment_shader());
+  return R;
+}
+
+int
+WRATHFontShaderSpecifier::
+glyph_table_texture_unit(const WRATHTextureFont::GlyphGLSL *fs_source)
+{
+  return fs_source->m_sampler_names.size() 
+    + WRATHText::number_additional_textures_supported;
+}
+
 const WRATHFontShaderSpecifier&
 WRATHFontShaderSpecifier::
 default_brush_item_aa(const WRATHShaderBrush &brush)
@@ -22,6 +22,8 @@
 #include <ft2build.h>
 #include FT_FREETYPE_H
 #include FT_STROKER_H
+#include FT_TRUETYPE_TAGS_H
+#include FT_TRUETYPE_TABLES_H
 
 #include <map>
 #include "WRATHFreeTypeSupport.hpp"
@@ -323,33 +325,138 @@ namespace
       }
   }
 
-  class face_with_private_library:public WRATHFreeTypeSupport::LockableFace
+  class face_with_shared_library:public WRATHFreeTypeSupport::LockableFace
   {
   public:
-    face_with_private_library(FT_Face ft_fc, FT_Library ft_lib):
-      WRATHFreeTypeSupport::LockableFace(ft_fc, true),
-      m_lib(ft_lib)
+    explicit
+    face_with_shared_library(FT_Face ft_fc):
+      WRATHFreeTypeSupport::LockableFace(ft_fc, true)
     {}
 
-    ~face_with_private_library(void)
+    ~face_with_shared_library(void)
     {
       /*
         note: we set the flag as true so that
         the dtor of WRATHFreeTypeSupport::LockableFace
-        would NOT FT_Done_Face the face, but we will
-        so that we can FT_Done_FreeType after closing
-        the FT_Face.
+        would NOT FT_Done_Face the face, we release
+        it with done_face() because releasing faces
+        of the shared library must be serialized.
        */
       WRATHLockMutex(mutex());
-      FT_Done_Face(face());
-      FT_Done_FreeType(m_lib);
+      WRATHFreeTypeSupport::done_face(face());
       WRATHUnlockMutex(mutex());
     }
+  };
+
+  class shared_library_holder:boost::noncopyable
+  {
+  public:
+    shared_library_holder(void):
+      m_lib(NULL)
+    {
+      int error_code;
+
+      error_code=FT_Init_FreeType(&m_lib);
+      if(error_code!=0)
+        {
+          WRATHwarning("Unable to initialize FreeType");
+          m_lib=NULL;
+        }
+    }
 
-  private:
+    /*
+      the library is deliberately never released:
+      faces may outlive static destruction of 
+      this object.
+     */
+
+    WRATHMutex m_mutex;
     FT_Library m_lib;
   };
 
+  shared_library_holder&
+  shared_library_data(void)
+  {
+    WRATHStaticInit();
+    static shared_library_holder R;
+    return R;
+  }
+
+  bool kerning_table_enabled_value(true);
+
+  uint32_t
+  read_uint16(const FT_Byte *p)
+  {
+    return (static_cast<uint32_t>(p[0])<<8u) | static_cast<uint32_t>(p[1]);
+  }
+
+  /*
+    reads the kerning pairs from a 'kern' table
+    in the same way that FreeType does: only
+    version 0 tables with format 0 horizontal 
+    subtables are understood, and the values
+    of the subtables are added except that a
+    subtable with the override bit (bit 3 of
+    coverage) set replaces the value of the
+    subtables before it.
+   */
+  void
+  read_kern_table(const std::vector<FT_Byte> &kern,
+                  std::map<uint32_t, int> &out_pairs)
+  {
+    const FT_Byte *p(&kern[0]), *p_limit(&kern[0] + kern.size());
+    uint32_t num_tables;
+
+    num_tables=read_uint16(p+2);
+    p+=4;
+
+    /*
+      FreeType only considers the first 32 subtables.
+     */
+    num_tables=std::min(num_tables, 32u);
+    for(uint32_t t=0; t<num_tables and p+6<=p_limit; ++t)
+      {
+        const FT_Byte *p_next;
+        uint32_t length, coverage, num_pairs;
+
+        length=read_uint16(p+2);
+        coverage=read_uint16(p+4);
+        if(length<=6+8)
+          {
+            break;
+          }
+
+        p_next=(static_cast<size_t>(p_limit-p)>length)?
+          p+length:
+          p_limit;
+
+        if((coverage&~8u)==1u and p+14<=p_next)
+          {
+            num_pairs=read_uint16(p+6);
+            p+=14;
+            num_pairs=std::min(num_pairs, static_cast<uint32_t>((p_next-p)/6));
+
+            for(uint32_t i=0; i<num_pairs; ++i, p+=6)
+              {
+                uint32_t key;
+                int16_t value;
+
+                key=(read_uint16(p)<<16u) | read_uint16(p+2);
+                value=static_cast<int16_t>(read_uint16(p+4));
+                if(coverage&8u)
+                  {
+                    out_pairs[key]=value;
+                  }
+                else
+                  {
+                    out_pairs[key]+=value;
+                  }
+              }
+          }
+        p=p_next;
+      }
+  }
+
 }
 
 namespace WRATHFreeTypeSupport
@@ -2883,40 +2990,41 @@ namespace WRATHFreeTypeSupport
 
 
 
-  LockableFace::handle
-  load_face(const WRATHFontDatabase::Font::const_handle &fnt)
+  FT_Library
+  shared_library(void)
   {
+    return shared_library_data().m_lib;
+  }
+
+  FT_Face
+  new_face(const std::string &filename, int face_index,
+           const WRATHFontDatabase::FontMemorySource::const_handle &h)
+  {
+    shared_library_holder &lib(shared_library_data());
     FT_Face face(NULL);
-    FT_Library lib(NULL);
-    int load_lib_error_code, load_font_error_code;
+    int load_font_error_code;
 
-    if(!fnt.valid())
+    if(lib.m_lib==NULL)
       {
-        return LockableFace::handle();
+        return NULL;
       }
 
-    load_lib_error_code=FT_Init_FreeType(&lib);
-    if(load_lib_error_code!=0)
-      {
-        return LockableFace::handle();
-      }
-  
-    if(!fnt->memory_source().valid())
+    WRATHAutoLockMutex(lib.m_mutex);
+    if(!h.valid())
       {
-        load_font_error_code=FT_New_Face(lib,
-                                         fnt->name().c_str(),
-                                         fnt->face_index(),
+        load_font_error_code=FT_New_Face(lib.m_lib,
+                                         filename.c_str(),
+                                         face_index,
                                          &face);
       }
     else
       {
-        load_font_error_code=FT_New_Memory_Face(lib,
-                                                fnt->memory_source()->data().c_ptr(),
-                                                fnt->memory_source()->data().size(),
-                                                fnt->face_index(),
+        load_font_error_code=FT_New_Memory_Face(lib.m_lib,
+                                                h->data().c_ptr(),
+                                                h->data().size(),
+                                                face_index,
                                                 &face);
       }
-          
 
     if(load_font_error_code!=0 or face==NULL or (face->face_flags&FT_FACE_FLAG_SCALABLE)==0) 
       {
@@ -2924,11 +3032,50 @@ namespace WRATHFreeTypeSupport
           {
             FT_Done_Face(face);
           }
-        FT_Done_FreeType(lib);
+        return NULL;
+      }
+    return face;
+  }
+
+  void
+  done_face(FT_Face face)
+  {
+    if(face!=NULL)
+      {
+        WRATHAutoLockMutex(shared_library_data().m_mutex);
+        FT_Done_Face(face);
+      }
+  }
+
+  LockableFace::handle
+  load_face(const WRATHFontDatabase::Font::const_handle &fnt)
+  {
+    FT_Face face;
+
+    if(!fnt.valid())
+      {
+        return LockableFace::handle();
+      }
+
+    face=new_face(fnt->name(), fnt->face_index(), fnt->memory_source());
+    if(face==NULL)
+      {
         return LockableFace::handle();
       }
     
-    return WRATHNew face_with_private_library(face, lib);
+    return WRATHNew face_with_shared_library(face);
+  }
+
+  bool
+  kerning_table_enabled(void)
+  {
+    return kerning_table_enabled_value;
+  }
+
+  void
+  kerning_table_enabled(bool v)
+  {
+    kerning_table_enabled_value=v;
   }
 
 
@@ -2936,4 +3083,106 @@ namespace WRATHFreeTypeSupport
 
 
 
+}
+
+
+////////////////////////////////////////
+// WRATHFreeTypeSupport::KerningTable methods
+WRATHFreeTypeSupport::KerningTable::
+KerningTable(FT_Face face, int pixel_height):
+  m_mask(0),
+  m_shift(0),
+  m_pixel_height(pixel_height),
+  m_number_pairs(0),
+  m_valid(false)
+{
+  FT_ULong length(0);
+  std::vector<FT_Byte> kern;
+  std::map<uint32_t, int> pairs;
+  std::vector<std::pair<uint32_t, int32_t> > scaled_pairs;
+  FT_Fixed x_scale;
+  uint32_t size;
+
+  if(!FT_HAS_KERNING(face))
+    {
+      m_valid=true;
+      return;
+    }
+
+  /*
+    if the face has kerning but no 'kern' table,
+    then FreeType gets the kerning from elsewhere
+    (for example an AFM file), in that case leave
+    m_valid as false so that kerning is fetched
+    from FreeType.
+   */
+  if(0!=FT_Load_Sfnt_Table(face, TTAG_kern, 0, NULL, &length) or length<4)
+    {
+      return;
+    }
+
+  kern.resize(length);
+  if(0!=FT_Load_Sfnt_Table(face, TTAG_kern, 0, &kern[0], &length))
+    {
+      return;
+    }
+
+  read_kern_table(kern, pairs);
+  if(pairs.empty())
+    {
+      return;
+    }
+
+  /*
+    scale as FT_Get_Kerning does for FT_KERNING_UNFITTED.
+   */
+  FT_Set_Pixel_Sizes(face, pixel_height, 0);
+  x_scale=face->size->metrics.x_scale;
+
+  scaled_pairs.reserve(pairs.size());
+  for(std::map<uint32_t, int>::const_iterator iter=pairs.begin(),
+        end=pairs.end(); iter!=end; ++iter)
+    {
+      int32_t v;
+
+      v=FT_MulFix(iter->second, x_scale);
+      if(v!=0 and iter->first!=static_cast<uint32_t>(empty_key))
+        {
+          scaled_pairs.push_back(std::make_pair(iter->first, v));
+        }
+    }
+
+  m_valid=true;
+  m_number_pairs=scaled_pairs.size();
+  if(scaled_pairs.empty())
+    {
+      return;
+    }
+
+  /*
+    keep the load factor at most 1/2.
+   */
+  for(size=2, m_shift=31; size<2*scaled_pairs.size(); size*=2, --m_shift)
+    {}
+
+  m_mask=size-1;
+  m_entries.resize(size);
+  for(std::vector<entry>::iterator iter=m_entries.begin(), 
+        end=m_entries.end(); iter!=end; ++iter)
+    {
+      iter->m_key=empty_key;
+      iter->m_value=0;
+    }
+
+  for(std::vector<std::pair<uint32_t, int32_t> >::const_iterator 
+        iter=scaled_pairs.begin(), end=scaled_pairs.end(); iter!=end; ++iter)
+    {
+      uint32_t slot;
+
+      for(slot=first_slot(iter->first); m_entries[slot].m_key!=empty_key; slot=(slot+1)&m_mask)
+        {}
+
+      m_entries[slot].m_key=iter->first;
+      m_entries[slot].m_value=iter->second;
+    }
 }
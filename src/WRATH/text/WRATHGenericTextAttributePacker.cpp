@@ -20,13 +20,127 @@
 
 #include "WRATHConfig.hpp"
 #include <limits>
+#include <set>
+#include <sstream>
+#include <string.h>
+#include <pthread.h>
 #include "WRATHGenericTextAttributePacker.hpp"
+#include "WRATHStaticInit.hpp"
 
 namespace
 {
-  
-  
-  
+  /*
+    Buffers into which a thread packs attribute
+    and index data without holding the locks of
+    the data sinks. Each thread has its own
+    buffers which are reused by each packing that
+    thread does, so that several threads can pack
+    text concurrently. The buffers of a thread are
+    deleted when the thread exits and are trimmed
+    after a packing that made them larger than
+    max_kept_bytes so that one large text does not
+    pin its peak memory for the life of the thread.
+   */
+  class staging_buffers:boost::noncopyable
+  {
+  public:
+    enum
+      {
+        max_kept_bytes=256*1024
+      };
+
+    void
+    trim(void)
+    {
+      if(m_attributes.capacity()>max_kept_bytes)
+        {
+          std::vector<uint8_t>().swap(m_attributes);
+        }
+
+      if(m_indices.capacity()*sizeof(GLushort)>max_kept_bytes)
+        {
+          std::vector<GLushort>().swap(m_indices);
+        }
+    }
+
+    std::vector<uint8_t> m_attributes;
+    std::vector<GLushort> m_indices;
+  };
+
+  __thread staging_buffers *current_staging_buffers=NULL;
+
+  class staging_registry:boost::noncopyable
+  {
+  public:
+    staging_registry(void)
+    {
+      pthread_key_create(&m_key, &staging_registry::on_thread_exit);
+    }
+
+    ~staging_registry()
+    {
+      pthread_key_delete(m_key);
+      for(std::set<staging_buffers*>::iterator iter=m_buffers.begin(),
+            end=m_buffers.end(); iter!=end; ++iter)
+        {
+          WRATHDelete(*iter);
+        }
+    }
+
+    staging_buffers*
+    create_buffers(void)
+    {
+      staging_buffers *return_value;
+
+      WRATHAutoLockMutex(m_mutex);
+      return_value=WRATHNew staging_buffers();
+      m_buffers.insert(return_value);
+      pthread_setspecific(m_key, return_value);
+      return return_value;
+    }
+
+    WRATHMutex m_mutex;
+    std::set<staging_buffers*> m_buffers;
+    pthread_key_t m_key;
+
+  private:
+    static
+    void
+    on_thread_exit(void *p);
+  };
+
+  staging_registry&
+  the_staging_registry(void)
+  {
+    WRATHStaticInit();
+    static staging_registry R;
+    return R;
+  }
+
+  void
+  staging_registry::
+  on_thread_exit(void *p)
+  {
+    staging_buffers *buffers(static_cast<staging_buffers*>(p));
+    staging_registry &R(the_staging_registry());
+
+    {
+      WRATHAutoLockMutex(R.m_mutex);
+      R.m_buffers.erase(buffers);
+    }
+    WRATHDelete(buffers);
+    current_staging_buffers=NULL;
+  }
+
+  staging_buffers&
+  fetch_staging_buffers(void)
+  {
+    if(current_staging_buffers==NULL)
+      {
+        current_staging_buffers=the_staging_registry().create_buffers();
+      }
+    return *current_staging_buffers;
+  }
 
   vecN<GLshort,2>
   compute_normalized_coordinate_short(bool y_factor_positive,
@@ -50,16 +164,6 @@ namespace
     return R.m_end-R.m_begin;
   }
 
-  inline
-  c_array<uint8_t>
-  get_pointer(const range_type<int> &R,
-              WRATHAbstractDataSink &buffer,
-              size_t attr_size)
-  {
-    return buffer.pointer<uint8_t>(R.m_begin*attr_size,
-                                   length_of_range(R)*attr_size);
-  }
-
   inline
   c_array<uint8_t>
   get_attribute_reference(int attr_index,
@@ -72,6 +176,143 @@ namespace
 
 /////////////////////////////////////////
 //WRATHGenericTextAttributePacker methods
+void
+WRATHGenericTextAttributePacker::
+append_custom_data_attribute_names(std::vector<std::string> &out_names,
+                                   int number_custom_data)
+{
+  unsigned int N, R;
+
+  N=number_custom_data/4;
+  R=number_custom_data%4;
+  if(R>0) 
+    {
+      ++N;
+    }
+
+  for(unsigned int i=0; i<N; ++i)
+    {
+      std::ostringstream ostr;
+      ostr << "custom_data" << i;
+      out_names.push_back(ostr.str());
+    }
+}
+
+void
+WRATHGenericTextAttributePacker::
+generate_custom_data_attribute_glsl(WRATHGLShader::shader_source &out_src,
+                                    int number_custom_data_to_use)
+{
+  int N, R, idx;
+  const char *swizzle[]={".x", ".y", ".z", ".w" };
+  std::ostringstream ostr;
+
+  N=number_custom_data_to_use/4;
+  R=number_custom_data_to_use%4;
+  for(int i=0; i<N; ++i)
+    {
+      ostr << "\nshader_in highp vec4 custom_data" << i << ";";
+    }
+  
+  if(R==1)
+    {
+      ostr << "\nshader_in highp float custom_data" << N << ";";
+    }
+  else if(R>1)
+    {
+      ostr << "\nshader_in highp vec" << R << " custom_data" << N << ";";
+    }
+  
+  /*
+    create the function that returns the data as an array
+  */
+  ostr << "\nvoid wrath_font_shader_custom_data_func(out wrath_font_custom_data_t v)"
+       << "\n{";
+  
+  idx=0;
+  for(int i=0; i<N; ++i)
+    {
+      for(int j=0; j<4; ++j, ++idx)
+        {
+          ostr << "\n\tv.values[" << idx << "]=" 
+               << "custom_data" << i << swizzle[j] << ";";
+        }
+    }
+
+  if(R==1)
+    {
+      ostr << "\n\tv.values[" << idx 
+           << "]=custom_data" << N << ";";
+    }
+  else
+    {
+      for(int j=0; j<R; ++j, ++idx)
+        {
+          ostr << "\n\tv.values[" << idx << "]=" 
+               << "custom_data" << N << swizzle[j] << ";";
+        }
+    }
+  ostr << "\n}\n";
+
+  out_src.add_source(ostr.str(), WRATHGLShader::from_string);
+}
+
+void
+WRATHGenericTextAttributePacker::
+set_custom_data_attribute_key(WRATHAttributeStoreKey &pkey,
+                              int attr_slot, ptrdiff_t offset,
+                              int number_custom_floats)
+{
+  int num_remaining(number_custom_floats);
+
+  /*
+    every 4 custom values adds a new vec4 attribute
+   */      
+  for(;num_remaining>=4 and attr_slot<WRATHDrawCallSpec::attribute_count;
+      num_remaining-=4, ++attr_slot, offset+=4*sizeof(float))
+    {
+      pkey.m_attribute_format_location[attr_slot].m_offset=offset;
+      pkey.m_attribute_format_location[attr_slot].traits( type_tag<vec4>() );
+    }
+
+  /*
+    remaining values use a float, vec2, or vec3
+   */
+  if(attr_slot<WRATHDrawCallSpec::attribute_count)
+    {
+      WRATHassert(num_remaining<4);
+      switch(num_remaining)
+        {
+        case 0:
+          break;
+          
+        case 1:
+          pkey.m_attribute_format_location[attr_slot].m_offset=offset;
+          pkey.m_attribute_format_location[attr_slot].traits( type_tag<float>() );
+          ++attr_slot;
+          break;
+          
+        case 2:
+          pkey.m_attribute_format_location[attr_slot].m_offset=offset;
+          pkey.m_attribute_format_location[attr_slot].traits( type_tag<vec2>() );
+          ++attr_slot;
+          break;
+          
+        case 3:
+          pkey.m_attribute_format_location[attr_slot].m_offset=offset;
+          pkey.m_attribute_format_location[attr_slot].traits( type_tag<vec3>() );
+          ++attr_slot;
+          break;
+        }
+    }
+  
+  //now adjust the stride:
+  for(int i=0; i<attr_slot; ++i)
+    {
+      pkey.m_attribute_format_location[i].m_stride = pkey.m_type_size;          
+    }
+}
+
 WRATHGenericTextAttributePacker::PackerState
 WRATHGenericTextAttributePacker::
 begin_range(const range_type<int>&,
@@ -147,7 +388,9 @@ allocation_allotment(int attributes_allowed,
     }
   else
     {
-      int glyphs_allowed(attributes_allowed>>2); //4 attributes per glyph
+      //4 attributes per glyph, 1 if instanced
+      int shift((m_type==InstancedPacker)?0:2);
+      int glyphs_allowed(attributes_allowed>>shift); 
     
       for(const_c_array<range_type<int> >::iterator 
             iter=Rarray.begin(), end=Rarray.end(); 
@@ -158,13 +401,13 @@ allocation_allotment(int attributes_allowed,
           count=iter->m_end - iter->m_begin;
           if(count<=glyphs_allowed)
             {
-              return_value.m_number_attributes+=(count<<2);
+              return_value.m_number_attributes+=(count<<shift);
               ++return_value.m_handled_end;
               glyphs_allowed-=count;
             }
           else
             {              
-              return_value.m_number_attributes+=(glyphs_allowed<<2);
+              return_value.m_number_attributes+=(glyphs_allowed<<shift);
               return_value.m_room_for_all=false;
               return_value.m_sub_end=iter->m_begin + glyphs_allowed;              
             }
@@ -215,8 +458,16 @@ allocation_requirement(const_c_array<range_type<int> > Rarray,
         WRATHTextAttributePacker::number_of_characters(Rarray.begin(), Rarray.end(), 
                                                        pdata, font, texture_page); 
       
-      return_value.m_number_attributes=4*number_chars;
-      return_value.m_number_indices=6*number_chars;
+      if(m_type==InstancedPacker)
+        {
+          return_value.m_number_attributes=number_chars;
+          return_value.m_number_indices=0;
+        }
+      else
+        {
+          return_value.m_number_attributes=4*number_chars;
+          return_value.m_number_indices=6*number_chars;
+        }
 
     }
 
@@ -247,7 +498,8 @@ set_attribute_data_implement(const_c_array<range_type<int> > Rarray,
   allocation_requirement_type AA(allocation_requirement(Rarray, font, texture_page, pdata, state_stream));
   WRATHassert(static_cast<unsigned int>(AA.m_number_attributes)<=WRATHAttributeStore::total_size(attr_location));
 
-  if(AA.m_number_attributes==0 or AA.m_number_indices==0)
+  if(AA.m_number_attributes==0 
+     or (AA.m_number_indices==0 and m_type!=InstancedPacker))
     {
       return;
     }
@@ -310,18 +562,21 @@ set_attribute_data_implement(const_c_array<range_type<int> > Rarray,
     float_normalized_coordinate_negative;
 
   /*
-    Lock before aquiring the pointers:
+    The attribute and index data is first packed
+    into the staging buffers of the calling thread
+    without locking; the locks of attribute_store
+    and index_group are only held while the staged
+    data is copied to them. The index values are
+    computed from attr_location, so they are the
+    same as if packed directly.
    */
-  WRATHAutoLockMutex(attribute_store.mutex());
-  WRATHAutoLockMutex(index_group.mutex());
+  staging_buffers &staging(fetch_staging_buffers());
 
-  indices=index_group.pointer<GLushort>(0, AA.m_number_indices);
-  if(!attr_location.empty())
-    {
-      attrs=get_pointer(attr_location[0], attribute_store, sattr_size);
-    }
+  staging.m_attributes.resize(AA.m_number_attributes*sattr_size);
+  staging.m_indices.resize(AA.m_number_indices);
+  attrs=c_array<uint8_t>(staging.m_attributes);
+  indices=c_array<GLushort>(staging.m_indices);
 
-  
   for(char_range_iter=Rarray.begin(), 
         char_range_end=Rarray.end(),
         attr_range_iter=attr_location.begin(),
@@ -482,22 +737,16 @@ set_attribute_data_implement(const_c_array<range_type<int> > Rarray,
                                      compute_normalized_coordinate_short(y_factor_positive, 
                                                                          tt.m_position_within_glyph_coordinate),
                                      custom_data_use,
-                                     get_attribute_reference(current_attr_index, 
+                                     get_attribute_reference(total_attribute_count, 
                                                              attrs, sattr_size),
                                      packer_state);
 
                       ++total_attribute_count;
                       ++current_attr_index;
-                      if(current_attr_index*sattr_size==attrs.size())
+                      if(static_cast<int>(current_attr_index)==length_of_range(*attr_range_iter))
                         {
                           ++attr_range_iter;
-                          if(attr_range_iter!=attr_range_end)
-                            {
-                              current_attr_index=0;
-                              attrs=get_pointer(*attr_range_iter, 
-                                                attribute_store,
-                                                sattr_size);
-                            }
+                          current_attr_index=0;
                         }
                     }
 
@@ -507,6 +756,30 @@ set_attribute_data_implement(const_c_array<range_type<int> > Rarray,
                     }
 
                 }
+              else if(m_type==InstancedPacker)
+                {
+                  /*
+                    one attribute per glyph, the corners
+                    are made by the vertex shader.
+                   */
+                  pack_attribute(WRATHFormattedTextStream::not_corner,
+                                 the_glyph,
+                                 use_float_normalized_coordinate[WRATHFormattedTextStream::top_right_corner],
+                                 use_normalzied_array[WRATHFormattedTextStream::top_right_corner],
+                                 custom_data_use,
+                                 get_attribute_reference(total_attribute_count, 
+                                                         attrs, 
+                                                         sattr_size),
+                                 packer_state);
+
+                  ++total_attribute_count;
+                  ++current_attr_index;
+                  if(static_cast<int>(current_attr_index)==length_of_range(*attr_range_iter))
+                    {
+                      ++attr_range_iter;
+                      current_attr_index=0;
+                    }
+                }
               else
                 {
                   vecN<int, 4> quad_indices;
@@ -521,23 +794,17 @@ set_attribute_data_implement(const_c_array<range_type<int> > Rarray,
                                      use_float_normalized_coordinate[k],
                                      use_normalzied_array[k],
                                      custom_data_use,
-                                     get_attribute_reference(current_attr_index, 
+                                     get_attribute_reference(total_attribute_count, 
                                                              attrs, 
                                                              sattr_size),
                                      packer_state);
 
                       ++total_attribute_count;
                       ++current_attr_index;
-                      if(current_attr_index*sattr_size==attrs.size())
+                      if(static_cast<int>(current_attr_index)==length_of_range(*attr_range_iter))
                         {
                           ++attr_range_iter;
-                          if(attr_range_iter!=attr_range_end)
-                            {
-                              current_attr_index=0;
-                              attrs=get_pointer(*attr_range_iter, 
-                                                attribute_store, 
-                                                sattr_size);
-                            }
+                          current_attr_index=0;
                         }
 
                     } //of for(int k=0; ...)
@@ -562,5 +829,39 @@ set_attribute_data_implement(const_c_array<range_type<int> > Rarray,
 
     } //of for(char_range_iter=Rarray.begin(), ...)
   
-  
+  /*
+    copy the staged data, only now
+    locking the data sinks.
+   */
+  WRATHMutex *index_mutex(NULL);
+
+  if(m_type!=InstancedPacker)
+    {
+      index_mutex=index_group.mutex();
+    }
+  WRATHAutoLockMutex(attribute_store.mutex());
+  WRATHAutoLockMutex(index_mutex);
+
+  for(int copied=0, I=0; copied<total_attribute_count; ++I)
+    {
+      int count;
+      c_array<uint8_t> dest;
+
+      WRATHassert(I<static_cast<int>(attr_location.size()));
+      count=std::min(length_of_range(attr_location[I]), total_attribute_count - copied);
+      dest=attribute_store.pointer<uint8_t>(attr_location[I].m_begin*sattr_size,
+                                            count*sattr_size);
+      memcpy(dest.c_ptr(), attrs.c_ptr() + copied*sattr_size, count*sattr_size);
+      copied+=count;
+    }
+
+  if(indx>0)
+    {
+      c_array<GLushort> dest;
+
+      dest=index_group.pointer<GLushort>(0, indx);
+      memcpy(dest.c_ptr(), indices.c_ptr(), indx*sizeof(GLushort));
+    }
+
+  staging.trim();
 }
@@ -0,0 +1,202 @@
+/*! 
+ * \file WRATHTextData.cpp
+ * \brief file WRATHTextData.cpp
+ * 
+ * Copyright 2013 by Nomovok Ltd.
+ * 
+ * Contact: info@nomovok.com
+ * 
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ * 
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ * 
+ */
+
+
+#include "WRATHConfig.hpp"
+#include <algorithm>
+#include "WRATHTextData.hpp"
+
+namespace
+{
+  const uint32_t bad_utf8_value=0xDC80;
+
+  bool
+  is_start_byte(uint8_t v)
+  {
+    return (v&(128|64))!=128;
+  }
+
+  /*
+    reserve room for at most n more elements, growing
+    geometrically so that many small appends do not
+    reallocate each time.
+   */
+  template<typename T>
+  void
+  reserve_additional(std::vector<T> &v, size_t n)
+  {
+    size_t needed(v.size() + n);
+
+    if(needed>v.capacity())
+      {
+        v.reserve(std::max(needed, 2*v.capacity()));
+      }
+  }
+
+  /*
+    decodes the character whose leading byte is at
+    begin, returns the character and advances begin
+    past the character and any stray continuation
+    bytes following it, the same as WRATHUTF8.
+   */
+  uint32_t
+  decode_multibyte(const uint8_t *&begin, const uint8_t *end)
+  {
+    uint8_t start_value(*begin), current_mask(128);
+    int header_length(0);
+    uint32_t return_value;
+    const uint32_t minimum_size[]=
+      {
+        1<<7 , //header_length=2
+        1<<11, //header_length=3
+        1<<16, //header_length=4
+        1<<21, //header_length=5
+        1<<26, //header_length=6
+      };
+
+    while(current_mask&start_value)
+      {
+        ++header_length;
+        start_value&=~current_mask;
+        current_mask=(current_mask>>1);
+      }
+
+    ++begin;
+    if(header_length>6)
+      {
+        return_value=bad_utf8_value;
+      }
+    else
+      {
+        int number_continuation_bytes(header_length-1);
+
+        return_value=start_value;
+        for(; number_continuation_bytes>0 and begin!=end
+              and !is_start_byte(*begin); ++begin, --number_continuation_bytes)
+          {
+            return_value=(return_value<<6) | (*begin&~128);
+          }
+
+        if(number_continuation_bytes>0 and begin!=end)
+          {
+            /*
+              start byte found before all
+              the continuation bytes.
+             */
+            return_value=bad_utf8_value;
+          }
+        else if(return_value<minimum_size[header_length-2])
+          {
+            return_value=bad_utf8_value;
+          }
+      }
+
+    while(begin!=end and !is_start_byte(*begin))
+      {
+        ++begin;
+      }
+    return return_value;
+  }
+
+  template<typename T>
+  void
+  decode_utf8_implement(const uint8_t *begin, const uint8_t *end,
+                        std::vector<T> &out)
+  {
+    /*
+      a leading stray continuation
+      byte is skipped, as in WRATHUTF8
+     */
+    while(begin!=end and !is_start_byte(*begin))
+      {
+        ++begin;
+      }
+
+    if(begin==end)
+      {
+        return;
+      }
+
+    /*
+      each character takes atleast one byte, so
+      size for one character per byte, write
+      through a pointer and trim afterwards;
+      inserting each ASCII run and pushing each
+      multibyte character costs more than the
+      decoding when runs are short.
+     */
+    size_t start(out.size());
+    T *dst;
+
+    reserve_additional(out, end - begin);
+    out.resize(start + (end - begin));
+    dst=&out[start];
+
+    while(begin!=end)
+      {
+        if(*begin<128)
+          {
+            do
+              {
+                *dst=T(*begin);
+                ++dst;
+                ++begin;
+              }
+            while(begin!=end and *begin<128);
+
+            while(begin!=end and !is_start_byte(*begin))
+              {
+                ++begin;
+              }
+          }
+        else
+          {
+            *dst=T(decode_multibyte(begin, end));
+            ++dst;
+          }
+      }
+
+    out.resize(dst - &out[0]);
+  }
+}
+
+
+////////////////////////////////////
+// WRATHTextData methods
+void
+WRATHTextData::
+append_utf8(const uint8_t *begin, const uint8_t *end)
+{
+  decode_utf8_implement(begin, end, m_data);
+}
+
+void
+WRATHTextData::
+append_utf32(const uint32_t *begin, const uint32_t *end)
+{
+  reserve_additional(m_data, end - begin);
+  m_data.insert(m_data.end(), begin, end);
+}
+
+void
+WRATHTextData::
+decode_utf8(const uint8_t *begin, const uint8_t *end,
+            std::vector<uint32_t> &out_codes)
+{
+  decode_utf8_implement(begin, end, out_codes);
+}
@@ -190,6 +190,74 @@ append(WRATHTextData::character C)
     }
 }
 
+void
+WRATHTextDataStream::
+append_utf8(const uint8_t *begin, const uint8_t *end)
+{
+  if(begin==end)
+    {
+      return;
+    }
+
+  if(m_cap.back()==WRATHText::capitalization_as_in_stream)
+    {
+      /*
+        no conversion needed, decode
+        straight into m_raw_text
+       */
+      flush_streams();
+      m_raw_text.append_utf8(begin, end);
+    }
+  else
+    {
+      /*
+        decode into the append stream so that the
+        capitalization is applied at flush just
+        as for append()
+       */
+      if(m_current_stream!=&m_append_stream)
+        {
+          flush_streams();
+          m_current_stream=&m_append_stream;
+        }
+      WRATHTextData::decode_utf8(begin, end, m_append_stream.m_data);
+    }
+  m_format_dirty=true;
+}
+
+void
+WRATHTextDataStream::
+append_utf32(const uint32_t *begin, const uint32_t *end)
+{
+  if(begin==end)
+    {
+      return;
+    }
+
+  if(m_cap.back()==WRATHText::capitalization_as_in_stream)
+    {
+      flush_streams();
+      m_raw_text.append_utf32(begin, end);
+    }
+  else
+    {
+      if(m_current_stream!=&m_append_stream)
+        {
+          flush_streams();
+          m_current_stream=&m_append_stream;
+        }
+      /*
+        mask the leading bit as append()
+        does via WRATHTextData::character
+       */
+      for(; begin!=end; ++begin)
+        {
+          m_append_stream.m_data.push_back(*begin&~(1u<<31));
+        }
+    }
+  m_format_dirty=true;
+}
+
 void
 WRATHTextDataStream::
 clear(void)
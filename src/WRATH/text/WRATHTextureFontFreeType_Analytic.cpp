@@ -21,12 +21,14 @@
 #include "WRATHConfig.hpp"
 #include <sstream>
 #include <limits>
+#include <cmath>
 #include <boost/algorithm/string/predicate.hpp>
 #include <fstream>
 #include <iomanip>
 #include <boost/multi_array.hpp>
 #include <sys/time.h>
 #include "WRATHTextureFontFreeType_Analytic.hpp"
+#include "WRATHProfiler.hpp"
 #include "WRATHFreeTypeSupport.hpp"
 #include "WRATHUtil.hpp"
 #include "WRATHStaticInit.hpp"
@@ -263,6 +265,178 @@ namespace
   }
   
        
+  enum
+    {
+      /*
+        values of block_slots for blocks of the
+        index level that are realized by the
+        shared outside and inside texel, blocks
+        realized at full resolution have as value
+        their slot (starting at 1) in the data image,
+        slot 0 holds the shared texels.
+       */
+      coarse_outside_block=-1,
+      coarse_inside_block=-2
+    };
+
+  /*
+    classify the blocks of the index level,
+    a block can be realized by a single texel
+    only if neither the block nor the texels
+    bordering it have any curves, since the 
+    texels without curves that border texels
+    with curves get the lines of their neighbors
+    for anti-aliasing (see find_neighbors_for_empty_texels).
+    Returns the number of blocks that need to
+    be stored at full resolution.
+   */
+  int
+  compute_index_blocks(ivec2 glyph_size, int block_size,
+                       const boost::multi_array<bool, 2> &texel_is_unfilled,
+                       const boost::multi_array<bool, 2> &texel_is_inside,
+                       boost::multi_array<int, 2> &block_slots)
+  {
+    ivec2 number_blocks((glyph_size.x() + block_size - 1)/block_size,
+                        (glyph_size.y() + block_size - 1)/block_size);
+    int number_fine_blocks(0);
+
+    block_slots.resize(boost::extents[number_blocks.x()][number_blocks.y()]);
+    for(int by=0; by<number_blocks.y(); ++by)
+      {
+        for(int bx=0; bx<number_blocks.x(); ++bx)
+          {
+            int minx(std::max(0, bx*block_size - 1));
+            int miny(std::max(0, by*block_size - 1));
+            int maxx(std::min(glyph_size.x(), (bx+1)*block_size + 1));
+            int maxy(std::min(glyph_size.y(), (by+1)*block_size + 1));
+            bool coarse(true), inside(texel_is_inside[bx*block_size][by*block_size]);
+
+            for(int y=miny; y<maxy and coarse; ++y)
+              {
+                for(int x=minx; x<maxx and coarse; ++x)
+                  {
+                    coarse=texel_is_unfilled[x][y]
+                      and texel_is_inside[x][y]==inside;
+                  }
+              }
+
+            if(coarse)
+              {
+                block_slots[bx][by]=(inside)?
+                  coarse_inside_block:
+                  coarse_outside_block;
+              }
+            else
+              {
+                ++number_fine_blocks;
+                block_slots[bx][by]=number_fine_blocks;
+              }
+          }
+      }
+    return number_fine_blocks;
+  }
+
+  /*
+    returns the number of blocks in each
+    dimension of the data image of a glyph
+    with the index level, the slots of the
+    blocks are in row-major order.
+   */
+  ivec2
+  index_data_blocks(int number_fine_blocks)
+  {
+    int number_slots(number_fine_blocks+1), columns;
+
+    columns=static_cast<int>(std::ceil(std::sqrt(static_cast<float>(number_slots))));
+    return ivec2(columns, (number_slots + columns - 1)/columns);
+  }
+
+  void
+  build_glyph_glsl(WRATHTextureFont::GlyphGLSL &glyph_glsl, bool indexed)
+  {
+    /*
+      only GLES2 requires the LA lookup.
+    */
+    #if defined(WRATH_GLES_VERSION) && WRATH_GLES_VERSION==2
+    {  
+      for(unsigned int i=0; i<WRATHTextureFont::GlyphGLSL::num_linearity_types; ++i)
+        {
+          glyph_glsl.m_fragment_processor[i].add_macro("WRATH_FONT_USE_LA_LOOKUP");
+        }
+    }
+    #endif
+
+    if(indexed)
+      {
+        for(unsigned int i=0; i<WRATHTextureFont::GlyphGLSL::num_linearity_types; ++i)
+          {
+            glyph_glsl.m_vertex_processor[i]
+              .add_macro("WRATH_FONT_ANALYTIC_INDEXED");
+
+            glyph_glsl.m_fragment_processor[i]
+              .add_macro("WRATH_FONT_ANALYTIC_INDEXED")
+              .add_macro("WRATH_FONT_ANALYTIC_INDEX_BLOCK_SIZE", 
+                         static_cast<int>(WRATHTextureFontFreeType_Analytic::index_block_size));
+          }
+      }
+
+    /*
+      reciprocal texture size, and with the
+      index level the reciprocal size of
+      the data texture
+    */
+    glyph_glsl.m_texture_page_data_size=(indexed)?4:2;
+
+    glyph_glsl.m_vertex_processor[WRATHTextureFont::GlyphGLSL::linear_glyph_position]
+      .add_source("font_analytic_linear.vert.wrath-shader.glsl",
+                  WRATHGLShader::from_resource);
+
+    glyph_glsl.m_fragment_processor[WRATHTextureFont::GlyphGLSL::linear_glyph_position]
+      .add_source("font_analytic_base.frag.wrath-shader.glsl", WRATHGLShader::from_resource)
+      .add_source("font_analytic_linear.frag.wrath-shader.glsl", WRATHGLShader::from_resource);
+
+    glyph_glsl.m_vertex_processor[WRATHTextureFont::GlyphGLSL::nonlinear_glyph_position]
+      .add_source("font_analytic_nonlinear.vert.wrath-shader.glsl",
+                  WRATHGLShader::from_resource);
+
+    glyph_glsl.m_fragment_processor[WRATHTextureFont::GlyphGLSL::nonlinear_glyph_position]
+      .add_source("font_analytic_base.frag.wrath-shader.glsl", WRATHGLShader::from_resource)
+      .add_source("font_analytic_nonlinear.frag.wrath-shader.glsl", WRATHGLShader::from_resource);
+
+    #if defined(WRATH_GLES_VERSION) && WRATH_GLES_VERSION==2
+    {  
+      for(unsigned int i=0; i<WRATHTextureFont::GlyphGLSL::num_linearity_types; ++i)
+        {
+          glyph_glsl.m_fragment_processor[i].remove_macro("WRATH_FONT_USE_LA_LOOKUP");
+        }
+    }
+    #endif
+
+    if(indexed)
+      {
+        for(unsigned int i=0; i<WRATHTextureFont::GlyphGLSL::num_linearity_types; ++i)
+          {
+            glyph_glsl.m_vertex_processor[i]
+              .remove_macro("WRATH_FONT_ANALYTIC_INDEXED");
+
+            glyph_glsl.m_fragment_processor[i]
+              .remove_macro("WRATH_FONT_ANALYTIC_INDEXED")
+              .remove_macro("WRATH_FONT_ANALYTIC_INDEX_BLOCK_SIZE");
+          }
+        glyph_glsl.m_sampler_names.push_back("wrath_AnalyticIndexTexture");
+      }
+
+    glyph_glsl.m_sampler_names.push_back("wrath_AnalyticNormalTexture");
+    glyph_glsl.m_sampler_names.push_back("wrath_AnalyticPositionTexture");
+    glyph_glsl.m_global_names.push_back("wrath_analytic_font_compute_distance");
+    glyph_glsl.m_global_names.push_back("wrath_AnalyticTexCoord_Position");
+    glyph_glsl.m_global_names.push_back("wrath_AnalyticBottomLeft");
+    if(indexed)
+      {
+        glyph_glsl.m_global_names.push_back("wrath_analytic_font_texture_coordinate");
+      }
+  }
+       
   class common_analytic_texture_data:boost::noncopyable
   {
   public:
@@ -270,16 +444,18 @@ namespace
     ~common_analytic_texture_data();
 
     const WRATHTextureFont::GlyphGLSL*
-    glyph_glsl(void);
+    glyph_glsl(bool indexed);
 
     WRATHMutex m_mutex;
     WRATHImage::TextureAllocatorHandle m_allocator;
     bool m_generate_sub_quads;
+    bool m_indexed_generation;
     GLint m_texture_creation_size;
     unsigned int m_mipmap_level;
 
   private:
     WRATHTextureFont::GlyphGLSL m_glyph_glsl;
+    WRATHTextureFont::GlyphGLSL m_indexed_glyph_glsl;
   };
 
   common_analytic_texture_data&
@@ -294,16 +470,27 @@ namespace
   {
   public:
     explicit
-    local_glyph_data(WRATHImage *pImage):
-      m_image(pImage)
+    local_glyph_data(WRATHImage *pImage, WRATHImage *pDataImage=NULL):
+      m_image(pImage),
+      m_data_image(pDataImage)
     {}
 
     ~local_glyph_data()
     {
       WRATHDelete(m_image);
+      if(m_data_image!=NULL)
+        {
+          WRATHDelete(m_data_image);
+        }
     }
 
+    /*
+      with the index level, m_image is the
+      index image and m_data_image holds the
+      blocks of the glyph.
+     */
     WRATHImage *m_image;
+    WRATHImage *m_data_image;
   };
 
 }
@@ -313,6 +500,7 @@ namespace
 common_analytic_texture_data::
 common_analytic_texture_data(void):
   m_generate_sub_quads(false),
+  m_indexed_generation(false),
   m_texture_creation_size(1024),
   m_mipmap_level(0)
 {
@@ -371,52 +559,8 @@ common_analytic_texture_data(void):
    */
   m_allocator.set_clear_bits(fmt, values);
   
-  /*
-    only GLES2 requires the LA lookup.
-   */
-  #if defined(WRATH_GLES_VERSION) && WRATH_GLES_VERSION==2
-  {  
-    for(unsigned int i=0; i<WRATHTextureFont::GlyphGLSL::num_linearity_types; ++i)
-      {
-        m_glyph_glsl.m_fragment_processor[i].add_macro("WRATH_FONT_USE_LA_LOOKUP");
-      }
-  }
-  #endif
-
-
-  m_glyph_glsl.m_texture_page_data_size=2;
-
-  m_glyph_glsl.m_vertex_processor[WRATHTextureFont::GlyphGLSL::linear_glyph_position]
-    .add_source("font_analytic_linear.vert.wrath-shader.glsl",
-                WRATHGLShader::from_resource);
-
-  m_glyph_glsl.m_fragment_processor[WRATHTextureFont::GlyphGLSL::linear_glyph_position]
-    .add_source("font_analytic_base.frag.wrath-shader.glsl", WRATHGLShader::from_resource)
-    .add_source("font_analytic_linear.frag.wrath-shader.glsl", WRATHGLShader::from_resource);
-
-  m_glyph_glsl.m_vertex_processor[WRATHTextureFont::GlyphGLSL::nonlinear_glyph_position]
-    .add_source("font_analytic_nonlinear.vert.wrath-shader.glsl",
-                WRATHGLShader::from_resource);
-
-  m_glyph_glsl.m_fragment_processor[WRATHTextureFont::GlyphGLSL::nonlinear_glyph_position]
-    .add_source("font_analytic_base.frag.wrath-shader.glsl", WRATHGLShader::from_resource)
-    .add_source("font_analytic_nonlinear.frag.wrath-shader.glsl", WRATHGLShader::from_resource);
-
-  
-  #if defined(WRATH_GLES_VERSION) && WRATH_GLES_VERSION==2
-  {  
-    for(unsigned int i=0; i<WRATHTextureFont::GlyphGLSL::num_linearity_types; ++i)
-      {
-        m_glyph_glsl.m_fragment_processor[i].remove_macro("WRATH_FONT_USE_LA_LOOKUP");
-      }
-  }
-  #endif
-
-  m_glyph_glsl.m_sampler_names.push_back("wrath_AnalyticNormalTexture");
-  m_glyph_glsl.m_sampler_names.push_back("wrath_AnalyticPositionTexture");
-  m_glyph_glsl.m_global_names.push_back("wrath_analytic_font_compute_distance");
-  m_glyph_glsl.m_global_names.push_back("wrath_AnalyticTexCoord_Position");
-  m_glyph_glsl.m_global_names.push_back("wrath_AnalyticBottomLeft");
+  build_glyph_glsl(m_glyph_glsl, false);
+  build_glyph_glsl(m_indexed_glyph_glsl, true);
 }
 
 common_analytic_texture_data::
@@ -426,9 +570,11 @@ common_analytic_texture_data::
 
 const WRATHTextureFont::GlyphGLSL*
 common_analytic_texture_data::
-glyph_glsl(void)
+glyph_glsl(bool indexed)
 {
-  return  &m_glyph_glsl;
+  return (indexed)?
+    &m_indexed_glyph_glsl:
+    &m_glyph_glsl;
 }
 
   
@@ -439,8 +585,10 @@ WRATHTextureFontFreeType_Analytic(WRATHFreeTypeSupport::LockableFace::handle pfa
                                   const WRATHTextureFontKey &presource_name):
   WRATHTextureFontFreeTypeT<WRATHTextureFontFreeType_Analytic>(pface, presource_name),
   m_generate_sub_quads(generate_sub_quads()),
+  m_indexed(indexed_generation()),
   m_mipmap_level(mipmap_level()),
-  m_bytes_per_pixel(4, 4)
+  m_bytes_per_pixel(4, 4),
+  m_data_atlas_size(0, 0)
 {
   ctor_init();
   m_page_tracker.connect(boost::bind(&WRATHTextureFontFreeType_Analytic::on_create_texture_page, this,
@@ -496,6 +644,20 @@ ctor_init(void)
     }
 
   m_pow2_mipmap_level=static_cast<float>(1 << m_mipmap_level);
+
+  /*
+    the index level is not mipmapped, thus
+    is only used without mipmapping.
+   */
+  m_indexed=m_indexed and m_mipmap_level==0;
+  m_index_format
+    .format(0, WRATHImage::ImageFormat()
+            .pixel_data_format(GL_RGBA)
+            .pixel_type(GL_UNSIGNED_BYTE)
+            .internal_format(GL_RGBA)
+            .magnification_filter(GL_NEAREST)
+            .minification_filter(GL_NEAREST)
+            .automatic_mipmap_generation(false));
   
   std::string file_extension(WRATHUtil::filename_extension(simple_name()));
   m_is_ttf=boost::iequals(file_extension, "ttf");
@@ -514,7 +676,12 @@ WRATHTextureFontFreeType_Analytic::
             << glyph_data_stats()
             << " spread across " 
             << m_page_tracker.number_texture_pages()
-            << " pages\n";
+            << " pages, "
+            << m_memory_usage.m_number_glyphs << " glyphs take "
+            << m_memory_usage.m_full_layout_bytes << " bytes at full resolution and "
+            << m_memory_usage.m_indexed_layout_bytes << " bytes with index level"
+            << ((m_indexed)?" (used)":" (not used)")
+            << "\n";
 #endif
   
 }
@@ -549,6 +716,160 @@ allocate_glyph(std::vector< vecN<std::vector<uint8_t>, number_textures_per_page>
   return pImage;
 }
 
+void
+WRATHTextureFontFreeType_Analytic::
+allocate_indexed_glyph(vecN<c_array<uint8_t>, number_textures_per_page> analytic_pixel_data,
+                       const ivec2 &glyph_size,
+                       const boost::multi_array<int, 2> &block_slots,
+                       int number_fine_blocks,
+                       WRATHImage *&out_index_image,
+                       WRATHImage *&out_data_image)
+{
+  const int B(index_block_size);
+  ivec2 number_blocks(block_slots.shape()[0], block_slots.shape()[1]);
+  ivec2 data_blocks(0, 0), data_size(0, 0);
+  std::vector<uint8_t> index_data(4*number_blocks.x()*number_blocks.y());
+  ivec2 data_bl;
+
+  if(number_blocks.x()>0 and number_blocks.y()>0)
+    {
+      data_blocks=index_data_blocks(number_fine_blocks);
+      data_size=ivec2(B*data_blocks.x(), B*data_blocks.y());
+    }
+
+  out_data_image=WRATHNew WRATHImage(data_size, m_format,
+                                     WRATHImage::BoundarySize(),
+                                     common_data().m_allocator);
+
+  out_index_image=WRATHNew WRATHImage(number_blocks, m_index_format,
+                                      WRATHImage::BoundarySize(),
+                                      common_data().m_allocator);
+
+  if(number_blocks.x()<=0 or number_blocks.y()<=0)
+    {
+      return;
+    }
+
+  /*
+    slot 0 holds the shared texels, texel 0 is
+    outside and texel 1 is inside, the remaining
+    texels of the slot are never used.
+   */
+  {
+    std::vector<OutlineData::curve_segment> no_curves;
+    vecN<std::vector<uint8_t>, number_textures_per_page> block_data;
+    vecN<c_array<uint8_t>, number_textures_per_page> block_data_ptr;
+    bool dummy(false);
+
+    for(int layer=0; layer<number_textures_per_page; ++layer)
+      {
+        block_data[layer].resize(m_bytes_per_pixel[layer]*B*B);
+        block_data_ptr[layer]=block_data[layer];
+      }
+
+    for(int L=0; L<B*B; ++L)
+      {
+        pack_lines(ivec2(0, 0), L, no_curves, 0, 
+                   (L==1)?-1.0f:1.0f, 
+                   block_data_ptr, dummy);
+      }
+
+    for(int layer=0; layer<number_textures_per_page; ++layer)
+      {
+        out_data_image->respecify_sub_image(layer, 0,
+                                            m_format[layer].m_pixel_format,
+                                            block_data[layer],
+                                            ivec2(0, 0), ivec2(B, B), 4);
+      }
+  }
+
+  data_bl=out_data_image->minX_minY();
+  for(int by=0; by<number_blocks.y(); ++by)
+    {
+      for(int bx=0; bx<number_blocks.x(); ++bx)
+        {
+          int slot(block_slots[bx][by]);
+          ivec2 origin;
+          uint8_t fine;
+          int I(4*(bx + by*number_blocks.x()));
+
+          if(slot>0)
+            {
+              ivec2 slot_bl(B*(slot%data_blocks.x()), B*(slot/data_blocks.x()));
+              vecN<std::vector<uint8_t>, number_textures_per_page> block_data;
+
+              /*
+                respecify_sub_image() takes the contents
+                of the std::vector, so we need new 
+                std::vector's for each block.
+               */
+              for(int layer=0; layer<number_textures_per_page; ++layer)
+                {
+                  block_data[layer].resize(m_bytes_per_pixel[layer]*B*B);
+                }
+
+              /*
+                copy the texels of the block, texels
+                past the end of the glyph are never 
+                sampled, we set them as the
+                block's last texels.
+               */
+              for(int y=0; y<B; ++y)
+                {
+                  for(int x=0; x<B; ++x)
+                    {
+                      int src_x(std::min(glyph_size.x()-1, B*bx + x));
+                      int src_y(std::min(glyph_size.y()-1, B*by + y));
+                      int src(src_x + src_y*glyph_size.x());
+                      int dest(x + y*B);
+
+                      for(int layer=0; layer<number_textures_per_page; ++layer)
+                        {
+                          int bpp(m_bytes_per_pixel[layer]);
+                          std::copy(analytic_pixel_data[layer].c_ptr() + bpp*src,
+                                    analytic_pixel_data[layer].c_ptr() + bpp*(src+1),
+                                    block_data[layer].begin() + bpp*dest);
+                        }
+                    }
+                }
+
+              for(int layer=0; layer<number_textures_per_page; ++layer)
+                {
+                  out_data_image->respecify_sub_image(layer, 0,
+                                                      m_format[layer].m_pixel_format,
+                                                      block_data[layer],
+                                                      slot_bl, ivec2(B, B), 4);
+                }
+              origin=data_bl + slot_bl;
+              fine=255;
+            }
+          else
+            {
+              origin=data_bl + ivec2((slot==coarse_inside_block)?1:0, 0);
+              fine=0;
+            }
+
+          /*
+            index texel packing:
+             .r = low 8 bits of origin.x
+             .g = low 8 bits of origin.y
+             .b = high 4 bits of origin.x + 16*(high 4 bits of origin.y)
+             .a = 255 if block is at full resolution, 0 otherwise
+           */
+          WRATHassert(origin.x()<4096 and origin.y()<4096);
+          index_data[I+0]=static_cast<uint8_t>(origin.x()&0xFF);
+          index_data[I+1]=static_cast<uint8_t>(origin.y()&0xFF);
+          index_data[I+2]=static_cast<uint8_t>((origin.x()>>8) + 16*(origin.y()>>8));
+          index_data[I+3]=fine;
+        }
+    }
+
+  out_index_image->respecify_sub_image(0, 0,
+                                       m_index_format[0].m_pixel_format,
+                                       index_data,
+                                       ivec2(0, 0), number_blocks, 4);
+}
+
 
 void
 WRATHTextureFontFreeType_Analytic::
@@ -600,6 +921,7 @@ WRATHTextureFont::glyph_data_type*
 WRATHTextureFontFreeType_Analytic::
 generate_character(WRATHTextureFont::glyph_index_type G)
 {
+  WRATHProfileZone("WRATHTextureFontFreeType_Analytic::generate_character");
   ivec2 pos, bitmap_sz, bitmap_offset, glyph_size;
   character_code_type C;
   ivec2 iadvance;
@@ -687,6 +1009,9 @@ generate_character(WRATHTextureFont::glyph_index_type G)
   boost::multi_array<int, 2> covered;
   boost::multi_array<bool, 2> no_intersection_texel_is_full_table(boost::extents[glyph_size.x()][glyph_size.y()]);
   boost::multi_array<bool, 2> texel_is_unfilled(boost::extents[glyph_size.x()][glyph_size.y()]);
+  boost::multi_array<bool, 2> texel_is_inside(boost::extents[glyph_size.x()][glyph_size.y()]);
+  boost::multi_array<int, 2> block_slots;
+  int number_fine_blocks;
   
                                                
 
@@ -777,6 +1102,7 @@ generate_character(WRATHTextureFont::glyph_index_type G)
           L=x + y*glyph_size.x();
 
           texel_is_unfilled[x][y]=(curves_used==0);
+          texel_is_inside[x][y]=(far_away_offset<0.0f);
           pack_lines(ivec2(x,y), L, ncts, curves_used, far_away_offset,
                      analytic_pixel_data[0], no_intersection_texel_is_full);
            
@@ -789,6 +1115,17 @@ generate_character(WRATHTextureFont::glyph_index_type G)
           
         } //of for(x=...)
     } //of for(y=...)
+
+  /*
+    the blocks of the index level need to be computed
+    before the empty texels get the lines of their
+    neighbors, we compute them even when the index
+    level is not used for memory_usage().
+   */
+  number_fine_blocks=compute_index_blocks(glyph_size, index_block_size,
+                                          texel_is_unfilled, texel_is_inside,
+                                          block_slots);
+
   find_neighbors_for_empty_texels(glyph_size, m_bytes_per_pixel,
                                   texel_is_unfilled,
                                   analytic_pixel_data[0]);
@@ -890,19 +1227,66 @@ generate_character(WRATHTextureFont::glyph_index_type G)
 
 
   
-  WRATHImage *glyph_image;
+  WRATHImage *glyph_image, *data_image(NULL);
   glyph_data_type *return_value;
+  int texture_page;
 
-  glyph_image=allocate_glyph(packed_analytic_pixel_data, 
-                             glyph_size);
+  {
+    size_t full_bytes(0), indexed_bytes(0);
+    int texel_bytes(m_bytes_per_pixel[0] + m_bytes_per_pixel[1]);
+
+    for(unsigned int LOD=0; LOD<num_levels_total; ++LOD)
+      {
+        full_bytes+=texel_bytes*(glyph_size.x()>>LOD)*(glyph_size.y()>>LOD);
+      }
+
+    if(block_slots.num_elements()>0)
+      {
+        ivec2 data_blocks(index_data_blocks(number_fine_blocks));
+
+        indexed_bytes=4*block_slots.num_elements()
+          + texel_bytes*index_block_size*index_block_size*data_blocks.x()*data_blocks.y();
+      }
+
+    WRATHAutoLockMutex(m_mutex);
+    ++m_memory_usage.m_number_glyphs;
+    m_memory_usage.m_full_layout_bytes+=full_bytes;
+    m_memory_usage.m_indexed_layout_bytes+=indexed_bytes;
+  }
+
+  if(m_indexed)
+    {
+      allocate_indexed_glyph(analytic_pixel_data[0], glyph_size,
+                             block_slots, number_fine_blocks,
+                             glyph_image, data_image);
+
+      /*
+        the texture page is keyed by the index and
+        data textures, on_create_texture_page()
+        needs the atlas size of the data image 
+        too which it gets from m_data_atlas_size.
+       */
+      vecN<WRATHImage*, 1> additional_images(data_image);
+      
+      WRATHLockMutex(m_mutex);
+      m_data_atlas_size=data_image->atlas_size();
+      texture_page=m_page_tracker.get_page_number(glyph_image, additional_images);
+      WRATHUnlockMutex(m_mutex);
+    }
+  else
+    {
+      glyph_image=allocate_glyph(packed_analytic_pixel_data, 
+                                 glyph_size);
+      texture_page=m_page_tracker.get_page_number(glyph_image);
+    }
 
-  return_value=WRATHNew local_glyph_data(glyph_image);
+  return_value=WRATHNew local_glyph_data(glyph_image, data_image);
   glyph_data_type &glyph(*return_value);
 
   glyph
     .font(this)
     .iadvance(iadvance)
-    .texture_page(m_page_tracker.get_page_number(glyph_image))
+    .texture_page(texture_page)
     .texel_values(glyph_image->minX_minY(), bitmap_sz)
     .origin( vec2(bitmap_offset) + vec2(float(-outline_data.internal_offset())/64.0f))
     .bounding_box_size(bitmap_sz)
@@ -1108,23 +1492,38 @@ WRATHTextureFontFreeType_Analytic::
 on_create_texture_page(ivec2 texture_size,
                        std::vector<float> &custom_data)
 {
-  custom_data.resize(2);
+  custom_data.resize(texture_page_data_size());
   custom_data[0]=1.0f/static_cast<float>(std::max(1, texture_size.x()) );
   custom_data[1]=1.0f/static_cast<float>(std::max(1, texture_size.y()) );
+
+  if(m_indexed)
+    {
+      /*
+        called from get_page_number() with m_mutex
+        locked by generate_character().
+       */
+      custom_data[2]=1.0f/static_cast<float>(std::max(1, m_data_atlas_size.x()) );
+      custom_data[3]=1.0f/static_cast<float>(std::max(1, m_data_atlas_size.y()) );
+    }
 }
 
 int
 WRATHTextureFontFreeType_Analytic::
 texture_page_data_size(void) const
 {
-  return 2; //reciprocal texture size
+  /*
+    reciprocal texture size, with the index level
+    the reciprocal index texture size followed
+    by the reciprocal data texture size
+   */
+  return (m_indexed)?4:2;
 }
 
 float
 WRATHTextureFontFreeType_Analytic::
 texture_page_data(int texture_page, int idx) const
 {
-  return (0<=idx and idx<2)?
+  return (0<=idx and idx<texture_page_data_size())?
     m_page_tracker.custom_data(texture_page)[idx]:
     0;
 }
@@ -1140,7 +1539,7 @@ const WRATHTextureFont::GlyphGLSL*
 WRATHTextureFontFreeType_Analytic::
 glyph_glsl(void)
 {
-  return common_data().glyph_glsl();
+  return common_data().glyph_glsl(m_indexed);
 }
 
 GLint
@@ -1177,6 +1576,30 @@ generate_sub_quads(bool v)
   common_data().m_generate_sub_quads=v;
 }
 
+bool
+WRATHTextureFontFreeType_Analytic::
+indexed_generation(void)
+{
+  WRATHAutoLockMutex(common_data().m_mutex);
+  return common_data().m_indexed_generation;
+}
+
+void
+WRATHTextureFontFreeType_Analytic::
+indexed_generation(bool v)
+{
+  WRATHAutoLockMutex(common_data().m_mutex);
+  common_data().m_indexed_generation=v;
+}
+
+WRATHTextureFontFreeType_Analytic::memory_usage_type
+WRATHTextureFontFreeType_Analytic::
+memory_usage(void)
+{
+  WRATHAutoLockMutex(m_mutex);
+  return m_memory_usage;
+}
+
 void
 WRATHTextureFontFreeType_Analytic::
 mipmap_level(unsigned int N)
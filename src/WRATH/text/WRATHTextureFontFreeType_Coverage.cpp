@@ -26,6 +26,7 @@
 #include <iomanip>
 #include <boost/multi_array.hpp>
 #include "WRATHTextureFontFreeType_Coverage.hpp"
+#include "WRATHProfiler.hpp"
 #include "WRATHUtil.hpp"
 #include "WRATHglGet.hpp"
 #include "c_array.hpp"
@@ -65,7 +66,10 @@ namespace
       m_texture_creation_size(1024),
       m_force_power2_texture(true),
       m_magnification_filter(GL_LINEAR),
-      m_minification_filter(GL_LINEAR_MIPMAP_NEAREST)
+      m_minification_filter(GL_LINEAR_MIPMAP_NEAREST),
+      m_mipmap_generation(WRATHTextureFontFreeType_Coverage::render_each_mipmap_level),
+      m_downsample_tolerance(12),
+      m_downsample_check_glyph_count(32)
     {
       m_allocator=WRATHImage::create_texture_allocator(true, m_texture_creation_size);
 
@@ -102,6 +106,9 @@ namespace
     bool m_force_power2_texture;
     GLenum m_magnification_filter;
     GLenum m_minification_filter;
+    enum WRATHTextureFontFreeType_Coverage::mipmap_generation_type m_mipmap_generation;
+    int m_downsample_tolerance;
+    int m_downsample_check_glyph_count;
     WRATHImage::TextureAllocatorHandle m_allocator;
     WRATHTextureFont::GlyphGLSL m_glyph_glsl;
   };
@@ -180,7 +187,51 @@ create_pixel_data(ivec2 sz)
     }
 }
 
+void
+WRATHTextureFontFreeType_Coverage::glyph_mipmap_level::
+downsample(const glyph_mipmap_level &src)
+{
+  m_size=src.m_size/2;
+  if(m_size.x()<=0 or m_size.y()<=0)
+    {
+      m_size=ivec2(0,0);
+      m_pixels.clear();
+      return;
+    }
+
+  m_pixels.resize(m_size.x()*m_size.y());
+  for(int yy=0; yy<m_size.y(); ++yy)
+    {
+      const uint8_t *row0(&src.m_pixels[2*yy*src.m_size.x()]);
+      const uint8_t *row1(row0 + src.m_size.x());
+      uint8_t *dst(&m_pixels[yy*m_size.x()]);
+
+      /*
+        kept as a plain loop over a row so
+        that the compiler can vectorize it.
+       */
+      for(int xx=0; xx<m_size.x(); ++xx)
+        {
+          unsigned int sum;
+
+          sum=row0[2*xx] + row0[2*xx+1] + row1[2*xx] + row1[2*xx+1];
+          dst[xx]=static_cast<uint8_t>((sum+2u)>>2u);
+        }
+    }
+}
 
+void
+WRATHTextureFontFreeType_Coverage::glyph_mipmap_level::
+accumulate_difference(const glyph_mipmap_level &rendered,
+                      int64_t &sum, int &count) const
+{
+  WRATHassert(rendered.m_size==m_size);
+  for(unsigned int i=0, end_i=m_pixels.size(); i<end_i; ++i)
+    {
+      sum+=std::abs(static_cast<int>(m_pixels[i]) - static_cast<int>(rendered.m_pixels[i]));
+    }
+  count+=m_pixels.size();
+}
 
 
 
@@ -195,6 +246,12 @@ WRATHTextureFontFreeType_Coverage(WRATHFreeTypeSupport::LockableFace::handle pfa
   m_magnification_filter(magnification_filter()),
   m_use_mipmaps(WRATHImage::ImageFormat::requires_mipmaps(m_minification_filter)),
   m_mipmap_deepness_concern(mipmap_slacking_threshhold_level()),
+  m_mipmap_generation(mipmap_generation()),
+  m_downsample_tolerance(downsample_tolerance()),
+  m_downsample_check_glyph_count(downsample_check_glyph_count()),
+  m_downsample_glyphs_checked(0),
+  m_downsample_pixels_checked(0),
+  m_downsample_difference(0),
 
   m_total_pixel_waste(0),
   m_total_pixel_use(0)
@@ -343,14 +400,20 @@ WRATHTextureFontFreeType_Coverage::glyph_data_type*
 WRATHTextureFontFreeType_Coverage::
 generate_character(WRATHTextureFont::glyph_index_type G)
 {
+  WRATHProfileZone("WRATHTextureFontFreeType_Coverage::generate_character");
   ivec2 bitmap_sz, bitmap_offset, glyph_size(0,0);
   ivec2 iadvance;
   ivec2 slack_added(0,0);
   character_code_type C;
   int slack(0);
   std::vector<glyph_mipmap_level> mipmaps;
+  enum mipmap_generation_type mode;
+  bool check_downsample(false);
+  glyph_mipmap_level rendered_level1;
 
   WRATHLockMutex(ttf_face()->mutex());
+
+  mode=m_mipmap_generation;
   
   FT_Set_Pixel_Sizes(ttf_face()->face(), pixel_size(), pixel_size());
       
@@ -392,26 +455,59 @@ generate_character(WRATHTextureFont::glyph_index_type G)
       max_deepness=m_mipmap_deepness_concern+1;
       mipmaps[0].take_bitmap_data(ttf_face()->face());
 
-      for(deepness=1, h=(pixel_size()>>1);
-          (ttf_face()->face()->glyph->bitmap.width>4 
-           or ttf_face()->face()->glyph->bitmap.rows>4)
-            and deepness<max_deepness and deepness<mipmaps.size() and h>=8; ++deepness, h>>=1)
+      if(mode==downsample_mipmap_levels)
         {
-          
+          ivec2 level_sz(bitmap_sz);
+
           /*
-            there are two different ways one can render the
-            glyph at a lower resolution: by changing the
-            pixel size or by setting the transform via
-            FT_Set_Transform. We get a better render 
-            results if we use FT_Set_Pixel_Sizes().
-          */
-          FT_Set_Pixel_Sizes(ttf_face()->face(), h, 0);
-          FT_Load_Glyph(ttf_face()->face(), G.value(), FT_LOAD_DEFAULT);
-          FT_Render_Glyph(ttf_face()->face()->glyph, FT_RENDER_MODE_NORMAL);
-        
-          /* copy raw bitmap data to mipmaps[deepness] */
-          mipmaps[deepness].take_bitmap_data(ttf_face()->face());
+            same choice of deepness as when rendering
+            each level, but the size of each level
+            is computed instead of rendered.
+           */
+          for(deepness=1, h=(pixel_size()>>1);
+              (level_sz.x()>4 or level_sz.y()>4)
+                and deepness<max_deepness and deepness<mipmaps.size() and h>=8; ++deepness, h>>=1)
+            {
+              level_sz=(level_sz+ivec2(1,1))/2;
+            }
 
+          /*
+            render level 1 of the first glyphs to
+            check the downsampled level against.
+           */
+          check_downsample=(mipmaps.size()>1 
+                            and m_downsample_tolerance>=0
+                            and m_downsample_glyphs_checked<m_downsample_check_glyph_count);
+          if(check_downsample)
+            {
+              FT_Set_Pixel_Sizes(ttf_face()->face(), pixel_size()>>1, 0);
+              FT_Load_Glyph(ttf_face()->face(), G.value(), FT_LOAD_DEFAULT);
+              FT_Render_Glyph(ttf_face()->face()->glyph, FT_RENDER_MODE_NORMAL);
+              rendered_level1.take_bitmap_data(ttf_face()->face());
+            }
+        }
+      else
+        {
+          for(deepness=1, h=(pixel_size()>>1);
+              (ttf_face()->face()->glyph->bitmap.width>4 
+               or ttf_face()->face()->glyph->bitmap.rows>4)
+                and deepness<max_deepness and deepness<mipmaps.size() and h>=8; ++deepness, h>>=1)
+            {
+              
+              /*
+                there are two different ways one can render the
+                glyph at a lower resolution: by changing the
+                pixel size or by setting the transform via
+                FT_Set_Transform. We get a better render 
+                results if we use FT_Set_Pixel_Sizes().
+              */
+              FT_Set_Pixel_Sizes(ttf_face()->face(), h, 0);
+              FT_Load_Glyph(ttf_face()->face(), G.value(), FT_LOAD_DEFAULT);
+              FT_Render_Glyph(ttf_face()->face()->glyph, FT_RENDER_MODE_NORMAL);
+              
+              /* copy raw bitmap data to mipmaps[deepness] */
+              mipmaps[deepness].take_bitmap_data(ttf_face()->face());
+            }
         }
 
       int scale_factor;
@@ -426,24 +522,33 @@ generate_character(WRATHTextureFont::glyph_index_type G)
           slack=1;
         }
 
-      glyph_size=ivec2(slack,slack)
-        + scale_factor*ivec2(ttf_face()->face()->glyph->bitmap.width,
-                             ttf_face()->face()->glyph->bitmap.rows);
-      
-      
-     
-      for(int mm=deepness, end_mm=mipmaps.size(); mm<end_mm; ++mm)
+      if(mode==downsample_mipmap_levels)
         {
-          
-          FT_Set_Pixel_Sizes(ttf_face()->face(), pixel_size()>>mm, pixel_size()>>mm);
-          FT_Load_Glyph(ttf_face()->face(), G.value(), FT_LOAD_DEFAULT);
-          FT_Render_Glyph(ttf_face()->face()->glyph, FT_RENDER_MODE_NORMAL);
-
-          /* copy raw bitmap data to mipmaps[deepness] */
-          mipmaps[mm].take_bitmap_data(ttf_face()->face());    
-          
+          /*
+            round up the size to a multiple of scale_factor
+            so that the levels up to deepness are exact
+            downsamples of the base level.
+           */
+          glyph_size=ivec2(slack,slack)
+            + scale_factor*((bitmap_sz + ivec2(scale_factor-1, scale_factor-1))/scale_factor);
+        }
+      else
+        {
+          glyph_size=ivec2(slack,slack)
+            + scale_factor*ivec2(ttf_face()->face()->glyph->bitmap.width,
+                                 ttf_face()->face()->glyph->bitmap.rows);
+      
+          for(int mm=deepness, end_mm=mipmaps.size(); mm<end_mm; ++mm)
+            {
+              
+              FT_Set_Pixel_Sizes(ttf_face()->face(), pixel_size()>>mm, pixel_size()>>mm);
+              FT_Load_Glyph(ttf_face()->face(), G.value(), FT_LOAD_DEFAULT);
+              FT_Render_Glyph(ttf_face()->face()->glyph, FT_RENDER_MODE_NORMAL);
+              
+              /* copy raw bitmap data to mipmaps[deepness] */
+              mipmaps[mm].take_bitmap_data(ttf_face()->face());    
+            }
         }
-
         
       slack_added=glyph_size-bitmap_sz;   
     }
@@ -462,13 +567,41 @@ generate_character(WRATHTextureFont::glyph_index_type G)
 
       if(m==0)
         {
-          sz=glyph_size;
+          mipmaps[m].create_pixel_data(glyph_size);
+        }
+      else if(mode==downsample_mipmap_levels)
+        {
+          mipmaps[m].downsample(mipmaps[m-1]);
         }
       else
         {
           sz=mipmaps[m-1].size()/2;
+          mipmaps[m].create_pixel_data(sz);
+        }
+    }
+
+  if(check_downsample)
+    {
+      int64_t difference(0);
+      int count(0);
+
+      /*
+        laid out as render_each_mipmap_level
+        lays out level 1.
+       */
+      rendered_level1.create_pixel_data(mipmaps[1].size());
+      mipmaps[1].accumulate_difference(rendered_level1, difference, count);
+
+      WRATHAutoLockMutex(ttf_face()->mutex());
+      m_downsample_difference+=difference;
+      m_downsample_pixels_checked+=count;
+      ++m_downsample_glyphs_checked;
+      if(m_downsample_glyphs_checked>=m_downsample_check_glyph_count
+         and m_mipmap_generation==downsample_mipmap_levels
+         and m_downsample_difference>static_cast<int64_t>(m_downsample_tolerance)*m_downsample_pixels_checked)
+        {
+          m_mipmap_generation=render_each_mipmap_level;
         }
-      mipmaps[m].create_pixel_data(sz);
     }
 
 
@@ -596,6 +729,80 @@ mipmap_slacking_threshhold_level(int v)
 }
 
 
+enum WRATHTextureFontFreeType_Coverage::mipmap_generation_type
+WRATHTextureFontFreeType_Coverage:: 
+mipmap_generation(void)
+{
+  WRATHAutoLockMutex(common_data().m_mutex);
+  return common_data().m_mipmap_generation;
+}
+
+void
+WRATHTextureFontFreeType_Coverage:: 
+mipmap_generation(enum mipmap_generation_type v)
+{
+  WRATHAutoLockMutex(common_data().m_mutex);
+  common_data().m_mipmap_generation=v;
+}
+
+int
+WRATHTextureFontFreeType_Coverage:: 
+downsample_tolerance(void)
+{
+  WRATHAutoLockMutex(common_data().m_mutex);
+  return common_data().m_downsample_tolerance;
+}
+
+void
+WRATHTextureFontFreeType_Coverage:: 
+downsample_tolerance(int v)
+{
+  WRATHAutoLockMutex(common_data().m_mutex);
+  common_data().m_downsample_tolerance=v;
+}
+
+int
+WRATHTextureFontFreeType_Coverage:: 
+downsample_check_glyph_count(void)
+{
+  WRATHAutoLockMutex(common_data().m_mutex);
+  return common_data().m_downsample_check_glyph_count;
+}
+
+void
+WRATHTextureFontFreeType_Coverage:: 
+downsample_check_glyph_count(int v)
+{
+  WRATHAutoLockMutex(common_data().m_mutex);
+  common_data().m_downsample_check_glyph_count=v;
+}
+
+enum WRATHTextureFontFreeType_Coverage::mipmap_generation_type
+WRATHTextureFontFreeType_Coverage:: 
+font_mipmap_generation(void)
+{
+  WRATHAutoLockMutex(ttf_face()->mutex());
+  return m_mipmap_generation;
+}
+
+float
+WRATHTextureFontFreeType_Coverage:: 
+mean_downsample_difference(void)
+{
+  WRATHAutoLockMutex(ttf_face()->mutex());
+  return (m_downsample_pixels_checked>0)?
+    static_cast<float>(m_downsample_difference)/static_cast<float>(m_downsample_pixels_checked):
+    0.0f;
+}
+
+int
+WRATHTextureFontFreeType_Coverage:: 
+number_downsample_checked_glyphs(void)
+{
+  WRATHAutoLockMutex(ttf_face()->mutex());
+  return m_downsample_glyphs_checked;
+}
+
 
 WRATHImage::TextureAllocatorHandle::texture_consumption_data_type
 WRATHTextureFontFreeType_Coverage::
@@ -20,6 +20,7 @@
 
 #include "WRATHConfig.hpp"
 #include "WRATHTextureFontFreeType_CurveAnalytic.hpp"
+#include "WRATHProfiler.hpp"
 #include "WRATHPolynomial.hpp"
 #include "WRATHStaticInit.hpp"
 #include <map>
@@ -3418,6 +3419,7 @@ WRATHTextureFont::glyph_data_type*
 WRATHTextureFontFreeType_CurveAnalytic::
 generate_character(WRATHTextureFont::glyph_index_type G)
 {
+  WRATHProfileZone("WRATHTextureFontFreeType_CurveAnalytic::generate_character");
   local_glyph_data_type *return_value(NULL);
   ivec2 glyph_advance;
   ivec2 bitmap_sz, bitmap_offset;
@@ -27,6 +27,7 @@
 #include <boost/multi_array.hpp>
 #include <sys/time.h>
 #include "WRATHTextureFontFreeType_DetailedCoverage.hpp"
+#include "WRATHProfiler.hpp"
 #include "WRATHUtil.hpp"
 #include "WRATHglGet.hpp"
 #include "c_array.hpp"
@@ -525,6 +526,7 @@ WRATHTextureFont::glyph_data_type*
 WRATHTextureFontFreeType_DetailedCoverage::
 generate_character(glyph_index_type G)
 {
+  WRATHProfileZone("WRATHTextureFontFreeType_DetailedCoverage::generate_character");
   std::vector<per_pixel_size_coverage_data> pixel_data(m_pixel_sizes.size());
   character_code_type C;
   ivec2 iadvance;
@@ -26,6 +26,7 @@
 #include <iomanip>
 #include <boost/multi_array.hpp>
 #include "WRATHTextureFontFreeType_Distance.hpp"
+#include "WRATHProfiler.hpp"
 #include "WRATHUtil.hpp"
 #include "WRATHglGet.hpp"
 #include "c_array.hpp"
@@ -268,6 +269,7 @@ WRATHTextureFont::glyph_data_type*
 WRATHTextureFontFreeType_Distance::
 generate_character(WRATHTextureFont::glyph_index_type G)
 {
+  WRATHProfileZone("WRATHTextureFontFreeType_Distance::generate_character");
   ivec2 bitmap_sz, bitmap_offset, glyph_size;
   ivec2 slack_added(0,0);
   std::vector<WRATHFreeTypeSupport::point_type> pts;
@@ -22,6 +22,56 @@ uniform mediump sampler2D wrath_AnalyticNormalTexture;
 uniform mediump sampler2D wrath_AnalyticPositionTexture;
 
 
+#ifdef WRATH_FONT_ANALYTIC_INDEXED
+
+uniform mediump sampler2D wrath_AnalyticIndexTexture;
+
+/*
+  IndexBottomLeft= location of the glyph in the index texture (in texels)
+  GlyphCoordinate= location within the glyph (in texels)
+
+  each texel of the index texture covers a block of
+  WRATH_FONT_ANALYTIC_INDEX_BLOCK_SIZE texels of the glyph,
+  it is packed as:
+   .r = low 8 bits of the x-coordinate of the block in the data textures
+   .g = low 8 bits of the y-coordinate of the block in the data textures
+   .b = high 4 bits of x-coordinate + 16*(high 4 bits of y-coordinate)
+   .a = 1.0 if the block is at full resolution, 0.0 if it is
+        a single texel
+
+  page data 0,1 = reciprocal size of the index texture
+  page data 2,3 = reciprocal size of the data textures
+  returns the texture coordinate to feed to
+  wrath_analytic_font_compute_distance
+ */
+mediump vec2
+wrath_analytic_font_texture_coordinate(in mediump vec2 IndexBottomLeft,
+                                       in mediump vec2 GlyphCoordinate)
+{
+  mediump float block_size, y_high;
+  mediump vec2 block, local, origin;
+  mediump vec4 I;
+
+  block_size=float(WRATH_FONT_ANALYTIC_INDEX_BLOCK_SIZE);
+  block=floor(GlyphCoordinate/block_size);
+  I=texture2D(wrath_AnalyticIndexTexture,
+              (IndexBottomLeft + block + vec2(0.5, 0.5))*vec2(wrath_font_page_data(0),
+                                                              wrath_font_page_data(1)));
+  I=floor(255.0*I + vec4(0.5, 0.5, 0.5, 0.5));
+
+  y_high=floor(I.b/16.0);
+  origin=I.rg + 256.0*vec2(I.b - 16.0*y_high, y_high);
+  local=(I.a>0.5)?
+    GlyphCoordinate - block_size*block:
+    vec2(0.5, 0.5);
+
+  return (origin + local)*vec2(wrath_font_page_data(2),
+                               wrath_font_page_data(3));
+}
+
+#endif
+
+
 
 #ifdef WRATH_FONT_ANALYTIC_PIXEL_RELATIVE_COORDINATES
 
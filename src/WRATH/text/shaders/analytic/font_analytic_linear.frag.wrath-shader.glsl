@@ -21,7 +21,11 @@
 
 shader_in mediump vec4 wrath_AnalyticTexCoord_Position;
 
+#if defined(WRATH_FONT_ANALYTIC_INDEXED)
+#define GlyphTextureCoordinate wrath_analytic_font_texture_coordinate(wrath_AnalyticTexCoord_Position.xy, wrath_AnalyticTexCoord_Position.zw)
+#else
 #define GlyphTextureCoordinate wrath_AnalyticTexCoord_Position.xy
+#endif
 #define GlyphCoordinate wrath_AnalyticTexCoord_Position.zw
 
 mediump float
@@ -23,12 +23,26 @@ void wrath_pre_compute_glyph(in vec2 glyph_position,
                              in vec2 glyph_bottom_left,
                              in vec2 glyph_size)
 {
-  mediump vec2 pp, glyph_texture_reciprocal_size;
+  wrath_AnalyticTexCoord_Position.zw=glyph_position;
 
-  pp=glyph_bottom_left + glyph_position;
-  glyph_texture_reciprocal_size=vec2(wrath_font_page_data(0),
-                                     wrath_font_page_data(1));
+  #if defined(WRATH_FONT_ANALYTIC_INDEXED)
+  {
+    /*
+      the texture coordinate is computed per fragment
+      from the index texture, see 
+      wrath_analytic_font_texture_coordinate
+     */
+    wrath_AnalyticTexCoord_Position.xy=glyph_bottom_left;
+  }
+  #else
+  {
+    mediump vec2 pp, glyph_texture_reciprocal_size;
 
-  wrath_AnalyticTexCoord_Position.zw=glyph_position;
-  wrath_AnalyticTexCoord_Position.xy=pp*glyph_texture_reciprocal_size;
+    pp=glyph_bottom_left + glyph_position;
+    glyph_texture_reciprocal_size=vec2(wrath_font_page_data(0),
+                                       wrath_font_page_data(1));
+
+    wrath_AnalyticTexCoord_Position.xy=pp*glyph_texture_reciprocal_size;
+  }
+  #endif
 }
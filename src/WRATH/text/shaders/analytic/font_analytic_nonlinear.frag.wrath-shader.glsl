@@ -22,11 +22,22 @@ shader_in mediump vec2 wrath_AnalyticBottomLeft;
 mediump float
 wrath_glyph_signed_distance(in vec2 glyph_position)
 {
-  mediump vec2 GlyphTextureCoordinate, glyph_texture_reciprocal_size;
+  mediump vec2 GlyphTextureCoordinate;
 
-  glyph_texture_reciprocal_size=vec2(wrath_font_page_data(0),
-                                     wrath_font_page_data(1));
-  GlyphTextureCoordinate=(glyph_position + wrath_AnalyticBottomLeft)*glyph_texture_reciprocal_size;
+  #if defined(WRATH_FONT_ANALYTIC_INDEXED)
+  {
+    GlyphTextureCoordinate=wrath_analytic_font_texture_coordinate(wrath_AnalyticBottomLeft,
+                                                                  glyph_position);
+  }
+  #else
+  {
+    mediump vec2 glyph_texture_reciprocal_size;
+
+    glyph_texture_reciprocal_size=vec2(wrath_font_page_data(0),
+                                       wrath_font_page_data(1));
+    GlyphTextureCoordinate=(glyph_position + wrath_AnalyticBottomLeft)*glyph_texture_reciprocal_size;
+  }
+  #endif
 
   return wrath_analytic_font_compute_distance(GlyphTextureCoordinate, 
                                               glyph_position);
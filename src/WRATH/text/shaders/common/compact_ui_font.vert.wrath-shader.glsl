@@ -0,0 +1,177 @@
+/*! 
+ * \file compact_ui_font.vert.wrath-shader.glsl
+ * \brief file compact_ui_font.vert.wrath-shader.glsl
+ * 
+ * Copyright 2013 by Nomovok Ltd.
+ * 
+ * Contact: info@nomovok.com
+ * 
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ * 
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ * 
+ */
+
+
+
+
+/*
+  Vertex shader to use with WRATHCompactTextAttributePacker.
+  Without WRATH_COMPACT_TEXT_INSTANCED, each glyph is drawn
+  as 4 vertices and the texel size and location of the glyph
+  are per-vertex attributes. With WRATH_COMPACT_TEXT_INSTANCED
+  (the packers of WRATHCompactTextAttributePacker::fetch_instanced()),
+  each glyph is one instance of 6 vertices (2 triangles), the
+  attributes are per-instance and the texel size and location 
+  of the glyph are read from a per-font table. Instancing
+  requires GL 3.3 or GLES3.
+ */
+
+/*pos meanings:
+ .xy: location before transformation of bottom left of glyph
+ .z : z-transformation the z value to feed to transformation matrix
+*/
+shader_in highp vec3 pos;
+
+
+/*
+  total scaling to apply to glyph, i.e.
+  the product of the scaling factor
+  and the stretching of the glyph
+  .x scaling in x
+  .y scaling in y
+ */
+shader_in highp vec2 glyph_scale;
+
+#if defined(WRATH_COMPACT_TEXT_INSTANCED)
+
+/*
+  location of the glyph within wrath_glyph_metrics:
+  .x: column, with 32768 added if the y-coordinate
+      increases downwards
+  .y: row
+ */
+shader_in highp vec2 glyph_table_location;
+
+/*
+  Color of each corner of the glyph, 
+  see simple_ui_font.vert.wrath-shader.glsl
+ */
+shader_in mediump vec4 color_bottom_left;
+shader_in mediump vec4 color_bottom_right;
+shader_in mediump vec4 color_top_right;
+shader_in mediump vec4 color_top_left;
+
+/*
+  table of the glyphs of the font, a texel is
+  .xy: glyph size in texels
+  .zw: bottom left corner in texel of glyph on texture page
+ */
+uniform highp usampler2D wrath_glyph_metrics;
+
+#else
+
+/*
+  size of glyph in _pixels_ on the texture holding the glyph
+  together with the corner of the glyph the vertex is:
+  .xy: glyph size in texels, with 32768 added to .x (resp. .y)
+       if the vertex is on the right (resp. top) of the glyph
+       and with 16384 added to .y if the y-coordinate increases
+       downwards
+  .zw: bottom left corner in texel of glyph on texture page
+ */
+shader_in highp vec4 glyph_size_and_bottom_left;
+
+/*
+  Color of the glyph, see simple_ui_font.vert.wrath-shader.glsl
+ */
+shader_in mediump vec4 color;
+
+#endif
+
+/*
+  color
+ */
+shader_out mediump vec4 tex_color;
+
+
+void
+shader_main(void)
+{
+  highp vec2 tpos, offset;
+  highp vec2 glyph_position, glyph_size, glyph_bottom_left, corner;
+  highp vec2 glyph_normalized_coordinate;
+  highp vec2 abs_glyph_normalized_coordinate, clipped_normalized;
+  highp float y_negative;
+
+  #if defined(WRATH_COMPACT_TEXT_INSTANCED)
+  {
+    highp int v;
+    highp uvec4 metrics;
+    highp vec2 location;
+
+    /*
+      the 6 vertices of an instance are the triangles
+      (0,0)-(1,0)-(1,1) and (0,0)-(1,1)-(0,1) of the 
+      quad of the glyph.
+     */
+    v=gl_VertexID;
+    corner=vec2((v==1 || v==2 || v==4)?1.0:0.0,
+                (v==2 || v==4 || v==5)?1.0:0.0);
+
+    y_negative=step(32768.0, glyph_table_location.x);
+    location=glyph_table_location - vec2(32768.0*y_negative, 0.0);
+    metrics=texelFetch(wrath_glyph_metrics, ivec2(location), 0);
+    glyph_size=vec2(metrics.xy);
+    glyph_bottom_left=vec2(metrics.zw);
+
+    tex_color=(corner.y<0.5)?
+      ((corner.x<0.5)?color_bottom_left:color_bottom_right):
+      ((corner.x<0.5)?color_top_left:color_top_right);
+  }
+  #else
+  {
+    //decode the corner of the glyph from the glyph size
+    corner=step(vec2(32768.0, 32768.0), glyph_size_and_bottom_left.xy);
+    glyph_size=glyph_size_and_bottom_left.xy - 32768.0*corner;
+    y_negative=step(16384.0, glyph_size.y);
+    glyph_size.y-=16384.0*y_negative;
+    glyph_bottom_left=glyph_size_and_bottom_left.zw;
+    tex_color=color;
+  }
+  #endif
+
+  glyph_normalized_coordinate=vec2(corner.x, corner.y*(1.0 - 2.0*y_negative));
+  
+  clipped_normalized=
+     compute_clipped_normalized_coordinate(glyph_normalized_coordinate,
+                                           pos.xy, 
+                                           glyph_size*glyph_scale);
+
+  abs_glyph_normalized_coordinate=abs(clipped_normalized);
+
+  //position of vertex inside of glyph
+  glyph_position=abs_glyph_normalized_coordinate*glyph_size;
+
+  wrath_font_prepare_glyph_vs(glyph_position,
+                              glyph_bottom_left,
+                              glyph_size);
+  
+  offset=clipped_normalized*glyph_size*glyph_scale;
+  tpos=pos.xy + offset;
+  gl_Position=compute_gl_position(vec3(tpos, pos.z));
+
+  #if defined(WRATH_APPLY_BRUSH_RELATIVE_TO_LETTER)
+  {
+    wrath_shader_brush_prepare(glyph_position);
+  }
+  #elif defined(WRATH_APPLY_BRUSH_RELATIVE_TO_ITEM)
+  {
+    wrath_shader_brush_prepare(tpos);    
+  }
+  #endif
+}
@@ -4,7 +4,7 @@ dirstack_$(sp)	:= $(d)
 d		:= $(dir)
 # End standard header
 
-LIB_SOURCES += $(call filelist,  WRATHReferenceCountedObject.cpp WRATHUtil.cpp WRATHPolynomial.cpp WRATHNew.cpp WRATHAtlas.cpp WRATHAtlasBase.cpp WRATH2DRigidTransformation.cpp WRATHResourceManager.cpp WRATHmalloc.cpp WRATHMutex.cpp WRATHTripleBufferEnabler.cpp WRATHStateStream.cpp WRATHStaticInit.cpp)
+LIB_SOURCES += $(call filelist,  WRATHReferenceCountedObject.cpp WRATHUtil.cpp WRATHPolynomial.cpp WRATHNew.cpp WRATHAtlas.cpp WRATHAtlasBase.cpp WRATH2DRigidTransformation.cpp WRATHResourceManager.cpp WRATHmalloc.cpp WRATHMutex.cpp WRATHActionQueue.cpp WRATHFrameSignal.cpp WRATHStableID.cpp WRATHProfiler.cpp WRATHSpatialIndex.cpp WRATHTripleBufferEnabler.cpp WRATHStateStream.cpp WRATHStaticInit.cpp WRATHParallelFor.cpp)
 
 # Begin standard footer
 d		:= $(dirstack_$(sp))
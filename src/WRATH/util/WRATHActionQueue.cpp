@@ -0,0 +1,390 @@
+/*! 
+ * \file WRATHActionQueue.cpp
+ * \brief file WRATHActionQueue.cpp
+ * 
+ * Copyright 2013 by Nomovok Ltd.
+ * 
+ * Contact: info@nomovok.com
+ * 
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ * 
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ * 
+ */
+
+
+#include "WRATHConfig.hpp"
+#include <string.h>
+#include <sched.h>
+#include <algorithm>
+#include "WRATHActionQueue.hpp"
+
+namespace
+{
+  /*
+    Spin for a short while and then yield,
+    used when waiting on a producer that has
+    reserved a record but not yet written it.
+   */
+  void
+  backoff(int &count)
+  {
+    if(count<64)
+      {
+        ++count;
+      }
+    else
+      {
+        sched_yield();
+      }
+  }
+}
+
+///////////////////////////////////////////
+// WRATHActionQueue::chunk methods
+WRATHActionQueue::chunk::
+chunk(void)
+{
+  reset();
+}
+
+void
+WRATHActionQueue::chunk::
+reset(void)
+{
+  /*
+    the consumer waits on record_header::m_state
+    becoming non-zero, thus the storage must be
+    zeroed before a chunk is reused.
+   */
+  memset(m_data, 0, chunk_size);
+  m_reserved=0;
+  m_next=NULL;
+}
+
+///////////////////////////////////////////
+// WRATHActionQueue methods
+WRATHActionQueue::
+WRATHActionQueue(void):
+  m_active_producers(0),
+  m_read(0)
+{
+  m_head=m_tail=WRATHNew chunk();
+}
+
+WRATHActionQueue::
+~WRATHActionQueue()
+{
+  /*
+    destroy, without executing, any actions
+    not yet executed. The dtor must only be
+    called when no thread is scheduling actions,
+    so all reserved records are published.
+   */
+  for(chunk *c=m_head; c!=NULL; )
+    {
+      uint32_t end;
+      chunk *n;
+
+      end=std::min(c->m_reserved, static_cast<uint32_t>(chunk_size));
+      while(m_read<end)
+        {
+          record_header *h(c->header(m_read));
+
+          if(h->m_state==record_end_of_chunk)
+            {
+              break;
+            }
+
+          if(h->m_state==record_action)
+            {
+              chunk::payload(h)->~base_action();
+            }
+          m_read+=h->m_size;
+        }
+
+      n=c->m_next;
+      WRATHDelete(c);
+      c=n;
+      m_read=0;
+    }
+
+  for(std::vector<chunk*>::iterator iter=m_retired.begin(),
+        end=m_retired.end(); iter!=end; ++iter)
+    {
+      WRATHDelete(*iter);
+    }
+
+  for(std::vector<chunk*>::iterator iter=m_free_chunks.begin(),
+        end=m_free_chunks.end(); iter!=end; ++iter)
+    {
+      WRATHDelete(*iter);
+    }
+}
+
+WRATHActionQueue::chunk*
+WRATHActionQueue::
+fetch_chunk(void)
+{
+  chunk *return_value(NULL);
+
+  WRATHLockMutex(m_free_chunks_mutex);
+  if(!m_free_chunks.empty())
+    {
+      return_value=m_free_chunks.back();
+      m_free_chunks.pop_back();
+    }
+  WRATHUnlockMutex(m_free_chunks_mutex);
+
+  if(return_value==NULL)
+    {
+      return_value=WRATHNew chunk();
+    }
+  return return_value;
+}
+
+WRATHActionQueue::record_header*
+WRATHActionQueue::
+reserve_record(uint32_t sz)
+{
+  WRATHassert(sz%record_alignment==0);
+  WRATHassert(sz<=max_inline_record_size);
+
+  WRATHAtomicAddAndFetch(&m_active_producers, 1);
+  for(;;)
+    {
+      chunk *c, *n;
+      uint32_t offset;
+
+      c=WRATHAtomicLoad(&m_tail);
+      offset=WRATHAtomicAddAndFetch(&c->m_reserved, sz) - sz;
+
+      if(offset + sz<=chunk_size)
+        {
+          record_header *h(c->header(offset));
+          h->m_size=sz;
+          return h;
+        }
+
+      if(offset<chunk_size)
+        {
+          /*
+            we are the first to run past the end of
+            the chunk, mark the chunk as finished
+            so that the consumer knows to move on
+            to the next chunk.
+           */
+          record_header *h(c->header(offset));
+          h->m_size=chunk_size - offset;
+          WRATHAtomicStore(&h->m_state, static_cast<int>(record_end_of_chunk));
+        }
+
+      n=WRATHAtomicLoad(&c->m_next);
+      if(n==NULL)
+        {
+          chunk *new_chunk(fetch_chunk());
+
+          if(WRATHAtomicCompareAndSwap(&c->m_next, static_cast<chunk*>(NULL), new_chunk))
+            {
+              n=new_chunk;
+            }
+          else
+            {
+              /*
+                new_chunk was never visible to
+                any other thread, so we can
+                place it directly back on the
+                free list.
+               */
+              WRATHLockMutex(m_free_chunks_mutex);
+              m_free_chunks.push_back(new_chunk);
+              WRATHUnlockMutex(m_free_chunks_mutex);
+              n=WRATHAtomicLoad(&c->m_next);
+            }
+        }
+
+      /*
+        failure means another thread already
+        advanced m_tail
+       */
+      WRATHAtomicCompareAndSwap(&m_tail, c, n);
+    }
+}
+
+void
+WRATHActionQueue::
+publish_record(record_header *h, enum record_state st)
+{
+  WRATHAtomicStore(&h->m_state, static_cast<int>(st));
+  WRATHAtomicSubtractAndFetch(&m_active_producers, 1);
+}
+
+int
+WRATHActionQueue::
+wait_record(record_header *h)
+{
+  int st, count(0);
+
+  while((st=WRATHAtomicLoad(&h->m_state))==record_pending)
+    {
+      backoff(count);
+    }
+  return st;
+}
+
+int
+WRATHActionQueue::
+execute_actions(void)
+{
+  chunk *tail;
+  uint32_t end;
+  int return_value(0);
+
+  /*
+    Snapshot the end of the queue, only those
+    records reserved before the snapshot are
+    executed. In particular actions scheduled
+    by the actions we execute are left for the
+    next call.
+   */
+  tail=WRATHAtomicLoad(&m_tail);
+  end=std::min(WRATHAtomicLoad(&tail->m_reserved), static_cast<uint32_t>(chunk_size));
+
+  for(;;)
+    {
+      chunk *c(m_head);
+      uint32_t limit;
+
+      limit=(c==tail)?
+        end:
+        static_cast<uint32_t>(chunk_size);
+
+      while(m_read<limit)
+        {
+          record_header *h(c->header(m_read));
+          int st;
+
+          st=wait_record(h);
+          if(st==record_end_of_chunk)
+            {
+              m_read=chunk_size;
+              break;
+            }
+
+          if(st==record_action)
+            {
+              base_action *a(chunk::payload(h));
+
+              a->execute();
+              a->~base_action();
+              ++return_value;
+            }
+          m_read+=h->m_size;
+        }
+
+      if(c==tail)
+        {
+          break;
+        }
+
+      /*
+        c is not the tail, hence it is full and
+        the producer that filled it has linked
+        (or is about to link) the next chunk.
+       */
+      chunk *n;
+      int count(0);
+
+      while((n=WRATHAtomicLoad(&c->m_next))==NULL)
+        {
+          backoff(count);
+        }
+
+      m_retired.push_back(c);
+      m_head=n;
+      m_read=0;
+    }
+
+  recycle_retired_chunks();
+  return return_value;
+}
+
+void
+WRATHActionQueue::
+recycle_retired_chunks(void)
+{
+  if(m_retired.empty())
+    {
+      return;
+    }
+
+  /*
+    A retired chunk is strictly before m_tail,
+    so a producer can only be touching it if it
+    read m_tail before the chunk was retired;
+    such a producer is still counted in
+    m_active_producers. Thus if there are no active
+    producers, no producer refers to a retired chunk.
+   */
+  if(WRATHAtomicAddAndFetch(&m_active_producers, 0)!=0)
+    {
+      return;
+    }
+
+  for(std::vector<chunk*>::iterator iter=m_retired.begin(),
+        end=m_retired.end(); iter!=end; ++iter)
+    {
+      (*iter)->reset();
+    }
+
+  WRATHLockMutex(m_free_chunks_mutex);
+  m_free_chunks.insert(m_free_chunks.end(), m_retired.begin(), m_retired.end());
+  WRATHUnlockMutex(m_free_chunks_mutex);
+
+  m_retired.clear();
+}
+
+bool
+WRATHActionQueue::
+empty(void)
+{
+  chunk *c(m_head);
+  uint32_t offset(m_read);
+
+  for(;;)
+    {
+      uint32_t end;
+
+      end=std::min(WRATHAtomicLoad(&c->m_reserved), static_cast<uint32_t>(chunk_size));
+      while(offset<end)
+        {
+          record_header *h(c->header(offset));
+          int st;
+
+          st=wait_record(h);
+          if(st==record_action)
+            {
+              return false;
+            }
+          offset=(st==record_end_of_chunk)?
+            static_cast<uint32_t>(chunk_size):
+            offset + h->m_size;
+        }
+
+      if(offset<chunk_size)
+        {
+          return true;
+        }
+
+      c=WRATHAtomicLoad(&c->m_next);
+      if(c==NULL)
+        {
+          return true;
+        }
+      offset=0;
+    }
+}
@@ -0,0 +1,136 @@
+/*! 
+ * \file WRATHFrameSignal.cpp
+ * \brief file WRATHFrameSignal.cpp
+ * 
+ * Copyright 2013 by Nomovok Ltd.
+ * 
+ * Contact: info@nomovok.com
+ * 
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ * 
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ * 
+ */
+
+
+#include "WRATHConfig.hpp"
+#include <algorithm>
+#include "WRATHFrameSignal.hpp"
+
+///////////////////////////////////
+// WRATHFrameSignal::connection methods
+void
+WRATHFrameSignal::connection::
+disconnect(void) const
+{
+  if(m_record.valid())
+    {
+      WRATHAtomicStore(&m_record->m_connected, 0);
+    }
+}
+
+bool
+WRATHFrameSignal::connection::
+connected(void) const
+{
+  return m_record.valid()
+    and WRATHAtomicLoad(&m_record->m_connected)!=0;
+}
+
+///////////////////////////////////
+// WRATHFrameSignal methods
+WRATHFrameSignal::
+WRATHFrameSignal(void):
+  m_has_pending(0)
+{}
+
+WRATHFrameSignal::
+~WRATHFrameSignal()
+{}
+
+WRATHFrameSignal::connection
+WRATHFrameSignal::
+connect(const slot_type &subscriber, int gp_order)
+{
+  slot_record *r;
+
+  r=WRATHNew slot_record(subscriber, gp_order);
+
+  WRATHLockMutex(m_pending_mutex);
+  m_pending.push_back(r);
+  WRATHAtomicStore(&m_has_pending, 1);
+  WRATHUnlockMutex(m_pending_mutex);
+
+  return connection(r);
+}
+
+void
+WRATHFrameSignal::
+merge_pending_slots(void)
+{
+  WRATHassert(m_scratch.empty());
+
+  WRATHLockMutex(m_pending_mutex);
+  std::swap(m_scratch, m_pending);
+  WRATHAtomicStore(&m_has_pending, 0);
+  WRATHUnlockMutex(m_pending_mutex);
+
+  if(m_scratch.empty())
+    {
+      return;
+    }
+
+  /*
+    stable sort and merge so that slots
+    of the same group are called in the
+    order that they are connected.
+   */
+  std::vector<record_handle>::size_type sz(m_slots.size());
+
+  std::stable_sort(m_scratch.begin(), m_scratch.end(), compare_gp_order());
+  m_slots.insert(m_slots.end(), m_scratch.begin(), m_scratch.end());
+  m_scratch.clear();
+
+  if(sz!=0 and m_slots[sz-1]->m_gp_order>m_slots[sz]->m_gp_order)
+    {
+      std::inplace_merge(m_slots.begin(), m_slots.begin()+sz, m_slots.end(),
+                         compare_gp_order());
+    }
+}
+
+void
+WRATHFrameSignal::
+operator()(void)
+{
+  std::vector<record_handle>::iterator write, read, end;
+
+  if(WRATHAtomicLoad(&m_has_pending)!=0)
+    {
+      merge_pending_slots();
+    }
+
+  /*
+    call the connected slots and compact
+    the array by dropping disconnected slots
+    as we go.
+   */
+  for(write=read=m_slots.begin(), end=m_slots.end(); read!=end; ++read)
+    {
+      slot_record *r(read->raw_pointer());
+
+      if(WRATHAtomicLoad(&r->m_connected)!=0)
+        {
+          r->m_slot();
+          if(write!=read)
+            {
+              write->swap(*read);
+            }
+          ++write;
+        }
+    }
+  m_slots.erase(write, end);
+}
@@ -0,0 +1,148 @@
+/*! 
+ * \file WRATHParallelFor.cpp
+ * \brief file WRATHParallelFor.cpp
+ * 
+ * Copyright 2013 by Nomovok Ltd.
+ * 
+ * Contact: info@nomovok.com
+ * 
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ * 
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ * 
+ */
+
+
+#include "WRATHConfig.hpp"
+#include <vector>
+#include <algorithm>
+#include <pthread.h>
+#include <unistd.h>
+#include "WRATHParallelFor.hpp"
+#include "WRATHatomic.hpp"
+#include "WRATHassert.hpp"
+#include "WRATHStaticInit.hpp"
+
+namespace
+{
+  class parallel_for_data
+  {
+  public:
+    parallel_for_data(WRATHParallelFor::Job &job, int count):
+      m_job(job),
+      m_count(count),
+      m_next(0)
+    {}
+
+    void
+    execute_jobs(void)
+    {
+      for(int i=WRATHAtomicAddAndFetch(&m_next, 1)-1; i<m_count;
+          i=WRATHAtomicAddAndFetch(&m_next, 1)-1)
+        {
+          m_job.execute(i);
+        }
+    }
+
+    WRATHParallelFor::Job &m_job;
+    int m_count;
+    int m_next;
+  };
+
+  void*
+  thread_main(void *ptr)
+  {
+    static_cast<parallel_for_data*>(ptr)->execute_jobs();
+    return NULL;
+  }
+
+  int
+  default_number_threads(void)
+  {
+    #ifdef _SC_NPROCESSORS_ONLN
+    {
+      long R;
+      R=sysconf(_SC_NPROCESSORS_ONLN);
+      return std::max(1L, R);
+    }
+    #else
+    {
+      return 1;
+    }
+    #endif
+  }
+
+  int&
+  max_threads(void)
+  {
+    WRATHStaticInit();
+    static int R(default_number_threads());
+    return R;
+  }
+}
+
+/////////////////////////////////////
+// WRATHParallelFor methods
+int
+WRATHParallelFor::
+max_number_threads(void)
+{
+  return WRATHAtomicLoad(&max_threads());
+}
+
+void
+WRATHParallelFor::
+max_number_threads(int v)
+{
+  WRATHAtomicStore(&max_threads(), std::max(1, v));
+}
+
+void
+WRATHParallelFor::
+run(Job &job, int count)
+{
+  int number_threads;
+
+  number_threads=std::min(count, max_number_threads());
+  if(number_threads<2)
+    {
+      for(int i=0; i<count; ++i)
+        {
+          job.execute(i);
+        }
+      return;
+    }
+
+  parallel_for_data data(job, count);
+  std::vector<pthread_t> threads;
+
+  /*
+    the calling thread is one of the threads
+    that execute the job, so we only create
+    number_threads-1 threads. If creating a 
+    thread fails, the remaining threads 
+    execute its share.
+   */
+  threads.reserve(std::max(0, number_threads-1));
+  for(int i=1; i<number_threads; ++i)
+    {
+      pthread_t th;
+      
+      if(0==pthread_create(&th, NULL, thread_main, &data))
+        {
+          threads.push_back(th);
+        }
+    }
+
+  data.execute_jobs();
+
+  for(std::vector<pthread_t>::iterator iter=threads.begin(),
+        end=threads.end(); iter!=end; ++iter)
+    {
+      pthread_join(*iter, NULL);
+    }
+}
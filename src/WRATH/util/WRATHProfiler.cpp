@@ -0,0 +1,428 @@
+/*! 
+ * \file WRATHProfiler.cpp
+ * \brief file WRATHProfiler.cpp
+ * 
+ * Copyright 2013 by Nomovok Ltd.
+ * 
+ * Contact: info@nomovok.com
+ * 
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ * 
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ * 
+ */
+
+
+#include "WRATHConfig.hpp"
+#include <time.h>
+#include <vector>
+#include <string>
+#include <map>
+#include <algorithm>
+#include <iomanip>
+#include "WRATHProfiler.hpp"
+#include "WRATHNew.hpp"
+#include "WRATHMutex.hpp"
+#include "WRATHatomic.hpp"
+#include "WRATHStaticInit.hpp"
+
+namespace
+{
+  class zone_record
+  {
+  public:
+    const char *m_name;
+    uint64_t m_begin, m_end;
+  };
+
+  /*
+    Ring buffer of zones of a single thread.
+    Only the owning thread writes m_records
+    and m_count; readers copy the records
+    and then re-read m_count to detect which
+    of the copied records the owning thread
+    may have overwritten while they were read.
+   */
+  class thread_buffer:boost::noncopyable
+  {
+  public:
+    explicit
+    thread_buffer(int tid):
+      m_count(0),
+      m_first(0),
+      m_tid(tid),
+      m_records(WRATHProfiler::ring_buffer_size)
+    {}
+
+    void
+    add(const char *name, uint64_t begin_ns, uint64_t end_ns)
+    {
+      unsigned int c(m_count);
+      zone_record &r(m_records[c & mask]);
+
+      r.m_name=name;
+      r.m_begin=begin_ns;
+      r.m_end=end_ns;
+      WRATHAtomicStore(&m_count, c + 1);
+    }
+
+    /*
+      append to out the zones recorded since
+      the last clear() that are still in the
+      ring buffer.
+     */
+    void
+    snapshot(std::vector<zone_record> &out) const
+    {
+      unsigned int begin, end, after;
+      std::vector<zone_record>::size_type start(out.size());
+
+      end=WRATHAtomicLoad(&m_count);
+      begin=(end - m_first > static_cast<unsigned int>(WRATHProfiler::ring_buffer_size))?
+        end - WRATHProfiler::ring_buffer_size:
+        m_first;
+
+      for(unsigned int i=begin; i!=end; ++i)
+        {
+          out.push_back(m_records[i & mask]);
+        }
+
+      /*
+        the owning thread may have written records
+        while we copied; the records with index
+        at or before after - ring_buffer_size
+        may have been overwritten.
+       */
+      WRATHAtomicFence();
+      after=WRATHAtomicLoad(&m_count);
+      if(after - begin >= static_cast<unsigned int>(WRATHProfiler::ring_buffer_size))
+        {
+          unsigned int drop;
+
+          drop=std::min(after - begin - WRATHProfiler::ring_buffer_size + 1, end - begin);
+          out.erase(out.begin() + start, out.begin() + start + drop);
+        }
+    }
+
+    enum
+      {
+        mask=WRATHProfiler::ring_buffer_size - 1
+      };
+
+    unsigned int m_count;
+
+    /*
+      value of m_count at the last clear(),
+      m_first and m_name are protected by
+      the mutex of the registry.
+     */
+    unsigned int m_first;
+    std::string m_name;
+
+    int m_tid;
+    std::vector<zone_record> m_records;
+  };
+
+  class registry:boost::noncopyable
+  {
+  public:
+    registry(void)
+    {}
+
+    ~registry()
+    {
+      for(std::vector<thread_buffer*>::iterator iter=m_buffers.begin(),
+            end=m_buffers.end(); iter!=end; ++iter)
+        {
+          WRATHDelete(*iter);
+        }
+    }
+
+    thread_buffer*
+    create_buffer(void)
+    {
+      thread_buffer *return_value;
+
+      WRATHAutoLockMutex(m_mutex);
+      return_value=WRATHNew thread_buffer(m_buffers.size());
+      m_buffers.push_back(return_value);
+      return return_value;
+    }
+
+    WRATHMutex m_mutex;
+    std::vector<thread_buffer*> m_buffers;
+  };
+
+  registry&
+  the_registry(void)
+  {
+    WRATHStaticInit();
+    static registry R;
+    return R;
+  }
+
+  /*
+    the ring buffer of the calling thread,
+    created on the first zone the thread
+    records.
+   */
+  __thread thread_buffer *current_thread_buffer=NULL;
+
+  thread_buffer&
+  fetch_thread_buffer(void)
+  {
+    if(current_thread_buffer==NULL)
+      {
+        current_thread_buffer=the_registry().create_buffer();
+      }
+    return *current_thread_buffer;
+  }
+
+  int recording_enabled=1;
+
+  class zone_summary
+  {
+  public:
+    zone_summary(void):
+      m_count(0),
+      m_total(0),
+      m_min(0),
+      m_max(0)
+    {}
+
+    void
+    add(uint64_t v)
+    {
+      m_min=(m_count==0)? v : std::min(m_min, v);
+      m_max=std::max(m_max, v);
+      m_total+=v;
+      ++m_count;
+    }
+
+    bool
+    operator<(const zone_summary &rhs) const
+    {
+      return m_total>rhs.m_total;
+    }
+
+    std::string m_name;
+    unsigned int m_count;
+    uint64_t m_total, m_min, m_max;
+  };
+
+  void
+  write_json_string(std::ostream &ostr, const char *str)
+  {
+    ostr << "\"";
+    for(; *str!='\0'; ++str)
+      {
+        if(*str=='"' or *str=='\\')
+          {
+            ostr << '\\';
+          }
+        ostr << *str;
+      }
+    ostr << "\"";
+  }
+
+  /*
+    ns to us printed with a fixed precision,
+    the format chrome://tracing expects for
+    time stamps.
+   */
+  void
+  write_us(std::ostream &ostr, uint64_t ns)
+  {
+    ostr << ns/1000 << "."
+         << std::setw(3) << std::setfill('0') << ns%1000
+         << std::setfill(' ');
+  }
+}
+
+uint64_t
+WRATHProfiler::
+time_ns(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return static_cast<uint64_t>(t.tv_sec)*uint64_t(1000000000)
+    + static_cast<uint64_t>(t.tv_nsec);
+}
+
+void
+WRATHProfiler::
+record_zone(const char *name, uint64_t begin_ns, uint64_t end_ns)
+{
+#ifdef WRATH_ENABLE_PROFILER
+  fetch_thread_buffer().add(name, begin_ns, end_ns);
+#else
+  WRATHunused(name);
+  WRATHunused(begin_ns);
+  WRATHunused(end_ns);
+#endif
+}
+
+void
+WRATHProfiler::
+enabled(bool v)
+{
+  WRATHAtomicStore(&recording_enabled, v?1:0);
+}
+
+bool
+WRATHProfiler::
+enabled(void)
+{
+#ifdef WRATH_ENABLE_PROFILER
+  return recording_enabled!=0;
+#else
+  return false;
+#endif
+}
+
+void
+WRATHProfiler::
+thread_name(const char *name)
+{
+  thread_buffer &buffer(fetch_thread_buffer());
+
+  WRATHAutoLockMutex(the_registry().m_mutex);
+  buffer.m_name=name;
+}
+
+void
+WRATHProfiler::
+clear(void)
+{
+  registry &R(the_registry());
+
+  WRATHAutoLockMutex(R.m_mutex);
+  for(std::vector<thread_buffer*>::iterator iter=R.m_buffers.begin(),
+        end=R.m_buffers.end(); iter!=end; ++iter)
+    {
+      (*iter)->m_first=WRATHAtomicLoad(&(*iter)->m_count);
+    }
+}
+
+void
+WRATHProfiler::
+write_chrome_trace(std::ostream &ostr)
+{
+  registry &R(the_registry());
+  std::vector<std::vector<zone_record> > zones;
+  std::vector<std::string> names;
+  std::vector<int> tids;
+  uint64_t start_time(~uint64_t(0));
+  bool first(true);
+
+  WRATHLockMutex(R.m_mutex);
+  zones.resize(R.m_buffers.size());
+  for(unsigned int i=0, endi=R.m_buffers.size(); i<endi; ++i)
+    {
+      R.m_buffers[i]->snapshot(zones[i]);
+      names.push_back(R.m_buffers[i]->m_name);
+      tids.push_back(R.m_buffers[i]->m_tid);
+    }
+  WRATHUnlockMutex(R.m_mutex);
+
+  for(unsigned int i=0, endi=zones.size(); i<endi; ++i)
+    {
+      for(unsigned int z=0, endz=zones[i].size(); z<endz; ++z)
+        {
+          start_time=std::min(start_time, zones[i][z].m_begin);
+        }
+    }
+
+  ostr << "{\"traceEvents\":[\n";
+  for(unsigned int i=0, endi=zones.size(); i<endi; ++i)
+    {
+      if(!names[i].empty())
+        {
+          ostr << (first?"":",\n")
+               << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":"
+               << tids[i] << ",\"args\":{\"name\":";
+          write_json_string(ostr, names[i].c_str());
+          ostr << "}}";
+          first=false;
+        }
+
+      for(unsigned int z=0, endz=zones[i].size(); z<endz; ++z)
+        {
+          const zone_record &r(zones[i][z]);
+
+          ostr << (first?"":",\n") << "{\"name\":";
+          write_json_string(ostr, r.m_name);
+          ostr << ",\"cat\":\"WRATH\",\"ph\":\"X\",\"pid\":0,\"tid\":"
+               << tids[i] << ",\"ts\":";
+          write_us(ostr, r.m_begin - start_time);
+          ostr << ",\"dur\":";
+          write_us(ostr, r.m_end - r.m_begin);
+          ostr << "}";
+          first=false;
+        }
+    }
+  ostr << "\n]}\n";
+}
+
+void
+WRATHProfiler::
+write_summary(std::ostream &ostr)
+{
+  registry &R(the_registry());
+  std::vector<zone_record> zones;
+  std::map<std::string, zone_summary> summary_map;
+  std::vector<zone_summary> summary;
+
+  WRATHLockMutex(R.m_mutex);
+  for(std::vector<thread_buffer*>::iterator iter=R.m_buffers.begin(),
+        end=R.m_buffers.end(); iter!=end; ++iter)
+    {
+      (*iter)->snapshot(zones);
+    }
+  WRATHUnlockMutex(R.m_mutex);
+
+  for(std::vector<zone_record>::const_iterator iter=zones.begin(),
+        end=zones.end(); iter!=end; ++iter)
+    {
+      summary_map[iter->m_name].add(iter->m_end - iter->m_begin);
+    }
+
+  for(std::map<std::string, zone_summary>::iterator iter=summary_map.begin(),
+        end=summary_map.end(); iter!=end; ++iter)
+    {
+      summary.push_back(iter->second);
+      summary.back().m_name=iter->first;
+    }
+  std::sort(summary.begin(), summary.end());
+
+  std::ios_base::fmtflags flags(ostr.flags());
+  std::streamsize precision(ostr.precision());
+
+  ostr << std::fixed << std::setprecision(3);
+  ostr << std::left << std::setw(32) << "zone" << std::right
+       << std::setw(10) << "count"
+       << std::setw(14) << "total(us)"
+       << std::setw(12) << "mean(us)"
+       << std::setw(12) << "min(us)"
+       << std::setw(12) << "max(us)"
+       << "\n";
+
+  for(std::vector<zone_summary>::const_iterator iter=summary.begin(),
+        end=summary.end(); iter!=end; ++iter)
+    {
+      ostr << std::left << std::setw(32) << iter->m_name << std::right
+           << std::setw(10) << iter->m_count
+           << std::setw(14) << static_cast<double>(iter->m_total)/1000.0
+           << std::setw(12) << static_cast<double>(iter->m_total)/(1000.0*iter->m_count)
+           << std::setw(12) << static_cast<double>(iter->m_min)/1000.0
+           << std::setw(12) << static_cast<double>(iter->m_max)/1000.0
+           << "\n";
+    }
+  ostr.flags(flags);
+  ostr.precision(precision);
+}
@@ -52,6 +52,30 @@ WRATHReferenceCountedObject::
 }
 
 
+int
+WRATHReferenceCountedObject::
+reference_count(void) const
+{
+  int v;
+
+  #ifdef WRATH_DISABLE_ATOMICS
+    WRATHLockMutexIfNonNULL(m_mutex);
+    v=m_reference_count;
+    WRATHUnlockMutexIfNonNULL(m_mutex);
+  #else
+    if(m_mutex!=NULL)
+      {
+        v=WRATHAtomicLoad(const_cast<int*>(&m_reference_count));
+      }
+    else
+      {
+        v=m_reference_count;
+      }
+  #endif
+
+  return v;
+}
+
 void
 WRATHReferenceCountedObject::
 increment(WRATHReferenceCountedObject *ptr)
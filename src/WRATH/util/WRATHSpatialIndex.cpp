@@ -0,0 +1,450 @@
+/*! 
+ * \file WRATHSpatialIndex.cpp
+ * \brief file WRATHSpatialIndex.cpp
+ * 
+ * Copyright 2013 by Nomovok Ltd.
+ * 
+ * Contact: info@nomovok.com
+ * 
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ * 
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ * 
+ */
+
+
+#include "WRATHConfig.hpp"
+#include <algorithm>
+#include "WRATHSpatialIndex.hpp"
+
+namespace
+{
+  float
+  perimeter(const vec2 &pmin, const vec2 &pmax)
+  {
+    return 2.0f*(pmax.x() - pmin.x() + pmax.y() - pmin.y());
+  }
+
+  float
+  union_perimeter(const vec2 &amin, const vec2 &amax,
+                  const vec2 &bmin, const vec2 &bmax)
+  {
+    return 2.0f*(std::max(amax.x(), bmax.x()) - std::min(amin.x(), bmin.x())
+                 + std::max(amax.y(), bmax.y()) - std::min(amin.y(), bmin.y()));
+  }
+
+  void
+  set_union(vec2 &outmin, vec2 &outmax,
+            const vec2 &amin, const vec2 &amax,
+            const vec2 &bmin, const vec2 &bmax)
+  {
+    outmin=vec2(std::min(amin.x(), bmin.x()), std::min(amin.y(), bmin.y()));
+    outmax=vec2(std::max(amax.x(), bmax.x()), std::max(amax.y(), bmax.y()));
+  }
+
+  bool
+  overlaps(const vec2 &amin, const vec2 &amax,
+           const vec2 &bmin, const vec2 &bmax)
+  {
+    return amin.x()<=bmax.x() and bmin.x()<=amax.x()
+      and amin.y()<=bmax.y() and bmin.y()<=amax.y();
+  }
+
+  bool
+  contains(const vec2 &outer_min, const vec2 &outer_max,
+           const vec2 &inner_min, const vec2 &inner_max)
+  {
+    return outer_min.x()<=inner_min.x() and outer_min.y()<=inner_min.y()
+      and inner_max.x()<=outer_max.x() and inner_max.y()<=outer_max.y();
+  }
+}
+
+/////////////////////////////////////
+// WRATHSpatialIndex methods
+WRATHSpatialIndex::
+WRATHSpatialIndex(float margin):
+  m_margin(margin),
+  m_root(null_node),
+  m_free_list(null_node),
+  m_size(0)
+{}
+
+void
+WRATHSpatialIndex::
+clear(void)
+{
+  m_nodes.clear();
+  m_root=null_node;
+  m_free_list=null_node;
+  m_size=0;
+}
+
+int
+WRATHSpatialIndex::
+allocate_node(void)
+{
+  int id;
+
+  if(m_free_list!=null_node)
+    {
+      id=m_free_list;
+      m_free_list=m_nodes[id].m_parent;
+    }
+  else
+    {
+      id=m_nodes.size();
+      m_nodes.push_back(node());
+    }
+
+  node &N(m_nodes[id]);
+  N.m_parent=null_node;
+  N.m_child[0]=N.m_child[1]=null_node;
+  N.m_height=0;
+  N.m_user_data=NULL;
+  return id;
+}
+
+void
+WRATHSpatialIndex::
+free_node(int id)
+{
+  m_nodes[id].m_height=-1;
+  m_nodes[id].m_parent=m_free_list;
+  m_free_list=id;
+}
+
+int
+WRATHSpatialIndex::
+add(const BBox &box, void *user_data)
+{
+  int id;
+
+  WRATHassert(!box.empty());
+
+  id=allocate_node();
+
+  node &N(m_nodes[id]);
+  N.m_exact_min=box.min_corner();
+  N.m_exact_max=box.max_corner();
+  N.m_min=box.min_corner() - vec2(m_margin, m_margin);
+  N.m_max=box.max_corner() + vec2(m_margin, m_margin);
+  N.m_user_data=user_data;
+
+  insert_leaf(id);
+  ++m_size;
+  return id;
+}
+
+void
+WRATHSpatialIndex::
+remove(int id)
+{
+  WRATHassert(is_leaf(id));
+
+  remove_leaf(id);
+  free_node(id);
+  --m_size;
+}
+
+bool
+WRATHSpatialIndex::
+move(int id, const BBox &box)
+{
+  WRATHassert(is_leaf(id));
+  WRATHassert(!box.empty());
+
+  node &N(m_nodes[id]);
+
+  N.m_exact_min=box.min_corner();
+  N.m_exact_max=box.max_corner();
+  if(contains(N.m_min, N.m_max, N.m_exact_min, N.m_exact_max))
+    {
+      return false;
+    }
+
+  remove_leaf(id);
+  m_nodes[id].m_min=box.min_corner() - vec2(m_margin, m_margin);
+  m_nodes[id].m_max=box.max_corner() + vec2(m_margin, m_margin);
+  insert_leaf(id);
+  return true;
+}
+
+void
+WRATHSpatialIndex::
+insert_leaf(int leaf)
+{
+  int sibling, old_parent, new_parent;
+  vec2 leaf_min, leaf_max;
+
+  if(m_root==null_node)
+    {
+      m_root=leaf;
+      m_nodes[leaf].m_parent=null_node;
+      return;
+    }
+
+  /*
+    find the best sibling for the new leaf
+    by the surface area (perimeter in 2D)
+    heuristic.
+   */
+  leaf_min=m_nodes[leaf].m_min;
+  leaf_max=m_nodes[leaf].m_max;
+  sibling=m_root;
+  while(!m_nodes[sibling].leaf())
+    {
+      const node &N(m_nodes[sibling]);
+      float area, combined_area, cost, inheritance_cost;
+      vecN<float, 2> child_cost;
+
+      area=perimeter(N.m_min, N.m_max);
+      combined_area=union_perimeter(N.m_min, N.m_max, leaf_min, leaf_max);
+
+      /*
+        cost of making a new parent of
+        this node and the new leaf
+       */
+      cost=2.0f*combined_area;
+
+      /*
+        minimum cost of pushing the leaf
+        further down the tree
+       */
+      inheritance_cost=2.0f*(combined_area - area);
+
+      for(int c=0; c<2; ++c)
+        {
+          const node &C(m_nodes[N.m_child[c]]);
+
+          child_cost[c]=union_perimeter(C.m_min, C.m_max, leaf_min, leaf_max)
+            + inheritance_cost;
+          if(!C.leaf())
+            {
+              child_cost[c]-=perimeter(C.m_min, C.m_max);
+            }
+        }
+
+      if(cost<child_cost[0] and cost<child_cost[1])
+        {
+          break;
+        }
+
+      sibling=(child_cost[0]<child_cost[1])?
+        N.m_child[0]:
+        N.m_child[1];
+    }
+
+  /*
+    note that allocate_node() may resize m_nodes,
+    so we cannot hold references across it.
+   */
+  new_parent=allocate_node();
+  old_parent=m_nodes[sibling].m_parent;
+
+  node &P(m_nodes[new_parent]);
+  P.m_parent=old_parent;
+  P.m_height=m_nodes[sibling].m_height + 1;
+  P.m_child[0]=sibling;
+  P.m_child[1]=leaf;
+  set_union(P.m_min, P.m_max,
+            leaf_min, leaf_max,
+            m_nodes[sibling].m_min, m_nodes[sibling].m_max);
+
+  if(old_parent!=null_node)
+    {
+      node &G(m_nodes[old_parent]);
+      G.m_child[(G.m_child[0]==sibling)?0:1]=new_parent;
+    }
+  else
+    {
+      m_root=new_parent;
+    }
+  m_nodes[sibling].m_parent=new_parent;
+  m_nodes[leaf].m_parent=new_parent;
+
+  refit_ancestors(new_parent);
+}
+
+void
+WRATHSpatialIndex::
+remove_leaf(int leaf)
+{
+  int parent, grand_parent, sibling;
+
+  if(leaf==m_root)
+    {
+      m_root=null_node;
+      return;
+    }
+
+  parent=m_nodes[leaf].m_parent;
+  grand_parent=m_nodes[parent].m_parent;
+  sibling=(m_nodes[parent].m_child[0]==leaf)?
+    m_nodes[parent].m_child[1]:
+    m_nodes[parent].m_child[0];
+
+  if(grand_parent!=null_node)
+    {
+      node &G(m_nodes[grand_parent]);
+
+      G.m_child[(G.m_child[0]==parent)?0:1]=sibling;
+      m_nodes[sibling].m_parent=grand_parent;
+      free_node(parent);
+      refit_ancestors(grand_parent);
+    }
+  else
+    {
+      m_root=sibling;
+      m_nodes[sibling].m_parent=null_node;
+      free_node(parent);
+    }
+}
+
+void
+WRATHSpatialIndex::
+refit_ancestors(int id)
+{
+  while(id!=null_node)
+    {
+      id=balance(id);
+
+      node &N(m_nodes[id]);
+      const node &C0(m_nodes[N.m_child[0]]);
+      const node &C1(m_nodes[N.m_child[1]]);
+
+      N.m_height=1 + std::max(C0.m_height, C1.m_height);
+      set_union(N.m_min, N.m_max, C0.m_min, C0.m_max, C1.m_min, C1.m_max);
+      id=N.m_parent;
+    }
+}
+
+int
+WRATHSpatialIndex::
+balance(int a)
+{
+  node &A(m_nodes[a]);
+  int b, c, d;
+
+  if(A.leaf() or A.m_height<2)
+    {
+      return a;
+    }
+
+  /*
+    if one child is more than 1 higher than
+    the other, rotate the higher child up:
+    the higher child (c) takes the place of a,
+    a takes the place of the higher grandchild
+    (of c) and the lower grandchild takes the
+    place of c under a.
+   */
+  b=A.m_child[0];
+  c=A.m_child[1];
+  if(m_nodes[b].m_height - m_nodes[c].m_height>1)
+    {
+      std::swap(b, c);
+    }
+  else if(m_nodes[c].m_height - m_nodes[b].m_height<=1)
+    {
+      return a;
+    }
+
+  /*
+    now c is the higher child of a and b the lower,
+    let k be the index of c within a
+   */
+  int k((A.m_child[0]==c)?0:1);
+  node &C(m_nodes[c]);
+  int f(C.m_child[0]), g(C.m_child[1]);
+  int lower;
+
+  if(m_nodes[f].m_height>m_nodes[g].m_height)
+    {
+      d=f;
+      lower=g;
+    }
+  else
+    {
+      d=g;
+      lower=f;
+    }
+
+  /*
+    c takes the place of a
+   */
+  C.m_parent=A.m_parent;
+  if(C.m_parent!=null_node)
+    {
+      node &P(m_nodes[C.m_parent]);
+      P.m_child[(P.m_child[0]==a)?0:1]=c;
+    }
+  else
+    {
+      m_root=c;
+    }
+
+  /*
+    a's children become b and lower,
+    c's children become a and d.
+   */
+  A.m_child[k]=lower;
+  m_nodes[lower].m_parent=a;
+  set_union(A.m_min, A.m_max,
+            m_nodes[b].m_min, m_nodes[b].m_max,
+            m_nodes[lower].m_min, m_nodes[lower].m_max);
+  A.m_height=1 + std::max(m_nodes[b].m_height, m_nodes[lower].m_height);
+
+  C.m_child[0]=a;
+  C.m_child[1]=d;
+  A.m_parent=c;
+  set_union(C.m_min, C.m_max,
+            A.m_min, A.m_max,
+            m_nodes[d].m_min, m_nodes[d].m_max);
+  C.m_height=1 + std::max(A.m_height, m_nodes[d].m_height);
+
+  return c;
+}
+
+void
+WRATHSpatialIndex::
+query(const BBox &box, std::vector<int> &out) const
+{
+  if(m_root==null_node or box.empty())
+    {
+      return;
+    }
+
+  const vec2 &qmin(box.min_corner());
+  const vec2 &qmax(box.max_corner());
+
+  m_stack.clear();
+  m_stack.push_back(m_root);
+  while(!m_stack.empty())
+    {
+      int id(m_stack.back());
+      const node &N(m_nodes[id]);
+
+      m_stack.pop_back();
+      if(!overlaps(N.m_min, N.m_max, qmin, qmax))
+        {
+          continue;
+        }
+
+      if(N.leaf())
+        {
+          if(overlaps(N.m_exact_min, N.m_exact_max, qmin, qmax))
+            {
+              out.push_back(id);
+            }
+        }
+      else
+        {
+          m_stack.push_back(N.m_child[0]);
+          m_stack.push_back(N.m_child[1]);
+        }
+    }
+}
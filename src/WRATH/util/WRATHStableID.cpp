@@ -0,0 +1,61 @@
+/*! 
+ * \file WRATHStableID.cpp
+ * \brief file WRATHStableID.cpp
+ * 
+ * Copyright 2013 by Nomovok Ltd.
+ * 
+ * Contact: info@nomovok.com
+ * 
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ * 
+ * \author Kevin Rogovin <kevin.rogovin@nomovok.com>
+ * 
+ */
+
+
+#include "WRATHConfig.hpp"
+#include <algorithm>
+#include <functional>
+#include "WRATHStableID.hpp"
+
+/////////////////////////////////
+// WRATHStableIDPool methods
+int
+WRATHStableIDPool::
+acquire(void)
+{
+  int return_value;
+
+  WRATHAutoLockMutex(m_mutex);
+  if(m_free.empty())
+    {
+      return_value=m_next;
+      ++m_next;
+    }
+  else
+    {
+      /*
+        m_free is a min-heap so that
+        the smallest free ID is reused.
+       */
+      std::pop_heap(m_free.begin(), m_free.end(), std::greater<int>());
+      return_value=m_free.back();
+      m_free.pop_back();
+    }
+  return return_value;
+}
+
+void
+WRATHStableIDPool::
+release(int v)
+{
+  WRATHAutoLockMutex(m_mutex);
+  WRATHassert(v>=0 and v<m_next);
+
+  m_free.push_back(v);
+  std::push_heap(m_free.begin(), m_free.end(), std::greater<int>());
+}
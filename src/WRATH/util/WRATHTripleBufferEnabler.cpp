@@ -228,32 +228,10 @@ connect(enum WRATHTripleBufferEnabler::signal_type tp,
   WRATHassert(tp<number_signal_type_enums);
   WRATHassert(tm<number_signal_time_enums);
 
-  return m_sigs[tp][tm].connect(gp_order, subscriber);
+  return m_sigs[tp][tm].connect(subscriber, gp_order);
 }
 
 
-void
-WRATHTripleBufferEnabler::
-do_actions(std::list<base_action*> &actions,
-           WRATHMutex &mutex)
-{
-  std::list<base_action*> ct;
-
-  WRATHLockMutex(mutex);
-  std::swap(actions, ct);
-  WRATHUnlockMutex(mutex);
-
-  for(std::list<base_action*>::iterator iter=ct.begin(),
-        end=ct.end(); iter!=end; ++iter)
-    {
-      (*iter)->execute();
-      WRATHDelete(*iter);
-    }
-}
-
-
-
-
 void
 WRATHTripleBufferEnabler::
 signal_begin_presentation_frame(void)
@@ -280,7 +258,7 @@ signal_begin_presentation_frame(void)
 
   WRATHUnlockMutex(m_mutex);
   fire_signal(m_sigs[on_begin_presentation_frame][post_update_no_lock]);
-  do_actions(m_render_actions, m_render_actions_mutex);
+  m_render_actions.execute_actions();
 
   {
     WRATHAutoLockMutex(m_counter_lock);
@@ -320,7 +298,7 @@ signal_complete_simulation_frame(void)
   /*
     do pending actions
    */
-  do_actions(m_simulation_actions, m_simulation_actions_mutex);
+  m_simulation_actions.execute_actions();
 
 
 
@@ -392,11 +370,7 @@ purge_cleanup(void)
       delops=!m_phase0.empty() or !m_phase1.empty() or !m_phase2.empty();  
       WRATHUnlockMutex(m_phase_mutex);
       
-      WRATHLockMutex(m_render_actions_mutex);
-      WRATHLockMutex(m_simulation_actions_mutex);
       rops=!m_render_actions.empty() or !m_simulation_actions.empty();
-      WRATHUnlockMutex(m_simulation_actions_mutex);
-      WRATHUnlockMutex(m_render_actions_mutex);
 
       ++return_value;
     }
@@ -21,6 +21,7 @@
 #include <sstream>
 #include <vector>
 #include <dirent.h>
+#include <cstring>
 #include "WRATHassert.hpp" 
 #include "WRATHUtil.hpp"
 #include "ieeehalfprecision.h"
@@ -28,6 +29,77 @@
 #include "WRATHMutex.hpp"
 #include "WRATHStaticInit.hpp"
 
+#if defined(__F16C__)
+  #include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__ARM_FP) && (__ARM_FP & 2)
+  #include <arm_neon.h>
+  #define WRATH_NEON_HALFP
+#endif
+
+namespace
+{
+  inline
+  float
+  float_from_bits(uint32_t v)
+  {
+    float f;
+    std::memcpy(&f, &v, sizeof(f));
+    return f;
+  }
+
+  inline
+  uint32_t
+  bits_from_float(float f)
+  {
+    uint32_t v;
+    std::memcpy(&v, &f, sizeof(v));
+    return v;
+  }
+
+  /*
+    Converts the bits of a 32-bit float to a 16-bit
+    float with round to nearest even. There are no
+    branches, only selects, so that a loop of it can
+    be vectorized by the compiler.
+   */
+  inline
+  uint16_t
+  halfp_from_float_bits(uint32_t x)
+  {
+    const uint32_t f32_infinity=255u << 23u;
+
+    //smallest float that overflows to infinity as a half, 65536.0f
+    const uint32_t f16_overflow=(127u + 16u) << 23u;
+
+    //smallest float that is a normal half, 2^-14
+    const uint32_t f16_min_normal=113u << 23u;
+
+    //0.5f, adding it to a float below 2^-14 places
+    //the half denormal mantissa in the low bits
+    const uint32_t denorm_magic=((127u - 15u) + (23u - 10u) + 1u) << 23u;
+
+    uint32_t sign, abs_x, mantissa_odd, normal, denorm, inf_nan, R;
+
+    sign=x & 0x80000000u;
+    abs_x=x ^ sign;
+
+    //rebias the exponent and round to nearest even
+    mantissa_odd=(abs_x >> 13u) & 1u;
+    normal=(abs_x - ((127u - 15u) << 23u) + 0xFFFu + mantissa_odd) >> 13u;
+
+    //let the FPU do the rounding of denormals
+    denorm=bits_from_float(float_from_bits(abs_x) + float_from_bits(denorm_magic)) - denorm_magic;
+
+    inf_nan=(abs_x>f32_infinity)?
+      0x7E00u:
+      0x7C00u;
+
+    R=(abs_x<f16_min_normal)?denorm:normal;
+    R=(abs_x>=f16_overflow)?inf_nan:R;
+    return static_cast<uint16_t>(R | (sign >> 16u));
+  }
+}
+
 std::string
 WRATHUtil::
 filename_extension(const std::string &S)
@@ -107,9 +179,40 @@ void
 WRATHUtil::
 convert_to_halfp_from_float_raw(void *dest, const void *src, int number_elements)
 {
-  singles2halfp(static_cast<uint16_t*>(dest), 
-                static_cast<const uint32_t*>(src), 
-                number_elements);
+  uint16_t *hp(static_cast<uint16_t*>(dest));
+  const uint32_t *xp(static_cast<const uint32_t*>(src));
+  int i(0);
+
+  if(hp==NULL or xp==NULL)
+    {
+      return;
+    }
+
+  #if defined(__F16C__)
+  {
+    for(; i+4<=number_elements; i+=4)
+      {
+        __m128 v;
+        v=_mm_loadu_ps(reinterpret_cast<const float*>(xp + i));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(hp + i), 
+                         _mm_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+      }
+  }
+  #elif defined(WRATH_NEON_HALFP)
+  {
+    for(; i+4<=number_elements; i+=4)
+      {
+        float32x4_t v;
+        v=vld1q_f32(reinterpret_cast<const float*>(xp + i));
+        vst1_u16(hp + i, vreinterpret_u16_f16(vcvt_f16_f32(v)));
+      }
+  }
+  #endif
+
+  for(; i<number_elements; ++i)
+    {
+      hp[i]=halfp_from_float_bits(xp[i]);
+    }
 }
  
 void